@@ -0,0 +1,59 @@
+#include "Benchmark.h"
+
+#include <cppu/cgc/pointers.h>
+
+#include "World/Constituents/Animator.h"
+
+namespace Esteem
+{
+	ESTEEM_BENCHMARK("Animator/InterpolateFrame", BenchAnimatorInterpolate)
+	{
+		constexpr std::size_t boneCount = 64;
+		constexpr std::size_t keyCount = 120;
+		constexpr float duration = 4.f;
+
+		BenchmarkRandom random;
+
+		// a single skeleton animation like the model loader creates it
+		auto sequence = cgc::construct_new<AnimationSequence>("bench", duration * 30.f, 30.f);
+		auto& channels = const_cast<std::unordered_map<hash_t, AnimationChannelData>&>(sequence->GetChannelData());
+
+		std::vector<hash_t> boneHashes;
+		for (std::size_t bone = 0; bone < boneCount; ++bone)
+		{
+			hash_t hash = hash_t(random.Next());
+			boneHashes.push_back(hash);
+
+			AnimationChannelData& channel = channels[hash];
+			channel.boneName = "bone" + std::to_string(bone);
+			channel.boneIndex = uint(bone);
+
+			for (std::size_t key = 0; key < keyCount; ++key)
+			{
+				float time = float(key) * (duration * 30.f / float(keyCount));
+				glm::vec3 axis = glm::normalize(glm::vec3(random.Between(-1.f, 1.f), random.Between(-1.f, 1.f), random.Between(0.1f, 1.f)));
+				channel.rotationKeys.emplace_back(time, glm::angleAxis(random.Between(-3.f, 3.f), axis));
+				channel.positionKeys.emplace_back(time, glm::vec3(random.Between(-1.f, 1.f), random.Between(-1.f, 1.f), random.Between(-1.f, 1.f)));
+			}
+		}
+
+		// spread the sample times over the whole animation, late keys take the longest to find
+		std::vector<Animator::Sequence> sequences;
+		for (std::size_t i = 0; i < 16; ++i)
+			sequences.emplace_back(sequence, random.Between(0.f, duration * 30.f));
+
+		std::vector<Animation::MixedFrame> frames(boneCount);
+
+		state.SetItems(sequences.size() * boneCount);
+		state.Measure([&]()
+		{
+			for (auto& animation : sequences)
+			{
+				for (std::size_t bone = 0; bone < boneCount; ++bone)
+					animation.Interpolate(boneHashes[bone], frames[bone]);
+			}
+
+			DoNotOptimize(frames);
+		});
+	}
+}
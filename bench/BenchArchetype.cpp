@@ -0,0 +1,119 @@
+#include "Benchmark.h"
+
+#include <memory>
+#include <unordered_map>
+
+#include "World/ArchetypeStore.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t EntityCount = 100000;
+
+		struct BenchPosition { float x, y, z; };
+		struct BenchVelocity { float x, y, z; };
+		struct BenchHealth { int32_t value; };
+		struct BenchTag { int32_t value; };
+
+		/// \brief the component layout the archetype store replaces: a heap object per component found through a map
+		struct BenchMapEntity
+		{
+			std::unordered_map<std::size_t, std::unique_ptr<void, void(*)(void*)>> components;
+
+			template<class T>
+			T* Get()
+			{
+				auto found = components.find(typeid(T).hash_code());
+				return found != components.end() ? static_cast<T*>(found->second.get()) : nullptr;
+			}
+
+			template<class T>
+			void Add(const T& value)
+			{
+				components.emplace(typeid(T).hash_code(), std::unique_ptr<void, void(*)(void*)>(new T(value), [](void* p) { delete static_cast<T*>(p); }));
+			}
+		};
+	}
+
+	/// \brief also checks that a query made before its archetypes existed visits every matching entity
+	ESTEEM_BENCHMARK("Archetype/QueryForEach", BenchArchetypeQuery)
+	{
+		BenchmarkRandom random;
+		ArchetypeStore store;
+
+		// made before any entity, the archetypes it matches are all created afterwards
+		auto query = store.Query<BenchPosition, BenchVelocity>();
+
+		// a third of the entities lives in a second archetype, so the query visits more than one
+		std::vector<ArchetypeEntity> entities;
+		for (std::size_t i = 0; i < EntityCount; ++i)
+		{
+			ArchetypeEntity entity = entities.emplace_back(store.CreateEntity());
+			store.AddComponent<BenchPosition>(entity, BenchPosition{ random.Between(-100.f, 100.f), 0.f, random.Between(-100.f, 100.f) });
+			store.AddComponent<BenchVelocity>(entity, BenchVelocity{ random.Between(-1.f, 1.f), 0.f, random.Between(-1.f, 1.f) });
+			if (i % 3 == 0)
+				store.AddComponent<BenchHealth>(entity, BenchHealth{ 100 });
+		}
+
+		auto countVisits = [&query]()
+		{
+			std::size_t visited = 0;
+			query.ForEach([&visited](BenchPosition&, BenchVelocity&) { ++visited; });
+			return visited;
+		};
+
+		std::size_t visited = countVisits();
+		ESTEEM_BENCH_CHECK(visited == EntityCount && query.Count() == EntityCount, "a query made before its archetypes visited ", std::to_string(visited), " and counted ",
+			std::to_string(query.Count()), " of ", std::to_string(EntityCount), " entities");
+
+		// migrating one entity creates a new archetype while the query is in use
+		store.AddComponent<BenchTag>(entities[1], BenchTag{ 1 });
+		visited = countVisits();
+		ESTEEM_BENCH_CHECK(visited == EntityCount, "after a new archetype appeared the query visited ", std::to_string(visited), " of ", std::to_string(EntityCount), " entities");
+		store.RemoveComponent<BenchTag>(entities[1]);
+
+		state.SetItems(EntityCount);
+		state.Measure([&]()
+		{
+			query.ForEach([](BenchPosition& position, const BenchVelocity& velocity)
+			{
+				position.x += velocity.x * 0.016f;
+				position.y += velocity.y * 0.016f;
+				position.z += velocity.z * 0.016f;
+			});
+		});
+	}
+
+	ESTEEM_BENCHMARK("Archetype/MapWalk", BenchArchetypeMapWalk)
+	{
+		BenchmarkRandom random;
+		std::vector<BenchMapEntity> entities(EntityCount);
+
+		for (std::size_t i = 0; i < EntityCount; ++i)
+		{
+			entities[i].Add(BenchPosition{ random.Between(-100.f, 100.f), 0.f, random.Between(-100.f, 100.f) });
+			entities[i].Add(BenchVelocity{ random.Between(-1.f, 1.f), 0.f, random.Between(-1.f, 1.f) });
+			if (i % 3 == 0)
+				entities[i].Add(BenchHealth{ 100 });
+		}
+
+		state.SetItems(EntityCount);
+		state.Measure([&]()
+		{
+			for (BenchMapEntity& entity : entities)
+			{
+				BenchPosition* position = entity.Get<BenchPosition>();
+				const BenchVelocity* velocity = entity.Get<BenchVelocity>();
+				if (position && velocity)
+				{
+					position->x += velocity->x * 0.016f;
+					position->y += velocity->y * 0.016f;
+					position->z += velocity->z * 0.016f;
+				}
+			}
+
+			DoNotOptimize(entities);
+		});
+	}
+}
@@ -0,0 +1,285 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "Utils/AssetIO.h"
+#include "Utils/Data.h"
+#include "Utils/PakWriter.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t FileCount = 512;
+		constexpr std::size_t FileSize = 64 * 1024;
+		constexpr std::size_t CriticalCount = 16;
+
+		/// \brief pak of random files, mounted while it exists so the reads go through Data::ReadAsset() like the engine's do
+		class ScratchPak
+		{
+		private:
+			std::filesystem::path path;
+			std::vector<std::string> paths;
+
+		public:
+			ScratchPak()
+				: path(std::filesystem::temp_directory_path() / "EsteemBenchAssetIO.pak")
+			{
+				BenchmarkRandom random;
+				std::string contents(FileSize, '\0');
+
+				PakWriter writer;
+				writer.Open(path.string());
+				for (std::size_t i = 0; i < FileCount; ++i)
+				{
+					for (char& c : contents)
+						c = char(random.Next());
+
+					paths.push_back("bench/assetio/file_" + std::to_string(i) + ".bin");
+					writer.Add(paths.back(), contents, false);
+				}
+
+				writer.Close();
+				Data::MountPak(path.string());
+			}
+
+			~ScratchPak()
+			{
+				Data::UnmountPak(path.string());
+
+				std::error_code error;
+				std::filesystem::remove(path, error);
+			}
+
+			// disable copy
+			ScratchPak(const ScratchPak&) = delete;
+			void operator=(const ScratchPak&) = delete;
+
+			inline const std::vector<std::string>& GetPaths() const { return paths; }
+		};
+
+		/// \brief holds up the I/O thread that finishes the gate read until Open(), so the reads queued before it can't start
+		class Gate
+		{
+		private:
+			std::mutex lock;
+			std::condition_variable opened;
+			bool open;
+			AssetHandle handle;
+
+		public:
+			Gate(AssetIO& assetIO, const std::string& path)
+				: open(false)
+			{
+				handle = assetIO.Read(path, AssetPriority::CRITICAL, [this](const std::string&, bool)
+				{
+					std::unique_lock<std::mutex> guard(lock);
+					opened.wait(guard, [this]() { return open; });
+				});
+			}
+
+			// disable copy
+			Gate(const Gate&) = delete;
+			void operator=(const Gate&) = delete;
+
+			void Open()
+			{
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					open = true;
+				}
+
+				opened.notify_all();
+			}
+		};
+	}
+
+	/// \brief also checks that the reads stay intact while another pak is mounted and unmounted over and over
+	ESTEEM_BENCHMARK("AssetIO/Throughput", BenchAssetIOThroughput)
+	{
+		ScratchPak pak;
+		AssetIO assetIO;
+
+		std::vector<AssetHandle> handles;
+		std::size_t bytes = 0;
+
+		std::filesystem::path otherPath = std::filesystem::temp_directory_path() / "EsteemBenchAssetIOOther.pak";
+		{
+			PakWriter writer;
+			writer.Open(otherPath.string());
+			writer.Add("bench/assetio/other.bin", std::string(16, 'o'), false);
+			writer.Close();
+		}
+
+		// a higher priority goes in front of the scratch pak, so the paks move while the I/O threads search them
+		std::atomic<bool> reading(true);
+		std::size_t mounts = 0;
+		std::thread mounter([&]()
+		{
+			while (reading)
+			{
+				mounts += Data::MountPak(otherPath.string(), 1);
+				Data::UnmountPak(otherPath.string());
+			}
+		});
+
+		std::size_t wrongReads = 0;
+		for (const std::string& path : pak.GetPaths())
+			handles.push_back(assetIO.Read(path, AssetPriority::VISIBLE));
+
+		for (const AssetHandle& handle : handles)
+			wrongReads += handle.Wait().size() != FileSize;
+
+		reading = false;
+		mounter.join();
+
+		std::error_code error;
+		std::filesystem::remove(otherPath, error);
+
+		ESTEEM_BENCH_CHECK(mounts > 0, "the other pak could not be mounted");
+		ESTEEM_BENCH_CHECK(wrongReads == 0, std::to_string(wrongReads), " of ", std::to_string(FileCount), " reads failed while another pak was (un)mounted");
+
+		state.SetItems(FileCount);
+		state.Measure([&]()
+		{
+			handles.clear();
+			for (const std::string& path : pak.GetPaths())
+				handles.push_back(assetIO.Read(path, AssetPriority::VISIBLE));
+
+			for (const AssetHandle& handle : handles)
+				bytes += handle.Wait().size();
+
+			DoNotOptimize(bytes);
+		});
+
+		ESTEEM_BENCH_CHECK(bytes % (FileCount * FileSize) == 0, std::to_string(bytes), " bytes read, not a multiple of the ", std::to_string(FileCount * FileSize), " bytes in the pak");
+	}
+
+	/// \brief latency of a few critical reads queued behind a full prefetch queue
+	/// Also checks that with a single I/O thread every critical read finishes before any prefetch queued ahead of it.
+	ESTEEM_BENCHMARK("AssetIO/CriticalUnderLoad", BenchAssetIOCriticalUnderLoad)
+	{
+		ScratchPak pak;
+		const std::vector<std::string>& paths = pak.GetPaths();
+
+		// finish order per file, written by the only I/O thread and read once it's joined
+		std::vector<std::size_t> order(paths.size(), 0);
+		{
+			std::size_t finished = 0;
+			std::vector<AssetHandle> prefetchHandles;
+			std::vector<AssetHandle> criticalHandles;
+			AssetIO orderIO(1);
+			Gate gate(orderIO, paths[0]);
+
+			auto record = [&order, &finished](std::size_t index)
+			{
+				return [&order, &finished, index](const std::string&, bool) { order[index] = ++finished; };
+			};
+
+			for (std::size_t i = CriticalCount + 1; i < paths.size(); ++i)
+				prefetchHandles.push_back(orderIO.Read(paths[i], AssetPriority::PREFETCH, record(i)));
+
+			for (std::size_t i = 1; i <= CriticalCount; ++i)
+				criticalHandles.push_back(orderIO.Read(paths[i], AssetPriority::CRITICAL, record(i)));
+
+			gate.Open();
+
+			// the criticals first, waiting for a queued prefetch raises it to CRITICAL
+			for (const AssetHandle& handle : criticalHandles)
+				handle.Wait();
+
+			for (const AssetHandle& handle : prefetchHandles)
+				handle.Wait();
+		}
+
+		std::size_t lastCritical = 0, firstPrefetch = paths.size(), unfinished = 0;
+		for (std::size_t i = 1; i < paths.size(); ++i)
+		{
+			unfinished += order[i] == 0;
+			if (i <= CriticalCount)
+				lastCritical = std::max(lastCritical, order[i]);
+			else
+				firstPrefetch = std::min(firstPrefetch, order[i]);
+		}
+
+		ESTEEM_BENCH_CHECK(unfinished == 0, std::to_string(unfinished), " reads never finished");
+		ESTEEM_BENCH_CHECK(lastCritical < firstPrefetch, "critical read finished as ", std::to_string(lastCritical), "th while a prefetch queued before it finished as ", std::to_string(firstPrefetch), "th");
+
+		AssetIO assetIO;
+		std::vector<AssetHandle> prefetches;
+		std::vector<AssetHandle> criticals;
+		std::size_t bytes = 0;
+
+		state.SetItems(CriticalCount);
+		state.Measure([&]()
+		{
+			// dropping the previous prefetch handles cancels whatever was still queued
+			prefetches.clear();
+			criticals.clear();
+
+			for (std::size_t i = CriticalCount; i < paths.size(); ++i)
+				prefetches.push_back(assetIO.Read(paths[i], AssetPriority::PREFETCH));
+		},
+		[&]()
+		{
+			for (std::size_t i = 0; i < CriticalCount; ++i)
+				criticals.push_back(assetIO.Read(paths[i], AssetPriority::CRITICAL));
+
+			for (const AssetHandle& handle : criticals)
+				bytes += handle.Wait().size();
+
+			DoNotOptimize(bytes);
+		});
+	}
+
+	/// \brief also checks that dropping the handles of queued reads cancels them before they are read
+	ESTEEM_BENCHMARK("AssetIO/CancelPrefetch", BenchAssetIOCancelPrefetch)
+	{
+		ScratchPak pak;
+		const std::vector<std::string>& paths = pak.GetPaths();
+
+		// read after the I/O thread is joined
+		std::size_t cancelled = 0, completed = 0, callbacks = 0;
+		{
+			AssetIO cancelIO(1);
+			Gate gate(cancelIO, paths[0]);
+
+			for (std::size_t i = 2; i < paths.size(); ++i)
+				cancelIO.Read(paths[i], AssetPriority::PREFETCH, [&callbacks](const std::string&, bool) { ++callbacks; });
+
+			cancelled = cancelIO.GetCancelledReads();
+
+			// a read queued behind the cancelled ones, its callback sees every read that completed before it
+			// waited for through the callback, Wait() would raise it to CRITICAL and let it skip the queue
+			std::promise<void> lastRead;
+			AssetHandle last = cancelIO.Read(paths[1], AssetPriority::PREFETCH, [&completed, &cancelIO, &lastRead](const std::string&, bool)
+			{
+				completed = cancelIO.GetCompletedReads();
+				lastRead.set_value();
+			});
+
+			gate.Open();
+			lastRead.get_future().wait();
+		}
+
+		ESTEEM_BENCH_CHECK(cancelled == paths.size() - 2, std::to_string(cancelled), " of ", std::to_string(paths.size() - 2), " dropped reads were cancelled");
+		ESTEEM_BENCH_CHECK(completed == 2 && callbacks == 0, std::to_string(completed), " reads completed and ", std::to_string(callbacks), " callbacks were called, only the gate and the last read should have been read");
+
+		AssetIO assetIO;
+
+		state.SetItems(FileCount);
+		state.Measure([&]()
+		{
+			// every handle is a temporary, so the requests are cancelled right away unless a thread already took them
+			for (const std::string& path : paths)
+				assetIO.Read(path, AssetPriority::PREFETCH);
+		});
+
+		DoNotOptimize(assetIO.GetCancelledReads());
+	}
+}
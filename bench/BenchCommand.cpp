@@ -0,0 +1,48 @@
+#include "Benchmark.h"
+
+#include "General/Command.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		std::size_t commandCalls = 0;
+
+		void OnBenchCommand(const std::string& command, const std::string& value)
+		{
+			commandCalls += value.size();
+		}
+	}
+
+	ESTEEM_BENCHMARK("Command/ExecuteCommand", BenchCommandExecute)
+	{
+		constexpr std::size_t commandCount = 256;
+
+		// the listeners stay registered, Command is a process wide registry
+		static std::vector<std::string> commands;
+		if (commands.empty())
+		{
+			for (std::size_t i = 0; i < commandCount; ++i)
+			{
+				commands.push_back("bench_command_" + std::to_string(i));
+				Command::RegisterListener(commands.back(), DELEGATE(&OnBenchCommand));
+			}
+		}
+
+		BenchmarkRandom random;
+		std::vector<std::size_t> order(4096);
+		for (auto& index : order)
+			index = std::size_t(random.Between(0, int32_t(commandCount)));
+
+		const std::string value = "1";
+
+		state.SetItems(order.size());
+		state.Measure([&]()
+		{
+			for (std::size_t index : order)
+				Command::ExecuteCommand(commands[index], value);
+
+			DoNotOptimize(commandCalls);
+		});
+	}
+}
@@ -0,0 +1,158 @@
+#include "Benchmark.h"
+
+#include <cstring>
+
+#include "Rendering/CommandList.h"
+#include "Threading/JobSystem.h"
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t SceneDrawCount = 50000;
+		constexpr uint SceneVertexArrayCount = 64;
+		constexpr uint SceneBoneBufferCount = 16;
+
+		/// \brief draws as GLCommandBuffer::Record() would add them, a shadow pass where most meshes repeat a few times
+		struct Scene
+		{
+			std::vector<CommandList::State> states;
+			std::vector<CommandList::DrawIndirect> draws;
+			std::vector<CommandList::DrawData> drawData;
+
+			Scene()
+				: states(SceneDrawCount)
+				, draws(SceneDrawCount)
+				, drawData(SceneDrawCount)
+			{
+				BenchmarkRandom random;
+				for (std::size_t i = 0; i < SceneDrawCount; ++i)
+				{
+					CommandList::State& state = states[i];
+					if (i > 0 && random.Between(0, 2) == 0)
+						state = states[i - 1];
+					else
+					{
+						state = {};
+						state.vertexArray = uint(random.Between(0, int32_t(SceneVertexArrayCount))) + 1;
+						state.mode = 0x0004; // triangles
+						state.indexType = state.vertexArray % 4 == 0 ? 0 : 0x1405; // unsigned int
+						if (random.Between(0, 8) == 0)
+						{
+							state.boneBuffer = uint(random.Between(0, int32_t(SceneBoneBufferCount))) + 1;
+							state.boneBinding = 3;
+						}
+					}
+
+					draws[i] = { state.vertexArray * 36, 1, 0, 0, 0 };
+					drawData[i].modelMatrix = glm::mat4(1.f);
+					drawData[i].modelMatrix[3] = glm::vec4(random.Between(-500.f, 500.f), 0.f, random.Between(-500.f, 500.f), 1.f);
+				}
+			}
+
+			void Record(CommandList& list, JobSystem* jobSystem) const
+			{
+				list.Record(states.size(), [this](CommandList& list, std::size_t i)
+				{
+					list.Draw(states[i], draws[i], drawData[i]);
+				}, jobSystem);
+			}
+
+			/// \brief amount of batches when every change of state starts a new one
+			std::size_t CountStateChanges() const
+			{
+				std::size_t count = states.empty() ? 0 : 1;
+				for (std::size_t i = 1; i < states.size(); ++i)
+					count += states[i] != states[i - 1];
+
+				return count;
+			}
+		};
+
+		template<typename T>
+		bool Equal(const std::vector<T>& a, const std::vector<T>& b)
+		{
+			return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+		}
+
+		/// \brief the batches follow each other, hold the recorded draws and only merge draws with equal state
+		void CheckList(BenchmarkState& state, const Scene& scene, const CommandList& list)
+		{
+			if (list.GetBatches().size() != scene.CountStateChanges())
+				state.Fail(std::to_string(list.GetBatches().size()), " batches, expected ", std::to_string(scene.CountStateChanges()));
+
+			if (!Equal(list.GetDraws(), scene.draws) || !Equal(list.GetDrawData(), scene.drawData))
+				state.Fail("the draws differ from the ones recorded");
+
+			std::size_t next = 0;
+			for (const CommandList::Batch& batch : list.GetBatches())
+			{
+				if (batch.first != next || batch.count == 0)
+				{
+					state.Fail("batch at draw ", std::to_string(batch.first), " doesn't follow draw ", std::to_string(next));
+					return;
+				}
+
+				for (uint32_t i = batch.first; i < batch.first + batch.count && i < scene.states.size(); ++i)
+				{
+					if (scene.states[i] != batch.state)
+					{
+						state.Fail("draw ", std::to_string(i), " is merged into a batch with another state");
+						break;
+					}
+				}
+
+				next += batch.count;
+			}
+
+			if (next != scene.states.size())
+				state.Fail("batches cover ", std::to_string(next), " of ", std::to_string(scene.states.size()), " draws");
+		}
+	}
+
+	ESTEEM_BENCHMARK("CommandList/RecordSerial", BenchCommandListRecordSerial)
+	{
+		Scene scene;
+		CommandList list;
+
+		state.SetItems(scene.states.size());
+		state.Measure([&]()
+		{
+			scene.Record(list, nullptr);
+			DoNotOptimize(list.GetBatches().front());
+		});
+
+		CheckList(state, scene, list);
+	}
+
+	/// \brief records in slices on the job threads, the result has to be the same as a serial recording
+	ESTEEM_BENCHMARK("CommandList/RecordParallel", BenchCommandListRecordParallel)
+	{
+		Scene scene;
+		JobSystem jobSystem;
+
+		CommandList serial;
+		scene.Record(serial, nullptr);
+
+		CommandList list;
+		state.SetItems(scene.states.size());
+		state.Measure([&]()
+		{
+			scene.Record(list, &jobSystem);
+			DoNotOptimize(list.GetBatches().front());
+		});
+
+		CheckList(state, scene, list);
+
+		if (!Equal(list.GetBatches(), serial.GetBatches()) || !Equal(list.GetDraws(), serial.GetDraws()) || !Equal(list.GetDrawData(), serial.GetDrawData()))
+			state.Fail("the parallel recording differs from the serial one");
+
+		// recording again into the same list reuses the slices and gives the same result
+		scene.Record(list, &jobSystem);
+		if (!Equal(list.GetBatches(), serial.GetBatches()))
+			state.Fail("recording twice gives different batches");
+
+		Debug::Log("CommandList/RecordParallel: ", std::to_string(scene.states.size()), " draws in ", std::to_string(list.GetBatches().size()), " batches");
+	}
+}
@@ -0,0 +1,125 @@
+#include "Benchmark.h"
+
+#include <vector>
+
+#include "World/Constituents/ConstituentTable.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t TableCount = 10000;
+
+		/// \brief laid out like AbstractConstituent, Collider, RigidBody and StaticBody, without needing a physics world
+		class BenchConstituent
+		{
+		public:
+			virtual ~BenchConstituent() = default;
+		};
+
+		class BenchCollider : public BenchConstituent { };
+		class BenchRigidBody final : public BenchCollider { };
+		class BenchStaticBody final : public BenchCollider { };
+		class BenchAnimator final : public BenchConstituent { };
+		/// \brief only ever added through a base pointer, nothing may ask for its id or mask statically before that
+		class BenchKinematicBody final : public BenchCollider { };
+	}
+
+	template<>
+	struct ConstituentBases<BenchRigidBody>
+	{
+		typedef std::tuple<BenchCollider> Types;
+		static inline const ConstituentBasesRegistrar<BenchRigidBody, Types> registrar;
+	};
+
+	template<>
+	struct ConstituentBases<BenchStaticBody>
+	{
+		typedef std::tuple<BenchCollider> Types;
+		static inline const ConstituentBasesRegistrar<BenchStaticBody, Types> registrar;
+	};
+
+	template<>
+	struct ConstituentBases<BenchKinematicBody>
+	{
+		typedef std::tuple<BenchCollider> Types;
+		static inline const ConstituentBasesRegistrar<BenchKinematicBody, Types> registrar;
+	};
+
+	/// \brief also checks the lookups through bases, dynamic types and after removing the constituent that owned a base
+	ESTEEM_BENCHMARK("Constituents/GetCollider", BenchConstituentsGetCollider)
+	{
+		typedef ConstituentTable<BenchConstituent> Table;
+
+		// first sight of the type is its dynamic type, its bases are known nonetheless
+		{
+			Table table;
+			cgc::strong_ptr<BenchKinematicBody> kinematicBody = cgc::construct_new<BenchKinematicBody>();
+			table.Add(cgc::strong_ptr<BenchConstituent>(kinematicBody));
+
+			ESTEEM_BENCH_CHECK(table.Get<BenchCollider>().ptr() == kinematicBody.ptr(), "a KinematicBody only seen through a base pointer isn't found as Collider");
+			ESTEEM_BENCH_CHECK(table.Get<BenchKinematicBody>().ptr() == kinematicBody.ptr(), "a KinematicBody only seen through a base pointer isn't found as KinematicBody");
+		}
+
+		// asking for a Collider returns the RigidBody
+		{
+			Table table;
+			cgc::strong_ptr<BenchRigidBody> rigidBody = cgc::construct_new<BenchRigidBody>();
+			table.Add(rigidBody);
+
+			ESTEEM_BENCH_CHECK(table.Get<BenchCollider>().ptr() == rigidBody.ptr(), "the Collider lookup doesn't return the RigidBody");
+			ESTEEM_BENCH_CHECK(table.Get<BenchRigidBody>().ptr() == rigidBody.ptr(), "the RigidBody lookup doesn't return the RigidBody");
+			ESTEEM_BENCH_CHECK(!table.Has<BenchStaticBody>(), "a StaticBody is found while only a RigidBody was added");
+		}
+
+		// added through a base pointer, it's still found by its concrete type
+		{
+			Table table;
+			cgc::strong_ptr<BenchRigidBody> rigidBody = cgc::construct_new<BenchRigidBody>();
+			table.Add(cgc::strong_ptr<BenchConstituent>(rigidBody));
+
+			ESTEEM_BENCH_CHECK(table.Get<BenchRigidBody>().ptr() == rigidBody.ptr(), "a RigidBody added as a base isn't found as RigidBody");
+			ESTEEM_BENCH_CHECK(table.Get<BenchCollider>().ptr() == rigidBody.ptr(), "a RigidBody added as a base isn't found as Collider");
+			ESTEEM_BENCH_CHECK(!table.Add(cgc::construct_new<BenchRigidBody>()), "a second RigidBody was added");
+		}
+
+		// the Collider moves to the StaticBody once the RigidBody that had it is removed
+		{
+			Table table;
+			cgc::strong_ptr<BenchRigidBody> rigidBody = cgc::construct_new<BenchRigidBody>();
+			cgc::strong_ptr<BenchStaticBody> staticBody = cgc::construct_new<BenchStaticBody>();
+			table.Add(rigidBody);
+			table.Add(staticBody);
+			ESTEEM_BENCH_CHECK(table.Get<BenchCollider>().ptr() == rigidBody.ptr(), "the Collider isn't the first one added");
+
+			table.Remove<BenchRigidBody>();
+			ESTEEM_BENCH_CHECK(!table.Has<BenchRigidBody>(), "the RigidBody is still found after removing it");
+			ESTEEM_BENCH_CHECK(table.Get<BenchCollider>().ptr() == staticBody.ptr(), "the Collider isn't reassigned to the StaticBody");
+			ESTEEM_BENCH_CHECK(table.Get<BenchStaticBody>().ptr() == staticBody.ptr(), "the StaticBody is lost after removing the RigidBody");
+		}
+
+		// half of the tables have a RigidBody, the others a StaticBody, all of them an Animator
+		std::vector<Table> tables(TableCount);
+		for (std::size_t i = 0; i < TableCount; ++i)
+		{
+			tables[i].Add(cgc::construct_new<BenchAnimator>());
+			if (i & 1)
+				tables[i].Add(cgc::construct_new<BenchRigidBody>());
+			else
+				tables[i].Add(cgc::construct_new<BenchStaticBody>());
+		}
+
+		state.SetItems(TableCount);
+		state.Measure([&]()
+		{
+			std::size_t found = 0;
+			for (const Table& table : tables)
+			{
+				if (table.Get<BenchCollider>())
+					++found;
+			}
+
+			DoNotOptimize(found);
+		});
+	}
+}
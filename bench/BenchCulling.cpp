@@ -0,0 +1,540 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Culling/CullingCheckers/FrustumCullingChecker.h"
+#include "Culling/CullingCheckers/ZHierarchyCullingChecker.h"
+#include "Culling/CullingAdders/OctreeCullingAdder.h"
+#include "Math/Math.h"
+#include "Threading/JobSystem.h"
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		/// \brief random boxes around the camera laid out for RangeOfObjectsCheck
+		struct BoxArrays
+		{
+			std::vector<float> arrays[6];
+
+			BoxArrays(std::size_t count)
+			{
+				BenchmarkRandom random;
+				for (auto& array : arrays)
+					array.resize(count);
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					arrays[0][i] = random.Between(-1000.f, 1000.f);
+					arrays[1][i] = random.Between(-100.f, 100.f);
+					arrays[2][i] = random.Between(-1000.f, 1000.f);
+					arrays[3][i] = random.Between(0.5f, 10.f);
+					arrays[4][i] = random.Between(0.5f, 10.f);
+					arrays[5][i] = random.Between(0.5f, 10.f);
+				}
+			}
+
+			CullingBoxes GetBoxes() const
+			{
+				return { arrays[0].data(), arrays[1].data(), arrays[2].data(), arrays[3].data(), arrays[4].data(), arrays[5].data(), arrays[0].size() };
+			}
+		};
+
+		/// \brief walls standing on a large floor in front of the camera, with boxes scattered between them
+		struct OcclusionScene
+		{
+			glm::vec3 eye;
+			glm::mat4 viewProjection;
+			std::vector<Occluder> occluders;
+			std::vector<float> boxes[6];
+
+			OcclusionScene(std::size_t boxCount)
+				: eye(0.f, 2.f, 0.f)
+			{
+				glm::mat4 projection = glm::perspective(glm::radians(70.f), 2.f, 0.1f, 500.f);
+				viewProjection = projection * glm::lookAt(eye, glm::vec3(0.f, 2.f, -10.f), glm::vec3(0.f, 1.f, 0.f));
+
+				BenchmarkRandom random;
+				occluders.resize(60);
+				for (auto& wall : occluders)
+				{
+					glm::vec3 center(random.Between(-60.f, 60.f), random.Between(-2.f, 6.f), random.Between(-120.f, -5.f));
+					float angle = random.Between(0.f, 3.14159f);
+					glm::vec3 side = glm::vec3(std::cos(angle), 0.f, std::sin(angle)) * random.Between(2.f, 15.f);
+					glm::vec3 up(0.f, random.Between(2.f, 10.f), 0.f);
+
+					wall.vertices = { center - side - up, center + side - up, center + side + up, center - side + up };
+					wall.indices = { 0, 1, 2, 0, 2, 3 };
+				}
+
+				// reaches behind the camera, so it gets clipped
+				Occluder floor;
+				floor.vertices = { { -500.f, -1.f, 500.f }, { 500.f, -1.f, 500.f }, { 500.f, -1.f, -500.f }, { -500.f, -1.f, -500.f } };
+				floor.indices = { 0, 1, 2, 0, 2, 3 };
+				occluders.push_back(floor);
+
+				for (auto& array : boxes)
+					array.resize(boxCount);
+
+				for (std::size_t i = 0; i < boxCount; ++i)
+				{
+					boxes[0][i] = random.Between(-80.f, 80.f);
+					boxes[1][i] = random.Between(-0.5f, 6.f);
+					boxes[2][i] = random.Between(-150.f, -2.f);
+					boxes[3][i] = random.Between(0.1f, 2.f);
+					boxes[4][i] = random.Between(0.1f, 2.f);
+					boxes[5][i] = random.Between(0.1f, 2.f);
+				}
+			}
+
+			CullingBoxes GetBoxes() const
+			{
+				return { boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(), boxes[5].data(), boxes[0].size() };
+			}
+
+			/// \brief distance along the ray to the box, negative when it's missed
+			static float RayBox(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& min, const glm::vec3& max)
+			{
+				float near = 0.f, far = std::numeric_limits<float>::max();
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					float invDirection = 1.f / direction[axis];
+					float from = (min[axis] - origin[axis]) * invDirection;
+					float to = (max[axis] - origin[axis]) * invDirection;
+					near = std::max(near, std::min(from, to));
+					far = std::min(far, std::max(from, to));
+				}
+
+				return near <= far ? near : -1.f;
+			}
+
+			/// \brief distance along the ray to the triangle, negative when it's missed
+			/// The triangle is grown a little, so precision differences at the edges can only make the reference hide more.
+			static float RayTriangle(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+			{
+				constexpr float margin = 1e-3f;
+
+				glm::vec3 edge1 = b - a, edge2 = c - a;
+				glm::vec3 p = glm::cross(direction, edge2);
+				float determinant = glm::dot(edge1, p);
+				if (std::abs(determinant) < 1e-12f)
+					return -1.f;
+
+				float invDeterminant = 1.f / determinant;
+				glm::vec3 t = origin - a;
+				float u = glm::dot(t, p) * invDeterminant;
+				if (u < -margin || u > 1.f + margin)
+					return -1.f;
+
+				glm::vec3 q = glm::cross(t, edge1);
+				float v = glm::dot(direction, q) * invDeterminant;
+				if (v < -margin || u + v > 1.f + margin)
+					return -1.f;
+
+				return glm::dot(edge2, q) * invDeterminant;
+			}
+
+			/// \brief brute force: a ray through the center of every pixel the box touches, visible when one reaches it first
+			bool IsVisibleReference(std::size_t i) const
+			{
+				glm::vec3 center(boxes[0][i], boxes[1][i], boxes[2][i]);
+				glm::vec3 extent(boxes[3][i], boxes[4][i], boxes[5][i]);
+				glm::vec3 min = center - extent, max = center + extent;
+
+				float left = std::numeric_limits<float>::max(), right = std::numeric_limits<float>::lowest();
+				float bottom = left, top = right;
+				for (int corner = 0; corner < 8; ++corner)
+				{
+					glm::vec4 clip = viewProjection * glm::vec4(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z, 1.f);
+					if (clip.w <= ZHierarchyCullingChecker::NearW)
+						return true;
+
+					float x = (clip.x / clip.w * 0.5f + 0.5f) * ZHierarchyCullingChecker::Width;
+					float y = (clip.y / clip.w * 0.5f + 0.5f) * ZHierarchyCullingChecker::Height;
+					left = std::min(left, x);
+					right = std::max(right, x);
+					bottom = std::min(bottom, y);
+					top = std::max(top, y);
+				}
+
+				glm::mat4 inverse = glm::inverse(viewProjection);
+				int minX = std::max(0, int(std::floor(left))), maxX = std::min(int(ZHierarchyCullingChecker::Width) - 1, int(std::floor(right)));
+				int minY = std::max(0, int(std::floor(bottom))), maxY = std::min(int(ZHierarchyCullingChecker::Height) - 1, int(std::floor(top)));
+
+				for (int y = minY; y <= maxY; ++y)
+				{
+					for (int x = minX; x <= maxX; ++x)
+					{
+						glm::vec4 far = inverse * glm::vec4((x + 0.5f) / ZHierarchyCullingChecker::Width * 2.f - 1.f, (y + 0.5f) / ZHierarchyCullingChecker::Height * 2.f - 1.f, 1.f, 1.f);
+						glm::vec3 direction = glm::vec3(far) / far.w - eye;
+
+						float boxDistance = RayBox(eye, direction, min, max);
+						if (boxDistance < 0.f)
+							continue;
+
+						bool hidden = false;
+						for (const auto& occluder : occluders)
+						{
+							for (std::size_t t = 0; t + 2 < occluder.indices.size() && !hidden; t += 3)
+							{
+								float distance = RayTriangle(eye, direction, occluder.vertices[occluder.indices[t]], occluder.vertices[occluder.indices[t + 1]], occluder.vertices[occluder.indices[t + 2]]);
+								hidden = distance > 0.f && distance < boxDistance;
+							}
+						}
+
+						if (!hidden)
+							return true;
+					}
+				}
+
+				return false;
+			}
+		};
+
+		FrustumCullingChecker CreateFrustum()
+		{
+			glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 800.f);
+			glm::mat4 view = glm::lookAt(glm::vec3(0.f, 20.f, 0.f), glm::vec3(100.f, 10.f, 100.f), glm::vec3(0.f, 1.f, 0.f));
+
+			FrustumCullingChecker frustum;
+			frustum.CalculateFrustum(projection * view);
+			return frustum;
+		}
+
+		/// \brief static objects spread over a town sized area, lit by point and spot lights of different ranges
+		struct ShadowScene
+		{
+			typedef OctreeCullingAdder<Partitioning::OctreeNodeWrapping::TIGHT> StaticCullingAdder;
+
+			StaticCullingAdder adder;
+			// declared after the adder, so they leave it before it's destroyed
+			std::vector<std::unique_ptr<CullingObject>> objects;
+			std::vector<LightData> lights;
+
+			ShadowScene(std::size_t objectCount, std::size_t lightCount)
+				: adder(nullptr, nullptr)
+			{
+				BenchmarkRandom random;
+				adder.TrackChanges();
+
+				objects.reserve(objectCount);
+				for (std::size_t i = 0; i < objectCount; ++i)
+				{
+					glm::vec3 center(random.Between(-1000.f, 1000.f), random.Between(0.f, 30.f), random.Between(-1000.f, 1000.f));
+					glm::vec3 halfVolume(random.Between(0.5f, 8.f), random.Between(0.5f, 8.f), random.Between(0.5f, 8.f));
+					objects.push_back(std::make_unique<CullingObject>(std::vector<cgc::strong_ptr<RenderObject>>(), center, halfVolume, CullingObject::Type::STATIC));
+					adder.RegisterCullingObject(objects.back().get());
+				}
+
+				lights.resize(lightCount);
+				for (std::size_t i = 0; i < lightCount; ++i)
+				{
+					LightData& light = lights[i];
+					light.type = i % 4 == 3 ? LightData::LightType::SPOT : LightData::LightType::POINT;
+					light.position = glm::vec3(random.Between(-1000.f, 1000.f), random.Between(2.f, 20.f), random.Between(-1000.f, 1000.f));
+					light.forward = glm::normalize(glm::vec3(random.Between(-1.f, 1.f), random.Between(-1.f, -0.2f), random.Between(-1.f, 1.f)));
+					light.distance = random.Between(10.f, 80.f);
+				}
+			}
+
+			void CalculateFaces(const LightData& light, FrustumCullingChecker* faces) const
+			{
+				for (uint face = 0; face < light.GetShadowFaceCount(); ++face)
+					faces[face].CalculateFrustum(light.GetShadowMatrix(face));
+			}
+
+			/// \brief every object against every face, what the octree query has to match
+			void QueryFacesReference(const LightData& light, const FrustumCullingChecker* faces, std::vector<const CullingObject*>* casters) const
+			{
+				for (const auto& object : objects)
+				{
+					const AxisAlignedBox& aab = object->GetAABB();
+					if (!Math::BoxOverlapsSphere(aab.begin, aab.end, light.position, light.distance))
+						continue;
+
+					for (uint face = 0; face < light.GetShadowFaceCount(); ++face)
+					{
+						if (faces[face].ClassifyBox(aab) != FrustumIntersection::OUTSIDE)
+							casters[face].push_back(object.get());
+					}
+				}
+			}
+		};
+	}
+
+	ESTEEM_BENCHMARK("Culling/CubeInFrustum", BenchCubeInFrustum)
+	{
+		constexpr std::size_t boxCount = 100000;
+
+		BenchmarkRandom random;
+		std::vector<AxisAlignedBox> boxes(boxCount);
+		for (auto& box : boxes)
+		{
+			glm::vec3 center(random.Between(-1000.f, 1000.f), random.Between(-100.f, 100.f), random.Between(-1000.f, 1000.f));
+			glm::vec3 halfSize(random.Between(0.5f, 10.f), random.Between(0.5f, 10.f), random.Between(0.5f, 10.f));
+			box = AxisAlignedBox(center - halfSize, center + halfSize);
+		}
+
+		glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 800.f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.f, 20.f, 0.f), glm::vec3(100.f, 10.f, 100.f), glm::vec3(0.f, 1.f, 0.f));
+
+		FrustumCullingChecker frustum;
+		frustum.CalculateFrustum(projection * view);
+
+		state.SetItems(boxes.size());
+		state.Measure([&]()
+		{
+			std::size_t visible = 0;
+			for (auto& box : boxes)
+				visible += frustum.CubeInFrustum(box.begin, box.end);
+
+			DoNotOptimize(visible);
+		});
+	}
+
+	/// \brief also checks the SIMD path against the scalar one and the corner test
+	ESTEEM_BENCHMARK("Culling/RangeOfObjectsCheck", BenchRangeOfObjectsCheck)
+	{
+		constexpr std::size_t boxCount = 1000000;
+
+		BoxArrays arrays(boxCount);
+		CullingBoxes boxes = arrays.GetBoxes();
+		FrustumCullingChecker frustum = CreateFrustum();
+
+		std::size_t wordCount = (boxCount + 63) / 64;
+		std::vector<uint64_t> visible(wordCount), inside(wordCount);
+		std::vector<uint64_t> expectedVisible(wordCount), expectedInside(wordCount);
+
+		frustum.RangeOfObjectsCheck(boxes, visible.data(), inside.data());
+		frustum.RangeOfObjectsCheckScalar(boxes, expectedVisible.data(), expectedInside.data());
+
+		std::size_t mismatches = 0, cornerMismatches = 0, visibleCount = 0, insideCount = 0;
+		for (std::size_t i = 0; i < boxCount; ++i)
+		{
+			uint64_t bit = uint64_t(1) << (i % 64);
+			bool isVisible = visible[i / 64] & bit;
+			bool isInside = inside[i / 64] & bit;
+
+			if (isVisible != bool(expectedVisible[i / 64] & bit) || isInside != bool(expectedInside[i / 64] & bit) || (isInside && !isVisible))
+				++mismatches;
+
+			glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+			glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+
+			// boxes touching a plane may round differently in the corner test, only compare the clear cases
+			glm::vec3 shrunk = extent * 0.999f, grown = extent * 1.001f;
+			bool cornerVisible = frustum.CubeInFrustum(center - extent, center + extent);
+			if (frustum.CubeInFrustum(center - shrunk, center + shrunk) == frustum.CubeInFrustum(center - grown, center + grown) && isVisible != cornerVisible)
+				++cornerMismatches;
+
+			visibleCount += isVisible;
+			insideCount += isInside;
+		}
+
+		if (mismatches)
+			state.Fail(std::to_string(mismatches), " boxes differ from the scalar path");
+		if (cornerMismatches)
+			state.Fail(std::to_string(cornerMismatches), " boxes differ from CubeInFrustum");
+		if (visibleCount == 0 || insideCount == 0 || visibleCount == boxCount)
+			state.Fail("the boxes don't cover all cases, ", std::to_string(visibleCount), " visible and ", std::to_string(insideCount), " inside");
+
+		state.SetItems(boxCount);
+		state.Measure([&]()
+		{
+			frustum.RangeOfObjectsCheck(boxes, visible.data(), inside.data());
+			DoNotOptimize(visible);
+		});
+	}
+
+	ESTEEM_BENCHMARK("Culling/RangeOfObjectsCheckScalar", BenchRangeOfObjectsCheckScalar)
+	{
+		constexpr std::size_t boxCount = 1000000;
+
+		BoxArrays arrays(boxCount);
+		CullingBoxes boxes = arrays.GetBoxes();
+		FrustumCullingChecker frustum = CreateFrustum();
+
+		std::vector<uint64_t> visible((boxCount + 63) / 64), inside((boxCount + 63) / 64);
+
+		state.SetItems(boxCount);
+		state.Measure([&]()
+		{
+			frustum.RangeOfObjectsCheckScalar(boxes, visible.data(), inside.data());
+			DoNotOptimize(visible);
+		});
+	}
+
+	ESTEEM_BENCHMARK("Culling/OcclusionRender", BenchOcclusionRender)
+	{
+		OcclusionScene scene(0);
+		JobSystem jobSystem;
+
+		ZHierarchyCullingChecker occlusion;
+		for (const auto& occluder : scene.occluders)
+			occlusion.AddOccluder(&occluder);
+
+		state.SetItems(scene.occluders.size());
+		state.Measure([&]()
+		{
+			occlusion.RenderOccluders(scene.viewProjection, nullptr, &jobSystem);
+			DoNotOptimize(occlusion.GetDepthBuffer());
+		});
+	}
+
+	/// \brief also compares the result with a ray traced reference, boxes may only be hidden when no ray reaches them
+	ESTEEM_BENCHMARK("Culling/OcclusionTest", BenchOcclusionTest)
+	{
+		constexpr std::size_t boxCount = 100000;
+		constexpr std::size_t referenceCount = 5000;
+
+		OcclusionScene scene(boxCount);
+		CullingBoxes boxes = scene.GetBoxes();
+
+		ZHierarchyCullingChecker occlusion;
+		for (const auto& occluder : scene.occluders)
+			occlusion.AddOccluder(&occluder);
+
+		occlusion.RenderOccluders(scene.viewProjection);
+
+		FrustumCullingChecker frustum;
+		frustum.CalculateFrustum(scene.viewProjection);
+
+		std::vector<uint64_t> visible((boxCount + 63) / 64), inFrustum((boxCount + 63) / 64);
+		occlusion.RangeOfObjectsCheck(boxes, visible.data());
+		frustum.RangeOfObjectsCheck(boxes, inFrustum.data());
+
+		std::size_t tested = 0, hidden = 0, wronglyHidden = 0, wronglyVisible = 0, pathMismatches = 0;
+		for (std::size_t i = 0; i < referenceCount; ++i)
+		{
+			bool isVisible = visible[i / 64] & (uint64_t(1) << (i % 64));
+			glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+			glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+			pathMismatches += occlusion.IsBoxVisible(center, extent) != isVisible;
+
+			if (!(inFrustum[i / 64] & (uint64_t(1) << (i % 64))))
+				continue;
+
+			bool reference = scene.IsVisibleReference(i);
+			++tested;
+			hidden += !isVisible;
+			wronglyHidden += reference && !isVisible;
+			wronglyVisible += !reference && isVisible;
+		}
+
+		if (wronglyHidden)
+			state.Fail(std::to_string(wronglyHidden), " of ", std::to_string(tested), " boxes were hidden while the reference can see them");
+		if (pathMismatches)
+			state.Fail(std::to_string(pathMismatches), " boxes differ between the SIMD and scalar path");
+		if (hidden == 0)
+			state.Fail("nothing was hidden, the scene doesn't test anything");
+		else
+			Debug::Log("Culling/OcclusionTest: ", std::to_string(hidden), " of ", std::to_string(tested), " boxes hidden, ", std::to_string(wronglyVisible), " could have been hidden as well");
+
+		state.SetItems(boxCount);
+		state.Measure([&]()
+		{
+			occlusion.RangeOfObjectsCheck(boxes, visible.data());
+			DoNotOptimize(visible);
+		});
+	}
+
+	/// \brief also compares the casters of every face with a brute force test, and checks that moving an object is noticed
+	ESTEEM_BENCHMARK("Culling/ShadowCasters", BenchShadowCasters)
+	{
+		ShadowScene scene(20000, 64);
+
+		FrustumCullingChecker faces[6];
+		std::array<std::vector<const CullingObject*>, 6> casters, reference;
+
+		std::size_t mismatches = 0, found = 0;
+		for (const LightData& light : scene.lights)
+		{
+			scene.CalculateFaces(light, faces);
+			for (auto& list : casters)
+				list.clear();
+			for (auto& list : reference)
+				list.clear();
+
+			scene.adder.QueryFaces(light.position, light.distance, faces, light.GetShadowFaceCount(), casters.data());
+			scene.QueryFacesReference(light, faces, reference.data());
+
+			for (uint face = 0; face < light.GetShadowFaceCount(); ++face)
+			{
+				std::sort(casters[face].begin(), casters[face].end());
+				std::sort(reference[face].begin(), reference[face].end());
+				mismatches += casters[face] != reference[face];
+				found += reference[face].size();
+			}
+		}
+
+		if (mismatches)
+			state.Fail(std::to_string(mismatches), " faces have different casters than the brute force test");
+		if (found == 0)
+			state.Fail("no light has any casters, the scene doesn't test anything");
+
+		// a moved static object has to be reported where it was and where it is now, and nowhere else
+		scene.adder.ClearChanges();
+		CullingObject& moved = *scene.objects.front();
+		AxisAlignedBox before = moved.GetAABB();
+		moved.SetCenter(moved.GetCenter() + glm::vec3(100.f, 0.f, 0.f));
+		moved.RecalculateAABB();
+		moved.TransformUpdate();
+
+		// translated objects are queued, the clean up records them
+		scene.adder.CleanUp();
+
+		auto sameBox = [](const AxisAlignedBox& a, const AxisAlignedBox& b) { return a.begin == b.begin && a.end == b.end; };
+		const std::vector<AxisAlignedBox>& changes = scene.adder.GetChanges();
+		bool reportedBefore = std::any_of(changes.begin(), changes.end(), [&](const AxisAlignedBox& change) { return sameBox(change, before); });
+		bool reportedAfter = std::any_of(changes.begin(), changes.end(), [&](const AxisAlignedBox& change) { return sameBox(change, moved.GetAABB()); });
+		std::size_t others = std::count_if(changes.begin(), changes.end(), [&](const AxisAlignedBox& change) { return !sameBox(change, before) && !sameBox(change, moved.GetAABB()); });
+
+		if (!reportedBefore || !reportedAfter)
+			state.Fail("moving a static object wasn't recorded as a change");
+		if (others != 0)
+			state.Fail(std::to_string(others), " recorded changes aren't the old or new bounds of the moved object");
+
+		state.SetItems(scene.lights.size());
+		state.Measure([&]()
+		{
+			for (const LightData& light : scene.lights)
+			{
+				scene.CalculateFaces(light, faces);
+				for (auto& list : casters)
+					list.clear();
+
+				scene.adder.QueryFaces(light.position, light.distance, faces, light.GetShadowFaceCount(), casters.data());
+			}
+
+			DoNotOptimize(casters);
+		});
+	}
+
+	ESTEEM_BENCHMARK("Culling/ShadowCastersBruteForce", BenchShadowCastersBruteForce)
+	{
+		ShadowScene scene(20000, 64);
+
+		FrustumCullingChecker faces[6];
+		std::array<std::vector<const CullingObject*>, 6> casters;
+
+		state.SetItems(scene.lights.size());
+		state.Measure([&]()
+		{
+			for (const LightData& light : scene.lights)
+			{
+				scene.CalculateFaces(light, faces);
+				for (auto& list : casters)
+					list.clear();
+
+				scene.QueryFacesReference(light, faces, casters.data());
+			}
+
+			DoNotOptimize(casters);
+		});
+	}
+}
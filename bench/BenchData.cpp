@@ -0,0 +1,112 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <fstream>
+#include "minizip/zip.h"
+
+#include "Utils/Data.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t AssetCount = 64;
+		constexpr std::size_t AssetSize = 64 * 1024;
+
+		/// \brief switches into a scratch directory holding a mounted data.pak and loose copies of the same assets
+		/// Data looks both up relative to ROOT_PATH, so the working directory is changed for the lifetime of this object.
+		class ScratchAssets
+		{
+		private:
+			std::filesystem::path previousPath;
+			std::filesystem::path scratchPath;
+
+		public:
+			ScratchAssets(bool loose)
+				: previousPath(std::filesystem::current_path())
+				, scratchPath(std::filesystem::temp_directory_path() / "EsteemBench")
+			{
+				std::filesystem::remove_all(scratchPath);
+				std::filesystem::create_directories(scratchPath);
+				std::filesystem::current_path(scratchPath);
+
+				BenchmarkRandom random;
+				std::string contents(AssetSize, '\0');
+
+				zipFile zip = zipOpen("data.pak", APPEND_STATUS_CREATE);
+				if (loose)
+					std::filesystem::create_directories("bench");
+
+				for (std::size_t i = 0; i < AssetCount; ++i)
+				{
+					// half random, half repeating, so deflate has some work to do
+					for (std::size_t c = 0; c < AssetSize; ++c)
+						contents[c] = c < AssetSize / 2 ? char(random.Next()) : char(c & 0x3F);
+
+					std::string name = GetAssetPath(i);
+					if (zip != nullptr && zipOpenNewFileInZip(zip, name.c_str(), nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_DEFAULT_COMPRESSION) == ZIP_OK)
+					{
+						zipWriteInFileInZip(zip, contents.data(), uint(contents.size()));
+						zipCloseFileInZip(zip);
+					}
+
+					if (loose)
+						std::ofstream(name, std::ios::binary).write(contents.data(), contents.size());
+				}
+
+				if (zip != nullptr)
+					zipClose(zip, nullptr);
+
+				Data::MountPak("data.pak");
+			}
+
+			~ScratchAssets()
+			{
+				Data::UnmountPak("data.pak");
+				std::filesystem::current_path(previousPath);
+
+				std::error_code error;
+				std::filesystem::remove_all(scratchPath, error);
+			}
+
+			// disable copy
+			ScratchAssets(const ScratchAssets&) = delete;
+			void operator=(const ScratchAssets&) = delete;
+
+			static std::string GetAssetPath(std::size_t index)
+			{
+				return "bench/asset_" + std::to_string(index) + ".bin";
+			}
+		};
+
+		void ReadAllAssets(BenchmarkState& state)
+		{
+			std::vector<std::string> paths;
+			for (std::size_t i = 0; i < AssetCount; ++i)
+				paths.push_back(ScratchAssets::GetAssetPath(i));
+
+			std::size_t bytes = 0;
+
+			state.SetItems(AssetCount);
+			state.Measure([&]()
+			{
+				for (const std::string& path : paths)
+					bytes += Data::ReadAsset(path).size();
+
+				DoNotOptimize(bytes);
+			});
+		}
+	}
+
+	ESTEEM_BENCHMARK("Data/ReadAssetPak", BenchDataReadAssetPak)
+	{
+		ScratchAssets assets(false);
+		ReadAllAssets(state);
+	}
+
+	ESTEEM_BENCHMARK("Data/ReadAssetLoose", BenchDataReadAssetLoose)
+	{
+		ScratchAssets assets(true);
+		ReadAllAssets(state);
+	}
+}
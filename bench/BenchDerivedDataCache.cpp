@@ -0,0 +1,306 @@
+#include "Benchmark.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+#include "Utils/DerivedDataCache.h"
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t EntryCount = 256;
+		constexpr std::size_t EntrySize = 64 * 1024;
+		/// \brief entries every process of the DerivedDataCacheWriters test writes
+		constexpr std::size_t SharedCount = 64;
+
+		/// \brief an empty cache directory that is removed again afterwards
+		class ScratchCache
+		{
+		private:
+			std::filesystem::path path;
+
+		public:
+			DerivedDataCache cache;
+
+			ScratchCache(uint64_t maxSize = DerivedDataCache::DefaultMaxSize)
+				: path(std::filesystem::temp_directory_path() / "EsteemBenchDerivedData")
+			{
+				std::error_code error;
+				std::filesystem::remove_all(path, error);
+				cache.Open(path.string(), maxSize);
+			}
+
+			~ScratchCache()
+			{
+				cache.Close();
+				SetReadOnly(false);
+
+				std::error_code error;
+				std::filesystem::remove_all(path, error);
+			}
+
+			// disable copy
+			ScratchCache(const ScratchCache&) = delete;
+			void operator=(const ScratchCache&) = delete;
+
+			uint64_t GetDirectorySize() const
+			{
+				uint64_t size = 0;
+				std::error_code error;
+				for (auto& entry : std::filesystem::recursive_directory_iterator(path, error))
+				{
+					if (entry.is_regular_file(error))
+						size += entry.file_size(error);
+				}
+
+				return size;
+			}
+
+			std::filesystem::path GetEntryPath(const DerivedDataCache::Key& key) const
+			{
+				std::string name = key.ToString();
+				return path / name.substr(0, 2) / (name + ".ddc");
+			}
+
+			inline const std::filesystem::path& GetPath() const { return path; }
+
+			/// \brief chmod 0555 the directory and its sub directories, or 0755 to make them writable again
+			void SetReadOnly(bool readOnly)
+			{
+				using std::filesystem::perms;
+				perms permissions = perms::owner_read | perms::owner_exec | perms::group_read | perms::group_exec | perms::others_read | perms::others_exec;
+				if (!readOnly)
+					permissions |= perms::owner_write;
+
+				std::error_code error;
+				std::vector<std::filesystem::path> directories(1, path);
+				for (auto& entry : std::filesystem::recursive_directory_iterator(path, error))
+				{
+					if (entry.is_directory(error))
+						directories.push_back(entry.path());
+				}
+
+				for (auto& directory : directories)
+					std::filesystem::permissions(directory, permissions, error);
+			}
+
+			/// \brief true when files can be created, also after SetReadOnly(true) when the permissions aren't enforced, e.g.: for root
+			bool CanCreateFiles() const
+			{
+				std::filesystem::path probe = path / "probe";
+				bool created = bool(std::ofstream(probe));
+
+				std::error_code error;
+				std::filesystem::remove(probe, error);
+				return created;
+			}
+
+			std::size_t CountFiles(const std::string& extension) const
+			{
+				std::size_t count = 0;
+				std::error_code error;
+				for (auto& entry : std::filesystem::recursive_directory_iterator(path, error))
+				{
+					if (entry.is_regular_file(error) && entry.path().extension() == extension)
+						++count;
+				}
+
+				return count;
+			}
+		};
+
+		DerivedDataCache::Key GetKey(std::size_t index)
+		{
+			return DerivedDataCache::KeyBuilder("bench", 1).AddValue(index).GetKey();
+		}
+
+		std::string CreateEntry(std::size_t index)
+		{
+			return std::string(EntrySize, char('a' + index % 26));
+		}
+	}
+
+	ESTEEM_BENCHMARK("DerivedDataCache/KeyBuilder", BenchDerivedDataCacheKeyBuilder)
+	{
+		// about the size of an imported model's source
+		std::string input(16 * 1024 * 1024, 'x');
+
+		state.SetItems(input.size());
+		state.Measure([&]()
+		{
+			DerivedDataCache::Key key = DerivedDataCache::KeyBuilder("bench", 1).AddString(input).GetKey();
+			DoNotOptimize(key);
+		});
+	}
+
+	ESTEEM_BENCHMARK("DerivedDataCache/Put", BenchDerivedDataCachePut)
+	{
+		ScratchCache scratch;
+
+		std::vector<std::string> entries(EntryCount);
+		for (std::size_t i = 0; i < EntryCount; ++i)
+			entries[i] = CreateEntry(i);
+
+		state.SetItems(EntryCount);
+		state.Measure([&]()
+		{
+			for (std::size_t i = 0; i < EntryCount; ++i)
+				scratch.cache.Put(GetKey(i), entries[i]);
+		});
+	}
+
+	/// \brief also checks that damaged entries are dropped instead of returned
+	ESTEEM_BENCHMARK("DerivedDataCache/GetHit", BenchDerivedDataCacheGetHit)
+	{
+		ScratchCache scratch;
+		for (std::size_t i = 0; i < EntryCount; ++i)
+			scratch.cache.Put(GetKey(i), CreateEntry(i));
+
+		std::string data;
+		for (std::size_t i = 0; i < EntryCount; ++i)
+		{
+			if (!scratch.cache.Get(GetKey(i), data) || data != CreateEntry(i))
+				state.Fail("entry ", std::to_string(i), " didn't come back as it was stored");
+		}
+
+		{
+			std::fstream file(scratch.GetEntryPath(GetKey(0)), std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(EntrySize / 2);
+			file.put('#');
+		}
+
+		if (scratch.cache.Get(GetKey(0), data))
+			state.Fail("a damaged entry was returned");
+
+		state.SetItems(EntryCount - 1);
+		state.Measure([&]()
+		{
+			for (std::size_t i = 1; i < EntryCount; ++i)
+				scratch.cache.Get(GetKey(i), data);
+
+			DoNotOptimize(data);
+		});
+	}
+
+	/// \brief the least recently used entries are evicted, the directory stays under its limit
+	ESTEEM_BENCHMARK("DerivedDataCache/Eviction", BenchDerivedDataCacheEviction)
+	{
+		constexpr uint64_t maxSize = EntryCount * EntrySize / 4;
+		ScratchCache scratch(maxSize);
+
+		std::vector<std::string> entries(EntryCount);
+		for (std::size_t i = 0; i < EntryCount; ++i)
+			entries[i] = CreateEntry(i);
+
+		state.SetItems(EntryCount);
+		state.Measure([&]()
+		{
+			for (std::size_t i = 0; i < EntryCount; ++i)
+				scratch.cache.Put(GetKey(i), entries[i]);
+		});
+
+		if (scratch.GetDirectorySize() > maxSize)
+			state.Fail("the directory grew to ", std::to_string(scratch.GetDirectorySize()), " bytes, the limit is ", std::to_string(maxSize));
+	}
+
+	/// \brief a directory that can't be written to still serves its entries, storing fails quietly and GetOrBuild() builds
+	ESTEEM_BENCHMARK("DerivedDataCache/ReadOnly", BenchDerivedDataCacheReadOnly)
+	{
+		ScratchCache scratch;
+		for (std::size_t i = 0; i < EntryCount; ++i)
+			scratch.cache.Put(GetKey(i), CreateEntry(i));
+
+		scratch.SetReadOnly(true);
+		if (!scratch.cache.Open(scratch.GetPath().string()))
+			state.Fail("a read-only cache directory can't be opened");
+
+		std::string data;
+		for (std::size_t i = 0; i < EntryCount; ++i)
+		{
+			if (!scratch.cache.Get(GetKey(i), data) || data != CreateEntry(i))
+				state.Fail("entry ", std::to_string(i), " can't be read from the read-only directory");
+		}
+
+		if (scratch.CanCreateFiles())
+			Debug::Log("DerivedDataCache/ReadOnly: the directory permissions aren't enforced for this process, the write checks are skipped");
+		else
+		{
+			if (scratch.cache.Put(GetKey(EntryCount), CreateEntry(EntryCount)))
+				state.Fail("an entry was stored in a read-only directory");
+			if (scratch.cache.IsWritable())
+				state.Fail("the cache still thinks the read-only directory is writable");
+
+			bool built = false;
+			bool found = scratch.cache.GetOrBuild(GetKey(EntryCount + 1), data, [&built](std::string& result, std::vector<std::string>&)
+			{
+				result = CreateEntry(EntryCount + 1);
+				built = true;
+				return true;
+			});
+
+			if (!found || !built || data != CreateEntry(EntryCount + 1))
+				state.Fail("GetOrBuild() doesn't build when the cache can't store the result");
+			if (scratch.CountFiles(".tmp") != 0)
+				state.Fail(std::to_string(scratch.CountFiles(".tmp")), " temporary files were left in the read-only directory");
+		}
+
+		state.SetItems(EntryCount);
+		state.Measure([&]()
+		{
+			for (std::size_t i = 0; i < EntryCount; ++i)
+				scratch.cache.Get(GetKey(i), data);
+
+			DoNotOptimize(data);
+		});
+	}
+
+	/// \brief writes and reads the same entries as other processes, which every read must return whole
+	/// The DerivedDataCacheWriters test starts several EsteemBench processes with only this benchmark at once and points
+	/// them at one directory through ESTEEM_BENCH_DDC_SHARED. Without it a scratch directory is used by this process alone.
+	ESTEEM_BENCHMARK("DerivedDataCache/SharedDirectory", BenchDerivedDataCacheSharedDirectory)
+	{
+		// the scratch directory is the same for every process, so it's only created when not shared
+		std::optional<ScratchCache> scratch;
+		DerivedDataCache shared;
+
+		const char* sharedPath = std::getenv("ESTEEM_BENCH_DDC_SHARED");
+		DerivedDataCache* cache = &shared;
+		if (sharedPath && sharedPath[0])
+		{
+			if (!shared.Open(sharedPath))
+				state.Fail("can't open the shared directory ", sharedPath);
+		}
+		else
+			cache = &scratch.emplace().cache;
+
+		std::vector<std::string> entries(SharedCount);
+		for (std::size_t i = 0; i < SharedCount; ++i)
+			entries[i] = CreateEntry(i);
+
+		std::size_t missing = 0;
+		std::size_t damaged = 0;
+		std::string data;
+
+		state.SetItems(SharedCount);
+		state.Measure([&]()
+		{
+			for (std::size_t i = 0; i < SharedCount; ++i)
+			{
+				// may fail when another process has the entry open on Windows, the entry is there either way
+				cache->Put(GetKey(i), entries[i]);
+
+				if (!cache->Get(GetKey(i), data))
+					++missing;
+				else if (data != entries[i])
+					++damaged;
+			}
+		});
+
+		if (missing != 0 || damaged != 0)
+			state.Fail(std::to_string(missing), " entries were missing and ", std::to_string(damaged), " differed right after storing them");
+	}
+}
@@ -0,0 +1,193 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory_resource>
+#include <thread>
+#include <cppu/cgc/pointers.h>
+
+#include "Memory/FrameArena.h"
+#include "Threading/JobSystem.h"
+#include "Utils/Time.h"
+#include "World/World.h"
+#include "World/Systems/ISystem.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t FrameCount = 64;
+		/// \brief frames before the arenas reached their size
+		constexpr std::size_t WarmUpFrames = 2;
+		/// \brief even when a single thread runs every batch, the positions fit in an arena's first block
+		constexpr std::size_t EntityCount = 1 << 12;
+		constexpr std::size_t BatchSize = 64;
+		constexpr float DeltaTime = 1.f / 60.f;
+
+		/// \brief counts the allocations that reach it and passes them on to the new/delete resource
+		/// Installed as default resource it is the upstream of every arena created meanwhile, and catches the frame
+		/// containers that were not given an arena.
+		class CountingResource : public std::pmr::memory_resource
+		{
+		private:
+			std::atomic<std::size_t> allocations;
+
+		protected:
+			virtual void* do_allocate(std::size_t bytes, std::size_t alignment) override
+			{
+				allocations.fetch_add(1, std::memory_order_relaxed);
+				return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+			}
+
+			virtual void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override
+			{
+				std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+			}
+
+			virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+			{
+				return this == &other;
+			}
+
+		public:
+			CountingResource()
+				: allocations(0)
+			{ }
+
+			inline std::size_t GetAllocations() const { return allocations.load(std::memory_order_relaxed); }
+		};
+
+		/// \brief game logic like the Animator's: every batch gathers the positions of its entities in a frame_vector and moves them
+		class BenchMoveSystem : public ISystem
+		{
+		private:
+			JobSystem& jobSystem;
+			const std::vector<cgc::strong_ptr<Entity>>& entities;
+			float time;
+
+		public:
+			BenchMoveSystem(JobSystem& jobSystem, const std::vector<cgc::strong_ptr<Entity>>& entities)
+				: jobSystem(jobSystem)
+				, entities(entities)
+				, time(0.f)
+			{ }
+
+			virtual void Update() override
+			{
+				time += DeltaTime;
+
+				auto function = [this](std::size_t from, std::size_t to)
+				{
+					frame_vector<Vector3> positions(&FrameArena::Get());
+					positions.reserve(to - from);
+					for (std::size_t i = from; i < to; ++i)
+						positions.push_back(entities[i]->GetPosition());
+
+					for (std::size_t i = from; i < to; ++i)
+						entities[i]->SetPosition(positions[i - from] + Vector3(std::sin(time + float(i)) * 0.01f, 0.f, 0.f));
+				};
+
+				jobSystem.WaitFor(jobSystem.ParallelFor(entities.size(), BatchSize, function));
+			}
+		};
+
+		/// \brief the world part of GameEngine's frame, up to and including the frame boundary
+		void RunFrame(World& world)
+		{
+			world.DirtyCleanUp();
+			world.Update();
+			world.Physics().UpdateWorld(DeltaTime);
+			world.LateUpdate();
+
+			world.GetNetworkSystem().UpdateAsync();
+			world.DirtyTransformCleanUp();
+
+			FrameArena::ResetThreadArenas();
+		}
+	}
+
+	/// \brief once warmed up a world frame doesn't grow any arena nor allocates frame containers elsewhere,
+	/// also not on threads outside the job system
+	ESTEEM_BENCHMARK("FrameArena/WorldFrame", BenchFrameArenaWorldFrame)
+	{
+		// outlives the thread local arenas of the threads that are created meanwhile
+		static CountingResource counting;
+		std::pmr::memory_resource* previous = std::pmr::set_default_resource(&counting);
+
+		JobSystem jobSystem(3);
+		FrameArena::CreateThreadArenas(jobSystem.GetThreadCount());
+
+		Time::deltaTime = DeltaTime;
+		cgc::strong_ptr<World> world = cgc::construct_new<World>(false, false);
+
+		std::vector<cgc::strong_ptr<Entity>> entities;
+		for (std::size_t i = 0; i < EntityCount; ++i)
+		{
+			entities.push_back(world->CreateEntity());
+			entities.back()->SetPosition(Vector3(float(i % 64), 0.f, float(i / 64)));
+		}
+
+		BenchMoveSystem moveSystem(jobSystem, entities);
+		world->AddSystem(&moveSystem);
+
+		// a thread outside the job system, like the render or asset threads, using its arena once every frame
+		std::atomic<std::size_t> startedFrame(0);
+		std::atomic<std::size_t> finishedFrame(0);
+		std::size_t warmReserved = 0;
+		std::size_t otherReserved = 0;
+
+		std::thread other([&]()
+		{
+			for (std::size_t frame = 1; frame <= FrameCount; ++frame)
+			{
+				while (startedFrame.load() < frame)
+					std::this_thread::yield();
+
+				{
+					frame_vector<char> data(64 * 1024, &FrameArena::Get());
+					DoNotOptimize(data);
+				}
+
+				if (frame == WarmUpFrames)
+					warmReserved = FrameArena::Get().GetReservedBytes();
+
+				otherReserved = FrameArena::Get().GetReservedBytes();
+				finishedFrame.store(frame);
+			}
+		});
+
+		// counts the allocations of all threads, the other thread finishes its part before the frame boundary
+		std::size_t allocations = 0;
+		for (std::size_t frame = 1; frame <= FrameCount; ++frame)
+		{
+			std::size_t before = counting.GetAllocations();
+			startedFrame.store(frame);
+
+			while (finishedFrame.load() < frame)
+				std::this_thread::yield();
+
+			RunFrame(*world);
+			if (frame > WarmUpFrames)
+				allocations += counting.GetAllocations() - before;
+		}
+
+		other.join();
+
+		ESTEEM_BENCH_CHECK(allocations == 0, std::to_string(allocations), " allocations from the default resource in ", std::to_string(FrameCount - WarmUpFrames), " world frames after warming up");
+		ESTEEM_BENCH_CHECK(otherReserved == warmReserved, "the arena of a thread outside the job system grew from ", std::to_string(warmReserved), " to ", std::to_string(otherReserved), " bytes, it isn't reset");
+		ESTEEM_BENCH_CHECK(FrameArena::Get().GetLiveAllocations() == 0, std::to_string(FrameArena::Get().GetLiveAllocations()), " allocations outlived the frame");
+
+		state.SetItems(EntityCount);
+		state.Measure([&]()
+		{
+			RunFrame(*world);
+		});
+
+		world->RemoveSystem(&moveSystem);
+		entities.clear();
+		world = cgc::strong_ptr<World>();
+
+		FrameArena::DestroyThreadArenas();
+		std::pmr::set_default_resource(previous);
+	}
+}
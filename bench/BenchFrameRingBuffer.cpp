@@ -0,0 +1,153 @@
+#include "Benchmark.h"
+
+#include <cstring>
+#include <vector>
+
+#include "Rendering/FrameRingBuffer.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr uint RingRegionCount = 3;
+		constexpr uint32_t RingAlignment = 256;
+		constexpr uint32_t RingSize = 8 * 1024 * 1024;
+
+		/// \brief bone palettes of 64 matrices of 3x4 floats, as many as a crowded frame draws
+		constexpr uint PaletteCount = 500;
+		constexpr uint32_t PaletteSize = 64 * 48;
+
+		/// \brief remembers the order of the signals and waits, instead of syncing with a GPU
+		class FakeFence : public FrameRingBuffer::Fence
+		{
+		public:
+			struct Event
+			{
+				bool signal;
+				uint region;
+			};
+
+			std::vector<Event> events;
+
+			virtual void Signal(uint region) { events.push_back({ true, region }); }
+			virtual void Wait(uint region) { events.push_back({ false, region }); }
+		};
+
+		/// \brief the allocations of one frame are aligned, inside the frame's region and don't overlap
+		void CheckAllocations(BenchmarkState& state, const FrameRingBuffer& ring, const std::vector<FrameRingBuffer::Allocation>& allocations)
+		{
+			uint32_t regionBegin = ring.GetRegion() * ring.GetRegionSize();
+			uint32_t regionEnd = regionBegin + ring.GetRegionSize();
+			uint32_t end = regionBegin;
+
+			for (const FrameRingBuffer::Allocation& allocation : allocations)
+			{
+				if (allocation.offset % ring.GetAlignment() != 0)
+					state.Fail("offset ", std::to_string(allocation.offset), " isn't aligned to ", std::to_string(ring.GetAlignment()));
+
+				if (allocation.offset < regionBegin || allocation.offset + allocation.size > regionEnd)
+					state.Fail("allocation at ", std::to_string(allocation.offset), " is outside region ", std::to_string(ring.GetRegion()));
+
+				if (allocation.offset < end)
+					state.Fail("allocation at ", std::to_string(allocation.offset), " overlaps the one before it");
+
+				end = allocation.offset + allocation.size;
+			}
+		}
+	}
+
+	/// \brief checks alignment, wrapping and the fence order, then writes a frame of bone palettes
+	ESTEEM_BENCHMARK("FrameRingBuffer/WritePalettes", BenchFrameRingBufferWritePalettes)
+	{
+		std::vector<uint8> memory(RingSize);
+		FakeFence fence;
+		FrameRingBuffer ring;
+		ring.Initialize(memory.data(), RingSize, RingRegionCount, RingAlignment, &fence);
+
+		if (ring.Allocate(16).IsValid())
+			state.Fail("allocation outside a frame succeeded");
+
+		// odd sizes, so alignment padding is needed between them
+		BenchmarkRandom random;
+		std::vector<FrameRingBuffer::Allocation> allocations;
+		const uint frameCount = RingRegionCount * 4;
+		for (uint frame = 0; frame < frameCount; ++frame)
+		{
+			ring.BeginFrame();
+			if (ring.GetRegion() != frame % RingRegionCount)
+				state.Fail("frame ", std::to_string(frame), " uses region ", std::to_string(ring.GetRegion()));
+
+			allocations.clear();
+			for (uint i = 0; i < 100; ++i)
+			{
+				FrameRingBuffer::Allocation allocation = ring.Allocate(uint32_t(random.Between(1, 2000)));
+				if (!allocation.IsValid())
+					state.Fail("allocation ", std::to_string(i), " of frame ", std::to_string(frame), " failed");
+				else
+					allocations.push_back(allocation);
+			}
+
+			CheckAllocations(state, ring, allocations);
+			ring.EndFrame();
+		}
+
+		// every frame waits for its region before using it, and that region was signaled RegionCount frames before
+		if (fence.events.size() != frameCount * 2)
+			state.Fail(std::to_string(fence.events.size()), " fence events, expected ", std::to_string(frameCount * 2));
+		else
+		{
+			for (uint frame = 0; frame < frameCount; ++frame)
+			{
+				const FakeFence::Event& wait = fence.events[frame * 2];
+				const FakeFence::Event& signal = fence.events[frame * 2 + 1];
+				uint region = frame % RingRegionCount;
+
+				if (wait.signal || wait.region != region || signal.signal == false || signal.region != region)
+					state.Fail("frame ", std::to_string(frame), " doesn't wait for and signal region ", std::to_string(region));
+
+				if (frame >= RingRegionCount)
+				{
+					const FakeFence::Event& previous = fence.events[(frame - RingRegionCount) * 2 + 1];
+					if (!previous.signal || previous.region != region)
+						state.Fail("frame ", std::to_string(frame), " reuses region ", std::to_string(region), " without its signal");
+				}
+			}
+		}
+
+		// a full region fails instead of writing into the next one
+		ring.BeginFrame();
+		uint32_t regionSize = ring.GetRegionSize();
+		if (!ring.Allocate(regionSize - RingAlignment).IsValid())
+			state.Fail("couldn't allocate most of a region");
+
+		if (ring.Allocate(RingAlignment + 1).IsValid() || ring.GetFailedCount() != 1)
+			state.Fail("allocation past the end of the region succeeded");
+
+		if (!ring.Allocate(RingAlignment).IsValid())
+			state.Fail("couldn't allocate the rest of the region");
+
+		ring.EndFrame();
+
+		// write what the renderer writes: a palette per animated object
+		std::vector<uint8> palette(PaletteSize);
+		for (uint32_t i = 0; i < PaletteSize; ++i)
+			palette[i] = uint8(i * 31 + 7);
+
+		FrameRingBuffer::Allocation last = { 0, 0, nullptr };
+		state.SetItems(PaletteCount);
+		state.Measure([&]()
+		{
+			ring.BeginFrame();
+			for (uint i = 0; i < PaletteCount; ++i)
+				last = ring.Write(palette.data(), PaletteSize);
+
+			ring.EndFrame();
+			DoNotOptimize(last);
+		});
+
+		if (!last.IsValid() || ring.GetFailedCount() != 0)
+			state.Fail(std::to_string(ring.GetFailedCount()), " palettes didn't fit");
+		else if (std::memcmp(last.data, palette.data(), PaletteSize) != 0)
+			state.Fail("written palette differs from its source");
+	}
+}
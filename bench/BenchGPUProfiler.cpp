@@ -0,0 +1,248 @@
+#include "Benchmark.h"
+
+#include <cstring>
+#include <vector>
+
+#include "Rendering/GPUProfiler.h"
+#include "Utils/Profiler.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		/// \brief nanoseconds the fake GPU takes between two timestamps
+		constexpr uint64_t FakeStep = 1000;
+
+		/// \brief a GPU that finishes a frame's queries a fixed amount of frames after they were written
+		/// Counts the reads that would have waited and the queries that were written again before they were available.
+		class FakeQueries : public GPUProfiler::Queries
+		{
+		private:
+			struct Query
+			{
+				uint64_t value;
+				uint64_t availableAt;
+				bool written;
+			};
+
+			std::vector<Query> queries;
+			uint64_t clock;
+			uint64_t frame;
+
+		public:
+			const uint64_t latency;
+			uint createdCount;
+			uint destroyedCount;
+			uint blockingReads;
+			uint pendingWrites;
+
+			FakeQueries(uint64_t latency)
+				: clock(1000000)
+				, frame(0)
+				, latency(latency)
+				, createdCount(0)
+				, destroyedCount(0)
+				, blockingReads(0)
+				, pendingWrites(0)
+			{ }
+
+			/// \brief the GPU moves on to the next frame
+			inline void Advance() { ++frame; }
+
+			virtual uint Create()
+			{
+				queries.push_back({ 0, 0, false });
+				++createdCount;
+				return uint(queries.size());
+			}
+
+			virtual void Destroy(uint query) { ++destroyedCount; }
+
+			virtual void Timestamp(uint query)
+			{
+				Query& q = queries[query - 1];
+				if (q.written && frame < q.availableAt)
+					++pendingWrites;
+
+				q = { clock, frame + latency, true };
+				clock += FakeStep;
+			}
+
+			virtual bool IsAvailable(uint query)
+			{
+				const Query& q = queries[query - 1];
+				return q.written && frame >= q.availableAt;
+			}
+
+			virtual uint64_t GetResult(uint query)
+			{
+				if (!IsAvailable(query))
+					++blockingReads;
+
+				return queries[query - 1].value;
+			}
+
+			virtual uint64_t GetTime() { return clock; }
+		};
+
+		struct ExpectedZone
+		{
+			const char* name;
+			uint depth;
+			uint64_t duration;
+		};
+
+		/// \brief the passes OpenGLRenderer measures in a forward frame
+		const ExpectedZone ExpectedZones[] =
+		{
+			{ "Frame", 0, 11 * FakeStep },
+			{ "Depth prepass", 1, FakeStep },
+			{ "Shadows", 1, 3 * FakeStep },
+			{ "Cascades", 2, FakeStep },
+			{ "Forward", 1, FakeStep },
+			{ "Overlay", 1, FakeStep },
+		};
+
+		void RenderFrame(FakeQueries& queries, GPUProfiler& profiler)
+		{
+			queries.Advance();
+			profiler.BeginFrame();
+
+			{
+				GPUProfileZone zone(profiler, "Depth prepass");
+			}
+			{
+				GPUProfileZone zone(profiler, "Shadows");
+				GPUProfileZone cascades(profiler, "Cascades");
+			}
+			{
+				GPUProfileZone zone(profiler, "Forward");
+			}
+			{
+				GPUProfileZone zone(profiler, "Overlay");
+			}
+
+			profiler.EndFrame();
+		}
+
+		bool CheckZones(BenchmarkState& state, const std::vector<GPUProfiler::Zone>& zones)
+		{
+			const std::size_t count = sizeof(ExpectedZones) / sizeof(ExpectedZones[0]);
+			if (zones.size() != count)
+			{
+				state.Fail(std::to_string(zones.size()), " zones, expected ", std::to_string(count));
+				return false;
+			}
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const ExpectedZone& expected = ExpectedZones[i];
+				if (std::strcmp(zones[i].name, expected.name) != 0 || zones[i].depth != expected.depth || zones[i].GetDuration() != expected.duration)
+				{
+					state.Fail("zone ", zones[i].name, " at depth ", std::to_string(zones[i].depth), " took ", std::to_string(zones[i].GetDuration()), "ns, expected ", expected.name, " at depth ", std::to_string(expected.depth), " taking ", std::to_string(expected.duration), "ns");
+					return false;
+				}
+			}
+
+			return true;
+		}
+	}
+
+	/// \brief the results arrive as many frames late as the GPU is behind, without ever reading a query that isn't available
+	ESTEEM_BENCHMARK("GPUProfiler/Frame", BenchGPUProfilerFrame)
+	{
+		const uint frameCount = 64;
+
+		for (uint64_t latency = 1; latency < GPUProfiler::FrameCount; ++latency)
+		{
+			FakeQueries queries(latency);
+			{
+				GPUProfiler profiler;
+				profiler.Initialize(&queries);
+
+				for (uint frame = 0; frame < frameCount; ++frame)
+				{
+					RenderFrame(queries, profiler);
+
+					uint64_t expectedLatency = frame >= latency ? latency : 0;
+					if (profiler.GetLatency() != expectedLatency)
+						state.Fail("latency ", std::to_string(profiler.GetLatency()), " in frame ", std::to_string(frame), ", expected ", std::to_string(expectedLatency));
+				}
+
+				if (!CheckZones(state, profiler.GetZones()) || profiler.GetFrameTime() != ExpectedZones[0].duration)
+					state.Fail("wrong zones with a latency of ", std::to_string(latency), " frames");
+
+				if (profiler.GetDroppedCount() != 0 || queries.pendingWrites != 0)
+					state.Fail(std::to_string(profiler.GetDroppedCount()), " frames dropped with a latency of ", std::to_string(latency), " frames");
+
+				if (queries.createdCount != GPUProfiler::FrameCount * 12)
+					state.Fail("created ", std::to_string(queries.createdCount), " queries, expected ", std::to_string(GPUProfiler::FrameCount * 12));
+			}
+
+			if (queries.blockingReads != 0)
+				state.Fail(std::to_string(queries.blockingReads), " reads of queries that weren't available");
+
+			if (queries.destroyedCount != queries.createdCount)
+				state.Fail(std::to_string(queries.createdCount - queries.destroyedCount), " queries leaked");
+		}
+
+		// a GPU further behind than the ring is deep drops frames instead of waiting for them
+		{
+			FakeQueries queries(GPUProfiler::FrameCount + 1);
+			GPUProfiler profiler;
+			profiler.Initialize(&queries);
+
+			for (uint frame = 0; frame < frameCount; ++frame)
+				RenderFrame(queries, profiler);
+
+			if (queries.blockingReads != 0 || !profiler.GetZones().empty())
+				state.Fail("read queries of a GPU that's behind the ring");
+
+			if (profiler.GetDroppedCount() != frameCount - GPUProfiler::FrameCount)
+				state.Fail("dropped ", std::to_string(profiler.GetDroppedCount()), " frames, expected ", std::to_string(frameCount - GPUProfiler::FrameCount));
+		}
+
+		// while capturing, the zones are added to the CPU profiler's trace
+		{
+			FakeQueries queries(2);
+			GPUProfiler profiler;
+			profiler.Initialize(&queries);
+
+			Profiler::Start();
+			for (uint frame = 0; frame < 8; ++frame)
+			{
+				RenderFrame(queries, profiler);
+				Profiler::EndFrame();
+			}
+			Profiler::Stop();
+
+			uint cascades = 0;
+			for (const ProfileFrame& frame : Profiler::GetFrames())
+			{
+				for (const ProfileEvent& event : frame.events)
+				{
+					if (std::strcmp(event.name, "Cascades") == 0 && event.depth == 2 && event.end - event.begin == FakeStep)
+						++cascades;
+				}
+			}
+
+			// the last two frames are still on the GPU
+			if (cascades != 6)
+				state.Fail(std::to_string(cascades), " cascade zones in the trace, expected 6");
+		}
+
+		FakeQueries queries(2);
+		GPUProfiler profiler;
+		profiler.Initialize(&queries);
+
+		state.SetItems(1);
+		state.Measure([&]()
+		{
+			RenderFrame(queries, profiler);
+			DoNotOptimize(profiler.GetFrameTime());
+		});
+
+		if (queries.blockingReads != 0 || profiler.GetDroppedCount() != 0)
+			state.Fail("the measured frames read or dropped queries they shouldn't have");
+	}
+}
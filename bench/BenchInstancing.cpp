@@ -0,0 +1,178 @@
+#include "Benchmark.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Rendering/Renderers/OpenGL/InstanceBatcher.h"
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		using OpenGL::InstanceBatcher;
+
+		constexpr std::size_t ForestTreeCount = 5000;
+		constexpr std::size_t RockGroupCount = 40;
+		constexpr std::size_t RockGroupSize = 20;
+		constexpr std::size_t SmallGroupCount = 200;
+		constexpr std::size_t SmallGroupSize = 3;
+		constexpr std::size_t AnimatedCount = 100;
+		constexpr uint Threshold = 8;
+
+		/// \brief what ForwardRendering compares of a render object, in the order the render queue sorts them
+		struct SceneDraw
+		{
+			uint material;
+			uint vertexArray;
+			bool animated;
+			glm::mat4 modelMatrix;
+		};
+
+		/// \brief a forest of a single tree, groups of rocks, props too few to instance and animated characters
+		struct Scene
+		{
+			std::vector<SceneDraw> draws;
+			std::size_t expectedInstanced;
+			std::size_t expectedMatrices;
+
+			Scene()
+				: expectedInstanced(0)
+				, expectedMatrices(0)
+			{
+				BenchmarkRandom random;
+				auto add = [&](uint material, uint vertexArray, bool animated, std::size_t count)
+				{
+					for (std::size_t i = 0; i < count; ++i)
+					{
+						glm::vec3 position(random.Between(-500.f, 500.f), 0.f, random.Between(-500.f, 500.f));
+						draws.push_back({ material, vertexArray, animated, glm::translate(glm::mat4(1.f), position) });
+					}
+				};
+
+				uint id = 1;
+				add(id, id, false, ForestTreeCount);
+				++id;
+				++expectedInstanced;
+				expectedMatrices += ForestTreeCount;
+
+				for (std::size_t i = 0; i < RockGroupCount; ++i, ++id)
+					add(id, id, false, RockGroupSize);
+				expectedInstanced += RockGroupCount;
+				expectedMatrices += RockGroupCount * RockGroupSize;
+
+				for (std::size_t i = 0; i < SmallGroupCount; ++i, ++id)
+					add(id, id, false, SmallGroupSize);
+
+				// same material and mesh, but every character has its own bones
+				add(id, id, true, AnimatedCount);
+			}
+
+			void Build(InstanceBatcher& batcher) const
+			{
+				batcher.Build(draws.size(), [this](std::size_t i)
+				{
+					return !draws[i].animated;
+				}, [this](std::size_t a, std::size_t b)
+				{
+					return draws[a].material == draws[b].material && draws[a].vertexArray == draws[b].vertexArray;
+				}, [this](std::size_t i) -> const glm::mat4&
+				{
+					return draws[i].modelMatrix;
+				});
+			}
+		};
+
+		/// \brief the batches cover every draw in order and the instanced ones point at their own matrices
+		void CheckBatches(BenchmarkState& state, const Scene& scene, const InstanceBatcher& batcher)
+		{
+			const auto& batches = batcher.GetBatches();
+			const auto& matrices = batcher.GetMatrices();
+
+			std::size_t next = 0;
+			std::size_t nextMatrix = 0;
+			for (const InstanceBatcher::Batch& batch : batches)
+			{
+				if (batch.first != next || batch.count == 0)
+				{
+					state.Fail("batch at draw ", std::to_string(batch.first), " doesn't follow draw ", std::to_string(next));
+					return;
+				}
+
+				if (batch.IsInstanced())
+				{
+					if (batch.matrixOffset != nextMatrix || batch.count < batcher.GetThreshold())
+						state.Fail("instanced batch at draw ", std::to_string(batch.first), " has matrix offset ", std::to_string(batch.matrixOffset), ", expected ", std::to_string(nextMatrix));
+
+					for (uint32_t i = 0; i < batch.count && batch.matrixOffset + i < matrices.size(); ++i)
+					{
+						const SceneDraw& draw = scene.draws[batch.first + i];
+						if (matrices[batch.matrixOffset + i] != draw.modelMatrix || draw.animated)
+						{
+							state.Fail("matrix ", std::to_string(batch.matrixOffset + i), " doesn't belong to draw ", std::to_string(batch.first + i));
+							break;
+						}
+					}
+
+					nextMatrix += batch.count;
+				}
+
+				next += batch.count;
+			}
+
+			if (next != scene.draws.size())
+				state.Fail("batches cover ", std::to_string(next), " of ", std::to_string(scene.draws.size()), " draws");
+			if (nextMatrix != matrices.size())
+				state.Fail(std::to_string(matrices.size()), " matrices, the batches use ", std::to_string(nextMatrix));
+		}
+	}
+
+	ESTEEM_BENCHMARK("Instancing/Build", BenchInstancingBuild)
+	{
+		Scene scene;
+		InstanceBatcher batcher(Threshold);
+
+		state.SetItems(scene.draws.size());
+		state.Measure([&]()
+		{
+			scene.Build(batcher);
+			DoNotOptimize(batcher.GetBatches().front());
+		});
+
+		CheckBatches(state, scene, batcher);
+
+		std::size_t instanced = 0;
+		std::size_t draws = 0;
+		for (const InstanceBatcher::Batch& batch : batcher.GetBatches())
+		{
+			instanced += batch.IsInstanced();
+			draws += batch.IsInstanced() ? 1 : batch.count;
+		}
+
+		if (instanced != scene.expectedInstanced)
+			state.Fail(std::to_string(instanced), " instanced batches, expected ", std::to_string(scene.expectedInstanced));
+		if (batcher.GetMatrices().size() != scene.expectedMatrices)
+			state.Fail(std::to_string(batcher.GetMatrices().size()), " matrices, expected ", std::to_string(scene.expectedMatrices));
+
+		Debug::Log("Instancing/Build: ", std::to_string(scene.draws.size()), " objects in ", std::to_string(draws), " draws");
+	}
+
+	/// \brief a threshold of 0 turns instancing off, everything is drawn one by one
+	ESTEEM_BENCHMARK("Instancing/Disabled", BenchInstancingDisabled)
+	{
+		Scene scene;
+		InstanceBatcher batcher(0);
+
+		state.SetItems(scene.draws.size());
+		state.Measure([&]()
+		{
+			scene.Build(batcher);
+			DoNotOptimize(batcher.GetBatches().front());
+		});
+
+		CheckBatches(state, scene, batcher);
+
+		const auto& batches = batcher.GetBatches();
+		if (batches.size() != 1 || batches.front().IsInstanced() || !batcher.GetMatrices().empty())
+			state.Fail(std::to_string(batches.size()), " batches and ", std::to_string(batcher.GetMatrices().size()), " matrices, expected a single range of draws");
+	}
+}
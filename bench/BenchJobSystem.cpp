@@ -0,0 +1,107 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "Threading/JobSystem.h"
+
+namespace Esteem
+{
+	ESTEEM_BENCHMARK("JobSystem/ParallelFor", BenchJobSystemParallelFor)
+	{
+		constexpr std::size_t itemCount = 1 << 18;
+		constexpr std::size_t batchSize = 256;
+
+		BenchmarkRandom random;
+		JobSystem jobSystem;
+
+		std::vector<float> values(itemCount);
+		for (float& value : values)
+			value = random.Between(0.f, 1000.f);
+
+		state.SetItems(itemCount);
+		state.Measure([&]()
+		{
+			// ParallelFor keeps a pointer to the function, it has to outlive WaitFor()
+			float* data = values.data();
+			auto function = [data](std::size_t from, std::size_t to)
+			{
+				for (std::size_t i = from; i < to; ++i)
+					data[i] = std::sqrt(data[i] * data[i] + 1.f);
+			};
+
+			jobSystem.WaitFor(jobSystem.ParallelFor(itemCount, batchSize, function));
+			DoNotOptimize(values);
+		});
+	}
+
+	ESTEEM_BENCHMARK("JobSystem/EmptyJobs", BenchJobSystemEmptyJobs)
+	{
+		// scheduling overhead only, half of the pool is used so nothing waits on free jobs
+		constexpr std::size_t jobCount = JobSystem::MaxJobsPerThread / 2;
+
+		JobSystem jobSystem;
+
+		state.SetItems(jobCount);
+		state.Measure([&]()
+		{
+			Job* root = jobSystem.CreateJob();
+			for (std::size_t i = 0; i < jobCount; ++i)
+				jobSystem.Run(jobSystem.CreateChildJob(root));
+
+			jobSystem.Run(root);
+			jobSystem.WaitFor(root);
+		});
+	}
+
+	/// \brief a million single item jobs, every one runs exactly once and every thread gets its share of them
+	ESTEEM_BENCHMARK("JobSystem/MillionJobs", BenchJobSystemMillionJobs)
+	{
+		constexpr std::size_t jobCount = 1 << 20;
+		// a fixed amount of workers, so stealing is exercised on any machine
+		constexpr uint8 workerCount = 3;
+
+		struct alignas(64) ThreadCount
+		{
+			std::size_t jobs;
+		};
+
+		JobSystem jobSystem(workerCount);
+		std::vector<uint8> runs(jobCount, 0);
+		std::vector<ThreadCount> threadCounts(jobSystem.GetThreadCount(), ThreadCount{ 0 });
+
+		// the counters are only written by their own thread and read after WaitFor()
+		uint8* runData = runs.data();
+		ThreadCount* countData = threadCounts.data();
+		auto function = [runData, countData](std::size_t from, std::size_t to)
+		{
+			for (std::size_t i = from; i < to; ++i)
+				++runData[i];
+
+			++countData[JobSystem::GetThreadIndex()].jobs;
+		};
+
+		jobSystem.WaitFor(jobSystem.ParallelFor(jobCount, 1, function));
+
+		std::size_t wrongRuns = std::size_t(std::count_if(runs.begin(), runs.end(), [](uint8 count) { return count != 1; }));
+		ESTEEM_BENCH_CHECK(wrongRuns == 0, std::to_string(wrongRuns), " of ", std::to_string(jobCount), " jobs didn't run exactly once");
+
+		std::size_t total = 0;
+		for (const ThreadCount& count : threadCounts)
+			total += count.jobs;
+		ESTEEM_BENCH_CHECK(total == jobCount, std::to_string(total), " jobs ran, expected ", std::to_string(jobCount));
+
+		// with a core per thread every thread should steal a fair part, otherwise they at least have to get some work
+		std::size_t minimumShare = std::thread::hardware_concurrency() >= jobSystem.GetThreadCount() ? jobCount / (jobSystem.GetThreadCount() * 8) : 1;
+		for (std::size_t thread = 0; thread < threadCounts.size(); ++thread)
+			ESTEEM_BENCH_CHECK(threadCounts[thread].jobs >= minimumShare, "thread ", std::to_string(thread), " ran ", std::to_string(threadCounts[thread].jobs), " jobs, expected at least ", std::to_string(minimumShare));
+
+		state.SetItems(jobCount);
+		state.Measure([&]()
+		{
+			jobSystem.WaitFor(jobSystem.ParallelFor(jobCount, 1, function));
+			DoNotOptimize(runs);
+		});
+	}
+}
@@ -0,0 +1,206 @@
+#include "Benchmark.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "Model/NativeModelLoader.h"
+#include "Rendering/Objects/AnimationSequence.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t MeshCount = 8;
+		constexpr std::size_t VertexCount = 16 * 1024;
+		constexpr std::size_t BoneCount = 64;
+		constexpr std::size_t KeyCount = 120;
+
+		/// \brief skinned model with animations and a physics shape, the parts an imported model has (minus materials)
+		cgc::strong_ptr<Model> CreateModel(const std::string& path)
+		{
+			BenchmarkRandom random;
+			cgc::strong_ptr<Model> model = cgc::construct_new<Model>(path, Model::ModelGenerateSettings::NONE, "");
+
+			for (std::size_t m = 0; m < MeshCount; ++m)
+			{
+				std::vector<ModelVertexDataA> vertices(VertexCount);
+				for (ModelVertexDataA& vertex : vertices)
+				{
+					vertex.position = glm::vec3(random.Between(-1.f, 1.f), random.Between(-1.f, 1.f), random.Between(-1.f, 1.f));
+					vertex.normal = glm::normalize(vertex.position);
+					vertex.uv = glm::vec2(random.Between(0.f, 1.f), random.Between(0.f, 1.f));
+					vertex.bones = glm::uvec4(uint(random.Next() % BoneCount), 0, 0, 0);
+					vertex.weights = glm::vec4(1.f, 0.f, 0.f, 0.f);
+				}
+
+				std::vector<uint> indices(VertexCount * 3);
+				for (uint& index : indices)
+					index = uint(random.Next() % VertexCount);
+
+				model->meshes.emplace_back(cgc::construct_new<Mesh<ModelVertexDataA>>(vertices, indices, true));
+			}
+
+			for (std::size_t b = 0; b < BoneCount; ++b)
+			{
+				glm::mat3x4 invBindMatrix(random.Between(-1.f, 1.f));
+				Model::BoneData& bone = model->boneData.emplace_back(uint(b), 1, b == 0 ? ~uint(0) : uint(b - 1), hash_t(random.Next()), invBindMatrix);
+				bone.defaults.translation = glm::vec3(random.Between(-1.f, 1.f));
+				bone.defaults.scale = glm::vec3(1.f);
+				bone.defaults.rotation = glm::quat(1.f, 0.f, 0.f, 0.f);
+
+				model->boneMap[bone.hash] = uint16(b);
+			}
+
+			model->boneUpperEnd = model->boneData.cbegin() + BoneCount / 2;
+			model->boneMatrices.resize(BoneCount);
+
+			auto sequence = cgc::construct_new<AnimationSequence>("bench", float(KeyCount), 30.f);
+			auto& channels = const_cast<std::unordered_map<hash_t, AnimationChannelData>&>(sequence->GetChannelData());
+			for (const Model::BoneData& bone : model->boneData)
+			{
+				AnimationChannelData& channel = channels[bone.hash];
+				channel.boneName = "bone" + std::to_string(bone.index);
+				channel.boneIndex = bone.index;
+
+				for (std::size_t key = 0; key < KeyCount; ++key)
+				{
+					channel.positionKeys.emplace_back(float(key), glm::vec3(random.Between(-1.f, 1.f)));
+					channel.rotationKeys.emplace_back(float(key), glm::quat(1.f, 0.f, 0.f, 0.f));
+				}
+			}
+
+			std::unordered_map<hash_t, cgc::strong_ptr<const AnimationSequence>> sequences;
+			sequences.emplace(hash_t(1), sequence);
+			model->SetBoneAnimationCollection(cgc::construct_new<AnimationCollection>(path, std::move(sequences)));
+
+			Model::PhysicsShape& shape = model->physicsShapes.emplace_back();
+			shape.type = Model::PhysicsShape::CONVEX_HULL;
+			shape.meshIndex = 0;
+			for (std::size_t p = 0; p < 64; ++p)
+				shape.points.emplace_back(random.Between(-1.f, 1.f), random.Between(-1.f, 1.f), random.Between(-1.f, 1.f));
+
+			model->center = glm::vec3(0.f);
+			model->volume = glm::vec3(1.f);
+
+			return model;
+		}
+
+		inline bool EqualBytes(const mm::array_view& a, const mm::array_view& b)
+		{
+			return a.size() == b.size() && a.type_size() == b.type_size() && std::memcmp(a.data(), b.data(), a.size() * a.type_size()) == 0;
+		}
+
+		/// \brief everything the .mdl format stores must come back unchanged
+		bool Equals(const Model& a, const Model& b)
+		{
+			if (a.center != b.center || a.volume != b.volume || a.meshes.size() != b.meshes.size()
+				|| a.boneData.size() != b.boneData.size() || a.boneMap != b.boneMap || a.physicsShapes.size() != b.physicsShapes.size()
+				|| (a.boneUpperEnd - a.boneData.cbegin()) != (b.boneUpperEnd - b.boneData.cbegin()))
+				return false;
+
+			for (std::size_t i = 0; i < a.meshes.size(); ++i)
+			{
+				const cgc::strong_ptr<IMeshData>& meshA = a.meshes[i]->GetMeshData();
+				const cgc::strong_ptr<IMeshData>& meshB = b.meshes[i]->GetMeshData();
+				if (!EqualBytes(meshA->GetVertexMemInfo(), meshB->GetVertexMemInfo()) || !EqualBytes(meshA->GetIndexMemInfo(), meshB->GetIndexMemInfo()))
+					return false;
+			}
+
+			for (std::size_t i = 0; i < a.boneData.size(); ++i)
+			{
+				const Model::BoneData& boneA = a.boneData[i];
+				const Model::BoneData& boneB = b.boneData[i];
+				if (boneA.index != boneB.index || boneA.parentIndex != boneB.parentIndex || boneA.hash != boneB.hash
+					|| boneA.invBindMatrix != boneB.invBindMatrix || boneA.childCount != boneB.childCount || boneA.physicsIK != boneB.physicsIK
+					|| boneA.defaults.translation != boneB.defaults.translation || boneA.defaults.scale != boneB.defaults.scale
+					|| boneA.defaults.rotation != boneB.defaults.rotation)
+					return false;
+			}
+
+			for (std::size_t i = 0; i < a.physicsShapes.size(); ++i)
+			{
+				const Model::PhysicsShape& shapeA = a.physicsShapes[i];
+				const Model::PhysicsShape& shapeB = b.physicsShapes[i];
+				if (shapeA.type != shapeB.type || shapeA.meshIndex != shapeB.meshIndex || shapeA.points != shapeB.points)
+					return false;
+			}
+
+			const auto& sequencesA = a.GetBoneAnimationCollection()->GetAnimationSequences();
+			const auto& sequencesB = b.GetBoneAnimationCollection()->GetAnimationSequences();
+			if (sequencesA.size() != sequencesB.size())
+				return false;
+
+			for (auto& sequenceA : sequencesA)
+			{
+				auto sequenceB = sequencesB.find(sequenceA.first);
+				if (sequenceB == sequencesB.end() || sequenceA.second->GetName() != sequenceB->second->GetName()
+					|| sequenceA.second->GetDuration() != sequenceB->second->GetDuration() || sequenceA.second->GetTPS() != sequenceB->second->GetTPS())
+					return false;
+
+				const auto& channelsA = sequenceA.second->GetChannelData();
+				const auto& channelsB = sequenceB->second->GetChannelData();
+				if (channelsA.size() != channelsB.size())
+					return false;
+
+				for (auto& channelA : channelsA)
+				{
+					auto channelB = channelsB.find(channelA.first);
+					if (channelB == channelsB.end() || channelA.second.boneName != channelB->second.boneName
+						|| channelA.second.boneIndex != channelB->second.boneIndex
+						|| channelA.second.positionKeys.size() != channelB->second.positionKeys.size()
+						|| channelA.second.rotationKeys.size() != channelB->second.rotationKeys.size()
+						|| !EqualBytes(mm::array_view(channelA.second.positionKeys), mm::array_view(channelB->second.positionKeys))
+						|| !EqualBytes(mm::array_view(channelA.second.rotationKeys), mm::array_view(channelB->second.rotationKeys)))
+						return false;
+				}
+			}
+
+			return true;
+		}
+	}
+
+	ESTEEM_BENCHMARK("Model/SaveNative", BenchModelSaveNative)
+	{
+		cgc::strong_ptr<Model> model = CreateModel("bench.mdl");
+
+		state.SetItems(MeshCount);
+		state.Measure([&]()
+		{
+			std::stringstream stream;
+			NativeModelLoader::SaveModel(stream, *model);
+			DoNotOptimize(stream);
+		});
+	}
+
+	/// \brief save to a loose file and map it back, also checks the round trip
+	ESTEEM_BENCHMARK("Model/LoadNative", BenchModelLoadNative)
+	{
+		std::string path = (std::filesystem::temp_directory_path() / "EsteemBenchModel.mdl").string();
+		cgc::strong_ptr<Model> source = CreateModel(path);
+
+		{
+			std::ofstream file(path, std::ios::binary);
+			NativeModelLoader::SaveModel(file, *source);
+		}
+
+		NativeModelLoader loader;
+		cgc::strong_ptr<Model> loaded = cgc::construct_new<Model>(path, Model::ModelGenerateSettings::NONE, "");
+		bool isLoaded = loader.LoadModel(path, *loaded, "", Model::ModelGenerateSettings::NONE);
+		ESTEEM_BENCH_CHECK(isLoaded, "couldn't load ", path);
+		ESTEEM_BENCH_CHECK(!isLoaded || Equals(*source, *loaded), "the .mdl round trip does not match the source model");
+
+		state.SetItems(MeshCount);
+		state.Measure([&]()
+		{
+			cgc::strong_ptr<Model> model = cgc::construct_new<Model>(path, Model::ModelGenerateSettings::NONE, "");
+			loader.LoadModel(path, *model, "", Model::ModelGenerateSettings::NONE);
+			DoNotOptimize(model);
+		});
+
+		loaded = nullptr;
+		std::error_code error;
+		std::filesystem::remove(path, error);
+	}
+}
@@ -0,0 +1,425 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "Memory/Partitioning/Spatial/Octree/Octree.h"
+#include "Threading/JobSystem.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t OctreeLeafCount = 20000;
+		constexpr std::size_t OctreeChurnCount = 100000;
+		constexpr float OctreeWorldSize = 3500.f;
+
+		struct BenchLeaf : public Partitioning::SpatialObject
+		{
+			void Set(const glm::vec3& center, float halfSize)
+			{
+				this->center = center;
+				this->halfVolume = glm::vec3(halfSize);
+				this->size = halfSize * 2.f;
+				RecalculateAABB();
+			}
+		};
+
+		/// \brief same configuration as the culling octree, with the root exposed for the query walk
+		class BenchOctree : public Partitioning::Octree<BenchLeaf, 1024 * 2 * 2 * 2, 32, 10, 6>
+		{
+		public:
+			const Node& GetRoot() const { return root; }
+			std::size_t GetMovedCount() const { return state.moved.size(); }
+
+			std::size_t GetTranslatedCount()
+			{
+				std::size_t count = 0;
+				for (auto& list : state.translated)
+					count += list.leaves.size();
+				return count;
+			}
+		};
+
+		void GenerateLeaves(std::vector<BenchLeaf>& leaves, BenchmarkRandom& random)
+		{
+			for (auto& leaf : leaves)
+			{
+				glm::vec3 center(random.Between(-OctreeWorldSize, OctreeWorldSize), random.Between(-OctreeWorldSize, OctreeWorldSize), random.Between(-OctreeWorldSize, OctreeWorldSize));
+				leaf.Set(center, random.Between(0.5f, 40.f));
+			}
+		}
+
+		inline bool Overlaps(const AxisAlignedBox& a, const AxisAlignedBox& b)
+		{
+			return a.begin.x <= b.end.x && a.end.x >= b.begin.x
+				&& a.begin.y <= b.end.y && a.end.y >= b.begin.y
+				&& a.begin.z <= b.end.z && a.end.z >= b.begin.z;
+		}
+
+		/// \brief counts leaves and nodes that break the tree's bookkeeping
+		/// \param cleanedUp leaves may only be outside of their node's cell, and nodes empty, until the next CleanUp
+		template<class Node>
+		std::size_t CountBrokenNodes(const Node& node, bool cleanedUp)
+		{
+			std::size_t broken = 0;
+			uint32_t count = uint32_t(node.leaves.size());
+
+			for (uint32_t i = 0; i < node.leaves.size(); ++i)
+			{
+				const BenchLeaf* leaf = node.leaves[i];
+				if (leaf->GetContainer() != &node || leaf->GetContainerSlot() != i)
+					++broken;
+				else if (cleanedUp && node.parent && (!node.IsInCell(glm::ivec3(leaf->GetCenter())) || uint(leaf->GetSize()) > node.size))
+					++broken;
+			}
+
+			for (auto& child : node.childs)
+			{
+				if (child)
+				{
+					count += child->count;
+					broken += CountBrokenNodes(*child, cleanedUp);
+
+					if (child->parent != &node || (cleanedUp && child->count == 0))
+						++broken;
+				}
+			}
+
+			return broken + (count != node.count);
+		}
+
+		void CheckOctree(BenchmarkState& state, BenchOctree& octree, const std::vector<BenchLeaf>& leaves, bool cleanedUp)
+		{
+			std::size_t live = 0;
+			for (auto& leaf : leaves)
+				live += leaf.GetContainer() != nullptr;
+
+			if (std::size_t broken = CountBrokenNodes(octree.GetRoot(), cleanedUp))
+				state.Fail(std::to_string(broken), " nodes or leaves are out of place");
+
+			if (octree.GetLeafCount() != live)
+				state.Fail("the tree counts ", std::to_string(octree.GetLeafCount()), " leaves, ", std::to_string(live), " were added");
+
+			if (cleanedUp && octree.GetMovedCount() != 0)
+				state.Fail(std::to_string(octree.GetMovedCount()), " moved leaves weren't placed by CleanUp");
+
+			if (cleanedUp && octree.GetTranslatedCount() != 0)
+				state.Fail(std::to_string(octree.GetTranslatedCount()), " translated leaves weren't merged by CleanUp");
+		}
+
+		template<class Node>
+		std::size_t QueryBox(const Node& node, const AxisAlignedBox& box)
+		{
+			std::size_t found = 0;
+			if (Overlaps(node.aab, box))
+			{
+				for (auto* leaf : node.leaves)
+					found += Overlaps(leaf->GetAABB(), box);
+
+				for (auto& child : node.childs)
+				{
+					if (child)
+						found += QueryBox(*child, box);
+				}
+			}
+
+			return found;
+		}
+	}
+
+	ESTEEM_BENCHMARK("Octree/Insert", BenchOctreeInsert)
+	{
+		BenchmarkRandom random;
+		std::vector<BenchLeaf> leaves(OctreeLeafCount);
+		GenerateLeaves(leaves, random);
+
+		std::unique_ptr<BenchOctree> octree;
+
+		state.SetItems(leaves.size());
+		state.Measure([&]()
+		{
+			for (auto& leaf : leaves)
+				leaf.RemoveFromCulling();
+			octree = std::make_unique<BenchOctree>();
+		}, [&]()
+		{
+			for (auto& leaf : leaves)
+				octree->AddLeaf(&leaf, glm::ivec3(leaf.GetCenter()), uint(leaf.GetSize()));
+		});
+
+		for (auto& leaf : leaves)
+			leaf.RemoveFromCulling();
+	}
+
+	ESTEEM_BENCHMARK("Octree/Translate", BenchOctreeTranslate)
+	{
+		BenchmarkRandom random;
+		std::vector<BenchLeaf> leaves(OctreeLeafCount);
+		GenerateLeaves(leaves, random);
+
+		std::vector<glm::vec3> centers(leaves.size());
+		for (std::size_t i = 0; i < leaves.size(); ++i)
+			centers[i] = leaves[i].GetCenter();
+
+		// small moves, most objects stay inside their node
+		std::vector<glm::vec3> offsets(leaves.size());
+		for (auto& offset : offsets)
+			offset = glm::vec3(random.Between(-2.f, 2.f), random.Between(-2.f, 2.f), random.Between(-2.f, 2.f));
+
+		// every iteration starts again from a freshly built tree, so the same objects leave their node
+		std::unique_ptr<BenchOctree> octree;
+
+		state.SetItems(leaves.size());
+		state.Measure([&]()
+		{
+			for (auto& leaf : leaves)
+				leaf.RemoveFromCulling();
+
+			octree = std::make_unique<BenchOctree>();
+			for (std::size_t i = 0; i < leaves.size(); ++i)
+			{
+				leaves[i].SetCenter(centers[i]);
+				leaves[i].RecalculateAABB();
+				octree->AddLeaf(&leaves[i], glm::ivec3(centers[i]), uint(leaves[i].GetSize()));
+			}
+		}, [&]()
+		{
+			for (std::size_t i = 0; i < leaves.size(); ++i)
+			{
+				BenchLeaf& leaf = leaves[i];
+				leaf.SetCenter(leaf.GetCenter() + offsets[i]);
+				leaf.RecalculateAABB();
+
+				if (auto* container = leaf.GetContainer())
+					container->Translate(&leaf);
+			}
+
+			// objects that left their node are placed again by the per frame clean up
+			octree->CleanUp();
+		});
+
+		CheckOctree(state, *octree, leaves, true);
+
+		for (auto& leaf : leaves)
+			leaf.RemoveFromCulling();
+	}
+
+	/// \brief like Octree/Translate, with the objects translated from every thread of a job system at once
+	ESTEEM_BENCHMARK("Octree/TranslateParallel", BenchOctreeTranslateParallel)
+	{
+		BenchmarkRandom random;
+		std::vector<BenchLeaf> leaves(OctreeLeafCount);
+		GenerateLeaves(leaves, random);
+
+		std::vector<glm::vec3> centers(leaves.size());
+		for (std::size_t i = 0; i < leaves.size(); ++i)
+			centers[i] = leaves[i].GetCenter();
+
+		// small moves with a few bigger ones, so some objects leave their node
+		std::vector<glm::vec3> offsets(leaves.size());
+		for (auto& offset : offsets)
+		{
+			float distance = random.Between(0, 10) == 0 ? 100.f : 2.f;
+			offset = glm::vec3(random.Between(-distance, distance), random.Between(-distance, distance), random.Between(-distance, distance));
+		}
+
+		JobSystem jobSystem(3);
+		std::unique_ptr<BenchOctree> octree;
+
+		auto translate = [&](std::size_t from, std::size_t to)
+		{
+			for (std::size_t i = from; i < to; ++i)
+			{
+				BenchLeaf& leaf = leaves[i];
+				leaf.SetCenter(leaf.GetCenter() + offsets[i]);
+				leaf.RecalculateAABB();
+
+				if (auto* container = leaf.GetContainer())
+					container->Translate(&leaf);
+			}
+		};
+
+		state.SetItems(leaves.size());
+		state.Measure([&]()
+		{
+			for (auto& leaf : leaves)
+				leaf.RemoveFromCulling();
+
+			octree = std::make_unique<BenchOctree>();
+			for (std::size_t i = 0; i < leaves.size(); ++i)
+			{
+				leaves[i].SetCenter(centers[i]);
+				leaves[i].RecalculateAABB();
+				octree->AddLeaf(&leaves[i], glm::ivec3(centers[i]), uint(leaves[i].GetSize()));
+			}
+		}, [&]()
+		{
+			jobSystem.WaitFor(jobSystem.ParallelFor(leaves.size(), 256, translate));
+			octree->CleanUp();
+		});
+
+		CheckOctree(state, *octree, leaves, true);
+
+		for (auto& leaf : leaves)
+			leaf.RemoveFromCulling();
+	}
+
+	ESTEEM_BENCHMARK("Octree/TranslateMany", BenchOctreeTranslateMany)
+	{
+		BenchmarkRandom random;
+		std::vector<BenchLeaf> leaves(OctreeLeafCount);
+		GenerateLeaves(leaves, random);
+
+		std::vector<glm::vec3> centers(leaves.size());
+		for (std::size_t i = 0; i < leaves.size(); ++i)
+			centers[i] = leaves[i].GetCenter();
+
+		// bigger moves than Octree/Translate, so a good part of the objects changes node
+		std::vector<glm::vec3> offsets(leaves.size());
+		for (auto& offset : offsets)
+			offset = glm::vec3(random.Between(-40.f, 40.f), random.Between(-40.f, 40.f), random.Between(-40.f, 40.f));
+
+		std::vector<BenchLeaf*> batch(leaves.size());
+		for (std::size_t i = 0; i < leaves.size(); ++i)
+			batch[i] = &leaves[i];
+
+		std::unique_ptr<BenchOctree> octree;
+
+		state.SetItems(leaves.size());
+		state.Measure([&]()
+		{
+			for (auto& leaf : leaves)
+				leaf.RemoveFromCulling();
+
+			octree = std::make_unique<BenchOctree>();
+			for (std::size_t i = 0; i < leaves.size(); ++i)
+			{
+				leaves[i].SetCenter(centers[i]);
+				leaves[i].RecalculateAABB();
+				octree->AddLeaf(&leaves[i], glm::ivec3(centers[i]), uint(leaves[i].GetSize()));
+			}
+		}, [&]()
+		{
+			for (std::size_t i = 0; i < leaves.size(); ++i)
+			{
+				leaves[i].SetCenter(leaves[i].GetCenter() + offsets[i]);
+				leaves[i].RecalculateAABB();
+			}
+
+			octree->TranslateMany(batch.data(), batch.size());
+		});
+
+		CheckOctree(state, *octree, leaves, false);
+
+		for (auto& leaf : leaves)
+			leaf.RemoveFromCulling();
+	}
+
+	/// \brief adds, removes and moves objects at random, then checks the tree's bookkeeping
+	ESTEEM_BENCHMARK("Octree/Churn", BenchOctreeChurn)
+	{
+		BenchmarkRandom random;
+		BenchOctree octree;
+		std::vector<BenchLeaf> leaves(OctreeChurnCount);
+		GenerateLeaves(leaves, random);
+
+		for (std::size_t i = 0; i < leaves.size(); i += 2)
+			octree.AddLeaf(&leaves[i], glm::ivec3(leaves[i].GetCenter()), uint(leaves[i].GetSize()));
+
+		std::vector<BenchLeaf*> batch;
+		std::vector<BenchLeaf*> translated;
+		auto churn = [&]()
+		{
+			batch.clear();
+			translated.clear();
+			for (std::size_t i = 0; i < leaves.size(); ++i)
+			{
+				BenchLeaf& leaf = leaves[i];
+				int32_t action = random.Between(0, 100);
+
+				if (action < 5)
+				{
+					if (leaf.GetContainer())
+						leaf.RemoveFromCulling();
+					else
+						octree.AddLeaf(&leaf, glm::ivec3(leaf.GetCenter()), uint(leaf.GetSize()));
+				}
+				else if (action < 35 && leaf.GetContainer())
+				{
+					// mostly small steps, some teleport to another part of the tree
+					float distance = action < 30 ? 4.f : 600.f;
+					glm::vec3 offset(random.Between(-distance, distance), random.Between(-distance, distance), random.Between(-distance, distance));
+					leaf.SetCenter(glm::clamp(leaf.GetCenter() + offset, glm::vec3(-OctreeWorldSize), glm::vec3(OctreeWorldSize)));
+					leaf.RecalculateAABB();
+
+					if (i & 1)
+						batch.push_back(&leaf);
+					else
+						translated.push_back(&leaf);
+				}
+			}
+
+			octree.TranslateMany(batch.data(), batch.size());
+
+			// these wait for the next CleanUp when they left their node
+			for (BenchLeaf* leaf : translated)
+				leaf->GetContainer()->Translate(leaf);
+		};
+
+		churn();
+		CheckOctree(state, octree, leaves, false);
+
+		octree.CleanUp();
+		CheckOctree(state, octree, leaves, true);
+
+		state.SetItems(leaves.size());
+		state.Measure([&]()
+		{
+			churn();
+			octree.CleanUp();
+		});
+
+		CheckOctree(state, octree, leaves, true);
+
+		for (auto& leaf : leaves)
+			leaf.RemoveFromCulling();
+
+		octree.CleanUp();
+		if (octree.GetLeafCount() != 0 || std::any_of(octree.GetRoot().childs.begin(), octree.GetRoot().childs.end(), [](auto& child) { return child != nullptr; }))
+			state.Fail("nodes are left after removing every leaf");
+	}
+
+	ESTEEM_BENCHMARK("Octree/Query", BenchOctreeQuery)
+	{
+		BenchmarkRandom random;
+		BenchOctree octree;
+		std::vector<BenchLeaf> leaves(OctreeLeafCount);
+		GenerateLeaves(leaves, random);
+
+		for (auto& leaf : leaves)
+			octree.AddLeaf(&leaf, glm::ivec3(leaf.GetCenter()), uint(leaf.GetSize()));
+
+		std::vector<AxisAlignedBox> boxes(256);
+		for (auto& box : boxes)
+		{
+			glm::vec3 center(random.Between(-OctreeWorldSize, OctreeWorldSize), random.Between(-OctreeWorldSize, OctreeWorldSize), random.Between(-OctreeWorldSize, OctreeWorldSize));
+			float halfSize = random.Between(50.f, 400.f);
+			box = AxisAlignedBox(center - halfSize, center + halfSize);
+		}
+
+		state.SetItems(boxes.size());
+		state.Measure([&]()
+		{
+			std::size_t found = 0;
+			for (auto& box : boxes)
+				found += QueryBox(octree.GetRoot(), box);
+
+			DoNotOptimize(found);
+		});
+
+		for (auto& leaf : leaves)
+			leaf.RemoveFromCulling();
+	}
+}
@@ -0,0 +1,300 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include "minizip/zip.h"
+#include "minizip/unzip.h"
+
+#include "Utils/PakArchive.h"
+#include "Utils/details/ipakstream.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t EntryCount = 20000;
+		constexpr std::size_t LookupCount = 100000;
+		/// \brief unzLocateFile() walks the central directory through file reads (tens of ms per lookup), keep the baseline small
+		constexpr std::size_t LinearLookupCount = 16;
+
+		/// \brief generates a pak with EntryCount small entries, half stored and half deflated
+		class ScratchPak
+		{
+		private:
+			std::filesystem::path path;
+
+		public:
+			ScratchPak()
+				: path(std::filesystem::temp_directory_path() / "EsteemBenchPak.pak")
+			{
+				std::string contents;
+
+				zipFile zip = zipOpen(path.string().c_str(), APPEND_STATUS_CREATE);
+				if (zip == nullptr)
+					return;
+
+				for (std::size_t i = 0; i < EntryCount; ++i)
+				{
+					contents.assign(64 + i % 192, char('a' + i % 26));
+
+					int method = (i & 1) ? Z_DEFLATED : 0;
+					int level = (i & 1) ? Z_DEFAULT_COMPRESSION : 0;
+					if (zipOpenNewFileInZip(zip, GetEntryPath(i).c_str(), nullptr, nullptr, 0, nullptr, 0, nullptr, method, level) == ZIP_OK)
+					{
+						zipWriteInFileInZip(zip, contents.data(), uint(contents.size()));
+						zipCloseFileInZip(zip);
+					}
+				}
+
+				zipClose(zip, nullptr);
+			}
+
+			~ScratchPak()
+			{
+				std::error_code error;
+				std::filesystem::remove(path, error);
+			}
+
+			// disable copy
+			ScratchPak(const ScratchPak&) = delete;
+			void operator=(const ScratchPak&) = delete;
+
+			inline std::string GetPath() const { return path.string(); }
+
+			static std::string GetEntryPath(std::size_t index)
+			{
+				return "assets/folder_" + std::to_string(index % 64) + "/entry_" + std::to_string(index) + ".bin";
+			}
+		};
+
+		constexpr std::size_t LargeEntrySize = 50 * 1024 * 1024;
+		constexpr std::size_t SeekCount = 64;
+		/// \brief without access points every backwards seek inflates from the start, keep the baseline small
+		constexpr std::size_t UnindexedSeekCount = 4;
+		constexpr std::size_t SeekReadSize = 4096;
+
+		/// \brief generates a pak with a single large deflated entry
+		class ScratchLargePak
+		{
+		private:
+			std::filesystem::path path;
+
+		public:
+			ScratchLargePak()
+				: path(std::filesystem::temp_directory_path() / "EsteemBenchLargePak.pak")
+			{
+				// small alphabet, so it compresses, but not so well that inflating is free
+				BenchmarkRandom random;
+				std::string contents(LargeEntrySize, '\0');
+				for (char& c : contents)
+					c = char('a' + random.Next() % 16);
+
+				zipFile zip = zipOpen(path.string().c_str(), APPEND_STATUS_CREATE);
+				if (zip == nullptr)
+					return;
+
+				if (zipOpenNewFileInZip(zip, "large.bin", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_DEFAULT_COMPRESSION) == ZIP_OK)
+				{
+					zipWriteInFileInZip(zip, contents.data(), uint(contents.size()));
+					zipCloseFileInZip(zip);
+				}
+
+				zipClose(zip, nullptr);
+			}
+
+			~ScratchLargePak()
+			{
+				std::error_code error;
+				std::filesystem::remove(path, error);
+			}
+
+			// disable copy
+			ScratchLargePak(const ScratchLargePak&) = delete;
+			void operator=(const ScratchLargePak&) = delete;
+
+			inline std::string GetPath() const { return path.string(); }
+		};
+
+		/// \brief seek to random offsets of the large entry and read a few KB at each
+		void SeekLargeEntry(BenchmarkState& state, std::size_t seekCount, std::size_t span)
+		{
+			ScratchLargePak scratch;
+			PakArchive pak;
+			pak.Open(scratch.GetPath());
+
+			const PakArchive::Entry* entry = pak.Find("large.bin");
+			if (entry == nullptr)
+				return;
+
+			mm::array_view compressed = pak.GetCompressedData(*entry);
+			auto index = std::make_shared<PakSeekIndex>(span);
+
+			BenchmarkRandom random;
+			std::vector<std::size_t> offsets;
+			for (std::size_t i = 0; i < seekCount; ++i)
+				offsets.push_back(std::size_t(random.Next() % (LargeEntrySize - SeekReadSize)));
+
+			char buffer[SeekReadSize];
+			std::size_t bytes = 0;
+
+			state.SetItems(seekCount);
+			state.Measure([&]()
+			{
+				ipakstream stream(static_cast<const uint8_t*>(compressed.data()), compressed.size(), entry->uncompressedSize, index);
+				for (std::size_t offset : offsets)
+				{
+					stream.seekg(offset);
+					stream.read(buffer, SeekReadSize);
+					bytes += std::size_t(stream.gcount());
+				}
+
+				DoNotOptimize(bytes);
+			});
+		}
+
+		/// \brief random entry paths, about one in eight misses the archive
+		std::vector<std::string> CreateLookups(std::size_t count)
+		{
+			BenchmarkRandom random;
+
+			std::vector<std::string> lookups;
+			lookups.reserve(count);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				std::size_t index = std::size_t(random.Between(0, int32_t(EntryCount + EntryCount / 7)));
+				lookups.push_back(ScratchPak::GetEntryPath(index));
+			}
+
+			return lookups;
+		}
+	}
+
+	ESTEEM_BENCHMARK("Pak/Open", BenchPakOpen)
+	{
+		ScratchPak scratch;
+		std::string path = scratch.GetPath();
+
+		PakArchive pak;
+		state.SetItems(EntryCount);
+		state.Measure([&]()
+		{
+			pak.Open(path);
+			DoNotOptimize(pak.GetEntryCount());
+		});
+	}
+
+	ESTEEM_BENCHMARK("Pak/Find", BenchPakFind)
+	{
+		ScratchPak scratch;
+		PakArchive pak;
+		pak.Open(scratch.GetPath());
+
+		std::vector<std::string> lookups = CreateLookups(LookupCount);
+		std::size_t found = 0;
+
+		state.SetItems(LookupCount);
+		state.Measure([&]()
+		{
+			for (const std::string& lookup : lookups)
+				found += pak.Find(lookup) != nullptr;
+
+			DoNotOptimize(found);
+		});
+	}
+
+	/// \brief also checks that Read() rejects an entry whose bytes don't match its checksum
+	ESTEEM_BENCHMARK("Pak/FindAndRead", BenchPakFindAndRead)
+	{
+		ScratchPak scratch;
+		PakArchive pak;
+		pak.Open(scratch.GetPath());
+
+		std::size_t failedReads = 0;
+		for (std::size_t i = 0; i < EntryCount; i += 97)
+		{
+			const PakArchive::Entry* entry = pak.Find(ScratchPak::GetEntryPath(i));
+			failedReads += entry == nullptr || pak.Read(*entry).size() != entry->uncompressedSize;
+		}
+
+		// entry 2 is stored and the first one filled with 'c', flip a byte of it in a copy of the pak
+		bool corruptionRejected = false;
+		{
+			std::filesystem::path corruptPath = scratch.GetPath() + ".corrupt";
+			std::error_code error;
+			std::filesystem::copy_file(scratch.GetPath(), corruptPath, std::filesystem::copy_options::overwrite_existing, error);
+
+			std::fstream file(corruptPath, std::ios::in | std::ios::out | std::ios::binary);
+			std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			std::size_t offset = bytes.find(std::string(64, 'c'));
+			if (offset != std::string::npos)
+			{
+				file.seekp(std::streamoff(offset + 32));
+				file.put('x');
+			}
+
+			file.close();
+
+			PakArchive corrupt;
+			corrupt.Open(corruptPath.string());
+			if (const PakArchive::Entry* entry = corrupt.Find(ScratchPak::GetEntryPath(2)))
+				corruptionRejected = offset != std::string::npos && entry->IsStored() && corrupt.Read(*entry).empty();
+
+			corrupt.Close();
+			std::filesystem::remove(corruptPath, error);
+		}
+
+		ESTEEM_BENCH_CHECK(failedReads == 0, std::to_string(failedReads), " intact entries failed to read");
+		ESTEEM_BENCH_CHECK(corruptionRejected, "a stored entry with a flipped byte was read without an error");
+
+		std::vector<std::string> lookups = CreateLookups(LookupCount);
+		std::size_t bytes = 0;
+
+		state.SetItems(LookupCount);
+		state.Measure([&]()
+		{
+			for (const std::string& lookup : lookups)
+			{
+				if (const PakArchive::Entry* entry = pak.Find(lookup))
+				{
+					mm::array_view view = pak.View(*entry);
+					bytes += view.empty() ? pak.Read(*entry).size() : view.size();
+				}
+			}
+
+			DoNotOptimize(bytes);
+		});
+	}
+
+	ESTEEM_BENCHMARK("Pak/UnzLocateFile", BenchPakUnzLocateFile)
+	{
+		ScratchPak scratch;
+		void* zip = unzOpen(scratch.GetPath().c_str());
+
+		std::vector<std::string> lookups = CreateLookups(LinearLookupCount);
+		std::size_t found = 0;
+
+		state.SetItems(LinearLookupCount);
+		state.Measure([&]()
+		{
+			for (const std::string& lookup : lookups)
+				found += zip != nullptr && unzLocateFile(zip, lookup.c_str(), 2) == UNZ_OK;
+
+			DoNotOptimize(found);
+		});
+
+		if (zip != nullptr)
+			unzClose(zip);
+	}
+
+	/// \brief random seeks into a 50MB deflated entry, access points are shared by all iterations like they are per pak entry
+	ESTEEM_BENCHMARK("Pak/SeekDeflated", BenchPakSeekDeflated)
+	{
+		SeekLargeEntry(state, SeekCount, PakSeekIndex::DefaultSpan);
+	}
+
+	ESTEEM_BENCHMARK("Pak/SeekDeflatedUnindexed", BenchPakSeekDeflatedUnindexed)
+	{
+		SeekLargeEntry(state, UnindexedSeekCount, std::numeric_limits<std::size_t>::max() / 2);
+	}
+}
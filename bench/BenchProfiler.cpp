@@ -0,0 +1,259 @@
+#include "Benchmark.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "Utils/Profiler.h"
+
+namespace Esteem
+{
+	// the zones are constructed directly, ESTEEM_PROFILE is compiled out unless ESTEEM_PROFILING is on
+	namespace
+	{
+		constexpr std::size_t ThreadCount = 8;
+		constexpr std::size_t ZoneCount = 1000;
+		constexpr std::size_t TraceFrameCount = 16;
+		constexpr std::size_t InnerZoneCount = 4;
+
+		/// \brief name of the parent zone of every node, empty for roots
+		std::unordered_map<std::string_view, std::string_view> GetParents(const ProfileFrame& frame)
+		{
+			std::unordered_map<std::string_view, std::string_view> parents;
+			for (const ProfileNode& node : frame.nodes)
+				parents[frame.events[node.event].name] = node.parent >= 0 ? frame.events[frame.nodes[node.parent].event].name : "";
+
+			return parents;
+		}
+
+		/// \brief names of the nodes chained through nextSibling, starting at the given node
+		std::string GetSiblings(const ProfileFrame& frame, int32_t node)
+		{
+			std::string names;
+			for (; node >= 0; node = frame.nodes[node].nextSibling)
+				names.append(frame.events[frame.nodes[node].event].name);
+
+			return names;
+		}
+	}
+
+	/// \brief also checks that named threads don't allocate a ring buffer until they profile,
+	/// and that the rings of exited threads are removed once their zones are collected
+	ESTEEM_BENCHMARK("Profiler/Zone", BenchProfilerZone)
+	{
+		Profiler::EndFrame();
+		std::size_t ringCount = Profiler::GetRingCount();
+
+		Profiler::Start();
+
+		// half of the threads only name themselves, the others also profile a zone
+		std::vector<char> allocated(ThreadCount, 0);
+		std::vector<std::thread> threads;
+		for (std::size_t i = 0; i < ThreadCount; ++i)
+		{
+			threads.emplace_back([&allocated, i]()
+			{
+				Profiler::SetThreadName("Bench " + std::to_string(i));
+				if (i & 1)
+					ProfileZone zone("BenchProfiler::Thread");
+
+				allocated[i] = Profiler::GetLocalRing().IsAllocated();
+			});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		ESTEEM_BENCH_CHECK(Profiler::GetRingCount() == ringCount + ThreadCount, std::to_string(Profiler::GetRingCount() - ringCount), " rings were created by ", std::to_string(ThreadCount), " threads");
+		Profiler::EndFrame();
+
+		std::size_t wrongAllocations = 0;
+		for (std::size_t i = 0; i < ThreadCount; ++i)
+			wrongAllocations += bool(allocated[i]) != bool(i & 1);
+
+		std::size_t threadZones = 0;
+		for (const ProfileFrame& frame : Profiler::GetFrames())
+		{
+			for (const ProfileEvent& event : frame.events)
+				threadZones += std::string_view(event.name) == "BenchProfiler::Thread";
+		}
+
+		ESTEEM_BENCH_CHECK(wrongAllocations == 0, std::to_string(wrongAllocations), " threads allocated their ring without profiling, or didn't while profiling");
+		ESTEEM_BENCH_CHECK(threadZones == ThreadCount / 2, std::to_string(threadZones), " zones of exited threads were collected, expected ", std::to_string(ThreadCount / 2));
+		ESTEEM_BENCH_CHECK(Profiler::GetRingCount() == ringCount, std::to_string(Profiler::GetRingCount() - ringCount), " rings of exited threads are left after EndFrame");
+
+		state.SetItems(ZoneCount);
+		state.Measure([&]()
+		{
+			for (std::size_t i = 0; i < ZoneCount; ++i)
+				ProfileZone zone("BenchProfiler::Zone");
+
+			Profiler::EndFrame();
+		});
+
+		Profiler::Stop();
+		Profiler::EndFrame();
+	}
+
+	/// \brief a zone while the profiler is stopped only reads whether it's enabled, it records nothing and allocates no ring
+	ESTEEM_BENCHMARK("Profiler/DisabledZone", BenchProfilerDisabledZone)
+	{
+		Profiler::Stop();
+		Profiler::EndFrame();
+
+		bool allocated = true;
+		std::thread thread([&allocated]()
+		{
+			for (std::size_t i = 0; i < ZoneCount; ++i)
+				ProfileZone zone("BenchProfiler::Disabled");
+
+			allocated = Profiler::GetLocalRing().IsAllocated();
+		});
+		thread.join();
+
+		// drained but not kept while disabled, so start capturing to see what the thread left behind
+		Profiler::Start();
+		Profiler::EndFrame();
+		std::size_t events = 0;
+		for (const ProfileFrame& frame : Profiler::GetFrames())
+			events += frame.events.size();
+
+		Profiler::Stop();
+		Profiler::EndFrame();
+
+		ESTEEM_BENCH_CHECK(!allocated, "a disabled zone allocated the ring of its thread");
+		ESTEEM_BENCH_CHECK(events == 0, std::to_string(events), " zones were recorded while the profiler was stopped");
+
+		state.SetItems(ZoneCount);
+		state.Measure([&]()
+		{
+			for (std::size_t i = 0; i < ZoneCount; ++i)
+				ProfileZone zone("BenchProfiler::Disabled");
+		});
+	}
+
+	/// \brief links per thread and orphaned zones of an unsorted frame, and exports nested zones of several frames
+	/// as a Chrome trace that nests the same way
+	ESTEEM_BENCHMARK("Profiler/ChromeTrace", BenchProfilerChromeTrace)
+	{
+		// A(B, C(D)), E on one thread, F(G) and H, whose parent was dropped, on another
+		ProfileFrame handmade;
+		handmade.begin = 0;
+		handmade.end = 200;
+		handmade.events = {
+			{ "D", 60, 70, 1, 2 }, { "G", 6, 7, 2, 1 }, { "E", 110, 120, 1, 0 }, { "B", 10, 40, 1, 1 },
+			{ "H", 60, 70, 2, 1 }, { "A", 0, 100, 1, 0 }, { "F", 5, 50, 2, 0 }, { "C", 50, 90, 1, 1 }
+		};
+		handmade.BuildHierarchy();
+
+		std::unordered_map<std::string_view, std::string_view> parents = GetParents(handmade);
+		std::unordered_map<std::string_view, std::string_view> expected = {
+			{ "A", "" }, { "B", "A" }, { "C", "A" }, { "D", "C" }, { "E", "" }, { "F", "" }, { "G", "F" }, { "H", "" }
+		};
+
+		ESTEEM_BENCH_CHECK(parents == expected, "BuildHierarchy linked zones to the wrong parents");
+		ESTEEM_BENCH_CHECK(GetSiblings(handmade, 0) == "AEFH", "roots are chained as ", GetSiblings(handmade, 0), " instead of AEFH");
+		ESTEEM_BENCH_CHECK(GetSiblings(handmade, handmade.nodes[0].firstChild) == "BC", "children of A are chained as ", GetSiblings(handmade, handmade.nodes[0].firstChild), " instead of BC");
+
+		Profiler::Stop();
+		Profiler::EndFrame();
+		Profiler::Start();
+
+		for (std::size_t frame = 0; frame < TraceFrameCount; ++frame)
+		{
+			{
+				ProfileZone outer("BenchProfiler::Outer");
+				for (std::size_t i = 0; i < InnerZoneCount; ++i)
+					ProfileZone inner("BenchProfiler::Inner");
+			}
+
+			Profiler::EndFrame();
+		}
+
+		std::size_t wrongParents = 0;
+		std::deque<ProfileFrame> frames = Profiler::GetFrames();
+		for (const ProfileFrame& frame : frames)
+		{
+			for (const ProfileNode& node : frame.nodes)
+			{
+				std::string_view name = frame.events[node.event].name;
+				std::string_view parent = node.parent >= 0 ? frame.events[frame.nodes[node.parent].event].name : "";
+				wrongParents += name == "BenchProfiler::Inner" ? parent != "BenchProfiler::Outer" : !parent.empty();
+			}
+		}
+
+		ESTEEM_BENCH_CHECK(frames.size() == TraceFrameCount, std::to_string(frames.size()), " frames were captured of ", std::to_string(TraceFrameCount));
+		ESTEEM_BENCH_CHECK(wrongParents == 0, std::to_string(wrongParents), " captured zones have the wrong parent");
+
+		std::string path = (std::filesystem::temp_directory_path() / "EsteemBenchProfiler.json").string();
+		bool written = Profiler::WriteChromeTrace(path);
+
+		std::stringstream contents;
+		contents << std::ifstream(path, std::ios::binary).rdbuf();
+
+		rapidjson::Document trace;
+		bool parsed = !trace.Parse(contents.str().c_str()).HasParseError() && trace.IsObject()
+			&& trace.HasMember("traceEvents") && trace["traceEvents"].IsArray();
+
+		ESTEEM_BENCH_CHECK(written && parsed, "the Chrome trace wasn't written or isn't valid JSON");
+
+		// every inner zone lies within an outer zone of the same thread
+		std::size_t frameMarkers = 0;
+		std::vector<std::pair<double, double>> outers;
+		std::vector<std::pair<double, double>> inners;
+		uint64_t zoneThread = ~uint64_t(0);
+		bool sameThread = true;
+		for (const auto& event : trace["traceEvents"].GetArray())
+		{
+			std::string_view phase = event["ph"].GetString();
+			std::string_view name = event["name"].GetString();
+			if (phase == "i")
+				frameMarkers += name == "Frame";
+			else if (phase == "X")
+			{
+				auto& zones = name == "BenchProfiler::Outer" ? outers : inners;
+				zones.emplace_back(event["ts"].GetDouble(), event["ts"].GetDouble() + event["dur"].GetDouble());
+
+				sameThread &= zoneThread == ~uint64_t(0) || zoneThread == event["tid"].GetUint64();
+				zoneThread = event["tid"].GetUint64();
+			}
+		}
+
+		// timestamps are exported in microseconds with nanosecond precision
+		std::size_t nested = 0;
+		for (const auto& inner : inners)
+		{
+			for (const auto& outer : outers)
+			{
+				if (inner.first >= outer.first - 0.001 && inner.second <= outer.second + 0.001)
+				{
+					++nested;
+					break;
+				}
+			}
+		}
+
+		std::filesystem::remove(path);
+
+		ESTEEM_BENCH_CHECK(frameMarkers == TraceFrameCount, std::to_string(frameMarkers), " frame markers were exported for ", std::to_string(TraceFrameCount), " frames");
+		ESTEEM_BENCH_CHECK(outers.size() == TraceFrameCount && inners.size() == TraceFrameCount * InnerZoneCount,
+			std::to_string(outers.size()), " outer and ", std::to_string(inners.size()), " inner zones were exported");
+		ESTEEM_BENCH_CHECK(sameThread, "zones of a single thread were exported on several threads");
+		ESTEEM_BENCH_CHECK(nested == inners.size(), std::to_string(inners.size() - nested), " exported inner zones lie outside every outer zone");
+
+		state.SetItems((InnerZoneCount + 1) * TraceFrameCount);
+		state.Measure([&]()
+		{
+			Profiler::WriteChromeTrace(path);
+		});
+
+		std::filesystem::remove(path);
+		Profiler::Stop();
+		Profiler::EndFrame();
+	}
+}
@@ -0,0 +1,212 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <set>
+#include <tuple>
+
+#include "Rendering/Renderers/OpenGL/RenderQueue.h"
+#include "Rendering/Renderers/OpenGL/GLStateCache.h"
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		using OpenGL::GLStateCache;
+		using OpenGL::RenderQueue;
+
+		constexpr std::size_t SceneObjectCount = 10000;
+		constexpr uint SceneProgramCount = 8;
+		constexpr uint SceneMaterialCount = 64;
+		constexpr uint SceneVertexArrayCount = 256;
+		constexpr uint SceneTexturesPerMaterial = 3;
+
+		/// \brief the ids ForwardRendering would read from a render object, without any OpenGL objects behind them
+		struct SceneObject
+		{
+			uint8 pass;
+			uint program;
+			uint material;
+			uint vertexArray;
+			glm::vec3 position;
+		};
+
+		struct Scene
+		{
+			RenderCameraData camera;
+			std::vector<SceneObject> objects;
+			/// \brief stands in for the material objects, SetUniforms compares their address
+			std::vector<uint> materials;
+
+			Scene()
+				: objects(SceneObjectCount)
+				, materials(SceneMaterialCount + 1)
+			{
+				camera.position = glm::vec3(0.f);
+				camera.forward = glm::vec3(0.f, 0.f, -1.f);
+				camera.nearClipDistance = 0.1f;
+				camera.farClipDistance = 1000.f;
+
+				BenchmarkRandom random;
+				for (auto& object : objects)
+				{
+					// every material belongs to one program, a tenth of the objects is double sided
+					object.pass = random.Between(0, 10) == 0 ? RenderObject::RenderOrder::OPAQUE_DOUBLE_SIDED : RenderObject::RenderOrder::OPAQUE_;
+					object.material = uint(random.Between(0, int32_t(SceneMaterialCount))) + 1;
+					object.program = object.material % SceneProgramCount + 1;
+					object.vertexArray = uint(random.Between(0, int32_t(SceneVertexArrayCount))) + 1;
+					object.position = glm::vec3(random.Between(-500.f, 500.f), random.Between(-20.f, 20.f), random.Between(-1000.f, 0.f));
+				}
+			}
+
+			uint64_t GetKey(const SceneObject& object) const
+			{
+				return RenderQueue::CreateKey(object.pass, object.program, object.material, object.vertexArray, RenderQueue::QuantizeDepth(object.position, camera));
+			}
+		};
+
+		/// \brief the same requests ForwardRendering::RenderOpaque makes per object
+		void RecordObject(GLStateCache& cache, const Scene& scene, const SceneObject& object)
+		{
+			cache.SetCullFace(object.pass != RenderObject::RenderOrder::OPAQUE_DOUBLE_SIDED);
+			cache.UseProgram(object.program);
+
+			for (uint i = 0; i < SceneTexturesPerMaterial; ++i)
+				cache.BindTexture(i, GL_TEXTURE_2D, object.material * SceneTexturesPerMaterial + i);
+
+			cache.BindTexture(7, GL_TEXTURE_2D, 1);
+			cache.BindTexture(8, GL_TEXTURE_2D, 2);
+			cache.SetUniforms(nullptr, &scene.materials[object.material]);
+			cache.BindVertexArray(object.vertexArray);
+			cache.Draw(nullptr, &object);
+		}
+
+		std::size_t CountCommands(const GLStateCache& cache, GLStateCache::Command::Type type)
+		{
+			return std::count_if(cache.GetCommands().begin(), cache.GetCommands().end(), [type](const GLStateCache::Command& command) { return command.type == type; });
+		}
+	}
+
+	ESTEEM_BENCHMARK("RenderQueue/Sort", BenchRenderQueueSort)
+	{
+		Scene scene;
+		RenderQueue queue;
+
+		std::vector<uint64_t> keys(scene.objects.size());
+		for (std::size_t i = 0; i < keys.size(); ++i)
+			keys[i] = scene.GetKey(scene.objects[i]);
+
+		state.SetItems(keys.size());
+		state.Measure([&]()
+		{
+			queue.Clear();
+			for (uint64_t key : keys)
+				queue.Add(key, nullptr);
+
+			queue.Sort();
+			DoNotOptimize(queue.GetItems().front());
+		});
+
+		const auto& items = queue.GetItems();
+		for (std::size_t i = 1; i < items.size(); ++i)
+		{
+			const RenderQueue::Item& previous = items[i - 1];
+			if (previous.key > items[i].key || (previous.key == items[i].key && previous.index > items[i].index))
+			{
+				state.Fail("item ", std::to_string(i), " is out of order");
+				break;
+			}
+		}
+	}
+
+	/// \brief records the sorted scene and checks the binds that are left and the draw order
+	ESTEEM_BENCHMARK("RenderQueue/Record", BenchRenderQueueRecord)
+	{
+		Scene scene;
+		RenderQueue queue;
+		for (const auto& object : scene.objects)
+			queue.Add(scene.GetKey(object), nullptr);
+
+		queue.Sort();
+
+		GLStateCache cache;
+		state.SetItems(scene.objects.size());
+		state.Measure([&]()
+		{
+			cache.Invalidate();
+			cache.Clear();
+
+			for (const RenderQueue::Item& item : queue.GetItems())
+				RecordObject(cache, scene, scene.objects[item.index]);
+		});
+
+		// every program and material is used by several objects, sorted they are each set once per pass at most
+		std::set<std::tuple<uint8, uint>> programs, materials;
+		std::set<std::tuple<uint8, uint, uint>> vertexArrays;
+		for (const auto& object : scene.objects)
+		{
+			programs.emplace(object.pass, object.program);
+			materials.emplace(object.pass, object.material);
+			vertexArrays.emplace(object.pass, object.material, object.vertexArray);
+		}
+
+		std::size_t programBinds = CountCommands(cache, GLStateCache::Command::Type::USE_PROGRAM);
+		std::size_t materialBinds = CountCommands(cache, GLStateCache::Command::Type::SET_UNIFORMS);
+		std::size_t vertexArrayBinds = CountCommands(cache, GLStateCache::Command::Type::BIND_VERTEX_ARRAY);
+		std::size_t cullFaceChanges = CountCommands(cache, GLStateCache::Command::Type::CULL_FACE);
+
+		if (programBinds != programs.size())
+			state.Fail(std::to_string(programBinds), " program binds, expected ", std::to_string(programs.size()));
+		if (materialBinds != materials.size())
+			state.Fail(std::to_string(materialBinds), " material changes, expected ", std::to_string(materials.size()));
+		if (vertexArrayBinds > vertexArrays.size())
+			state.Fail(std::to_string(vertexArrayBinds), " vertex array binds, expected at most ", std::to_string(vertexArrays.size()));
+		if (cullFaceChanges != 2)
+			state.Fail("face culling changed ", std::to_string(cullFaceChanges), " times, expected once per pass");
+
+		// draws follow the keys, objects with the same state front to back
+		std::vector<bool> drawn(scene.objects.size(), false);
+		uint64_t previousKey = 0;
+		for (const auto& command : cache.GetCommands())
+		{
+			if (command.type != GLStateCache::Command::Type::DRAW)
+				continue;
+
+			const SceneObject& object = *static_cast<const SceneObject*>(command.data);
+			std::size_t index = &object - scene.objects.data();
+			uint64_t key = scene.GetKey(object);
+
+			if (drawn[index])
+				state.Fail("object ", std::to_string(index), " is drawn twice");
+			if (key < previousKey)
+				state.Fail("object ", std::to_string(index), " is drawn out of order");
+
+			drawn[index] = true;
+			previousKey = key;
+		}
+
+		if (cache.GetDrawCount() != scene.objects.size() || std::count(drawn.begin(), drawn.end(), true) != std::ptrdiff_t(scene.objects.size()))
+			state.Fail(std::to_string(cache.GetDrawCount()), " draws for ", std::to_string(scene.objects.size()), " objects");
+
+		Debug::Log("RenderQueue/Record: ", std::to_string(cache.GetBindCount()), " binds, ", std::to_string(cache.GetSkippedCount()), " skipped");
+	}
+
+	/// \brief the same scene in culling order, for comparing the amount of binds against RenderQueue/Record
+	ESTEEM_BENCHMARK("RenderQueue/RecordUnsorted", BenchRenderQueueRecordUnsorted)
+	{
+		Scene scene;
+		GLStateCache cache;
+
+		state.SetItems(scene.objects.size());
+		state.Measure([&]()
+		{
+			cache.Invalidate();
+			cache.Clear();
+
+			for (const auto& object : scene.objects)
+				RecordObject(cache, scene, object);
+		});
+
+		Debug::Log("RenderQueue/RecordUnsorted: ", std::to_string(cache.GetBindCount()), " binds, ", std::to_string(cache.GetSkippedCount()), " skipped");
+	}
+}
@@ -0,0 +1,171 @@
+#include "Benchmark.h"
+
+#include <memory>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/norm.hpp>
+
+#include "Client/RenderView.h"
+#include "Culling/Objects/CullingObject.h"
+#include "Rendering/Objects/Mesh.h"
+#include "Rendering/Renderers/Null/NullRenderer.h"
+#include "Utils/Data.h"
+#include "World/World.h"
+#include "World/Constituents/Camera.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr int GridExtent = 32;
+		constexpr std::size_t ObjectCount = std::size_t(GridExtent * 2) * std::size_t(GridExtent * 2);
+		constexpr std::size_t OpaqueMaterialCount = 6;
+		constexpr std::size_t ShaderCount = 3;
+		constexpr std::size_t TranslucentEvery = 8;
+		constexpr float Spacing = 4.f;
+
+		/// \brief unit cube, 12 triangles
+		cgc::strong_ptr<Mesh<ModelVertexDataA>> CreateCube()
+		{
+			std::vector<ModelVertexDataA> vertices(8);
+			for (std::size_t i = 0; i < vertices.size(); ++i)
+			{
+				vertices[i].position = glm::vec3(i & 1 ? .5f : -.5f, i & 2 ? .5f : -.5f, i & 4 ? .5f : -.5f);
+				vertices[i].normal = glm::normalize(vertices[i].position);
+			}
+
+			std::vector<uint> indices = {
+				0, 2, 1, 1, 2, 3,	4, 5, 6, 5, 7, 6,
+				0, 1, 4, 1, 5, 4,	2, 6, 3, 3, 6, 7,
+				0, 4, 2, 2, 4, 6,	1, 3, 5, 3, 7, 5
+			};
+
+			return cgc::construct_new<Mesh<ModelVertexDataA>>(vertices, indices, true);
+		}
+
+		cgc::strong_ptr<Material> CreateMaterial(Null::NullFactory& factory, std::string_view path, const std::string& json, const std::vector<cgc::strong_ptr<Material>>& bases = {})
+		{
+			rapidjson::Document document = Data::ReadJSON(json.c_str());
+			return factory.CreateMaterial(path, document, bases);
+		}
+
+		/// \brief a grid of cubes around a camera on the null renderer, every few cubes uses a translucent material
+		struct RenderScene
+		{
+			Null::NullRenderer renderer;
+			cgc::strong_ptr<World> world;
+			cgc::strong_ptr<Entity> cameraEntity;
+
+			cgc::strong_ptr<Material> translucentBase;
+			std::vector<cgc::strong_ptr<Material>> materials;
+			std::vector<glm::mat4> matrices;
+			std::vector<std::unique_ptr<CullingObject>> cullingObjects;
+
+			RenderScene()
+				: renderer(Settings::initialScreenSize)
+			{
+				renderer.ThreadInitialize();
+
+				world = cgc::construct_new<World>(false, false);
+				renderer.SetWorld(world.ptr());
+
+				cameraEntity = world->CreateEntity();
+				cameraEntity->SetPosition(Vector3(0.f, 2.f, 0.f));
+				Camera::Instantiate(cameraEntity);
+
+				Null::NullFactory& factory = renderer.GetNullFactory();
+				for (std::size_t i = 0; i < OpaqueMaterialCount; ++i)
+				{
+					std::string name = "opaque" + std::to_string(i);
+					materials.push_back(CreateMaterial(factory, "bench/" + name,
+						"{ \"name\": \"" + name + "\", \"shader\": \"bench" + std::to_string(i % ShaderCount) + "\" }"));
+				}
+
+				// the derived material only names itself, shader and translucency come from its base
+				translucentBase = CreateMaterial(factory, "bench/glass_base", "{ \"name\": \"glass_base\", \"shader\": \"glass\", \"transparent\": true }");
+				materials.push_back(CreateMaterial(factory, "bench/glass", "{ \"name\": \"glass\" }", { translucentBase }));
+
+				matrices.reserve(ObjectCount);
+				cullingObjects.reserve(ObjectCount);
+				for (int x = -GridExtent; x < GridExtent; ++x)
+				{
+					for (int z = -GridExtent; z < GridExtent; ++z)
+					{
+						std::size_t index = matrices.size();
+						glm::vec3 position(float(x) * Spacing, 0.f, float(z) * Spacing);
+						matrices.push_back(glm::translate(glm::mat4(1.f), position));
+
+						const cgc::strong_ptr<Material>& material = index % TranslucentEvery == 0 ? materials.back() : materials[index % OpaqueMaterialCount];
+						cgc::strong_ptr<RenderObject> renderObject = factory.LoadRenderObject(cgc::static_pointer_cast<AbstractMesh>(CreateCube()), material);
+						renderObject->SetModelMatrix(&matrices.back());
+
+						cullingObjects.emplace_back(std::make_unique<CullingObject>(std::vector<cgc::strong_ptr<RenderObject>>{ renderObject }, position, glm::vec3(.5f), CullingObject::Type::STATIC));
+						world->AddCullingObject(cullingObjects.back().get());
+					}
+				}
+			}
+
+			~RenderScene()
+			{
+				// culling objects leave the world's tree before it is destroyed
+				cullingObjects.clear();
+				cameraEntity = cgc::strong_ptr<Entity>();
+				world = cgc::strong_ptr<World>();
+			}
+
+			// disable copy
+			RenderScene(const RenderScene&) = delete;
+			void operator=(const RenderScene&) = delete;
+		};
+	}
+
+	/// \brief the 3D part of RenderView::RenderFrame() on the null renderer: culling, translucent sort, clean up and the render list walk
+	ESTEEM_BENCHMARK("RenderView/RenderFrame", BenchRenderViewRenderFrame)
+	{
+		RenderScene scene;
+		Null::NullFactory& factory = scene.renderer.GetNullFactory();
+
+		// materials are created by the shared parsing in RenderingFactory
+		const cgc::strong_ptr<Material>& glass = scene.materials.back();
+		ESTEEM_BENCH_CHECK(glass->IsTranslucent(), "the derived material didn't inherit translucency from its base");
+		ESTEEM_BENCH_CHECK(static_cast<const Null::NullMaterial*>(glass.ptr())->GetNullShader() == static_cast<const Null::NullMaterial*>(scene.translucentBase.ptr())->GetNullShader(),
+			"the derived material didn't inherit the shader of its base");
+		ESTEEM_BENCH_CHECK(!scene.materials.front()->IsTranslucent(), "an opaque material became translucent");
+
+		cgc::strong_ptr<Material> missing = factory.LoadMaterial("bench/missing_material");
+		ESTEEM_BENCH_CHECK(missing != nullptr, "a missing material didn't fall back to a diffuse material");
+		ESTEEM_BENCH_CHECK(missing == factory.LoadMaterial("bench/missing_material"), "the fallback material isn't cached");
+		ESTEEM_BENCH_CHECK(static_cast<const Null::NullMaterial*>(missing.ptr())->GetNullShader() == factory.LoadNullShader("diffuse"), "the fallback material doesn't use the diffuse shader");
+
+		RenderView::RenderWorld(*scene.world, scene.renderer);
+		Null::NullRenderer::FrameStatistics first = scene.renderer.GetFrameStatistics();
+
+		const RenderList& renderList = scene.world->GetCulling().GetRenderObjectList();
+		std::size_t listed = 0;
+		for (const auto& renderObjects : renderList)
+			listed += renderObjects.size();
+
+		const auto& translucent = renderList[RenderObject::RenderOrder::TRANSLUCENT];
+		glm::vec3 eye = scene.cameraEntity->GetPosition();
+		bool backToFront = true;
+		for (std::size_t i = 1; i < translucent.size(); ++i)
+			backToFront &= glm::length2(translucent[i - 1]->GetPosition() - eye) >= glm::length2(translucent[i]->GetPosition() - eye);
+
+		ESTEEM_BENCH_CHECK(first.drawCalls > 0 && first.drawCalls < ObjectCount, std::to_string(first.drawCalls), " draw calls of ", std::to_string(ObjectCount), " objects, the frustum should cull part of the grid");
+		ESTEEM_BENCH_CHECK(first.drawCalls == listed, std::to_string(first.drawCalls), " draw calls for ", std::to_string(listed), " listed render objects");
+		ESTEEM_BENCH_CHECK(!translucent.empty(), "no translucent objects were listed");
+		ESTEEM_BENCH_CHECK(backToFront, "translucent objects aren't sorted back to front");
+		ESTEEM_BENCH_CHECK(first.triangles == std::size_t(first.drawCalls) * 12, std::to_string(first.triangles), " triangles for ", std::to_string(first.drawCalls), " cubes");
+		ESTEEM_BENCH_CHECK(first.shaderSwitches <= first.materialSwitches && first.uploadedBytes > 0, "shader switches or uploads out of place");
+
+		RenderView::RenderWorld(*scene.world, scene.renderer);
+		const Null::NullRenderer::FrameStatistics& second = scene.renderer.GetFrameStatistics();
+		ESTEEM_BENCH_CHECK(second.drawCalls == first.drawCalls && second.triangles == first.triangles, "a second frame of the same scene drew ", std::to_string(second.drawCalls), " instead of ", std::to_string(first.drawCalls), " objects");
+
+		state.SetItems(ObjectCount);
+		state.Measure([&]()
+		{
+			RenderView::RenderWorld(*scene.world, scene.renderer);
+			DoNotOptimize(scene.renderer.GetFrameStatistics());
+		});
+	}
+}
@@ -0,0 +1,140 @@
+#include "Benchmark.h"
+
+#include <cmath>
+
+#include "Rendering/Objects/BlockCompression.h"
+#include "Rendering/Objects/TextureContainer.h"
+#include "Threading/JobSystem.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr uint32_t ImageWidth = 1024;
+		constexpr uint32_t ImageHeight = 1024;
+
+		/// \brief gradients, hard edges and a bit of noise, the kinds of content a texture has
+		std::vector<uint8> CreateImage(uint32_t width, uint32_t height)
+		{
+			BenchmarkRandom random;
+			std::vector<uint8> pixels(std::size_t(width) * height * 4);
+
+			for (uint32_t y = 0; y < height; ++y)
+			{
+				for (uint32_t x = 0; x < width; ++x)
+				{
+					float u = float(x) / width, v = float(y) / height;
+					uint8* pixel = pixels.data() + (std::size_t(y) * width + x) * 4;
+
+					pixel[0] = uint8(std::clamp(127.5f + 127.5f * std::sin(u * 9.f + v * 3.f) + random.Between(-4.f, 4.f), 0.f, 255.f));
+					pixel[1] = uint8(std::clamp(255.f * u * v + random.Between(-4.f, 4.f), 0.f, 255.f));
+					pixel[2] = ((x / 32 + y / 32) & 1) ? 200 : 40;
+					pixel[3] = uint8(127.5f + 127.5f * std::cos(u * 5.f));
+				}
+			}
+
+			return pixels;
+		}
+
+		/// \brief peak signal to noise ratio over the first channelCount channels, in dB
+		double PSNR(const std::vector<uint8>& a, const std::vector<uint8>& b, uint32_t channelCount)
+		{
+			double squaredError = 0.;
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < a.size(); ++i)
+			{
+				if ((i & 3) >= channelCount)
+					continue;
+
+				double difference = double(a[i]) - double(b[i]);
+				squaredError += difference * difference;
+				++count;
+			}
+
+			return squaredError == 0. ? 99. : 10. * std::log10(255. * 255. * count / squaredError);
+		}
+
+		/// \brief encode the image in parallel, also decodes it back and checks the quality
+		void BenchEncode(BenchmarkState& state, TextureContainer::Format format, uint32_t channelCount, double minimumPSNR, bool opaque)
+		{
+			std::vector<uint8> pixels = CreateImage(ImageWidth, ImageHeight);
+			if (opaque)
+			{
+				for (std::size_t i = 3; i < pixels.size(); i += 4)
+					pixels[i] = 255;
+			}
+
+			JobSystem jobSystem;
+
+			std::vector<uint8> decoded;
+			std::vector<uint8> blocks = BlockCompression::Encode(format, pixels.data(), ImageWidth, ImageHeight, &jobSystem);
+			double psnr = BlockCompression::Decode(format, blocks.data(), ImageWidth, ImageHeight, decoded) ? PSNR(pixels, decoded, channelCount) : 0.;
+			if (psnr < minimumPSNR)
+				state.Fail("format ", std::to_string(int(format)), " reaches ", std::to_string(psnr), " dB, expected at least ", std::to_string(minimumPSNR));
+
+			state.SetItems(std::size_t(ImageWidth / 4) * (ImageHeight / 4));
+			state.Measure([&]()
+			{
+				blocks = BlockCompression::Encode(format, pixels.data(), ImageWidth, ImageHeight, &jobSystem);
+				DoNotOptimize(blocks);
+			});
+		}
+	}
+
+	ESTEEM_BENCHMARK("Texture/GenerateMipsBox", BenchTextureGenerateMipsBox)
+	{
+		std::vector<uint8> pixels = CreateImage(ImageWidth, ImageHeight);
+
+		state.SetItems(std::size_t(ImageWidth) * ImageHeight);
+		state.Measure([&]()
+		{
+			std::vector<TextureContainer::Mip> mips = TextureContainer::GenerateMipChain(pixels.data(), ImageWidth, ImageHeight, TextureContainer::MipFilter::BOX);
+			DoNotOptimize(mips);
+		});
+	}
+
+	/// \brief also checks that a flat image stays flat, gamma correction and filter weights may not shift it
+	ESTEEM_BENCHMARK("Texture/GenerateMipsKaiser", BenchTextureGenerateMipsKaiser)
+	{
+		std::vector<uint8> flat(std::size_t(37) * 19 * 4, 128);
+		for (auto& mip : TextureContainer::GenerateMipChain(flat.data(), 37, 19, TextureContainer::MipFilter::KAISER))
+		{
+			if (std::any_of(mip.data.begin(), mip.data.end(), [](uint8 value) { return value != 128; }))
+				state.Fail("the ", std::to_string(mip.width), "x", std::to_string(mip.height), " level of a flat image isn't flat");
+		}
+
+		std::vector<uint8> pixels = CreateImage(ImageWidth, ImageHeight);
+
+		state.SetItems(std::size_t(ImageWidth) * ImageHeight);
+		state.Measure([&]()
+		{
+			std::vector<TextureContainer::Mip> mips = TextureContainer::GenerateMipChain(pixels.data(), ImageWidth, ImageHeight, TextureContainer::MipFilter::KAISER);
+			DoNotOptimize(mips);
+		});
+	}
+
+	ESTEEM_BENCHMARK("Texture/EncodeBC1", BenchTextureEncodeBC1)
+	{
+		BenchEncode(state, TextureContainer::Format::BC1, 3, 38., true);
+	}
+
+	ESTEEM_BENCHMARK("Texture/EncodeBC3", BenchTextureEncodeBC3)
+	{
+		BenchEncode(state, TextureContainer::Format::BC3, 4, 40., false);
+	}
+
+	ESTEEM_BENCHMARK("Texture/EncodeBC4", BenchTextureEncodeBC4)
+	{
+		BenchEncode(state, TextureContainer::Format::BC4, 1, 48., false);
+	}
+
+	ESTEEM_BENCHMARK("Texture/EncodeBC5", BenchTextureEncodeBC5)
+	{
+		BenchEncode(state, TextureContainer::Format::BC5, 2, 48., false);
+	}
+
+	ESTEEM_BENCHMARK("Texture/EncodeBC7", BenchTextureEncodeBC7)
+	{
+		BenchEncode(state, TextureContainer::Format::BC7, 4, 42., false);
+	}
+}
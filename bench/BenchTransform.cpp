@@ -0,0 +1,393 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <cppu/cgc/pointers.h>
+
+#include "World/Objects/Transform.h"
+#include "World/Objects/TransformHierarchy.h"
+#include "General/Matrix.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		/// \brief chains of childs under a single root, deep enough to not fit in the cache when walked as pointers
+		constexpr std::size_t ChainCount = 64;
+		constexpr std::size_t ChainDepth = 64;
+
+		/// \brief nodes of the parity forest, a node's parent is one of the 64 nodes before it so the trees get deep
+		constexpr std::size_t ParityCount = 4096;
+		constexpr int32_t ParityWindow = 64;
+		constexpr std::size_t ParityEdits = 256;
+
+		/// \brief nodes and edits of the edit benchmark, roots are never destroyed or moved
+		constexpr std::size_t EditCount = 1 << 16;
+		constexpr std::size_t EditRoots = 64;
+		constexpr std::size_t EditBatch = 256;
+
+		inline Vector3 RandomVector(BenchmarkRandom& random, float range)
+		{
+			return Vector3(random.Between(-range, range), random.Between(-range, range), random.Between(-range, range));
+		}
+
+		inline Quaternion RandomRotation(BenchmarkRandom& random)
+		{
+			return Quaternion(glm::normalize(glm::quat(random.Between(-1.f, 1.f), random.Between(-1.f, 1.f), random.Between(-1.f, 1.f), random.Between(-1.f, 1.f))));
+		}
+
+		/// \brief Transform leaves Update() and LateUpdate() to the world objects, the benchmarks only need the transform part
+		class BenchTransformObject : public Transform
+		{
+		public:
+			using Transform::Transform;
+
+			void Update() override { }
+			void LateUpdate() override { }
+		};
+
+		template<class T>
+		bool SameBits(const T& a, const T& b)
+		{
+			return std::memcmp(&a, &b, sizeof(T)) == 0;
+		}
+
+		/// \brief the values and formulas Transform used before it became a handle into TransformHierarchy
+		struct ReferenceTransform
+		{
+			int32_t parent;
+			Vector3 position;
+			Vector3 scale;
+			Quaternion rotation;
+			Vector3 localPosition;
+			Vector3 localScale;
+			Quaternion localRotation;
+			glm::mat4 matrix;
+		};
+
+		/// \brief a random forest of Transforms next to the same forest as ReferenceTransforms
+		/// Parents always come before their childs, so reparenting to an earlier node can't create a cycle and the
+		/// reference can be updated front to back.
+		struct ParityForest
+		{
+			BenchmarkRandom random;
+			bool scalar;
+
+			// declared before the transforms, they release their handles when destroyed
+			TransformHierarchy hierarchy;
+			std::vector<cgc::strong_ptr<Transform>> transforms;
+			std::vector<ReferenceTransform> reference;
+
+			ParityForest(bool scalar)
+				: scalar(scalar)
+			{ }
+
+			/// \brief a root gets a random world transform, a child a random local transform
+			void SetRandomValues(std::size_t i)
+			{
+				Vector3 position = RandomVector(random, 1.f);
+				Quaternion rotation = RandomRotation(random);
+				Vector3 scale(random.Between(0.9f, 1.1f), random.Between(0.9f, 1.1f), random.Between(0.9f, 1.1f));
+
+				Transform& transform = *transforms[i];
+				ReferenceTransform& node = reference[i];
+				node.localPosition = position;
+				node.localRotation = rotation;
+				node.localScale = scale;
+
+				if (node.parent < 0)
+				{
+					node.position = position;
+					node.rotation = rotation;
+					node.scale = scale;
+
+					transform.SetPosition(position);
+					transform.SetRotation(rotation);
+					transform.SetScale(scale);
+				}
+				else
+				{
+					transform.SetLocalPosition(position);
+					transform.SetLocalRotation(rotation);
+					transform.SetLocalScale(scale);
+				}
+			}
+
+			/// \brief random alive node before i, or -1
+			int32_t RandomParent(std::size_t i)
+			{
+				for (std::size_t attempt = 0; attempt < 4 && i > 0; ++attempt)
+				{
+					int32_t parent = random.Between(std::max(int32_t(i) - ParityWindow, 0), int32_t(i));
+					if (transforms[parent] != nullptr)
+						return parent;
+				}
+
+				return -1;
+			}
+
+			void Add(int32_t parent)
+			{
+				std::size_t i = transforms.size();
+				transforms.push_back(cgc::construct_new<BenchTransformObject>(nullptr, hierarchy));
+				reference.push_back(ReferenceTransform());
+				reference[i].parent = parent;
+
+				if (parent >= 0)
+					Transform::AddChild(transforms[parent], transforms[i]);
+
+				SetRandomValues(i);
+			}
+
+			void SetParent(std::size_t i, int32_t parent)
+			{
+				if (reference[i].parent >= 0)
+					transforms[reference[i].parent]->RemoveChild(transforms[i]);
+
+				if (parent >= 0)
+					Transform::AddChild(transforms[parent], transforms[i]);
+
+				reference[i].parent = parent;
+				SetRandomValues(i);
+			}
+
+			/// \brief the childs become roots that keep the world transform of the last clean up
+			void Destroy(std::size_t i)
+			{
+				if (reference[i].parent >= 0)
+					transforms[reference[i].parent]->RemoveChild(transforms[i]);
+
+				for (std::size_t c = i + 1; c < transforms.size(); ++c)
+				{
+					if (transforms[c] != nullptr && reference[c].parent == int32_t(i))
+					{
+						transforms[i]->RemoveChild(transforms[c]);
+						reference[c].parent = -1;
+					}
+				}
+
+				transforms[i] = nullptr;
+			}
+
+			/// \brief the engine's clean up, followed by the reference's
+			void DirtyCleanUp()
+			{
+				if (scalar)
+					hierarchy.DirtyCleanUpScalar();
+				else
+					hierarchy.DirtyCleanUp();
+
+				for (std::size_t i = 0; i < transforms.size(); ++i)
+				{
+					if (transforms[i] != nullptr && reference[i].parent < 0)
+						transforms[i]->DirtyCleanUp();
+				}
+
+				for (std::size_t i = 0; i < reference.size(); ++i)
+				{
+					if (transforms[i] == nullptr)
+						continue;
+
+					// same operations as Transform::DirtyCleanUp() and Transform::UpdateMatrix() used to do
+					ReferenceTransform& node = reference[i];
+					if (node.parent >= 0)
+					{
+						ReferenceTransform& parent = reference[node.parent];
+						node.scale = parent.scale * node.localScale;
+						node.position = parent.position + (parent.rotation * (parent.scale * node.localPosition));
+						node.rotation = parent.rotation * node.localRotation;
+					}
+
+					node.matrix = Matrix4x4(Matrix3x3(node.rotation), node.scale, node.position);
+				}
+			}
+
+			/// \brief transforms whose values or matrix aren't bit identical to the reference
+			std::size_t Compare()
+			{
+				std::size_t mismatches = 0;
+				for (std::size_t i = 0; i < transforms.size(); ++i)
+				{
+					if (transforms[i] == nullptr)
+						continue;
+
+					Transform& transform = *transforms[i];
+					const ReferenceTransform& node = reference[i];
+					bool same = SameBits(transform.GetPosition(), node.position) && SameBits(transform.GetRotation(), node.rotation)
+						&& SameBits(transform.GetScale(), node.scale) && SameBits(transform.GetMatrix(), node.matrix);
+
+					// recalculating it directly gives the same matrix as the clean up
+					transform.UpdateMatrix();
+					same &= SameBits(transform.GetMatrix(), node.matrix);
+
+					mismatches += !same;
+				}
+
+				return mismatches;
+			}
+
+			/// \brief create, reparent, destroy and recreate nodes, mismatches after each step
+			std::array<std::size_t, 3> Run()
+			{
+				std::array<std::size_t, 3> mismatches;
+				for (std::size_t i = 0; i < ParityCount; ++i)
+					Add(random.Between(0, 64) == 0 ? -1 : RandomParent(i));
+
+				DirtyCleanUp();
+				mismatches[0] = Compare();
+
+				// move nodes under an earlier node or make them roots
+				for (std::size_t e = 0; e < ParityEdits; ++e)
+				{
+					std::size_t i = std::size_t(random.Between(1, int32_t(ParityCount)));
+					if (transforms[i] != nullptr)
+						SetParent(i, random.Between(0, 8) == 0 ? -1 : RandomParent(i));
+				}
+
+				DirtyCleanUp();
+				mismatches[1] = Compare();
+
+				// destroy nodes, their handles are released at the next clean up, then add new ones
+				for (std::size_t e = 0; e < ParityEdits; ++e)
+				{
+					std::size_t i = std::size_t(random.Between(0, int32_t(ParityCount)));
+					if (transforms[i] != nullptr)
+						Destroy(i);
+				}
+
+				for (std::size_t e = 0; e < ParityEdits; ++e)
+					Add(RandomParent(transforms.size()));
+
+				DirtyCleanUp();
+				mismatches[2] = Compare();
+
+				return mismatches;
+			}
+		};
+	}
+
+	ESTEEM_BENCHMARK("Transform/DirtyCleanUp", BenchTransformDirtyCleanUp)
+	{
+		BenchmarkRandom random;
+		TransformHierarchy hierarchy;
+
+		// transforms without a world, SetDirty() isn't used as the root is cleaned directly
+		cgc::strong_ptr<Transform> root = cgc::construct_new<BenchTransformObject>(nullptr, hierarchy);
+		std::vector<cgc::strong_ptr<Transform>> transforms;
+
+		for (std::size_t chain = 0; chain < ChainCount; ++chain)
+		{
+			cgc::strong_ptr<Transform> parent = root;
+			for (std::size_t depth = 0; depth < ChainDepth; ++depth)
+			{
+				cgc::strong_ptr<Transform> child = cgc::construct_new<BenchTransformObject>(nullptr, hierarchy);
+				child->SetPosition(RandomVector(random, 10.f));
+				Transform::AddChild(parent, child);
+
+				transforms.push_back(child);
+				parent = child;
+			}
+		}
+
+		hierarchy.DirtyCleanUp();
+
+		// the same work as a frame of GameEngine::ThreadLoop1() when the root moves
+		float angle = 0.f;
+		state.SetItems(transforms.size());
+		state.Measure([&]()
+		{
+			angle += 0.01f;
+			root->SetRotation(Quaternion(glm::angleAxis(angle, glm::vec3(0.f, 1.f, 0.f))));
+			hierarchy.DirtyCleanUp();
+			root->DirtyCleanUp();
+
+			DoNotOptimize(transforms.back()->GetMatrix());
+		});
+	}
+
+	ESTEEM_BENCHMARK("Transform/HierarchyDirtyCleanUp", BenchTransformHierarchyDirtyCleanUp)
+	{
+		BenchmarkRandom random;
+		TransformHierarchy hierarchy;
+
+		TransformId root = hierarchy.Create();
+		std::vector<TransformId> transforms;
+
+		for (std::size_t chain = 0; chain < ChainCount; ++chain)
+		{
+			TransformId parent = root;
+			for (std::size_t depth = 0; depth < ChainDepth; ++depth)
+			{
+				TransformId child = hierarchy.Create(parent);
+				hierarchy.SetLocalPosition(child, RandomVector(random, 10.f));
+
+				transforms.push_back(child);
+				parent = child;
+			}
+		}
+
+		hierarchy.DirtyCleanUp();
+
+		float angle = 0.f;
+		state.SetItems(transforms.size());
+		state.Measure([&]()
+		{
+			// touching the root dirties everything below it
+			angle += 0.01f;
+			hierarchy.SetLocalRotation(root, Quaternion(glm::angleAxis(angle, glm::vec3(0.f, 1.f, 0.f))));
+			hierarchy.DirtyCleanUp();
+
+			DoNotOptimize(hierarchy.GetMatrix(transforms.back()));
+		});
+	}
+
+	/// \brief also checks that Transforms in the hierarchy give bit for bit the values and matrices of the formulas Transform
+	/// used before, on a random forest that is reparented and partly destroyed, cleaned up with and without SIMD
+	ESTEEM_BENCHMARK("Transform/HierarchyEdit", BenchTransformHierarchyEdit)
+	{
+		for (bool scalar : { false, true })
+		{
+			ParityForest forest(scalar);
+			std::array<std::size_t, 3> mismatches = forest.Run();
+
+			const char* cleanUp = scalar ? "DirtyCleanUpScalar()" : "DirtyCleanUp()";
+			ESTEEM_BENCH_CHECK(mismatches[0] == 0, std::to_string(mismatches[0]), " transforms differ from the reference after creating the forest, using ", cleanUp);
+			ESTEEM_BENCH_CHECK(mismatches[1] == 0, std::to_string(mismatches[1]), " transforms differ from the reference after reparenting, using ", cleanUp);
+			ESTEEM_BENCH_CHECK(mismatches[2] == 0, std::to_string(mismatches[2]), " transforms differ from the reference after destroying, using ", cleanUp);
+		}
+
+		// every destroyed node is recreated under a root and takes over one other node
+		BenchmarkRandom random;
+		TransformHierarchy hierarchy;
+
+		std::vector<TransformId> roots;
+		for (std::size_t i = 0; i < EditRoots; ++i)
+			roots.push_back(hierarchy.Create());
+
+		std::vector<TransformId> transforms;
+		for (std::size_t i = 0; i < EditCount; ++i)
+			transforms.push_back(hierarchy.Create(roots[std::size_t(random.Between(0, int32_t(EditRoots)))]));
+
+		hierarchy.DirtyCleanUp();
+
+		state.SetItems(EditBatch);
+		state.Measure([&]()
+		{
+			for (std::size_t e = 0; e < EditBatch; ++e)
+			{
+				std::size_t i = std::size_t(random.Between(0, int32_t(EditCount)));
+				hierarchy.Destroy(transforms[i]);
+				transforms[i] = hierarchy.Create(roots[std::size_t(random.Between(0, int32_t(EditRoots)))]);
+
+				// the new node has no childs and a root as parent, so this can't create a cycle
+				std::size_t other = std::size_t(random.Between(0, int32_t(EditCount)));
+				if (other != i)
+					hierarchy.SetParent(transforms[other], transforms[i]);
+			}
+
+			DoNotOptimize(hierarchy.GetCount());
+		});
+	}
+}
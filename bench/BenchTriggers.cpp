@@ -0,0 +1,37 @@
+#include "Benchmark.h"
+
+#include <memory>
+
+#include "World/Systems/TriggerSystem/TriggerSystem.h"
+
+namespace Esteem
+{
+	ESTEEM_BENCHMARK("TriggerSystem/TriggerDelayed", BenchTriggerDelayed)
+	{
+		constexpr std::size_t serieCount = 2048;
+
+		BenchmarkRandom random;
+
+		// distinct series, the system keys its pending series on their address
+		std::vector<TriggerCommandSerie> series(serieCount);
+		std::vector<std::chrono::microseconds> delays(serieCount);
+		for (std::size_t i = 0; i < serieCount; ++i)
+		{
+			series[i].commands.push_back(TriggerCommand::CreateTriggerCommand("bench_trigger", int(i)));
+			delays[i] = std::chrono::microseconds(random.Between(0, 10000000));
+		}
+
+		std::unique_ptr<TriggerSystem> triggerSystem;
+
+		state.SetItems(serieCount);
+		state.Measure([&]()
+		{
+			triggerSystem = std::make_unique<TriggerSystem>();
+		},
+		[&]()
+		{
+			for (std::size_t i = 0; i < serieCount; ++i)
+				triggerSystem->TriggerDelayed(series[i], delays[i]);
+		});
+	}
+}
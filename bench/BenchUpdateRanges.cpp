@@ -0,0 +1,250 @@
+#include "Benchmark.h"
+
+#include <deque>
+#include <memory>
+#include <cppu/cgc/pointers.h>
+
+#include "World/UpdateRanges.h"
+#include "World/World.h"
+#include "World/Constituents/AbstractComponent.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr std::size_t EntityCount = 100000;
+		constexpr std::size_t WorldObjectCount = 1000;
+		/// \brief one in this many objects isn't thread safe
+		constexpr std::size_t SerialEvery = 10;
+
+		/// \brief counts its update calls, the objects that aren't thread safe also remember their order in the serial tail
+		class BenchWorldObject : public IWorldObject
+		{
+		private:
+			bool threadSafe;
+			std::size_t* serialCounter;
+
+		public:
+			uint updates;
+			uint lateUpdates;
+			std::size_t serialOrder;
+			std::size_t thread;
+
+			BenchWorldObject(bool threadSafe = true, std::size_t* serialCounter = nullptr)
+				: threadSafe(threadSafe)
+				, serialCounter(serialCounter)
+				, updates(0)
+				, lateUpdates(0)
+				, serialOrder(0)
+				, thread(0)
+			{ }
+
+			virtual void Update()
+			{
+				++updates;
+				thread = JobSystem::GetThreadIndex();
+				if (!threadSafe)
+					serialOrder = (*serialCounter)++;
+			}
+
+			virtual void LateUpdate()
+			{
+				++lateUpdates;
+				thread = JobSystem::GetThreadIndex();
+			}
+
+			virtual World* GetWorld() { return nullptr; }
+			virtual bool IsThreadSafeUpdate() const { return threadSafe; }
+		};
+
+		typedef UpdateRanges<std::deque<BenchWorldObject>::iterator, std::vector<std::unique_ptr<BenchWorldObject>>::iterator> BenchUpdateRanges;
+
+		/// \brief entities in a few deques like the arrays of an m_array, so the ranges can't rely on contiguous memory
+		struct BenchWorld
+		{
+			std::size_t serialCounter;
+			std::vector<std::deque<BenchWorldObject>> entities;
+			std::vector<std::unique_ptr<BenchWorldObject>> worldObjects;
+
+			BenchWorld()
+				: serialCounter(0)
+				, entities(3)
+			{
+				for (std::size_t i = 0; i < EntityCount; ++i)
+					entities[i * 7 % entities.size()].emplace_back(i % SerialEvery != 0, &serialCounter);
+
+				for (std::size_t i = 0; i < WorldObjectCount; ++i)
+					worldObjects.emplace_back(std::make_unique<BenchWorldObject>(i % SerialEvery != 0, &serialCounter));
+			}
+
+			void Build(BenchUpdateRanges& ranges)
+			{
+				ranges.Clear();
+				for (auto& array : entities)
+					ranges.AddObjects(array.begin(), array.end(), 32 * 1024 / sizeof(BenchWorldObject));
+
+				ranges.AddPointers(worldObjects.begin(), worldObjects.end(), 64);
+			}
+
+			template<typename F>
+			void ForEach(F&& function)
+			{
+				for (auto& array : entities)
+				{
+					for (BenchWorldObject& object : array)
+						function(object);
+				}
+
+				for (auto& object : worldObjects)
+					function(*object);
+			}
+		};
+
+		constexpr std::size_t WorldEntityCount = 20000;
+
+		/// \brief a game component that only moves its own entity, it opts in to the parallel pass
+		class BenchMoveComponent : public AbstractComponent
+		{
+		private:
+			Entity& owner;
+
+		public:
+			uint updates;
+			uint lateUpdates;
+
+			BenchMoveComponent(const cgc::strong_ptr<Entity>& entity)
+				: AbstractComponent(entity)
+				, owner(*entity)
+				, updates(0)
+				, lateUpdates(0)
+			{ }
+
+			virtual void Initialize() override { }
+
+			virtual void Update() override
+			{
+				++updates;
+				owner.SetPosition(owner.GetPosition() + Vector3(0.01f, 0.f, 0.f));
+			}
+
+			virtual void LateUpdate() override { ++lateUpdates; }
+
+			virtual bool IsThreadSafeUpdate() const override { return true; }
+		};
+
+		/// \brief a game component that touches shared state and doesn't opt in, its entity goes to the serial tail
+		class BenchSharedComponent : public AbstractComponent
+		{
+		private:
+			std::size_t* updates;
+			std::size_t* offThread;
+
+		public:
+			BenchSharedComponent(const cgc::strong_ptr<Entity>& entity, std::size_t* updates, std::size_t* offThread)
+				: AbstractComponent(entity)
+				, updates(updates)
+				, offThread(offThread)
+			{ }
+
+			virtual void Initialize() override { }
+
+			virtual void Update() override
+			{
+				++*updates;
+				*offThread += JobSystem::GetThreadIndex() != 0;
+			}
+		};
+	}
+
+	/// \brief also checks that every object is updated once per phase and the serial tail runs in order on the calling thread
+	ESTEEM_BENCHMARK("UpdateRanges/Update", BenchUpdateRangesUpdate)
+	{
+		JobSystem jobSystem(3);
+		BenchWorld world;
+		BenchUpdateRanges ranges;
+
+		world.Build(ranges);
+		ranges.Run(jobSystem, false);
+
+		std::size_t serialObjects = (EntityCount + WorldObjectCount + SerialEvery - 1) / SerialEvery;
+		ESTEEM_BENCH_CHECK(ranges.GetSerialCount() == serialObjects, std::to_string(ranges.GetSerialCount()), " objects in the serial tail, expected ", std::to_string(serialObjects));
+
+		world.Build(ranges);
+		ranges.Run(jobSystem, true);
+
+		std::size_t wrongCalls = 0, wrongSerial = 0, serialOrder = 0;
+		world.ForEach([&](const BenchWorldObject& object)
+		{
+			wrongCalls += object.updates != 1 || object.lateUpdates != 1;
+			if (!object.IsThreadSafeUpdate())
+				wrongSerial += object.serialOrder != serialOrder++ || object.thread != 0;
+		});
+
+		ESTEEM_BENCH_CHECK(wrongCalls == 0, std::to_string(wrongCalls), " objects weren't updated exactly once per phase");
+		ESTEEM_BENCH_CHECK(wrongSerial == 0, std::to_string(wrongSerial), " objects that aren't thread safe were updated out of order or on a worker");
+
+		state.SetItems(EntityCount + WorldObjectCount);
+		state.Measure([&]()
+		{
+			world.Build(ranges);
+			ranges.Run(jobSystem, false);
+		});
+		}
+
+	/// \brief the update passes over the entities of a real world, the way the GameEngine builds and runs them
+	/// Entities without components or with only thread safe ones take the parallel path, the others the serial tail.
+	ESTEEM_BENCHMARK("UpdateRanges/World", BenchUpdateRangesWorld)
+	{
+		JobSystem jobSystem(3);
+		cgc::strong_ptr<World> world = cgc::construct_new<World>(false, false);
+
+		std::size_t sharedUpdates = 0, offThread = 0, sharedEntities = 0;
+		std::vector<cgc::strong_ptr<Entity>> entities;
+		std::vector<cgc::strong_ptr<BenchMoveComponent>> moveComponents;
+		for (std::size_t i = 0; i < WorldEntityCount; ++i)
+		{
+			entities.push_back(world->CreateEntity());
+			const cgc::strong_ptr<Entity>& entity = entities.back();
+
+			// one in ten has only a shared component, one in ten no components at all
+			if (i % SerialEvery == 0)
+			{
+				Entity::AddComponent(entity, cgc::construct_new<BenchSharedComponent>(entity, &sharedUpdates, &offThread));
+				++sharedEntities;
+			}
+			else if (i % SerialEvery != 1)
+			{
+				moveComponents.push_back(cgc::construct_new<BenchMoveComponent>(entity));
+				Entity::AddComponent(entity, moveComponents.back());
+			}
+		}
+
+		World::WorldUpdateRanges ranges;
+		world->BuildUpdateRanges(ranges);
+		ranges.Run(jobSystem, false);
+
+		ESTEEM_BENCH_CHECK(ranges.GetSerialCount() == sharedEntities, std::to_string(ranges.GetSerialCount()), " entities in the serial tail, expected ", std::to_string(sharedEntities));
+
+		world->BuildUpdateRanges(ranges);
+		ranges.Run(jobSystem, true);
+
+		std::size_t wrongCalls = 0;
+		for (auto& component : moveComponents)
+			wrongCalls += component->updates != 1 || component->lateUpdates != 1;
+
+		ESTEEM_BENCH_CHECK(wrongCalls == 0, std::to_string(wrongCalls), " thread safe components weren't updated exactly once per phase");
+		ESTEEM_BENCH_CHECK(sharedUpdates == sharedEntities, std::to_string(sharedUpdates), " updates of shared components, expected ", std::to_string(sharedEntities));
+		ESTEEM_BENCH_CHECK(offThread == 0, std::to_string(offThread), " shared components were updated on a worker");
+
+		state.SetItems(WorldEntityCount);
+		state.Measure([&]()
+		{
+			world->BuildUpdateRanges(ranges);
+			ranges.Run(jobSystem, false);
+		});
+
+		moveComponents.clear();
+		entities.clear();
+		world = cgc::strong_ptr<World>();
+	}
+}
@@ -0,0 +1,169 @@
+#include "Benchmark.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace Esteem
+{
+	BenchmarkState::BenchmarkState(std::size_t samples, std::chrono::nanoseconds minSampleTime)
+		: samples(std::max<std::size_t>(1, samples))
+		, minSampleTime(minSampleTime)
+		, items(1)
+		, iterations(0)
+	{ }
+
+	void BenchmarkState::AddFailure(std::string message)
+	{
+		std::cerr << "  failed: " << message << std::endl;
+		failures.emplace_back(std::move(message));
+	}
+
+	std::vector<Benchmarks::Entry>& Benchmarks::GetEntries()
+	{
+		// function local, registration happens during static initialization of the other translation units
+		static std::vector<Entry> entries;
+		return entries;
+	}
+
+	bool Benchmarks::Register(const char* name, Function function)
+	{
+		GetEntries().push_back(Entry{ name, function });
+		return true;
+	}
+
+	std::vector<std::string> Benchmarks::GetNames()
+	{
+		std::vector<std::string> names;
+		for (auto& entry : GetEntries())
+			names.emplace_back(entry.name);
+
+		std::sort(names.begin(), names.end());
+		return names;
+	}
+
+	std::vector<BenchmarkResult> Benchmarks::Run(const std::string& filter, std::size_t samples, std::chrono::nanoseconds minSampleTime, std::vector<std::string>& failed)
+	{
+		// sorted so the output order doesn't depend on the link order
+		std::vector<Entry> entries = GetEntries();
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return std::string(a.name) < std::string(b.name); });
+
+		std::vector<BenchmarkResult> results;
+		for (auto& entry : entries)
+		{
+			if (!filter.empty() && std::string(entry.name).find(filter) == std::string::npos)
+				continue;
+
+			std::cerr << "running " << entry.name << std::endl;
+
+			BenchmarkState state(samples, minSampleTime);
+			entry.function(state);
+
+			if (state.HasFailed())
+				failed.emplace_back(entry.name);
+
+			if (state.results.empty())
+			{
+				std::cerr << "  " << entry.name << " didn't call Measure(), skipped" << std::endl;
+				continue;
+			}
+
+			std::vector<double> sorted = state.results;
+			std::sort(sorted.begin(), sorted.end());
+
+			BenchmarkResult& result = results.emplace_back();
+			result.name = entry.name;
+			result.iterations = state.iterations;
+			result.samples = sorted.size();
+			result.items = state.items;
+			result.medianNs = sorted.size() % 2 ? sorted[sorted.size() / 2] : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) * 0.5;
+			result.minNs = sorted.front();
+			result.maxNs = sorted.back();
+			result.failures = state.failures.size();
+		}
+
+		return results;
+	}
+
+	std::string Benchmarks::ToJSON(const std::vector<BenchmarkResult>& results)
+	{
+		rapidjson::StringBuffer buffer;
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+		writer.StartObject();
+		writer.Key("seed");
+		writer.Uint64(BenchmarkSeed);
+		writer.Key("benchmarks");
+		writer.StartArray();
+
+		for (auto& result : results)
+		{
+			writer.StartObject();
+			writer.Key("name"); writer.String(result.name.c_str(), rapidjson::SizeType(result.name.size()));
+			writer.Key("iterations"); writer.Uint64(result.iterations);
+			writer.Key("samples"); writer.Uint64(result.samples);
+			writer.Key("items"); writer.Uint64(result.items);
+			writer.Key("median_ns"); writer.Double(result.medianNs);
+			writer.Key("min_ns"); writer.Double(result.minNs);
+			writer.Key("max_ns"); writer.Double(result.maxNs);
+			writer.Key("items_per_second"); writer.Double(result.medianNs > 0. ? double(result.items) * 1e9 / result.medianNs : 0.);
+			writer.Key("failures"); writer.Uint64(result.failures);
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+		writer.EndObject();
+
+		return std::string(buffer.GetString(), buffer.GetSize());
+	}
+
+	int Benchmarks::CompareToBaseline(const std::vector<BenchmarkResult>& results, const std::string& baselinePath, double thresholdPercent)
+	{
+		std::ifstream file(baselinePath, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cerr << "couldn't open baseline \"" << baselinePath << "\"" << std::endl;
+			return -1;
+		}
+
+		std::stringstream contents;
+		contents << file.rdbuf();
+
+		rapidjson::Document baseline;
+		if (baseline.Parse(contents.str().c_str()).HasParseError() || !baseline.IsObject()
+			|| !baseline.HasMember("benchmarks") || !baseline["benchmarks"].IsArray())
+		{
+			std::cerr << "baseline \"" << baselinePath << "\" isn't an EsteemBench result file" << std::endl;
+			return -1;
+		}
+
+		std::unordered_map<std::string, double> medians;
+		for (auto& benchmark : baseline["benchmarks"].GetArray())
+		{
+			if (benchmark.HasMember("name") && benchmark.HasMember("median_ns"))
+				medians[benchmark["name"].GetString()] = benchmark["median_ns"].GetDouble();
+		}
+
+		int regressions = 0;
+		for (auto& result : results)
+		{
+			auto found = medians.find(result.name);
+			if (found == medians.end() || found->second <= 0.)
+				continue;
+
+			double change = (result.medianNs / found->second - 1.) * 100.;
+			if (change > thresholdPercent)
+			{
+				std::cerr << "regression: " << result.name << " " << found->second << "ns -> " << result.medianNs << "ns (+" << change << "%)" << std::endl;
+				++regressions;
+			}
+		}
+
+		return regressions;
+	}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define ESTEEM_BENCHMARK_CONCAT_DETAIL(a, b) a##b
+#define ESTEEM_BENCHMARK_CONCAT(a, b) ESTEEM_BENCHMARK_CONCAT_DETAIL(a, b)
+
+/// \brief register a benchmark function, e.g.: ESTEEM_BENCHMARK("Octree/Insert", BenchOctreeInsert)
+#define ESTEEM_BENCHMARK(name, function) \
+	static void function(::Esteem::BenchmarkState& state); \
+	static const bool ESTEEM_BENCHMARK_CONCAT(function, Registered) = ::Esteem::Benchmarks::Register(name, &function); \
+	static void function(::Esteem::BenchmarkState& state)
+
+/// \brief fail the running benchmark when condition is false, the message parts are written after the condition
+/// Expects the BenchmarkState to be called state, like it is in ESTEEM_BENCHMARK functions.
+#define ESTEEM_BENCH_CHECK(condition, ...) \
+	do { if (!(condition)) state.Fail(#condition, ": ", __VA_ARGS__); } while (false)
+
+namespace Esteem
+{
+	/// \brief seed every benchmark starts its data with, keeps runs comparable between commits
+	constexpr uint64_t BenchmarkSeed = 0x5EED5EED5EED5EEDull;
+
+	/// \brief xorshift generator, unlike the std distributions it gives the same numbers on every platform
+	class BenchmarkRandom
+	{
+	private:
+		uint64_t state;
+
+	public:
+		BenchmarkRandom(uint64_t seed = BenchmarkSeed)
+			: state(seed ? seed : 1)
+		{ }
+
+		inline uint64_t Next()
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state;
+		}
+
+		/// \brief value in [min, max)
+		inline float Between(float min, float max)
+		{
+			return min + float(Next() >> 40) * (1.f / float(1 << 24)) * (max - min);
+		}
+
+		/// \brief value in [min, max)
+		inline int32_t Between(int32_t min, int32_t max)
+		{
+			return min + int32_t(Next() % uint64_t(max - min));
+		}
+	};
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		/// \brief iterations per sample
+		std::size_t iterations;
+		std::size_t samples;
+		/// \brief items processed per iteration, e.g.: amount of boxes tested
+		std::size_t items;
+		double medianNs;
+		double minNs;
+		double maxNs;
+		/// \brief checks of the benchmark that failed
+		std::size_t failures;
+	};
+
+	/// \brief passed to every benchmark, the benchmark prepares its data and calls Measure() once
+	class BenchmarkState
+	{
+	friend class Benchmarks;
+
+	private:
+		std::size_t samples;
+		std::chrono::nanoseconds minSampleTime;
+		std::size_t items;
+
+		/// \brief nanoseconds per iteration, one entry per sample
+		std::vector<double> results;
+		std::size_t iterations;
+
+		std::vector<std::string> failures;
+
+		void AddFailure(std::string message);
+
+	public:
+		BenchmarkState(std::size_t samples, std::chrono::nanoseconds minSampleTime);
+
+		/// \brief amount of items a single iteration handles, used for the items per second output
+		inline void SetItems(std::size_t items) { this->items = items; }
+
+		/// \brief time body(), the iteration count is raised until a sample takes at least the minimum sample time
+		template<typename F>
+		void Measure(F&& body);
+
+		/// \brief time body() only, reset() runs untimed before every iteration
+		template<typename R, typename F>
+		void Measure(R&& reset, F&& body);
+
+		/// \brief record a failed check, the benchmark keeps running and EsteemBench exits with 1 once all are done
+		/// \param message parts are written one after the other, anything an std::ostream takes
+		template<typename... Args>
+		void Fail(const Args&... message);
+
+		inline bool HasFailed() const { return !failures.empty(); }
+		inline const std::vector<std::string>& GetFailures() const { return failures; }
+	};
+
+	class Benchmarks
+	{
+	public:
+		typedef void(*Function)(BenchmarkState&);
+
+	private:
+		struct Entry
+		{
+			const char* name;
+			Function function;
+		};
+
+		static std::vector<Entry>& GetEntries();
+
+	public:
+		static bool Register(const char* name, Function function);
+
+		/// \brief run every benchmark of which the name contains filter
+		/// \param failed receives the names of the benchmarks of which a check failed, also when they didn't measure
+		static std::vector<BenchmarkResult> Run(const std::string& filter, std::size_t samples, std::chrono::nanoseconds minSampleTime, std::vector<std::string>& failed);
+		static std::vector<std::string> GetNames();
+
+		static std::string ToJSON(const std::vector<BenchmarkResult>& results);
+
+		/// \brief compare against an earlier ToJSON() output
+		/// \return amount of benchmarks whose median is more than thresholdPercent slower, -1 if the baseline couldn't be read
+		static int CompareToBaseline(const std::vector<BenchmarkResult>& results, const std::string& baselinePath, double thresholdPercent);
+	};
+
+	/// \brief keep the optimizer from removing a computation that's only done for the benchmark
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(_MSC_VER)
+		static volatile const void* sink;
+		sink = &value;
+#else
+		asm volatile("" : : "g"(&value) : "memory");
+#endif
+	}
+}
+
+#include "./Benchmark.inl"
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Benchmark.h"
+
+namespace Esteem
+{
+	template<typename F>
+	void BenchmarkState::Measure(F&& body)
+	{
+		typedef std::chrono::steady_clock clock;
+
+		// warm up and find an iteration count that fills a sample
+		body();
+		iterations = 1;
+		for (;;)
+		{
+			auto begin = clock::now();
+			for (std::size_t i = 0; i < iterations; ++i)
+				body();
+			auto elapsed = clock::now() - begin;
+
+			if (elapsed >= minSampleTime || iterations >= (std::size_t(1) << 30))
+				break;
+
+			iterations *= elapsed.count() > 0 ? std::clamp<std::size_t>(std::size_t(minSampleTime / elapsed), 2, 10) : 10;
+		}
+
+		results.clear();
+		for (std::size_t sample = 0; sample < samples; ++sample)
+		{
+			auto begin = clock::now();
+			for (std::size_t i = 0; i < iterations; ++i)
+				body();
+			std::chrono::duration<double, std::nano> elapsed = clock::now() - begin;
+
+			results.push_back(elapsed.count() / double(iterations));
+		}
+	}
+
+	template<typename... Args>
+	void BenchmarkState::Fail(const Args&... message)
+	{
+		std::ostringstream stream;
+		(stream << ... << message);
+		AddFailure(stream.str());
+	}
+
+	template<typename R, typename F>
+	void BenchmarkState::Measure(R&& reset, F&& body)
+	{
+		typedef std::chrono::steady_clock clock;
+
+		reset();
+		body();
+
+		// every iteration is timed on its own, meant for bodies that take well over a microsecond
+		results.clear();
+		iterations = 0;
+		for (std::size_t sample = 0; sample < samples; ++sample)
+		{
+			std::chrono::nanoseconds sampleTime(0);
+			std::size_t sampleIterations = 0;
+			while (sampleTime < minSampleTime || sampleIterations == 0)
+			{
+				reset();
+
+				auto begin = clock::now();
+				body();
+				sampleTime += clock::now() - begin;
+
+				++sampleIterations;
+			}
+
+			iterations = std::max(iterations, sampleIterations);
+			results.push_back(double(sampleTime.count()) / double(sampleIterations));
+		}
+	}
+}
@@ -0,0 +1,60 @@
+# starts several EsteemBench processes at once that all write the same derived data cache entries into one directory
+# cmake -DBENCH=<EsteemBench> -DDIRECTORY=<cache directory> [-DWORKERS=<count>] -P DerivedDataCacheWriters.cmake
+cmake_minimum_required(VERSION 3.10)
+
+if(NOT BENCH OR NOT DIRECTORY)
+	message(FATAL_ERROR "BENCH and DIRECTORY are required")
+endif()
+
+# a single worker, its output is kept off stdout since the workers are chained by pipes
+if(WORKER)
+	set(ENV{ESTEEM_BENCH_DDC_SHARED} "${DIRECTORY}")
+	execute_process(
+		COMMAND "${BENCH}" --filter DerivedDataCache/SharedDirectory --samples 5 --min-time 50 --out "${DIRECTORY}-worker${WORKER}.json"
+		OUTPUT_VARIABLE OUTPUT
+		ERROR_VARIABLE OUTPUT
+		RESULT_VARIABLE RESULT
+	)
+
+	if(NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "worker ${WORKER} failed: ${RESULT}\n${OUTPUT}")
+	endif()
+
+	return()
+endif()
+
+if(NOT WORKERS)
+	set(WORKERS 4)
+endif()
+
+file(REMOVE_RECURSE "${DIRECTORY}")
+
+# the commands of a single execute_process run at the same time
+set(COMMANDS)
+foreach(INDEX RANGE 1 ${WORKERS})
+	list(APPEND COMMANDS COMMAND "${CMAKE_COMMAND}" "-DBENCH=${BENCH}" "-DDIRECTORY=${DIRECTORY}" "-DWORKER=${INDEX}" -P "${CMAKE_CURRENT_LIST_FILE}")
+endforeach()
+
+execute_process(${COMMANDS} RESULTS_VARIABLE RESULTS)
+
+foreach(RESULT ${RESULTS})
+	if(NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "a worker failed: ${RESULTS}")
+	endif()
+endforeach()
+
+# the workers checked every entry they read, here all SharedCount entries must exist and no writer left its temporary file behind
+file(GLOB_RECURSE ENTRIES "${DIRECTORY}/*.ddc")
+file(GLOB_RECURSE TEMPORARIES "${DIRECTORY}/*.tmp")
+list(LENGTH ENTRIES ENTRY_COUNT)
+list(LENGTH TEMPORARIES TEMPORARY_COUNT)
+
+if(NOT ENTRY_COUNT EQUAL 64)
+	message(FATAL_ERROR "${ENTRY_COUNT} entries in ${DIRECTORY}, expected 64")
+endif()
+if(NOT TEMPORARY_COUNT EQUAL 0)
+	message(FATAL_ERROR "${TEMPORARY_COUNT} temporary files were left in ${DIRECTORY}")
+endif()
+
+file(GLOB RESULT_FILES "${DIRECTORY}-worker*.json")
+file(REMOVE_RECURSE "${DIRECTORY}" ${RESULT_FILES})
@@ -0,0 +1,102 @@
+#include "Benchmark.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace Esteem;
+
+static void PrintUsage()
+{
+	std::cerr <<
+		"EsteemBench [options]\n"
+		"  --filter <text>      only run benchmarks of which the name contains text\n"
+		"  --samples <n>        samples per benchmark (default 15)\n"
+		"  --min-time <ms>      minimum time per sample (default 20)\n"
+		"  --out <file>         write the JSON results to file instead of stdout\n"
+		"  --baseline <file>    compare against an earlier result file\n"
+		"  --threshold <pct>    allowed slowdown against the baseline (default 10)\n"
+		"  --list               print the benchmark names\n"
+		"exits with 1 when a check of a benchmark failed or a benchmark regressed against the baseline\n";
+}
+
+int main(int argc, char** argv)
+{
+	std::string filter;
+	std::string outPath;
+	std::string baselinePath;
+	std::size_t samples = 15;
+	long minTimeMs = 20;
+	double threshold = 10.;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (strcmp(argument, "--list") == 0)
+		{
+			for (auto& name : Benchmarks::GetNames())
+				std::cout << name << "\n";
+			return 0;
+		}
+		else if (strcmp(argument, "--help") == 0 || strcmp(argument, "-h") == 0)
+		{
+			PrintUsage();
+			return 0;
+		}
+		else if (value == nullptr)
+		{
+			PrintUsage();
+			return 2;
+		}
+		else if (strcmp(argument, "--filter") == 0)
+			filter = value;
+		else if (strcmp(argument, "--samples") == 0)
+			samples = std::size_t(std::strtoul(value, nullptr, 10));
+		else if (strcmp(argument, "--min-time") == 0)
+			minTimeMs = std::strtol(value, nullptr, 10);
+		else if (strcmp(argument, "--out") == 0)
+			outPath = value;
+		else if (strcmp(argument, "--baseline") == 0)
+			baselinePath = value;
+		else if (strcmp(argument, "--threshold") == 0)
+			threshold = std::strtod(value, nullptr);
+		else
+		{
+			PrintUsage();
+			return 2;
+		}
+
+		++i;
+	}
+
+	std::vector<std::string> failed;
+	std::vector<BenchmarkResult> results = Benchmarks::Run(filter, samples, std::chrono::milliseconds(std::max(1l, minTimeMs)), failed);
+	std::string json = Benchmarks::ToJSON(results);
+
+	if (outPath.empty())
+		std::cout << json << std::endl;
+	else
+		std::ofstream(outPath, std::ios::binary | std::ios::trunc) << json << "\n";
+
+	int exitCode = 0;
+	if (!failed.empty())
+	{
+		std::cerr << failed.size() << " benchmark(s) failed their checks:" << std::endl;
+		for (auto& name : failed)
+			std::cerr << "  " << name << std::endl;
+
+		exitCode = 1;
+	}
+
+	if (!baselinePath.empty())
+	{
+		int regressions = Benchmarks::CompareToBaseline(results, baselinePath, threshold);
+		if (regressions != 0)
+			exitCode = 1;
+	}
+
+	return exitCode;
+}
@@ -0,0 +1,232 @@
+#include "Converters.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "CookFactory.h"
+#include "Model/AssimpModelLoader.h"
+#include "Model/NativeModelLoader.h"
+#include "Rendering/Objects/BlockCompression.h"
+#include "Rendering/Objects/Image.h"
+#include "Rendering/Objects/TextureContainer.h"
+#include "Rendering/RenderingFactory.h"
+#include "Threading/JobSystem.h"
+#include "Utils/CookedAssets.h"
+#include "Utils/CPreProcessor.h"
+#include "Utils/Data.h"
+#include "Utils/Debug.h"
+#include "Utils/PakArchive.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		inline std::string_view GetExtension(std::string_view path)
+		{
+			std::size_t dot = path.rfind('.');
+			std::size_t slash = path.rfind('/');
+			if (dot == std::string_view::npos || (slash != std::string_view::npos && dot < slash))
+				return std::string_view();
+
+			return path.substr(dot + 1);
+		}
+
+		inline bool StartsWith(std::string_view string, std::string_view start)
+		{
+			return string.size() >= start.size() && string.compare(0, start.size(), start) == 0;
+		}
+
+		/// \brief engine paths start at the current directory, e.g.: "./resources/models/"
+		inline std::string_view StripCurrentDirectory(std::string_view path)
+		{
+			return StartsWith(path, "./") ? path.substr(2) : path;
+		}
+
+		inline CookOutput& AddSourceCopy(CookItem& item, std::string&& contents)
+		{
+			item.outputs.push_back(CookOutput{ PakArchive::NormalizePath(item.source), std::move(contents), false });
+			return item.outputs.back();
+		}
+	}
+
+	bool ModelConverter::EqualsSearch(std::string_view sourcePath) const
+	{
+		std::string_view extension = GetExtension(sourcePath);
+
+		// only models below the models directory are loaded through the ModelFactory, other ones are copied
+		return StartsWith(sourcePath, StripCurrentDirectory(RESOURCES_PATH + MODELS_PATH))
+			&& !extension.empty() && extension != "mdl"
+			&& AssimpModelLoader().EqualsSearch(extension);
+	}
+
+	bool ModelConverter::Convert(CookItem& item) const
+	{
+		// same arguments as the game uses: ModelFactory::LoadModel(path, extensionless path, GENERATE_NORMALS)
+		std::string modelsDirectory(StripCurrentDirectory(RESOURCES_PATH + MODELS_PATH));
+		std::string_view relativePath = std::string_view(item.source).substr(modelsDirectory.size());
+		std::string folder(relativePath.substr(0, relativePath.rfind('.')));
+
+		std::string filePath = "./" + item.source;
+		cgc::strong_ptr<Model> model = cgc::construct_new<Model>(filePath, Model::GENERATE_NORMALS, folder);
+
+		AssimpModelLoader loader;
+		if (!loader.LoadModel(filePath, *model, folder, Model::GENERATE_NORMALS))
+			return false;
+
+		std::stringstream stream;
+		if (!NativeModelLoader::SaveModel(stream, *model))
+			return false;
+
+		item.outputs.push_back(CookOutput{ PakArchive::NormalizePath(CookedAssets::GetModelPath(item.source)), stream.str(), false });
+
+		// keep the materials Assimp made up, written where RenderingFactory::LoadMaterial() looks for them
+		CookFactory* factory = static_cast<CookFactory*>(RenderingFactory::Instance());
+		for (auto& material : model->materials)
+		{
+			if (!material)
+				continue;
+
+			std::string contents = factory->GetGeneratedMaterial(material->GetPath());
+			if (!contents.empty())
+				item.outputs.push_back(CookOutput{ PakArchive::NormalizePath(RESOURCES_PATH + MATERIALS_PATH + material->GetPath() + ".mat"), std::move(contents), true });
+		}
+
+		return true;
+	}
+
+	bool TextureConverter::EqualsSearch(std::string_view sourcePath) const
+	{
+		// formats stb_image decodes
+		std::string_view extension = GetExtension(sourcePath);
+		return extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "tga"
+			|| extension == "bmp" || extension == "psd" || extension == "gif";
+	}
+
+	TextureConverter::TextureConverter(const Options& options)
+		: options(options)
+	{ }
+
+	uint64_t TextureConverter::GetOptionsHash() const
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		hash = (hash ^ uint64_t(options.automaticFormat)) * 0x100000001b3ull;
+		hash = (hash ^ uint64_t(options.format)) * 0x100000001b3ull;
+		hash = (hash ^ uint64_t(options.mipFilter)) * 0x100000001b3ull;
+		for (auto& path : options.linearPaths)
+		{
+			for (char c : path)
+				hash = (hash ^ uint8(c)) * 0x100000001b3ull;
+			hash = hash * 0x100000001b3ull;
+		}
+
+		return hash;
+	}
+
+	bool TextureConverter::Convert(CookItem& item) const
+	{
+		std::string contents = Data::ReadAsset("./" + item.source);
+		if (contents.empty())
+			return false;
+
+		Image image;
+		if (!image.LoadFromMemory(contents.data(), contents.size(), item.source))
+		{
+			Debug::LogError("EsteemCook: could not decode image ", item.source);
+			return false;
+		}
+
+		Vector2u size = image.GetSize();
+		const uint8* pixels = image.GetPixelsPtr();
+
+		TextureContainer::Format format = options.format;
+		if (options.automaticFormat)
+		{
+			// BC1 keeps 1 bit of alpha
+			bool bitAlpha = true;
+			for (std::size_t i = 3; i < std::size_t(size.x) * size.y * 4 && bitAlpha; i += 4)
+				bitAlpha = pixels[i] == 0 || pixels[i] == 255;
+
+			format = bitAlpha ? TextureContainer::Format::BC1 : TextureContainer::Format::BC3;
+		}
+
+		bool sRGB = std::none_of(options.linearPaths.begin(), options.linearPaths.end(), [&](const std::string& path) { return StartsWith(item.source, path); });
+
+		// levels and tiles are spread over the cooker's job system, this runs in one of its jobs
+		std::vector<TextureContainer::Mip> mips = TextureContainer::GenerateMipChain(pixels, size.x, size.y, options.mipFilter, sRGB);
+		std::string container = TextureContainer::Write(format, BlockCompression::Encode(format, mips, JobSystem::GetLocal()));
+		if (container.empty())
+			return false;
+
+		AddSourceCopy(item, std::move(contents));
+		item.outputs.push_back(CookOutput{ PakArchive::NormalizePath(CookedAssets::GetTexturePath(item.source)), std::move(container), false });
+
+		return true;
+	}
+
+	ShaderConverter::ShaderConverter(const std::vector<std::unordered_map<std::string, std::string>>& permutations)
+		: permutations(permutations)
+	{ }
+
+	uint64_t ShaderConverter::GetOptionsHash() const
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (auto& defines : permutations)
+			hash = (hash ^ CookedAssets::HashDefines(defines)) * 0x100000001b3ull;
+
+		return hash;
+	}
+
+	bool ShaderConverter::EqualsSearch(std::string_view sourcePath) const
+	{
+		// .glinc files are only included, those are copied and become dependencies
+		std::string_view extension = GetExtension(sourcePath);
+		return extension == "glvs" || extension == "glfs" || extension == "glgs"
+			|| extension == "glcs" || extension == "gltcs" || extension == "gltes";
+	}
+
+	bool ShaderConverter::Convert(CookItem& item) const
+	{
+		std::string path = "./" + item.source;
+		std::string contents = Data::ReadAsset(path);
+		if (contents.empty())
+			return false;
+
+		AddSourceCopy(item, std::move(contents));
+
+		std::vector<std::string> dependencies;
+		for (auto& permutation : permutations)
+		{
+			size_t size;
+			cgc::strong_ptr<std::istream> stream = Data::StreamAsset(path, size);
+			if (!stream)
+				return false;
+
+			// the preprocessor adds defines of its own, the runtime looks the result up by the defines it started with
+			std::unordered_map<std::string, std::string> defines(permutation);
+			std::vector<std::string> includes;
+			std::string processed = CPreProcessor::ProcessStreamToString(stream, path, RESOURCES_PATH + SHADERS_PATH, defines, includes, &dependencies);
+
+			item.outputs.push_back(CookOutput{ PakArchive::NormalizePath(CookedAssets::GetShaderPath(item.source, permutation)), CPreProcessor::PackProcessed(processed, defines), false });
+		}
+
+		// kept in the case they have on disk, they are read again for the key of the next cook
+		for (auto& dependency : dependencies)
+		{
+			std::string_view file = StripCurrentDirectory(dependency);
+			if (file != item.source && std::find(item.dependencies.begin(), item.dependencies.end(), file) == item.dependencies.end())
+				item.dependencies.emplace_back(file);
+		}
+
+		return true;
+	}
+
+	bool CopyConverter::Convert(CookItem& item) const
+	{
+		std::string path = "./" + item.source;
+		if (!Data::FileExists(path))
+			return false;
+
+		AddSourceCopy(item, Data::ReadAsset(path));
+		return true;
+	}
+}
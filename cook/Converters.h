@@ -0,0 +1,137 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Rendering/Objects/TextureContainer.h"
+
+namespace Esteem
+{
+	struct CookOutput
+	{
+		/// \brief pak entry name, normalized
+		std::string name;
+		std::string contents;
+		/// \brief only written when no other source writes the same name, e.g.: a generated .mat
+		bool optional;
+		/// \brief set by the Cooker once it is in the pak, an optional output may lose against a source file
+		bool written;
+	};
+
+	/// \brief one source file and what it was cooked into
+	struct CookItem
+	{
+		enum State
+		{
+			PENDING = 0,
+			COOKED,
+			REUSED,
+			FAILED
+		};
+
+		/// \brief relative to the project directory, e.g.: "resources/models/crate.fbx"
+		std::string source;
+		class IAssetConverter* converter;
+		/// \brief hash of the cooker and converter versions, options and the contents of the source and its dependencies
+		uint64_t key;
+		/// \brief other files the outputs were made from, these are hashed into the key as well
+		std::vector<std::string> dependencies;
+		/// \brief contents are empty for reused outputs, those are copied from the previous pak
+		std::vector<CookOutput> outputs;
+		State state;
+	};
+
+	class IAssetConverter
+	{
+	public:
+		virtual ~IAssetConverter() = 0;
+
+		/// \brief stored in the manifest, changing it cooks every asset of this converter again
+		virtual const char* GetName() const = 0;
+		/// \brief bump whenever the output for the same input changes
+		virtual uint32_t GetVersion() const = 0;
+		/// \brief hash of the settings that affect the output
+		virtual uint64_t GetOptionsHash() const { return 0; }
+
+		/// \brief used by the Cooker to find the converter of a source file, put in own logic in here
+		virtual bool EqualsSearch(std::string_view sourcePath) const = 0;
+
+		/// \brief fill item.outputs and item.dependencies, called from several threads at once
+		virtual bool Convert(CookItem& item) const = 0;
+	};
+
+	inline IAssetConverter::~IAssetConverter() {}
+
+	/// \brief imports models through Assimp and writes them as .mdl, generated materials are written as .mat
+	class ModelConverter : public IAssetConverter
+	{
+	public:
+		virtual const char* GetName() const { return "model"; }
+		virtual uint32_t GetVersion() const { return 1; }
+
+		virtual bool EqualsSearch(std::string_view sourcePath) const;
+		virtual bool Convert(CookItem& item) const;
+	};
+
+	/// \brief decodes images into a compressed TextureContainer with the full mip chain
+	/// The source is kept as well, it is what textures that stay on the CPU are loaded from.
+	class TextureConverter : public IAssetConverter
+	{
+	public:
+		struct Options
+		{
+			/// \brief pick BC1 for opaque and 1 bit alpha images and BC3 for the rest, instead of format
+			bool automaticFormat = true;
+			TextureContainer::Format format = TextureContainer::Format::BC1;
+			TextureContainer::MipFilter mipFilter = TextureContainer::MipFilter::KAISER;
+			/// \brief sources starting with one of these hold data instead of colors (e.g.: normal maps), filtered without gamma
+			std::vector<std::string> linearPaths;
+		};
+
+	private:
+		Options options;
+
+	public:
+		TextureConverter(const Options& options);
+
+		virtual const char* GetName() const { return "texture"; }
+		virtual uint32_t GetVersion() const { return 2; }
+		virtual uint64_t GetOptionsHash() const;
+
+		virtual bool EqualsSearch(std::string_view sourcePath) const;
+		virtual bool Convert(CookItem& item) const;
+	};
+
+	/// \brief preprocesses shaders once per define permutation, the source is kept for other permutations
+	class ShaderConverter : public IAssetConverter
+	{
+	private:
+		std::vector<std::unordered_map<std::string, std::string>> permutations;
+
+	public:
+		ShaderConverter(const std::vector<std::unordered_map<std::string, std::string>>& permutations);
+
+		virtual const char* GetName() const { return "shader"; }
+		virtual uint32_t GetVersion() const { return 2; }
+		virtual uint64_t GetOptionsHash() const;
+
+		virtual bool EqualsSearch(std::string_view sourcePath) const;
+		virtual bool Convert(CookItem& item) const;
+	};
+
+	/// \brief everything else goes into the pak as it is
+	class CopyConverter : public IAssetConverter
+	{
+	public:
+		virtual const char* GetName() const { return "copy"; }
+		virtual uint32_t GetVersion() const { return 1; }
+
+		virtual bool EqualsSearch(std::string_view sourcePath) const { return true; }
+		virtual bool Convert(CookItem& item) const;
+	};
+}
@@ -0,0 +1,32 @@
+#include "CookFactory.h"
+
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace Esteem
+{
+	cgc::strong_ptr<Material> CookFactory::CreateMaterial(std::string_view path, const rapidjson::Document& json, const std::vector<cgc::strong_ptr<Material>>& baseMaterials, TEXTURE_FILTER textureFlter)
+	{
+		// materials loaded from a .mat are created through here as well, those have bases or come with their own file
+		if (baseMaterials.empty() && !json.HasParseError())
+		{
+			rapidjson::StringBuffer buffer;
+			rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+			writer.SetIndent('\t', 1);
+			json.Accept(writer);
+
+			std::lock_guard<std::mutex> guard(generatedLock);
+			generatedMaterials.try_emplace(std::string(path), std::string(buffer.GetString(), buffer.GetSize()));
+		}
+
+		return NullFactory::CreateMaterial(path, json, baseMaterials, textureFlter);
+	}
+
+	std::string CookFactory::GetGeneratedMaterial(std::string_view path)
+	{
+		std::lock_guard<std::mutex> guard(generatedLock);
+
+		auto found = generatedMaterials.find(std::string(path));
+		return found != generatedMaterials.end() ? found->second : std::string();
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Rendering/Renderers/Null/NullFactory.h"
+
+namespace Esteem
+{
+	/// \brief headless rendering factory for cooking, remembers the materials loaders generate on the fly
+	/// Model importers create materials from the model file when there is no .mat for them, EsteemCook writes those
+	/// out as .mat files so the cooked model looks the same without having to import it again.
+	class CookFactory : public Null::NullFactory
+	{
+	private:
+		std::mutex generatedLock;
+		std::unordered_map<std::string, std::string> generatedMaterials;
+
+	public:
+		virtual cgc::strong_ptr<Material> CreateMaterial(std::string_view path, const rapidjson::Document& json, const std::vector<cgc::strong_ptr<Material>>& baseMaterials, TEXTURE_FILTER textureFlter = Settings::textureFlter);
+
+		/// \return the .mat contents for a material that was created from code, empty for anything else
+		std::string GetGeneratedMaterial(std::string_view path);
+	};
+}
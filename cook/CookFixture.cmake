@@ -0,0 +1,165 @@
+# cooks a copy of the fixture project twice, the second run must reuse every item of the first
+# cmake -DCOOK=<EsteemCook> -DFIXTURE=<fixture directory> -DDIRECTORY=<scratch directory> -P CookFixture.cmake
+cmake_minimum_required(VERSION 3.10)
+
+if(NOT COOK OR NOT FIXTURE OR NOT DIRECTORY)
+	message(FATAL_ERROR "COOK, FIXTURE and DIRECTORY are required")
+endif()
+
+set(PAK "${DIRECTORY}/data.pak")
+set(MANIFEST "${DIRECTORY}/data.pak.manifest")
+
+# shader source, one output per permutation of cook.json, the include and the copied text file
+set(EXPECTED_ENTRIES
+	"resources/shaders/common.glinc"
+	"resources/shaders/fixture.glvs"
+	"resources/text/readme.txt"
+)
+set(SHADER_PERMUTATIONS 2)
+set(ITEM_COUNT 3)
+
+function(cook EXPECTED_SUMMARY)
+	execute_process(
+		COMMAND "${COOK}" "${DIRECTORY}" --jobs 2
+		OUTPUT_VARIABLE OUTPUT
+		ERROR_VARIABLE OUTPUT
+		RESULT_VARIABLE RESULT
+	)
+
+	if(NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "EsteemCook failed: ${RESULT}\n${OUTPUT}")
+	endif()
+
+	string(FIND "${OUTPUT}" "${EXPECTED_SUMMARY}" FOUND)
+	if(FOUND EQUAL -1)
+		message(FATAL_ERROR "expected \"${EXPECTED_SUMMARY}\" in the output of EsteemCook:\n${OUTPUT}")
+	endif()
+endfunction()
+
+# lists the pak entries into ENTRIES and extracts them below EXTRACTED, a pak is a plain zip archive
+function(read_pak EXTRACTED)
+	file(REMOVE_RECURSE "${EXTRACTED}")
+	file(MAKE_DIRECTORY "${EXTRACTED}")
+
+	execute_process(
+		COMMAND "${CMAKE_COMMAND}" -E tar xvf "${PAK}"
+		WORKING_DIRECTORY "${EXTRACTED}"
+		OUTPUT_VARIABLE LISTING
+		ERROR_VARIABLE LISTING
+		RESULT_VARIABLE RESULT
+	)
+
+	if(NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "${PAK} can't be read as zip archive:\n${LISTING}")
+	endif()
+
+	file(GLOB_RECURSE FILES RELATIVE "${EXTRACTED}" "${EXTRACTED}/*")
+	list(SORT FILES)
+	set(ENTRIES "${FILES}" PARENT_SCOPE)
+endfunction()
+
+function(check_pak EXTRACTED)
+	read_pak("${EXTRACTED}")
+
+	foreach(ENTRY ${EXPECTED_ENTRIES})
+		if(NOT ENTRY IN_LIST ENTRIES)
+			message(FATAL_ERROR "${ENTRY} is missing from the pak, it has: ${ENTRIES}")
+		endif()
+
+		file(READ "${FIXTURE}/${ENTRY}" SOURCE_CONTENTS)
+		file(READ "${EXTRACTED}/${ENTRY}" PAK_CONTENTS)
+		if(NOT SOURCE_CONTENTS STREQUAL PAK_CONTENTS)
+			message(FATAL_ERROR "${ENTRY} in the pak differs from the source")
+		endif()
+	endforeach()
+
+	set(PERMUTATIONS ${ENTRIES})
+	list(FILTER PERMUTATIONS INCLUDE REGEX "^resources/shaders/fixture\\.glvs\\.[0-9a-f]+$")
+	list(LENGTH PERMUTATIONS PERMUTATION_COUNT)
+	if(NOT PERMUTATION_COUNT EQUAL SHADER_PERMUTATIONS)
+		message(FATAL_ERROR "${PERMUTATION_COUNT} preprocessed permutations of fixture.glvs in the pak, expected ${SHADER_PERMUTATIONS}: ${ENTRIES}")
+	endif()
+
+	# preprocessed, the include is pulled in and the define of the second permutation is applied
+	set(SCALED 0)
+	foreach(PERMUTATION ${PERMUTATIONS})
+		file(READ "${EXTRACTED}/${PERMUTATION}" CONTENTS)
+		if(NOT CONTENTS MATCHES "FixturePosition\\(\\)[^;]*\\{" OR CONTENTS MATCHES "#include")
+			message(FATAL_ERROR "${PERMUTATION} isn't preprocessed:\n${CONTENTS}")
+		endif()
+
+		if(CONTENTS MATCHES "\\* 2\\.0")
+			math(EXPR SCALED "${SCALED} + 1")
+		endif()
+	endforeach()
+
+	if(NOT SCALED EQUAL 1)
+		message(FATAL_ERROR "${SCALED} permutations of fixture.glvs have FIXTURE_SCALE applied, expected 1")
+	endif()
+
+	list(LENGTH ENTRIES ENTRY_COUNT)
+	list(LENGTH EXPECTED_ENTRIES EXPECTED_COUNT)
+	math(EXPR EXPECTED_COUNT "${EXPECTED_COUNT} + ${SHADER_PERMUTATIONS}")
+	if(NOT ENTRY_COUNT EQUAL EXPECTED_COUNT)
+		message(FATAL_ERROR "${ENTRY_COUNT} entries in the pak, expected ${EXPECTED_COUNT}: ${ENTRIES}")
+	endif()
+
+	set(ENTRIES "${ENTRIES}" PARENT_SCOPE)
+endfunction()
+
+function(check_manifest)
+	if(NOT EXISTS "${MANIFEST}")
+		message(FATAL_ERROR "${MANIFEST} wasn't written")
+	endif()
+
+	file(READ "${MANIFEST}" CONTENTS)
+	foreach(EXPECTED
+		"\"source\": \"resources/shaders/fixture.glvs\""
+		"\"source\": \"resources/shaders/common.glinc\""
+		"\"source\": \"resources/text/readme.txt\""
+		"\"converter\": \"shader\""
+		"\"converter\": \"copy\""
+	)
+		string(FIND "${CONTENTS}" "${EXPECTED}" FOUND)
+		if(FOUND EQUAL -1)
+			message(FATAL_ERROR "${EXPECTED} is missing from the manifest:\n${CONTENTS}")
+		endif()
+	endforeach()
+
+	# the shader depends on its include, so changing the include cooks the shader again
+	if(NOT CONTENTS MATCHES "\"dependencies\": \\[[^]]*\"resources/shaders/common\\.glinc\"")
+		message(FATAL_ERROR "fixture.glvs doesn't list common.glinc as dependency:\n${CONTENTS}")
+	endif()
+endfunction()
+
+file(REMOVE_RECURSE "${DIRECTORY}")
+file(COPY "${FIXTURE}/" DESTINATION "${DIRECTORY}")
+
+cook("${ITEM_COUNT} assets, ${ITEM_COUNT} cooked, 0 up to date")
+check_pak("${DIRECTORY}-first")
+check_manifest()
+file(READ "${MANIFEST}" FIRST_MANIFEST)
+set(FIRST_ENTRIES ${ENTRIES})
+
+# nothing changed, everything is copied from the previous pak
+cook("${ITEM_COUNT} assets, 0 cooked, ${ITEM_COUNT} up to date")
+check_pak("${DIRECTORY}-second")
+check_manifest()
+
+file(READ "${MANIFEST}" SECOND_MANIFEST)
+if(NOT FIRST_MANIFEST STREQUAL SECOND_MANIFEST)
+	message(FATAL_ERROR "the manifest changed while nothing was cooked")
+endif()
+if(NOT FIRST_ENTRIES STREQUAL ENTRIES)
+	message(FATAL_ERROR "the pak entries changed while nothing was cooked: ${FIRST_ENTRIES} -> ${ENTRIES}")
+endif()
+
+foreach(ENTRY ${ENTRIES})
+	file(READ "${DIRECTORY}-first/${ENTRY}" FIRST_CONTENTS)
+	file(READ "${DIRECTORY}-second/${ENTRY}" SECOND_CONTENTS)
+	if(NOT FIRST_CONTENTS STREQUAL SECOND_CONTENTS)
+		message(FATAL_ERROR "${ENTRY} changed while nothing was cooked")
+	endif()
+endforeach()
+
+file(REMOVE_RECURSE "${DIRECTORY}" "${DIRECTORY}-first" "${DIRECTORY}-second")
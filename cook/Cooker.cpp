@@ -0,0 +1,521 @@
+#include "Cooker.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+#include "CookFactory.h"
+#include "Threading/JobSystem.h"
+#include "Utils/CookedAssets.h"
+#include "Utils/Data.h"
+#include "Utils/Debug.h"
+#include "Utils/PakWriter.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr uint64_t FNVOffset = 0xcbf29ce484222325ull;
+		constexpr uint64_t FNVPrime = 0x100000001b3ull;
+
+		/// \brief hash of a file that couldn't be read, so deleting a dependency changes the key as well
+		constexpr uint64_t MissingFileHash = 0;
+
+		inline uint64_t HashBytes(uint64_t hash, const void* data, std::size_t size)
+		{
+			const uint8* bytes = static_cast<const uint8*>(data);
+			for (std::size_t i = 0; i < size; ++i)
+				hash = (hash ^ bytes[i]) * FNVPrime;
+
+			return hash;
+		}
+
+		inline uint64_t HashString(uint64_t hash, std::string_view string)
+		{
+			// including the terminating zero, so neighbouring strings can't run into each other
+			return HashBytes(HashBytes(hash, string.data(), string.size()), "", 1);
+		}
+
+		inline uint64_t HashValue(uint64_t hash, uint64_t value)
+		{
+			return HashBytes(hash, &value, sizeof(value));
+		}
+
+		std::string ToHex(uint64_t value)
+		{
+			static const char digits[] = "0123456789abcdef";
+
+			std::string hex(16, '0');
+			for (int i = 15; i >= 0; --i, value >>= 4)
+				hex[i] = digits[value & 0xF];
+
+			return hex;
+		}
+	}
+
+	Cooker::Cooker(const CookSettings& settings)
+		: settings(settings)
+	{ }
+
+	int Cooker::Run()
+	{
+		std::error_code errorCode;
+		std::filesystem::current_path(settings.projectDirectory, errorCode);
+		if (errorCode)
+		{
+			Debug::LogError("EsteemCook: can't open project directory \"", settings.projectDirectory, "\": ", errorCode.message());
+			return 1;
+		}
+
+		if (!LoadSettings())
+			return 1;
+
+		// loaders need a rendering factory for their materials, this one doesn't need a GPU
+		CookFactory factory;
+
+		CollectItems();
+		if (!settings.force)
+		{
+			LoadPreviousManifest();
+			if (!previousManifest.empty() && std::filesystem::exists(settings.outputPath))
+				previousPak.Open(settings.outputPath);
+		}
+
+		{
+			uint threads = settings.jobs != 0 ? settings.jobs : std::max(1u, std::thread::hardware_concurrency());
+			JobSystem jobSystem(uint8(std::min(255u, threads - 1)));
+
+			jobSystem.WaitFor(jobSystem.ParallelFor(items.size(), 1, [this](std::size_t from, std::size_t to)
+			{
+				for (std::size_t i = from; i < to; ++i)
+					ProcessItem(items[i]);
+			}));
+		}
+
+		std::size_t cooked = 0, reused = 0, failed = 0;
+		for (auto& item : items)
+		{
+			switch (item.state)
+			{
+			case CookItem::COOKED:
+				++cooked;
+				break;
+			case CookItem::REUSED:
+				++reused;
+				break;
+			default:
+				++failed;
+				break;
+			}
+		}
+
+		if (failed != 0)
+		{
+			Debug::LogError("EsteemCook: ", std::to_string(failed), " of ", std::to_string(items.size()), " assets failed, ", settings.outputPath, " is left untouched");
+			return 1;
+		}
+
+		// written aside and moved over the old pak, which is still read from until then
+		std::string temporaryPath = settings.outputPath + ".tmp";
+		if (!WritePak(temporaryPath))
+		{
+			Debug::LogError("EsteemCook: could not write ", temporaryPath);
+			std::filesystem::remove(temporaryPath, errorCode);
+			return 1;
+		}
+
+		previousPak.Close();
+		std::filesystem::rename(temporaryPath, settings.outputPath, errorCode);
+		if (errorCode)
+		{
+			Debug::LogError("EsteemCook: could not replace ", settings.outputPath, ": ", errorCode.message());
+			return 1;
+		}
+
+		if (!WriteManifest(settings.outputPath + ".manifest"))
+		{
+			Debug::LogError("EsteemCook: could not write ", settings.outputPath, ".manifest");
+			return 1;
+		}
+
+		Debug::Log("EsteemCook: ", std::to_string(items.size()), " assets, ", std::to_string(cooked), " cooked, ", std::to_string(reused), " up to date");
+		return 0;
+	}
+
+	bool Cooker::LoadSettings()
+	{
+		// optional cook.json in the project directory:
+		// {
+		//	"shaderPermutations": [ {}, { "DEFINE": "value" } ],
+		//	"textures": { "format": "auto", "mipFilter": "kaiser", "linearPaths": [ "resources/textures/normals/" ] }
+		// }
+		std::vector<std::unordered_map<std::string, std::string>> permutations;
+		TextureConverter::Options textureOptions;
+
+		if (Data::FileExists("./cook.json"))
+		{
+			rapidjson::Document json = Data::ReadJSONFile("./cook.json");
+			if (!json.IsObject())
+				return false;
+
+			auto textures = json.FindMember("textures");
+			if (textures != json.MemberEnd() && textures->value.IsObject() && !ParseTextureOptions(textures->value, textureOptions))
+				return false;
+
+			auto found = json.FindMember("shaderPermutations");
+			if (found != json.MemberEnd() && found->value.IsArray())
+			{
+				for (auto& permutation : found->value.GetArray())
+				{
+					if (!permutation.IsObject())
+					{
+						Debug::LogError("EsteemCook: cook.json, every shader permutation must be an object of defines");
+						return false;
+					}
+
+					auto& defines = permutations.emplace_back();
+					for (auto& define : permutation.GetObject())
+						defines.emplace(define.name.GetString(), define.value.IsString() ? define.value.GetString() : "");
+				}
+			}
+		}
+
+		if (permutations.empty())
+			permutations.emplace_back();
+
+		// the first one that accepts a source converts it, CopyConverter takes the rest
+		converters.emplace_back(std::make_unique<ModelConverter>());
+		converters.emplace_back(std::make_unique<TextureConverter>(textureOptions));
+		converters.emplace_back(std::make_unique<ShaderConverter>(permutations));
+		converters.emplace_back(std::make_unique<CopyConverter>());
+
+		return true;
+	}
+
+	bool Cooker::ParseTextureOptions(const rapidjson::Value& json, TextureConverter::Options& options)
+	{
+		static const std::pair<const char*, TextureContainer::Format> formats[] = {
+			{ "rgba8", TextureContainer::Format::RGBA8 },
+			{ "bc1", TextureContainer::Format::BC1 },
+			{ "bc3", TextureContainer::Format::BC3 },
+			{ "bc4", TextureContainer::Format::BC4 },
+			{ "bc5", TextureContainer::Format::BC5 },
+			{ "bc7", TextureContainer::Format::BC7 }
+		};
+
+		auto found = json.FindMember("format");
+		if (found != json.MemberEnd() && found->value.IsString() && std::strcmp(found->value.GetString(), "auto") != 0)
+		{
+			auto format = std::find_if(std::begin(formats), std::end(formats), [&](auto& f) { return std::strcmp(f.first, found->value.GetString()) == 0; });
+			if (format == std::end(formats))
+			{
+				Debug::LogError("EsteemCook: cook.json, unknown texture format \"", found->value.GetString(), "\"");
+				return false;
+			}
+
+			options.automaticFormat = false;
+			options.format = format->second;
+		}
+
+		found = json.FindMember("mipFilter");
+		if (found != json.MemberEnd() && found->value.IsString())
+		{
+			if (std::strcmp(found->value.GetString(), "box") == 0)
+				options.mipFilter = TextureContainer::MipFilter::BOX;
+			else if (std::strcmp(found->value.GetString(), "kaiser") == 0)
+				options.mipFilter = TextureContainer::MipFilter::KAISER;
+			else
+			{
+				Debug::LogError("EsteemCook: cook.json, unknown mip filter \"", found->value.GetString(), "\"");
+				return false;
+			}
+		}
+
+		found = json.FindMember("linearPaths");
+		if (found != json.MemberEnd() && found->value.IsArray())
+		{
+			for (auto& path : found->value.GetArray())
+			{
+				if (path.IsString())
+					options.linearPaths.emplace_back(path.GetString());
+			}
+		}
+
+		return true;
+	}
+
+	void Cooker::CollectItems()
+	{
+		std::error_code errorCode;
+		std::string resources = RESOURCES_PATH.substr(RESOURCES_PATH.find_first_not_of("./"));
+
+		std::vector<std::string> sources;
+		for (auto it = std::filesystem::recursive_directory_iterator(resources, errorCode); it != std::filesystem::recursive_directory_iterator(); it.increment(errorCode))
+		{
+			if (it->is_regular_file())
+				sources.emplace_back(it->path().generic_string());
+		}
+
+		if (errorCode)
+			Debug::LogWarning("EsteemCook: could not list everything in ", resources, ": ", errorCode.message());
+
+		// same pak for the same sources, whatever order the file system lists them in
+		std::sort(sources.begin(), sources.end());
+
+		items.reserve(sources.size());
+		for (auto& source : sources)
+		{
+			auto converter = std::find_if(converters.begin(), converters.end(), [&](auto& c) { return c->EqualsSearch(source); });
+			items.push_back(CookItem{ std::move(source), converter->get(), 0, {}, {}, CookItem::PENDING });
+		}
+	}
+
+	void Cooker::LoadPreviousManifest()
+	{
+		std::string manifestPath = settings.outputPath + ".manifest";
+		if (!Data::FileExists(manifestPath))
+			return;
+
+		rapidjson::Document json = Data::ReadJSONFile(manifestPath);
+		if (!json.IsObject())
+			return;
+
+		auto version = json.FindMember("version");
+		auto entries = json.FindMember("items");
+		if (version == json.MemberEnd() || !version->value.IsUint() || version->value.GetUint() != CookedAssets::Version
+			|| entries == json.MemberEnd() || !entries->value.IsArray())
+			return;
+
+		for (auto& entry : entries->value.GetArray())
+		{
+			if (!entry.IsObject() || !entry.HasMember("source") || !entry.HasMember("converter") || !entry.HasMember("key")
+				|| !entry.HasMember("dependencies") || !entry.HasMember("outputs"))
+				continue;
+
+			ManifestEntry manifestEntry;
+			manifestEntry.converter = entry["converter"].GetString();
+			manifestEntry.key = std::strtoull(entry["key"].GetString(), nullptr, 16);
+
+			for (auto& dependency : entry["dependencies"].GetArray())
+				manifestEntry.dependencies.emplace_back(dependency.GetString());
+
+			for (auto& output : entry["outputs"].GetArray())
+				manifestEntry.outputs.push_back(ManifestOutput{ output["name"].GetString(), output["optional"].GetBool(), output["written"].GetBool() });
+
+			previousManifest.emplace(entry["source"].GetString(), std::move(manifestEntry));
+		}
+	}
+
+	void Cooker::ProcessItem(CookItem& item)
+	{
+		auto previous = previousManifest.find(item.source);
+		if (previous != previousManifest.end() && ReuseItem(item, previous->second))
+		{
+			item.state = CookItem::REUSED;
+			return;
+		}
+
+		if (!item.converter->Convert(item))
+		{
+			Debug::LogError("EsteemCook: ", item.converter->GetName(), " converter failed on ", item.source);
+			item.state = CookItem::FAILED;
+			return;
+		}
+
+		item.key = ComputeKey(item);
+		item.state = CookItem::COOKED;
+	}
+
+	bool Cooker::ReuseItem(CookItem& item, const ManifestEntry& previous)
+	{
+		if (!previousPak.IsOpen() || previous.converter != item.converter->GetName())
+			return false;
+
+		// an optional output that lost last time may be needed now, cook again instead of guessing
+		for (auto& output : previous.outputs)
+		{
+			if (!output.written || !previousPak.Contains(output.name))
+				return false;
+		}
+
+		item.dependencies = previous.dependencies;
+		item.key = ComputeKey(item);
+		if (item.key != previous.key)
+		{
+			item.dependencies.clear();
+			return false;
+		}
+
+		// contents are copied from the previous pak when writing
+		for (auto& output : previous.outputs)
+			item.outputs.push_back(CookOutput{ output.name, std::string(), output.optional, false });
+
+		return true;
+	}
+
+	uint64_t Cooker::GetContentHash(const std::string& path)
+	{
+		{
+			std::lock_guard<std::mutex> guard(contentHashesLock);
+			auto found = contentHashes.find(path);
+			if (found != contentHashes.end())
+				return found->second;
+		}
+
+		uint64_t hash = MissingFileHash;
+
+		std::ifstream file(path, std::ios::binary);
+		if (file)
+		{
+			hash = FNVOffset;
+
+			char buffer[64 * 1024];
+			while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+				hash = HashBytes(hash, buffer, std::size_t(file.gcount()));
+		}
+
+		std::lock_guard<std::mutex> guard(contentHashesLock);
+		contentHashes.emplace(path, hash);
+		return hash;
+	}
+
+	uint64_t Cooker::ComputeKey(const CookItem& item)
+	{
+		uint64_t key = HashValue(FNVOffset, CookedAssets::Version);
+		key = HashString(key, item.converter->GetName());
+		key = HashValue(key, item.converter->GetVersion());
+		key = HashValue(key, item.converter->GetOptionsHash());
+
+		key = HashString(key, item.source);
+		key = HashValue(key, GetContentHash(item.source));
+
+		for (auto& dependency : item.dependencies)
+		{
+			key = HashString(key, dependency);
+			key = HashValue(key, GetContentHash(dependency));
+		}
+
+		return key;
+	}
+
+	bool Cooker::WritePak(const std::string& path)
+	{
+		PakWriter writer;
+		if (!writer.Open(path))
+			return false;
+
+		std::unordered_set<std::string> names;
+		bool success = true;
+
+		auto WriteOutputs = [&](bool optional)
+		{
+			for (auto& item : items)
+			{
+				for (auto& output : item.outputs)
+				{
+					if (output.optional != optional)
+						continue;
+
+					if (!names.insert(output.name).second)
+					{
+						// e.g.: two sources that only differ in case
+						if (!optional)
+							Debug::LogWarning("EsteemCook: ", output.name, " from ", item.source, " is already in the pak, skipped");
+						continue;
+					}
+
+					if (item.state == CookItem::REUSED)
+					{
+						const PakArchive::Entry* entry = previousPak.Find(output.name);
+						output.contents = entry != nullptr ? previousPak.Read(*entry) : std::string();
+						if (entry == nullptr || output.contents.size() != entry->uncompressedSize)
+						{
+							Debug::LogError("EsteemCook: could not copy ", output.name, " from the previous pak");
+							success = false;
+						}
+					}
+
+					success &= writer.Add(output.name, output.contents, ShouldCompress(output.name));
+					output.written = true;
+
+					// everything is in the pak now, no need to keep it around
+					std::string().swap(output.contents);
+				}
+			}
+		};
+
+		// sources and their outputs first, so a generated .mat never replaces one that is part of the project
+		WriteOutputs(false);
+		WriteOutputs(true);
+
+		return writer.Close() && success;
+	}
+
+	bool Cooker::WriteManifest(const std::string& path) const
+	{
+		rapidjson::StringBuffer buffer;
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+		writer.SetIndent('\t', 1);
+
+		writer.StartObject();
+		writer.Key("version");
+		writer.Uint(CookedAssets::Version);
+
+		writer.Key("items");
+		writer.StartArray();
+		for (auto& item : items)
+		{
+			writer.StartObject();
+			writer.Key("source");
+			writer.String(item.source.c_str(), rapidjson::SizeType(item.source.size()));
+			writer.Key("converter");
+			writer.String(item.converter->GetName());
+			writer.Key("key");
+			writer.String(ToHex(item.key).c_str());
+
+			writer.Key("dependencies");
+			writer.StartArray();
+			for (auto& dependency : item.dependencies)
+				writer.String(dependency.c_str(), rapidjson::SizeType(dependency.size()));
+			writer.EndArray();
+
+			writer.Key("outputs");
+			writer.StartArray();
+			for (auto& output : item.outputs)
+			{
+				writer.StartObject();
+				writer.Key("name");
+				writer.String(output.name.c_str(), rapidjson::SizeType(output.name.size()));
+				writer.Key("optional");
+				writer.Bool(output.optional);
+				writer.Key("written");
+				writer.Bool(output.written);
+				writer.EndObject();
+			}
+			writer.EndArray();
+
+			writer.EndObject();
+		}
+		writer.EndArray();
+		writer.EndObject();
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(buffer.GetString(), std::streamsize(buffer.GetSize()));
+		file << "\n";
+		return bool(file);
+	}
+
+	bool Cooker::ShouldCompress(std::string_view name)
+	{
+		std::string_view extension = name.substr(name.rfind('.') + 1);
+		return extension != "mdl" && extension != "tex";
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "Converters.h"
+#include "Utils/PakArchive.h"
+
+namespace Esteem
+{
+	struct CookSettings
+	{
+		/// \brief the directory that contains "resources/", the cooker works from there
+		std::string projectDirectory;
+		/// \brief relative to the project directory, the manifest is written next to it
+		std::string outputPath = "data.pak";
+		/// \brief threads to cook with, 0 uses all cores
+		uint jobs = 0;
+		/// \brief ignore the previous pak and manifest and cook everything again
+		bool force = false;
+	};
+
+	/// \brief cooks every file below resources/ into one pak that Data mounts on startup
+	/// Sources are matched to the first converter whose EqualsSearch() accepts them and converted in parallel. The
+	/// key of an item hashes the versions, options and contents of everything that went in, items with an unchanged
+	/// key copy their outputs from the previous pak instead. A manifest with the keys, dependencies and outputs of
+	/// every item is written next to the pak, the pak itself is only replaced once all items succeeded.
+	class Cooker
+	{
+	private:
+		struct ManifestOutput
+		{
+			std::string name;
+			bool optional;
+			bool written;
+		};
+
+		struct ManifestEntry
+		{
+			std::string converter;
+			uint64_t key;
+			std::vector<std::string> dependencies;
+			std::vector<ManifestOutput> outputs;
+		};
+
+		CookSettings settings;
+
+		std::vector<std::unique_ptr<IAssetConverter>> converters;
+		std::vector<CookItem> items;
+
+		std::unordered_map<std::string, ManifestEntry> previousManifest;
+		PakArchive previousPak;
+
+		/// \brief content hash per file, dependencies are shared between many items
+		std::mutex contentHashesLock;
+		std::unordered_map<std::string, uint64_t> contentHashes;
+
+		bool LoadSettings();
+		static bool ParseTextureOptions(const rapidjson::Value& json, TextureConverter::Options& options);
+		void CollectItems();
+		void LoadPreviousManifest();
+
+		void ProcessItem(CookItem& item);
+		bool ReuseItem(CookItem& item, const ManifestEntry& previous);
+
+		uint64_t GetContentHash(const std::string& path);
+		uint64_t ComputeKey(const CookItem& item);
+
+		bool WritePak(const std::string& path);
+		bool WriteManifest(const std::string& path) const;
+
+		/// \brief native formats are stored so they can be mapped in place, the rest is deflated
+		static bool ShouldCompress(std::string_view name);
+
+	public:
+		Cooker(const CookSettings& settings);
+
+		// disable copy
+		Cooker(const Cooker&) = delete;
+		void operator=(const Cooker&) = delete;
+
+		/// \return the process exit code, 0 on success
+		int Run();
+	};
+}
@@ -0,0 +1,67 @@
+#include "Cooker.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace Esteem;
+
+static void PrintUsage()
+{
+	std::cerr <<
+		"EsteemCook <project directory> [options]\n"
+		"  --out <file>         pak to write, relative to the project directory (default data.pak)\n"
+		"  --jobs <n>           threads to cook with (default all cores)\n"
+		"  --force              cook everything, ignore the previous pak and manifest\n";
+}
+
+int main(int argc, char** argv)
+{
+	CookSettings settings;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (strcmp(argument, "--help") == 0 || strcmp(argument, "-h") == 0)
+		{
+			PrintUsage();
+			return 0;
+		}
+		else if (strcmp(argument, "--force") == 0)
+		{
+			settings.force = true;
+			continue;
+		}
+		else if (argument[0] != '-' && settings.projectDirectory.empty())
+		{
+			settings.projectDirectory = argument;
+			continue;
+		}
+		else if (value == nullptr)
+		{
+			PrintUsage();
+			return 2;
+		}
+		else if (strcmp(argument, "--out") == 0)
+			settings.outputPath = value;
+		else if (strcmp(argument, "--jobs") == 0)
+			settings.jobs = uint(std::strtoul(value, nullptr, 10));
+		else
+		{
+			PrintUsage();
+			return 2;
+		}
+
+		++i;
+	}
+
+	if (settings.projectDirectory.empty())
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	return Cooker(settings).Run();
+}
@@ -12,17 +12,20 @@
 #include "Rendering/Objects/Text.h"
 #include "Rendering/Renderers/OpenGL/OpenGLRenderer.h"
 #include "Rendering/Renderers/OpenGL/Objects/OpenGLRenderObject.h"
+#include "Rendering/Renderers/Null/NullRenderer.h"
 #include "General/Settings.h"
 
 #include "Utils/Debug.h"
 #include "Utils/Time.h"
 #include "Utils/Diagnostics.h"
+#include "Memory/FrameArena.h"
 #include "General/Command.h"
 
 #include "World/World.h"
 
 #include <time.h>
-#include <iomanip>
+#include <cstdarg>
+#include <cstdio>
 #include <filesystem>
 
 #ifndef _WIN32
@@ -152,6 +155,10 @@ namespace Esteem
 			throw("RenderView::InitializeRenderer() DIRECTX as a rendering engine (Settings::RendererType) is not yet implemented");
 			break;
 
+		case Settings::RendererType::NONE:
+			renderer = std::make_unique<Null::NullRenderer>(Settings::initialScreenSize);
+			break;
+
 		default: // OPENGL
 			renderer = std::make_unique<OpenGL::OpenGLRenderer>(Settings::initialScreenSize);
 			break;
@@ -192,8 +199,6 @@ namespace Esteem
 		rect.setOutlineColor(sf::Color::Color(180, 180, 180, 255));
 		rect.setPosition(35, 5);*/
 
-		devBoardText = std::stringstream();
-
 
 		htmlContext = Rml::CreateContext("ScreenView", Rml::Vector2i(screenSize.x, screenSize.y));
 		Console::Initialize(window.get(), htmlContext);
@@ -309,65 +314,77 @@ namespace Esteem
 	}
 
 #pragma region Debug Rendering TODO: move this to another class
-	void RenderView::UpdateStatisticsWindow()
+	/// \brief printf style append, the text lives in the frame arena so this doesn't touch the heap
+	static void AppendFormat(frame_string& text, const char* format, ...)
 	{
+		char buffer[256];
+
+		va_list args;
+		va_start(args, format);
+		int length = vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+
+		if (length > 0)
+			text.append(buffer, std::min(std::size_t(length), sizeof(buffer) - 1));
+	}
 
+	void RenderView::UpdateStatisticsWindow()
+	{
 		const char* trueFalse = "false\0true";
 
+		frame_string text(&FrameArena::Get());
+		text.reserve(1024);
+
 		// Rendering
-		devBoardText.str("");
-		devBoardText << "PERFORMANCE MONITOR ";
+		text += "PERFORMANCE MONITOR ";
 #ifdef _DEBUG
-		devBoardText << "(DEBUG):";
+		text += "(DEBUG):";
 #else
-		devBoardText << "(RELEASE):";
+		text += "(RELEASE):";
 #endif
 
 		// Performance
-		devBoardText << "\n\nMAIN PERFORMANCE ";
-
+		text += "\n\nMAIN PERFORMANCE ";
 
 		double cpuTime = os::Statistics::CPUUsageByProcess();
-		devBoardText.setf(std::ios::fixed, std::ios::floatfield);
-		devBoardText.precision(3);
-		devBoardText << "\nCPU:         ";
-		devBoardText << std::right << std::setfill('') << std::setw(7) << cpuTime;
-		devBoardText << "%, " << (Diagnostics::frameTime * 1000) << "ms";
-		devBoardText << "\nMEMORY PHYS: " << ((float)os::Statistics::PhysicalMemoryUsedByProcess() / 1024.f / 1024.f) << "MB";
-		devBoardText << "\n       VIRT: " << ((float)os::Statistics::VirtualMemoryUsedByProcess() / 1024.f / 1024.f) << "MB";
-		devBoardText << "\n        GPU: " << ((float)RenderingFactory::Instance()->GetAllocatedMemory() / 1024.f / 1024.f) << "MB";
-
-		devBoardText << "\n\nRENDERING PERFORMANCE";
-		devBoardText << "\nFPS:         " << fpsCount << " (" << (avgDeltaTime * 1000.f) << "ms)";
+		text += "\nCPU:         ";
+		text.append(std::size_t(std::max(0, 7 - snprintf(nullptr, 0, "%.3f", cpuTime))), '\xB7');
+		AppendFormat(text, "%.3f%%, %.3fms", cpuTime, Diagnostics::frameTime * 1000);
+		AppendFormat(text, "\nMEMORY PHYS: %.3fMB", (float)os::Statistics::PhysicalMemoryUsedByProcess() / 1024.f / 1024.f);
+		AppendFormat(text, "\n       VIRT: %.3fMB", (float)os::Statistics::VirtualMemoryUsedByProcess() / 1024.f / 1024.f);
+		AppendFormat(text, "\n        GPU: %.3fMB", (float)RenderingFactory::Instance()->GetAllocatedMemory() / 1024.f / 1024.f);
+
+		text += "\n\nRENDERING PERFORMANCE";
+		AppendFormat(text, "\nFPS:         %d (%.3fms)", fpsCount, avgDeltaTime * 1000.f);
 		if (GameEngine::IsFPSLimitEnabled())
-			devBoardText << "\nFPS CAP:     true (" << targetFps << ")";
+			AppendFormat(text, "\nFPS CAP:     true (%u)", targetFps);
 		else
-			devBoardText << "\nFPS CAP:     false";
+			text += "\nFPS CAP:     false";
 
-		devBoardText << "\nVSYNC:       " << (trueFalse + 6 * Settings::vSyncEnabled);
-		devBoardText << "\nDRAW CALLS:  " << Diagnostics::drawCalls;
+		AppendFormat(text, "\nVSYNC:       %s", trueFalse + 6 * Settings::vSyncEnabled);
+		AppendFormat(text, "\nDRAW CALLS:  %u", Diagnostics::drawCalls);
 
-		devBoardText << "\nCPU:         " << elapsedMilliseconds << "ms";
-		devBoardText << "\nGPU:         " << renderer->GetRenderTime() << "ms";
-		fps->SetText(devBoardText.str());
+		AppendFormat(text, "\nCPU:         %dms", elapsedMilliseconds);
+		AppendFormat(text, "\nGPU:         %ums", renderer->GetRenderTime());
+		fps->SetText(text);
 
 		// Debug text
-		devBoardText.str("");
-		devBoardText << "WIREFRAME:     " << (trueFalse + 6 * Settings::drawLines);
-		devBoardText << "\nDEBUG INFO:    " << (trueFalse + 6 * Settings::drawDebug);
+		text.clear();
+		AppendFormat(text, "WIREFRAME:     %s", trueFalse + 6 * Settings::drawLines);
+		AppendFormat(text, "\nDEBUG INFO:    %s", trueFalse + 6 * Settings::drawDebug);
 
-		devBoardText << "\nPHYSICS:";
-		devBoardText << "\n  COL. BOXES:  " << (trueFalse + 6 * Settings::drawCollisionBoxes);
-		//devBoardText << "\nBONES:       " << (drawBones ? "drawn" : "hidden");
+		text += "\nPHYSICS:";
+		AppendFormat(text, "\n  COL. BOXES:  %s", trueFalse + 6 * Settings::drawCollisionBoxes);
+		//AppendFormat(text, "\nBONES:       %s", drawBones ? "drawn" : "hidden");
 
 		cgc::strong_ptr<Camera> camera = world->GetRenderData()->GetCamera();
 		RenderCamera* renderCamera = camera->GetRenderCameraData().ptr();
 
-		devBoardText << "\n\nCAMERA:";
-		devBoardText << "\n  POSITION:    " << (int)renderCamera->data.position.x << ", " << (int)renderCamera->data.position.y << ", " << (int)renderCamera->data.position.z;
-		devBoardText << "\n  ROTATION:    " << (roundf(renderCamera->data.forward.x * 100) * 0.01f) << ", " << (roundf(renderCamera->data.forward.y * 100) * 0.01f) << ", " << ((float)(int)(renderCamera->data.forward.z * 100) * 0.01f);
+		text += "\n\nCAMERA:";
+		AppendFormat(text, "\n  POSITION:    %d, %d, %d", (int)renderCamera->data.position.x, (int)renderCamera->data.position.y, (int)renderCamera->data.position.z);
+		AppendFormat(text, "\n  ROTATION:    %.3f, %.3f, %.3f", roundf(renderCamera->data.forward.x * 100) * 0.01f, roundf(renderCamera->data.forward.y * 100) * 0.01f, (float)(int)(renderCamera->data.forward.z * 100) * 0.01f);
 
-		debug->SetText(devBoardText.str());
+		debug->SetText(text);
 		//texthollow.setString(dev_board.str());
 	}
 
@@ -391,28 +408,13 @@ namespace Esteem
 	}
 #pragma endregion
 
-	void RenderView::RenderFrame()
+	void RenderView::RenderWorld(World& world, Renderer& renderer)
 	{
-		Diagnostics::drawCalls = 0;
-
-		frames++;
-		avgDeltaTime = Time::RenderDeltaTime();
-		auto timeNow = std::chrono::high_resolution_clock::now();
-		if (timeNow >= fpsCountNextTime)
-		{
-			fpsCount = frames;
-			frames = 0;
-
-			//while ((fpsCountNextTime += std::chrono::seconds(1)) <= timeNow); // accurate, few more clock cycles than below options
-			fpsCountNextTime = timeNow + std::chrono::seconds(1); // inaccurate (adds extra micro-/nanoseconds on each iteration)
-			//fpsCountNextTime = timeNow + std::chrono::seconds(1) - ((timeNow - nextUpdate) % std::chrono::seconds(1)); // removes above error to nanosecond accuracy
-		}
-
-		IRenderData* renderData = world->GetRenderData();
+		IRenderData* renderData = world.GetRenderData();
 		cgc::raw_ptr<RenderCamera> camera = renderData->GetCamera()->GetRenderCameraData();
 
 		// Culling
-		Culling& culling = world->GetCulling();
+		Culling& culling = world.GetCulling();
 		culling.PreRenderUpdate(camera);
 		RenderList& renderList = culling.GetRenderObjectList();
 
@@ -424,21 +426,45 @@ namespace Esteem
 		});
 
 		// Load in queued data
-		renderer->GetFactory().HandleQueue();
+		renderer.GetFactory().HandleQueue();
 
 		// clean up
-		world->DirtyRenderCleanUp();
+		world.DirtyRenderCleanUp();
+
+		// after the clean up, so lights are culled where they are this frame
+		culling.CullShadowCasters(world.GetLights());
 
 		// 3D renderer
 		renderData->SetRenderList(renderList);
-		renderData->SetLights(&world->GetLights());
+		renderData->SetLights(&world.GetLights());
+		renderData->SetShadowCasters(&culling.GetShadowCasterLists());
 		renderData->GetCamera()->Update();
 
-		renderer->RenderFrame();
+		renderer.RenderFrame();
+	}
+
+	void RenderView::RenderFrame()
+	{
+		Diagnostics::drawCalls = 0;
+
+		frames++;
+		avgDeltaTime = Time::RenderDeltaTime();
+		auto timeNow = std::chrono::high_resolution_clock::now();
+		if (timeNow >= fpsCountNextTime)
+		{
+			fpsCount = frames;
+			frames = 0;
+
+			//while ((fpsCountNextTime += std::chrono::seconds(1)) <= timeNow); // accurate, few more clock cycles than below options
+			fpsCountNextTime = timeNow + std::chrono::seconds(1); // inaccurate (adds extra micro-/nanoseconds on each iteration)
+			//fpsCountNextTime = timeNow + std::chrono::seconds(1) - ((timeNow - nextUpdate) % std::chrono::seconds(1)); // removes above error to nanosecond accuracy
+		}
+
+		RenderWorld(*world, *renderer);
 
 		if (Settings::drawDebug)
 		{
-			culling.DebugRender(world->GetDebugRenderObjects());
+			world->GetCulling().DebugRender(world->GetDebugRenderObjects());
 			renderer->RenderDevObjects(world->GetDebugRenderObjects());
 
 			// TODO: check if we can do this approach without instantiating and ditching the objects
@@ -108,8 +108,6 @@ namespace Esteem
 		cgc::strong_ptr<Text> fps;
 		cgc::strong_ptr<Text> debug;
 
-		std::stringstream devBoardText;
-
 		void DrawStatisticsWindow();
 		void UpdateStatisticsWindow();
 	#pragma endregion
@@ -168,6 +166,10 @@ namespace Esteem
 		/// \brief Render the frame
 		virtual void Render();
 
+		/// \brief the 3D part of RenderFrame(): cull, load queued data, clean up and render the world with the given renderer
+		/// Doesn't need a window, e.g. for benchmarking a frame on the null renderer.
+		static void RenderWorld(World& world, Renderer& renderer);
+
 		virtual RenderingFactory* GetFactory() { return renderer ? &renderer->GetFactory() : nullptr; };
 
 		virtual void EnableStatisticsWindow(bool enable);
@@ -4,6 +4,9 @@
 
 #include "World/Constituents/Camera.h"
 #include "World/World.h"
+#include "Utils/Profiler.h"
+#include "Threading/JobSystem.h"
+#include "Math/Math.h"
 
 #include "Rendering/Objects/RenderCamera.h"
 
@@ -12,16 +15,21 @@ namespace Esteem
 	Culling::Culling()
 	{
 		//cullingAdders[CullingObject::Type::STATIC] = new OctreeCullingAdder<Partitioning::OctreeNodeWrapping::DEFAULT>(this, &frustumChecker, CullingObject::Flags::NONE));
-		cullingAdders[CullingObject::Type::STATIC] = new OctreeCullingAdder<Partitioning::OctreeNodeWrapping::TIGHT>(this, &frustumChecker);
-		cullingAdders[CullingObject::Type::DYNAMIC] = new OctreeCullingAdder<Partitioning::OctreeNodeWrapping::LOOSE>(this, &frustumChecker);
-		cullingAdders[CullingObject::Type::VOXEL] = new VoxelCullingAdder(this, &frustumChecker);
+		cullingAdders[CullingObject::Type::STATIC] = staticAdder = new OctreeCullingAdder<Partitioning::OctreeNodeWrapping::TIGHT>(this, &frustumChecker, &occlusionChecker);
+		cullingAdders[CullingObject::Type::DYNAMIC] = dynamicAdder = new OctreeCullingAdder<Partitioning::OctreeNodeWrapping::LOOSE>(this, &frustumChecker, &occlusionChecker);
+		cullingAdders[CullingObject::Type::VOXEL] = voxelAdder = new VoxelCullingAdder(this, &frustumChecker);
+
+		// shadow casters of static objects are cached, they need to know when to find them again
+		staticAdder->TrackChanges();
 	}
 
 	void Culling::PreRenderUpdate(RenderCamera* renderCamera)
 	{
 		//std::unique_lock<std::mutex> lk(lock);
+		ESTEEM_PROFILE("Culling::PreRenderUpdate");
 
 		frustumChecker.CalculateFrustum(renderCamera->data.viewProjectMatrix);
+		occlusionChecker.RenderOccluders(renderCamera->data.viewProjectMatrix, &frustumChecker, JobSystem::GetLocal());
 
 		// clean up lists
 		lights.clear();
@@ -32,6 +40,118 @@ namespace Esteem
 			adder->AddObjects();
 	}
 	
+	void Culling::CullShadowCasters(const std::vector<LightRenderData>& lights)
+	{
+		ESTEEM_PROFILE("Culling::CullShadowCasters");
+
+		// objects that moved since AddObjects have to be in their new node before the tree is read from several threads
+		staticAdder->CleanUp();
+		dynamicAdder->CleanUp();
+
+		for (auto& cache : shadowCasterCache)
+			cache.second.used = false;
+
+		// set up everything that isn't thread safe before the lights are spread over the jobs
+		std::size_t count = 0;
+		shadowCasterLights.clear();
+
+		const std::vector<AxisAlignedBox>& changes = staticAdder->GetChanges();
+		for (const auto& light : lights)
+		{
+			const LightData& data = *light.data;
+			uint faceCount = data.GetShadowFaceCount();
+			if (data.shadowInfoIndex == -1 || faceCount == 0)
+				continue;
+
+			ShadowCasterCache& cache = shadowCasterCache.try_emplace(light.data).first->second;
+			if (cache.valid)
+			{
+				cache.valid = cache.light.type == data.type && cache.light.position == data.position
+					&& cache.light.distance == data.distance && (data.type != LightData::LightType::SPOT || cache.light.forward == data.forward);
+
+				for (std::size_t i = 0; i < changes.size() && cache.valid; ++i)
+					cache.valid = !Math::BoxOverlapsSphere(changes[i].begin, changes[i].end, data.position, data.distance);
+			}
+
+			cache.light = data;
+			cache.used = true;
+
+			// reuse the lists of last frame, they keep their capacity
+			if (count == shadowCasters.size())
+				shadowCasters.emplace_back();
+
+			ShadowCasterList& casters = shadowCasters[count++];
+			casters.light = light.data;
+			casters.faceCount = faceCount;
+
+			shadowCasterLights.push_back(&cache);
+		}
+
+		shadowCasters.resize(count);
+		staticAdder->ClearChanges();
+
+		// lights that are gone don't keep their cache around
+		for (auto it = shadowCasterCache.begin(); it != shadowCasterCache.end();)
+		{
+			if (it->second.used)
+				++it;
+			else
+				it = shadowCasterCache.erase(it);
+		}
+
+		auto cullLights = [this](std::size_t from, std::size_t to)
+		{
+			for (std::size_t i = from; i < to; ++i)
+				CullShadowCasters(shadowCasters[i], *shadowCasterLights[i]);
+		};
+
+		if (JobSystem* jobSystem = JobSystem::GetLocal())
+			jobSystem->WaitFor(jobSystem->ParallelFor(shadowCasters.size(), 1, cullLights));
+		else
+			cullLights(0, shadowCasters.size());
+	}
+
+	void Culling::CullShadowCasters(ShadowCasterList& casters, ShadowCasterCache& cache)
+	{
+		const LightData& light = cache.light;
+
+		FrustumCullingChecker faces[6];
+		for (uint face = 0; face < casters.faceCount; ++face)
+			faces[face].CalculateFrustum(light.GetShadowMatrix(face));
+
+		if (!cache.valid)
+		{
+			for (auto& objects : cache.faces)
+				objects.clear();
+
+			staticAdder->QueryFaces(light.position, light.distance, faces, casters.faceCount, cache.faces.data());
+			cache.valid = true;
+		}
+
+		std::array<std::vector<const CullingObject*>, 6> objects;
+		dynamicAdder->QueryFaces(light.position, light.distance, faces, casters.faceCount, objects.data());
+		voxelAdder->QueryFaces(light.position, light.distance, faces, casters.faceCount, objects.data());
+
+		for (uint face = 0; face < casters.faceCount; ++face)
+		{
+			casters.faces[face].clear();
+			AppendShadowCasters(cache.faces[face], casters.faces[face]);
+			AppendShadowCasters(objects[face], casters.faces[face]);
+		}
+	}
+
+	void Culling::AppendShadowCasters(const std::vector<const CullingObject*>& objects, std::vector<RenderObject*>& casters)
+	{
+		for (const CullingObject* object : objects)
+		{
+			for (const auto& renderObject : object->GetRenderObjects())
+			{
+				if (renderObject->IsInitialized() && renderObject->IsCastingShadows() && renderObject->GetRenderOrder() == RenderObject::RenderOrder::OPAQUE_)
+					casters.push_back(renderObject.ptr());
+			}
+		}
+	}
+
 	bool Culling::RegisterCullingObject(CullingObject* cullingObject)
 	{
 		if (cullingObject->GetContainer() == nullptr)
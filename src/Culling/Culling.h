@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 #include <cppu/stor/lock/deque.h>
 
 #include "./CullingCheckers/ICullingChecker.h"
@@ -8,6 +9,7 @@
 
 #include "./CullingAdders/OctreeCullingAdder.h"
 #include "./CullingCheckers/FrustumCullingChecker.h"
+#include "./CullingCheckers/ZHierarchyCullingChecker.h"
 
 #include "Rendering/Objects/DevRenderObject.h"
 #include "Rendering/Objects/IRenderData.h"
@@ -19,18 +21,45 @@ namespace Esteem
 	class Light;
 	class World;
 	class RenderCamera;
+	class VoxelCullingAdder;
 
 	class Culling
 	{
 	private:
+		/// \brief static objects found for a light, kept until the light or a static object in its range changes
+		struct ShadowCasterCache
+		{
+			LightData light;
+			std::array<std::vector<const CullingObject*>, 6> faces;
+			bool valid;
+			bool used;
+
+			ShadowCasterCache()
+				: valid(false)
+				, used(false)
+			{ }
+		};
+
 		std::vector<ICullingChecker*> cullingCheckers;
 		ICullingAdder* cullingAdders[CullingObject::Type::COUNT];
 
+		OctreeCullingAdder<Partitioning::OctreeNodeWrapping::TIGHT>* staticAdder;
+		OctreeCullingAdder<Partitioning::OctreeNodeWrapping::LOOSE>* dynamicAdder;
+		VoxelCullingAdder* voxelAdder;
+
 		RenderList renderList;
 		std::vector<Light*> lights;
 
+		std::vector<ShadowCasterList> shadowCasters;
+		std::unordered_map<const LightData*, ShadowCasterCache> shadowCasterCache;
+		std::vector<ShadowCasterCache*> shadowCasterLights;
+
+		void CullShadowCasters(ShadowCasterList& casters, ShadowCasterCache& cache);
+		static void AppendShadowCasters(const std::vector<const CullingObject*>& objects, std::vector<RenderObject*>& casters);
+
 		// Octree
 		FrustumCullingChecker frustumChecker;
+		ZHierarchyCullingChecker occlusionChecker;
 
 		// locking (TODO: need different approach)
 		std::mutex lock;
@@ -41,8 +70,14 @@ namespace Esteem
 		
 		void PreRenderUpdate(RenderCamera* renderCamera);
 
+		/// \brief find the casters of every shadowed point and spot light, per shadow map face, call after PreRenderUpdate
+		/// Every light is culled in its own job, static casters are reused until something in the light's range changes.
+		void CullShadowCasters(const std::vector<LightRenderData>& lights);
+
 		RenderList& GetRenderObjectList();
 		std::vector<Light*>& GetLightList();
+		/// \brief one entry per light culled by CullShadowCasters, in the same order
+		const std::vector<ShadowCasterList>& GetShadowCasterLists() const;
 
 		void DebugRender(std::vector<DevRenderObject>& renderObjects);
 
@@ -52,6 +87,10 @@ namespace Esteem
 		bool RegisterCullingObject(CullingObject* cullingObject);
 		static void UnRegisterCullingObject(CullingObject* cullingObject);
 
+		/// \brief hide objects behind the occluder, it needs to stay alive until it's unregistered
+		void RegisterOccluder(const Occluder* occluder);
+		void UnRegisterOccluder(const Occluder* occluder);
+
 		void AddObjectToRenderList(RenderObject* renderObject);
 
 		void AppendRenderObjectsDirectly(const std::vector<cgc::strong_ptr<RenderObject>>& renderObjects);
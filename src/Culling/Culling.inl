@@ -14,6 +14,11 @@ namespace Esteem
 		return lights;
 	}
 
+	inline const std::vector<ShadowCasterList>& Culling::GetShadowCasterLists() const
+	{
+		return shadowCasters;
+	}
+
 	// This requires speed so inline it
 	inline void Culling::AddObjectToRenderList(RenderObject* renderObject)
 	{
@@ -76,6 +81,16 @@ namespace Esteem
 		cullingObject->RemoveFromCulling();
 	}
 
+	inline void Culling::RegisterOccluder(const Occluder* occluder)
+	{
+		occlusionChecker.AddOccluder(occluder);
+	}
+
+	inline void Culling::UnRegisterOccluder(const Occluder* occluder)
+	{
+		occlusionChecker.RemoveOccluder(occluder);
+	}
+
 	inline void Culling::DebugRender(std::vector<DevRenderObject>& renderObjects)
 	{
 		for (auto& adder : cullingAdders)
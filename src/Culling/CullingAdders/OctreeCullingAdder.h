@@ -7,6 +7,7 @@ namespace Esteem
 {
 	class Culling;
 	class FrustumCullingChecker;
+	class ZHierarchyCullingChecker;
 
 	template<Partitioning::OctreeNodeWrapping Wrapping = Partitioning::OctreeNodeWrapping::DEFAULT>
 	class OctreeCullingAdder : public Partitioning::Octree<CullingObject,
@@ -28,20 +29,33 @@ namespace Esteem
 
 		Culling* culling;
 		FrustumCullingChecker* frustumChecker;
+		ZHierarchyCullingChecker* occlusionChecker;
 
-		void CullingPass(const Node& partition);
+		/// \brief center and extent arrays of the leaves being tested, reused between nodes
+		std::vector<float> leafBoxes[6];
+		std::vector<uint64_t> leafVisibility;
+		std::vector<uint64_t> leafOcclusion;
 
-		static void DebugRenderOctree(std::vector<DevRenderObject>& renderObjects, const Node& partition, uint depth);
+		/// \brief bounds of registered, moved and removed objects since the last ClearChanges
+		std::vector<AxisAlignedBox> changedBoxes;
+
+		/// \param insideFrustum the parent is fully inside, skips the frustum tests
+		void CullingPass(const Node& partition, bool insideFrustum);
+		/// \brief add everything below a node that is fully inside the frustum, without testing it
+		void AddAll(const Node& partition);
+
+		static void QueryFaces(const Node& partition, const glm::vec3& center, float radius, const FrustumCullingChecker* faces, uint faceCount, std::vector<const CullingObject*>* objects);
+		static void QueryLeaves(const std::vector<CullingObject*>& leaves, const glm::vec3& center, float radius, const FrustumCullingChecker* faces, uint faceCount, std::vector<const CullingObject*>* objects);
 
-		static void ResetSizes(Node* node, const glm::vec3& min, const glm::vec3& max);
-		static void ResetSizes(Node* node, float size);
+		static void DebugRenderOctree(std::vector<DevRenderObject>& renderObjects, const Node& partition, uint depth);
 
 	public:
 		// disable copy
 		OctreeCullingAdder(const OctreeCullingAdder&) = delete;
 		void operator=(const OctreeCullingAdder&) = delete;
 
-		OctreeCullingAdder(Culling* culling, FrustumCullingChecker* frustumChecker);
+		/// \param occlusionChecker optional, hides nodes and leaves behind its occluders
+		OctreeCullingAdder(Culling* culling, FrustumCullingChecker* frustumChecker, ZHierarchyCullingChecker* occlusionChecker = nullptr);
 		virtual void AddObjects();
 
 		void RegisterCullingObject(CullingObject* cullingObject);
@@ -49,6 +63,15 @@ namespace Esteem
 
 		virtual void DebugRender(std::vector<DevRenderObject>& renderObjects);
 
+		/// \brief objects overlapping the sphere are appended to objects[face] for every face frustum they intersect
+		/// Only reads the tree, so several lights can be queried from different threads at once.
+		void QueryFaces(const glm::vec3& center, float radius, const FrustumCullingChecker* faces, uint faceCount, std::vector<const CullingObject*>* objects) const;
+
+		/// \brief start recording the bounds of every registered, moved or removed object, call before anything is registered
+		void TrackChanges();
+		inline const std::vector<AxisAlignedBox>& GetChanges() const { return changedBoxes; }
+		inline void ClearChanges() { changedBoxes.clear(); }
+
 		virtual ~OctreeCullingAdder() = default;
 	};
 }
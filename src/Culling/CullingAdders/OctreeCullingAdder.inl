@@ -2,121 +2,199 @@
 
 #include "OctreeCullingAdder.h"
 
+#include <algorithm>
+
 #include "General/Settings.h"
 #include "General/Color.h"
+#include "Math/Math.h"
 #include "../Culling.h"
 #include "../CullingCheckers/FrustumCullingChecker.h"
+#include "../CullingCheckers/ZHierarchyCullingChecker.h"
 
 namespace Esteem
 {
 	// TODO: make this octree independent of the Settings class
 	template<Partitioning::OctreeNodeWrapping Wrapping>
-	OctreeCullingAdder<Wrapping>::OctreeCullingAdder(Culling* culling, FrustumCullingChecker* frustumChecker)
+	OctreeCullingAdder<Wrapping>::OctreeCullingAdder(Culling* culling, FrustumCullingChecker* frustumChecker, ZHierarchyCullingChecker* occlusionChecker)
 		: culling(culling)
 		, frustumChecker(frustumChecker)
+		, occlusionChecker(occlusionChecker)
 	{ }
 
 	template<Partitioning::OctreeNodeWrapping Wrapping>
 	void OctreeCullingAdder<Wrapping>::AddObjects()
 	{
-		auto& root = Base::root;
+		// places objects that moved out of their node, then merges and drops nodes emptied since the last frame
+		Base::CleanUp();
+
+		// the root also holds the objects that are too big for any of its children
+		CullingPass(Base::root, false);
+	}
 
-		if (root.dirty)
+	template<Partitioning::OctreeNodeWrapping Wrapping>
+	void OctreeCullingAdder<Wrapping>::CullingPass(const Node& partition, bool insideFrustum)
+	{
+		if (!insideFrustum)
 		{
-			for(const auto& leaf : root.leaves)
-				RegisterCullingObject(leaf);
+			FrustumIntersection intersection = frustumChecker->ClassifyBox(partition.aab);
+			if (intersection == FrustumIntersection::OUTSIDE)
+				return;
 
-			root.leaves.clear();
+			insideFrustum = intersection == FrustumIntersection::INSIDE;
+		}
 
-			for (size_t i = 0; i < root.childs.size(); ++i)
-			{
-				if (auto* child = root.childs[i].get())
-					Base::CleanUp(*child, i);
-			}
+		bool occlusion = occlusionChecker && occlusionChecker->IsActive();
+		if (occlusion && !occlusionChecker->IsBoxVisible(partition.aab))
+			return;
 
-			root.dirty = false;
+		if (insideFrustum && !occlusion)
+		{
+			AddAll(partition);
+			return;
 		}
 
-		for (const auto& child : root.childs)
+		for (const auto& child : partition.childs)
 		{
 			if (child)
-				CullingPass(*child.get());
+				CullingPass(*child.get(), insideFrustum);
 		}
-	}
 
-	template<Partitioning::OctreeNodeWrapping Wrapping>
-	void OctreeCullingAdder<Wrapping>::CullingPass(const Node& partition)
-	{
-		if (frustumChecker->CubeInFrustum(partition.aab))
+		std::size_t count = partition.leaves.size();
+		if (count == 0)
+			return;
+
+		for (auto& boxes : leafBoxes)
+			boxes.resize(count);
+
+		for (std::size_t i = 0; i < count; ++i)
 		{
-			for (const auto& child : partition.childs)
-			{
-				if (child)
-					CullingPass(*child.get());
-			}
+			const AxisAlignedBox& aab = partition.leaves[i]->GetAABB();
+			glm::vec3 extent = (aab.end - aab.begin) * 0.5f;
+			glm::vec3 center = aab.begin + extent;
+
+			leafBoxes[0][i] = center.x;
+			leafBoxes[1][i] = center.y;
+			leafBoxes[2][i] = center.z;
+			leafBoxes[3][i] = extent.x;
+			leafBoxes[4][i] = extent.y;
+			leafBoxes[5][i] = extent.z;
+		}
+
+		CullingBoxes boxes = { leafBoxes[0].data(), leafBoxes[1].data(), leafBoxes[2].data(),
+			leafBoxes[3].data(), leafBoxes[4].data(), leafBoxes[5].data(), count };
+
+		std::size_t wordCount = (count + 63) / 64;
+		leafVisibility.resize(wordCount);
+
+		if (insideFrustum)
+		{
+			std::fill(leafVisibility.begin(), leafVisibility.end(), ~uint64_t(0));
+			if (count % 64)
+				leafVisibility.back() = (uint64_t(1) << (count % 64)) - 1;
+		}
+		else
+			frustumChecker->RangeOfObjectsCheck(boxes, leafVisibility.data());
+
+		if (occlusion)
+		{
+			leafOcclusion.resize(wordCount);
+			occlusionChecker->RangeOfObjectsCheck(boxes, leafOcclusion.data());
 
-			for (const auto& leaf : partition.leaves)
+			for (std::size_t word = 0; word < wordCount; ++word)
+				leafVisibility[word] &= leafOcclusion[word];
+		}
+
+		for (std::size_t word = 0; word < wordCount; ++word)
+		{
+			for (uint64_t bits = leafVisibility[word]; bits; bits &= bits - 1)
 			{
-				if(frustumChecker->CubeInFrustum(leaf->GetAABB()))
-					culling->AppendRenderObjectsDirectly(leaf->GetRenderObjects());
+				std::size_t i = word * 64 + Math::CountTrailingZeros(bits);
+				culling->AppendRenderObjectsDirectly(partition.leaves[i]->GetRenderObjects());
 			}
 		}
 	}
 
 	template<Partitioning::OctreeNodeWrapping Wrapping>
-	void OctreeCullingAdder<Wrapping>::ResetSizes(Node* node, const glm::vec3& min, const glm::vec3& max)
+	void OctreeCullingAdder<Wrapping>::AddAll(const Node& partition)
 	{
-		bool isSet = false;
+		for (const auto& child : partition.childs)
+		{
+			if (child)
+				AddAll(*child.get());
+		}
 
-		// Make it nice and tight
-		if (min.x < node->aab.begin.x) { node->aab.begin.x = min.x; isSet = true; }
-		if (min.y < node->aab.begin.y) { node->aab.begin.y = min.y; isSet = true; }
-		if (min.z < node->aab.begin.z) { node->aab.begin.z = min.z; isSet = true; }
+		for (const auto& leaf : partition.leaves)
+			culling->AppendRenderObjectsDirectly(leaf->GetRenderObjects());
+	}
 
-		if (max.x > node->aab.end.x) { node->aab.end.x = max.x; isSet = true; }
-		if (max.y > node->aab.end.y) { node->aab.end.y = max.y; isSet = true; }
-		if (max.z > node->aab.end.z) { node->aab.end.z = max.z; isSet = true; }
+	template<Partitioning::OctreeNodeWrapping Wrapping>
+	void OctreeCullingAdder<Wrapping>::QueryFaces(const glm::vec3& center, float radius, const FrustumCullingChecker* faces, uint faceCount, std::vector<const CullingObject*>* objects) const
+	{
+		for (const auto& child : Base::root.childs)
+		{
+			if (child)
+				QueryFaces(*child.get(), center, radius, faces, faceCount, objects);
+		}
 
-		if (node->parent != nullptr && isSet)
-			ResetSizes(node->parent, min, max);
+		// objects that are too big for any child live in the root
+		QueryLeaves(Base::root.leaves, center, radius, faces, faceCount, objects);
 	}
-	
+
 	template<Partitioning::OctreeNodeWrapping Wrapping>
-	void OctreeCullingAdder<Wrapping>::ResetSizes(Node* node, float volumeSize)
+	void OctreeCullingAdder<Wrapping>::QueryFaces(const Node& partition, const glm::vec3& center, float radius, const FrustumCullingChecker* faces, uint faceCount, std::vector<const CullingObject*>* objects)
 	{
-		bool isSet = false;
+		if (!Math::BoxOverlapsSphere(partition.aab.begin, partition.aab.end, center, radius))
+			return;
 
-		// Loosely fit
-		float overSize = ((node->aab.end.x - node->aab.begin.x) - node->size) * 0.5f;
-		if (volumeSize > overSize)
+		bool inAnyFace = false;
+		for (uint face = 0; face < faceCount && !inAnyFace; ++face)
+			inAnyFace = faces[face].ClassifyBox(partition.aab) != FrustumIntersection::OUTSIDE;
+
+		if (!inAnyFace)
+			return;
+
+		for (const auto& child : partition.childs)
 		{
-			float deltaSize = volumeSize - overSize;
-			node->aab.begin -= deltaSize;
-			node->aab.end += deltaSize;
-			isSet = true;
+			if (child)
+				QueryFaces(*child.get(), center, radius, faces, faceCount, objects);
 		}
 
-		if (node->parent != nullptr && isSet)
-			ResetSizes(node->parent, volumeSize);
+		QueryLeaves(partition.leaves, center, radius, faces, faceCount, objects);
+	}
+
+	template<Partitioning::OctreeNodeWrapping Wrapping>
+	void OctreeCullingAdder<Wrapping>::QueryLeaves(const std::vector<CullingObject*>& leaves, const glm::vec3& center, float radius, const FrustumCullingChecker* faces, uint faceCount, std::vector<const CullingObject*>* objects)
+	{
+		for (const CullingObject* leaf : leaves)
+		{
+			const AxisAlignedBox& aab = leaf->GetAABB();
+			if (!Math::BoxOverlapsSphere(aab.begin, aab.end, center, radius))
+				continue;
+
+			for (uint face = 0; face < faceCount; ++face)
+			{
+				if (faces[face].ClassifyBox(aab) != FrustumIntersection::OUTSIDE)
+					objects[face].push_back(leaf);
+			}
+		}
+	}
 
+	template<Partitioning::OctreeNodeWrapping Wrapping>
+	void OctreeCullingAdder<Wrapping>::TrackChanges()
+	{
+		Base::state.changes = &changedBoxes;
 	}
 
 	template<Partitioning::OctreeNodeWrapping Wrapping>
 	void OctreeCullingAdder<Wrapping>::RegisterCullingObject(CullingObject* cullingObject)
 	{
-		Node* partition = Base::FindOrCreatePartition(Base::root, (glm::ivec3)cullingObject->GetCenter(), (uint)cullingObject->GetSize());
-		partition->AddLeaf(cullingObject);
-
-		if constexpr (Wrapping == Partitioning::OctreeNodeWrapping::LOOSE)
-			ResetSizes(partition, cullingObject->GetSize());
-		else if constexpr (Wrapping == Partitioning::OctreeNodeWrapping::TIGHT)
-			ResetSizes(partition, cullingObject->GetAABB().begin, cullingObject->GetAABB().end);
+		Base::AddLeaf(cullingObject, (glm::ivec3)cullingObject->GetCenter(), (uint)cullingObject->GetSize());
 	}
 
 	template<Partitioning::OctreeNodeWrapping Wrapping>
 	void OctreeCullingAdder<Wrapping>::UnRegisterCullingObject(CullingObject* cullingObject)
 	{
-		// TODO: build this
+		Base::RemoveLeaf(cullingObject);
 	}
 
 	template<Partitioning::OctreeNodeWrapping Wrapping>
@@ -1,6 +1,7 @@
 #include "VoxelCullingAdder.h"
 #include "../CullingCheckers/FrustumCullingChecker.h"
 #include "../Culling.h"
+#include "Math/Math.h"
 
 namespace Esteem
 {
@@ -42,6 +43,23 @@ namespace Esteem
 		}
 	}
 
+	void VoxelCullingAdder::QueryFaces(const glm::vec3& center, float radius, const FrustumCullingChecker* faces, uint faceCount, std::vector<const CullingObject*>* faceObjects)
+	{
+		std::lock_guard lk(lock);
+		for (const auto* object : objects)
+		{
+			const AxisAlignedBox& aab = object->GetAABB();
+			if (!Math::BoxOverlapsSphere(aab.begin, aab.end, center, radius))
+				continue;
+
+			for (uint face = 0; face < faceCount; ++face)
+			{
+				if (faces[face].ClassifyBox(aab) != FrustumIntersection::OUTSIDE)
+					faceObjects[face].push_back(object);
+			}
+		}
+	}
+
 	void VoxelCullingAdder::Translate(Partitioning::SpatialObject* cullingObject)
 	{
 
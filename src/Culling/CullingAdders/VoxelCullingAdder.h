@@ -28,6 +28,9 @@ namespace Esteem
 
 		virtual void DebugRender(std::vector<DevRenderObject>& renderObjects);
 
+		/// \brief objects overlapping the sphere are appended to faceObjects[face] for every face frustum they intersect
+		void QueryFaces(const glm::vec3& center, float radius, const FrustumCullingChecker* faces, uint faceCount, std::vector<const CullingObject*>* faceObjects);
+
 		virtual void Translate(Partitioning::SpatialObject* cullingObject);
 		virtual void Scale(Partitioning::SpatialObject* cullingObject);
 		virtual void Remove(Partitioning::SpatialObject* cullingObject);
@@ -1,5 +1,10 @@
 #include "FrustumCullingChecker.h"
+
+#include <algorithm>
+#include <cmath>
+
 #include "Math/Math.h"
+#include "Math/SimdFloats.h"
 
 namespace Esteem
 {
@@ -8,9 +13,86 @@ namespace Esteem
 		return PointInFrustum(object->GetPosition());
 	}
 
-	void FrustumCullingChecker::RangeOfObjectsCheck()
+	template<class V>
+	inline void FrustumCullingChecker::CheckBoxes(const CullingBoxes& boxes, std::size_t i, uint32_t& visible, uint32_t& inside) const
+	{
+		V centerX = V::Load(boxes.centerX + i), centerY = V::Load(boxes.centerY + i), centerZ = V::Load(boxes.centerZ + i);
+		V extentX = V::Load(boxes.extentX + i), extentY = V::Load(boxes.extentY + i), extentZ = V::Load(boxes.extentZ + i);
+		V zero = V::Set1(0.f);
+
+		visible = (1u << V::Width) - 1;
+		inside = visible;
+
+		for (const auto& plane : planes)
+		{
+			// the extents projected on the plane normal reach the p-vertex (distance + radius) and the n-vertex (distance - radius)
+			V distance = V::Set1(plane.x) * centerX + V::Set1(plane.y) * centerY + V::Set1(plane.z) * centerZ + V::Set1(plane.w);
+			V radius = V::Set1(std::abs(plane.x)) * extentX + V::Set1(std::abs(plane.y)) * extentY + V::Set1(std::abs(plane.z)) * extentZ;
+
+			visible &= (distance + radius).GreaterThanMask(zero);
+			inside &= (distance - radius).GreaterThanMask(zero);
+		}
+
+		inside &= visible;
+	}
+
+	template<class V>
+	void FrustumCullingChecker::CheckRange(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside) const
+	{
+		for (std::size_t word = 0, begin = 0; begin < boxes.count; ++word, begin += 64)
+		{
+			std::size_t end = std::min(begin + 64, boxes.count);
+			uint64_t visibleBits = 0, insideBits = 0;
+			uint32_t visibleMask, insideMask;
+
+			std::size_t i = begin;
+			for (; i + V::Width <= end; i += V::Width)
+			{
+				CheckBoxes<V>(boxes, i, visibleMask, insideMask);
+				visibleBits |= uint64_t(visibleMask) << (i - begin);
+				insideBits |= uint64_t(insideMask) << (i - begin);
+			}
+
+			for (; i < end; ++i)
+			{
+				CheckBoxes<Math::ScalarFloats>(boxes, i, visibleMask, insideMask);
+				visibleBits |= uint64_t(visibleMask) << (i - begin);
+				insideBits |= uint64_t(insideMask) << (i - begin);
+			}
+
+			visible[word] = visibleBits;
+			if (inside)
+				inside[word] = insideBits;
+		}
+	}
+
+	void FrustumCullingChecker::RangeOfObjectsCheck(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside)
+	{
+		CheckRange<Math::WideFloats>(boxes, visible, inside);
+	}
+
+	void FrustumCullingChecker::RangeOfObjectsCheckScalar(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside) const
+	{
+		CheckRange<Math::ScalarFloats>(boxes, visible, inside);
+	}
+
+	FrustumIntersection FrustumCullingChecker::ClassifyBox(const glm::vec3& center, const glm::vec3& extent) const
 	{
+		CullingBoxes box = { &center.x, &center.y, &center.z, &extent.x, &extent.y, &extent.z, 1 };
+
+		uint32_t visible, inside;
+		CheckBoxes<Math::ScalarFloats>(box, 0, visible, inside);
+
+		if (inside)
+			return FrustumIntersection::INSIDE;
 
+		return visible ? FrustumIntersection::INTERSECTS : FrustumIntersection::OUTSIDE;
+	}
+
+	FrustumIntersection FrustumCullingChecker::ClassifyBox(const AxisAlignedBox& aab) const
+	{
+		glm::vec3 extent = (aab.end - aab.begin) * 0.5f;
+		return ClassifyBox(aab.begin + extent, extent);
 	}
 
 	FrustumCullingChecker::~FrustumCullingChecker()
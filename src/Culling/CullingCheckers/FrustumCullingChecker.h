@@ -15,17 +15,39 @@ namespace Esteem
 		FRONT = 5		// The FRONT side of the frustum
 	};
 	
+	enum class FrustumIntersection : uint8
+	{
+		OUTSIDE = 0,
+		INTERSECTS,
+		INSIDE
+	};
+	
 	/// \brief Frustum culling checks
 	class FrustumCullingChecker : public ICullingChecker
 	{
 	private:
 		glm::vec4 planes[6];
 
+		/// \brief p-vertex test of V::Width boxes starting at index, bit i of the masks is box index + i
+		template<class V>
+		void CheckBoxes(const CullingBoxes& boxes, std::size_t index, uint32_t& visible, uint32_t& inside) const;
+
+		template<class V>
+		void CheckRange(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside) const;
+
 	public:
 		virtual ~FrustumCullingChecker();
 
 		virtual bool SingleObjectCheck(const RenderObject* object);
-		virtual void RangeOfObjectsCheck();
+		/// \brief test all boxes against the frustum, uses SSE or AVX2 when available
+		virtual void RangeOfObjectsCheck(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside = nullptr);
+
+		/// \brief reference version of RangeOfObjectsCheck, tests the boxes one at a time without SIMD
+		void RangeOfObjectsCheckScalar(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside = nullptr) const;
+
+		/// \brief center and half extents version of CubeInFrustum that also tells if the box is fully inside
+		FrustumIntersection ClassifyBox(const glm::vec3& center, const glm::vec3& extent) const;
+		FrustumIntersection ClassifyBox(const AxisAlignedBox& aab) const;
 
 
 		// \brief Call this every time the camera moves, to update the frustum
@@ -1,17 +1,35 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include "../../Rendering/Objects/RenderObject.h"
 
 namespace Esteem
 {
+	/// \brief boxes laid out as separate arrays of centers and half extents, so checkers can test several at once
+	struct CullingBoxes
+	{
+		const float* centerX;
+		const float* centerY;
+		const float* centerZ;
+		const float* extentX;
+		const float* extentY;
+		const float* extentZ;
+		std::size_t count;
+	};
+
 	class ICullingChecker
 	{
 	public:
 		virtual ~ICullingChecker() = 0;
 
 		virtual bool SingleObjectCheck(const RenderObject* object) = 0;
-		virtual void RangeOfObjectsCheck() = 0;
+
+		/// \brief test all boxes, bit i of visible[i / 64] is set when box i passes
+		/// \param inside optional, bit i is set when box i passes for certain, so anything inside it passes as well
+		virtual void RangeOfObjectsCheck(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside = nullptr) = 0;
 	};
 
 	inline ICullingChecker::~ICullingChecker() {}
-}
\ No newline at end of file
+}
@@ -1,6 +1,512 @@
 #include "ZHierarchyCullingChecker.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "./FrustumCullingChecker.h"
+#include "Math/SimdFloats.h"
+#include "Threading/JobSystem.h"
+
 namespace Esteem
 {
+	namespace
+	{
+		/// \brief occluders are clipped a bit outside of the screen, keeps the edge functions precise
+		constexpr float GuardBand = 2.f;
+		constexpr int ClipPlaneCount = 5;
+		/// \brief a triangle gains at most one vertex per clip plane
+		constexpr std::size_t MaxClippedVertices = 3 + ClipPlaneCount;
+
+		/// \brief planes w >= NearW, |x| <= GuardBand * w and |y| <= GuardBand * w, inside when >= 0
+		inline float ClipDistance(const glm::vec4& vertex, int plane)
+		{
+			switch (plane)
+			{
+			case 0: return vertex.w - ZHierarchyCullingChecker::NearW;
+			case 1: return GuardBand * vertex.w - vertex.x;
+			case 2: return GuardBand * vertex.w + vertex.x;
+			case 3: return GuardBand * vertex.w - vertex.y;
+			default: return GuardBand * vertex.w + vertex.y;
+			}
+		}
+
+		inline uint32_t ClipCode(const glm::vec4& vertex)
+		{
+			uint32_t code = 0;
+			for (int plane = 0; plane < ClipPlaneCount; ++plane)
+				code |= uint32_t(ClipDistance(vertex, plane) < 0.f) << plane;
+
+			return code;
+		}
+	}
+
+	ZHierarchyCullingChecker::ZHierarchyCullingChecker()
+		: viewProjection(1.f)
+		, active(false)
+	{
+		for (uint level = 0; level < LevelCount; ++level)
+		{
+			levels[level].width = Width >> level;
+			levels[level].height = Height >> level;
+			levels[level].furthest.resize(levels[level].width * levels[level].height, 0.f);
+			if (level > 0)
+				levels[level].nearest.resize(levels[level].width * levels[level].height, 0.f);
+		}
+	}
+
+	void ZHierarchyCullingChecker::AddOccluder(const Occluder* occluder)
+	{
+		std::lock_guard<std::mutex> lk(occludersLock);
+		occluders.push_back(occluder);
+	}
+
+	void ZHierarchyCullingChecker::RemoveOccluder(const Occluder* occluder)
+	{
+		std::lock_guard<std::mutex> lk(occludersLock);
+		auto it = std::find(occluders.begin(), occluders.end(), occluder);
+		if (it != occluders.end())
+		{
+			*it = occluders.back();
+			occluders.pop_back();
+		}
+	}
+
+	void ZHierarchyCullingChecker::RenderOccluders(const glm::mat4& viewProjection, const FrustumCullingChecker* frustum, JobSystem* jobSystem)
+	{
+		this->viewProjection = viewProjection;
+
+		std::lock_guard<std::mutex> lk(occludersLock);
+
+		std::size_t threadCount = jobSystem ? jobSystem->GetThreadCount() : 1;
+		threadTriangles.resize(threadCount);
+		threadVertices.resize(threadCount);
+		for (auto& triangles : threadTriangles)
+			triangles.clear();
+
+		auto setupOccluders = [&](std::size_t from, std::size_t to)
+		{
+			std::size_t thread = jobSystem ? JobSystem::GetThreadIndex() : 0;
+			for (std::size_t i = from; i < to; ++i)
+			{
+				const Occluder& occluder = *occluders[i];
+				if (frustum && occluder.bounds && frustum->ClassifyBox(*occluder.bounds) == FrustumIntersection::OUTSIDE)
+					continue;
+
+				SetupOccluder(occluder, threadVertices[thread], threadTriangles[thread]);
+			}
+		};
+
+		if (jobSystem)
+			jobSystem->WaitFor(jobSystem->ParallelFor(occluders.size(), 1, setupOccluders));
+		else
+			setupOccluders(0, occluders.size());
+
+		active = std::any_of(threadTriangles.begin(), threadTriangles.end(), [](const std::vector<Triangle>& triangles) { return !triangles.empty(); });
+		if (!active)
+			return;
+
+		// every band clears and fills its own rows, then reduces them as far as they go
+		auto rasterizeBands = [&](std::size_t from, std::size_t to)
+		{
+			for (std::size_t band = from; band < to; ++band)
+			{
+				uint firstRow = uint(band) * BandHeight;
+				RasterizeBand<Math::WideFloats>(firstRow, firstRow + BandHeight);
+
+				for (uint level = 1; level < LevelCount && (BandHeight >> level) > 0; ++level)
+					BuildLevelRows(level, firstRow >> level, (firstRow + BandHeight) >> level);
+			}
+		};
+
+		constexpr std::size_t bandCount = Height / BandHeight;
+		if (jobSystem)
+			jobSystem->WaitFor(jobSystem->ParallelFor(bandCount, 1, rasterizeBands));
+		else
+			rasterizeBands(0, bandCount);
+
+		for (uint level = 1; level < LevelCount; ++level)
+		{
+			if ((BandHeight >> level) == 0)
+				BuildLevelRows(level, 0, levels[level].height);
+		}
+	}
+
+	void ZHierarchyCullingChecker::SetupOccluder(const Occluder& occluder, std::vector<glm::vec4>& clipVertices, std::vector<Triangle>& triangles) const
+	{
+		glm::mat4 transform = occluder.modelMatrix ? viewProjection * *occluder.modelMatrix : viewProjection;
+
+		clipVertices.resize(occluder.vertices.size());
+		for (std::size_t i = 0; i < occluder.vertices.size(); ++i)
+			clipVertices[i] = transform * glm::vec4(occluder.vertices[i], 1.f);
+
+		const std::size_t vertexCount = clipVertices.size();
+		const std::vector<uint32_t>& indices = occluder.indices;
+		for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			if (indices[i] < vertexCount && indices[i + 1] < vertexCount && indices[i + 2] < vertexCount)
+				ClipTriangle(clipVertices[indices[i]], clipVertices[indices[i + 1]], clipVertices[indices[i + 2]], triangles);
+		}
+	}
+
+	void ZHierarchyCullingChecker::ClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, std::vector<Triangle>& triangles) const
+	{
+		uint32_t codeA = ClipCode(a), codeB = ClipCode(b), codeC = ClipCode(c);
+
+		// completely outside of one of the planes
+		if (codeA & codeB & codeC)
+			return;
+
+		if ((codeA | codeB | codeC) == 0)
+		{
+			AddTriangle(a, b, c, triangles);
+			return;
+		}
+
+		glm::vec4 polygons[2][MaxClippedVertices] = { { a, b, c } };
+		std::size_t count = 3;
+		uint current = 0;
+
+		uint32_t crossedPlanes = codeA | codeB | codeC;
+		for (int plane = 0; plane < ClipPlaneCount; ++plane)
+		{
+			if (!(crossedPlanes & (1u << plane)))
+				continue;
+
+			const glm::vec4* input = polygons[current];
+			glm::vec4* output = polygons[current ^ 1];
+			std::size_t outputCount = 0;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const glm::vec4& from = input[i];
+				const glm::vec4& to = input[(i + 1) % count];
+				float fromDistance = ClipDistance(from, plane);
+				float toDistance = ClipDistance(to, plane);
+
+				if (fromDistance >= 0.f)
+					output[outputCount++] = from;
+
+				if ((fromDistance >= 0.f) != (toDistance >= 0.f))
+					output[outputCount++] = from + (to - from) * (fromDistance / (fromDistance - toDistance));
+			}
+
+			count = outputCount;
+			current ^= 1;
+
+			if (count < 3)
+				return;
+		}
+
+		for (std::size_t i = 1; i + 1 < count; ++i)
+			AddTriangle(polygons[current][0], polygons[current][i], polygons[current][i + 1], triangles);
+	}
+
+	void ZHierarchyCullingChecker::AddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, std::vector<Triangle>& triangles)
+	{
+		const glm::vec4* clip[3] = { &a, &b, &c };
+		float x[3], y[3], z[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			z[i] = 1.f / clip[i]->w;
+			x[i] = (clip[i]->x * z[i] * 0.5f + 0.5f) * Width;
+			y[i] = (clip[i]->y * z[i] * 0.5f + 0.5f) * Height;
+		}
+
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (!(std::abs(area) > 1e-6f))
+			return;
+
+		// both windings are drawn, so single sided walls hide from both sides
+		if (area < 0.f)
+		{
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+			std::swap(z[1], z[2]);
+			area = -area;
+		}
+
+		Triangle triangle;
+
+		// pixel centers are at + 0.5, only the ones between the extremes can be covered
+		triangle.minX = std::max(0, int(std::ceil(std::min({ x[0], x[1], x[2] }) - 0.5f)));
+		triangle.maxX = std::min(int(Width) - 1, int(std::floor(std::max({ x[0], x[1], x[2] }) - 0.5f)));
+		triangle.minY = std::max(0, int(std::ceil(std::min({ y[0], y[1], y[2] }) - 0.5f)));
+		triangle.maxY = std::min(int(Height) - 1, int(std::floor(std::max({ y[0], y[1], y[2] }) - 0.5f)));
+
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+			return;
+
+		// edge e runs from vertex e to the next one and is 0 on it, positive towards the opposite vertex
+		for (int e = 0; e < 3; ++e)
+		{
+			int next = (e + 1) % 3;
+			triangle.edgeA[e] = y[e] - y[next];
+			triangle.edgeB[e] = x[next] - x[e];
+			triangle.edgeC[e] = -(triangle.edgeA[e] * x[e] + triangle.edgeB[e] * y[e]);
+		}
+
+		// the edge opposite of a vertex divided by the area is its barycentric weight, 1/w is linear in screen space
+		float invArea = 1.f / area;
+		triangle.depthA = (z[0] * triangle.edgeA[1] + z[1] * triangle.edgeA[2] + z[2] * triangle.edgeA[0]) * invArea;
+		triangle.depthB = (z[0] * triangle.edgeB[1] + z[1] * triangle.edgeB[2] + z[2] * triangle.edgeB[0]) * invArea;
+		triangle.depthC = (z[0] * triangle.edgeC[1] + z[1] * triangle.edgeC[2] + z[2] * triangle.edgeC[0]) * invArea;
+
+		triangles.push_back(triangle);
+	}
+
+	template<class V>
+	void ZHierarchyCullingChecker::RasterizeBand(uint firstRow, uint endRow)
+	{
+		float* depth = levels[0].furthest.data();
+		std::fill(depth + firstRow * Width, depth + endRow * Width, 0.f);
+
+		float laneOffsets[V::Width];
+		for (std::size_t i = 0; i < V::Width; ++i)
+			laneOffsets[i] = float(i) + 0.5f;
+
+		const V offsets = V::Load(laneOffsets);
+		const V zero = V::Set1(0.f);
+
+		for (const auto& triangles : threadTriangles)
+		{
+			for (const Triangle& triangle : triangles)
+			{
+				int minY = std::max(triangle.minY, int(firstRow));
+				int maxY = std::min(triangle.maxY, int(endRow) - 1);
+				if (minY > maxY)
+					continue;
+
+				// rows are a multiple of the width, so aligned steps never run past them
+				int minX = triangle.minX & ~int(V::Width - 1);
+
+				V edgeA0 = V::Set1(triangle.edgeA[0]), edgeA1 = V::Set1(triangle.edgeA[1]), edgeA2 = V::Set1(triangle.edgeA[2]);
+				V depthA = V::Set1(triangle.depthA);
+
+				for (int y = minY; y <= maxY; ++y)
+				{
+					float centerY = float(y) + 0.5f;
+					V edgeRow0 = V::Set1(triangle.edgeB[0] * centerY + triangle.edgeC[0]);
+					V edgeRow1 = V::Set1(triangle.edgeB[1] * centerY + triangle.edgeC[1]);
+					V edgeRow2 = V::Set1(triangle.edgeB[2] * centerY + triangle.edgeC[2]);
+					V depthRow = V::Set1(triangle.depthB * centerY + triangle.depthC);
+
+					float* row = depth + y * Width;
+					for (int x = minX; x <= triangle.maxX; x += int(V::Width))
+					{
+						V centerX = V::Set1(float(x)) + offsets;
+						V covered = (edgeA0 * centerX + edgeRow0).GreaterEqual(zero)
+							& (edgeA1 * centerX + edgeRow1).GreaterEqual(zero)
+							& (edgeA2 * centerX + edgeRow2).GreaterEqual(zero);
+
+						// uncovered lanes become 0, the furthest possible depth
+						V::Max(V::Load(row + x), (depthA * centerX + depthRow) & covered).Store(row + x);
+					}
+				}
+			}
+		}
+	}
+
+	void ZHierarchyCullingChecker::BuildLevelRows(uint level, uint firstRow, uint endRow)
+	{
+		const Level& source = levels[level - 1];
+		const std::vector<float>& sourceNearest = level == 1 ? source.furthest : source.nearest;
+		Level& target = levels[level];
+
+		for (uint y = firstRow; y < endRow; ++y)
+		{
+			for (uint x = 0; x < target.width; ++x)
+			{
+				std::size_t i = std::size_t(y) * 2 * source.width + x * 2;
+				std::size_t j = i + source.width;
+
+				target.furthest[y * target.width + x] = std::min({ source.furthest[i], source.furthest[i + 1], source.furthest[j], source.furthest[j + 1] });
+				target.nearest[y * target.width + x] = std::max({ sourceNearest[i], sourceNearest[i + 1], sourceNearest[j], sourceNearest[j + 1] });
+			}
+		}
+	}
+
+	template<class V>
+	inline void ZHierarchyCullingChecker::CheckBoxes(const CullingBoxes& boxes, std::size_t i, uint32_t& visible) const
+	{
+		const glm::mat4& m = viewProjection;
+
+		V centerX = V::Load(boxes.centerX + i), centerY = V::Load(boxes.centerY + i), centerZ = V::Load(boxes.centerZ + i);
+		V extents[3] = { V::Load(boxes.extentX + i), V::Load(boxes.extentY + i), V::Load(boxes.extentZ + i) };
+
+		// clip coordinates are linear, so every corner is the center plus or minus the projected extent of each axis
+		V clipX = V::Set1(m[0][0]) * centerX + V::Set1(m[1][0]) * centerY + V::Set1(m[2][0]) * centerZ + V::Set1(m[3][0]);
+		V clipY = V::Set1(m[0][1]) * centerX + V::Set1(m[1][1]) * centerY + V::Set1(m[2][1]) * centerZ + V::Set1(m[3][1]);
+		V clipW = V::Set1(m[0][3]) * centerX + V::Set1(m[1][3]) * centerY + V::Set1(m[2][3]) * centerZ + V::Set1(m[3][3]);
+
+		V axisX[3], axisY[3], axisW[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			axisX[axis] = V::Set1(m[axis][0]) * extents[axis];
+			axisY[axis] = V::Set1(m[axis][1]) * extents[axis];
+			axisW[axis] = V::Set1(m[axis][3]) * extents[axis];
+		}
+
+		V minX = V::Set1(std::numeric_limits<float>::max()), minY = minX, minW = minX;
+		V maxX = V::Set1(std::numeric_limits<float>::lowest()), maxY = maxX;
+		V one = V::Set1(1.f);
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			V x = clipX, y = clipY, w = clipW;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (corner & (1 << axis))
+				{
+					x = x + axisX[axis];
+					y = y + axisY[axis];
+					w = w + axisW[axis];
+				}
+				else
+				{
+					x = x - axisX[axis];
+					y = y - axisY[axis];
+					w = w - axisW[axis];
+				}
+			}
+
+			V invW = one / w;
+			x = x * invW;
+			y = y * invW;
+
+			minW = V::Min(minW, w);
+			minX = V::Min(minX, x);
+			maxX = V::Max(maxX, x);
+			minY = V::Min(minY, y);
+			maxY = V::Max(maxY, y);
+		}
+
+		float minXs[V::Width], maxXs[V::Width], minYs[V::Width], maxYs[V::Width], minWs[V::Width];
+		minX.Store(minXs);
+		maxX.Store(maxXs);
+		minY.Store(minYs);
+		maxY.Store(maxYs);
+		minW.Store(minWs);
+
+		visible = 0;
+		for (std::size_t lane = 0; lane < V::Width; ++lane)
+			visible |= uint32_t(IsProjectionVisible(minXs[lane], minYs[lane], maxXs[lane], maxYs[lane], minWs[lane])) << lane;
+	}
+
+	bool ZHierarchyCullingChecker::IsProjectionVisible(float minX, float minY, float maxX, float maxY, float minW) const
+	{
+		// reaches the camera, the projected bounds mean nothing then
+		if (!(minW > NearW))
+			return true;
+
+		float left = (minX * 0.5f + 0.5f) * Width, right = (maxX * 0.5f + 0.5f) * Width;
+		float bottom = (minY * 0.5f + 0.5f) * Height, top = (maxY * 0.5f + 0.5f) * Height;
+
+		// off screen is up to the frustum
+		if (!(right >= 0.f && top >= 0.f && left < float(Width) && bottom < float(Height)))
+			return true;
+
+		// every pixel the box touches
+		int pixelMinX = int(std::max(left, 0.f)), pixelMaxX = int(std::min(right, float(Width - 1)));
+		int pixelMinY = int(std::max(bottom, 0.f)), pixelMaxY = int(std::min(top, float(Height - 1)));
+
+		// start at the level where the pixels fall in at most 2x2 texels
+		uint level = 0;
+		while (level + 1 < LevelCount && ((pixelMaxX >> level) - (pixelMinX >> level) > 1 || (pixelMaxY >> level) - (pixelMinY >> level) > 1))
+			++level;
+
+		return IsRectVisible(level, pixelMinX, pixelMinY, pixelMaxX, pixelMaxY, 1.f / minW);
+	}
+
+	bool ZHierarchyCullingChecker::IsRectVisible(uint level, int minX, int minY, int maxX, int maxY, float nearest) const
+	{
+		const Level& texels = levels[level];
+
+		for (int y = minY >> level; y <= (maxY >> level); ++y)
+		{
+			for (int x = minX >> level; x <= (maxX >> level); ++x)
+			{
+				std::size_t i = std::size_t(y) * texels.width + x;
+
+				if (level == 0)
+				{
+					if (nearest >= texels.furthest[i])
+						return true;
+
+					continue;
+				}
+
+				// every pixel of the texel is in front of the box
+				if (nearest < texels.furthest[i])
+					continue;
+
+				// no pixel of the texel is in front of the box
+				if (nearest >= texels.nearest[i])
+					return true;
+
+				int texelMinX = x << level, texelMinY = y << level;
+				int texelMaxX = texelMinX + (1 << level) - 1, texelMaxY = texelMinY + (1 << level) - 1;
+				if (IsRectVisible(level - 1, std::max(minX, texelMinX), std::max(minY, texelMinY), std::min(maxX, texelMaxX), std::min(maxY, texelMaxY), nearest))
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool ZHierarchyCullingChecker::SingleObjectCheck(const RenderObject* object)
+	{
+		return IsBoxVisible(object->GetPosition(), glm::vec3(0.f));
+	}
+
+	void ZHierarchyCullingChecker::RangeOfObjectsCheck(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside)
+	{
+		for (std::size_t word = 0, begin = 0; begin < boxes.count; ++word, begin += 64)
+		{
+			std::size_t end = std::min(begin + 64, boxes.count);
+			uint64_t visibleBits = 0;
+
+			if (!active)
+				visibleBits = end - begin == 64 ? ~uint64_t(0) : (uint64_t(1) << (end - begin)) - 1;
+			else
+			{
+				uint32_t mask;
+
+				std::size_t i = begin;
+				for (; i + Math::WideFloats::Width <= end; i += Math::WideFloats::Width)
+				{
+					CheckBoxes<Math::WideFloats>(boxes, i, mask);
+					visibleBits |= uint64_t(mask) << (i - begin);
+				}
+
+				for (; i < end; ++i)
+				{
+					CheckBoxes<Math::ScalarFloats>(boxes, i, mask);
+					visibleBits |= uint64_t(mask) << (i - begin);
+				}
+			}
+
+			visible[word] = visibleBits;
+			if (inside)
+				inside[word] = 0;
+		}
+	}
+
+	bool ZHierarchyCullingChecker::IsBoxVisible(const glm::vec3& center, const glm::vec3& extent) const
+	{
+		if (!active)
+			return true;
+
+		CullingBoxes box = { &center.x, &center.y, &center.z, &extent.x, &extent.y, &extent.z, 1 };
+
+		uint32_t visible;
+		CheckBoxes<Math::ScalarFloats>(box, 0, visible);
+		return visible;
+	}
 
-}
\ No newline at end of file
+	bool ZHierarchyCullingChecker::IsBoxVisible(const AxisAlignedBox& aab) const
+	{
+		glm::vec3 extent = (aab.end - aab.begin) * 0.5f;
+		return IsBoxVisible(aab.begin + extent, extent);
+	}
+}
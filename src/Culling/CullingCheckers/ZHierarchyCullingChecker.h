@@ -1,11 +1,107 @@
 #pragma once
 
+#include <mutex>
+#include <vector>
+#include <glm/glm.hpp>
+
 #include "./ICullingChecker.h"
+#include "Culling/Objects/Occluder.h"
 
 namespace Esteem
 {
+	class FrustumCullingChecker;
+	class JobSystem;
+
+	/// \brief Occlusion culling against a small depth buffer that is rasterized on the CPU
+	/// Occluders are rendered as 1/w (bigger is nearer) into bands of rows that are rasterized in parallel,
+	/// a pyramid with the nearest and furthest depth of every 2x2 block lets a box be tested with a few reads.
 	class ZHierarchyCullingChecker : public ICullingChecker
 	{
+	public:
+		static constexpr uint Width = 256;
+		static constexpr uint Height = 128;
+		/// \brief rows rasterized by one job, also builds the first pyramid levels of those rows
+		static constexpr uint BandHeight = 8;
+		/// \brief level 0 is the depth buffer itself, the last one is 2x1
+		static constexpr uint LevelCount = 8;
+		/// \brief clip space w occluders are clipped at, boxes that come closer are always visible
+		static constexpr float NearW = 0.01f;
+
+	private:
+		/// \brief edge functions and depth plane in pixel coordinates, pixel (x, y) is covered when all edges are >= 0 at its center
+		struct Triangle
+		{
+			float edgeA[3], edgeB[3], edgeC[3];
+			float depthA, depthB, depthC;
+			int minX, maxX, minY, maxY;
+		};
+
+		struct Level
+		{
+			uint width;
+			uint height;
+			/// \brief smallest 1/w of every texel, level 0 holds the depth buffer
+			std::vector<float> furthest;
+			/// \brief biggest 1/w of every texel, empty on level 0
+			std::vector<float> nearest;
+		};
+
+		std::vector<const Occluder*> occluders;
+		mutable std::mutex occludersLock;
+
+		glm::mat4 viewProjection;
+		Level levels[LevelCount];
+
+		/// \brief triangles set up per thread, so occluders can be transformed in parallel
+		std::vector<std::vector<Triangle>> threadTriangles;
+		std::vector<std::vector<glm::vec4>> threadVertices;
+
+		/// \brief false when there was nothing to render, every box is visible then
+		bool active;
+
+		void SetupOccluder(const Occluder& occluder, std::vector<glm::vec4>& clipVertices, std::vector<Triangle>& triangles) const;
+		/// \brief clip against the near plane and a guard band around the screen, then set up what's left
+		void ClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, std::vector<Triangle>& triangles) const;
+		static void AddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, std::vector<Triangle>& triangles);
+
+		template<class V>
+		void RasterizeBand(uint firstRow, uint endRow);
+		void BuildLevelRows(uint level, uint firstRow, uint endRow);
+
+		template<class V>
+		void CheckBoxes(const CullingBoxes& boxes, std::size_t index, uint32_t& visible) const;
+		bool IsRectVisible(uint level, int minX, int minY, int maxX, int maxY, float nearest) const;
+		bool IsProjectionVisible(float minX, float minY, float maxX, float maxY, float minW) const;
+
+	public:
+		ZHierarchyCullingChecker();
+		virtual ~ZHierarchyCullingChecker() = default;
+
+		// disable copy
+		ZHierarchyCullingChecker(const ZHierarchyCullingChecker&) = delete;
+		void operator=(const ZHierarchyCullingChecker&) = delete;
+
+		/// \brief the occluder needs to stay alive until it's removed again
+		void AddOccluder(const Occluder* occluder);
+		void RemoveOccluder(const Occluder* occluder);
+
+		/// \brief rasterize all occluders and build the depth pyramid, call every time the camera moves
+		/// \param frustum optional, skips occluders whose bounds are outside of it
+		/// \param jobSystem optional, rasterizes on its threads when given
+		void RenderOccluders(const glm::mat4& viewProjection, const FrustumCullingChecker* frustum = nullptr, JobSystem* jobSystem = nullptr);
+
+		/// \brief tests the object's position, use the box tests for anything with a volume
+		virtual bool SingleObjectCheck(const RenderObject* object);
+		/// \brief bit i of visible is cleared when box i is hidden behind the occluders, inside is always cleared
+		virtual void RangeOfObjectsCheck(const CullingBoxes& boxes, uint64_t* visible, uint64_t* inside = nullptr);
+
+		bool IsBoxVisible(const glm::vec3& center, const glm::vec3& extent) const;
+		bool IsBoxVisible(const AxisAlignedBox& aab) const;
+
+		/// \brief true when there are occluders in view, testing boxes is pointless otherwise
+		inline bool IsActive() const { return active; }
 
+		/// \brief 1/w of every pixel, row 0 is the bottom of the screen
+		inline const std::vector<float>& GetDepthBuffer() const { return levels[0].furthest; }
 	};
-}
\ No newline at end of file
+}
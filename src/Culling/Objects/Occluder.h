@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Memory/Partitioning/Spatial/AxisAlignedBox.h"
+
+namespace Esteem
+{
+	/// \brief triangles that hide whatever is behind them, e.g.: walls, floors and large props
+	/// Rendered into the ZHierarchyCullingChecker's depth buffer, keep them simple and inside the visible geometry.
+	struct Occluder
+	{
+		/// \brief model space positions, transformed by modelMatrix every frame
+		std::vector<glm::vec3> vertices;
+		std::vector<uint32_t> indices;
+
+		/// \brief nullptr when the vertices are in world space already
+		const glm::mat4* modelMatrix;
+		/// \brief world space bounds to skip occluders outside of the frustum, nullptr to always render it
+		const AxisAlignedBox* bounds;
+
+		Occluder()
+			: modelMatrix(nullptr)
+			, bounds(nullptr)
+		{ }
+
+		inline std::size_t GetTriangleCount() const { return indices.size() / 3; }
+	};
+}
@@ -6,9 +6,13 @@
 #include "Utils/Data.h"
 #include "Utils/Time.h"
 #include "Utils/Diagnostics.h"
+#include "Utils/Profiler.h"
+#include "Memory/FrameArena.h"
 
 #include "Input/Input.h"
 
+#include "General/Command.h"
+
 #include "General/Settings.h"
 #include "Physics/Physics.h"
 #include "Physics/Physics.h"
@@ -42,13 +46,15 @@ namespace Esteem
 		if (defaultEngine == nullptr)
 			defaultEngine = this;
 
+		Command::RegisterListener("profile", DELEGATE(&GameEngine::OnCommand, this));
+
 	}
 
 	GameEngine::~GameEngine()
 	{
-		taskWaiter.notify_all();
-		for (uint i = 0; i < threads.size(); ++i)
-			threads[i].join();
+		Command::UnRegisterListener("profile", DELEGATE(&GameEngine::OnCommand, this));
+
+		jobSystem.reset();
 
 		// Make sure we delete factories as last
 		Data::Destruct();
@@ -92,13 +98,12 @@ namespace Esteem
 		std::chrono::high_resolution_clock::time_point wakeTime = currentTime;
 		std::chrono::high_resolution_clock::duration deltaTime = std::chrono::seconds(0);
 
-		// threading
-		threadCount = std::thread::hardware_concurrency() - 1;
-		for (int i = 0; i < threadCount; ++i)
-			threads.emplace_back(&GameEngine::Worker, this);
+		// threading, this thread becomes the job system's main thread
+		threadCount = uint8(std::max(1u, std::thread::hardware_concurrency()) - 1);
+		jobSystem = std::make_unique<JobSystem>(threadCount);
+		FrameArena::CreateThreadArenas(jobSystem->GetThreadCount());
+		Profiler::SetThreadName("Main");
 
-		batchesCount = threads.size() * 4;
-		
 		//try
 		{
 			while (GameEngine::running)
@@ -134,28 +139,27 @@ namespace Esteem
 
 				for (auto& world : worlds)
 				{
-					batchedAmount = std::size_t(ceil(world->worldObjects.size() / float(batchesCount)));
-
 					// Game logic: Update calls and LateUpdate calls
 					ThreadLoop2(world);
 
-					// Work along and wait until tasks are done
-					MainWorker(world);
-
 					// do some networking
 					world->GetNetworkSystem().UpdateAsync();
 
 					// update matrices
 					ThreadLoop1(world);
-
-					// Work along and wait until tasks are done
-					MainWorker(world);
 				}
 
 				Diagnostics::frameTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - currentTime).count();
 
 				// Render scene
-				view->Render();
+				{
+					ESTEEM_PROFILE("Render");
+					view->Render();
+				}
+
+				// frame boundary, all jobs are finished so the frame arenas can be released
+				FrameArena::ResetThreadArenas();
+				Profiler::EndFrame();
 
 				//auto endFrameTime = std::chrono::high_resolution_clock::now();
 				//currentTime = endFrameTime;
@@ -191,74 +195,9 @@ namespace Esteem
 
 		if (this->scene)
 			this->scene->UnloadScene();
-	}
-
-	void GameEngine::Worker()
-	{
-		std::function<void()> function;
-
-		while (true)
-		{
-
-			{
-				std::unique_lock<std::mutex> lock(taskLock);
-				taskWaiter.wait(lock, [this] { return !GameEngine::running || !tasks.empty(); });
-
-				if (!GameEngine::running)
-					break;
-
-				workersActive++;
-
-				function = tasks.front().first;
-				tasks.pop_front();
-			}
-
-			try
-			{
-				function();
-			}
-			catch (std::exception& e)
-			{
-				Debug::Log("GameEngine::Worker Exception: " + std::string(e.what()));
-			}
-
-			workersActive--;
-		}
-	}
-
-	void GameEngine::MainWorker(cgc::raw_ptr<World> world)
-	{
-		std::function<void()> function;
-
-		while (!tasks.empty())
-		{
-
-			{
-				std::unique_lock<std::mutex> lock(taskLock);
-				if (!GameEngine::running || tasks.empty())
-					break;
-
-				workersActive++;
-
-				function = tasks.front().first;
-				tasks.pop_front();
-			}
 
-			try
-			{
-				function();
-			}
-			catch (std::exception& e)
-			{
-				Debug::Log("GameEngine::Worker Exception: " + std::string(e.what()));
-			}
-
-			workersActive--;
-		}
-
-		// SYNC
-		while (workersActive > 0)
-			std::this_thread::yield();
+		jobSystem.reset();
+		FrameArena::DestroyThreadArenas();
 	}
 
 	cgc::strong_ptr<World> GameEngine::CreateWorld()
@@ -268,6 +207,8 @@ namespace Esteem
 
 	void GameEngine::ThreadLoop1(cgc::raw_ptr<World> world)
 	{
+		ESTEEM_PROFILE("GameEngine::ThreadLoop1");
+
 		{
 			/*std::unique_lock<std::mutex> lock(taskLock);
 			IWorldObject* worldObject;
@@ -276,15 +217,8 @@ namespace Esteem
 
 			tasks.emplace_back(std::bind(&world::DirtyCleanUp, world));
 			tasks.emplace_back(std::bind(&WorldController::DirtyCleanUp, world));*/
-			
-			bool test = true;
 
-			IWorldObject* worldObject;
-			while (world->dirtyWorldObjects.pop(worldObject))
-			{
-				worldObject->DirtyCleanUp();
-				test = false;
-			}
+			world->DirtyTransformCleanUp();
 		}
 
 		//taskWaiter.notify_all();
@@ -292,41 +226,19 @@ namespace Esteem
 
 	void GameEngine::ThreadLoop2(cgc::raw_ptr<World> world)
 	{
-		/*{
-			std::unique_lock<std::mutex> lock(taskLock);
-
-			// non concurrent test
-			world->GetPhysicsEngine()->UpdateWorld(Time::deltaTime);
+		ESTEEM_PROFILE("GameEngine::ThreadLoop2");
 
-			world->UpdateThreadTasks(tasks, threadCount);
+		// Game logic: Update calls in parallel, then the serial tail
+		world->BuildUpdateRanges(updateRanges);
+		updateRanges.Run(*jobSystem, false);
 
-			for (size_t i = 0; i < batchesCount; ++i)
-				tasks.emplace_back(std::bind(&GameEngine::WorldObjectsUpdate, this, i * batchedAmount, (i + 1) * batchedAmount));
-
-			// append new task giver
-			tasks.emplace_back(std::bind(&GameEngine::ThreadLoop3, this));
-		}
-
-		taskWaiter.notify_all();*/
-
-		auto& entitiesVector = world->entities.get_arrays();
+		world->DirtyCleanUp();
 
-		for (std::size_t v = 0; v < entitiesVector.size(); ++v)
 		{
-			auto& entities = *entitiesVector[v];
-			for (auto& entity : entities)
-				entity.Update();
+			ESTEEM_PROFILE("World::Update");
+			world->Update();
 		}
 
-		auto& worldObjects = world->worldObjects;
-		for (size_t i = 0; i < worldObjects.size(); ++i)
-			worldObjects[i]->Update();
-
-
-		world->DirtyCleanUp();
-
-		world->Update();
-
 		world->Physics().UpdateWorld(Time::deltaTime);
 
 		this->ThreadLoop3(world);
@@ -334,54 +246,32 @@ namespace Esteem
 
 	void GameEngine::ThreadLoop3(cgc::raw_ptr<World> world)
 	{
-		// SYNC: 2
-		/*while (!tasks.empty() || workersActive > 1)
-			std::this_thread::yield();
-
-		{
-			std::unique_lock<std::mutex> lock(taskLock);
-			for (size_t i = 0; i < batchesCount; ++i)
-				tasks.emplace_back(std::bind(&GameEngine::WorldObjectsLateUpdate, this, i * batchedAmount, (i + 1) * batchedAmount));
-		}
-
-		taskWaiter.notify_all();*/
-
-		for (auto& entity : world->entities)
-			entity.LateUpdate();
-
-		for (auto& vector : world->entities.get_arrays())
-		{
-			for (auto& entity : *vector)
-				entity.LateUpdate();
-		}
-
-		for (size_t i = 0; i < world->worldObjects.size(); ++i)
-			world->worldObjects[i]->LateUpdate();
+		ESTEEM_PROFILE("GameEngine::ThreadLoop3");
 
+		// objects may have been added or removed during Update
+		world->BuildUpdateRanges(updateRanges);
+		updateRanges.Run(*jobSystem, true);
 
 		world->LateUpdate();
 	}
 
-	void GameEngine::WorldObjectsUpdate(cgc::raw_ptr<World> world, size_t from, size_t to)
+	void GameEngine::OnCommand(const std::string& command, const std::string& value)
 	{
-
-		for (auto& vector : world->entities.get_arrays())
+		switch (RT_HASH(value))
 		{
-			for (auto& entity : *vector)
-				entity.Update();
+		case CT_HASH("start"):
+			Profiler::Start();
+			break;
+		case CT_HASH("stop"):
+			Profiler::Stop();
+			break;
+		default:
+			if (!value.empty() && Profiler::WriteChromeTrace(value))
+				Debug::Log("Profiler: trace written to " + value);
+			break;
 		}
-
-		for (size_t i = from; i < to && i < world->worldObjects.size(); ++i)
-			world->worldObjects[i]->Update();
 	}
 
-	void GameEngine::WorldObjectsLateUpdate(cgc::raw_ptr<World> world, size_t from, size_t to)
-	{
-		for (auto& worldObject : world->worldObjects)
-			worldObject->LateUpdate();
-	}
-
-
 	void GameEngine::SetScene(const cgc::strong_ptr<Scene>& scene)
 	{
 		if (scene)
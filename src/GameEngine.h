@@ -3,16 +3,14 @@
 #include "stdafx.h"
 
 #include <thread>
-#include <condition_variable>
-#include <mutex>
-#include <atomic>
-#include <deque>
 #include <chrono>
+#include <utility>
 
 #include "World/World.h"
 #include "Client/RenderView.h"
 #include "Window/View.h"
 #include "Utils/Data.h"
+#include "Threading/JobSystem.h"
 
 #include "World/Scene.h"
 
@@ -41,37 +39,19 @@ namespace Esteem
 		/// \briefthe amount of threads that'll be run
 		uint8 threadCount;
 
-		/// \brief count (operations) per batch
-		std::size_t batchesCount;
-		/// \brief amount of batches that need to be processed
-		std::size_t batchedAmount;
-
 		/// \brief fixed fps limiter
 		static std::chrono::high_resolution_clock::duration targetSleepTime;
 		
 		// Threading
-		/// \brief mutex lock to lock all 
-		std::mutex taskLock;
-		/// \brief condition_variable to wake up sleeping workers
-		std::condition_variable taskWaiter;
-		/// \brief current count of active/working threads
-		std::atomic<uint8> workersActive;
-
-		/// \brief thread handlers
-		std::vector<std::thread> threads;
-		/// \brief tasks that should be executed in the next sequence
-		std::deque<std::pair<std::function<void()>, World*>> tasks;
-		/// \brief which task should be done next
-		std::atomic<uint> nextTask;
+		/// \brief work-stealing job system, owns the worker threads
+		std::unique_ptr<JobSystem> jobSystem;
+
+		/// \brief the world's entities and world objects split in ranges for the update jobs, rebuilt every phase
+		World::WorldUpdateRanges updateRanges;
 
 		cgc::strong_ptr<Scene> scene;
 		cgc::strong_ptr<Scene> newScene;
 
-		/// \brief Worker thread function to execute all parallel operations
-		void Worker();
-		/// \brief Function for the main thread to help along with the other workers
-		void MainWorker(cgc::raw_ptr<World>);
-
 		/// \brief task collector TODO: requires rename
 		void ThreadLoop1(cgc::raw_ptr<World> world);
 		/// \brief task collector TODO: requires rename
@@ -79,10 +59,8 @@ namespace Esteem
 		/// \brief task collector TODO: requires rename
 		void ThreadLoop3(cgc::raw_ptr<World> world);
 
-		/// \brief Helper function to easier loop a certain size of a list/queue
-		void WorldObjectsUpdate(cgc::raw_ptr<World> world, size_t from, size_t to);
-		/// \brief Helper function to easier loop a certain size of a list/queue
-		void WorldObjectsLateUpdate(cgc::raw_ptr<World> world, size_t from, size_t to);
+		/// \brief "profile start", "profile stop" or "profile <file>" to export a Chrome trace
+		void OnCommand(const std::string& command, const std::string& value);
 
 	public:
 		/// \brief contruct the GameEngine
@@ -100,6 +78,9 @@ namespace Esteem
 
 		inline IView* GetView() const {	return view.get(); }
 
+		/// \brief get the job system, only available while the engine is executing
+		inline JobSystem* GetJobSystem() const { return jobSystem.get(); }
+
 		void SetScene(const cgc::strong_ptr<Scene>& scene);
 
 		/// \brief thread function, main execution for the game engine (runs apart from initial thread)
@@ -17,6 +17,9 @@ namespace Esteem
 	glm::uvec2 Settings::shadowAtlasSize = glm::uvec2(1024, 1024);
 	glm::uvec2 Settings::cascadedShadowMapSize = glm::uvec2(1024, 1024);
 
+	uint Settings::instancingThreshold = 8;
+	uint Settings::frameRingBufferSize = 12 * 1024 * 1024;
+
 	bool Settings::drawLines = false;
 	bool Settings::drawDebug = false;
 	bool Settings::drawCollisionBoxes = false;
@@ -38,6 +38,7 @@ namespace Esteem
 		{
 			OPENGL = 0,
 			DIRECTX = 1,
+			NONE = 2, // NullRenderer, no GPU
 			COUNT
 		} rendererType;
 
@@ -62,6 +63,12 @@ namespace Esteem
 		static glm::uvec2 shadowAtlasSize;
 		static glm::uvec2 cascadedShadowMapSize;
 
+		/// \brief objects sharing a mesh and material are drawn instanced from this many on, 0 disables instancing
+		/// Only materials whose shader has the instanceMatrices samplerBuffer are instanced.
+		static uint instancingThreshold;
+		/// \brief bytes of the mapped buffer per frame uniforms and bone palettes are written to, split over the frames in flight
+		static uint frameRingBufferSize;
+
 		enum PhysicsEngine
 		{
 			BULLET = 0
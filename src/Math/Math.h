@@ -2,6 +2,11 @@
 
 #include <glm/glm.hpp>
 #include <array>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #ifndef M_PI
 #define M_PI	3.14159265358979323846264338328
@@ -150,4 +155,23 @@ namespace Math
 	{
 		return from + (to - from) * delta;
 	}
+
+	/// \brief index of the lowest set bit, bits must not be 0
+	inline static uint32_t CountTrailingZeros(uint64_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, bits);
+		return uint32_t(index);
+#else
+		return uint32_t(__builtin_ctzll(bits));
+#endif
+	}
+
+	/// \brief true when the box from begin to end and the sphere share any point
+	inline static bool BoxOverlapsSphere(const glm::vec3& begin, const glm::vec3& end, const glm::vec3& center, float radius)
+	{
+		glm::vec3 delta = glm::clamp(center, begin, end) - center;
+		return glm::dot(delta, delta) <= radius * radius;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+namespace Math
+{
+	/// \brief Small wrappers so the same kernel can be instantiated for scalar, SSE or AVX widths
+	/// Only plain arithmetic, min/max and comparisons are exposed (no FMA), so every width produces bit-exact results
+	/// as long as the compiler doesn't contract a * b + c into an FMA either, CMakeLists.txt passes -ffp-contract=off to the files using them.
+	struct ScalarFloats
+	{
+		static constexpr std::size_t Width = 1;
+		float v;
+
+		static inline ScalarFloats Set1(float value) { return { value }; }
+		static inline ScalarFloats Load(const float* data) { return { *data }; }
+		static inline ScalarFloats Gather(const float* base, const int32_t* indices) { return { base[indices[0]] }; }
+		inline void Store(float* data) const { *data = v; }
+		/// \brief bit i is set when lane i is greater than lane i of other, false for NaN
+		inline uint32_t GreaterThanMask(ScalarFloats other) const { return v > other.v ? 1u : 0u; }
+		/// \brief lanes with all bits set where this is greater or equal to other, to be combined with operator&
+		inline ScalarFloats GreaterEqual(ScalarFloats other) const { return FromBits(v >= other.v ? ~0u : 0u); }
+
+		/// \brief same as the SSE instructions: returns b when either is NaN
+		static inline ScalarFloats Min(ScalarFloats a, ScalarFloats b) { return { a.v < b.v ? a.v : b.v }; }
+		static inline ScalarFloats Max(ScalarFloats a, ScalarFloats b) { return { a.v > b.v ? a.v : b.v }; }
+
+		friend inline ScalarFloats operator+(ScalarFloats a, ScalarFloats b) { return { a.v + b.v }; }
+		friend inline ScalarFloats operator-(ScalarFloats a, ScalarFloats b) { return { a.v - b.v }; }
+		friend inline ScalarFloats operator*(ScalarFloats a, ScalarFloats b) { return { a.v * b.v }; }
+		friend inline ScalarFloats operator/(ScalarFloats a, ScalarFloats b) { return { a.v / b.v }; }
+		friend inline ScalarFloats operator&(ScalarFloats a, ScalarFloats b) { return FromBits(a.ToBits() & b.ToBits()); }
+
+	private:
+		static inline ScalarFloats FromBits(uint32_t bits) { ScalarFloats result; std::memcpy(&result.v, &bits, sizeof(bits)); return result; }
+		inline uint32_t ToBits() const { uint32_t bits; std::memcpy(&bits, &v, sizeof(bits)); return bits; }
+	};
+
+	struct SSEFloats
+	{
+		static constexpr std::size_t Width = 4;
+		__m128 v;
+
+		static inline SSEFloats Set1(float value) { return { _mm_set1_ps(value) }; }
+		static inline SSEFloats Load(const float* data) { return { _mm_loadu_ps(data) }; }
+		static inline SSEFloats Gather(const float* base, const int32_t* indices)
+		{
+			return { _mm_set_ps(base[indices[3]], base[indices[2]], base[indices[1]], base[indices[0]]) };
+		}
+		inline void Store(float* data) const { _mm_storeu_ps(data, v); }
+		inline uint32_t GreaterThanMask(SSEFloats other) const { return uint32_t(_mm_movemask_ps(_mm_cmpgt_ps(v, other.v))); }
+		inline SSEFloats GreaterEqual(SSEFloats other) const { return { _mm_cmpge_ps(v, other.v) }; }
+
+		static inline SSEFloats Min(SSEFloats a, SSEFloats b) { return { _mm_min_ps(a.v, b.v) }; }
+		static inline SSEFloats Max(SSEFloats a, SSEFloats b) { return { _mm_max_ps(a.v, b.v) }; }
+
+		friend inline SSEFloats operator+(SSEFloats a, SSEFloats b) { return { _mm_add_ps(a.v, b.v) }; }
+		friend inline SSEFloats operator-(SSEFloats a, SSEFloats b) { return { _mm_sub_ps(a.v, b.v) }; }
+		friend inline SSEFloats operator*(SSEFloats a, SSEFloats b) { return { _mm_mul_ps(a.v, b.v) }; }
+		friend inline SSEFloats operator/(SSEFloats a, SSEFloats b) { return { _mm_div_ps(a.v, b.v) }; }
+		friend inline SSEFloats operator&(SSEFloats a, SSEFloats b) { return { _mm_and_ps(a.v, b.v) }; }
+	};
+
+#ifdef __AVX2__
+	struct AVXFloats
+	{
+		static constexpr std::size_t Width = 8;
+		__m256 v;
+
+		static inline AVXFloats Set1(float value) { return { _mm256_set1_ps(value) }; }
+		static inline AVXFloats Load(const float* data) { return { _mm256_loadu_ps(data) }; }
+		static inline AVXFloats Gather(const float* base, const int32_t* indices)
+		{
+			return { _mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), 4) };
+		}
+		inline void Store(float* data) const { _mm256_storeu_ps(data, v); }
+		inline uint32_t GreaterThanMask(AVXFloats other) const { return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(v, other.v, _CMP_GT_OQ))); }
+		inline AVXFloats GreaterEqual(AVXFloats other) const { return { _mm256_cmp_ps(v, other.v, _CMP_GE_OQ) }; }
+
+		static inline AVXFloats Min(AVXFloats a, AVXFloats b) { return { _mm256_min_ps(a.v, b.v) }; }
+		static inline AVXFloats Max(AVXFloats a, AVXFloats b) { return { _mm256_max_ps(a.v, b.v) }; }
+
+		friend inline AVXFloats operator+(AVXFloats a, AVXFloats b) { return { _mm256_add_ps(a.v, b.v) }; }
+		friend inline AVXFloats operator-(AVXFloats a, AVXFloats b) { return { _mm256_sub_ps(a.v, b.v) }; }
+		friend inline AVXFloats operator*(AVXFloats a, AVXFloats b) { return { _mm256_mul_ps(a.v, b.v) }; }
+		friend inline AVXFloats operator/(AVXFloats a, AVXFloats b) { return { _mm256_div_ps(a.v, b.v) }; }
+		friend inline AVXFloats operator&(AVXFloats a, AVXFloats b) { return { _mm256_and_ps(a.v, b.v) }; }
+	};
+
+	typedef AVXFloats WideFloats;
+#else
+	typedef SSEFloats WideFloats;
+#endif
+}
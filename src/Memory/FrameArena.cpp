@@ -0,0 +1,150 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "Threading/JobSystem.h"
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	std::vector<std::unique_ptr<FrameArena>> FrameArena::threadArenas;
+	std::atomic<uint64_t> FrameArena::frame(0);
+
+	FrameArena::FrameArena(std::size_t blockSize, std::pmr::memory_resource* upstream)
+		: upstream(upstream)
+		, blockIndex(0)
+		, offset(0)
+		, blockSize(blockSize)
+		, liveAllocations(0)
+		, resetFrame(frame.load(std::memory_order_relaxed))
+	{
+		// up front, so the first frame a thread gets work in doesn't go to the heap
+		blocks.push_back(Block{ static_cast<std::byte*>(upstream->allocate(blockSize, alignof(std::max_align_t))), blockSize });
+	}
+
+	FrameArena::~FrameArena()
+	{
+		assert(liveAllocations == 0);
+		for (auto& block : blocks)
+			upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+	}
+
+	void* FrameArena::AllocateFromNextBlock(std::size_t bytes, std::size_t alignment)
+	{
+		// blocks start at max_align_t alignment, larger alignments are padded
+		std::size_t required = bytes + (alignment > alignof(std::max_align_t) ? alignment : 0);
+
+		std::size_t next = blocks.empty() ? 0 : blockIndex + 1;
+		while (next < blocks.size() && blocks[next].size < required)
+			++next;
+
+		if (next >= blocks.size())
+		{
+			std::size_t size = std::max(blockSize, required);
+			blocks.push_back(Block{ static_cast<std::byte*>(upstream->allocate(size, alignof(std::max_align_t))), size });
+			next = blocks.size() - 1;
+		}
+		else if (next > blockIndex + 1)
+		{
+			// keep the used blocks in front
+			std::swap(blocks[blockIndex + 1], blocks[next]);
+			next = blockIndex + 1;
+		}
+
+		blockIndex = next;
+		offset = 0;
+
+		return do_allocate(bytes, alignment);
+	}
+
+	void FrameArena::do_deallocate(void* pointer, std::size_t bytes, std::size_t)
+	{
+		assert(liveAllocations > 0);
+		--liveAllocations;
+#ifndef NDEBUG
+		std::memset(pointer, 0xDD, bytes);
+#else
+		(void)pointer;
+		(void)bytes;
+#endif
+	}
+
+	bool FrameArena::Reset()
+	{
+		// a frame_vector or frame_string still holds on to memory of this frame, handing it out again would corrupt it
+		assert(liveAllocations == 0);
+		if (liveAllocations != 0)
+			return false;
+
+		resetFrame = frame.load(std::memory_order_relaxed);
+
+#ifndef NDEBUG
+		for (std::size_t i = 0; i < blocks.size() && i <= blockIndex; ++i)
+			std::memset(blocks[i].data, 0xCD, i == blockIndex ? offset : blocks[i].size);
+#endif
+
+		blockIndex = 0;
+		offset = 0;
+		return true;
+	}
+
+	std::size_t FrameArena::GetUsedBytes() const
+	{
+		std::size_t used = 0;
+		for (std::size_t i = 0; i < blockIndex && i < blocks.size(); ++i)
+			used += blocks[i].size;
+
+		return used + offset;
+	}
+
+	std::size_t FrameArena::GetReservedBytes() const
+	{
+		std::size_t reserved = 0;
+		for (auto& block : blocks)
+			reserved += block.size;
+
+		return reserved;
+	}
+
+	FrameArena& FrameArena::Get()
+	{
+		if (JobSystem::IsJobThread())
+		{
+			std::size_t index = JobSystem::GetThreadIndex();
+			if (index < threadArenas.size())
+				return *threadArenas[index];
+		}
+
+		// nobody else resets this one, do it once the previous frames' memory is no longer used
+		static thread_local FrameArena localArena;
+		if (localArena.resetFrame != frame.load(std::memory_order_relaxed) && localArena.liveAllocations == 0)
+			localArena.Reset();
+
+		return localArena;
+	}
+
+	void FrameArena::CreateThreadArenas(std::size_t threadCount)
+	{
+		threadArenas.clear();
+		for (std::size_t i = 0; i < threadCount; ++i)
+			threadArenas.emplace_back(std::make_unique<FrameArena>());
+	}
+
+	void FrameArena::ResetThreadArenas()
+	{
+		for (std::size_t i = 0; i < threadArenas.size(); ++i)
+		{
+			if (!threadArenas[i]->Reset())
+				Debug::LogError("FrameArena: " + std::to_string(threadArenas[i]->GetLiveAllocations()) + " allocations of job thread " + std::to_string(i) + " outlived the frame, its arena isn't reset");
+		}
+
+		frame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void FrameArena::DestroyThreadArenas()
+	{
+		threadArenas.clear();
+	}
+}
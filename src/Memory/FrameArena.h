@@ -0,0 +1,95 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace Esteem
+{
+	/// \brief linear (bump) allocator for temporaries that only live during a single frame
+	/// Deallocating is free, all memory is handed back at once with Reset(). Every job system thread owns an arena
+	/// that the GameEngine resets on the frame boundary. Other threads get their own arena, which resets itself
+	/// on the first Get() of a new frame once none of its allocations are alive anymore. Threads with a loop of
+	/// their own (e.g.: networking) may also reset it at the start of their loop.
+	/// Blocks come from the upstream resource, which is the default resource at the time the arena is created.
+	class FrameArena : public std::pmr::memory_resource
+	{
+	public:
+		static constexpr std::size_t DefaultBlockSize = 256 * 1024;
+
+	private:
+		struct Block
+		{
+			std::byte* data;
+			std::size_t size;
+		};
+
+		std::pmr::memory_resource* upstream;
+
+		std::vector<Block> blocks;
+		std::size_t blockIndex;
+		std::size_t offset;
+		std::size_t blockSize;
+
+		/// \brief allocations that are not yet deallocated, must be 0 when the frame ends
+		std::size_t liveAllocations;
+		/// \brief frame in which the arena was last reset
+		uint64_t resetFrame;
+
+		/// \brief arenas of the job system threads, indexed by JobSystem::GetThreadIndex()
+		static std::vector<std::unique_ptr<FrameArena>> threadArenas;
+		/// \brief incremented by ResetThreadArenas(), tells the arenas of other threads a new frame started
+		static std::atomic<uint64_t> frame;
+
+		/// \brief move to the next block that fits, allocates a new block if none is left
+		void* AllocateFromNextBlock(std::size_t bytes, std::size_t alignment);
+
+	protected:
+		virtual void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+		virtual void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+		virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	public:
+		/// \brief the first block is allocated right away
+		FrameArena(std::size_t blockSize = DefaultBlockSize, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+		virtual ~FrameArena();
+
+		// disable copy
+		FrameArena(const FrameArena&) = delete;
+		void operator=(const FrameArena&) = delete;
+
+		/// \brief release all allocations, blocks are kept for the next frame
+		/// \return false when allocations are still alive, the arena is left untouched then so their memory isn't reused
+		bool Reset();
+
+		inline std::size_t GetLiveAllocations() const { return liveAllocations; }
+
+		std::size_t GetUsedBytes() const;
+		std::size_t GetReservedBytes() const;
+
+		/// \brief get the calling thread's arena
+		/// The arena of a thread outside the job system is reset here when a frame passed and nothing of it is alive.
+		static FrameArena& Get();
+
+		/// \brief create one arena for every thread of the job system, call from the job system's main thread
+		static void CreateThreadArenas(std::size_t threadCount);
+		/// \brief reset all job system arenas, only call when no jobs are running
+		static void ResetThreadArenas();
+		static void DestroyThreadArenas();
+	};
+
+	/// \brief vector on the calling thread's frame arena, e.g.: frame_vector<int> values(&FrameArena::Get());
+	template<class T>
+	using frame_vector = std::vector<T, std::pmr::polymorphic_allocator<T>>;
+
+	/// \brief string on the calling thread's frame arena, e.g.: frame_string text(&FrameArena::Get());
+	typedef std::basic_string<char, std::char_traits<char>, std::pmr::polymorphic_allocator<char>> frame_string;
+}
+
+#include "./FrameArena.inl"
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "FrameArena.h"
+
+namespace Esteem
+{
+	inline void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+	{
+		if (blockIndex < blocks.size())
+		{
+			Block& block = blocks[blockIndex];
+			std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(block.data);
+			std::size_t aligned = std::size_t(((begin + offset + alignment - 1) & ~std::uintptr_t(alignment - 1)) - begin);
+			if (aligned + bytes <= block.size)
+			{
+				offset = aligned + bytes;
+				++liveAllocations;
+				return block.data + aligned;
+			}
+		}
+
+		return AllocateFromNextBlock(bytes, alignment);
+	}
+
+	inline bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+}
@@ -3,6 +3,7 @@
 #include "stdafx.h"
 #include <vector>
 #include <list>
+#include <utility>
 #include <glm/vec3.hpp>
 
 #include "./OctreeData.h"
@@ -19,24 +20,45 @@ namespace Esteem
 			typedef OctreeNode<L> Node;
 
 		protected:
+			OctreeState<L> state;
 			Node root;
 
+			/// \brief moved leaves with their morton code, reused between batches
+			std::vector<std::pair<uint32_t, L*>> sortedMoves;
+			/// \brief swapped with a thread's translated list while it is merged, reused between merges
+			std::vector<L*> translatedLeaves;
+
 			static AxisAlignedBox CreateAxisAlignedBox(const glm::ivec3& position, uint size);
 
 			static void DivideBox(Node& node);
 
 			static void MergeBox(Node& node);
 
-			static bool CleanUp(Node& node, size_t parentIndex);
+			static void CleanUp(Node& node, size_t parentIndex);
 
 			static uint8 OctreeChildIndex(const Node& node, const glm::ivec3& position);
 
 			//template<typename T = AddRemoveClass, typename = std::enable_if_t<std::is_same<NoAddRemoveClass, T>::value, T>>
 			//static void MergeBox(Node* node);
 
-			static uint GetObjectsCountRecursive(const Node& node);
 			static uint GetSmallObjectsCount(const Node& node);
 
+			/// \brief true when the leaf may stay in the node, it doesn't have to be the deepest node it fits in
+			static bool CanHold(const Node& node, const glm::ivec3& position, uint minSize);
+			/// \brief grow the node and its parents around the leaf, depending on the wrapping
+			static void FitToLeaf(Node& node, const L& leaf);
+			static void ResetSizes(Node* node, const glm::vec3& min, const glm::vec3& max);
+			static void ResetSizes(Node* node, float size);
+
+			/// \brief 10 bits per axis within the root's cell, leaves close to each other share most of their path
+			static uint32_t MortonCode(const glm::vec3& position);
+
+			/// \brief move the queued leaves of every thread's translated list into state.moved when they left their node
+			void MergeTranslated();
+
+			/// \brief place every leaf in state.moved again, starting at the lowest node that can hold both its old and new position
+			void PlaceMoved();
+
 		public:
 			// disable copy
 			Octree(const Octree&) = delete;
@@ -51,8 +73,18 @@ namespace Esteem
 			virtual void QueryObjects(const AxisAlignedBox& aabb, std::vector<L*>& list);*/
 
 			void AddLeaf(L* leaf, const glm::ivec3& position, uint minSize);
+			/// \brief the leaf has to be in this tree, empty nodes are merged by the next CleanUp
 			void RemoveLeaf(L* leaf);
 
+			/// \brief place leaves of this tree again after they moved, sorted by morton code and under a single lock
+			/// Also places the leaves that went outside of their node through Translate.
+			void TranslateMany(L* const* leaves, size_t count);
+
+			/// \brief place translated leaves, merge nodes that dropped to MergeCount leaves and drop empty ones, call once per frame
+			void CleanUp();
+
+			inline uint GetLeafCount() const { return root.count; }
+
 			static Node* FindOrCreatePartition(Node& root, const glm::ivec3& position, uint minSize);
 			static Node* FindPartition(Node& root, const glm::ivec3& position);
 			static Node* CreatePartition(Node& parent, const glm::ivec3& position, uint size, uint8 cellIndex);
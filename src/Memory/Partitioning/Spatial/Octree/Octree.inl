@@ -1,5 +1,7 @@
 #include "Octree.h"
 
+#include <algorithm>
+
 namespace Esteem
 {
 	namespace Partitioning
@@ -10,48 +12,252 @@ namespace Esteem
 		{
 			static_assert(MergeCount <= DivideCount, "Octree::Octree(): MergeCount can not be bigger than DivideCount");
 			static_assert(MinGridSize <= MaxGridSize, "Octree::Octree(): MinGridSize can not be bigger than MaxGridSize");
+
+			root.state = &state;
 		}
 
 		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
-		bool Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::CleanUp(Node& node, size_t parentIndex)
+		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::CleanUp(Node& node, size_t parentIndex)
 		{
 			if (node.dirty)
 			{
-				size_t childCount = 0;
 				for (size_t i = 0; i < node.childs.size(); ++i)
 				{
 					if (Node* child = node.childs[i].get())
-					{
-						++childCount;
 						CleanUp(*child, i);
-					}
 				}
 
-				if (GetObjectsCountRecursive(node) <= MergeCount)
-					MergeBox(node);
-
-				if (node.parent != nullptr && childCount == 0 && node.leaves.empty())
+				if (node.parent != nullptr && node.count == 0)
 					node.parent->childs[parentIndex] = nullptr;
 				else
+				{
+					if (node.count <= MergeCount)
+						MergeBox(node);
+
 					node.dirty = false;
+				}
 			}
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::CleanUp()
+		{
+			std::lock_guard<std::mutex> lk(state.lock);
 
-			return false;
+			MergeTranslated();
+			PlaceMoved();
+
+			if (root.dirty)
+			{
+				for (size_t i = 0; i < root.childs.size(); ++i)
+				{
+					if (Node* child = root.childs[i].get())
+						CleanUp(*child, i);
+				}
+
+				root.dirty = false;
+			}
 		}
 
 		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
 		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::AddLeaf(L* leaf, const glm::ivec3& position, uint minSize)
 		{
-			uint8_t index = OctreeChildIndex(root, position);
-			auto* child = root.childs[index].get();
-			Node* partition = child ? FindOrCreatePartition(*child, position, minSize) : CreatePartition(root, position, minSize, index);
+			if (leaf->GetContainer() != nullptr)
+				leaf->RemoveFromCulling();
+
+			std::lock_guard<std::mutex> lk(state.lock);
+
+			Node* partition = FindOrCreatePartition(root, position, minSize);
 			partition->AddLeaf(leaf);
+			partition->RecordChange(leaf->GetAABB());
+			leaf->placedAab = leaf->GetAABB();
+			FitToLeaf(*partition, *leaf);
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::RemoveLeaf(L* leaf)
+		{
+			std::lock_guard<std::mutex> lk(state.lock);
+
+			if (Node* partition = static_cast<Node*>(leaf->GetContainer()))
+				partition->Detach(leaf);
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::TranslateMany(L* const* leaves, size_t count)
+		{
+			std::lock_guard<std::mutex> lk(state.lock);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				L* leaf = leaves[i];
+				Node* partition = static_cast<Node*>(leaf->GetContainer());
+				if (partition == nullptr)
+					continue;
+
+				partition->RecordMove(leaf);
+
+				if (!leaf->moved)
+				{
+					leaf->moved = true;
+					state.moved.push_back(leaf);
+				}
+			}
+
+			MergeTranslated();
+			PlaceMoved();
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::MergeTranslated()
+		{
+			for (auto& list : state.translated)
+			{
+				// the list keeps the capacity of the previous merge, threads translating meanwhile only wait for the swap
+				{
+					std::lock_guard<std::mutex> lk(list.lock);
+					if (list.leaves.empty())
+						continue;
+
+					translatedLeaves.swap(list.leaves);
+				}
+
+				for (L* leaf : translatedLeaves)
+				{
+					// removed leaves were taken out of the lists, so this is the node it was translated in or a later one
+					Node* partition = static_cast<Node*>(leaf->container);
+					partition->RecordMove(leaf);
+
+					const glm::vec3& min = leaf->GetAABB().begin;
+					const glm::vec3& max = leaf->GetAABB().end;
+					const AxisAlignedBox& aab = partition->aab;
+
+					if (!leaf->moved && (min.x < aab.begin.x || min.y < aab.begin.y || min.z < aab.begin.z ||
+						max.x > aab.end.x || max.y > aab.end.y || max.z > aab.end.z))
+					{
+						leaf->moved = true;
+						state.moved.push_back(leaf);
+					}
+				}
+
+				translatedLeaves.clear();
+			}
 		}
 
 		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
-		inline void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::RemoveLeaf(L * leaf)
+		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::PlaceMoved()
 		{
-			// TODO: build this
+			if (state.moved.empty())
+				return;
+
+			// neighbours are placed one after another, so they walk the same nodes while those are still in cache
+			sortedMoves.clear();
+			sortedMoves.reserve(state.moved.size());
+			for (L* leaf : state.moved)
+				sortedMoves.emplace_back(MortonCode(leaf->GetCenter()), leaf);
+
+			std::sort(sortedMoves.begin(), sortedMoves.end(), [](const std::pair<uint32_t, L*>& a, const std::pair<uint32_t, L*>& b) { return a.first < b.first; });
+
+			for (const auto& move : sortedMoves)
+			{
+				L* leaf = move.second;
+				leaf->moved = false;
+
+				glm::ivec3 position = (glm::ivec3)leaf->GetCenter();
+				uint minSize = (uint)leaf->GetSize();
+
+				Node* partition = static_cast<Node*>(leaf->container);
+				if (!CanHold(*partition, position, minSize))
+				{
+					// the root can hold anything, so this always ends
+					Node* ancestor = partition->parent;
+					while (!CanHold(*ancestor, position, minSize))
+						ancestor = ancestor->parent;
+
+					partition->RemoveLeafAt(leaf->containerSlot);
+					partition->SetDirty();
+
+					partition = FindOrCreatePartition(*ancestor, position, minSize);
+					partition->AddLeaf(leaf);
+				}
+
+				FitToLeaf(*partition, *leaf);
+			}
+
+			state.moved.clear();
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		inline bool Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::CanHold(const Node& partition, const glm::ivec3& position, uint minSize)
+		{
+			return partition.parent == nullptr || (minSize <= partition.size && partition.IsInCell(position));
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		inline void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::FitToLeaf(Node& partition, const L& leaf)
+		{
+			if constexpr (Wrapping == OctreeNodeWrapping::LOOSE)
+				ResetSizes(&partition, leaf.GetSize());
+			else if constexpr (Wrapping == OctreeNodeWrapping::TIGHT)
+				ResetSizes(&partition, leaf.GetAABB().begin, leaf.GetAABB().end);
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::ResetSizes(Node* node, const glm::vec3& min, const glm::vec3& max)
+		{
+			bool isSet = false;
+
+			// Make it nice and tight
+			if (min.x < node->aab.begin.x) { node->aab.begin.x = min.x; isSet = true; }
+			if (min.y < node->aab.begin.y) { node->aab.begin.y = min.y; isSet = true; }
+			if (min.z < node->aab.begin.z) { node->aab.begin.z = min.z; isSet = true; }
+
+			if (max.x > node->aab.end.x) { node->aab.end.x = max.x; isSet = true; }
+			if (max.y > node->aab.end.y) { node->aab.end.y = max.y; isSet = true; }
+			if (max.z > node->aab.end.z) { node->aab.end.z = max.z; isSet = true; }
+
+			if (node->parent != nullptr && isSet)
+				ResetSizes(node->parent, min, max);
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::ResetSizes(Node* node, float volumeSize)
+		{
+			bool isSet = false;
+
+			// Loosely fit
+			float overSize = ((node->aab.end.x - node->aab.begin.x) - node->size) * 0.5f;
+			if (volumeSize > overSize)
+			{
+				float deltaSize = volumeSize - overSize;
+				node->aab.begin -= deltaSize;
+				node->aab.end += deltaSize;
+				isSet = true;
+			}
+
+			if (node->parent != nullptr && isSet)
+				ResetSizes(node->parent, volumeSize);
+		}
+
+		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
+		uint32_t Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::MortonCode(const glm::vec3& position)
+		{
+			constexpr float scale = 1024.f / float(MaxGridSize);
+			constexpr float offset = float(MaxGridSize) * 0.5f;
+
+			uint32_t code = 0;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				uint32_t bits = uint32_t(std::min(std::max((position[axis] + offset) * scale, 0.f), 1023.f));
+				bits = (bits | (bits << 16)) & 0x030000FFu;
+				bits = (bits | (bits << 8)) & 0x0300F00Fu;
+				bits = (bits | (bits << 4)) & 0x030C30C3u;
+				bits = (bits | (bits << 2)) & 0x09249249u;
+
+				code |= bits << (2 - axis);
+			}
+
+			return code;
 		}
 
 		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
@@ -63,10 +269,12 @@ namespace Esteem
 				{
 					MergeBox(*child);
 
+					// the counts stay the same, the leaves were below this node already
 					partition.leaves.reserve(partition.leaves.size() + child->leaves.size());
-					for (auto& leaf : child->leaves)
+					for (L* leaf : child->leaves)
 					{
-						leaf->SetContainer(&partition);
+						leaf->container = &partition;
+						leaf->containerSlot = uint32_t(partition.leaves.size());
 						partition.leaves.push_back(leaf);
 					}
 
@@ -79,21 +287,21 @@ namespace Esteem
 		void Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::DivideBox(Node& partition)
 		{
 			uint halfSize = partition.size / 2;
-			for (size_t i = partition.leaves.size(); i-- >= 0;)
+			for (size_t i = partition.leaves.size(); i-- > 0;)
 			{
 				L* leaf = partition.leaves[i];
-				if (leaf->GetSize() <= halfSize)
+				glm::ivec3 position = (glm::ivec3)leaf->GetCenter();
+				if (leaf->GetSize() <= halfSize && partition.IsInCell(position))
 				{
 					partition.RemoveLeafAt(i);
 
-					glm::ivec3 position = (glm::ivec3)leaf->GetCenter();
-
 					uint index = OctreeChildIndex(partition, position);
 					Node* child = partition.childs[index].get();
 					if (child == nullptr)
 						child = CreatePartition(partition, position, halfSize, index);
 
 					child->AddLeaf(leaf);
+					FitToLeaf(*child, *leaf);
 				}
 			}
 		}
@@ -103,7 +311,8 @@ namespace Esteem
 		{
 			uint32_t halfSize = root.size / 2;
 
-			if (root.size <= MinGridSize || minSize > halfSize)
+			// only the root can be asked for a position outside of its cell
+			if (root.size <= MinGridSize || minSize > halfSize || !root.IsInCell(position))
 				return &root;
 			
 			if constexpr (MergeCount != DivideCount)
@@ -165,20 +374,6 @@ namespace Esteem
 				return AxisAlignedBox(position, (float)size, false);
 		}
 
-		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
-		uint Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::GetObjectsCountRecursive(const Node& partition)
-		{
-			uint count = partition.leaves.size();
-
-			for (const auto& child : partition.childs)
-			{
-				if (child)
-					count += GetObjectsCountRecursive(*child);
-			}
-
-			return count;
-		}
-
 		template<class L, size_t MaxGridSize, size_t MinGridSize, size_t DivideCount, size_t MergeCount, OctreeNodeWrapping Wrapping>
 		uint Octree<L, MaxGridSize, MinGridSize, DivideCount, MergeCount, Wrapping>::GetSmallObjectsCount(const Node& partition)
 		{
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <array>
-#include <cppu/stor/lock/deque.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "stdafx.h"
 
 #include "../AxisAlignedBox.h"
 #include "../SpatialObject.h"
 #include "../ISpatialObjectContainer.h"
+#include "Threading/JobSystem.h"
 
 namespace Esteem
 {
@@ -22,27 +26,60 @@ namespace Esteem
 		template<class L>
 		struct OctreeNode;
 
-		class CullingObject;
-
 		template<class L, size_t, size_t, size_t, size_t, OctreeNodeWrapping>
 		class Octree;
 
+		/// \brief shared by all nodes of a tree
+		template<class L>
+		struct OctreeState
+		{
+			/// \brief translated leaves of the threads that share a slot, merged into the tree by its CleanUp
+			struct alignas(64) TranslatedList
+			{
+				/// \brief only contended by the threads sharing the slot and the merge
+				std::mutex lock;
+				std::vector<L*> leaves;
+			};
+
+			/// \brief slot 0 is shared by the threads outside of a job system, job threads spread over the others
+			static constexpr size_t TranslatedListCount = 16;
+
+			/// \brief taken by the tree's public functions and the nodes' container functions, never by nodes among themselves
+			std::mutex lock;
+			/// \brief leaves that left their node, they stay there until the tree places them again
+			std::vector<L*> moved;
+			std::array<TranslatedList, TranslatedListCount> translated;
+			/// \brief old and new bounds of moved leaves and the bounds of removed leaves are appended here when set
+			std::vector<AxisAlignedBox>* changes;
+
+			OctreeState()
+				: changes(nullptr)
+			{ }
+
+			inline TranslatedList& GetTranslatedList()
+			{
+				return translated[JobSystem::IsJobThread() ? 1 + JobSystem::GetThreadIndex() % (TranslatedListCount - 1) : 0];
+			}
+		};
+
 		template<class L>
 		struct OctreeNode : ISpatialObjectContainer
 		{
-			template<class L, size_t, size_t, size_t, size_t, OctreeNodeWrapping>
+			template<class T, size_t, size_t, size_t, size_t, OctreeNodeWrapping>
 			friend class Octree;
 
 		public:
 			bool dirty;
-			std::shared_mutex lock;
 
 			uint32_t size;
+			/// \brief leaves in this node and all nodes below it
+			uint32_t count;
 			glm::ivec3 center;
 
 			AxisAlignedBox aab;
 
 			OctreeNode<L>* parent;
+			OctreeState<L>* state;
 			std::array<std::unique_ptr<OctreeNode<L>>, 8> childs;
 			std::vector<L*> leaves;
 
@@ -51,29 +88,46 @@ namespace Esteem
 			void operator=(const OctreeNode<L>&) = delete;
 
 			OctreeNode(const AxisAlignedBox& aab, OctreeNode<L>* parent, const glm::ivec3& center, uint32_t size)
-				: aab(aab), parent(parent), size(size), dirty(false), center(center)
+				: aab(aab), parent(parent), state(parent ? parent->state : nullptr), size(size), count(0), dirty(false), center(center)
 			{}
 
 			OctreeNode()
-				: center(glm::ivec3(0, 0, 0))
+				: center(glm::ivec3(0, 0, 0)), state(nullptr), count(0)
 			{}
 
+			/// \brief the leaf may not be in any container
 			inline void AddLeaf(L* leaf)
 			{
+				leaf->container = this;
+				leaf->containerSlot = uint32_t(leaves.size());
 				leaves.push_back(leaf);
-				leaf->SetContainer(this);
+
+				for (OctreeNode<L>* node = this; node; node = node->parent)
+					++node->count;
 			}
 
-			inline void RemoveLeaf(L* leaf)
+			/// \brief swaps the last leaf into its place, the leaf's container is left alone
+			inline void RemoveLeafAt(size_t index)
 			{
-				auto found = std::find(leaves.begin(), leaves.end(), leaf);
-				if(found != leaves.end())
-					RemoveLeafByIterator(found);
+				if (index + 1 != leaves.size())
+				{
+					leaves[index] = leaves.back();
+					leaves[index]->containerSlot = uint32_t(index);
+				}
+
+				leaves.pop_back();
+
+				for (OctreeNode<L>* node = this; node; node = node->parent)
+					--node->count;
 			}
 
-			inline void RemoveLeafAt(size_t index)
+			/// \brief true when the position is in this node's cell, the root also holds what is outside of its cell
+			inline bool IsInCell(const glm::ivec3& position) const
 			{
-				RemoveLeafByIterator(leaves.begin() + index);
+				int halfSize = int(size / 2);
+				return position.x >= center.x - halfSize && position.x < center.x + halfSize
+					&& position.y >= center.y - halfSize && position.y < center.y + halfSize
+					&& position.z >= center.z - halfSize && position.z < center.z + halfSize;
 			}
 
 			void SetDirty()
@@ -87,49 +141,65 @@ namespace Esteem
 				}
 			}
 
-			void PlaceObjectInRoot(L* leaf)
+			inline void RecordChange(const AxisAlignedBox& aab)
 			{
-				if (this->parent != nullptr)
-					this->parent->PlaceObjectInRoot(leaf);
-				else
-					this->leaves.push_back(leaf);
+				if (state && state->changes)
+					state->changes->push_back(aab);
 			}
 
-			virtual void Translate(SpatialObject* cullingObject)
+			/// \brief record the leaf's old and new bounds, the new ones are the old ones of its next move
+			inline void RecordMove(L* leaf)
 			{
-				const glm::vec3& min = cullingObject->GetAABB().begin;
-				const glm::vec3& max = cullingObject->GetAABB().end;
-
-				if (min.x < aab.begin.x || min.y < aab.begin.y || min.z < aab.begin.z ||
-					max.x > aab.end.x || max.y > aab.end.y || max.z > aab.end.z)
-				{
-					auto found = std::find(leaves.begin(), leaves.end(), cullingObject);
-					if (found != leaves.end())
-						leaves.erase(found);
+				RecordChange(leaf->placedAab);
+				RecordChange(leaf->GetAABB());
+				leaf->placedAab = leaf->GetAABB();
+			}
 
-					PlaceObjectInRoot(static_cast<L*>(cullingObject));
+			/// \brief only queues the leaf, the tree's CleanUp records its bounds and places it again when it left this node
+			/// Doesn't take the tree's lock, so objects can be translated from several threads at once.
+			virtual void Translate(SpatialObject* cullingObject)
+			{
+				auto& list = state->GetTranslatedList();
 
-					SetDirty();
-				}
+				std::lock_guard<std::mutex> lk(list.lock);
+				list.leaves.push_back(static_cast<L*>(cullingObject));
 			}
 
 			virtual void Scale(SpatialObject* cullingObject) {}
 
 			virtual void Remove(SpatialObject* cullingObject)
 			{
-				auto found = std::find(leaves.begin(), leaves.end(), cullingObject);
-				if (found != leaves.end())
-				{
-					leaves.erase(found);
-					SetDirty();
-				}
+				std::lock_guard<std::mutex> lk(state->lock);
+				Detach(static_cast<L*>(cullingObject));
 			}
 
 		protected:
-			inline virtual void RemoveLeafByIterator(const typename std::vector<L*>::iterator& it)
+			/// \brief remove the leaf without taking the lock, merging is left to the tree's CleanUp
+			void Detach(L* leaf)
 			{
-				L* leaf = *it;
-				leaves.erase(it);
+				if (leaf->containerSlot < leaves.size() && leaves[leaf->containerSlot] == leaf)
+				{
+					RemoveLeafAt(leaf->containerSlot);
+					// a translated leaf that wasn't merged yet was last recorded somewhere else
+					RecordChange(leaf->placedAab);
+					RecordChange(leaf->GetAABB());
+					SetDirty();
+				}
+
+				if (leaf->moved)
+				{
+					leaf->moved = false;
+					state->moved.erase(std::find(state->moved.begin(), state->moved.end(), leaf));
+				}
+
+				// it may be translated more than once before the next CleanUp
+				for (auto& list : state->translated)
+				{
+					std::lock_guard<std::mutex> lk(list.lock);
+					list.leaves.erase(std::remove(list.leaves.begin(), list.leaves.end(), leaf), list.leaves.end());
+				}
+
+				leaf->container = nullptr;
 			}
 		};
 	}
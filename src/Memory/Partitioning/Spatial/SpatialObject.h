@@ -2,6 +2,8 @@
 
 #include <map>
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 
 #include "./AxisAlignedBox.h"
 #include "./ISpatialObjectContainer.h"
@@ -10,18 +12,38 @@ namespace Esteem
 {
 	namespace Partitioning
 	{
+		enum class OctreeNodeWrapping;
+
+		template<class L>
+		struct OctreeNode;
+
+		template<class L, size_t, size_t, size_t, size_t, OctreeNodeWrapping>
+		class Octree;
+
 		struct SpatialObject
 		{
+			template<class L>
+			friend struct OctreeNode;
+
+			template<class L, size_t, size_t, size_t, size_t, OctreeNodeWrapping>
+			friend class Octree;
+
 		protected:
 			glm::vec3 center;
 			glm::vec3 halfVolume;
 			float size;
 			AxisAlignedBox aab;
+			/// \brief bounds the tree last recorded, the old bounds once it is translated
+			AxisAlignedBox placedAab;
 
 			ISpatialObjectContainer* container;
+			/// \brief index in the container's list of objects, so it can be removed without searching
+			uint32_t containerSlot;
+			/// \brief left its node and waits in the tree's list of moved objects to be placed again
+			bool moved;
 
 		public:
-			SpatialObject() = default;
+			SpatialObject();
 			SpatialObject(const glm::vec3& center);
 
 			void SetCenter(const glm::vec3& center);
@@ -37,6 +59,7 @@ namespace Esteem
 
 			ISpatialObjectContainer* GetContainer()  const;
 			void SetContainer(ISpatialObjectContainer* container);
+			inline uint32_t GetContainerSlot() const { return containerSlot; }
 
 			void RemoveFromCulling();
 
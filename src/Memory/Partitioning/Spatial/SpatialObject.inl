@@ -6,12 +6,26 @@ namespace Esteem
 {
 	namespace Partitioning
 	{
+		inline SpatialObject::SpatialObject()
+			: center()
+			, halfVolume()
+			, size()
+			, aab()
+			, placedAab()
+			, container(nullptr)
+			, containerSlot(0)
+			, moved(false)
+		{}
+
 		inline SpatialObject::SpatialObject(const glm::vec3& center)
 			: center(center)
 			, halfVolume()
 			, size()
 			, aab()
+			, placedAab()
 			, container(nullptr)
+			, containerSlot(0)
+			, moved(false)
 		{}
 
 		inline void SpatialObject::SetCenter(const glm::vec3& center)
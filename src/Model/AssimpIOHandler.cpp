@@ -1,21 +1,34 @@
 #include "AssimpIOHandler.h"
 
+#include <algorithm>
+
 #include "./AssimpIOStream.h"
 #include "Utils/Data.h"
 #include "Utils/File.h"
 
 namespace Esteem
 {
-	AssimpIOHandler::AssimpIOHandler()
+	AssimpIOHandler::AssimpIOHandler(std::vector<std::string>* accessedFiles)
+		: accessedFiles(accessedFiles)
 	{ }
 
+	void AssimpIOHandler::RecordAccess(const char* pFile) const
+	{
+		// missing files count as well, one showing up later changes the import
+		if (accessedFiles && std::find(accessedFiles->begin(), accessedFiles->end(), pFile) == accessedFiles->end())
+			accessedFiles->emplace_back(pFile);
+	}
+
 	bool AssimpIOHandler::Exists(const char* pFile) const
 	{
+		RecordAccess(pFile);
 		return Data::AssetExists(pFile);
 	}
 
 	Assimp::IOStream* AssimpIOHandler::Open(const char* pFile, const char* pMode)
 	{
+		RecordAccess(pFile);
+
 		File file = File::Open(pFile);
 		if (file.GetSize())
 			return new AssimpIOStream(std::move(file));
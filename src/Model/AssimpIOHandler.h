@@ -1,13 +1,21 @@
 #pragma once
 
+#include <string>
+#include <vector>
 #include <assimp/IOSystem.hpp>
 
 namespace Esteem
 {
 	class AssimpIOHandler : public Assimp::IOSystem
 	{
+	private:
+		std::vector<std::string>* accessedFiles;
+
+		void RecordAccess(const char* pFile) const;
+
 	public:
-		AssimpIOHandler();
+		/// \param accessedFiles	optional, receives every file Assimp looked for or opened once
+		AssimpIOHandler(std::vector<std::string>* accessedFiles = nullptr);
 
 		bool Exists(const char* pFile) const override;
 
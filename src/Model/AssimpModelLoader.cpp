@@ -26,7 +26,12 @@ namespace Esteem
 
 	}
 
-	void AssimpModelLoader::LoadModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings)
+	bool AssimpModelLoader::LoadModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings)
+	{
+		return ImportModel(path, model, modelTexturesFolder, settings, nullptr);
+	}
+
+	bool AssimpModelLoader::ImportModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings, ImportRecord* record)
 	{
 		aiPostProcessSteps processSteps = (aiPostProcessSteps)0;
 		if (settings & Model::ModelGenerateSettings::GENERATE_NORMALS)
@@ -38,7 +43,7 @@ namespace Esteem
 		}
 
 		Assimp::Importer importer;
-		importer.SetIOHandler(new AssimpIOHandler());
+		importer.SetIOHandler(new AssimpIOHandler(record ? &record->dependencies : nullptr));
 		const aiScene* scene = importer.ReadFile(path.data(),
 			processSteps
 
@@ -65,9 +70,15 @@ namespace Esteem
 		);
 
 		if (scene == nullptr)
+		{
 			Debug::LogError("AssimpModelLoader: Could not load ", path, " error code: ", importer.GetErrorString());
+			return false;
+		}
 		else if (scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+		{
 			Debug::LogError("AssimpModelLoader: The file wasn't successfully opened or doesn't contain anything useful: ", path);
+			return false;
+		}
 		else
 		{
 			std::vector<Model::BoneData>& boneData = model.boneData;
@@ -127,7 +138,7 @@ namespace Esteem
 			model.boneUpperEnd = model.boneData.cbegin() + boneUpperCount;
 			model.boneMatrices.resize(boneData.size());
 
-			ParseMesh(*scene, model, modelTexturesFolder);
+			ParseMesh(*scene, model, modelTexturesFolder, record);
 			//LoadBoneMatricesRecursive(model, boneMatrices, &(*bonesData)[0], boneMatrices[0]);
 
 			cgc::strong_ptr<AnimationCollection> collection = ParseAnimationCollection(*scene, model, path);
@@ -141,6 +152,8 @@ namespace Esteem
 			model.volume = (model.volume - model.center) * 0.5f;
 			model.center += model.volume;
 		}
+
+		return true;
 	}
 
 	cgc::strong_ptr<AnimationCollection> AssimpModelLoader::LoadAnimations(std::string_view path)
@@ -149,7 +162,7 @@ namespace Esteem
 		return cgc::strong_ptr<AnimationCollection>();
 	}
 
-	void AssimpModelLoader::ParseMesh(const aiScene& scene, Model& model, std::string_view modelTexturesFolder)
+	void AssimpModelLoader::ParseMesh(const aiScene& scene, Model& model, std::string_view modelTexturesFolder, ImportRecord* record)
 	{
 		for (uint i = 0; i < scene.mNumMeshes; ++i)
 		{
@@ -244,6 +257,9 @@ namespace Esteem
 			materialPath += '/';
 			materialPath.append(aiMaterialName.data, aiMaterialName.length);
 
+			if (record)
+				record->dependencies.push_back(materialPath + ".mat");
+
 			if (auto ptr = RenderingFactory::Instance()->GetMaterial(materialPath))
 			{
 				materials.emplace_back(ptr);
@@ -287,6 +303,9 @@ namespace Esteem
 						file.substr(json.GetErrorOffset(), 20), (json.GetErrorOffset() + 19 < file.size() ? "..." : ""), "\n^");
 				}
 
+				if (record)
+					record->generatedMaterials.emplace_back(materialPath, std::move(file));
+
 				materials.emplace_back(RenderingFactory::Instance()->CreateMaterial(materialPath, json, {}));
 			}
 
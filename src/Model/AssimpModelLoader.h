@@ -1,5 +1,9 @@
 #pragma once
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "./IModelLoader.h"
 #include "./ModelFactory.h"
 #include <assimp/Importer.hpp>
@@ -10,10 +14,20 @@ namespace Esteem
 {
 	class AssimpModelLoader : public IModelLoader
 	{
+	public:
+		/// \brief what an import read and made up besides the model itself, tells the derived data cache when it's stale
+		struct ImportRecord
+		{
+			/// \brief every file Assimp looked at and every .mat that was looked for
+			std::vector<std::string> dependencies;
+			/// \brief path and JSON of the materials that were made up because there was no .mat
+			std::vector<std::pair<std::string, std::string>> generatedMaterials;
+		};
+
 	private:
 		//Assimp::Importer importer;
 
-		static void ParseMesh(const aiScene& scene, Model& model, std::string_view modelTexturesFolder);
+		static void ParseMesh(const aiScene& scene, Model& model, std::string_view modelTexturesFolder, ImportRecord* record);
 
 		static void ParseBonesRecursive(Model& model, const aiNode& node, const aiScene& scene, const glm::mat4& parentMatrix);
 		static void ParseChildBone(Model& model, const aiNode& node, const aiScene& scene, int parentIndex, const glm::mat4& parentMatrix);
@@ -27,7 +41,9 @@ namespace Esteem
 		AssimpModelLoader();
 		//~AssimpModelLoader();
 		
-		virtual void LoadModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings);
+		virtual bool LoadModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings);
+		/// \brief LoadModel() that also fills in what the import depended on
+		bool ImportModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings, ImportRecord* record);
 		virtual cgc::strong_ptr<AnimationCollection> LoadAnimations(std::string_view path);
 		
 		/// \brief used by the Data class to enable factory search, put in own logic in here
@@ -12,7 +12,8 @@ namespace Esteem
 	public:
 		virtual ~IModelLoader() = 0;
 
-		virtual void LoadModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings) = 0;
+		/// \return false when the model couldn't be loaded, so the next loader can be tried
+		virtual bool LoadModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings) = 0;
 		virtual cgc::strong_ptr<AnimationCollection> LoadAnimations(std::string_view path) = 0;
 
 		/// \brief used by the Data class to enable factory search, put in own logic in here
@@ -58,6 +58,19 @@ namespace Esteem
 			{}
 		};
 
+		/// \brief precomputed collision shape of a mesh, e.g.: a cooked convex hull
+		struct PhysicsShape
+		{
+			enum Type : uint8
+			{
+				CONVEX_HULL = 0
+			};
+
+			Type type;
+			uint16 meshIndex;
+			std::vector<glm::vec3> points;
+		};
+
 	private:
 		std::string path;
 
@@ -76,6 +89,8 @@ namespace Esteem
 		std::vector<BoneData> boneData;
 		std::vector<BoneData>::const_iterator boneUpperEnd;
 		std::vector<glm::mat4> boneMatrices;
+		/// \brief only filled by loaders that store them (.mdl), empty otherwise
+		std::vector<PhysicsShape> physicsShapes;
 
 		Model(const std::string& path, const std::vector<cgc::strong_ptr<Mesh<ModelVertexDataA>>>& meshes, const std::vector<cgc::strong_ptr<Material>>& materials,
 			const std::vector<BoneData>& boneData, const cgc::strong_ptr<AnimationCollection>& animationCollection = cgc::strong_ptr<AnimationCollection>());
@@ -1,13 +1,57 @@
 #include "./ModelFactory.h"
 
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
 #include "General/Command.h"
+#include "Utils/CookedAssets.h"
 #include "Utils/Data.h"
 #include "Utils/Debug.h"
 
 namespace Esteem
 {
+	namespace
+	{
+		template<typename T>
+		void AppendValue(std::string& data, T value)
+		{
+			data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		}
+
+		void AppendString(std::string& data, std::string_view string)
+		{
+			AppendValue(data, uint32_t(string.size()));
+			data += string;
+		}
+
+		template<typename T>
+		bool ReadValue(std::string_view& data, T& value)
+		{
+			if (data.size() < sizeof(value))
+				return false;
+
+			std::memcpy(&value, data.data(), sizeof(value));
+			data.remove_prefix(sizeof(value));
+			return true;
+		}
+
+		bool ReadString(std::string_view& data, std::string_view& string)
+		{
+			uint32_t length;
+			if (!ReadValue(data, length) || data.size() < length)
+				return false;
+
+			string = data.substr(0, length);
+			data.remove_prefix(length);
+			return true;
+		}
+	}
+
 	ModelFactory::ModelFactory()
 	{
+		// first match wins, the native format is preferred over importing and also loads the cooked models
+		modelLoaders.push_back(new NativeModelLoader());
 		modelLoaders.push_back(new AssimpModelLoader());
 	}
 
@@ -35,21 +79,7 @@ namespace Esteem
 			for (auto it = models.begin(); it != models.end(); ++it)
 			{
 				Model& model = *it->second;
-
-				uint dotPosition = model.GetPath().find_last_of('.');
-				std::string extension = model.GetPath().substr(dotPosition + 1);
-
-				uint i = 0;
-				for (; i < modelLoaders.size(); ++i)
-				{
-					if (modelLoaders[i]->EqualsSearch(extension))
-					{
-						modelLoaders[i]->LoadModel(model.GetPath(), model, model.importMaterialsDirectory, model.importSettings);
-						break;
-					}
-				}
-
-				if (i == modelLoaders.size())
+				if (!LoadModelData(model.GetPath(), model, model.importMaterialsDirectory, model.importSettings))
 					Debug::LogError("ModelFactory: No suitable model loader found for " + model.GetPath());
 			}
 
@@ -68,27 +98,125 @@ namespace Esteem
 		if (foundModel != models.end())
 			return foundModel->second;
 
-		std::string_view extension = path.substr(path.rfind('.') + 1);
-
 		cgc::strong_ptr<Model> model = models.emplace(std::string(path), filePath, settings, modelTexturesFolder);
+		if (LoadModelData(filePath, *model, modelTexturesFolder, settings))
+			return model;
+
+		Debug::LogError("ModelFactory: No suitable model loader found for ", path);
+
+		return nullptr;
+	}
+
+	bool ModelFactory::LoadModelData(std::string_view filePath, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings)
+	{
+		std::string_view extension = filePath.substr(filePath.rfind('.') + 1);
+
+		// cooked by EsteemCook, only the native loader (the first one) reads those
+		if (extension != "mdl")
+		{
+			std::string cookedPath = CookedAssets::GetModelPath(filePath);
+			if (Data::AssetExists(cookedPath) && modelLoaders[0]->LoadModel(cookedPath, model, modelTexturesFolder, settings))
+				return true;
+		}
+
+		// everything else is imported once, later runs load the native model the derived data cache kept
+		if (extension != "mdl" && modelLoaders[1]->EqualsSearch(extension))
+			return ImportModelData(filePath, model, modelTexturesFolder, settings);
+
 		for (auto* modelLoader : modelLoaders)
 		{
-			if (modelLoader->EqualsSearch(extension))
+			if (modelLoader->EqualsSearch(extension)
+				&& modelLoader->LoadModel(filePath, model, modelTexturesFolder, settings))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool ModelFactory::ImportModelData(std::string_view filePath, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings)
+	{
+		// merges with a prefetch of the same model and goes before any other queued read
+		AssetHandle sourceRead = Data::ReadAssetAsync(filePath, AssetPriority::CRITICAL);
+		const std::string& source = sourceRead.Wait();
+		if (source.empty())
+		{
+			Debug::LogError("ModelFactory: could not read ", filePath);
+			return false;
+		}
+
+		// the extension picks Assimp's importer, the folder and settings end up in the materials and vertices
+		DerivedDataCache::Key key = DerivedDataCache::KeyBuilder("model", 1)
+			.AddBytes(NativeModel::Version, sizeof(NativeModel::Version))
+			.AddString(filePath.substr(filePath.rfind('.') + 1))
+			.AddString(modelTexturesFolder)
+			.AddValue(uint64_t(settings))
+			.AddString(source)
+			.GetKey();
+
+		AssimpModelLoader* importer = static_cast<AssimpModelLoader*>(modelLoaders[1]);
+		bool imported = false;
+
+		std::string cached;
+		bool built = Data::GetDerivedDataCache().GetOrBuild(key, cached, [&](std::string& data, std::vector<std::string>& dependencies)
+		{
+			AssimpModelLoader::ImportRecord record;
+			imported = importer->ImportModel(filePath, model, modelTexturesFolder, settings, &record);
+			if (!imported)
+				return false;
+
+			std::stringstream stream;
+			if (!NativeModelLoader::SaveModel(stream, model))
+				return false;
+
+			// the made up materials go first, they have to exist before the native loader resolves them by path
+			AppendValue(data, uint32_t(record.generatedMaterials.size()));
+			for (auto& material : record.generatedMaterials)
 			{
-				modelLoader->LoadModel(filePath, *model, modelTexturesFolder, settings);
-				return model;
+				AppendString(data, material.first);
+				AppendString(data, material.second);
 			}
-		}
 
-		Debug::LogError("ModelFactory: No suitable model loader found for ", path);
+			data += stream.str();
 
-		return nullptr;
+			// the source itself is part of the key already
+			record.dependencies.erase(std::remove(record.dependencies.begin(), record.dependencies.end(), filePath), record.dependencies.end());
+			dependencies = std::move(record.dependencies);
+			return true;
+		});
+
+		// Assimp filled in the model just now, even when it couldn't be cached
+		if (imported)
+			return true;
+		else if (!built)
+			return false;
+
+		std::string_view contents(cached);
+		uint32_t materialCount;
+		if (!ReadValue(contents, materialCount))
+			return false;
+
+		for (uint32_t i = 0; i < materialCount; ++i)
+		{
+			std::string_view path, json;
+			if (!ReadString(contents, path) || !ReadString(contents, json))
+				return false;
+
+			if (!RenderingFactory::Instance()->GetMaterial(path))
+			{
+				rapidjson::Document document;
+				document.Parse(json.data(), json.size());
+				RenderingFactory::Instance()->CreateMaterial(path, document, {});
+			}
+		}
+
+		return NativeModelLoader::LoadModelFromMemory(filePath, contents, model);
 	}
 
 	cgc::strong_ptr<AnimationCollection> ModelFactory::LoadAnimations(std::string_view path) const
 	{
 		std::string filePath = (RESOURCES_PATH + MODELS_PATH).append(path);
 
+		std::lock_guard<std::mutex> guard(animationCollectionsLock);
 		auto foundModel = animationCollections.find(filePath);
 		if (foundModel != animationCollections.end())
 			return foundModel->second;
@@ -98,12 +226,14 @@ namespace Esteem
 
 	void ModelFactory::Register(const cgc::strong_ptr<AnimationCollection>& collection)
 	{
+		std::lock_guard<std::mutex> guard(animationCollectionsLock);
 		if (animationCollections.find(collection->GetPath()) == animationCollections.end())
 			animationCollections[collection->GetPath()] = collection;
 	}
 
 	void ModelFactory::UnRegister(const cgc::strong_ptr<const AnimationCollection>&collection)
 	{
+		std::lock_guard<std::mutex> guard(animationCollectionsLock);
 		auto found = animationCollections.find(collection->GetPath());
 		if (found != animationCollections.end())
 			animationCollections.erase(found);
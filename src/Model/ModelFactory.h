@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <vector>
 #include <string>
 #include <cppu/cgc/ref/unordered_map.h>
@@ -11,6 +12,7 @@
 #include "./Model.h"
 #include "./IModelLoader.h"
 
+#include "./NativeModelLoader.h"
 #include "./AssimpModelLoader.h"
 
 namespace Esteem
@@ -20,11 +22,18 @@ namespace Esteem
 	private:
 		cgc::ref::unordered_map<std::string, Model> models;
 		std::unordered_map<std::string, cgc::strong_ptr<AnimationCollection>> animationCollections;
+		/// \brief models may be imported from several threads, e.g.: by EsteemCook
+		mutable std::mutex animationCollectionsLock;
 		std::vector<std::vector<Mesh<ModelVertexDataA>>*> meshArray;
 
 
 		std::vector<IModelLoader*> modelLoaders;
 
+		/// \brief load with the first loader that succeeds, prefers the cooked .mdl when there is one
+		bool LoadModelData(std::string_view filePath, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings);
+		/// \brief import with Assimp through the derived data cache, a hit loads the native model it stored instead
+		bool ImportModelData(std::string_view filePath, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings);
+
 	public:
 		ModelFactory();
 		~ModelFactory();
@@ -1,14 +1,16 @@
 #include "NativeModelLoader.h"
 
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 
 #include "Utils/Data.h"
 #include "Utils/Debug.h"
-#include "Utils/StringParser.h"
-#include "Math/Math.h"
+#include "Utils/MappedFile.h"
 
 #include "Rendering/Objects/AnimationCollection.h"
 #include "Rendering/Objects/AnimationSequence.h"
@@ -16,197 +18,511 @@
 
 namespace Esteem
 {
-	NativeModelLoader::NativeModelLoader()
+	namespace
 	{
-		//Command::RegisterListener("reload", DELEGATE(&AssimpModelLoader::Command, this));		
-	}
+		using namespace NativeModel;
 
-	void NativeModelLoader::LoadModel(const std::string& path, Model& model, const std::string& modelTexturesFolder, Model::ModelGenerateSettings settings)
-	{
-		if (Data::AssetExists(path))
+		typedef AnimationKey<glm::vec3> PositionKey;
+		typedef AnimationKey<glm::quat> RotationKey;
+
+		/// \brief record size per section, files written with other sizes are rejected
+		constexpr uint32_t SectionStrides[SECTION_COUNT] =
+		{
+			sizeof(MeshEntry),
+			sizeof(ModelVertexDataA),
+			sizeof(uint),
+			sizeof(Model::BoneData),
+			sizeof(MaterialEntry),
+			sizeof(AnimationEntry),
+			sizeof(ChannelEntry),
+			sizeof(PositionKey),
+			sizeof(RotationKey),
+			sizeof(PhysicsShapeEntry),
+			sizeof(glm::vec3),
+			sizeof(char),
+		};
+
+		/// \brief backing memory for files that could not be mapped, keeps the Alignment the format relies on
+		struct alignas(Alignment) Block
 		{
-			std::size_t size;
-			cgc::strong_ptr<std::istream> data = Esteem::Data::StreamAsset(path, size);
-			if (data)
+			uint8_t bytes[Alignment];
+		};
+
+		/// \brief collects the sections in memory, so the header can be written with all offsets up front
+		class SectionWriter
+		{
+		private:
+			std::array<std::string, SECTION_COUNT> sections;
+
+		public:
+			template<typename T>
+			uint32_t Append(Section section, const T* items, std::size_t count)
+			{
+				std::string& bytes = sections[section];
+				uint32_t first = uint32_t(bytes.size() / sizeof(T));
+				if (count > 0)
+					bytes.append(reinterpret_cast<const char*>(items), count * sizeof(T));
+
+				return first;
+			}
+
+			template<typename T>
+			inline uint32_t Append(Section section, const T& item)
 			{
-				::details::zipfilebuffer zipFileBuffer(data, size);				
-				
-				// header data
-				uint8 version[4] = { 0, 0, 0, 0 };
+				return Append(section, &item, 1);
+			}
 
-				if (data->gcount() != size)
+			StringRef AppendString(std::string_view string)
+			{
+				return StringRef{ Append(STRINGS, string.data(), string.size()), uint32_t(string.size()) };
+			}
+
+			void Write(std::ostream& stream, Header& header) const
+			{
+				uint32_t offset = sizeof(Header);
+				for (uint32_t i = 0; i < SECTION_COUNT; ++i)
 				{
-					// get header info
-					char name[6];
-					zipFileBuffer.sgetn(name, 6);
-					if (strncmp(name, "Esteem", 6) == 0)
-					{
-						zipFileBuffer.sgetn(reinterpret_cast<char*>(version), 4);
-						if (version[0] == 0 && version[1] == 1 && version[3] == 0)
-							LoadModel_0_1_0_0(zipFileBuffer, model, modelTexturesFolder, settings);
-						else
-							Debug::LogError("Cant load ", path, ", unsupported version");
-					}
-					else
-						Debug::LogError("Cant load ", path, ", unsupported model file");
+					SectionEntry& entry = header.sections[i];
+					entry.offset = offset;
+					entry.count = uint32_t(sections[i].size() / SectionStrides[i]);
+					entry.stride = SectionStrides[i];
+
+					offset += uint32_t(sections[i].size());
+					offset = (offset + Alignment - 1) & ~(Alignment - 1);
+				}
+
+				header.fileSize = offset;
+				stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+				const char padding[Alignment] = {};
+				for (uint32_t i = 0; i < SECTION_COUNT; ++i)
+				{
+					stream.write(sections[i].data(), sections[i].size());
+
+					std::size_t end = header.sections[i].offset + sections[i].size();
+					stream.write(padding, (Alignment - end % Alignment) % Alignment);
 				}
-				else
-					Debug::LogError("Cant load ", path, ", Invalid model file");
 			}
+		};
+	}
+
+	template<typename T>
+	const T* NativeModelLoader::File::GetSection(Section section, uint32_t& count) const
+	{
+		const SectionEntry& entry = GetHeader().sections[section];
+		count = entry.count;
 
+		return count > 0 ? reinterpret_cast<const T*>(data + entry.offset) : nullptr;
+	}
+
+	std::string_view NativeModelLoader::File::GetString(const StringRef& string) const
+	{
+		uint32_t count;
+		const char* strings = GetSection<char>(STRINGS, count);
+
+		return string.offset + uint64_t(string.length) <= count ? std::string_view(strings + string.offset, string.length) : std::string_view();
+	}
+
+	NativeModelLoader::NativeModelLoader()
+	{
+		//Command::RegisterListener("reload", DELEGATE(&NativeModelLoader::Command, this));
+	}
+
+	bool NativeModelLoader::OpenFile(std::string_view path, File& file)
+	{
+		// loose files are mapped, the mapping lives as long as any mesh that points into it
+		if (Data::FileExists(path))
+		{
+			std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+			if (mapping->Open(std::string(path)))
+			{
+				file.data = mapping->GetData();
+				file.size = mapping->GetSize();
+				file.storage = std::move(mapping);
+				return true;
+			}
 		}
-		else
-			Debug::LogError("Could not load .mdl ", path);
+
+		// stored pak entries are used in place when they happen to be aligned, the pak outlives the model
+		mm::array_view view = Data::MapAsset(path);
+		if (!view.empty() && reinterpret_cast<std::uintptr_t>(view.data()) % Alignment == 0)
+		{
+			file.data = static_cast<const uint8_t*>(view.data());
+			file.size = view.size();
+			file.storage = nullptr;
+			return true;
+		}
+
+		// compressed or unaligned, one copy into aligned memory
+		std::string contents = Data::ReadAsset(path);
+		if (contents.empty())
+			return false;
+
+		CopyToFile(contents, file);
+		return true;
 	}
 
-	bool NativeModelLoader::LoadModel_0_1_0_0(std::streambuf& streamBuffer, Model& model, const std::string& modelTexturesFolder, Model::ModelGenerateSettings settings)
+	void NativeModelLoader::CopyToFile(std::string_view contents, File& file)
 	{
-		// meta data
-		streamBuffer.sgetn(reinterpret_cast<char*>(&model.volume), sizeof(glm::vec3));
-		streamBuffer.sgetn(reinterpret_cast<char*>(&model.center), sizeof(glm::vec3));
+		std::shared_ptr<std::vector<Block>> blocks = std::make_shared<std::vector<Block>>((contents.size() + Alignment - 1) / Alignment);
+		std::memcpy(blocks->data(), contents.data(), contents.size());
 
-		uint16 meshCount;
-		streamBuffer.sgetn(reinterpret_cast<char*>(&meshCount), sizeof(uint16));
+		file.data = reinterpret_cast<const uint8_t*>(blocks->data());
+		file.size = contents.size();
+		file.storage = std::move(blocks);
+	}
 
-		for (uint16 m = 0; m < meshCount; ++m)
+	bool NativeModelLoader::ValidateFile(std::string_view path, const File& file)
+	{
+		if (file.size < sizeof(Header) || std::memcmp(file.data, Magic, sizeof(Magic)) != 0)
 		{
-			// vertices
-			uint16 vertexType;
-			uint16 vertexCount;
-			std::vector<ModelVertexDataA> vertices;
+			Debug::LogError("NativeModelLoader: ", path, " is not a .mdl file");
+			return false;
+		}
 
-			streamBuffer.sgetn(reinterpret_cast<char*>(&vertexType), sizeof(uint16));
-			streamBuffer.sgetn(reinterpret_cast<char*>(&vertexCount), sizeof(uint16));
+		const Header& header = file.GetHeader();
+		if (header.version[0] != Version[0] || header.version[1] != Version[1])
+		{
+			Debug::LogError("NativeModelLoader: can't load ", path, ", unsupported version ", std::to_string(header.version[0]), ".", std::to_string(header.version[1]));
+			return false;
+		}
 
-			assert(vertexType == 1);
-			vertices.resize(vertexCount);
-			streamBuffer.sgetn(reinterpret_cast<char*>(vertices.data()), sizeof(ModelVertexDataA) * vertexCount);
+		if (header.fileSize > file.size || header.sectionCount != SECTION_COUNT)
+		{
+			Debug::LogError("NativeModelLoader: can't load ", path, ", the file is truncated or corrupt");
+			return false;
+		}
 
-			// indices
-			uint16 indexType;
-			uint16 indexCount;
-			std::vector<uint> indices;
+		for (uint32_t i = 0; i < SECTION_COUNT; ++i)
+		{
+			const SectionEntry& entry = header.sections[i];
+			if (entry.stride != SectionStrides[i])
+			{
+				Debug::LogError("NativeModelLoader: can't load ", path, ", it was written with a different memory layout, cook it again");
+				return false;
+			}
 
-			streamBuffer.sgetn(reinterpret_cast<char*>(&indexType), sizeof(uint16));
-			streamBuffer.sgetn(reinterpret_cast<char*>(&indexCount), sizeof(uint16));
+			if (entry.offset % Alignment != 0 || entry.offset + uint64_t(entry.count) * entry.stride > header.fileSize)
+			{
+				Debug::LogError("NativeModelLoader: can't load ", path, ", section ", std::to_string(i), " is out of bounds");
+				return false;
+			}
+		}
 
-			assert(indexType == sizeof(uint));
-			indices.resize(indexCount);
-			streamBuffer.sgetn(reinterpret_cast<char*>(indices.data()), sizeof(uint) * indexCount);
+		return true;
+	}
 
-			// Add mesh
-			cgc::strong_ptr<Mesh<ModelVertexDataA, uint>> mesh = cgc::construct_new<Mesh<ModelVertexDataA, uint>>(vertices, indices, false);
-			model.meshes.push_back(mesh);
+	bool NativeModelLoader::LoadModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings)
+	{
+		File file;
+		if (!OpenFile(path, file))
+		{
+			Debug::LogError("NativeModelLoader: could not load ", path);
+			return false;
 		}
 
-		// bones
-		uint16 boneType;
-		uint16 boneCount;
-		std::vector<Model::BoneData>& bones = model.boneData;
+		return LoadFile(path, file, model);
+	}
 
-		streamBuffer.sgetn(reinterpret_cast<char*>(&boneType), sizeof(uint16));
-		streamBuffer.sgetn(reinterpret_cast<char*>(&boneCount), sizeof(uint16));
+	bool NativeModelLoader::LoadModelFromMemory(std::string_view path, std::string_view contents, Model& model)
+	{
+		if (contents.empty())
+			return false;
+
+		File file;
+		CopyToFile(contents, file);
+		return LoadFile(path, file, model);
+	}
 
-		assert(boneType == 1);
-		bones.resize(boneCount);
-		streamBuffer.sgetn(reinterpret_cast<char*>(bones.data()), sizeof(Model::BoneData) * boneCount);
+	bool NativeModelLoader::LoadFile(std::string_view path, const File& file, Model& model)
+	{
+		if (!ValidateFile(path, file))
+			return false;
 
-		// materials
-		uint16 materialCount;
-		std::vector<cgc::strong_ptr<Material>>& materials = model.materials;
+		// models are reloaded in place
+		model.meshes.clear();
+		model.materials.clear();
+		model.physicsShapes.clear();
 
-		streamBuffer.sgetn(reinterpret_cast<char*>(&materialCount), sizeof(uint16));
+		const Header& header = file.GetHeader();
+		model.center = header.center;
+		model.volume = header.volume;
 
-		materials.resize(materialCount);
-		for (uint16 i = 0; i < materialCount; ++i)
+		if (!ParseBones(path, file, model) || !ParseMeshes(path, file, model))
+			return false;
+
+		ParsePhysicsShapes(file, model);
+
+		cgc::strong_ptr<AnimationCollection> collection = ParseAnimationCollection(path, file);
+		if (collection)
 		{
-			uint16 materialSize;
-			streamBuffer.sgetn(reinterpret_cast<char*>(&materialSize), sizeof(uint16));
+			Data::GetModelFactory().Register(collection);
+			model.SetBoneAnimationCollection(collection);
+		}
 
-			assert(false, "look at this");
+		return true;
+	}
 
-			/*cgc::strong_ptr<Material> material = materials[i];
-			material.resize(modelTexturesFolder.size() + materialSize + 1);
+	bool NativeModelLoader::ParseMeshes(std::string_view path, const File& file, Model& model)
+	{
+		uint32_t meshCount, vertexCount, indexCount, materialCount;
+		const MeshEntry* meshes = file.GetSection<MeshEntry>(MESHES, meshCount);
+		const ModelVertexDataA* vertices = file.GetSection<ModelVertexDataA>(VERTICES, vertexCount);
+		const uint* indices = file.GetSection<uint>(INDICES, indexCount);
+		const MaterialEntry* materialEntries = file.GetSection<MaterialEntry>(MATERIALS, materialCount);
+
+		std::vector<cgc::strong_ptr<Material>> materials(materialCount);
+		for (uint32_t i = 0; i < materialCount; ++i)
+			materials[i] = ResolveMaterial(file.GetString(materialEntries[i].path));
+
+		model.meshes.reserve(meshCount);
+		for (uint32_t i = 0; i < meshCount; ++i)
+		{
+			const MeshEntry& entry = meshes[i];
+			if (entry.firstVertex + uint64_t(entry.vertexCount) > vertexCount || entry.firstIndex + uint64_t(entry.indexCount) > indexCount)
+			{
+				Debug::LogError("NativeModelLoader: can't load ", path, ", mesh ", std::to_string(i), " is out of bounds");
+				model.meshes.clear();
+				model.materials.clear();
+				return false;
+			}
 
-			memcpy(material.data(), modelTexturesFolder.data(), modelTexturesFolder.size());
-			material[modelTexturesFolder.size()] = '/';
-			streamBuffer.sgetn(reinterpret_cast<char*>(material.data() + modelTexturesFolder.size()), materialSize);*/
+			// no copies, the mesh data points into the file
+			cgc::strong_ptr<Mesh<ModelVertexDataA>::MappedData> meshData = cgc::construct_new<Mesh<ModelVertexDataA>::MappedData>(file.storage,
+				vertices + entry.firstVertex, entry.vertexCount, indices + entry.firstIndex, entry.indexCount);
+			model.meshes.emplace_back(cgc::construct_new<Mesh<ModelVertexDataA>>(meshData, true));
+
+			// materials are per mesh, like the other loaders
+			if (entry.materialIndex < materialCount)
+				model.materials.emplace_back(materials[entry.materialIndex]);
 		}
 
 		return true;
 	}
 
-	bool NativeModelLoader::SaveModel(std::ostream& streamBuffer, Model& model, const std::string& modelTexturesFolder)
+	bool NativeModelLoader::ParseBones(std::string_view path, const File& file, Model& model)
 	{
-		// meta data
-		streamBuffer.write(reinterpret_cast<const char*>(&model.volume), sizeof(glm::vec3));
-		streamBuffer.write(reinterpret_cast<const char*>(&model.center), sizeof(glm::vec3));
+		uint32_t boneCount;
+		const Model::BoneData* bones = file.GetSection<Model::BoneData>(BONES, boneCount);
 
-		auto& meshes = model.meshes;
-		for (uint16 m = 0; m < meshes.size(); ++m)
+		uint32_t boneUpperCount = file.GetHeader().boneUpperCount;
+		if (boneUpperCount > boneCount)
 		{
-			auto& mesh = *meshes[m].ptr();
+			Debug::LogError("NativeModelLoader: can't load ", path, ", invalid bone count");
+			return false;
+		}
 
-			// vertices
-			mm::array_view vertexInfo = mesh.GetMeshData()->GetVertexMemInfo();
-			uint16 vertexSize = vertexInfo.type_size();
-			uint16 vertexCount = vertexInfo.size();
+		model.boneData.assign(bones, bones + boneCount);
+		model.boneUpperEnd = model.boneData.cbegin() + boneUpperCount;
+		model.boneMatrices.resize(boneCount);
 
-			streamBuffer.write(reinterpret_cast<const char*>(&vertexSize), sizeof(glm::uint16));
-			streamBuffer.write(reinterpret_cast<const char*>(&vertexCount), sizeof(glm::uint16));
-			streamBuffer.write(reinterpret_cast<const char*>(vertexInfo.data()), std::streamsize(vertexCount) * vertexSize);
+		model.boneMap.clear();
+		for (uint32_t i = 0; i < boneCount; ++i)
+			model.boneMap[bones[i].hash] = uint16(i);
+
+		return true;
+	}
 
-			// indices
-			mm::array_view indexInfo = mesh.GetMeshData()->GetIndexMemInfo();
-			uint16 indexSize = indexInfo.type_size();
-			uint16 indexCount = indexInfo.size();
+	void NativeModelLoader::ParsePhysicsShapes(const File& file, Model& model)
+	{
+		uint32_t shapeCount, pointCount;
+		const PhysicsShapeEntry* shapes = file.GetSection<PhysicsShapeEntry>(PHYSICS_SHAPES, shapeCount);
+		const glm::vec3* points = file.GetSection<glm::vec3>(PHYSICS_POINTS, pointCount);
 
-			streamBuffer.write(reinterpret_cast<const char*>(&indexSize), sizeof(uint16));
-			streamBuffer.write(reinterpret_cast<const char*>(&indexCount), sizeof(uint16));
-			streamBuffer.write(reinterpret_cast<const char*>(indexInfo.data()), std::streamsize(indexCount) * indexSize);
+		model.physicsShapes.reserve(shapeCount);
+		for (uint32_t i = 0; i < shapeCount; ++i)
+		{
+			const PhysicsShapeEntry& entry = shapes[i];
+			if (entry.firstPoint + uint64_t(entry.pointCount) > pointCount)
+				continue;
+
+			Model::PhysicsShape& shape = model.physicsShapes.emplace_back();
+			shape.type = Model::PhysicsShape::Type(entry.type);
+			shape.meshIndex = entry.meshIndex;
+			shape.points.assign(points + entry.firstPoint, points + entry.firstPoint + entry.pointCount);
 		}
+	}
 
-		// bones
-		std::vector<Model::BoneData>& bones = model.boneData;
-		uint16 boneType = 1;
-		uint16 boneCount = bones.size();
+	cgc::strong_ptr<AnimationCollection> NativeModelLoader::ParseAnimationCollection(std::string_view path, const File& file)
+	{
+		uint32_t animationCount, channelCount, positionKeyCount, rotationKeyCount;
+		const AnimationEntry* animations = file.GetSection<AnimationEntry>(ANIMATIONS, animationCount);
+		const ChannelEntry* channels = file.GetSection<ChannelEntry>(CHANNELS, channelCount);
+		const PositionKey* positionKeys = file.GetSection<PositionKey>(POSITION_KEYS, positionKeyCount);
+		const RotationKey* rotationKeys = file.GetSection<RotationKey>(ROTATION_KEYS, rotationKeyCount);
 
-		streamBuffer.write(reinterpret_cast<const char*>(&boneType), sizeof(uint16));
-		streamBuffer.write(reinterpret_cast<const char*>(&boneCount), sizeof(uint16));
-		streamBuffer.write(reinterpret_cast<const char*>(bones.data()), std::streamsize(sizeof(Model::BoneData)) * boneCount);
+		if (animationCount == 0)
+			return nullptr;
 
-		assert(false, "look at this");
+		std::unordered_map<hash_t, cgc::strong_ptr<const AnimationSequence>> animationSequences;
+		for (uint32_t a = 0; a < animationCount; ++a)
+		{
+			const AnimationEntry& animation = animations[a];
+			if (animation.firstChannel + uint64_t(animation.channelCount) > channelCount)
+			{
+				Debug::LogError("NativeModelLoader: skipping animation ", std::to_string(a), " of ", path, ", it is out of bounds");
+				continue;
+			}
 
-		// materials
-		/*std::vector<std::string>& materials = model.materials;
-		uint16 materialCount = materials.size();
+			cgc::strong_ptr<AnimationSequence> sequence = cgc::construct_new<AnimationSequence>(std::string(file.GetString(animation.name)), animation.duration, animation.tps);
+			std::unordered_map<hash_t, AnimationChannelData>& channelData = const_cast<std::unordered_map<hash_t, AnimationChannelData>&>(sequence->GetChannelData());
+			channelData.reserve(animation.channelCount);
 
-		streamBuffer.write(reinterpret_cast<char*>(&materialCount), sizeof(uint16));
+			for (uint32_t c = animation.firstChannel; c < animation.firstChannel + animation.channelCount; ++c)
+			{
+				const ChannelEntry& entry = channels[c];
+				if (entry.firstPositionKey + uint64_t(entry.positionKeyCount) > positionKeyCount
+					|| entry.firstRotationKey + uint64_t(entry.rotationKeyCount) > rotationKeyCount)
+					continue;
+
+				AnimationChannelData& channel = channelData[entry.hash];
+				channel.boneName = file.GetString(entry.boneName);
+				channel.boneIndex = entry.boneIndex;
+				channel.positionKeys.assign(positionKeys + entry.firstPositionKey, positionKeys + entry.firstPositionKey + entry.positionKeyCount);
+				channel.rotationKeys.assign(rotationKeys + entry.firstRotationKey, rotationKeys + entry.firstRotationKey + entry.rotationKeyCount);
+			}
 
-		std::string modelTexturesFolderSlash = modelTexturesFolder + '/';
-		for (uint16 i = 0; i < materialCount; ++i)
-		{
-			std::string material = materials[i];
-			size_t pos = material.find(modelTexturesFolderSlash);
-			if (pos != std::string::npos)
-				material.erase(pos, modelTexturesFolderSlash.size());
+			animationSequences.emplace(animation.hash, std::move(sequence));
+		}
 
-			uint16 materialSize = material.size();
-			streamBuffer.write(reinterpret_cast<char*>(&materialSize), sizeof(uint16));
-			streamBuffer.write(reinterpret_cast<char*>(material.data()), materialSize);
-		}*/
+		return cgc::construct_new<AnimationCollection>(path, std::move(animationSequences));
+	}
 
-		return true;
+	cgc::strong_ptr<Material> NativeModelLoader::ResolveMaterial(std::string_view materialPath)
+	{
+		if (auto ptr = RenderingFactory::Instance()->GetMaterial(materialPath))
+			return ptr;
+
+		// the file LoadMaterial() reads, EsteemCook writes generated materials there as well
+		std::string path(materialPath);
+		if (Data::AssetExists(RESOURCES_PATH + MATERIALS_PATH + path + ".mat"))
+			return RenderingFactory::Instance()->LoadMaterial(path);
+
+		// texture references aren't part of the format, cook a .mat next to the model to keep them
+		Debug::LogWarning("NativeModelLoader: no .mat found for ", materialPath, ", using an untextured material");
+
+		std::stringstream fileContents;
+		fileContents << "{\n\t\"name\": \"" << path << "\",\n\t\"shader\": \"diffuse\",\n\t\"alpha\": false,\n\t\"textures\": {\t}\n}";
+
+		rapidjson::Document json;
+		json.Parse(fileContents.str().c_str());
+
+		return RenderingFactory::Instance()->CreateMaterial(path, json, {});
 	}
 
-	cgc::strong_ptr<AnimationCollection> NativeModelLoader::LoadAnimations(const std::string& path)
+	cgc::strong_ptr<AnimationCollection> NativeModelLoader::LoadAnimations(std::string_view path)
 	{
-		return cgc::strong_ptr<AnimationCollection>();
+		File file;
+		if (!OpenFile(path, file) || !ValidateFile(path, file))
+			return cgc::strong_ptr<AnimationCollection>();
+
+		return ParseAnimationCollection(path, file);
+	}
+
+	bool NativeModelLoader::SaveModel(std::ostream& stream, const Model& model)
+	{
+		SectionWriter writer;
+
+		Header header = {};
+		std::memcpy(header.magic, Magic, sizeof(Magic));
+		std::memcpy(header.version, Version, sizeof(Version));
+		header.sectionCount = SECTION_COUNT;
+		header.boneUpperCount = uint32_t(model.boneUpperEnd - model.boneData.cbegin());
+		header.center = model.center;
+		header.volume = model.volume;
+
+		// materials, shared ones are stored once
+		std::unordered_map<std::string, uint32_t> materialIndices;
+
+		for (std::size_t m = 0; m < model.meshes.size(); ++m)
+		{
+			const cgc::strong_ptr<IMeshData>& meshData = model.meshes[m]->GetMeshData();
+			if (!meshData)
+			{
+				Debug::LogError("NativeModelLoader: can't save ", model.GetPath(), ", mesh ", std::to_string(m), " is not available on the CPU");
+				return false;
+			}
+
+			mm::array_view vertexInfo = meshData->GetVertexMemInfo();
+			mm::array_view indexInfo = meshData->GetIndexMemInfo();
+
+			MeshEntry entry = {};
+			entry.firstVertex = writer.Append(VERTICES, static_cast<const ModelVertexDataA*>(vertexInfo.data()), vertexInfo.size());
+			entry.vertexCount = uint32_t(vertexInfo.size());
+			entry.firstIndex = writer.Append(INDICES, static_cast<const uint*>(indexInfo.data()), indexInfo.size());
+			entry.indexCount = uint32_t(indexInfo.size());
+			entry.materialIndex = NoMaterial;
+
+			if (m < model.materials.size() && model.materials[m])
+			{
+				const std::string& materialPath = model.materials[m]->GetPath();
+
+				auto found = materialIndices.find(materialPath);
+				if (found == materialIndices.end())
+					found = materialIndices.emplace(materialPath, writer.Append(MATERIALS, MaterialEntry{ writer.AppendString(materialPath) })).first;
+
+				entry.materialIndex = found->second;
+			}
+
+			writer.Append(MESHES, entry);
+		}
+
+		// bones
+		writer.Append(BONES, model.boneData.data(), model.boneData.size());
+
+		// animations
+		if (const cgc::strong_ptr<const AnimationCollection>& collection = model.GetBoneAnimationCollection())
+		{
+			uint32_t channelCount = 0;
+			for (auto& sequence : collection->GetAnimationSequences())
+			{
+				AnimationEntry animation = {};
+				animation.hash = sequence.first;
+				animation.name = writer.AppendString(sequence.second->GetName());
+				animation.duration = sequence.second->GetDuration();
+				animation.tps = sequence.second->GetTPS();
+				animation.firstChannel = channelCount;
+
+				for (auto& channelData : sequence.second->GetChannelData())
+				{
+					const AnimationChannelData& channel = channelData.second;
+
+					ChannelEntry entry = {};
+					entry.hash = channelData.first;
+					entry.boneName = writer.AppendString(channel.boneName);
+					entry.boneIndex = channel.boneIndex;
+					entry.firstPositionKey = writer.Append(POSITION_KEYS, channel.positionKeys.data(), channel.positionKeys.size());
+					entry.positionKeyCount = uint32_t(channel.positionKeys.size());
+					entry.firstRotationKey = writer.Append(ROTATION_KEYS, channel.rotationKeys.data(), channel.rotationKeys.size());
+					entry.rotationKeyCount = uint32_t(channel.rotationKeys.size());
+
+					writer.Append(CHANNELS, entry);
+					++channelCount;
+				}
+
+				animation.channelCount = channelCount - animation.firstChannel;
+				writer.Append(ANIMATIONS, animation);
+			}
+		}
+
+		// physics shapes
+		for (const Model::PhysicsShape& shape : model.physicsShapes)
+		{
+			PhysicsShapeEntry entry = {};
+			entry.type = shape.type;
+			entry.meshIndex = shape.meshIndex;
+			entry.firstPoint = writer.Append(PHYSICS_POINTS, shape.points.data(), shape.points.size());
+			entry.pointCount = uint32_t(shape.points.size());
+
+			writer.Append(PHYSICS_SHAPES, entry);
+		}
+
+		writer.Write(stream, header);
+		return bool(stream);
 	}
 
 	bool NativeModelLoader::EqualsSearch(std::string_view search)
 	{
-		// all supported file formats
-		return std::string("mdl").find(search) != std::string::npos;
+		return search == "mdl";
 	}
 }
@@ -1,30 +1,170 @@
 #pragma once
 
-#include "./IModelLoader.h"
-
-#include "Utils/details/zipfilebuffer.h"
+#include "stdafx.h"
 
-#include "./ModelFactory.h"
+#include <cstdint>
+#include <memory>
+#include <ostream>
 
+#include "./IModelLoader.h"
 
 namespace Esteem
 {
+	/// \brief layout of the .mdl format, all integers are little endian
+	/// A fixed header is followed by sections, every section starts on an Alignment boundary and is an array of
+	/// fixed size records. Vertices, indices, bones and animation keys are stored exactly as they are in memory,
+	/// so a loaded (memory mapped) file is used in place: meshes point straight into it.
+	namespace NativeModel
+	{
+		constexpr char Magic[6] = { 'E', 's', 't', 'e', 'e', 'm' };
+		constexpr uint8 Version[4] = { 0, 2, 0, 0 };
+		constexpr uint32_t Alignment = 16;
+		constexpr uint32_t NoMaterial = ~uint32_t(0);
+
+		enum Section : uint32_t
+		{
+			MESHES = 0,			// MeshEntry
+			VERTICES,			// ModelVertexDataA
+			INDICES,			// uint
+			BONES,				// Model::BoneData
+			MATERIALS,			// MaterialEntry
+			ANIMATIONS,			// AnimationEntry
+			CHANNELS,			// ChannelEntry
+			POSITION_KEYS,		// AnimationKey<glm::vec3>
+			ROTATION_KEYS,		// AnimationKey<glm::quat>
+			PHYSICS_SHAPES,		// PhysicsShapeEntry
+			PHYSICS_POINTS,		// glm::vec3
+			STRINGS,			// char
+
+			SECTION_COUNT
+		};
+
+		struct SectionEntry
+		{
+			/// \brief from the start of the file
+			uint32_t offset;
+			uint32_t count;
+			/// \brief record size, must match the loader's sizeof() or the file is rejected
+			uint32_t stride;
+			uint32_t reserved;
+		};
+
+		struct alignas(16) Header
+		{
+			char magic[6];
+			uint8 version[4];
+			uint16 sectionCount;
+			uint32_t fileSize;
+			uint32_t boneUpperCount;
+			glm::vec3 center;
+			glm::vec3 volume;
+			uint32_t reserved[5];
+
+			SectionEntry sections[SECTION_COUNT];
+		};
+
+		struct StringRef
+		{
+			/// \brief into the STRINGS section
+			uint32_t offset;
+			uint32_t length;
+		};
+
+		struct MeshEntry
+		{
+			uint32_t firstVertex;
+			uint32_t vertexCount;
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			/// \brief into the MATERIALS section or NoMaterial
+			uint32_t materialIndex;
+			uint32_t reserved[3];
+		};
+
+		struct MaterialEntry
+		{
+			StringRef path;
+		};
+
+		struct AnimationEntry
+		{
+			uint64_t hash;
+			StringRef name;
+			float duration;
+			float tps;
+			uint32_t firstChannel;
+			uint32_t channelCount;
+		};
+
+		struct ChannelEntry
+		{
+			uint64_t hash;
+			StringRef boneName;
+			uint32_t boneIndex;
+			uint32_t firstPositionKey;
+			uint32_t positionKeyCount;
+			uint32_t firstRotationKey;
+			uint32_t rotationKeyCount;
+			uint32_t reserved;
+		};
+
+		struct PhysicsShapeEntry
+		{
+			uint8 type;
+			uint8 reserved;
+			uint16 meshIndex;
+			uint32_t firstPoint;
+			uint32_t pointCount;
+		};
+
+		static_assert(sizeof(Header) % Alignment == 0, "the first section must start aligned");
+	}
+
 	class NativeModelLoader : public IModelLoader
 	{
 	private:
+		/// \brief a loaded .mdl file, storage keeps data alive
+		struct File
+		{
+			std::shared_ptr<const void> storage;
+			const uint8_t* data;
+			std::size_t size;
+
+			inline const NativeModel::Header& GetHeader() const { return *reinterpret_cast<const NativeModel::Header*>(data); }
 
-		bool LoadModel_0_1_0_0(std::streambuf& streamBuffer, Model& model, const std::string& modelTexturesFolder, Model::ModelGenerateSettings settings);
+			/// \return nullptr and count 0 for an empty section
+			template<typename T>
+			const T* GetSection(NativeModel::Section section, uint32_t& count) const;
+			std::string_view GetString(const NativeModel::StringRef& string) const;
+		};
+
+		static bool OpenFile(std::string_view path, File& file);
+		/// \brief one copy into aligned memory that the file owns
+		static void CopyToFile(std::string_view contents, File& file);
+		static bool ValidateFile(std::string_view path, const File& file);
+		static bool LoadFile(std::string_view path, const File& file, Model& model);
+
+		static bool ParseMeshes(std::string_view path, const File& file, Model& model);
+		static bool ParseBones(std::string_view path, const File& file, Model& model);
+		static void ParsePhysicsShapes(const File& file, Model& model);
+		static cgc::strong_ptr<AnimationCollection> ParseAnimationCollection(std::string_view path, const File& file);
+
+		static cgc::strong_ptr<Material> ResolveMaterial(std::string_view materialPath);
 
 	public:
 		NativeModelLoader();
 		//~NativeModelLoader();
-		
-		virtual void LoadModel(const std::string& path, Model& model, const std::string& modelTexturesFolder, Model::ModelGenerateSettings settings);
-		virtual cgc::strong_ptr<AnimationCollection> LoadAnimations(const std::string& path);
 
-		bool SaveModel(std::ostream& streamBuffer, Model& model, const std::string& modelTexturesFolder);
-		
+		virtual bool LoadModel(std::string_view path, Model& model, std::string_view modelTexturesFolder, Model::ModelGenerateSettings settings);
+		virtual cgc::strong_ptr<AnimationCollection> LoadAnimations(std::string_view path);
+
+		/// \brief load a .mdl that's already in memory, e.g.: from the derived data cache, path names it in errors and animations
+		static bool LoadModelFromMemory(std::string_view path, std::string_view contents, Model& model);
+
+		/// \brief write the model as .mdl, materials are stored by path and resolved again when loading
+		static bool SaveModel(std::ostream& stream, const Model& model);
+
 		/// \brief used by the Data class to enable factory search, put in own logic in here
 		virtual bool EqualsSearch(std::string_view search);
 	};
-}
\ No newline at end of file
+}
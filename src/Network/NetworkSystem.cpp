@@ -6,6 +6,8 @@
 #include "Utils/Debug.h"
 #include "Utils/Hash.h"
 #include "General/Command.h"
+#include "Memory/FrameArena.h"
+#include "Utils/Profiler.h"
 
 #include "World/Constituents/Network.h"
 
@@ -143,13 +145,20 @@ namespace Esteem
 
 	void NetworkSystem::Update()
 	{
+		Profiler::SetThreadName("Network");
+
 		while (running)
 		{
+			// this thread's loop is its own frame
+			FrameArena::Get().Reset();
+
 			{
 				std::unique_lock<std::mutex> lk(threadLock);
 				threadWait.wait(lk);
 			}
 
+			ESTEEM_PROFILE("NetworkSystem::Update");
+
 			if (hosting)
 			{
 				if (udpBroadcast)
@@ -176,8 +185,7 @@ namespace Esteem
 
 								// receive data
 								const std::size_t packetSize = 1024;
-								std::vector<char> data;
-								data.resize(packetSize);
+								frame_vector<char> data(packetSize, &FrameArena::Get());
 
 								std::size_t actualPacketSize;
 								if (actualPacketSize = socket.Receive(&data[0], packetSize))
@@ -239,8 +247,7 @@ namespace Esteem
 
 				// receive data
 				const uint16 packetSize = 1024;
-				std::vector<char> data;
-				data.resize(packetSize);
+				frame_vector<char> data(packetSize, &FrameArena::Get());
 
 				size_t size;
 				//uint16 port;
@@ -4,6 +4,7 @@
 //#include "World/WorldController.h"
 //#include "World/World.h"
 #include "Utils/Time.h"
+#include "Utils/Profiler.h"
 #include "General/Settings.h"
 #include "PhysicsSettings.h"
 
@@ -54,6 +55,8 @@ namespace Esteem
 		constexpr btScalar FIXED_STEPS_PER_SECOND = btScalar(30.);
 		constexpr btScalar FIXED_TIME_STEP = btScalar(1.) / FIXED_STEPS_PER_SECOND;
 
+		ESTEEM_PROFILE("Physics::UpdateWorld");
+
 		running = true;
 		int simulationSteps = bulletWorld->stepSimulation(deltaTime, 7, FIXED_TIME_STEP);
 
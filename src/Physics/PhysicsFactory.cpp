@@ -1,5 +1,6 @@
 #include "PhysicsFactory.h"
 
+#include <cstring>
 #include <cppu/cgc/constructor.h>
 
 #include <BulletCollision/CollisionShapes/btSphereShape.h>
@@ -13,11 +14,13 @@
 #include <BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
 #include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
 #include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
 #include <BulletCollision/CollisionShapes/btConvexHullShape.h>
 #include <BulletCollision/CollisionShapes/btShapeHull.h>
 
 #include <BulletSoftBody/btSoftRigidDynamicsWorld.h>
 
+#include "Utils/Data.h"
 #include "Utils/Debug.h"
 
 #include "PhysicsSettings.h"
@@ -190,9 +193,18 @@ namespace Esteem
 
 			meshInterface->addIndexedMesh(part, PHY_INTEGER);
 
-			bool useQuantizedAabbCompression = true;
-
-			triangleMeshShape = new btBvhTriangleMeshShape(meshInterface, useQuantizedAabbCompression);
+			// everything the tree is built from, the same mesh gives the same BVH on every run
+			DerivedDataCache::Key key = DerivedDataCache::KeyBuilder("bvh", 1)
+				.AddValue(BT_BULLET_VERSION)
+				.AddValue(sizeof(btScalar))
+				.AddValue(uint64_t(part.m_vertexStride))
+				.AddValue(uint64_t(part.m_numVertices))
+				.AddValue(uint64_t(part.m_numTriangles))
+				.AddBytes(vertexData.data(), vertexData.size() * vertexData.type_size())
+				.AddBytes(indexData.data(), indexData.size() * indexData.type_size())
+				.GetKey();
+
+			triangleMeshShape = CreateBvhTriangleMeshShape(meshInterface, key);
 			cachedMeshShapes.emplace(std::piecewise_construct, std::forward_as_tuple(mesh.ptr()), std::forward_as_tuple(triangleMeshShape));
 		}
 		
@@ -201,6 +213,49 @@ namespace Esteem
 			: static_cast<btConcaveShape*>(new btScaledBvhTriangleMeshShape(triangleMeshShape, reinterpret_cast<const btVector3&>(scale)));
 	}
 
+	btBvhTriangleMeshShape* PhysicsFactory::CreateBvhTriangleMeshShape(btStridingMeshInterface* meshInterface, const DerivedDataCache::Key& key)
+	{
+		bool useQuantizedAabbCompression = true;
+		btBvhTriangleMeshShape* triangleMeshShape = nullptr;
+
+		std::string serialized;
+		Data::GetDerivedDataCache().GetOrBuild(key, serialized, [&](std::string& data, std::vector<std::string>& dependencies)
+		{
+			triangleMeshShape = new btBvhTriangleMeshShape(meshInterface, useQuantizedAabbCompression);
+
+			// serialized in place, that wants 16 byte aligned memory
+			btOptimizedBvh* bvh = triangleMeshShape->getOptimizedBvh();
+			unsigned size = bvh->calculateSerializeBufferSize();
+			void* buffer = btAlignedAlloc(size, 16);
+
+			bool written = bvh->serializeInPlace(buffer, size, false);
+			if (written)
+				data.assign(static_cast<const char*>(buffer), size);
+
+			btAlignedFree(buffer);
+			return written;
+		});
+
+		// built just now
+		if (triangleMeshShape)
+			return triangleMeshShape;
+
+		// the BVH is used in place, its memory lives as long as the shape: which like all cached shapes is never freed
+		void* buffer = btAlignedAlloc(unsigned(serialized.size()), 16);
+		std::memcpy(buffer, serialized.data(), serialized.size());
+
+		btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(buffer, unsigned(serialized.size()), false);
+		if (!bvh)
+		{
+			btAlignedFree(buffer);
+			return new btBvhTriangleMeshShape(meshInterface, useQuantizedAabbCompression);
+		}
+
+		triangleMeshShape = new btBvhTriangleMeshShape(meshInterface, useQuantizedAabbCompression, false);
+		triangleMeshShape->setOptimizedBvh(bvh);
+		return triangleMeshShape;
+	}
+
 	btConvexShape* PhysicsFactory::GetOrCreateConvexHullShape(const cgc::strong_ptr<AbstractMesh>& mesh, const glm::vec3& scale)
 	{
 
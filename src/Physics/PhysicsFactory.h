@@ -8,12 +8,14 @@
 #include <glm/gtc/quaternion.hpp>
 
 #include "General/Delegate.h"
+#include "Utils/DerivedDataCache.h"
 
 class btSoftRigidDynamicsWorld;
 class btDiscreteDynamicsWorld;
 
 class btHeightfieldTerrainShape;
 class btBvhTriangleMeshShape;
+class btStridingMeshInterface;
 class btCollisionShape;
 class btConcaveShape;
 class btConvexShape;
@@ -99,6 +101,8 @@ namespace Esteem
 		static void SetShape(btRigidBody& rigidBody, const btCollisionShape* shape, float mass);
 
 		static btConcaveShape* GetOrCreateConcaveMeshShape(const cgc::strong_ptr<AbstractMesh>& mesh, const glm::vec3& scale);
+		/// \brief builds the BVH or loads it from the derived data cache
+		static btBvhTriangleMeshShape* CreateBvhTriangleMeshShape(btStridingMeshInterface* meshInterface, const DerivedDataCache::Key& key);
 		static btConvexShape* GetOrCreateConvexHullShape(const cgc::strong_ptr<AbstractMesh>& mesh, const glm::vec3& scale);
 	};
 }
\ No newline at end of file
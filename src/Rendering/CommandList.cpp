@@ -0,0 +1,42 @@
+#include "CommandList.h"
+
+namespace Esteem
+{
+	void CommandList::Clear()
+	{
+		batches.clear();
+		draws.clear();
+		drawData.clear();
+	}
+
+	void CommandList::Draw(const State& state, const DrawIndirect& draw, const DrawData& data)
+	{
+		if (!batches.empty() && batches.back().state == state)
+			++batches.back().count;
+		else
+			batches.push_back({ state, uint32_t(draws.size()), 1 });
+
+		draws.push_back(draw);
+		drawData.push_back(data);
+	}
+
+	void CommandList::Append(const CommandList& other)
+	{
+		if (other.batches.empty())
+			return;
+
+		uint32_t offset = uint32_t(draws.size());
+		auto batch = other.batches.begin();
+		if (!batches.empty() && batches.back().state == batch->state)
+		{
+			batches.back().count += batch->count;
+			++batch;
+		}
+
+		for (; batch != other.batches.end(); ++batch)
+			batches.push_back({ batch->state, batch->first + offset, batch->count });
+
+		draws.insert(draws.end(), other.draws.begin(), other.draws.end());
+		drawData.insert(drawData.end(), other.drawData.begin(), other.drawData.end());
+	}
+}
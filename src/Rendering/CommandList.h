@@ -0,0 +1,104 @@
+#pragma once
+
+#include "stdafx.h"
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Esteem
+{
+	class JobSystem;
+
+	/// \brief Draws recorded without a graphics context, so job threads can fill them while the render thread draws
+	/// Consecutive draws with the same state are merged into one batch, which a renderer can submit as one multi draw.
+	/// The ids and enums in the state belong to the renderer that replays the list, the list only compares them.
+	class CommandList
+	{
+	public:
+		/// \brief amount of draws Record() gives to one job
+		static constexpr std::size_t SliceSize = 256;
+
+		/// \brief layout of an indexed indirect draw, draws without indices read the first four fields
+		/// baseVertex is 0 for those, which is their baseInstance
+		struct DrawIndirect
+		{
+			uint32_t count;
+			uint32_t instanceCount;
+			uint32_t first;
+			int32_t baseVertex;
+			uint32_t baseInstance;
+		};
+
+		/// \brief everything that has to be bound before a draw
+		struct State
+		{
+			uint vertexArray;
+			/// \brief primitive type
+			uint mode;
+			/// \brief type of the indices, 0 for draws without indices
+			uint indexType;
+			/// \brief bone uniform buffer and its binding index, 0 for objects without animations
+			uint boneBuffer;
+			uint boneBinding;
+			/// \brief bound range of the bone buffer, size 0 binds the whole buffer
+			uint boneOffset;
+			uint boneSize;
+
+			inline bool operator==(const State& other) const
+			{
+				return vertexArray == other.vertexArray && mode == other.mode && indexType == other.indexType
+					&& boneBuffer == other.boneBuffer && boneBinding == other.boneBinding
+					&& boneOffset == other.boneOffset && boneSize == other.boneSize;
+			}
+
+			inline bool operator!=(const State& other) const { return !(*this == other); }
+		};
+
+		/// \brief per draw data, read by the shaders from a buffer that is filled once per frame
+		struct DrawData
+		{
+			glm::mat4 modelMatrix;
+		};
+
+		struct Batch
+		{
+			State state;
+			/// \brief first draw of the batch in GetDraws() and GetDrawData()
+			uint32_t first;
+			uint32_t count;
+		};
+
+	private:
+		std::vector<Batch> batches;
+		std::vector<DrawIndirect> draws;
+		std::vector<DrawData> drawData;
+
+		/// \brief lists the jobs of Record() write to, kept to reuse their memory
+		std::vector<CommandList> slices;
+
+	public:
+		CommandList() = default;
+		CommandList(CommandList&&) = default;
+		CommandList& operator=(CommandList&&) = default;
+
+		// disable copy
+		CommandList(const CommandList&) = delete;
+		void operator=(const CommandList&) = delete;
+
+		void Clear();
+		void Draw(const State& state, const DrawIndirect& draw, const DrawData& data);
+		/// \brief add the draws of the other list after ours, its first batch is merged with our last when their state is equal
+		void Append(const CommandList& other);
+
+		/// \brief replace the draws with the ones record(CommandList& list, std::size_t index) adds for [0, count)
+		/// With a job system the range is recorded in slices of SliceSize on its threads, the slices are appended in order
+		/// so the list is the same as when it's recorded on one thread.
+		template<typename F>
+		void Record(std::size_t count, const F& record, JobSystem* jobSystem = nullptr);
+
+		inline const std::vector<Batch>& GetBatches() const { return batches; }
+		inline const std::vector<DrawIndirect>& GetDraws() const { return draws; }
+		inline const std::vector<DrawData>& GetDrawData() const { return drawData; }
+	};
+}
+
+#include "./CommandList.inl"
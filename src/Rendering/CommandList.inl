@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CommandList.h"
+
+#include <algorithm>
+#include "Threading/JobSystem.h"
+
+namespace Esteem
+{
+	template<typename F>
+	void CommandList::Record(std::size_t count, const F& record, JobSystem* jobSystem)
+	{
+		Clear();
+
+		if (jobSystem == nullptr || count <= SliceSize)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				record(*this, i);
+
+			return;
+		}
+
+		std::size_t sliceCount = (count + SliceSize - 1) / SliceSize;
+		if (slices.size() < sliceCount)
+			slices.resize(sliceCount);
+
+		// the slices are fixed ranges, which thread records them doesn't change the result
+		jobSystem->WaitFor(jobSystem->ParallelFor(sliceCount, 1, [this, count, &record](std::size_t from, std::size_t to)
+		{
+			for (std::size_t slice = from; slice < to; ++slice)
+			{
+				CommandList& list = slices[slice];
+				list.Clear();
+
+				std::size_t end = std::min(count, (slice + 1) * SliceSize);
+				for (std::size_t i = slice * SliceSize; i < end; ++i)
+					record(list, i);
+			}
+		}));
+
+		for (std::size_t slice = 0; slice < sliceCount; ++slice)
+			Append(slices[slice]);
+	}
+}
@@ -0,0 +1,91 @@
+#include "FrameRingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Esteem
+{
+	FrameRingBuffer::FrameRingBuffer()
+		: memory(nullptr)
+		, fence(nullptr)
+		, regionSize(0)
+		, regionCount(1)
+		, alignment(1)
+		, region(0)
+		, offset(0)
+		, frame(0)
+		, inFrame(false)
+		, failedCount(0)
+	{ }
+
+	void FrameRingBuffer::Initialize(void* memory, uint32_t size, uint regionCount, uint32_t alignment, Fence* fence)
+	{
+		this->memory = static_cast<uint8*>(memory);
+		this->fence = fence;
+		this->regionCount = std::max(regionCount, 1u);
+		this->alignment = std::max(alignment, 1u);
+
+		// every region starts aligned
+		regionSize = size / this->regionCount / this->alignment * this->alignment;
+
+		// the first frame begins at region 0
+		region = this->regionCount - 1;
+		offset = 0;
+		frame = 0;
+		inFrame = false;
+		failedCount = 0;
+	}
+
+	void FrameRingBuffer::BeginFrame()
+	{
+		if (inFrame)
+			EndFrame();
+
+		region = (region + 1) % regionCount;
+		if (fence != nullptr)
+			fence->Wait(region);
+
+		offset = 0;
+		failedCount = 0;
+		++frame;
+		inFrame = true;
+	}
+
+	void FrameRingBuffer::EndFrame()
+	{
+		if (!inFrame)
+			return;
+
+		if (fence != nullptr)
+			fence->Signal(region);
+
+		inFrame = false;
+	}
+
+	FrameRingBuffer::Allocation FrameRingBuffer::Allocate(uint32_t size)
+	{
+		if (!inFrame || memory == nullptr)
+			return { 0, 0, nullptr };
+
+		uint32_t aligned = (offset + alignment - 1) / alignment * alignment;
+		if (aligned > regionSize || size > regionSize - aligned)
+		{
+			++failedCount;
+			return { 0, 0, nullptr };
+		}
+
+		offset = aligned + size;
+
+		uint32_t bufferOffset = region * regionSize + aligned;
+		return { bufferOffset, size, memory + bufferOffset };
+	}
+
+	FrameRingBuffer::Allocation FrameRingBuffer::Write(const void* data, uint32_t size)
+	{
+		Allocation allocation = Allocate(size);
+		if (allocation.IsValid())
+			std::memcpy(allocation.data, data, size);
+
+		return allocation;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "stdafx.h"
+
+namespace Esteem
+{
+	/// \brief Hands out per frame sub-allocations of one large mapped buffer
+	/// The buffer is split in regions, one per frame in flight. A region is written during one frame and reused
+	/// regionCount frames later, after waiting on the fence that was signaled at the end of the frame that wrote it.
+	/// Allocations are made on the render thread between BeginFrame() and EndFrame().
+	class FrameRingBuffer
+	{
+	public:
+		/// \brief GPU synchronization of the regions, implemented by the renderer with its own sync objects
+		class Fence
+		{
+		public:
+			virtual ~Fence() = default;
+
+			/// \brief called after the last command of the frame that wrote to the region
+			virtual void Signal(uint region) = 0;
+			/// \brief block until the commands signaled for the region are done, returns at once when nothing was signaled
+			virtual void Wait(uint region) = 0;
+		};
+
+		struct Allocation
+		{
+			/// \brief from the start of the buffer
+			uint32_t offset;
+			uint32_t size;
+			/// \brief mapped memory to write to, nullptr when there was no room
+			void* data;
+
+			inline bool IsValid() const { return data != nullptr; }
+		};
+
+	private:
+		uint8* memory;
+		Fence* fence;
+
+		uint32_t regionSize;
+		uint regionCount;
+		uint32_t alignment;
+
+		uint region;
+		/// \brief from the start of the region
+		uint32_t offset;
+		uint64_t frame;
+		bool inFrame;
+		uint failedCount;
+
+	public:
+		FrameRingBuffer();
+
+		// disable copy
+		FrameRingBuffer(const FrameRingBuffer&) = delete;
+		void operator=(const FrameRingBuffer&) = delete;
+
+		/// \param memory mapped buffer of size bytes, stays owned by the caller
+		/// \param alignment of every allocation's offset, e.g.: the uniform buffer offset alignment
+		void Initialize(void* memory, uint32_t size, uint regionCount, uint32_t alignment, Fence* fence);
+
+		/// \brief move on to the next region, waits when the GPU is still reading it
+		void BeginFrame();
+		void EndFrame();
+
+		/// \return an invalid allocation outside of a frame or when the region is full
+		Allocation Allocate(uint32_t size);
+		/// \brief allocate and copy the data into it
+		Allocation Write(const void* data, uint32_t size);
+
+		inline bool IsInitialized() const { return memory != nullptr; }
+		inline bool IsInFrame() const { return inFrame; }
+		/// \brief amount of frames begun
+		inline uint64_t GetFrame() const { return frame; }
+		inline uint GetRegion() const { return region; }
+		inline uint GetRegionCount() const { return regionCount; }
+		inline uint32_t GetRegionSize() const { return regionSize; }
+		inline uint32_t GetAlignment() const { return alignment; }
+		/// \brief bytes allocated in this frame's region, including alignment padding
+		inline uint32_t GetUsed() const { return offset; }
+		/// \brief allocations of this frame that didn't fit
+		inline uint GetFailedCount() const { return failedCount; }
+	};
+}
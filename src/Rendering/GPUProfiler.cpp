@@ -0,0 +1,151 @@
+#include "GPUProfiler.h"
+
+#include <algorithm>
+
+namespace Esteem
+{
+	GPUProfiler::GPUProfiler()
+		: queries(nullptr)
+		, frames()
+		, current(FrameCount - 1)
+		, inFrame(false)
+		, frameNumber(0)
+		, resolvedFrame(0)
+		, droppedCount(0)
+		, ring(nullptr)
+	{ }
+
+	GPUProfiler::~GPUProfiler()
+	{
+		if (ring != nullptr)
+			Profiler::DestroyRing(*ring);
+
+		if (queries == nullptr)
+			return;
+
+		for (Frame& frame : frames)
+		{
+			for (uint query : frame.queries)
+				queries->Destroy(query);
+		}
+	}
+
+	void GPUProfiler::Initialize(Queries* queries)
+	{
+		this->queries = queries;
+	}
+
+	void GPUProfiler::BeginFrame()
+	{
+		if (queries == nullptr)
+			return;
+
+		if (inFrame)
+			EndFrame();
+
+		// oldest first, so the zones reach the trace in order
+		for (uint i = 1; i <= FrameCount; ++i)
+		{
+			Frame& frame = frames[(current + i) % FrameCount];
+			if (frame.pending && !Resolve(frame))
+				break;
+		}
+
+		current = (current + 1) % FrameCount;
+		Frame& frame = frames[current];
+
+		// reusing the queries is cheaper than waiting for them
+		if (frame.pending)
+		{
+			frame.pending = false;
+			++droppedCount;
+		}
+
+		frame.usedQueries = 0;
+		frame.zones.clear();
+		frame.number = ++frameNumber;
+		frame.clockOffset = Profiler::IsEnabled() ? int64_t(Profiler::Now()) - int64_t(queries->GetTime()) : 0;
+		inFrame = true;
+
+		BeginZone("Frame");
+	}
+
+	void GPUProfiler::EndFrame()
+	{
+		if (!inFrame)
+			return;
+
+		while (!openZones.empty())
+			EndZone();
+
+		frames[current].pending = true;
+		inFrame = false;
+	}
+
+	void GPUProfiler::BeginZone(const char* name)
+	{
+		if (!inFrame)
+			return;
+
+		Frame& frame = frames[current];
+		uint begin = AllocateQuery(frame);
+		queries->Timestamp(frame.queries[begin]);
+
+		openZones.push_back(uint(frame.zones.size()));
+		frame.zones.push_back({ name, uint(openZones.size() - 1), begin, begin });
+	}
+
+	void GPUProfiler::EndZone()
+	{
+		if (!inFrame || openZones.empty())
+			return;
+
+		Frame& frame = frames[current];
+		uint end = AllocateQuery(frame);
+		queries->Timestamp(frame.queries[end]);
+
+		frame.zones[openZones.back()].end = end;
+		openZones.pop_back();
+	}
+
+	uint GPUProfiler::AllocateQuery(Frame& frame)
+	{
+		if (frame.usedQueries == frame.queries.size())
+			frame.queries.push_back(queries->Create());
+
+		return frame.usedQueries++;
+	}
+
+	bool GPUProfiler::Resolve(Frame& frame)
+	{
+		// a later timestamp can't be relied on to mean the earlier ones are done, so check them all
+		for (uint i = 0; i < frame.usedQueries; ++i)
+		{
+			if (!queries->IsAvailable(frame.queries[i]))
+				return false;
+		}
+
+		resolvedZones.clear();
+		for (const PendingZone& zone : frame.zones)
+		{
+			uint64_t begin = uint64_t(int64_t(queries->GetResult(frame.queries[zone.begin])) + frame.clockOffset);
+			uint64_t end = uint64_t(int64_t(queries->GetResult(frame.queries[zone.end])) + frame.clockOffset);
+			resolvedZones.push_back({ zone.name, zone.depth, begin, std::max(begin, end) });
+		}
+
+		frame.pending = false;
+		resolvedFrame = frame.number;
+
+		// only frames that began while capturing are on the CPU timeline
+		if (frame.clockOffset != 0 && Profiler::IsEnabled())
+		{
+			if (ring == nullptr)
+				ring = &Profiler::CreateRing("GPU");
+
+			for (const Zone& zone : resolvedZones)
+				ring->Push(ProfileEvent{ zone.name, zone.begin, zone.end, ring->threadId, zone.depth });
+		}
+
+		return true;
+	}
+}
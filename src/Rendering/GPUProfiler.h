@@ -0,0 +1,152 @@
+#pragma once
+
+#include "stdafx.h"
+#include <vector>
+
+#include "Utils/Profiler.h"
+
+#ifdef ESTEEM_PROFILING
+/// \brief profile the current scope on the CPU and the GPU, name must be a string literal
+#define ESTEEM_GPU_PROFILE(profiler, name) ESTEEM_PROFILE(name); ::Esteem::GPUProfileZone ESTEEM_PROFILE_CONCAT(gpuProfileZone, __LINE__)(profiler, name)
+#else
+#define ESTEEM_GPU_PROFILE(profiler, name) ((void)0)
+#endif
+
+namespace Esteem
+{
+	/// \brief GPU timings of the frames, measured with timestamp queries that are read back frames later
+	/// Every frame uses its own set of queries out of a ring of FrameCount. A frame is resolved once the backend reports
+	/// all of its queries available, so reading the timings never waits for the GPU. When a frame is still not
+	/// available by the time its set is needed again, it's dropped instead.
+	/// While the CPU profiler captures, the zones are added to its trace on a "GPU" timeline.
+	class GPUProfiler
+	{
+	public:
+		/// \brief frames in flight, results are at most FrameCount - 1 frames old
+		static constexpr uint FrameCount = 4;
+
+		/// \brief timestamp queries of the renderer
+		class Queries
+		{
+		public:
+			virtual ~Queries() = default;
+
+			virtual uint Create() = 0;
+			virtual void Destroy(uint query) = 0;
+			/// \brief record the GPU time once the commands issued before are done
+			virtual void Timestamp(uint query) = 0;
+			/// \brief whether the result can be read, without waiting
+			virtual bool IsAvailable(uint query) = 0;
+			/// \brief GPU time in nanoseconds, only read after IsAvailable() returned true
+			virtual uint64_t GetResult(uint query) = 0;
+			/// \brief GPU time in nanoseconds of commands issued now, to line the GPU up with the CPU timeline
+			virtual uint64_t GetTime() = 0;
+		};
+
+		/// \brief a measured zone, the frame itself is the first one with depth 0
+		struct Zone
+		{
+			const char* name;
+			uint depth;
+			/// \brief nanoseconds on the CPU profiler's timeline when it was capturing, on the GPU's clock otherwise
+			uint64_t begin;
+			uint64_t end;
+
+			inline uint64_t GetDuration() const { return end - begin; }
+		};
+
+	private:
+		struct PendingZone
+		{
+			const char* name;
+			uint depth;
+			/// \brief indices in Frame::queries
+			uint begin;
+			uint end;
+		};
+
+		struct Frame
+		{
+			/// \brief grows to the most queries a frame used
+			std::vector<uint> queries;
+			uint usedQueries;
+			std::vector<PendingZone> zones;
+			uint64_t number;
+			/// \brief CPU timeline minus GPU clock, 0 when the CPU profiler wasn't capturing
+			int64_t clockOffset;
+			bool pending;
+		};
+
+		Queries* queries;
+		Frame frames[FrameCount];
+		uint current;
+		bool inFrame;
+		/// \brief zones that are open, as indices in the current frame's zones
+		std::vector<uint> openZones;
+
+		uint64_t frameNumber;
+		uint64_t resolvedFrame;
+		std::vector<Zone> resolvedZones;
+		uint droppedCount;
+
+		/// \brief created once the CPU profiler captures
+		ProfileRing* ring;
+
+		uint AllocateQuery(Frame& frame);
+		/// \return false when not all queries of the frame are available yet
+		bool Resolve(Frame& frame);
+
+	public:
+		GPUProfiler();
+		~GPUProfiler();
+
+		// disable copy
+		GPUProfiler(const GPUProfiler&) = delete;
+		void operator=(const GPUProfiler&) = delete;
+
+		/// \param queries stays owned by the caller and has to outlive the profiler
+		void Initialize(Queries* queries);
+
+		/// \brief resolve the frames that are available and start measuring a new one
+		void BeginFrame();
+		/// \brief closes the zones that are still open
+		void EndFrame();
+
+		/// \brief nested zones have to end before the zone they're in, use ESTEEM_GPU_PROFILE(profiler, "name")
+		void BeginZone(const char* name);
+		void EndZone();
+
+		/// \brief zones of the last resolved frame, empty before the first one
+		inline const std::vector<Zone>& GetZones() const { return resolvedZones; }
+		/// \brief nanoseconds the GPU spent on the last resolved frame
+		inline uint64_t GetFrameTime() const { return resolvedZones.empty() ? 0 : resolvedZones.front().GetDuration(); }
+		/// \brief frames between the current one and the last resolved one
+		inline uint64_t GetLatency() const { return resolvedFrame != 0 ? frameNumber - resolvedFrame : 0; }
+		/// \brief frames that weren't available before their queries were needed again
+		inline uint GetDroppedCount() const { return droppedCount; }
+		inline bool IsInitialized() const { return queries != nullptr; }
+	};
+
+	/// \brief scoped GPU zone, use ESTEEM_GPU_PROFILE(profiler, "name") instead of constructing this directly
+	class GPUProfileZone
+	{
+	private:
+		GPUProfiler& profiler;
+
+	public:
+		inline GPUProfileZone(GPUProfiler& profiler, const char* name)
+			: profiler(profiler)
+		{
+			profiler.BeginZone(name);
+		}
+
+		inline ~GPUProfileZone()
+		{
+			profiler.EndZone();
+		}
+
+		// disable copy
+		GPUProfileZone(const GPUProfileZone&) = delete;
+		void operator=(const GPUProfileZone&) = delete;
+	};
+}
@@ -45,6 +45,7 @@ namespace Esteem
 			: name(name), duration(duration), tps(tps) {}
 
 		const std::unordered_map<hash_t, AnimationChannelData>& GetChannelData() const { return channelData; }
+		inline const std::string& GetName() const { return name; }
 		inline float GetDuration() const { return duration; }
 		inline float GetTPS() const { return tps; }
 	};
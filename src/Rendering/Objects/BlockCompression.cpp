@@ -0,0 +1,891 @@
+#include "./BlockCompression.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ESTEEM_BLOCK_COMPRESSION_SSE
+#include <emmintrin.h>
+#endif
+
+#include "Threading/JobSystem.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		/// \brief block rows per job when encoding in parallel
+		constexpr uint32_t TileRows = 8;
+
+		constexpr uint8 BC7Weights2[4] = { 0, 21, 43, 64 };
+		constexpr uint8 BC7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+		constexpr uint8 BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		constexpr float AllPixels[16] = { 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f };
+
+		/// \brief the pixels of a block per channel, so 4 pixels can be compared at once
+		struct BlockChannels
+		{
+			alignas(16) float values[4][16];
+
+			BlockChannels(const uint8* pixels)
+			{
+				for (uint32_t i = 0; i < 16; ++i)
+				{
+					for (uint32_t c = 0; c < 4; ++c)
+						values[c][i] = pixels[i * 4 + c];
+				}
+			}
+		};
+
+		struct BitWriter
+		{
+			uint8* block;
+			uint32_t position;
+
+			inline void Write(uint32_t value, uint32_t bits)
+			{
+				for (uint32_t b = 0; b < bits; ++b, ++position)
+				{
+					if ((value >> b) & 1)
+						block[position >> 3] |= uint8(1 << (position & 7));
+				}
+			}
+		};
+
+		struct BitReader
+		{
+			const uint8* block;
+			uint32_t position;
+
+			inline uint32_t Read(uint32_t bits)
+			{
+				uint32_t value = 0;
+				for (uint32_t b = 0; b < bits; ++b, ++position)
+					value |= uint32_t((block[position >> 3] >> (position & 7)) & 1) << b;
+
+				return value;
+			}
+		};
+
+		/// \brief closest palette entry of every pixel over the first channelCount channels
+		/// \param weights how much the error of each pixel counts, 0 excludes it
+		/// \return the summed squared error
+		float SelectIndices(const BlockChannels& block, const float (*palette)[4], uint32_t paletteSize, uint32_t channelCount, const float* weights, uint8* indices)
+		{
+#ifdef ESTEEM_BLOCK_COMPRESSION_SSE
+			__m128 total = _mm_setzero_ps();
+			for (uint32_t p = 0; p < 16; p += 4)
+			{
+				__m128 best = _mm_set1_ps(FLT_MAX);
+				__m128i bestIndex = _mm_setzero_si128();
+
+				for (uint32_t i = 0; i < paletteSize; ++i)
+				{
+					__m128 distance = _mm_setzero_ps();
+					for (uint32_t c = 0; c < channelCount; ++c)
+					{
+						__m128 difference = _mm_sub_ps(_mm_load_ps(&block.values[c][p]), _mm_set1_ps(palette[i][c]));
+						distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+					}
+
+					__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+					bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(int(i))), _mm_andnot_si128(closer, bestIndex));
+					best = _mm_min_ps(distance, best);
+				}
+
+				alignas(16) int32_t lanes[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes), bestIndex);
+				for (uint32_t l = 0; l < 4; ++l)
+					indices[p + l] = uint8(lanes[l]);
+
+				total = _mm_add_ps(total, _mm_mul_ps(best, _mm_loadu_ps(weights + p)));
+			}
+
+			alignas(16) float sums[4];
+			_mm_store_ps(sums, total);
+			return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#else
+			float total = 0.f;
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				float best = FLT_MAX;
+				for (uint32_t i = 0; i < paletteSize; ++i)
+				{
+					float distance = 0.f;
+					for (uint32_t c = 0; c < channelCount; ++c)
+					{
+						float difference = block.values[c][p] - palette[i][c];
+						distance += difference * difference;
+					}
+
+					if (distance < best)
+					{
+						best = distance;
+						indices[p] = uint8(i);
+					}
+				}
+
+				total += best * weights[p];
+			}
+
+			return total;
+#endif
+		}
+
+		/// \brief endpoints on the line through the mean along the largest spread of the pixels
+		/// \param inset part of the range to move both endpoints inwards, the outer palette entries are rarely hit exactly
+		void FitEndpoints(const BlockChannels& block, const float* weights, uint32_t channelCount, float inset, float* endpoint0, float* endpoint1)
+		{
+			float mean[4] = {};
+			float total = 0.f;
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				total += weights[p];
+				for (uint32_t c = 0; c < channelCount; ++c)
+					mean[c] += block.values[c][p] * weights[p];
+			}
+
+			if (total == 0.f)
+			{
+				std::fill(endpoint0, endpoint0 + channelCount, 0.f);
+				std::fill(endpoint1, endpoint1 + channelCount, 0.f);
+				return;
+			}
+
+			for (uint32_t c = 0; c < channelCount; ++c)
+				mean[c] /= total;
+
+			float covariance[4][4] = {};
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				for (uint32_t a = 0; a < channelCount; ++a)
+				{
+					for (uint32_t b = 0; b < channelCount; ++b)
+						covariance[a][b] += (block.values[a][p] - mean[a]) * (block.values[b][p] - mean[b]) * weights[p];
+				}
+			}
+
+			// power iteration, starting at the channel with the most variance
+			uint32_t largest = 0;
+			for (uint32_t c = 1; c < channelCount; ++c)
+			{
+				if (covariance[c][c] > covariance[largest][largest])
+					largest = c;
+			}
+
+			float axis[4] = {};
+			std::copy(covariance[largest], covariance[largest] + channelCount, axis);
+			for (uint32_t iteration = 0; iteration < 8; ++iteration)
+			{
+				float next[4] = {};
+				float length = 0.f;
+				for (uint32_t a = 0; a < channelCount; ++a)
+				{
+					for (uint32_t b = 0; b < channelCount; ++b)
+						next[a] += covariance[a][b] * axis[b];
+
+					length += next[a] * next[a];
+				}
+
+				if (length < 1e-12f)
+					break;
+
+				length = 1.f / std::sqrt(length);
+				for (uint32_t c = 0; c < channelCount; ++c)
+					axis[c] = next[c] * length;
+			}
+
+			float minimum = FLT_MAX, maximum = -FLT_MAX;
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				if (weights[p] == 0.f)
+					continue;
+
+				float t = 0.f;
+				for (uint32_t c = 0; c < channelCount; ++c)
+					t += (block.values[c][p] - mean[c]) * axis[c];
+
+				minimum = std::min(minimum, t);
+				maximum = std::max(maximum, t);
+			}
+
+			float shrink = (maximum - minimum) * inset;
+			minimum += shrink;
+			maximum -= shrink;
+
+			for (uint32_t c = 0; c < channelCount; ++c)
+			{
+				endpoint0[c] = std::clamp(mean[c] + axis[c] * minimum, 0.f, 255.f);
+				endpoint1[c] = std::clamp(mean[c] + axis[c] * maximum, 0.f, 255.f);
+			}
+		}
+
+		/// \brief least squares endpoints for the chosen indices
+		/// \param indexWeights position of each palette entry between endpoint 0 (0) and endpoint 1 (1)
+		/// \return false if the indices don't determine two endpoints
+		bool RefineEndpoints(const BlockChannels& block, const float* weights, uint32_t channelCount, const uint8* indices, const float* indexWeights, float* endpoint0, float* endpoint1)
+		{
+			float aa = 0.f, bb = 0.f, ab = 0.f;
+			float ax[4] = {}, bx[4] = {};
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				float b = indexWeights[indices[p]] * weights[p];
+				float a = (1.f - indexWeights[indices[p]]) * weights[p];
+
+				aa += a * a;
+				bb += b * b;
+				ab += a * b;
+				for (uint32_t c = 0; c < channelCount; ++c)
+				{
+					ax[c] += a * block.values[c][p];
+					bx[c] += b * block.values[c][p];
+				}
+			}
+
+			float determinant = aa * bb - ab * ab;
+			if (std::abs(determinant) < 1e-6f)
+				return false;
+
+			determinant = 1.f / determinant;
+			for (uint32_t c = 0; c < channelCount; ++c)
+			{
+				endpoint0[c] = std::clamp((ax[c] * bb - bx[c] * ab) * determinant, 0.f, 255.f);
+				endpoint1[c] = std::clamp((bx[c] * aa - ax[c] * ab) * determinant, 0.f, 255.f);
+			}
+
+			return true;
+		}
+
+		inline uint16 To565(const float* color)
+		{
+			uint32_t r = uint32_t(color[0] * (31.f / 255.f) + .5f);
+			uint32_t g = uint32_t(color[1] * (63.f / 255.f) + .5f);
+			uint32_t b = uint32_t(color[2] * (31.f / 255.f) + .5f);
+			return uint16((r << 11) | (g << 5) | b);
+		}
+
+		inline void From565(uint16 color, uint8* rgb)
+		{
+			uint32_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+			rgb[0] = uint8((r << 3) | (r >> 2));
+			rgb[1] = uint8((g << 2) | (g >> 4));
+			rgb[2] = uint8((b << 3) | (b >> 2));
+		}
+
+		/// \brief the palette as the decoder builds it, 3 colors and transparent black when color0 <= color1
+		/// \return amount of opaque entries
+		uint32_t GetBC1Palette(uint16 color0, uint16 color1, bool fourColors, uint8 (*palette)[4])
+		{
+			From565(color0, palette[0]);
+			From565(color1, palette[1]);
+			palette[0][3] = palette[1][3] = 255;
+
+			fourColors |= color0 > color1;
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				uint32_t a = palette[0][c], b = palette[1][c];
+				palette[2][c] = uint8(fourColors ? (2 * a + b + 1) / 3 : (a + b + 1) / 2);
+				palette[3][c] = uint8(fourColors ? (a + 2 * b + 1) / 3 : 0);
+			}
+
+			palette[2][3] = 255;
+			palette[3][3] = fourColors ? 255 : 0;
+			return fourColors ? 4 : 3;
+		}
+
+		/// \param fourColors BC3 always decodes 4 colors, BC1 uses 3 and transparent for blocks with alpha
+		void EncodeColorBlock(const uint8* pixels, uint8* block, bool fourColors)
+		{
+			BlockChannels channels(pixels);
+
+			float weights[16];
+			uint32_t opaquePixels = 0;
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				bool opaque = fourColors || pixels[p * 4 + 3] >= 128;
+				weights[p] = opaque ? 1.f : 0.f;
+				opaquePixels += opaque;
+			}
+
+			bool transparent = opaquePixels != 16;
+
+			uint16 bestColor0 = 0, bestColor1 = 0;
+			uint8 bestIndices[16];
+			std::fill(bestIndices, bestIndices + 16, uint8(3));
+			float bestError = FLT_MAX;
+
+			float endpoint0[4], endpoint1[4];
+			FitEndpoints(channels, weights, 3, 1.f / 16.f, endpoint0, endpoint1);
+
+			// the fitted endpoints, then twice refined on the indices they gave; fully transparent blocks keep the defaults
+			for (uint32_t iteration = 0; iteration < 3 && opaquePixels != 0; ++iteration)
+			{
+				uint16 color0 = To565(endpoint0), color1 = To565(endpoint1);
+
+				// the order of the colors selects the mode
+				if (transparent ? color0 > color1 : color0 < color1)
+				{
+					std::swap(color0, color1);
+					std::swap(endpoint0, endpoint1);
+				}
+
+				uint8 palette8[4][4];
+				uint32_t paletteSize = GetBC1Palette(color0, color1, fourColors, palette8);
+
+				float palette[4][4];
+				for (uint32_t i = 0; i < 4; ++i)
+					std::copy(palette8[i], palette8[i] + 4, palette[i]);
+
+				uint8 indices[16];
+				float error = SelectIndices(channels, palette, paletteSize, 3, weights, indices);
+				for (uint32_t p = 0; p < 16; ++p)
+				{
+					if (weights[p] == 0.f)
+						indices[p] = 3;
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					bestColor0 = color0;
+					bestColor1 = color1;
+					std::copy(indices, indices + 16, bestIndices);
+				}
+
+				const float fourColorWeights[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+				const float threeColorWeights[4] = { 0.f, 1.f, .5f, 0.f };
+				if (error == 0.f || !RefineEndpoints(channels, weights, 3, indices, paletteSize == 4 ? fourColorWeights : threeColorWeights, endpoint0, endpoint1))
+					break;
+			}
+
+			uint32_t bits = 0;
+			for (uint32_t p = 0; p < 16; ++p)
+				bits |= uint32_t(bestIndices[p]) << (p * 2);
+
+			block[0] = uint8(bestColor0);
+			block[1] = uint8(bestColor0 >> 8);
+			block[2] = uint8(bestColor1);
+			block[3] = uint8(bestColor1 >> 8);
+			std::memcpy(block + 4, &bits, sizeof(bits));
+		}
+
+		void DecodeColorBlock(const uint8* block, uint8* pixels, bool fourColors)
+		{
+			uint8 palette[4][4];
+			GetBC1Palette(uint16(block[0] | (block[1] << 8)), uint16(block[2] | (block[3] << 8)), fourColors, palette);
+
+			uint32_t bits;
+			std::memcpy(&bits, block + 4, sizeof(bits));
+			for (uint32_t p = 0; p < 16; ++p)
+				std::memcpy(pixels + p * 4, palette[(bits >> (p * 2)) & 3], 4);
+		}
+
+		/// \brief 8 interpolated values when value0 > value1, otherwise 6 and the extremes 0 and 255
+		void GetBC4Palette(uint8 value0, uint8 value1, uint8* palette)
+		{
+			palette[0] = value0;
+			palette[1] = value1;
+
+			if (value0 > value1)
+			{
+				for (uint32_t i = 2; i < 8; ++i)
+					palette[i] = uint8(((8 - i) * value0 + (i - 1) * value1 + 3) / 7);
+			}
+			else
+			{
+				for (uint32_t i = 2; i < 6; ++i)
+					palette[i] = uint8(((6 - i) * value0 + (i - 1) * value1 + 2) / 5);
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+		}
+
+		uint32_t SelectBC4Indices(const uint8* values, uint8 value0, uint8 value1, uint8* indices)
+		{
+			uint8 palette[8];
+			GetBC4Palette(value0, value1, palette);
+
+			uint32_t error = 0;
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				uint32_t best = ~0u;
+				for (uint32_t i = 0; i < 8; ++i)
+				{
+					int32_t difference = int32_t(values[p]) - palette[i];
+					if (uint32_t(difference * difference) < best)
+					{
+						best = uint32_t(difference * difference);
+						indices[p] = uint8(i);
+					}
+				}
+
+				error += best;
+			}
+
+			return error;
+		}
+
+		void EncodeChannelBlock(const uint8* pixels, uint32_t channel, uint8* block)
+		{
+			uint8 values[16];
+			uint8 minimum = 255, maximum = 0;
+			uint8 innerMinimum = 255, innerMaximum = 0;
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				values[p] = pixels[p * 4 + channel];
+				minimum = std::min(minimum, values[p]);
+				maximum = std::max(maximum, values[p]);
+
+				// the 6 value mode has 0 and 255 for free
+				if (values[p] != 0 && values[p] != 255)
+				{
+					innerMinimum = std::min(innerMinimum, values[p]);
+					innerMaximum = std::max(innerMaximum, values[p]);
+				}
+			}
+
+			if (innerMinimum > innerMaximum)
+				innerMinimum = innerMaximum = 0;
+
+			uint8 value0 = maximum, value1 = minimum;
+			uint8 indices[16], innerIndices[16];
+			uint32_t error = SelectBC4Indices(values, value0, value1, indices);
+			if (error != 0 && SelectBC4Indices(values, innerMinimum, innerMaximum, innerIndices) < error)
+			{
+				value0 = innerMinimum;
+				value1 = innerMaximum;
+				std::copy(innerIndices, innerIndices + 16, indices);
+			}
+
+			uint64_t bits = 0;
+			for (uint32_t p = 0; p < 16; ++p)
+				bits |= uint64_t(indices[p]) << (p * 3);
+
+			block[0] = value0;
+			block[1] = value1;
+			for (uint32_t i = 0; i < 6; ++i)
+				block[2 + i] = uint8(bits >> (i * 8));
+		}
+
+		void DecodeChannelBlock(const uint8* block, uint32_t channel, uint8* pixels)
+		{
+			uint8 palette[8];
+			GetBC4Palette(block[0], block[1], palette);
+
+			uint64_t bits = 0;
+			for (uint32_t i = 0; i < 6; ++i)
+				bits |= uint64_t(block[2 + i]) << (i * 8);
+
+			for (uint32_t p = 0; p < 16; ++p)
+				pixels[p * 4 + channel] = palette[(bits >> (p * 3)) & 7];
+		}
+
+		inline uint8 BC7Interpolate(uint32_t endpoint0, uint32_t endpoint1, uint32_t weight)
+		{
+			return uint8(((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6);
+		}
+
+		/// \brief widen an endpoint to 8 bits by repeating its top bits
+		inline uint8 BC7Expand(uint32_t value, uint32_t bits)
+		{
+			return bits >= 8 ? uint8(value) : uint8((value << (8 - bits)) | (value >> (2 * bits - 8)));
+		}
+
+		/// \brief the first index of a subset is stored without its top bit
+		inline void ReadBC7Indices(BitReader& reader, uint32_t bits, uint8* indices)
+		{
+			indices[0] = uint8(reader.Read(bits - 1));
+			for (uint32_t p = 1; p < 16; ++p)
+				indices[p] = uint8(reader.Read(bits));
+		}
+
+		typedef void(*EncodeFunction)(const uint8* pixels, uint8* block);
+
+		EncodeFunction GetEncoder(TextureContainer::Format format)
+		{
+			switch (format)
+			{
+			case TextureContainer::Format::BC1:
+				return &BlockCompression::EncodeBC1;
+			case TextureContainer::Format::BC3:
+				return &BlockCompression::EncodeBC3;
+			case TextureContainer::Format::BC4:
+				return &BlockCompression::EncodeBC4;
+			case TextureContainer::Format::BC5:
+				return &BlockCompression::EncodeBC5;
+			case TextureContainer::Format::BC7:
+				return &BlockCompression::EncodeBC7;
+			default:
+				return nullptr;
+			}
+		}
+
+		void EncodeBlockRows(TextureContainer::Format format, const uint8* pixels, uint32_t width, uint32_t height, std::size_t firstRow, std::size_t lastRow, uint8* target)
+		{
+			EncodeFunction encode = GetEncoder(format);
+			std::size_t blockSize = TextureContainer::GetBlockSize(format);
+			uint32_t blocksWide = (width + 3) / 4;
+
+			uint8 block[64];
+			for (std::size_t by = firstRow; by < lastRow; ++by)
+			{
+				for (uint32_t bx = 0; bx < blocksWide; ++bx)
+				{
+					// the last row and column repeat for sizes that aren't a multiple of 4
+					for (uint32_t y = 0; y < 4; ++y)
+					{
+						std::size_t sourceY = std::min(by * 4 + y, std::size_t(height) - 1);
+						for (uint32_t x = 0; x < 4; ++x)
+						{
+							std::size_t sourceX = std::min(bx * 4 + x, width - 1);
+							std::memcpy(block + (y * 4 + x) * 4, pixels + (sourceY * width + sourceX) * 4, 4);
+						}
+					}
+
+					encode(block, target + (by * blocksWide + bx) * blockSize);
+				}
+			}
+		}
+	}
+
+	void BlockCompression::EncodeBC1(const uint8* pixels, uint8* block)
+	{
+		EncodeColorBlock(pixels, block, false);
+	}
+
+	void BlockCompression::EncodeBC3(const uint8* pixels, uint8* block)
+	{
+		EncodeChannelBlock(pixels, 3, block);
+		EncodeColorBlock(pixels, block + 8, true);
+	}
+
+	void BlockCompression::EncodeBC4(const uint8* pixels, uint8* block)
+	{
+		EncodeChannelBlock(pixels, 0, block);
+	}
+
+	void BlockCompression::EncodeBC5(const uint8* pixels, uint8* block)
+	{
+		EncodeChannelBlock(pixels, 0, block);
+		EncodeChannelBlock(pixels, 1, block + 8);
+	}
+
+	void BlockCompression::EncodeBC7(const uint8* pixels, uint8* block)
+	{
+		// mode 6: RGBA endpoints of 7 bits plus a shared lowest bit (p-bit) per endpoint, 4 bit indices
+		BlockChannels channels(pixels);
+
+		float indexWeights[16];
+		for (uint32_t i = 0; i < 16; ++i)
+			indexWeights[i] = BC7Weights4[i] / 64.f;
+
+		float endpoint0[4], endpoint1[4];
+		FitEndpoints(channels, AllPixels, 4, 1.f / 32.f, endpoint0, endpoint1);
+
+		uint8 bestQuantized[2][4] = {};
+		uint32_t bestPBits[2] = {};
+		uint8 bestIndices[16] = {};
+		float bestError = FLT_MAX;
+
+		for (uint32_t iteration = 0; iteration < 2; ++iteration)
+		{
+			for (uint32_t pBits = 0; pBits < 4; ++pBits)
+			{
+				uint32_t p[2] = { pBits & 1, pBits >> 1 };
+
+				uint8 quantized[2][4];
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					quantized[0][c] = uint8(std::clamp(int32_t((endpoint0[c] - p[0]) * .5f + .5f), 0, 127));
+					quantized[1][c] = uint8(std::clamp(int32_t((endpoint1[c] - p[1]) * .5f + .5f), 0, 127));
+				}
+
+				float palette[16][4];
+				for (uint32_t i = 0; i < 16; ++i)
+				{
+					for (uint32_t c = 0; c < 4; ++c)
+						palette[i][c] = BC7Interpolate(quantized[0][c] * 2u + p[0], quantized[1][c] * 2u + p[1], BC7Weights4[i]);
+				}
+
+				uint8 indices[16];
+				float error = SelectIndices(channels, palette, 16, 4, AllPixels, indices);
+				if (error < bestError)
+				{
+					bestError = error;
+					std::memcpy(bestQuantized, quantized, sizeof(quantized));
+					bestPBits[0] = p[0];
+					bestPBits[1] = p[1];
+					std::copy(indices, indices + 16, bestIndices);
+				}
+			}
+
+			if (bestError == 0.f || !RefineEndpoints(channels, AllPixels, 4, bestIndices, indexWeights, endpoint0, endpoint1))
+				break;
+		}
+
+		// the first index is stored without its top bit, which is made 0 by swapping the endpoints
+		if (bestIndices[0] & 8)
+		{
+			std::swap(bestQuantized[0], bestQuantized[1]);
+			std::swap(bestPBits[0], bestPBits[1]);
+			for (uint8& index : bestIndices)
+				index = uint8(15 - index);
+		}
+
+		std::memset(block, 0, 16);
+		BitWriter writer{ block, 0 };
+		writer.Write(1 << 6, 7);
+
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			writer.Write(bestQuantized[0][c], 7);
+			writer.Write(bestQuantized[1][c], 7);
+		}
+
+		writer.Write(bestPBits[0], 1);
+		writer.Write(bestPBits[1], 1);
+
+		writer.Write(bestIndices[0], 3);
+		for (uint32_t p = 1; p < 16; ++p)
+			writer.Write(bestIndices[p], 4);
+	}
+
+	void BlockCompression::DecodeBC1(const uint8* block, uint8* pixels)
+	{
+		DecodeColorBlock(block, pixels, false);
+	}
+
+	void BlockCompression::DecodeBC3(const uint8* block, uint8* pixels)
+	{
+		DecodeColorBlock(block + 8, pixels, true);
+		DecodeChannelBlock(block, 3, pixels);
+	}
+
+	void BlockCompression::DecodeBC4(const uint8* block, uint8* pixels)
+	{
+		for (uint32_t p = 0; p < 16; ++p)
+		{
+			pixels[p * 4 + 1] = pixels[p * 4 + 2] = 0;
+			pixels[p * 4 + 3] = 255;
+		}
+
+		DecodeChannelBlock(block, 0, pixels);
+	}
+
+	void BlockCompression::DecodeBC5(const uint8* block, uint8* pixels)
+	{
+		for (uint32_t p = 0; p < 16; ++p)
+		{
+			pixels[p * 4 + 2] = 0;
+			pixels[p * 4 + 3] = 255;
+		}
+
+		DecodeChannelBlock(block, 0, pixels);
+		DecodeChannelBlock(block + 8, 1, pixels);
+	}
+
+	bool BlockCompression::DecodeBC7(const uint8* block, uint8* pixels)
+	{
+		// the mode is the amount of zero bits before the first one
+		uint32_t mode = 0;
+		while (mode < 8 && !(block[0] & (1 << mode)))
+			++mode;
+
+		if (mode < 4 || mode > 6)
+		{
+			std::memset(pixels, 0, 64);
+			return false;
+		}
+
+		BitReader reader{ block, mode + 1 };
+		uint32_t rotation = mode != 6 ? reader.Read(2) : 0;
+		uint32_t indexMode = mode == 4 ? reader.Read(1) : 0;
+
+		uint32_t colorBits = mode == 4 ? 5 : 7;
+		uint32_t alphaBits = mode == 4 ? 6 : (mode == 5 ? 8 : 7);
+
+		uint32_t endpoints[2][4];
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			endpoints[0][c] = reader.Read(colorBits);
+			endpoints[1][c] = reader.Read(colorBits);
+		}
+
+		endpoints[0][3] = reader.Read(alphaBits);
+		endpoints[1][3] = reader.Read(alphaBits);
+
+		for (uint32_t e = 0; e < 2; ++e)
+		{
+			if (mode == 6)
+			{
+				uint32_t pBit = reader.Read(1);
+				for (uint32_t c = 0; c < 4; ++c)
+					endpoints[e][c] = (endpoints[e][c] << 1) | pBit;
+			}
+			else
+			{
+				for (uint32_t c = 0; c < 4; ++c)
+					endpoints[e][c] = BC7Expand(endpoints[e][c], c < 3 ? colorBits : alphaBits);
+			}
+		}
+
+		uint8 colorIndices[16], alphaIndices[16];
+		const uint8* colorWeights;
+		const uint8* alphaWeights;
+		if (mode == 6)
+		{
+			ReadBC7Indices(reader, 4, colorIndices);
+			std::copy(colorIndices, colorIndices + 16, alphaIndices);
+			colorWeights = alphaWeights = BC7Weights4;
+		}
+		else if (mode == 5)
+		{
+			ReadBC7Indices(reader, 2, colorIndices);
+			ReadBC7Indices(reader, 2, alphaIndices);
+			colorWeights = alphaWeights = BC7Weights2;
+		}
+		else
+		{
+			// 2 bit indices first, then 3 bit ones, the index mode says which of them are for the colors
+			ReadBC7Indices(reader, 2, indexMode ? alphaIndices : colorIndices);
+			ReadBC7Indices(reader, 3, indexMode ? colorIndices : alphaIndices);
+			colorWeights = indexMode ? BC7Weights3 : BC7Weights2;
+			alphaWeights = indexMode ? BC7Weights2 : BC7Weights3;
+		}
+
+		for (uint32_t p = 0; p < 16; ++p)
+		{
+			uint8* pixel = pixels + p * 4;
+			for (uint32_t c = 0; c < 3; ++c)
+				pixel[c] = BC7Interpolate(endpoints[0][c], endpoints[1][c], colorWeights[colorIndices[p]]);
+			pixel[3] = BC7Interpolate(endpoints[0][3], endpoints[1][3], alphaWeights[alphaIndices[p]]);
+
+			if (rotation != 0)
+				std::swap(pixel[3], pixel[rotation - 1]);
+		}
+
+		return true;
+	}
+
+	std::vector<uint8> BlockCompression::Encode(TextureContainer::Format format, const uint8* pixels, uint32_t width, uint32_t height, JobSystem* jobSystem)
+	{
+		if (!TextureContainer::IsBlockCompressed(format))
+			return std::vector<uint8>(pixels, pixels + TextureContainer::GetLevelSize(format, width, height));
+
+		std::vector<uint8> blocks(TextureContainer::GetLevelSize(format, width, height));
+		std::size_t blockRows = (height + 3) / 4;
+
+		if (jobSystem)
+		{
+			jobSystem->WaitFor(jobSystem->ParallelFor(blockRows, TileRows, [&](std::size_t from, std::size_t to)
+			{
+				EncodeBlockRows(format, pixels, width, height, from, to, blocks.data());
+			}));
+		}
+		else
+			EncodeBlockRows(format, pixels, width, height, 0, blockRows, blocks.data());
+
+		return blocks;
+	}
+
+	std::vector<TextureContainer::Mip> BlockCompression::Encode(TextureContainer::Format format, const std::vector<TextureContainer::Mip>& mips, JobSystem* jobSystem)
+	{
+		struct Tile
+		{
+			uint32_t mip;
+			std::size_t firstRow;
+			std::size_t lastRow;
+		};
+
+		std::vector<TextureContainer::Mip> encoded(mips.size());
+		std::vector<Tile> tiles;
+		for (uint32_t i = 0; i < mips.size(); ++i)
+		{
+			const TextureContainer::Mip& mip = mips[i];
+			encoded[i] = TextureContainer::Mip{ mip.width, mip.height, std::vector<uint8>(TextureContainer::GetLevelSize(format, mip.width, mip.height)) };
+
+			std::size_t blockRows = (mip.height + 3) / 4;
+			for (std::size_t row = 0; row < blockRows; row += TileRows)
+				tiles.push_back(Tile{ i, row, std::min(row + TileRows, blockRows) });
+		}
+
+		if (!TextureContainer::IsBlockCompressed(format))
+		{
+			for (uint32_t i = 0; i < mips.size(); ++i)
+				encoded[i].data = mips[i].data;
+			return encoded;
+		}
+
+		auto EncodeTiles = [&](std::size_t from, std::size_t to)
+		{
+			for (std::size_t t = from; t < to; ++t)
+			{
+				const Tile& tile = tiles[t];
+				const TextureContainer::Mip& mip = mips[tile.mip];
+				EncodeBlockRows(format, mip.data.data(), mip.width, mip.height, tile.firstRow, tile.lastRow, encoded[tile.mip].data.data());
+			}
+		};
+
+		if (jobSystem)
+			jobSystem->WaitFor(jobSystem->ParallelFor(tiles.size(), 1, EncodeTiles));
+		else
+			EncodeTiles(0, tiles.size());
+
+		return encoded;
+	}
+
+	bool BlockCompression::Decode(TextureContainer::Format format, const uint8* data, uint32_t width, uint32_t height, std::vector<uint8>& pixels)
+	{
+		pixels.resize(std::size_t(width) * height * 4);
+		if (!TextureContainer::IsBlockCompressed(format))
+		{
+			std::memcpy(pixels.data(), data, pixels.size());
+			return true;
+		}
+
+		std::size_t blockSize = TextureContainer::GetBlockSize(format);
+		uint32_t blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+		bool success = true;
+
+		uint8 block[64];
+		for (uint32_t by = 0; by < blocksHigh; ++by)
+		{
+			for (uint32_t bx = 0; bx < blocksWide; ++bx)
+			{
+				const uint8* source = data + (std::size_t(by) * blocksWide + bx) * blockSize;
+				switch (format)
+				{
+				case TextureContainer::Format::BC1:
+					DecodeBC1(source, block);
+					break;
+				case TextureContainer::Format::BC3:
+					DecodeBC3(source, block);
+					break;
+				case TextureContainer::Format::BC4:
+					DecodeBC4(source, block);
+					break;
+				case TextureContainer::Format::BC5:
+					DecodeBC5(source, block);
+					break;
+				case TextureContainer::Format::BC7:
+					success &= DecodeBC7(source, block);
+					break;
+				default:
+					return false;
+				}
+
+				// only the part of the block inside the image
+				for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+				{
+					uint32_t columns = std::min(4u, width - bx * 4);
+					std::memcpy(pixels.data() + ((std::size_t(by) * 4 + y) * width + bx * 4) * 4, block + y * 16, columns * 4);
+				}
+			}
+		}
+
+		return success;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "./TextureContainer.h"
+
+namespace Esteem
+{
+	class JobSystem;
+
+	/// \brief CPU encoders and decoders for the block compressed formats of a TextureContainer
+	/// A block holds 4x4 RGBA8 pixels (64 bytes, row by row), images that aren't a multiple of 4 repeat their last
+	/// row and column. Encoders fit the endpoints on the principal axis of the block and refine them once with least
+	/// squares, BC7 only writes mode 6 (one subset, RGBA endpoints, 4 bit indices). The decoders verify the encoders and
+	/// cover GPUs without the format, of BC7 they read the single subset modes 4, 5 and 6.
+	class BlockCompression
+	{
+	public:
+		static constexpr uint32_t BlockDimension = 4;
+		static constexpr uint32_t BlockPixels = BlockDimension * BlockDimension;
+
+		/// \brief pixels with alpha below 128 become transparent (black)
+		static void EncodeBC1(const uint8* pixels, uint8* block);
+		static void EncodeBC3(const uint8* pixels, uint8* block);
+		/// \brief red only
+		static void EncodeBC4(const uint8* pixels, uint8* block);
+		/// \brief red and green
+		static void EncodeBC5(const uint8* pixels, uint8* block);
+		static void EncodeBC7(const uint8* pixels, uint8* block);
+
+		static void DecodeBC1(const uint8* block, uint8* pixels);
+		static void DecodeBC3(const uint8* block, uint8* pixels);
+		/// \brief missing channels become 0 and alpha 255, like sampling the texture on the GPU
+		static void DecodeBC4(const uint8* block, uint8* pixels);
+		static void DecodeBC5(const uint8* block, uint8* pixels);
+		/// \return false for modes this decoder doesn't read, the pixels are zeroed then
+		static bool DecodeBC7(const uint8* block, uint8* pixels);
+
+		/// \brief compress an RGBA8 image, rows of blocks are spread over the job system if one is given
+		static std::vector<uint8> Encode(TextureContainer::Format format, const uint8* pixels, uint32_t width, uint32_t height, JobSystem* jobSystem = nullptr);
+		/// \brief compress every level of an RGBA8 mip chain, all levels and tiles are encoded in parallel
+		static std::vector<TextureContainer::Mip> Encode(TextureContainer::Format format, const std::vector<TextureContainer::Mip>& mips, JobSystem* jobSystem = nullptr);
+
+		/// \brief decompress a level into RGBA8 pixels
+		static bool Decode(TextureContainer::Format format, const uint8* data, uint32_t width, uint32_t height, std::vector<uint8>& pixels);
+	};
+}
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "Rendering/Objects/RenderObject.h"
+#include "Rendering/Objects/LightObject.h"
 
 #include <cppu/cgc/pointers.h>
 
@@ -14,15 +15,26 @@ namespace Esteem
 
 	typedef std::array<std::vector<RenderObject*>, RenderObject::RenderOrder::COUNT> RenderList;
 
+	/// \brief opaque shadow casting objects of one light, per shadow map face in the order of LightData::GetShadowMatrix
+	struct ShadowCasterList
+	{
+		const LightData* light;
+		uint faceCount;
+		std::array<std::vector<RenderObject*>, 6> faces;
+	};
+
 	class IRenderData
 	{
 	public:
 		virtual RenderList& GetAbstractRenderList() = 0;
 		virtual const std::vector<LightRenderData>* GetLights() const = 0;
 		virtual const cgc::strong_ptr<Camera>& GetCamera() const = 0;
+		/// \brief nullptr when the shadow casters weren't culled, the opaque render list is used then
+		virtual const std::vector<ShadowCasterList>* GetShadowCasters() const = 0;
 
 		virtual void SetRenderList(const RenderList& renderList) = 0;
 		virtual void SetLights(const std::vector<LightRenderData>* lights) = 0;
+		virtual void SetShadowCasters(const std::vector<ShadowCasterList>* shadowCasters) = 0;
 		virtual void SetRenderCamera(const cgc::strong_ptr<Camera>& renderCamera) = 0;
 	};
 }
\ No newline at end of file
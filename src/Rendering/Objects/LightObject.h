@@ -3,6 +3,7 @@
 #include "stdafx.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 #include "General/CommonTypes.h"
 
@@ -38,6 +39,27 @@ namespace Esteem
 		{}
 
 		inline void SetShadowMapIndex(int32 shadowMapIndex) { this->shadowMapIndex = shadowMapIndex; }
+
+		/// \brief shadow map faces rendered for this light: 6 for point lights, 1 for spot lights, 0 for anything else
+		/// Directional lights are left out, they use the cascades that follow the camera.
+		inline uint GetShadowFaceCount() const
+		{
+			return type == LightType::POINT ? 6 : (type == LightType::SPOT ? 1 : 0);
+		}
+
+		/// \brief view projection matrix of a shadow map face, faces of point lights are ordered as the cube map sides (+x, -x, +y, -y, +z, -z)
+		/// Used by both the shadow caster culling and the shadow renderer, so they can't drift apart.
+		inline glm::mat4 GetShadowMatrix(uint face) const
+		{
+			static const glm::mat4 projection = glm::perspective<float>(glm::radians(91.f), 1.f, 1.f, 1024.f);
+
+			if (type == LightType::SPOT)
+				return projection * glm::lookAt(position, position - forward, glm::vec3(0, 1, 0));
+
+			static const glm::vec3 directions[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+			static const glm::vec3 ups[6] = { { 0, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 0, 1, 0 }, { 0, 1, 0 } };
+			return projection * glm::lookAt(position, position + directions[face], ups[face]);
+		}
 	};
 
 	struct LightRenderData
@@ -19,6 +19,8 @@ namespace Esteem
 	
 	class Material
 	{
+	friend class RenderingFactory;
+
 	public:
 		struct Buffers
 		{
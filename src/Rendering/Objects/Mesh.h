@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 #include <cppu/cgc/pointers.h>
 
@@ -38,6 +39,28 @@ namespace Esteem
 			virtual ~Data() {}
 		};
 
+		/// \brief vertices and indices in memory owned by someone else, e.g.: a memory mapped .mdl file
+		struct MappedData : IMeshData
+		{
+			/// \brief keeps the memory alive, may be empty if the owner outlives the mesh (e.g.: a mounted pak)
+			std::shared_ptr<const void> storage;
+			const V* vertices;
+			std::size_t vertexCount;
+			const I* indices;
+			std::size_t indexCount;
+
+			MappedData(const std::shared_ptr<const void>& storage, const V* vertices, std::size_t vertexCount, const I* indices, std::size_t indexCount)
+				: storage(storage)
+				, vertices(vertices)
+				, vertexCount(vertexCount)
+				, indices(indices)
+				, indexCount(indexCount)
+			{ }
+
+			virtual mm::array_view GetVertexMemInfo() const;
+			virtual mm::array_view GetIndexMemInfo() const;
+		};
+
 	private:
 		cgc::strong_ptr<IVBO> vbo;
 		cgc::strong_ptr<IEBO> ebo;
@@ -46,6 +69,7 @@ namespace Esteem
 		Mesh(bool keepOnCPU);
 		Mesh(std::vector<V>& vertexData, std::vector<I>& indices, bool keepOnCPU);
 		Mesh(const cgc::strong_ptr<Data>& meshData, bool keepOnCPU);
+		Mesh(const cgc::strong_ptr<MappedData>& meshData, bool keepOnCPU);
 
 		virtual const cgc::strong_ptr<IVBO>& GetVBO() const;
 		virtual void SetVBO(const cgc::strong_ptr<IVBO>& vbo);
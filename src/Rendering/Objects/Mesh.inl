@@ -22,6 +22,11 @@ namespace Esteem
 		: AbstractMesh(keepOnCPU, meshData)
 	{ }
 
+	template<class V, class I>
+	Mesh<V, I>::Mesh(const cgc::strong_ptr<MappedData>& meshData, bool keepOnCPU)
+		: AbstractMesh(keepOnCPU, meshData)
+	{ }
+
 	template<class V, class I>
 	inline const cgc::strong_ptr<IVBO>& Mesh<V, I>::GetVBO() const
 	{
@@ -85,6 +90,18 @@ namespace Esteem
 		return mm::array_view(indices);
 	}
 	
+	template<class V, class I>
+	mm::array_view Mesh<V, I>::MappedData::GetVertexMemInfo() const
+	{
+		return mm::array_view(vertices, vertexCount, sizeof(V));
+	}
+
+	template<class V, class I>
+	mm::array_view Mesh<V, I>::MappedData::GetIndexMemInfo() const
+	{
+		return mm::array_view(indices, indexCount, sizeof(I));
+	}
+
 	template<class V, class I>
 	inline bool Mesh<V, I>::AvailableOnGPU() const
 	{
@@ -57,7 +57,7 @@ namespace Esteem
 		Rebuild();
 	}
 
-	void Text::SetText(const std::string& text)
+	void Text::SetText(std::string_view text)
 	{
 		this->text = text;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include "./Font.h"
 #include "Rendering/Objects/GraphicalOverlay.h"
 
@@ -48,7 +49,7 @@ namespace Esteem
 
 		const details::FontInfo& GetFontSettings() const { return fontSettings; }
 
-		void SetText(const std::string& text);
+		void SetText(std::string_view text);
 		const std::string& GetText() const { return text; }
 
 
@@ -0,0 +1,286 @@
+#include "./TextureContainer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr float Pi = 3.14159265358979f;
+
+		/// \brief source texels [first, first + weights.size()) that make up one target texel
+		struct FilterTaps
+		{
+			uint32_t first;
+			std::vector<float> weights;
+		};
+
+		inline float SRGBToLinear(float value)
+		{
+			return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		inline float LinearToSRGB(float value)
+		{
+			return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+		}
+
+		/// \brief modified Bessel function of the first kind, order 0
+		float BesselI0(float x)
+		{
+			float sum = 1.f, term = 1.f;
+			for (int k = 1; k < 32 && term > sum * 1e-8f; ++k)
+			{
+				float factor = x / (2.f * k);
+				term *= factor * factor;
+				sum += term;
+			}
+
+			return sum;
+		}
+
+		/// \param x distance in target texels
+		float Kaiser(float x)
+		{
+			constexpr float Width = 3.f;
+			constexpr float Alpha = 4.f;
+
+			float t = x / Width;
+			if (t * t >= 1.f)
+				return 0.f;
+
+			float sinc = std::abs(x) < 1e-4f ? 1.f : std::sin(Pi * x) / (Pi * x);
+			return sinc * BesselI0(Alpha * std::sqrt(1.f - t * t)) / BesselI0(Alpha);
+		}
+
+		/// \brief weights per target texel, edges clamp to the first and last source texel
+		std::vector<FilterTaps> GetFilterTaps(TextureContainer::MipFilter filter, uint32_t sourceSize, uint32_t targetSize)
+		{
+			std::vector<FilterTaps> taps(targetSize);
+			float scale = float(sourceSize) / float(targetSize);
+			float radius = filter == TextureContainer::MipFilter::KAISER ? 3.f * scale : .5f * scale;
+
+			for (uint32_t i = 0; i < targetSize; ++i)
+			{
+				float center = (i + .5f) * scale;
+				int32_t first = int32_t(std::floor(center - radius));
+				int32_t last = int32_t(std::ceil(center + radius));
+
+				std::vector<float> weights(std::size_t(last - first + 1), 0.f);
+				float total = 0.f;
+				for (int32_t s = first; s <= last; ++s)
+				{
+					float distance = (s + .5f - center) / scale;
+					float weight;
+					if (filter == TextureContainer::MipFilter::KAISER)
+						weight = Kaiser(distance);
+					else
+					{
+						// the part of the source texel that falls inside the target texel
+						float overlap = std::min(s + 1.f, center + radius) - std::max(float(s), center - radius);
+						weight = std::max(0.f, overlap);
+					}
+
+					int32_t clamped = std::clamp(s, 0, int32_t(sourceSize) - 1);
+					weights[std::size_t(clamped - first)] += weight;
+					total += weight;
+				}
+
+				// trim the texels that fell outside, they were folded onto the edge
+				std::size_t begin = std::size_t(std::max(0, -first));
+				std::size_t end = std::size_t(std::min(last, int32_t(sourceSize) - 1) - first + 1);
+
+				taps[i].first = uint32_t(first + int32_t(begin));
+				taps[i].weights.assign(weights.begin() + begin, weights.begin() + end);
+				for (float& weight : taps[i].weights)
+					weight /= total;
+			}
+
+			return taps;
+		}
+	}
+
+	TextureContainer::TextureContainer()
+		: data(nullptr)
+		, size(0)
+	{ }
+
+	bool TextureContainer::Open(const void* data, std::size_t size)
+	{
+		this->data = nullptr;
+		this->size = 0;
+
+		if (size < sizeof(Header) || std::memcmp(data, Magic, sizeof(Magic)) != 0)
+			return false;
+
+		const Header& header = *static_cast<const Header*>(data);
+		if (header.version != Version || header.format > Format::LAST || header.mipCount == 0 || header.mipCount > MaxMipCount)
+			return false;
+
+		for (uint32_t i = 0; i < header.mipCount; ++i)
+		{
+			const MipLevel& mip = header.mips[i];
+			if (uint64_t(mip.offset) + mip.size > size || GetLevelSize(header.format, mip.width, mip.height) != mip.size)
+				return false;
+		}
+
+		this->data = static_cast<const uint8*>(data);
+		this->size = size;
+		return true;
+	}
+
+	mm::array_view TextureContainer::GetMip(uint32_t level) const
+	{
+		if (data == nullptr || level >= GetHeader().mipCount)
+			return mm::array_view();
+
+		const MipLevel& mip = GetHeader().mips[level];
+		return mm::array_view(data + mip.offset, mip.size, sizeof(uint8));
+	}
+
+	std::vector<TextureContainer::Mip> TextureContainer::GenerateMipChain(const uint8* pixels, uint32_t width, uint32_t height, MipFilter filter, bool sRGB)
+	{
+		std::vector<Mip> mips;
+		if (pixels == nullptr || width == 0 || height == 0)
+			return mips;
+
+		mips.push_back(Mip{ width, height, std::vector<uint8>(pixels, pixels + std::size_t(width) * height * 4) });
+
+		// levels are filtered from the previous one in linear floats, so rounding doesn't add up over the chain
+		float toLinear[256];
+		for (uint32_t i = 0; i < 256; ++i)
+			toLinear[i] = sRGB ? SRGBToLinear(i / 255.f) : i / 255.f;
+
+		std::vector<float> source(std::size_t(width) * height * 4);
+		for (std::size_t i = 0; i < source.size(); ++i)
+			source[i] = (i & 3) == 3 ? pixels[i] / 255.f : toLinear[pixels[i]];
+
+		std::vector<float> rows;
+		std::vector<float> target;
+		while ((width > 1 || height > 1) && mips.size() < MaxMipCount)
+		{
+			uint32_t mipWidth = std::max(1u, width >> 1);
+			uint32_t mipHeight = std::max(1u, height >> 1);
+
+			// separable: first the width of every source row, then the height
+			std::vector<FilterTaps> horizontal = GetFilterTaps(filter, width, mipWidth);
+			std::vector<FilterTaps> vertical = GetFilterTaps(filter, height, mipHeight);
+
+			rows.assign(std::size_t(mipWidth) * height * 4, 0.f);
+			for (uint32_t y = 0; y < height; ++y)
+			{
+				const float* sourceRow = source.data() + std::size_t(y) * width * 4;
+				float* row = rows.data() + std::size_t(y) * mipWidth * 4;
+
+				for (uint32_t x = 0; x < mipWidth; ++x)
+				{
+					const FilterTaps& taps = horizontal[x];
+					for (std::size_t t = 0; t < taps.weights.size(); ++t)
+					{
+						const float* texel = sourceRow + std::size_t(taps.first + t) * 4;
+						for (uint32_t c = 0; c < 4; ++c)
+							row[x * 4 + c] += texel[c] * taps.weights[t];
+					}
+				}
+			}
+
+			target.assign(std::size_t(mipWidth) * mipHeight * 4, 0.f);
+			for (uint32_t y = 0; y < mipHeight; ++y)
+			{
+				const FilterTaps& taps = vertical[y];
+				float* targetRow = target.data() + std::size_t(y) * mipWidth * 4;
+
+				for (std::size_t t = 0; t < taps.weights.size(); ++t)
+				{
+					const float* row = rows.data() + std::size_t(taps.first + t) * mipWidth * 4;
+					for (std::size_t i = 0; i < std::size_t(mipWidth) * 4; ++i)
+						targetRow[i] += row[i] * taps.weights[t];
+				}
+			}
+
+			Mip mip{ mipWidth, mipHeight, std::vector<uint8>(target.size()) };
+			for (std::size_t i = 0; i < target.size(); ++i)
+			{
+				// the negative lobes of the Kaiser filter can overshoot
+				float value = std::clamp(target[i], 0.f, 1.f);
+				mip.data[i] = uint8(((i & 3) == 3 || !sRGB ? value : LinearToSRGB(value)) * 255.f + .5f);
+			}
+
+			width = mipWidth;
+			height = mipHeight;
+			source.swap(target);
+			mips.push_back(std::move(mip));
+		}
+
+		return mips;
+	}
+
+	std::string TextureContainer::Write(Format format, const std::vector<Mip>& mips)
+	{
+		if (mips.empty() || mips.size() > MaxMipCount)
+			return std::string();
+
+		Header header = {};
+		std::memcpy(header.magic, Magic, sizeof(Magic));
+		header.version = Version;
+		header.format = format;
+		header.width = mips[0].width;
+		header.height = mips[0].height;
+		header.mipCount = uint32_t(mips.size());
+
+		uint32_t offset = sizeof(Header);
+		for (std::size_t i = 0; i < mips.size(); ++i)
+		{
+			if (mips[i].data.size() != GetLevelSize(format, mips[i].width, mips[i].height))
+				return std::string();
+
+			MipLevel& level = header.mips[i];
+			level.offset = offset;
+			level.size = uint32_t(mips[i].data.size());
+			level.width = mips[i].width;
+			level.height = mips[i].height;
+
+			offset = (offset + level.size + Alignment - 1) & ~(Alignment - 1);
+		}
+
+		std::string contents(offset, '\0');
+		std::memcpy(contents.data(), &header, sizeof(Header));
+		for (std::size_t i = 0; i < mips.size(); ++i)
+			std::memcpy(contents.data() + header.mips[i].offset, mips[i].data.data(), mips[i].data.size());
+
+		return contents;
+	}
+
+	bool TextureContainer::IsBlockCompressed(Format format)
+	{
+		return format != Format::RGBA8;
+	}
+
+	std::size_t TextureContainer::GetBlockSize(Format format)
+	{
+		switch (format)
+		{
+		case Format::RGBA8:
+			return 4;
+		case Format::BC1:
+		case Format::BC4:
+			return 8;
+		case Format::BC3:
+		case Format::BC5:
+		case Format::BC7:
+			return 16;
+		}
+
+		return 0;
+	}
+
+	std::size_t TextureContainer::GetLevelSize(Format format, uint32_t width, uint32_t height)
+	{
+		if (!IsBlockCompressed(format))
+			return std::size_t(width) * height * GetBlockSize(format);
+
+		return std::size_t((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+	}
+}
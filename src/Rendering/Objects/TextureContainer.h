@@ -0,0 +1,107 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Memory/array_view.h"
+
+namespace Esteem
+{
+	/// \brief cooked texture: a small header with the offset of every mip level followed by the levels themselves
+	/// Levels start on an Alignment boundary and are stored exactly as they are uploaded, so a mapped container can be
+	/// handed to the GPU without conversions. Written by EsteemCook, see CookedAssets::GetTexturePath().
+	class TextureContainer
+	{
+	public:
+		static constexpr char Magic[4] = { 'E', 'T', 'E', 'X' };
+		static constexpr uint16 Version = 1;
+		static constexpr uint32_t MaxMipCount = 16;
+		static constexpr uint32_t Alignment = 16;
+
+		enum class Format : uint16
+		{
+			RGBA8 = 0,
+			/// \brief RGB with 1 bit alpha, 4 bits per pixel
+			BC1,
+			/// \brief BC1 colors with BC4 alpha, 8 bits per pixel
+			BC3,
+			/// \brief one channel (red), 4 bits per pixel
+			BC4,
+			/// \brief two BC4 channels (red and green), 8 bits per pixel
+			BC5,
+			/// \brief RGBA, 8 bits per pixel
+			BC7,
+
+			LAST = BC7
+		};
+
+		enum class MipFilter
+		{
+			/// \brief average of the pixels a texel covers
+			BOX = 0,
+			/// \brief windowed sinc, sharper than BOX without its aliasing
+			KAISER
+		};
+
+		struct MipLevel
+		{
+			uint32_t offset;
+			uint32_t size;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		struct alignas(16) Header
+		{
+			char magic[4];
+			uint16 version;
+			Format format;
+			uint32_t width;
+			uint32_t height;
+			uint32_t mipCount;
+			uint32_t reserved[3];
+
+			MipLevel mips[MaxMipCount];
+		};
+
+		/// \brief a level while cooking, RGBA8 pixels or the blocks of a compressed format
+		struct Mip
+		{
+			uint32_t width;
+			uint32_t height;
+			std::vector<uint8> data;
+		};
+
+	private:
+		const uint8* data;
+		std::size_t size;
+
+	public:
+		TextureContainer();
+
+		/// \brief validate and use the given container, which must outlive this object
+		bool Open(const void* data, std::size_t size);
+
+		inline bool IsOpen() const { return data != nullptr; }
+		inline const Header& GetHeader() const { return *reinterpret_cast<const Header*>(data); }
+
+		/// \brief the bytes of a mip level, level 0 is the full size image
+		mm::array_view GetMip(uint32_t level) const;
+
+		/// \brief full mip chain down to 1x1 of an RGBA8 image, each level is filtered from the previous one
+		/// \param sRGB filter the colors in linear space, alpha always is; turn off for data like normal maps
+		static std::vector<Mip> GenerateMipChain(const uint8* pixels, uint32_t width, uint32_t height, MipFilter filter = MipFilter::BOX, bool sRGB = true);
+
+		/// \return the container, empty if there are no or too many levels
+		static std::string Write(Format format, const std::vector<Mip>& mips);
+
+		static bool IsBlockCompressed(Format format);
+		/// \brief bytes of a 4x4 block, or of a pixel for uncompressed formats
+		static std::size_t GetBlockSize(Format format);
+		/// \brief bytes of a level, compressed levels are rounded up to whole blocks
+		static std::size_t GetLevelSize(Format format, uint32_t width, uint32_t height);
+	};
+}
@@ -0,0 +1,448 @@
+#include "NullFactory.h"
+
+#include <algorithm>
+
+#include "Utils/Data.h"
+#include "Utils/Debug.h"
+
+#include "../../Objects/Image.h"
+#include "Rendering/Objects/AbstractMesh.h"
+
+namespace Esteem
+{
+	namespace Null
+	{
+		void NullUBO::UpdateBuffer(const void* data, uint size)
+		{
+			factory->AddUploadedBytes(size);
+		}
+
+		void NullBoneMatrices::UpdateMatrices()
+		{
+			factory->AddUploadedBytes(size * sizeof(value_type));
+			dirty = false;
+		}
+
+		void NullBoneMatrices::UpdateMatrices(const value_type* matrices, size_t size, size_t offset)
+		{
+			BoneMatrices::UpdateMatrices(matrices, size, offset);
+			NullBoneMatrices::UpdateMatrices();
+		}
+
+		void NullBoneMatrices::UpdateMatrices(const value_type* matrices)
+		{
+			NullBoneMatrices::UpdateMatrices(matrices, size, 0);
+		}
+
+		NullFactory::NullFactory()
+			: allocatedMemory(0)
+			, uploadedBytes(0)
+			, nextId(1)
+		{
+			if (RenderingFactory::instance)
+				Debug::LogError("NullFactory created while another factory is already present, newly created instance has been ignored.");
+			else
+				RenderingFactory::instance = this;
+
+			Data::Register(this);
+		}
+
+		NullFactory::~NullFactory()
+		{
+			Data::UnRegister(this);
+
+			if (RenderingFactory::instance == this)
+				RenderingFactory::instance = nullptr;
+		}
+
+		std::size_t NullFactory::GetTextureSize(const glm::uvec2& size, bool mipmapped)
+		{
+			// RGBA8, a full mip chain adds a third
+			std::size_t bytes = std::size_t(size.x) * std::size_t(size.y) * 4;
+			return mipmapped ? bytes + bytes / 3 : bytes;
+		}
+
+		cgc::strong_ptr<IShader> NullFactory::LoadShader(std::string_view path)
+		{
+			return cgc::static_pointer_cast<IShader>(LoadNullShader(path));
+		}
+
+		cgc::strong_ptr<NullShader> NullFactory::LoadNullShader(std::string_view path)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			auto found = shadersByPath.find(RT_HASH(path));
+			if (found != shadersByPath.end())
+				return found->second;
+
+			cgc::strong_ptr<NullShader> shader = shaders.emplace(nextId++, path);
+			shadersByPath.emplace(RT_HASH(path), shader);
+
+			return shader;
+		}
+
+		cgc::strong_ptr<Material> NullFactory::CreateMaterial(std::string_view path, const rapidjson::Document& json, const std::vector<cgc::strong_ptr<Material>>& baseMaterials, TEXTURE_FILTER textureFlter)
+		{
+			auto found = json.FindMember("name");
+			std::string name = found != json.MemberEnd() && found->value.IsString() ? found->value.GetString() : "UNKNOWN";
+
+			cgc::strong_ptr<NullMaterial> material;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				material = materials.emplace(nextId++, path, name);
+				materialsByPath[RT_HASH(path)] = material;
+			}
+
+			for (const cgc::strong_ptr<Material>& base : baseMaterials)
+				material->shader = static_cast<const NullMaterial*>(base.ptr())->shader;
+
+			ApplyMaterialSettings(*material, json, baseMaterials);
+
+			if ((found = json.FindMember("textures")) != json.MemberEnd() && found->value.IsObject())
+			{
+				// textures are registered under their path but never decoded
+				for (auto it = found->value.MemberBegin(); it != found->value.MemberEnd(); ++it)
+				{
+					if (!it->value.IsString())
+						continue;
+
+					ConstructSettings::Texture2D settings;
+					settings.mipmapped = true;
+					settings.repeat = TEXTURE_REPEAT::REPEAT;
+					settings.textureFilter = TEXTURE_FILTER::NEAREST;
+					settings.mipMapFilter = textureFlter == TEXTURE_FILTER::NEAREST ? TEXTURE_FILTER::NEAREST_MIPMAP_NEAREST : TEXTURE_FILTER::LINEAR_MIPMAP_LINEAR;
+
+					cgc::strong_ptr<Texture2D> texture2D = LoadTexture2D(settings, RESOURCES_PATH + TEXTURES_PATH + it->value.GetString());
+					if (texture2D != nullptr)
+						material->SetTexture2D(RT_HASH(std::string(it->name.GetString())), texture2D);
+				}
+			}
+
+			// shaders only need a stable identity, sub shaders are folded into one name
+			found = json.FindMember("openglshaders");
+			if (found == json.MemberEnd())
+				found = json.FindMember("shader");
+
+			if (found != json.MemberEnd())
+			{
+				if (found->value.IsString())
+					material->shader = LoadNullShader(found->value.GetString());
+				else if (found->value.IsObject())
+				{
+					std::string shaderName;
+					for (auto it = found->value.MemberBegin(); it != found->value.MemberEnd(); ++it)
+					{
+						if (it->value.IsString())
+							shaderName.append(it->value.GetString()).push_back(';');
+					}
+
+					material->shader = LoadNullShader(shaderName);
+				}
+			}
+
+			return material;
+		}
+
+		cgc::strong_ptr<Material> NullFactory::GetMaterial(std::string_view path)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			auto found = materialsByPath.find(RT_HASH(path));
+			if (found != materialsByPath.end())
+				return found->second;
+
+			return nullptr;
+		}
+
+		cgc::strong_ptr<Buffer> NullFactory::LoadBuffer(const ConstructSettings::Buffer& settings, const std::string& name, void* data, std::size_t offset, std::size_t size)
+		{
+			cgc::strong_ptr<Buffer> buffer;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				uint id = nextId++;
+				buffer = buffers.emplace(settings, id, id, name);
+			}
+
+			allocatedMemory += settings.size;
+			if (data)
+				uploadedBytes += size;
+
+			return buffer;
+		}
+
+		cgc::strong_ptr<Texture1D> NullFactory::LoadTexture1D(const ConstructSettings::Texture1D& settings, const cgc::strong_ptr<Image>& image)
+		{
+			if (!image)
+				return cgc::strong_ptr<Texture1D>();
+
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (!settings.custom)
+			{
+				auto found = originalTexture1Ds.find(RT_HASH(image->GetPath()));
+				if (found != originalTexture1Ds.end())
+					return found->second;
+			}
+
+			cgc::strong_ptr<Texture1D> texture = texture1Ds.emplace(settings, nextId++, image->GetPath(), image);
+			if (!settings.custom)
+				originalTexture1Ds.emplace(RT_HASH(image->GetPath()), texture);
+
+			allocatedMemory += std::size_t(settings.size) * 4;
+			uploadedBytes += std::size_t(settings.size) * 4;
+
+			return texture;
+		}
+
+		cgc::strong_ptr<Texture1D> NullFactory::LoadTexture1D(const ConstructSettings::Texture1D& settings, const std::string& name)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (!settings.custom)
+			{
+				auto found = originalTexture1Ds.find(RT_HASH(name));
+				if (found != originalTexture1Ds.end())
+					return found->second;
+			}
+
+			cgc::strong_ptr<Texture1D> texture = texture1Ds.emplace(settings, nextId++, name);
+			if (!settings.custom)
+				originalTexture1Ds.emplace(RT_HASH(name), texture);
+
+			allocatedMemory += std::size_t(settings.size) * 4;
+
+			return texture;
+		}
+
+		cgc::strong_ptr<Texture2D> NullFactory::LoadTexture2D(const ConstructSettings::Texture2D& settings, const cgc::strong_ptr<Image>& image)
+		{
+			if (!image)
+				return cgc::strong_ptr<Texture2D>();
+
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (!settings.custom)
+			{
+				auto found = originalTexture2Ds.find(RT_HASH(image->GetPath()));
+				if (found != originalTexture2Ds.end())
+					return found->second;
+			}
+
+			cgc::strong_ptr<Texture2D> texture = texture2Ds.emplace(settings, nextId++, image->GetPath(), image);
+			if (!settings.custom)
+				originalTexture2Ds.emplace(RT_HASH(image->GetPath()), texture);
+
+			std::size_t bytes = GetTextureSize(settings.size, settings.mipmapped);
+			allocatedMemory += bytes;
+			uploadedBytes += bytes;
+
+			return texture;
+		}
+
+		cgc::strong_ptr<Texture2D> NullFactory::LoadTexture2D(const ConstructSettings::Texture2D& settings, const std::string& name)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (!settings.custom)
+			{
+				auto found = originalTexture2Ds.find(RT_HASH(name));
+				if (found != originalTexture2Ds.end())
+					return found->second;
+			}
+
+			cgc::strong_ptr<Texture2D> texture = texture2Ds.emplace(settings, nextId++, name);
+			if (!settings.custom)
+				originalTexture2Ds.emplace(RT_HASH(name), texture);
+
+			allocatedMemory += GetTextureSize(settings.size, settings.mipmapped);
+
+			return texture;
+		}
+
+		cgc::strong_ptr<Texture3D> NullFactory::LoadTexture3D(const ConstructSettings::Texture3D& settings, const std::string& name, const std::vector<cgc::strong_ptr<Image>>& images)
+		{
+			// not supported by any backend yet
+			return cgc::strong_ptr<Texture3D>();
+		}
+
+		cgc::strong_ptr<TextureCube> NullFactory::LoadTextureCube(const ConstructSettings::TextureCube& settings, const std::string& name, const std::vector<cgc::strong_ptr<Image>>& images)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			auto found = originalTextureCubes.find(RT_HASH(name));
+			if (found != originalTextureCubes.end())
+				return found->second;
+
+			cgc::strong_ptr<TextureCube> texture = textureCubes.emplace(settings, nextId++, name, images);
+			originalTextureCubes.emplace(RT_HASH(name), texture);
+
+			std::size_t bytes = GetTextureSize(settings.size, settings.mipmapped) * 6;
+			allocatedMemory += bytes;
+			if (!images.empty())
+				uploadedBytes += bytes;
+
+			return texture;
+		}
+
+		cgc::strong_ptr<Texture2D> NullFactory::GetTexture2D(const std::string& name)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			auto found = originalTexture2Ds.find(RT_HASH(name));
+			if (found != originalTexture2Ds.end())
+				return found->second;
+
+			return {};
+		}
+
+		void NullFactory::UpdateBuffer(const cgc::strong_ptr<Buffer>& buffer, const void* data, std::size_t offset, std::size_t size, bool enlarge)
+		{
+			if (data)
+			{
+				if (enlarge && offset + size > buffer->GetSettings().size)
+				{
+					allocatedMemory += offset + size - buffer->GetSettings().size;
+					const_cast<Buffer::Settings&>(buffer->GetSettings()).size = offset + size;
+				}
+
+				uploadedBytes += size;
+			}
+		}
+
+		void NullFactory::UpdateTexture1D(const cgc::strong_ptr<Texture1D>& texture, const cgc::strong_ptr<Image>& image, uint offset)
+		{
+			if (image)
+				uploadedBytes += std::size_t(image->GetSize().x) * 4;
+		}
+
+		void NullFactory::UpdateTexture2D(const cgc::strong_ptr<Texture2D>& texture, const cgc::strong_ptr<Image>& image, const glm::uvec2& offset)
+		{
+			if (image)
+				uploadedBytes += GetTextureSize(glm::uvec2(image->GetSize().x, image->GetSize().y), false);
+		}
+
+		void NullFactory::CreateMeshBuffers(AbstractMesh& mesh, const IMeshData& meshData, TRIANGLE_TYPE triangleType)
+		{
+			mm::array_view vertices = meshData.GetVertexMemInfo();
+			mm::array_view indices = meshData.GetIndexMemInfo();
+
+			std::size_t vertexBytes = vertices.type_size() * vertices.size();
+			std::size_t indexBytes = indices.type_size() * indices.size();
+
+			cgc::strong_ptr<NullVBO> vbo;
+			cgc::strong_ptr<NullEBO> ebo;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				if (!mesh.GetVBO())
+					vbo = vbos.emplace(nextId++, vertexBytes, vertices.size());
+				ebo = ebos.emplace(nextId++, indexBytes, indices.size(), triangleType);
+			}
+
+			if (vbo)
+			{
+				mesh.SetVBO(vbo);
+				allocatedMemory += vertexBytes;
+				uploadedBytes += vertexBytes;
+			}
+
+			mesh.SetEBO(ebo);
+			allocatedMemory += indexBytes;
+			uploadedBytes += indexBytes;
+		}
+
+		cgc::strong_ptr<RenderObject> NullFactory::LoadRenderObject(const cgc::strong_ptr<AbstractMesh>& mesh, const cgc::strong_ptr<Material>& material, UPLOAD_TYPE uploadType, TRIANGLE_TYPE triangleType)
+		{
+			cgc::strong_ptr<NullRenderObject> renderObject;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				renderObject = renderObjects.emplace(mesh, material);
+			}
+
+			if (mesh->GetMeshData())
+				CreateMeshBuffers(*mesh, *mesh->GetMeshData(), triangleType);
+
+			if (!mesh->KeepOnCPU())
+				mesh->UnloadFromCPU();
+
+			return renderObject;
+		}
+
+		cgc::strong_ptr<RenderObject> NullFactory::LoadRenderObject(const cgc::strong_ptr<RenderObject>& copy)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			return renderObjects.emplace(*static_cast<NullRenderObject*>(copy.ptr()));
+		}
+
+		void NullFactory::UpdateMesh(const cgc::strong_ptr<AbstractMesh>& mesh, const cgc::strong_ptr<IMeshData>& meshData)
+		{
+			if (mesh->version != meshData->version || !mesh->GetVBO() || !mesh->GetEBO())
+				return;
+
+			mm::array_view vertices = meshData->GetVertexMemInfo();
+			mm::array_view indices = meshData->GetIndexMemInfo();
+
+			NullVBO* vbo = static_cast<NullVBO*>(mesh->GetVBO().ptr());
+			NullEBO* ebo = static_cast<NullEBO*>(mesh->GetEBO().ptr());
+
+			std::size_t vertexBytes = vertices.type_size() * vertices.size();
+			std::size_t indexBytes = indices.type_size() * indices.size();
+
+			allocatedMemory += vertexBytes + indexBytes;
+			allocatedMemory -= vbo->bufferSize + ebo->bufferSize;
+			uploadedBytes += vertexBytes + indexBytes;
+
+			vbo->bufferSize = vertexBytes;
+			vbo->vertexCount = vertices.size();
+			ebo->bufferSize = indexBytes;
+			ebo->indices = indices.size();
+		}
+
+		LightRenderData NullFactory::LoadLight()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			for (std::size_t i = 0; i < lightsData.size(); ++i)
+			{
+				LightData* light = &lightsData[i];
+				if (light->type == LightData::NONE_REUSE)
+					return { light, &lightMatrices[i], uint32_t(i) };
+			}
+
+			// deques keep the handed out pointers valid when growing
+			uint32_t lightIndex = uint32_t(lightsData.size());
+			LightData* lightData = &lightsData.emplace_back();
+			glm::mat4* lightMatrix = &lightMatrices.emplace_back();
+
+			return { lightData, lightMatrix, lightIndex };
+		}
+
+		cgc::strong_ptr<BoneMatrices> NullFactory::LoadBoneMatrices(uint matrixCount)
+		{
+			cgc::strong_ptr<NullBoneMatrices> matrices;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				matrices = boneMatrices.emplace(this, matrixCount);
+			}
+
+			allocatedMemory += matrixCount * sizeof(BoneMatrices::value_type);
+
+			return matrices;
+		}
+
+		cgc::strong_ptr<IUBO> NullFactory::LoadUBO(void* data, int bufferSize, std::string_view bindingName, UPLOAD_TYPE usageType)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			auto emplaced = uboIndices.try_emplace(RT_HASH(bindingName), uint(uboIndices.size()));
+
+			if (bufferSize > 0)
+			{
+				allocatedMemory += bufferSize;
+				if (data)
+					uploadedBytes += bufferSize;
+			}
+
+			return ubos.emplace(this, nextId++, emplaced.first->second, bindingName, uint(std::max(bufferSize, 0)));
+		}
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <rapidjson/document.h>
+#include <cppu/cgc/m_array.h>
+
+#include "../../RenderingFactory.h"
+
+#include "../../Objects/Buffer.h"
+#include "../../Objects/Texture1D.h"
+#include "../../Objects/Texture2D.h"
+#include "../../Objects/Texture3D.h"
+#include "../../Objects/TextureCube.h"
+#include "../../Objects/LightObject.h"
+
+#include "./Objects/NullBuffers.h"
+#include "./Objects/NullMaterial.h"
+#include "./Objects/NullRenderObject.h"
+
+namespace Esteem
+{
+	namespace Null
+	{
+		/// \brief Rendering factory without a GPU, creates CPU-side stand-ins for all resources
+		/// Nothing is queued, every resource is usable as soon as it is returned. Sizes of the data that
+		/// would have been sent to the GPU are summed up, see GetUploadedBytes() and GetAllocatedMemory().
+		class NullFactory : public RenderingFactory
+		{
+		private:
+			std::mutex lock;
+			std::atomic<std::size_t> allocatedMemory;
+			std::atomic<std::size_t> uploadedBytes;
+			std::atomic<uint> nextId;
+
+			std::deque<LightData> lightsData;
+			std::deque<glm::mat4> lightMatrices;
+
+			cgc::m_array<Buffer> buffers;
+			cgc::m_array<Texture1D> texture1Ds;
+			std::unordered_map<hash_t, cgc::strong_ptr<Texture1D>> originalTexture1Ds;
+			cgc::m_array<Texture2D> texture2Ds;
+			std::unordered_map<hash_t, cgc::strong_ptr<Texture2D>> originalTexture2Ds;
+			cgc::m_array<TextureCube> textureCubes;
+			std::unordered_map<hash_t, cgc::strong_ptr<TextureCube>> originalTextureCubes;
+
+			std::unordered_map<hash_t, uint> uboIndices;
+			cgc::m_array<NullUBO> ubos;
+			cgc::m_array<NullVBO> vbos;
+			cgc::m_array<NullEBO> ebos;
+			cgc::m_array<NullBoneMatrices> boneMatrices;
+			cgc::m_array<NullRenderObject> renderObjects;
+
+			cgc::m_array<NullShader> shaders;
+			std::unordered_map<hash_t, cgc::strong_ptr<NullShader>> shadersByPath;
+			cgc::m_array<NullMaterial> materials;
+			std::unordered_map<hash_t, cgc::strong_ptr<NullMaterial>> materialsByPath;
+
+			void CreateMeshBuffers(AbstractMesh& mesh, const IMeshData& meshData, TRIANGLE_TYPE triangleType);
+
+			static std::size_t GetTextureSize(const glm::uvec2& size, bool mipmapped);
+
+		public:
+			NullFactory();
+			virtual ~NullFactory();
+
+			// disable copy
+			NullFactory(const NullFactory&) = delete;
+			void operator=(const NullFactory&) = delete;
+
+			virtual void Initialize() { }
+			virtual void ReInitialize() { }
+			virtual bool EqualsSearch(std::string_view search) { return false; }
+
+			virtual std::size_t GetAllocatedMemory() const { return allocatedMemory; }
+
+			/// \brief total amount of bytes that would have been sent to the GPU since creation
+			inline std::size_t GetUploadedBytes() const { return uploadedBytes; }
+			inline void AddUploadedBytes(std::size_t size) { uploadedBytes += size; }
+
+			virtual cgc::strong_ptr<IShader> LoadShader(std::string_view path);
+			cgc::strong_ptr<NullShader> LoadNullShader(std::string_view path);
+
+			virtual cgc::strong_ptr<Material> CreateMaterial(std::string_view path, const rapidjson::Document& json,
+				const std::vector<cgc::strong_ptr<Material>>& baseMaterials, TEXTURE_FILTER textureFlter = Settings::textureFlter);
+			virtual cgc::strong_ptr<Material> GetMaterial(std::string_view path);
+
+			virtual cgc::strong_ptr<Buffer> LoadBuffer(const ConstructSettings::Buffer& settings, const std::string& name, void* data, std::size_t offset, std::size_t size);
+			virtual cgc::strong_ptr<Texture1D> LoadTexture1D(const ConstructSettings::Texture1D& settings, const cgc::strong_ptr<Image>& image = cgc::strong_ptr<Image>());
+			virtual cgc::strong_ptr<Texture1D> LoadTexture1D(const ConstructSettings::Texture1D& settings, const std::string& name);
+			virtual cgc::strong_ptr<Texture2D> LoadTexture2D(const ConstructSettings::Texture2D& settings, const cgc::strong_ptr<Image>& image = cgc::strong_ptr<Image>());
+			virtual cgc::strong_ptr<Texture2D> LoadTexture2D(const ConstructSettings::Texture2D& settings, const std::string& name);
+			virtual cgc::strong_ptr<Texture3D> LoadTexture3D(const ConstructSettings::Texture3D& settings, const std::string& name, const std::vector<cgc::strong_ptr<Image>>& images = std::vector<cgc::strong_ptr<Image>>());
+			virtual cgc::strong_ptr<TextureCube> LoadTextureCube(const ConstructSettings::TextureCube& settings, const std::string& name, const std::vector<cgc::strong_ptr<Image>>& images = std::vector<cgc::strong_ptr<Image>>());
+
+			virtual cgc::strong_ptr<Texture2D> GetTexture2D(const std::string& name);
+
+			virtual void UpdateBuffer(const cgc::strong_ptr<Buffer>& buffer, const void* data, std::size_t offset, std::size_t size, bool enlarge = false);
+			virtual void UpdateTexture1D(const cgc::strong_ptr<Texture1D>& texture, const cgc::strong_ptr<Image>& image, uint offset = 0);
+			virtual void UpdateTexture2D(const cgc::strong_ptr<Texture2D>& texture, const cgc::strong_ptr<Image>& image, const glm::uvec2& offset = glm::uvec2(0, 0));
+
+			virtual cgc::strong_ptr<RenderObject> LoadRenderObject(const cgc::strong_ptr<AbstractMesh>& mesh, const cgc::strong_ptr<Material>& material, UPLOAD_TYPE uploadType = UPLOAD_TYPE::STATIC, TRIANGLE_TYPE triangleType = TRIANGLE_TYPE::TRIANGLES);
+			virtual cgc::strong_ptr<RenderObject> LoadRenderObject(const cgc::strong_ptr<RenderObject>& copy);
+			virtual void UpdateMesh(const cgc::strong_ptr<AbstractMesh>& mesh, const cgc::strong_ptr<IMeshData>& meshData);
+
+			virtual LightRenderData LoadLight();
+			virtual cgc::strong_ptr<BoneMatrices> LoadBoneMatrices(uint matrixCount);
+
+			virtual cgc::strong_ptr<IUBO> LoadUBO(void* data, int bufferSize, std::string_view bindingName, UPLOAD_TYPE usageType = UPLOAD_TYPE::STATIC) override;
+
+			inline const std::deque<LightData>& GetLightsData() const { return lightsData; }
+
+			/// \brief nothing is ever queued, kept for the interface
+			virtual void HandleQueue() { }
+		};
+	}
+}
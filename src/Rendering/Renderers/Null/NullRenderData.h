@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "../../Objects/IRenderData.h"
+#include "../../Objects/RenderObject.h"
+#include "Rendering/Objects/RenderCamera.h"
+#include "Rendering/Objects/LightObject.h"
+
+#include <cppu/cgc/pointers.h>
+
+namespace Esteem
+{
+	namespace Null
+	{
+		class NullRenderData : public IRenderData
+		{
+		private:
+			RenderList renderList;
+			const std::vector<LightRenderData>* lights;
+			const std::vector<ShadowCasterList>* shadowCasters;
+			cgc::strong_ptr<Camera> renderCamera;
+
+		public:
+			NullRenderData()
+				: lights(nullptr)
+				, shadowCasters(nullptr)
+			{ }
+
+			virtual RenderList& GetAbstractRenderList();
+			const RenderList& GetRenderList() const;
+
+			virtual const std::vector<LightRenderData>* GetLights() const;
+			virtual const cgc::strong_ptr<Camera>& GetCamera() const;
+			virtual const std::vector<ShadowCasterList>* GetShadowCasters() const;
+
+			virtual void SetRenderList(const RenderList& renderList);
+			virtual void SetLights(const std::vector<LightRenderData>* lights);
+			virtual void SetShadowCasters(const std::vector<ShadowCasterList>* shadowCasters);
+			virtual void SetRenderCamera(const cgc::strong_ptr<Camera>& renderCamera);
+		};
+	}
+}
+
+#include "./NullRenderData.inl"
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "./NullRenderData.h"
+
+namespace Esteem
+{
+	namespace Null
+	{
+		inline RenderList& NullRenderData::GetAbstractRenderList()
+		{
+			return renderList;
+		}
+
+		inline const RenderList& NullRenderData::GetRenderList() const
+		{
+			return renderList;
+		}
+
+		inline const std::vector<LightRenderData>* NullRenderData::GetLights() const
+		{
+			return lights;
+		}
+
+		inline const cgc::strong_ptr<Camera>& NullRenderData::GetCamera() const
+		{
+			return renderCamera;
+		}
+
+		inline void NullRenderData::SetRenderList(const RenderList& renderList)
+		{
+			this->renderList = renderList;
+		}
+
+		inline const std::vector<ShadowCasterList>* NullRenderData::GetShadowCasters() const
+		{
+			return shadowCasters;
+		}
+
+		inline void NullRenderData::SetLights(const std::vector<LightRenderData>* lights)
+		{
+			this->lights = lights;
+		}
+
+		inline void NullRenderData::SetShadowCasters(const std::vector<ShadowCasterList>* shadowCasters)
+		{
+			this->shadowCasters = shadowCasters;
+		}
+
+		inline void NullRenderData::SetRenderCamera(const cgc::strong_ptr<Camera>& renderCamera)
+		{
+			this->renderCamera = renderCamera;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#include "NullRenderer.h"
+
+#include "Utils/Debug.h"
+#include "Utils/Diagnostics.h"
+#include "Utils/Profiler.h"
+#include "World/World.h"
+
+namespace Esteem
+{
+	namespace Null
+	{
+		NullRenderer::NullRenderer(glm::uvec2 screenSize)
+			: Renderer(screenSize)
+			, world(nullptr)
+			, statistics()
+		{ }
+
+		void NullRenderer::ThreadInitialize()
+		{
+			// same uniform buffers as the OpenGL renderer so the uploaded bytes compare
+			lightsUBO = factory.LoadUBO(nullptr, 256 * sizeof(LightData), "lightsUB");
+			cameraUBO = factory.LoadUBO(nullptr, sizeof(RenderCameraData), "cameraUB");
+
+			Debug::Log(" -------------------------------------------------------------------------------------");
+			Debug::Log("| RENDERER: \t\t\t\tNullRenderer (no GPU)");
+			Debug::Log(" -------------------------------------------------------------------------------------");
+		}
+
+		void NullRenderer::ReInitialize()
+		{
+			factory.ReInitialize();
+		}
+
+		void NullRenderer::RenderFrame()
+		{
+			ESTEEM_PROFILE("NullRenderer::RenderFrame");
+
+			std::size_t uploadedBefore = factory.GetUploadedBytes();
+			statistics = FrameStatistics();
+
+			const NullRenderData& renderData = *static_cast<NullRenderData*>(world->GetRenderData());
+			cameraUBO->UpdateBuffer(&renderData.GetCamera()->GetRenderCameraData()->data, sizeof(RenderCameraData));
+
+			if (const std::vector<LightRenderData>* lights = renderData.GetLights())
+				lightsUBO->UpdateBuffer(nullptr, uint(lights->size() * sizeof(LightData)));
+
+			const Material* activeMaterial = nullptr;
+			const IShader* activeShader = nullptr;
+
+			for (const auto& renderObjects : renderData.GetRenderList())
+			{
+				for (const RenderObject* renderObject : renderObjects)
+				{
+					const Material* material = renderObject->GetMaterial().ptr();
+					if (material != activeMaterial)
+					{
+						activeMaterial = material;
+						++statistics.materialSwitches;
+
+						const IShader* shader = static_cast<const NullMaterial*>(material)->GetNullShader().ptr();
+						if (shader != activeShader)
+						{
+							activeShader = shader;
+							++statistics.shaderSwitches;
+						}
+					}
+
+					// model matrix uniform
+					factory.AddUploadedBytes(sizeof(glm::mat4));
+
+					if (const NullEBO* ebo = static_cast<const NullEBO*>(renderObject->GetMesh()->GetEBO().ptr()))
+						statistics.triangles += ebo->GetIndicesCount() / 3 * renderObject->GetInstanceCount();
+
+					++statistics.drawCalls;
+					Diagnostics::drawCalls++;
+				}
+			}
+
+			statistics.uploadedBytes = factory.GetUploadedBytes() - uploadedBefore;
+		}
+
+		void NullRenderer::RenderDevObjects(const std::vector<DevRenderObject>& renderObjects)
+		{
+			// one line list per object
+			statistics.drawCalls += uint(renderObjects.size());
+			Diagnostics::drawCalls += uint(renderObjects.size());
+		}
+
+		void NullRenderer::SetWorld(World* world)
+		{
+			this->world = world;
+			if (!world->GetRenderData())
+				world->SetRenderData(std::make_unique<NullRenderData>());
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../../Renderer.h"
+
+#include <thread>
+
+#include "./NullFactory.h"
+#include "./NullRenderData.h"
+
+namespace Esteem
+{
+	namespace Null
+	{
+		/// \brief Renderer without a GPU, for headless simulation and benchmarking of the CPU side of a frame
+		/// The render list produced by culling is walked like a real backend would, draw calls, material
+		/// switches and triangles are counted and uniform uploads are added to the factory's uploaded bytes.
+		class NullRenderer : public Renderer
+		{
+		public:
+			struct FrameStatistics
+			{
+				uint drawCalls;
+				uint materialSwitches;
+				uint shaderSwitches;
+				std::size_t triangles;
+				std::size_t uploadedBytes;
+			};
+
+		private:
+			NullFactory factory;
+			World* world;
+
+			cgc::strong_ptr<IUBO> lightsUBO;
+			cgc::strong_ptr<IUBO> cameraUBO;
+
+			FrameStatistics statistics;
+
+		public:
+			NullRenderer(glm::uvec2 screenSize);
+
+			// disable copy
+			NullRenderer(const NullRenderer&) = delete;
+			void operator=(const NullRenderer&) = delete;
+
+			virtual void Initialize() override { }
+			virtual void ThreadInitialize() override;
+			virtual void ReInitialize() override;
+
+			virtual void RenderFrame() override;
+			virtual void RenderDevObjects(const std::vector<DevRenderObject>& renderObjects) override;
+
+			/// \brief there is no GPU time to measure
+			virtual uint GetRenderTime() override { return 0; }
+
+			virtual void SetThreadID(const std::thread::id& id) override { }
+			virtual void SetWorld(World* world) override;
+
+			/// \brief statistics of the last RenderFrame()
+			inline const FrameStatistics& GetFrameStatistics() const { return statistics; }
+
+			inline NullFactory& GetNullFactory() { return factory; }
+			virtual RenderingFactory& GetFactory() override { return factory; }
+			virtual const RenderingFactory& GetFactory() const override { return factory; }
+		};
+	}
+}
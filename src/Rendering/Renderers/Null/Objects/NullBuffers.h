@@ -0,0 +1,100 @@
+#pragma once
+
+#include "stdafx.h"
+#include <string>
+#include <cppu/cgc/constructor.h>
+
+#include "../../../Objects/IVBO.h"
+#include "../../../Objects/IEBO.h"
+#include "../../../Objects/IUBO.h"
+#include "../../../rtypes.h"
+
+namespace Esteem
+{
+	namespace Null
+	{
+		class NullFactory;
+
+		/// \brief CPU-side stand-in for a vertex buffer, only remembers what would have been uploaded
+		class NullVBO : public IVBO
+		{
+		friend class NullFactory;
+		friend class cgc::constructor;
+
+		private:
+			uint id;
+			std::size_t bufferSize;
+			std::size_t vertexCount;
+
+			NullVBO(uint id, std::size_t bufferSize, std::size_t vertexCount)
+				: id(id)
+				, bufferSize(bufferSize)
+				, vertexCount(vertexCount)
+			{ }
+
+		public:
+			virtual uint GetID() const { return id; }
+			inline std::size_t GetBufferSize() const { return bufferSize; }
+			inline std::size_t GetVertexCount() const { return vertexCount; }
+
+			virtual void AddVertexAttribute(std::string attribName, uint size, uint type, uint stride, void* offset, Mapping mapping = IVBO::Mapping::FLOAT) { }
+			virtual void RemoveVertexAttribute(std::string attribName) { }
+		};
+
+		/// \brief CPU-side stand-in for an element buffer
+		class NullEBO : public IEBO
+		{
+		friend class NullFactory;
+		friend class cgc::constructor;
+
+		private:
+			uint id;
+			std::size_t bufferSize;
+			std::size_t indices;
+			TRIANGLE_TYPE triangleType;
+
+			NullEBO(uint id, std::size_t bufferSize, std::size_t indices, TRIANGLE_TYPE triangleType)
+				: id(id)
+				, bufferSize(bufferSize)
+				, indices(indices)
+				, triangleType(triangleType)
+			{ }
+
+		public:
+			virtual uint GetID() const { return id; }
+			inline std::size_t GetBufferSize() const { return bufferSize; }
+			inline std::size_t GetIndicesCount() const { return indices; }
+			inline TRIANGLE_TYPE GetRenderType() const { return triangleType; }
+		};
+
+		/// \brief CPU-side stand-in for a uniform buffer, updates are counted as uploaded bytes on the factory
+		class NullUBO : public IUBO
+		{
+		friend class NullFactory;
+		friend class cgc::constructor;
+
+		private:
+			NullFactory* factory;
+			uint id;
+			uint bindingIndex;
+			uint size;
+			std::string bindingName;
+
+			NullUBO(NullFactory* factory, uint id, uint bindingIndex, std::string_view bindingName, uint size)
+				: factory(factory)
+				, id(id)
+				, bindingIndex(bindingIndex)
+				, size(size)
+				, bindingName(bindingName)
+			{ }
+
+		public:
+			virtual uint GetID() const { return id; }
+			virtual uint GetBindingIndex() const { return bindingIndex; }
+			virtual const std::string& GetBindingName() const { return bindingName; }
+			inline uint GetSize() const { return size; }
+
+			virtual void UpdateBuffer(const void* data, uint size);
+		};
+	}
+}
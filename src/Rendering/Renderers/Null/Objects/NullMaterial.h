@@ -0,0 +1,58 @@
+#pragma once
+
+#include "stdafx.h"
+#include <string>
+#include <cppu/cgc/pointers.h>
+
+#include "Rendering/Objects/IShader.h"
+#include "Rendering/Objects/Material.h"
+
+namespace Esteem
+{
+	namespace Null
+	{
+		class NullFactory;
+
+		/// \brief shader stand-in, nothing is compiled, only the name is kept
+		class NullShader : public IShader
+		{
+		friend class NullFactory;
+		friend class cgc::constructor;
+
+		private:
+			uint id;
+			std::string path;
+
+			NullShader(uint id, std::string_view path)
+				: id(id)
+				, path(path)
+			{ }
+
+		public:
+			inline uint GetID() const { return id; }
+			inline const std::string& GetPath() const { return path; }
+		};
+
+		class NullMaterial : public Material
+		{
+		friend class NullFactory;
+		friend class cgc::constructor;
+
+		private:
+			uint id;
+			cgc::strong_ptr<NullShader> shader;
+
+			NullMaterial(uint id, std::string_view path, std::string_view name)
+				: Material(path, name)
+				, id(id)
+			{ }
+
+		public:
+			inline uint GetID() const { return id; }
+			inline const cgc::strong_ptr<NullShader>& GetNullShader() const { return shader; }
+			virtual cgc::strong_ptr<IShader> GetShader() const { return cgc::static_pointer_cast<IShader>(shader); }
+
+			virtual void Bind() { }
+		};
+	}
+}
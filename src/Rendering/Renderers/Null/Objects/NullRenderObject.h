@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../../../Objects/RenderObject.h"
+#include "../../../Objects/BoneMatrices.h"
+
+namespace Esteem
+{
+	namespace Null
+	{
+		class NullFactory;
+
+		/// \brief render object that is initialized as soon as it is created, there is no upload to wait for
+		class NullRenderObject : public RenderObject
+		{
+		friend class NullFactory;
+		friend class cgc::constructor;
+
+		private:
+			NullRenderObject(const cgc::strong_ptr<AbstractMesh>& mesh, const cgc::strong_ptr<Material>& material)
+				: RenderObject(material, mesh)
+			{
+				initialized = true;
+
+				// same render order as the OpenGL render object, so culling fills the same lists
+				isTranslucent = material->IsTranslucent();
+
+				if (material->IsTranslucent())
+					SetRenderOrder(RenderOrder::TRANSLUCENT);
+				else if (material->IsDoubleSided())
+					SetRenderOrder(RenderOrder::OPAQUE_DOUBLE_SIDED);
+			}
+		};
+
+		/// \brief bone matrices stored in CPU memory only, every update is counted as uploaded bytes on the factory
+		class NullBoneMatrices : public BoneMatrices
+		{
+		friend class NullFactory;
+		friend class cgc::constructor;
+
+		private:
+			NullFactory* factory;
+			std::vector<value_type> storage;
+
+			NullBoneMatrices(NullFactory* factory, uint size)
+				: BoneMatrices(nullptr, 0, size)
+				, factory(factory)
+				, storage(size, value_type(1.f))
+			{
+				matrices = storage.data();
+			}
+
+		public:
+			virtual void UpdateMatrices();
+			virtual void UpdateMatrices(const value_type* matrices, size_t size, size_t offset);
+			virtual void UpdateMatrices(const value_type* matrices);
+		};
+	}
+}
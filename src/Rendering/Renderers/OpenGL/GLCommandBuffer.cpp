@@ -0,0 +1,206 @@
+#include "GLCommandBuffer.h"
+
+#include <GL/glew.h>
+
+#include "Utils/Diagnostics.h"
+#include "./Objects/OpenGLRenderObject.h"
+#include "./Objects/OpenGLBoneMatrices.h"
+#include "./Objects/OpenGLShader.h"
+#include "./Objects/VAO.h"
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		namespace
+		{
+			std::size_t GetIndexSize(uint indexType)
+			{
+				switch (indexType)
+				{
+				case GL_UNSIGNED_BYTE:
+					return 1;
+				case GL_UNSIGNED_SHORT:
+					return 2;
+				default:
+					return 4;
+				}
+			}
+		}
+
+		GLCommandBuffer::GLCommandBuffer()
+			: indirectBuffer(0)
+			, drawDataBuffer(0)
+			, drawDataTexture(0)
+			, multiDraw(false)
+		{ }
+
+		GLCommandBuffer::~GLCommandBuffer()
+		{
+			if (drawDataTexture != 0)
+				glDeleteTextures(1, &drawDataTexture);
+
+			if (drawDataBuffer != 0)
+				glDeleteBuffers(1, &drawDataBuffer);
+
+			if (indirectBuffer != 0)
+				glDeleteBuffers(1, &indirectBuffer);
+		}
+
+		void GLCommandBuffer::Initialize()
+		{
+			multiDraw = GLEW_ARB_multi_draw_indirect != 0;
+			if (multiDraw)
+				glGenBuffers(1, &indirectBuffer);
+
+			glGenBuffers(1, &drawDataBuffer);
+			glBindBuffer(GL_TEXTURE_BUFFER, drawDataBuffer);
+			glBufferData(GL_TEXTURE_BUFFER, sizeof(CommandList::DrawData), nullptr, GL_STREAM_DRAW);
+
+			glGenTextures(1, &drawDataTexture);
+			glBindTexture(GL_TEXTURE_BUFFER, drawDataTexture);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, drawDataBuffer);
+
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		}
+
+		void GLCommandBuffer::Clear()
+		{
+			draws.clear();
+			drawData.clear();
+		}
+
+		uint32_t GLCommandBuffer::Add(const CommandList& list)
+		{
+			uint32_t offset = uint32_t(draws.size());
+			draws.insert(draws.end(), list.GetDraws().begin(), list.GetDraws().end());
+			drawData.insert(drawData.end(), list.GetDrawData().begin(), list.GetDrawData().end());
+
+			return offset;
+		}
+
+		void GLCommandBuffer::Upload()
+		{
+			if (draws.empty())
+				return;
+
+			// orphan last frame's storage, so the upload doesn't wait for draws that still read it
+			glBindBuffer(GL_TEXTURE_BUFFER, drawDataBuffer);
+			glBufferData(GL_TEXTURE_BUFFER, drawData.size() * sizeof(CommandList::DrawData), nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_TEXTURE_BUFFER, 0, drawData.size() * sizeof(CommandList::DrawData), drawData.data());
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+			// without multi draws the draws are read from memory
+			if (multiDraw)
+			{
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+				glBufferData(GL_DRAW_INDIRECT_BUFFER, draws.size() * sizeof(CommandList::DrawIndirect), nullptr, GL_STREAM_DRAW);
+				glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, draws.size() * sizeof(CommandList::DrawIndirect), draws.data());
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			}
+		}
+
+		void GLCommandBuffer::Execute(const CommandList& list, uint32_t offset, const OpenGLShader& shader) const
+		{
+			if (list.GetBatches().empty())
+				return;
+
+			// shaders that don't read drawData take the matrix from the ModelMatrix uniform, so they can't draw indirectly
+			bool indirect = multiDraw && shader.HasUniform(CT_HASH("drawData"));
+			if (indirect)
+			{
+				glActiveTexture(GL_TEXTURE0 + DrawDataUnit);
+				glBindTexture(GL_TEXTURE_BUFFER, drawDataTexture);
+				shader.SetUniform(CT_HASH("drawData"), int(DrawDataUnit));
+
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+			}
+			else
+				shader.SetUniform(CT_HASH("drawOffset"), -1);
+
+			for (const CommandList::Batch& batch : list.GetBatches())
+			{
+				const CommandList::State& state = batch.state;
+				glBindVertexArray(state.vertexArray);
+
+				if (state.boneSize != 0)
+					glBindBufferRange(GL_UNIFORM_BUFFER, state.boneBinding, state.boneBuffer, state.boneOffset, state.boneSize);
+				else if (state.boneBuffer != 0)
+					glBindBufferBase(GL_UNIFORM_BUFFER, state.boneBinding, state.boneBuffer);
+
+				shader.SetUniform(CT_HASH("animations"), state.boneBuffer != 0 ? 1 : 0);
+
+				uint32_t first = offset + batch.first;
+				if (indirect)
+				{
+					const void* indirectOffset = reinterpret_cast<const void*>(std::size_t(first) * sizeof(CommandList::DrawIndirect));
+					shader.SetUniform(CT_HASH("drawOffset"), int(first));
+
+					if (state.indexType != 0)
+						glMultiDrawElementsIndirect(state.mode, state.indexType, indirectOffset, batch.count, sizeof(CommandList::DrawIndirect));
+					else
+						glMultiDrawArraysIndirect(state.mode, indirectOffset, batch.count, sizeof(CommandList::DrawIndirect));
+
+					Diagnostics::drawCalls++;
+				}
+				else
+				{
+					for (uint32_t i = first; i < first + batch.count; ++i)
+					{
+						const CommandList::DrawIndirect& draw = draws[i];
+						shader.SetUniform(CT_HASH("ModelMatrix"), drawData[i].modelMatrix);
+
+						if (state.indexType != 0)
+							glDrawElementsInstanced(state.mode, draw.count, state.indexType, reinterpret_cast<const void*>(draw.first * GetIndexSize(state.indexType)), draw.instanceCount);
+						else
+							glDrawArraysInstanced(state.mode, draw.first, draw.count, draw.instanceCount);
+
+						Diagnostics::drawCalls++;
+					}
+				}
+			}
+
+			if (indirect)
+			{
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+				shader.SetUniform(CT_HASH("drawOffset"), -1);
+			}
+		}
+
+		void GLCommandBuffer::Record(CommandList& list, const OpenGLRenderObject& renderObject)
+		{
+			cgc::raw_ptr<VAO> vao = renderObject.GetVAO();
+			cgc::raw_ptr<EBO> ebo = vao->GetEBO();
+
+			CommandList::State state = {};
+			CommandList::DrawIndirect draw = {};
+			state.vertexArray = vao->GetID();
+			draw.instanceCount = uint32_t(renderObject.GetInstanceCount());
+
+			if (ebo != nullptr)
+			{
+				state.mode = static_cast<uint>(ebo->GetRenderType());
+				state.indexType = ebo->GetIndicesType();
+				draw.count = ebo->GetIndicesCount();
+			}
+			else
+			{
+				cgc::raw_ptr<VBO> vbo = vao->GetVBO();
+				state.mode = static_cast<uint>(vbo->GetRenderType());
+				draw.count = uint32_t(vbo->GetVertexCount());
+			}
+
+			if (const OpenGLBoneMatrices* boneMatrices = static_cast<const OpenGLBoneMatrices*>(renderObject.boneMatrices.ptr()))
+			{
+				const OpenGLBoneMatrices::Binding& bones = boneMatrices->GetBinding();
+				state.boneBuffer = bones.buffer;
+				state.boneBinding = bones.index;
+				state.boneOffset = bones.offset;
+				state.boneSize = bones.size;
+			}
+
+			list.Draw(state, draw, { *renderObject.GetModelMatrix() });
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "stdafx.h"
+#include <vector>
+
+#include "Rendering/CommandList.h"
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		class OpenGLRenderObject;
+		class OpenGLShader;
+
+		/// \brief Replays command lists from one indirect buffer and one draw data buffer shared by all lists of a frame
+		/// Batches are drawn with glMultiDrawElementsIndirect when ARB_multi_draw_indirect is available and the bound shader
+		/// has a drawData samplerBuffer. Those shaders read the model matrix as 4 RGBA32F texels from drawData at
+		/// (drawOffset + gl_DrawIDARB) * 4. Otherwise the batches are drawn draw by draw with drawOffset at -1 and the
+		/// ModelMatrix uniform set per draw, like objects drawn without a command list.
+		class GLCommandBuffer
+		{
+		public:
+			/// \brief texture unit of the drawData samplerBuffer
+			static constexpr uint DrawDataUnit = 10;
+
+		private:
+			uint indirectBuffer;
+			uint drawDataBuffer;
+			uint drawDataTexture;
+			bool multiDraw;
+
+			std::vector<CommandList::DrawIndirect> draws;
+			std::vector<CommandList::DrawData> drawData;
+
+		public:
+			GLCommandBuffer();
+			~GLCommandBuffer();
+
+			// disable copy
+			GLCommandBuffer(const GLCommandBuffer&) = delete;
+			void operator=(const GLCommandBuffer&) = delete;
+
+			/// \brief create the buffers, needs the OpenGL context
+			void Initialize();
+
+			/// \brief start a new frame
+			void Clear();
+			/// \return offset of the list's draws in the shared buffers, pass it to Execute()
+			uint32_t Add(const CommandList& list);
+			/// \brief send the draws added since Clear() to OpenGL, before the first Execute() of the frame
+			void Upload();
+
+			/// \brief draw a list that was added this frame with the bound shader, leaves drawOffset at -1
+			/// \param offset what Add() returned for the list
+			void Execute(const CommandList& list, uint32_t offset, const OpenGLShader& shader) const;
+
+			inline bool IsMultiDraw() const { return multiDraw; }
+
+			/// \brief add the draw of the object as DrawRenderObject() would draw it, safe to call from job threads
+			static void Record(CommandList& list, const OpenGLRenderObject& renderObject);
+		};
+	}
+}
@@ -0,0 +1,104 @@
+#include "GLFrameRingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		GLFrameRingBuffer::GLFrameRingBuffer()
+			: id(0)
+			, memory(nullptr)
+			, fences()
+		{ }
+
+		GLFrameRingBuffer::~GLFrameRingBuffer()
+		{
+			for (GLsync& fence : fences)
+			{
+				if (fence != nullptr)
+					glDeleteSync(fence);
+			}
+
+			if (id != 0)
+			{
+				if (memory != nullptr)
+				{
+					glBindBuffer(GL_UNIFORM_BUFFER, id);
+					glUnmapBuffer(GL_UNIFORM_BUFFER);
+					glBindBuffer(GL_UNIFORM_BUFFER, 0);
+				}
+
+				glDeleteBuffers(1, &id);
+			}
+		}
+
+		bool GLFrameRingBuffer::Initialize(uint32_t size)
+		{
+			if (!GLEW_ARB_buffer_storage)
+			{
+				Debug::LogWarning("GLFrameRingBuffer: ARB_buffer_storage isn't supported, uniform buffers are updated one by one");
+				return false;
+			}
+
+			GLint alignment = 0;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+			// coherent, so writes are visible to the GPU without flushing
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+			glGenBuffers(1, &id);
+			glBindBuffer(GL_UNIFORM_BUFFER, id);
+			glBufferStorage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+			memory = glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+			if (memory == nullptr)
+			{
+				Debug::LogError("GLFrameRingBuffer: couldn't map ", std::to_string(size), " bytes");
+				return false;
+			}
+
+			allocator.Initialize(memory, size, RegionCount, uint32_t(alignment), this);
+			return true;
+		}
+
+		bool GLFrameRingBuffer::BindUniforms(uint index, const void* data, uint32_t size, uint32_t rangeSize)
+		{
+			FrameRingBuffer::Allocation allocation = allocator.Allocate(std::max(size, rangeSize));
+			if (!allocation.IsValid())
+				return false;
+
+			std::memcpy(allocation.data, data, size);
+			glBindBufferRange(GL_UNIFORM_BUFFER, index, id, allocation.offset, allocation.size);
+
+			return true;
+		}
+
+		void GLFrameRingBuffer::Signal(uint region)
+		{
+			if (fences[region] != nullptr)
+				glDeleteSync(fences[region]);
+
+			fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		void GLFrameRingBuffer::Wait(uint region)
+		{
+			GLsync& fence = fences[region];
+			if (fence == nullptr)
+				return;
+
+			// the first wait flushes, so the fence is sure to be reached
+			GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			while (result == GL_TIMEOUT_EXPIRED)
+				result = glClientWaitSync(fence, 0, 1000000);
+
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "stdafx.h"
+#include <GL/glew.h>
+
+#include "Rendering/FrameRingBuffer.h"
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		/// \brief FrameRingBuffer over a persistently mapped buffer, the regions are guarded by sync objects
+		/// Without ARB_buffer_storage nothing is mapped, every allocation fails and the callers upload to their own buffers.
+		class GLFrameRingBuffer : private FrameRingBuffer::Fence
+		{
+		public:
+			/// \brief frames the CPU may be ahead of the GPU
+			static constexpr uint RegionCount = 3;
+
+		private:
+			uint id;
+			void* memory;
+			GLsync fences[RegionCount];
+			FrameRingBuffer allocator;
+
+			virtual void Signal(uint region);
+			virtual void Wait(uint region);
+
+		public:
+			GLFrameRingBuffer();
+			~GLFrameRingBuffer();
+
+			// disable copy
+			GLFrameRingBuffer(const GLFrameRingBuffer&) = delete;
+			void operator=(const GLFrameRingBuffer&) = delete;
+
+			/// \return false when persistent mapping isn't supported
+			bool Initialize(uint32_t size);
+
+			inline void BeginFrame() { allocator.BeginFrame(); }
+			/// \brief after the last command that reads this frame's allocations
+			inline void EndFrame() { allocator.EndFrame(); }
+
+			/// \brief copy the data into this frame's region and bind it to the uniform buffer binding index
+			/// \param rangeSize bytes to bind, at least the size of the uniform block, when it's larger than the data
+			/// \return false when it didn't fit, nothing is bound then
+			bool BindUniforms(uint index, const void* data, uint32_t size, uint32_t rangeSize = 0);
+
+			inline FrameRingBuffer& GetAllocator() { return allocator; }
+			inline const FrameRingBuffer& GetAllocator() const { return allocator; }
+			inline uint GetID() const { return id; }
+		};
+	}
+}
@@ -0,0 +1,181 @@
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		namespace
+		{
+			/// \brief never a valid object name, so the first bind after an Invalidate() is always recorded
+			constexpr uint UnknownID = ~0u;
+		}
+
+		GLStateCache::GLStateCache()
+			: bindCount(0)
+			, skippedCount(0)
+			, drawCount(0)
+		{
+			Invalidate();
+		}
+
+		void GLStateCache::Invalidate()
+		{
+			program = UnknownID;
+			vertexArray = UnknownID;
+			cullFace = UnknownID;
+			uniforms = nullptr;
+
+			for (uint i = 0; i < TextureUnitCount; ++i)
+			{
+				textureTargets[i] = UnknownID;
+				textures[i] = UnknownID;
+			}
+
+			for (uint i = 0; i < UniformBufferCount; ++i)
+				uniformBuffers[i] = UnknownID;
+		}
+
+		bool GLStateCache::UseProgram(uint program)
+		{
+			if (this->program == program)
+			{
+				++skippedCount;
+				return false;
+			}
+
+			this->program = program;
+			uniforms = nullptr;
+
+			commands.push_back({ Command::Type::USE_PROGRAM, 0, 0, program, nullptr, nullptr });
+			++bindCount;
+			return true;
+		}
+
+		void GLStateCache::BindTexture(uint unit, uint target, uint texture)
+		{
+			if (textureTargets[unit] == target && textures[unit] == texture)
+			{
+				++skippedCount;
+				return;
+			}
+
+			textureTargets[unit] = target;
+			textures[unit] = texture;
+
+			commands.push_back({ Command::Type::BIND_TEXTURE, uint8(unit), target, texture, nullptr, nullptr });
+			++bindCount;
+		}
+
+		void GLStateCache::BindVertexArray(uint vertexArray)
+		{
+			if (this->vertexArray == vertexArray)
+			{
+				++skippedCount;
+				return;
+			}
+
+			this->vertexArray = vertexArray;
+
+			commands.push_back({ Command::Type::BIND_VERTEX_ARRAY, 0, 0, vertexArray, nullptr, nullptr });
+			++bindCount;
+		}
+
+		void GLStateCache::BindUniformBuffer(uint index, uint buffer, uint offset, uint size)
+		{
+			if (uniformBuffers[index] == buffer && uniformBufferOffsets[index] == offset && uniformBufferSizes[index] == size)
+			{
+				++skippedCount;
+				return;
+			}
+
+			uniformBuffers[index] = buffer;
+			uniformBufferOffsets[index] = offset;
+			uniformBufferSizes[index] = size;
+
+			commands.push_back({ Command::Type::BIND_UNIFORM_BUFFER, uint8(index), 0, buffer, nullptr, nullptr, offset, size });
+			++bindCount;
+		}
+
+		void GLStateCache::SetCullFace(bool enable)
+		{
+			if (cullFace == uint(enable))
+			{
+				++skippedCount;
+				return;
+			}
+
+			cullFace = uint(enable);
+
+			commands.push_back({ Command::Type::CULL_FACE, 0, uint(enable), 0, nullptr, nullptr });
+			++bindCount;
+		}
+
+		bool GLStateCache::SetUniforms(Callback callback, const void* data)
+		{
+			if (uniforms == data)
+			{
+				++skippedCount;
+				return false;
+			}
+
+			uniforms = data;
+
+			commands.push_back({ Command::Type::SET_UNIFORMS, 0, 0, 0, callback, data });
+			++bindCount;
+			return true;
+		}
+
+		void GLStateCache::Draw(Callback callback, const void* data)
+		{
+			commands.push_back({ Command::Type::DRAW, 0, 0, 0, callback, data });
+			++drawCount;
+		}
+
+		void GLStateCache::Execute() const
+		{
+			for (const Command& command : commands)
+			{
+				switch (command.type)
+				{
+				case Command::Type::USE_PROGRAM:
+					glUseProgram(command.id);
+					break;
+				case Command::Type::BIND_TEXTURE:
+					glActiveTexture(GL_TEXTURE0 + command.slot);
+					glBindTexture(command.target, command.id);
+					break;
+				case Command::Type::BIND_VERTEX_ARRAY:
+					glBindVertexArray(command.id);
+					break;
+				case Command::Type::BIND_UNIFORM_BUFFER:
+					if (command.size != 0)
+						glBindBufferRange(GL_UNIFORM_BUFFER, command.slot, command.id, command.offset, command.size);
+					else
+						glBindBufferBase(GL_UNIFORM_BUFFER, command.slot, command.id);
+					break;
+				case Command::Type::CULL_FACE:
+					if (command.target)
+						glEnable(GL_CULL_FACE);
+					else
+						glDisable(GL_CULL_FACE);
+					break;
+				case Command::Type::SET_UNIFORMS:
+				case Command::Type::DRAW:
+					if (command.callback)
+						command.callback(command.data);
+					break;
+				}
+			}
+		}
+
+		void GLStateCache::Clear()
+		{
+			commands.clear();
+			bindCount = 0;
+			skippedCount = 0;
+			drawCount = 0;
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "stdafx.h"
+#include <vector>
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		/// \brief Filters redundant binds and records what's left as a command stream
+		/// Nothing is sent to OpenGL until Execute(), so the recorded commands can be inspected without a context.
+		class GLStateCache
+		{
+		public:
+			static constexpr uint TextureUnitCount = 32;
+			static constexpr uint UniformBufferCount = 16;
+
+			/// \brief called by Execute() with the recorded data pointer, e.g.: to set uniforms or draw an object
+			typedef void(*Callback)(const void* data);
+
+			struct Command
+			{
+				enum class Type : uint8
+				{
+					USE_PROGRAM,
+					BIND_TEXTURE,
+					BIND_VERTEX_ARRAY,
+					BIND_UNIFORM_BUFFER,
+					CULL_FACE,
+					SET_UNIFORMS,
+					DRAW,
+				};
+
+				Type type;
+				/// \brief texture unit or uniform buffer binding index
+				uint8 slot;
+				/// \brief texture target, or 1 to enable face culling
+				uint target;
+				/// \brief program, texture, vertex array or buffer id
+				uint id;
+
+				Callback callback;
+				const void* data;
+
+				/// \brief bound range of a uniform buffer, size 0 binds the whole buffer
+				uint offset;
+				uint size;
+			};
+
+		private:
+			uint program;
+			uint vertexArray;
+			uint textureTargets[TextureUnitCount];
+			uint textures[TextureUnitCount];
+			uint uniformBuffers[UniformBufferCount];
+			uint uniformBufferOffsets[UniformBufferCount];
+			uint uniformBufferSizes[UniformBufferCount];
+			/// \brief 0 disabled, 1 enabled, anything else unknown
+			uint cullFace;
+			/// \brief last SET_UNIFORMS, uniforms live in the program so they are applied again after a program change
+			const void* uniforms;
+
+			std::vector<Command> commands;
+			uint bindCount;
+			uint skippedCount;
+			uint drawCount;
+
+		public:
+			GLStateCache();
+
+			// disable copy
+			GLStateCache(const GLStateCache&) = delete;
+			void operator=(const GLStateCache&) = delete;
+
+			/// \brief forget the known state, call when OpenGL was used outside of the cache
+			void Invalidate();
+			/// \brief the next SetUniforms is recorded even when its data didn't change
+			inline void InvalidateUniforms() { uniforms = nullptr; }
+
+			/// \return true when the program changed
+			bool UseProgram(uint program);
+			void BindTexture(uint unit, uint target, uint texture);
+			void BindVertexArray(uint vertexArray);
+			/// \param size of the range to bind, 0 binds the whole buffer
+			void BindUniformBuffer(uint index, uint buffer, uint offset = 0, uint size = 0);
+			void SetCullFace(bool enable);
+			/// \return true when the callback was recorded
+			bool SetUniforms(Callback callback, const void* data);
+			void Draw(Callback callback, const void* data);
+
+			/// \brief replay the recorded commands in order
+			void Execute() const;
+			/// \brief drop the recorded commands and counters, the known state is kept
+			void Clear();
+
+			inline const std::vector<Command>& GetCommands() const { return commands; }
+			/// \brief recorded commands that aren't draws
+			inline uint GetBindCount() const { return bindCount; }
+			/// \brief requests that matched the known state and weren't recorded
+			inline uint GetSkippedCount() const { return skippedCount; }
+			inline uint GetDrawCount() const { return drawCount; }
+		};
+	}
+}
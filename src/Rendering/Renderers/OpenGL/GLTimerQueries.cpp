@@ -0,0 +1,48 @@
+#include "GLTimerQueries.h"
+
+#include <GL/glew.h>
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		uint GLTimerQueries::Create()
+		{
+			GLuint query = 0;
+			glGenQueries(1, &query);
+			return query;
+		}
+
+		void GLTimerQueries::Destroy(uint query)
+		{
+			glDeleteQueries(1, &query);
+		}
+
+		void GLTimerQueries::Timestamp(uint query)
+		{
+			glQueryCounter(query, GL_TIMESTAMP);
+		}
+
+		bool GLTimerQueries::IsAvailable(uint query)
+		{
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+			return available != GL_FALSE;
+		}
+
+		uint64_t GLTimerQueries::GetResult(uint query)
+		{
+			GLuint64 result = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &result);
+			return result;
+		}
+
+		uint64_t GLTimerQueries::GetTime()
+		{
+			// the time the commands issued so far reach the GPU, doesn't wait for them to finish
+			GLint64 time = 0;
+			glGetInteger64v(GL_TIMESTAMP, &time);
+			return uint64_t(time);
+		}
+	}
+}
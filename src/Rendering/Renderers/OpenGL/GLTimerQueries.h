@@ -0,0 +1,23 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include "Rendering/GPUProfiler.h"
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		/// \brief GL_TIMESTAMP queries, polled through GL_QUERY_RESULT_AVAILABLE
+		class GLTimerQueries : public GPUProfiler::Queries
+		{
+		public:
+			virtual uint Create();
+			virtual void Destroy(uint query);
+			virtual void Timestamp(uint query);
+			virtual bool IsAvailable(uint query);
+			virtual uint64_t GetResult(uint query);
+			virtual uint64_t GetTime();
+		};
+	}
+}
@@ -0,0 +1,20 @@
+#include "InstanceBatcher.h"
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		InstanceBatcher::InstanceBatcher(uint threshold)
+			: threshold(threshold)
+		{ }
+
+		void InstanceBatcher::AddSingleDraws(uint32_t first, uint32_t count)
+		{
+			// grow the previous range, so draws that can't be instanced don't each get a batch
+			if (!batches.empty() && !batches.back().IsInstanced() && batches.back().first + batches.back().count == first)
+				batches.back().count += count;
+			else
+				batches.push_back({ first, count, SingleDraws });
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "stdafx.h"
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		/// \brief Splits a sorted list of draws into instanced batches and ranges that are drawn one by one
+		/// Runs of draws that share their state are packed into one instance buffer, a run shorter than
+		/// the threshold is left to single draws. Only the order of the draws is used, so it runs without OpenGL.
+		class InstanceBatcher
+		{
+		public:
+			/// \brief matrixOffset of a batch whose draws are done one by one
+			static constexpr uint32_t SingleDraws = ~0u;
+
+			struct Batch
+			{
+				/// \brief first draw of the batch in the order they were given
+				uint32_t first;
+				uint32_t count;
+				/// \brief first matrix of the batch in the instance buffer, or SingleDraws
+				uint32_t matrixOffset;
+
+				inline bool IsInstanced() const { return matrixOffset != SingleDraws; }
+			};
+
+		private:
+			std::vector<Batch> batches;
+			std::vector<glm::mat4> matrices;
+			uint threshold;
+
+			void AddSingleDraws(uint32_t first, uint32_t count);
+
+		public:
+			/// \param threshold least amount of draws in an instanced batch, 0 disables instancing
+			InstanceBatcher(uint threshold = 8);
+
+			// disable copy
+			InstanceBatcher(const InstanceBatcher&) = delete;
+			void operator=(const InstanceBatcher&) = delete;
+
+			inline void SetThreshold(uint threshold) { this->threshold = threshold; }
+			inline uint GetThreshold() const { return threshold; }
+
+			/// \brief replace the batches, they cover every draw in the given order
+			/// \param canInstance bool(size_t draw), false for draws that need their own uniforms, e.g.: animated ones
+			/// \param sameState bool(size_t a, size_t b), true when both draws can share one instanced draw
+			/// \param modelMatrix const glm::mat4&(size_t draw)
+			template<typename C, typename S, typename M>
+			void Build(std::size_t count, const C& canInstance, const S& sameState, const M& modelMatrix);
+
+			inline const std::vector<Batch>& GetBatches() const { return batches; }
+			/// \brief model matrices of all instanced batches, the contents of the instance buffer
+			inline const std::vector<glm::mat4>& GetMatrices() const { return matrices; }
+		};
+	}
+}
+
+#include "./InstanceBatcher.inl"
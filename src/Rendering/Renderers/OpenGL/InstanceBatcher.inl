@@ -0,0 +1,38 @@
+#pragma once
+
+#include "InstanceBatcher.h"
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		template<typename C, typename S, typename M>
+		void InstanceBatcher::Build(std::size_t count, const C& canInstance, const S& sameState, const M& modelMatrix)
+		{
+			batches.clear();
+			matrices.clear();
+
+			std::size_t i = 0;
+			while (i < count)
+			{
+				std::size_t end = i + 1;
+				if (threshold > 0 && canInstance(i))
+				{
+					while (end < count && canInstance(end) && sameState(i, end))
+						++end;
+				}
+
+				if (threshold > 0 && end - i >= threshold)
+				{
+					batches.push_back({ uint32_t(i), uint32_t(end - i), uint32_t(matrices.size()) });
+					for (std::size_t j = i; j < end; ++j)
+						matrices.push_back(modelMatrix(j));
+				}
+				else
+					AddSingleDraws(uint32_t(i), uint32_t(end - i));
+
+				i = end;
+			}
+		}
+	}
+}
@@ -3,6 +3,7 @@
 #include "Rendering/Objects/BoneMatrices.h"
 #include <cppu/cgc/pointers.h>
 #include "./UBO.h"
+#include "../GLFrameRingBuffer.h"
 
 namespace Esteem
 {
@@ -11,8 +12,21 @@ namespace Esteem
 		class OpenGLBoneMatrices : public BoneMatrices
 		{
 		friend class OpenGLFactory;
+		public:
+			/// \brief the uniform buffer range the matrices are read from this frame, size 0 binds the whole buffer
+			struct Binding
+			{
+				uint index;
+				uint buffer;
+				uint offset;
+				uint size;
+			};
+
 		private:
 			cgc::strong_ptr<UBO> ubo;
+			Binding binding;
+			/// \brief FrameRingBuffer::GetFrame() of the last Upload()
+			uint64_t uploadedFrame;
 
 			// TODO: (needs thought) maybe add a updater that only updates a piece of all the matrices?
 			void UpdateUBO();
@@ -20,11 +34,18 @@ namespace Esteem
 		public:
 			OpenGLBoneMatrices(value_type* matrices, uint index, uint size, const cgc::strong_ptr<UBO>& ubo);
 			
+			/// \brief mark the matrices as changed, they're uploaded when they're drawn
 			virtual void UpdateMatrices();
 			virtual void UpdateMatrices(const value_type* matrices, size_t size, size_t offset);
 			virtual void UpdateMatrices(const value_type* matrices);
 
+			/// \brief write the matrices to this frame's region, once per frame, or to our own buffer when the region is full
+			void Upload(GLFrameRingBuffer& frameRingBuffer);
+			/// \brief bind the range of the last Upload()
+			void Bind() const;
+
 			inline const cgc::strong_ptr<UBO>& GetUBO() const;
+			inline const Binding& GetBinding() const;
 		};
 	}
 }
@@ -8,11 +8,14 @@ namespace Esteem
 		inline OpenGLBoneMatrices::OpenGLBoneMatrices(value_type* matrices, uint index, uint size, const cgc::strong_ptr<UBO>& ubo)
 			: BoneMatrices(matrices, index, size)
 			, ubo(ubo)
+			, binding({ 0, 0, 0, 0 })
+			, uploadedFrame(0)
 		{}
 
 		inline void OpenGLBoneMatrices::UpdateMatrices()
 		{
-			UpdateUBO();
+			// our own buffer is out of date, the ring buffer gets the matrices every frame they're drawn
+			dirty = true;
 		}
 
 		inline void OpenGLBoneMatrices::UpdateMatrices(const value_type* matrices, size_t size, size_t offset)
@@ -32,6 +35,38 @@ namespace Esteem
 				ubo->UpdateBuffer(matrices, size * sizeof(value_type));
 		}
 
+		inline void OpenGLBoneMatrices::Upload(GLFrameRingBuffer& frameRingBuffer)
+		{
+			const FrameRingBuffer& allocator = frameRingBuffer.GetAllocator();
+			if (!ubo || (allocator.IsInFrame() && uploadedFrame == allocator.GetFrame()))
+				return;
+
+			uploadedFrame = allocator.GetFrame();
+
+			FrameRingBuffer::Allocation allocation = frameRingBuffer.GetAllocator().Write(matrices, uint32_t(size * sizeof(value_type)));
+			if (allocation.IsValid())
+				binding = { ubo->GetBindingIndex(), frameRingBuffer.GetID(), allocation.offset, allocation.size };
+			else
+			{
+				if (dirty)
+				{
+					UpdateUBO();
+					dirty = false;
+				}
+
+				binding = { ubo->GetBindingIndex(), ubo->GetID(), 0, 0 };
+			}
+		}
+
+		inline void OpenGLBoneMatrices::Bind() const
+		{
+			if (binding.size != 0)
+				glBindBufferRange(GL_UNIFORM_BUFFER, binding.index, binding.buffer, binding.offset, binding.size);
+			else if (binding.buffer != 0)
+				glBindBufferBase(GL_UNIFORM_BUFFER, binding.index, binding.buffer);
+		}
+
 		inline const cgc::strong_ptr<UBO>& OpenGLBoneMatrices::GetUBO() const { return ubo; }
+		inline const OpenGLBoneMatrices::Binding& OpenGLBoneMatrices::GetBinding() const { return binding; }
 	}
 }
@@ -1,5 +1,6 @@
 #include "./OpenGLMaterial.h"
 #include "../OpenGLFactory.h"
+#include "../GLStateCache.h"
 
 namespace Esteem
 {
@@ -58,5 +59,30 @@ namespace Esteem
 			for (auto it = activeUniformValues.begin(); it != activeUniformValues.end(); ++it)
 				it->second.func(it->second.GetVariable()->index, &it->second.value[0]);
 		}
+
+		void OpenGLMaterial::ApplyUniforms() const
+		{
+			ApplySamplerUniforms(buffers, *shader);
+
+			for (auto it = activeUniformValues.begin(); it != activeUniformValues.end(); ++it)
+				it->second.func(it->second.GetVariable()->index, &it->second.value[0]);
+		}
+
+		void OpenGLMaterial::BindTextures(const Buffers& buffers, GLStateCache& cache)
+		{
+			const auto* data = buffers.data.data();
+			for (uint i = 0; i < buffers.texture2DSize; ++i)
+			{
+				uint target = i < buffers.bufferSize ? GL_TEXTURE_BUFFER : i < buffers.texture1DSize ? GL_TEXTURE_1D : GL_TEXTURE_2D;
+				cache.BindTexture(i, target, data[i].buffer->GetID());
+			}
+		}
+
+		void OpenGLMaterial::ApplySamplerUniforms(const Buffers& buffers, const OpenGLShader& shader)
+		{
+			const auto* data = buffers.data.data();
+			for (uint i = 0; i < buffers.texture2DSize; ++i)
+				shader.SetUniform(data[i].hash, int(i));
+		}
 	}
 }
\ No newline at end of file
@@ -18,6 +18,7 @@ namespace Esteem
 	{
 		class OpenGLFactory;
 		class UBO;
+		class GLStateCache;
 
 		class OpenGLMaterial : public Material
 		{
@@ -55,6 +56,15 @@ namespace Esteem
 			}
 
 			virtual void Bind() const;
+
+			/// \brief record the material's textures, the sampler uniforms are set by ApplyUniforms()
+			inline void BindTextures(GLStateCache& cache) const { BindTextures(buffers, cache); }
+			/// \brief set the sampler and value uniforms on the bound program
+			void ApplyUniforms() const;
+
+			/// \brief buffers and textures take the units from 0 up, in the order they are stored in
+			static void BindTextures(const Buffers& buffers, GLStateCache& cache);
+			static void ApplySamplerUniforms(const Buffers& buffers, const OpenGLShader& shader);
 		};
 
 	}
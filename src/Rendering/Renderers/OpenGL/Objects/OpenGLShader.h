@@ -83,6 +83,8 @@ namespace Esteem
 			
 			Variable* GetAttributeVariable(const std::string& attribName);
 			Variable* GetUniformVariable(std::size_t attribName);
+			/// \brief true when the uniform is active in the program, so it has a location
+			inline bool HasUniform(std::size_t variable) const { return uniforms.find(variable) != uniforms.end(); }
 
 			void Bind() const;
 			void Bind(const glm::mat4& CameraMVP) const;
@@ -2,6 +2,7 @@
 #include "Utils/Data.h"
 #include "../OpenGLDebug.h"
 #include "./OpenGLShader.h"
+#include "../GLFrameRingBuffer.h"
 
 namespace Esteem
 {
@@ -13,6 +14,7 @@ namespace Esteem
 			, bindingName(bindingName)
 			, bindingIndex(bindingIndex)
 			, size(size)
+			, frameRingBuffer(nullptr)
 		{
 		}
 		
@@ -23,6 +25,10 @@ namespace Esteem
 
 		void UBO::UpdateBuffer(const void* data, uint size)
 		{
+			// bound from this frame's region until the next update, at our full size so the whole uniform block is backed
+			if (frameRingBuffer != nullptr && frameRingBuffer->BindUniforms(bindingIndex, data, size, this->size))
+				return;
+
 			//glBindBuffer(GL_UNIFORM_BUFFER, bindingID);
 			glBindBuffer(GL_UNIFORM_BUFFER, id);
 			if(size <= this->size)
@@ -34,6 +40,10 @@ namespace Esteem
 			}
 
 			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+			// an earlier frame may have bound the ring buffer instead
+			if (frameRingBuffer != nullptr)
+				Bind();
 		}
 
 		void UBO::Bind(cgc::raw_ptr<OpenGLShader> shader, std::string_view uniformBlockName, uint index)
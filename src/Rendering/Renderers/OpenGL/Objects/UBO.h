@@ -11,6 +11,7 @@ namespace Esteem
 	{
 		class OpenGLFactory;
 		class OpenGLShader;
+		class GLFrameRingBuffer;
 
 		class UBO : public IUBO
 		{
@@ -23,6 +24,7 @@ namespace Esteem
 			uint size;
 			hash_t bindingHash;
 			std::string bindingName;
+			GLFrameRingBuffer* frameRingBuffer;
 
 			UBO(uint id, uint bindingIndex, std::string_view bindingName, uint size, uint usageType);
 
@@ -35,6 +37,10 @@ namespace Esteem
 			
 			virtual void UpdateBuffer(const void* data, uint size);
 
+			/// \brief write updates to the frame ring buffer and bind them from there, for buffers that are updated every frame they're used
+			/// \param frameRingBuffer nullptr to update our own buffer again
+			inline void SetFrameRingBuffer(GLFrameRingBuffer* frameRingBuffer) { this->frameRingBuffer = frameRingBuffer; }
+
 			static void Bind(cgc::raw_ptr<OpenGLShader> shader, std::string_view uniformBlockName, uint index);
 			static void Bind(cgc::raw_ptr<OpenGLShader> shader, hash_t bindingHash, uint index);
 
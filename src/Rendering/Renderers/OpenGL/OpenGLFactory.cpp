@@ -6,8 +6,11 @@
 #include "Utils/Debug.h"
 #include "Utils/StringParser.h"
 #include "Utils/CPreProcessor.h"
+#include "Utils/CookedAssets.h"
+#include "Utils/Profiler.h"
 #include "./OpenGLDebug.h"
 
+#include "../../Objects/BlockCompression.h"
 #include "../../Objects/Image.h"
 #include "World/Objects/Entity.h"
 #include "World/World.h"
@@ -19,13 +22,52 @@
 #include <sched.h>
 #endif
 
-#define AUTO_CREATE_MATERIALS
 #define sizeofmember(type, member) sizeof(type::member)
 
 namespace Esteem
 {
 	namespace OpenGL
 	{
+		namespace
+		{
+			/// \brief start reading the file the upload of the image needs: its cooked texture unless that can be mapped, or else the image itself
+			AssetHandle ReadTextureAsync(const Image& image, bool keepImageOnCPU)
+			{
+				const std::string& path = image.GetPath();
+				if (image.GetPixelsPtr() != nullptr || path.empty())
+					return AssetHandle();
+
+				std::string cookedPath = CookedAssets::GetTexturePath(path);
+				if (!keepImageOnCPU && Data::AssetExists(cookedPath))
+					return Data::MapAsset(cookedPath).data() == nullptr ? Data::ReadAssetAsync(cookedPath) : AssetHandle();
+
+				return Data::ReadAssetAsync(path);
+			}
+
+			/// \brief contents of the asset, taken from the read that was started for it when there is one
+			std::string_view ReadStarted(const std::string& path, const AssetHandle& read, std::string& storage)
+			{
+				if (read.IsValid() && read.GetPath() == path)
+					return read.Wait();
+
+				storage = Data::ReadAsset(path);
+				return storage;
+			}
+
+			/// \brief decode the image from the read that was started for it, or from its file when there is none
+			bool LoadImage(Image& image, const AssetHandle& read)
+			{
+				if (image.GetPixelsPtr() == nullptr && read.IsValid() && read.GetPath() == image.GetPath())
+				{
+					std::string path = image.GetPath();
+					const std::string& contents = read.Wait();
+					return image.LoadFromMemory(contents.data(), contents.size(), path);
+				}
+
+				return image.LoadFileIfNotLoaded();
+			}
+		}
+
 		OpenGLFactory::OpenGLFactory()
 			: coUploaderContext()
 			, coUploaderRunning(true)
@@ -264,14 +306,34 @@ namespace Esteem
 			std::unordered_map<std::string, std::string> defines;
 			defines.insert(this->defines.begin(), this->defines.end());
 
-			// Read file and continue when we got input
+			// Read file and continue when we got input, EsteemCook may have preprocessed it for these defines already
 			std::string contents;
-			size_t size;
-			cgc::strong_ptr<std::istream> stream = Data::StreamAsset(path, size);
-			if (stream)
+			std::string cookedPath = CookedAssets::GetShaderPath(path, defines);
+			if (Data::AssetExists(cookedPath))
+				contents = CPreProcessor::UnpackProcessed(Data::ReadAsset(cookedPath), defines);
+			else if (Data::AssetExists(path))
 			{
-				std::vector<std::string> includes;
-				contents = CPreProcessor::ProcessStreamToString(stream, std::string(path), RESOURCES_PATH + SHADERS_PATH, defines, includes);
+				// otherwise the derived data cache may have it from an earlier run, its includes are checked on a hit
+				std::string source = Data::ReadAsset(path);
+				DerivedDataCache::Key key = DerivedDataCache::KeyBuilder("shader", 1)
+					.AddString(path)
+					.AddValue(CookedAssets::HashDefines(defines))
+					.AddString(source)
+					.GetKey();
+
+				std::string packed;
+				Data::GetDerivedDataCache().GetOrBuild(key, packed, [&](std::string& data, std::vector<std::string>& dependencies)
+				{
+					std::unordered_map<std::string, std::string> processedDefines(defines);
+					std::vector<std::string> includes;
+					cgc::strong_ptr<std::istream> stream = cgc::construct_new<std::istringstream>(source);
+					std::string processed = CPreProcessor::ProcessStreamToString(stream, std::string(path), RESOURCES_PATH + SHADERS_PATH, processedDefines, includes, &dependencies);
+
+					data = CPreProcessor::PackProcessed(processed, processedDefines);
+					return true;
+				});
+
+				contents = CPreProcessor::UnpackProcessed(packed, defines);
 			}
 			else
 				Debug::LogError("Could not find shader: ", path);
@@ -389,72 +451,6 @@ namespace Esteem
 			path = RESOURCES_PATH + SHADERS_PATH + path;
 		}
 
-		cgc::strong_ptr<Material> OpenGLFactory::LoadMaterial(std::string_view path, TEXTURE_FILTER textureFlter)
-		{
-			std::string newPath(path);
-			if (path.empty())
-				newPath = "def_diffuse";
-
-			newPath = RESOURCES_PATH + MATERIALS_PATH + newPath.substr(0, newPath.find(".")) + ".mat";
-
-			// Material already loaded ?
-			auto foundMaterial = materials.find(RT_HASH(path));
-			if (foundMaterial != materials.end())
-				return static_cast<cgc::strong_ptr<OpenGLMaterial>>(foundMaterial->second);
-
-
-			// read file and look for # commands
-			std::string fileContents = Data::ReadAsset(newPath);
-			if (fileContents.length() <= 0)
-			{
-#ifdef AUTO_CREATE_MATERIALS
-				uint beginPos = path.find_last_of("/");
-				if (beginPos == std::string::npos)
-					beginPos = path.find_last_of("\\");
-				if (beginPos == std::string::npos)
-					beginPos = 0;
-
-				std::string materialName(path.substr(beginPos + 1, path.find(".")));
-				fileContents = std::string("{\n  \"name\": \"" + materialName + "\",\n  \"shader\" : \"diffuse\",\n  \"alpha\" : false,\n  \"textures\": {\n    \"texture\": \"").append(path) + ".tga\"\n  }\n}";
-				//Data::WriteFile(path, fileContents);
-
-				Debug::LogWarning("Couldn't load material \"", path, "\", creating default material.");
-#else
-				return LoadMaterial(std::string("def_diffuse"));
-#endif
-			}
-
-			uint startJson = fileContents.find("{");
-			std::vector<cgc::strong_ptr<Material>> baseMaterials;
-
-			if (startJson != std::string::npos)
-			{
-				std::vector<HashCommand> hashCommands = CPreProcessor::RetrieveHashCommands(fileContents.substr(0, startJson));
-				for (uint i = 0; i < hashCommands.size(); ++i)
-				{
-					if (hashCommands[i].command == "#include")
-					{
-						cgc::strong_ptr<Material> baseMaterial = LoadMaterial(hashCommands[i].value);
-						if (baseMaterial != nullptr)
-							baseMaterials.push_back(cgc::static_pointer_cast<OpenGLMaterial>(baseMaterial));
-						else
-							Debug::LogError("Material: Could not load base material: " + hashCommands[i].value);
-					}
-
-				}
-				fileContents = fileContents.substr(startJson, fileContents.length() - startJson);
-			}
-
-			// Create new material
-			rapidjson::Document jsonDoc = Data::ReadJSON(fileContents.c_str());
-			if (jsonDoc.ObjectEmpty())
-				return LoadMaterial(std::string("def_diffuse")); // ReadJsonDocument already reports errors
-
-			cgc::strong_ptr<Material> material = CreateMaterial(path, jsonDoc, baseMaterials, textureFlter);
-
-			return material;
-		}
-
 		cgc::strong_ptr<Material> OpenGLFactory::CreateMaterial(std::string_view path, const rapidjson::Document& json, const std::vector<cgc::strong_ptr<Material>>& baseMaterials, TEXTURE_FILTER textureFlter)
 		{
 			// initialize material with json data
@@ -472,10 +468,6 @@ namespace Esteem
 				OpenGLMaterial* baseMaterial = static_cast<OpenGLMaterial*>(baseMaterials[i].ptr());
 
 				material->shader = baseMaterial->shader;
-				material->transparent = baseMaterial->transparent;
-				material->doubleSided = baseMaterial->doubleSided;
-
-				material->buffers = baseMaterial->buffers;
 
 				for (auto it = baseMaterial->activeUniformValues.begin(); it != baseMaterial->activeUniformValues.end(); ++it)
 					material->unactiveUniformValues[it->first] = it->second; // yes place them in the unactive list
@@ -484,15 +476,8 @@ namespace Esteem
 					material->unactiveUniformValues[it->first] = it->second;
 			}
 
-			// Alpha and reflective settings
-			if ((found = json.FindMember("transparent")) != json.MemberEnd())
-				material->transparent = found->value.IsBool() ? found->value.GetBool() : false;
-
-			if ((found = json.FindMember("doublesided")) != json.MemberEnd())
-				material->doubleSided = found->value.IsBool() ? found->value.GetBool() : false;
-
-			if ((found = json.FindMember("reflective")) != json.MemberEnd())
-				material->reflective = found->value.IsBool() ? found->value.GetBool() : false;
+			// Alpha and reflective settings, with the flags and buffers of the bases
+			ApplyMaterialSettings(*material, json, baseMaterials);
 
 			if ((found = json.FindMember("textures")) != json.MemberEnd())
 			{
@@ -792,7 +777,9 @@ namespace Esteem
 				if (!settings.custom)
 					originalTexture1Ds.emplace(RT_HASH(image->GetPath()), texture);
 
-				ThreadSafeCreateTexture1D(Recipe::Texture1D(texture, settings, image));
+				Recipe::Texture1D recipe(texture, settings, image);
+				recipe.read = ReadTextureAsync(*image, settings.keepImageOnCPU);
+				ThreadSafeCreateTexture1D(recipe);
 			}
 
 			return texture;
@@ -839,7 +826,9 @@ namespace Esteem
 				if (!settings.custom)
 					originalTexture2Ds.emplace(RT_HASH(image->GetPath()), texture);
 
-				ThreadSafeCreateTexture2D(Recipe::Texture2D(texture, settings, image));
+				Recipe::Texture2D recipe(texture, settings, image);
+				recipe.read = ReadTextureAsync(*image, settings.keepImageOnCPU);
+				ThreadSafeCreateTexture2D(recipe);
 			}
 
 			return texture;
@@ -979,7 +968,12 @@ namespace Esteem
 
 			// Will be used in the queue
 			cgc::strong_ptr<TextureCube> texture = texturesCubes.emplace(RT_HASH(name), settings, defaultTextureId, name, images);
-			ThreadSafeCreateTextureCube(Recipe::TextureCube(texture, settings, images));
+
+			Recipe::TextureCube recipe(texture, settings, images);
+			for (const cgc::strong_ptr<Image>& image : images)
+				recipe.reads.push_back(image ? ReadTextureAsync(*image, true) : AssetHandle());
+
+			ThreadSafeCreateTextureCube(recipe);
 
 			return texture;
 		}
@@ -1265,6 +1259,8 @@ namespace Esteem
 
 		void OpenGLFactory::HandleQueue()
 		{
+			ESTEEM_PROFILE("OpenGLFactory::HandleQueue");
+
 			// Trash
 			shaders.clean_garbage();
 			subShaders.clean_garbage();
@@ -1327,6 +1323,7 @@ namespace Esteem
 		void OpenGLFactory::CoHandleQueue()
 		{
 			coUploaderThreadID = std::this_thread::get_id();
+			Profiler::SetThreadName("OpenGL CoUploader");
 			coUploaderContext.setActive(true);
 			glewInit();
 
@@ -1340,6 +1337,8 @@ namespace Esteem
 
 				while (true)
 				{
+					ESTEEM_PROFILE("OpenGLFactory::CoHandleQueue");
+
 					// Recipes
 					Recipe::BoneMatrices boneMatricesRecipe;
 					while (boneMatricesRecipesQueue.pop_front(boneMatricesRecipe))
@@ -1527,7 +1526,13 @@ namespace Esteem
 			glTexParameterfv(GL_TEXTURE_1D, GL_TEXTURE_BORDER_COLOR, &textureRecipe.settings.borderColor[0]);
 
 			cgc::raw_ptr<Image> image = textureRecipe.image;
-			if (image && image->LoadFileIfNotLoaded())
+			if (image && image->GetPixelsPtr() == nullptr && !settings.keepImageOnCPU
+				&& (UploadCookedTexture2D(image->GetPath(), settings, textureRecipe.read) || (settings.mipmapped && UploadDerivedTexture2D(image->GetPath(), settings, textureRecipe.read))))
+			{
+				// EsteemCook or an earlier run made the mips already
+				AlterTexture2D(texture, id, texture->GetPath(), &settings, cgc::strong_ptr<Image>());
+			}
+			else if (image && LoadImage(*image, textureRecipe.read))
 			{
 				glPixelStorei(GL_UNPACK_ALIGNMENT, image->GetStride());
 
@@ -1584,7 +1589,13 @@ namespace Esteem
 			glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, &textureRecipe.settings.borderColor[0]);
 
 			cgc::raw_ptr<Image> image = textureRecipe.image;
-			if (image && image->LoadFileIfNotLoaded())
+			if (image && image->GetPixelsPtr() == nullptr && !settings.keepImageOnCPU
+				&& (UploadCookedTexture2D(image->GetPath(), settings, textureRecipe.read) || (settings.mipmapped && UploadDerivedTexture2D(image->GetPath(), settings, textureRecipe.read))))
+			{
+				// EsteemCook or an earlier run made the mips already
+				AlterTexture2D(texture, id, texture->GetPath(), &settings, cgc::strong_ptr<Image>());
+			}
+			else if (image && LoadImage(*image, textureRecipe.read))
 			{
 				glPixelStorei(GL_UNPACK_ALIGNMENT, image->GetStride());
 
@@ -1630,6 +1641,117 @@ namespace Esteem
 			LogOpenGLErrors();
 		}
 
+		bool OpenGLFactory::UploadCookedTexture2D(const std::string& path, const ConstructSettings::Texture2D& settings, const AssetHandle& read)
+		{
+			std::string cookedPath = CookedAssets::GetTexturePath(path);
+			if (path.empty() || !Data::AssetExists(cookedPath))
+				return false;
+
+			// mapped straight from the pak when stored there, loose files are read
+			std::string contents;
+			mm::array_view view = Data::MapAsset(cookedPath);
+			if (view.data() == nullptr)
+			{
+				std::string_view data = ReadStarted(cookedPath, read, contents);
+				view = mm::array_view(data.data(), data.size(), sizeof(char));
+			}
+
+			TextureContainer container;
+			if (!container.Open(view.data(), view.size()))
+			{
+				Debug::LogWarning("Cooked texture ", cookedPath, " is invalid, loading ", path, " instead");
+				return false;
+			}
+
+			UploadTextureContainer(container, settings);
+			return true;
+		}
+
+		bool OpenGLFactory::UploadDerivedTexture2D(const std::string& path, const ConstructSettings::Texture2D& settings, const AssetHandle& read)
+		{
+			std::string storage;
+			std::string_view source = path.empty() ? std::string_view() : ReadStarted(path, read, storage);
+			if (source.empty())
+				return false;
+
+			// box filtered without compression, so it looks exactly like glGenerateMipmap() did, only the decode and filtering are saved
+			DerivedDataCache::Key key = DerivedDataCache::KeyBuilder("texture", 1)
+				.AddString(source)
+				.GetKey();
+
+			std::string contents;
+			bool built = Data::GetDerivedDataCache().GetOrBuild(key, contents, [&](std::string& data, std::vector<std::string>& dependencies)
+			{
+				Image decoded;
+				if (!decoded.LoadFromMemory(source.data(), source.size(), path))
+					return false;
+
+				Vector2u size = decoded.GetSize();
+				data = TextureContainer::Write(TextureContainer::Format::RGBA8,
+					TextureContainer::GenerateMipChain(decoded.GetPixelsPtr(), size.x, size.y, TextureContainer::MipFilter::BOX, false));
+
+				return !data.empty();
+			});
+
+			TextureContainer container;
+			if (!built || !container.Open(contents.data(), contents.size()))
+				return false;
+
+			UploadTextureContainer(container, settings);
+			return true;
+		}
+
+		void OpenGLFactory::UploadTextureContainer(const TextureContainer& container, const ConstructSettings::Texture2D& settings)
+		{
+			const TextureContainer::Header& header = container.GetHeader();
+
+			GLenum internalFormat = 0;
+			switch (header.format)
+			{
+			case TextureContainer::Format::BC1:
+				internalFormat = GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : 0;
+				break;
+			case TextureContainer::Format::BC3:
+				internalFormat = GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+				break;
+			case TextureContainer::Format::BC4:
+				internalFormat = GL_COMPRESSED_RED_RGTC1;
+				break;
+			case TextureContainer::Format::BC5:
+				internalFormat = GL_COMPRESSED_RG_RGTC2;
+				break;
+			case TextureContainer::Format::BC7:
+				internalFormat = GLEW_ARB_texture_compression_bptc ? GL_COMPRESSED_RGBA_BPTC_UNORM : 0;
+				break;
+			default:
+				break;
+			}
+
+			uint32_t levels = settings.mipmapped ? header.mipCount : 1;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, int(levels - 1));
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+			std::vector<uint8> pixels;
+			for (uint32_t level = 0; level < levels; ++level)
+			{
+				const TextureContainer::MipLevel& mip = header.mips[level];
+				mm::array_view data = container.GetMip(level);
+
+				if (header.format == TextureContainer::Format::RGBA8)
+					glTexImage2D(GL_TEXTURE_2D, level, (GLenum)settings.format, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+				else if (internalFormat != 0)
+					glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, mip.width, mip.height, 0, GLsizei(data.size()), data.data());
+				else
+				{
+					// the GPU lacks the format, unpack it here
+					BlockCompression::Decode(header.format, static_cast<const uint8*>(data.data()), mip.width, mip.height, pixels);
+					glTexImage2D(GL_TEXTURE_2D, level, (GLenum)settings.format, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+				}
+			}
+
+			const_cast<glm::uvec2&>(settings.size) = glm::uvec2(header.width, header.height);
+		}
+
 		void OpenGLFactory::ThreadSafeCreateTextureCube(const Recipe::TextureCube& textureRecipe)
 		{
 			std::thread::id thisThreadID = std::this_thread::get_id();
@@ -1651,7 +1773,7 @@ namespace Esteem
 			{
 				// TODO: let the data factory handle this
 				Esteem::Image* img = textureRecipe.images[i].ptr();
-				if (img && img->LoadFileIfNotLoaded())
+				if (img && LoadImage(*img, i < textureRecipe.reads.size() ? textureRecipe.reads[i] : AssetHandle()))
 				{
 					glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, img->GetSize().x, img->GetSize().y, 0, GL_RGBA, GL_UNSIGNED_BYTE, img->GetPixelsPtr());
 					size = img->GetSize();
@@ -30,6 +30,7 @@
 #include "../../Objects/Texture2D.h"
 #include "../../Objects/Texture3D.h"
 #include "../../Objects/TextureCube.h"
+#include "../../Objects/TextureContainer.h"
 
 #include "./Objects/OpenGLBoneMatrices.h"
 #include "./Objects/OpenGLRenderObject.h"
@@ -158,10 +159,6 @@ namespace Esteem
 
 			void ParseToShaderPath(std::string& path, const GLenum& type);
 
-			/// \brief Load a material.
-			/// \param path		path and filename (relative path to RESOURCES_PATH + MATERIALS_PATH folder) will look for: path + ".mat" files.
-			/// \returns		OpenGLMaterial* to a new created or found material (with the same path).
-			virtual cgc::strong_ptr<Material> LoadMaterial(std::string_view path, TEXTURE_FILTER textureFlter = Settings::textureFlter);
 			virtual cgc::strong_ptr<Material> CreateMaterial(std::string_view path, const rapidjson::Document& json,
 				const std::vector<cgc::strong_ptr<Material>>& baseMaterials, TEXTURE_FILTER textureFlter = Settings::textureFlter);
 			virtual cgc::strong_ptr<Material> GetMaterial(std::string_view path);
@@ -225,6 +222,12 @@ namespace Esteem
 				void ThreadSafeCreateBuffer(const Recipe::Buffer& bufferRecipe);
 				void ThreadSafeCreateTexture1D(const Recipe::Texture1D& textureRecipe);
 				void ThreadSafeCreateTexture2D(const Recipe::Texture2D& textureRecipe);
+				/// \brief upload the texture EsteemCook made of the image at path into the bound texture, with all of its mips
+				bool UploadCookedTexture2D(const std::string& path, const ConstructSettings::Texture2D& settings, const AssetHandle& read);
+				/// \brief same for images that aren't cooked, their mip chain is built once and kept in the derived data cache
+				bool UploadDerivedTexture2D(const std::string& path, const ConstructSettings::Texture2D& settings, const AssetHandle& read);
+				/// \brief upload the container's levels into the bound texture, unpacks formats the GPU lacks
+				void UploadTextureContainer(const TextureContainer& container, const ConstructSettings::Texture2D& settings);
 				void ThreadSafeCreateTextureCube(const Recipe::TextureCube& textureRecipe);
 				void ThreadSafeCreateShader(Recipe::Shader& shaderRecipe);
 				void ThreadSafeCreateBoneMatrices(const Recipe::BoneMatrices& boneMatricesRecipe);
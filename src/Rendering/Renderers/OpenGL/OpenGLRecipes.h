@@ -6,6 +6,7 @@
 #include <cppu/cgc/pointers.h>
 
 #include "../../ConstructSettings.h"
+#include "Utils/AssetIO.h"
 
 namespace Esteem
 {
@@ -52,6 +53,8 @@ namespace Esteem
 				ConstructSettings::Texture1D settings;
 				cgc::strong_ptr<Esteem::Texture1D> texture;
 				cgc::strong_ptr<Esteem::Image> image;
+				/// \brief file the upload needs, read on the I/O threads while the recipe is queued
+				AssetHandle read;
 
 				Texture1D(const cgc::strong_ptr<Esteem::Texture1D>& texture, const ConstructSettings::Texture1D& settings, const cgc::strong_ptr<Esteem::Image>& image = cgc::strong_ptr<Esteem::Image>())
 					: texture(texture)
@@ -65,6 +68,8 @@ namespace Esteem
 				ConstructSettings::Texture2D settings;
 				cgc::strong_ptr<Esteem::Texture2D> texture;
 				cgc::strong_ptr<Esteem::Image> image;
+				/// \brief file the upload needs, read on the I/O threads while the recipe is queued
+				AssetHandle read;
 
 				Texture2D()
 				{}
@@ -81,6 +86,8 @@ namespace Esteem
 				ConstructSettings::TextureCube settings;
 				cgc::strong_ptr<Esteem::TextureCube> texture;
 				std::vector<cgc::strong_ptr<Esteem::Image>> images;
+				/// \brief per image, see Texture2D::read
+				std::vector<AssetHandle> reads;
 
 				TextureCube()
 				{}
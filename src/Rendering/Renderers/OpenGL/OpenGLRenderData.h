@@ -22,17 +22,25 @@ namespace Esteem
 		private:
 			OpenGLRenderList renderList;
 			const std::vector<LightRenderData>* lights;
+			const std::vector<ShadowCasterList>* shadowCasters;
 			cgc::strong_ptr<Camera> renderCamera;
 
 		public:
+			OpenGLRenderData()
+				: lights(nullptr)
+				, shadowCasters(nullptr)
+			{ }
+
 			virtual RenderList& GetAbstractRenderList();
 			const OpenGLRenderList& GetRenderList() const;
 
 			virtual const std::vector<LightRenderData>* GetLights() const;
 			virtual const cgc::strong_ptr<Camera>& GetCamera() const;
+			virtual const std::vector<ShadowCasterList>* GetShadowCasters() const;
 
 			virtual void SetRenderList(const RenderList& renderList);
 			virtual void SetLights(const std::vector<LightRenderData>* lights);
+			virtual void SetShadowCasters(const std::vector<ShadowCasterList>* shadowCasters);
 			virtual void SetRenderCamera(const cgc::strong_ptr<Camera>& renderCamera);
 		};
 	}
@@ -32,11 +32,21 @@ namespace Esteem
 			this->renderList = (OpenGLRenderList&)renderList;
 		}
 
+		inline const std::vector<ShadowCasterList>* OpenGLRenderData::GetShadowCasters() const
+		{
+			return shadowCasters;
+		}
+
 		inline void OpenGLRenderData::SetLights(const std::vector<LightRenderData>* lights)
 		{
 			this->lights = lights;
 		}
 
+		inline void OpenGLRenderData::SetShadowCasters(const std::vector<ShadowCasterList>* shadowCasters)
+		{
+			this->shadowCasters = shadowCasters;
+		}
+
 		inline void OpenGLRenderData::SetRenderCamera(const cgc::strong_ptr<Camera>& renderCamera)
 		{
 			this->renderCamera = renderCamera;
@@ -17,6 +17,7 @@
 #include "World/World.h"
 
 #include "OpenGLFactory.h"
+#include "./Objects/OpenGLBoneMatrices.h"
 
 #define M_PI 3.141592653589793238462643383279502884
 
@@ -44,12 +45,17 @@ namespace Esteem
 			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 			glClearDepth(1.0f);
 
+			// per frame uniforms and bone palettes are written to a persistently mapped buffer
+			frameRingBuffer.Initialize(Settings::frameRingBufferSize);
+
 			// initialize ubo and store light data
 			int lightAmount = 256;
 			lightsUBO = cgc::static_pointer_cast<UBO>(factory.LoadUBO(nullptr, lightAmount * sizeof(LightData), "lightsUB"));
+			lightsUBO->SetFrameRingBuffer(&frameRingBuffer);
 
 			// initialize camera ubo
 			cameraUBO = cgc::static_pointer_cast<UBO>(factory.LoadUBO(nullptr, sizeof(RenderCameraData), "cameraUB"));
+			cameraUBO->SetFrameRingBuffer(&frameRingBuffer);
 			
 			Debug::Log(" -------------------------------------------------------------------------------------");
 
@@ -100,12 +106,7 @@ namespace Esteem
 			Debug::Log(" -------------------------------------------------------------------------------------");
 
 			// initialize timing
-			queryID = 0;
-			glGenQueries(2, &query[0]);
-			glBeginQuery(GL_TIME_ELAPSED, query[0]);
-			glEndQuery(GL_TIME_ELAPSED);
-			glBeginQuery(GL_TIME_ELAPSED, query[1]);
-			glEndQuery(GL_TIME_ELAPSED);
+			gpuProfiler.Initialize(&timerQueries);
 
 			//set default values
 			//glEnable(GL_PRIMITIVE_RESTART);
@@ -121,10 +122,14 @@ namespace Esteem
 		void OpenGLRenderer::RenderFrame()
 		{
 			std::unique_lock<std::mutex> lock = factory.GetLock();
-			glBeginQuery(GL_TIME_ELAPSED, query[queryID]);
-			
+			gpuProfiler.BeginFrame();
+
+			// waits when the GPU is still reading the region of a few frames ago
+			frameRingBuffer.BeginFrame();
+
 			OpenGLRenderData& renderData = *static_cast<OpenGLRenderData*>(world->GetRenderData());
 			cameraUBO->UpdateBuffer(&renderData.GetCamera()->GetRenderCameraData()->data, sizeof(RenderCameraData));
+			UploadBoneMatrices(renderData);
 			
 			glEnable(GL_DEPTH_TEST);
 			glDepthMask(GL_TRUE);
@@ -140,15 +145,47 @@ namespace Esteem
 			//glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 			renderTechnique->RenderFrame(renderData);
-			overlayRenderTechnique->RenderFrame(renderData);
 
-			glEndQuery(GL_TIME_ELAPSED);
+			{
+				ESTEEM_GPU_PROFILE(gpuProfiler, "Overlay");
+				overlayRenderTechnique->RenderFrame(renderData);
+			}
 
-			queryID = queryID ^ 1; // == 1 ? 0 : 1;
-			glGetQueryObjectuiv(query[queryID], GL_QUERY_RESULT, &elapsedTime);
+			frameRingBuffer.EndFrame();
+			gpuProfiler.EndFrame();
 
 			//LogOpenGLErrors();
 		}
+
+		void OpenGLRenderer::UploadBoneMatrices(const OpenGLRenderData& renderData)
+		{
+			// the regions of earlier frames are overwritten, so every palette that's drawn gets written again
+			const OpenGLRenderList& renderList = renderData.GetRenderList();
+			for (const std::vector<OpenGLRenderObject*>& renderObjects : renderList)
+			{
+				for (const OpenGLRenderObject* renderObject : renderObjects)
+				{
+					if (renderObject->boneMatrices)
+						static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->Upload(frameRingBuffer);
+				}
+			}
+
+			// shadow casters outside the view aren't in the render list, Upload() skips the ones that are
+			if (const std::vector<ShadowCasterList>* shadowCasters = renderData.GetShadowCasters())
+			{
+				for (const ShadowCasterList& casters : *shadowCasters)
+				{
+					for (uint f = 0; f < casters.faceCount; ++f)
+					{
+						for (const RenderObject* renderObject : casters.faces[f])
+						{
+							if (renderObject->boneMatrices)
+								static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->Upload(frameRingBuffer);
+						}
+					}
+				}
+			}
+		}
 		
 		void OpenGLRenderer::RenderDevObjects(const std::vector<DevRenderObject>& renderObjects)
 		{
@@ -210,7 +247,7 @@ namespace Esteem
 
 		uint OpenGLRenderer::GetRenderTime()
 		{
-			return ((uint)elapsedTime / 1000000);
+			return uint(gpuProfiler.GetFrameTime() / 1000000);
 		}
 
 		void OpenGLRenderer::ActivateTexture(uint textureIndex, std::size_t uniformVariable, Texture2D* texture, cgc::raw_ptr<OpenGLShader> shader)
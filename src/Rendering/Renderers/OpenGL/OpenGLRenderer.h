@@ -15,6 +15,8 @@
 
 #include "./OpenGLRenderData.h"
 #include "./OpenGLFactory.h"
+#include "./GLFrameRingBuffer.h"
+#include "./GLTimerQueries.h"
 
 namespace Esteem
 {
@@ -37,11 +39,14 @@ namespace Esteem
 			cgc::strong_ptr<UBO> lightsUBO;
 			/// \brief UBO for camera information
 			cgc::strong_ptr<UBO> cameraUBO;
+			/// \brief per frame uniforms and bone palettes
+			GLFrameRingBuffer frameRingBuffer;
 
 			uint enabledTextures[32];
 
-			uint query[2];
-			bool queryID;
+			/// \brief GPU timings, read back a few frames later without waiting
+			GLTimerQueries timerQueries;
+			GPUProfiler gpuProfiler;
 
 			// Debug/Dev Rendering
 			cgc::strong_ptr<OpenGLShader> devRenderObjectsShader;
@@ -49,10 +54,10 @@ namespace Esteem
 			RenderTechnique<OpenGLRenderData, OpenGLRenderer>* renderTechnique;
 			RenderTechnique<OpenGLRenderData, OpenGLRenderer>* overlayRenderTechnique;
 
-		public:
-			uint32_t elapsedTime;
-			
+			/// \brief write the bone palettes of everything that can be drawn this frame to the frame ring buffer
+			void UploadBoneMatrices(const OpenGLRenderData& renderData);
 
+		public:
 			/// \brief Constructor
 			OpenGLRenderer(glm::uvec2 screenSize);
 			/// \brief Destructor
@@ -82,6 +87,8 @@ namespace Esteem
 
 			inline const cgc::strong_ptr<UBO>& GetLightsUBO() { return lightsUBO; }
 			inline const cgc::strong_ptr<UBO>& GetCameraUBO() { return cameraUBO; }
+			inline GLFrameRingBuffer& GetFrameRingBuffer() { return frameRingBuffer; }
+			inline GPUProfiler& GetGPUProfiler() { return gpuProfiler; }
 
 			inline OpenGLFactory& GetOpenGLFactory() { return factory; }
 			inline const OpenGLFactory& GetOpenGLFactory() const { return factory; }
@@ -0,0 +1,118 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "Threading/JobSystem.h"
+#include "./Objects/VAO.h"
+
+namespace Esteem
+{
+	namespace OpenGL
+	{
+		void RenderQueue::Build(const OpenGLRenderList& renderList, std::initializer_list<RenderObject::RenderOrder> passes, const RenderCameraData& camera, JobSystem* jobSystem)
+		{
+			Clear();
+
+			for (RenderObject::RenderOrder pass : passes)
+			{
+				const auto& list = renderList[pass];
+				for (OpenGLRenderObject* object : list)
+					Add(uint64_t(pass), object);
+			}
+
+			// only the pass is known yet, it's stored in the key until the rest is added
+			auto createKeys = [this, &camera](std::size_t from, std::size_t to)
+			{
+				for (std::size_t i = from; i < to; ++i)
+					items[i].key = CreateKey(uint8(items[i].key), *objects[i], camera);
+			};
+
+			if (jobSystem)
+				jobSystem->WaitFor(jobSystem->ParallelFor(items.size(), 1024, createKeys));
+			else
+				createKeys(0, items.size());
+
+			Sort();
+		}
+
+		void RenderQueue::Clear()
+		{
+			items.clear();
+			objects.clear();
+		}
+
+		uint32_t RenderQueue::Add(uint64_t key, OpenGLRenderObject* object)
+		{
+			uint32_t index = uint32_t(objects.size());
+			items.push_back({ key, index });
+			objects.push_back(object);
+
+			return index;
+		}
+
+		void RenderQueue::Sort()
+		{
+			if (items.size() > 1)
+				RadixSort();
+		}
+
+		void RenderQueue::RadixSort()
+		{
+			uint32_t counts[8][256] = {};
+			for (const Item& item : items)
+			{
+				for (uint byte = 0; byte < 8; ++byte)
+					++counts[byte][(item.key >> (byte * 8)) & 0xFF];
+			}
+
+			sortBuffer.resize(items.size());
+			for (uint byte = 0; byte < 8; ++byte)
+			{
+				uint32_t* count = counts[byte];
+				if (count[(items.front().key >> (byte * 8)) & 0xFF] == items.size())
+					continue;
+
+				uint32_t offset = 0;
+				for (uint digit = 0; digit < 256; ++digit)
+				{
+					uint32_t digitCount = count[digit];
+					count[digit] = offset;
+					offset += digitCount;
+				}
+
+				for (const Item& item : items)
+					sortBuffer[count[(item.key >> (byte * 8)) & 0xFF]++] = item;
+
+				items.swap(sortBuffer);
+			}
+		}
+
+		uint64_t RenderQueue::CreateKey(uint8 pass, uint program, uint material, uint vertexArray, uint depth)
+		{
+			uint64_t key = uint64_t(pass) & ((1u << PassBits) - 1);
+			key = (key << ProgramBits) | (program & ((1u << ProgramBits) - 1));
+			key = (key << MaterialBits) | (material & ((1u << MaterialBits) - 1));
+			key = (key << VertexArrayBits) | (vertexArray & ((1u << VertexArrayBits) - 1));
+			key = (key << DepthBits) | (depth & ((1u << DepthBits) - 1));
+
+			return key;
+		}
+
+		uint64_t RenderQueue::CreateKey(uint8 pass, const OpenGLRenderObject& object, const RenderCameraData& camera)
+		{
+			const OpenGLMaterial* material = static_cast<const OpenGLMaterial*>(object.GetMaterial().ptr());
+			return CreateKey(pass, material->GetOpenGLShader()->GetShaderID(), material->GetID(), object.GetVAO()->GetID(), QuantizeDepth(object.GetPosition(), camera));
+		}
+
+		uint RenderQueue::QuantizeDepth(const glm::vec3& position, const RenderCameraData& camera)
+		{
+			constexpr float maxDepth = float((1u << DepthBits) - 1);
+
+			float distance = glm::dot(position - camera.position, camera.forward);
+			float depth = camera.farClipDistance > 0.f ? distance / camera.farClipDistance * maxDepth : 0.f;
+
+			return uint(std::min(std::max(depth, 0.f), maxDepth));
+		}
+	}
+}
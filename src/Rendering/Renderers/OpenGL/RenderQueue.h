@@ -0,0 +1,69 @@
+#pragma once
+
+#include "stdafx.h"
+#include <initializer_list>
+#include <vector>
+
+#include "./OpenGLRenderData.h"
+
+namespace Esteem
+{
+	class JobSystem;
+
+	namespace OpenGL
+	{
+		/// \brief Draws sorted by a 64 bit key, so objects that share a program, material or vertex array follow each other
+		/// From the most to the least significant bits: pass, program, material, vertex array and depth.
+		/// Ids are cut to their lower bits, a collision only makes the grouping worse, the state cache compares the full ids.
+		class RenderQueue
+		{
+		public:
+			static constexpr uint PassBits = 4;
+			static constexpr uint ProgramBits = 16;
+			static constexpr uint MaterialBits = 16;
+			static constexpr uint VertexArrayBits = 16;
+			static constexpr uint DepthBits = 12;
+
+			struct Item
+			{
+				uint64_t key;
+				/// \brief index of the object the item was added with
+				uint32_t index;
+			};
+
+		private:
+			std::vector<Item> items;
+			std::vector<Item> sortBuffer;
+			std::vector<OpenGLRenderObject*> objects;
+
+			/// \brief least significant byte first, passes in which every key has the same byte are skipped
+			void RadixSort();
+
+		public:
+			RenderQueue() = default;
+
+			// disable copy
+			RenderQueue(const RenderQueue&) = delete;
+			void operator=(const RenderQueue&) = delete;
+
+			/// \brief replace the queue with the objects of the given passes, front to back within equal state
+			/// \param jobSystem optional, creates the keys on its threads when given
+			void Build(const OpenGLRenderList& renderList, std::initializer_list<RenderObject::RenderOrder> passes, const RenderCameraData& camera, JobSystem* jobSystem = nullptr);
+
+			void Clear();
+			/// \return index of the object, stored in the item
+			uint32_t Add(uint64_t key, OpenGLRenderObject* object);
+			/// \brief sort by key, items with equal keys keep the order they were added in
+			void Sort();
+
+			inline const std::vector<Item>& GetItems() const { return items; }
+			inline OpenGLRenderObject* GetObject(const Item& item) const { return objects[item.index]; }
+
+			static uint64_t CreateKey(uint8 pass, uint program, uint material, uint vertexArray, uint depth);
+			static uint64_t CreateKey(uint8 pass, const OpenGLRenderObject& object, const RenderCameraData& camera);
+			/// \brief distance along the camera's forward, mapped from [0, far clip distance] to the depth bits
+			static uint QuantizeDepth(const glm::vec3& position, const RenderCameraData& camera);
+			static inline uint8 GetPass(uint64_t key) { return uint8(key >> (64 - PassBits)); }
+		};
+	}
+}
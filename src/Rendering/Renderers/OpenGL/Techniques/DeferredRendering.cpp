@@ -132,6 +132,8 @@ namespace Esteem
 			shadowMapTechnique->RenderFrame(renderData);
 			renderer.GetLightsUBO()->UpdateBuffer(factory->GetLightsData().data(), factory->GetLightsData().size() * sizeof(LightData));
 
+			ESTEEM_GPU_PROFILE(renderer.GetGPUProfiler(), "Deferred");
+
 			deferredFrameBuffer->Bind();
 
 			glClearColor(0, 0, 0, 1);
@@ -162,7 +164,7 @@ namespace Esteem
 				if (renderObject->boneMatrices != nullptr)
 				{
 					shader->SetUniform(CT_HASH("animations"), 1);
-					static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->GetUBO()->Bind(shader);
+					static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->Bind();
 				}
 				else
 					shader->SetUniform(CT_HASH("animations"), 0);
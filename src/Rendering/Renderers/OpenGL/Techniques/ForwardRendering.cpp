@@ -2,6 +2,8 @@
 
 #include "General/Settings.h"
 #include "Utils/Diagnostics.h"
+#include "Threading/JobSystem.h"
+#include "World/Constituents/Camera.h"
 #include "../OpenGLFactory.h"
 
 #include "../OpenGLRenderCalls.h"
@@ -15,6 +17,8 @@ namespace Esteem
 			, skyBoxTechnique(renderer)
 			, shadowMapTechnique(renderer)
 			, cascadedShadowMapTechnique(renderer, shadowMapTechnique)
+			, instanceBuffer(0)
+			, instanceTexture(0)
 		{
 			Initialize();
 		}
@@ -76,6 +80,18 @@ namespace Esteem
 			//depthFrameBuffer->AttachDepthTexture(depthTexture);
 			//depthFrameBuffer->Validate();
 
+			// instance buffer, filled every frame with the model matrices of the instanced draws
+			glGenBuffers(1, &instanceBuffer);
+			glBindBuffer(GL_TEXTURE_BUFFER, instanceBuffer);
+			glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+
+			glGenTextures(1, &instanceTexture);
+			glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceBuffer);
+
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
 			// default shadow map technique
 			shadowMapTechnique.Initialize();
 			cascadedShadowMapTechnique.Initialize();
@@ -94,6 +110,8 @@ namespace Esteem
 			shadowMapTechnique.RenderFrame(renderData);
 			if(!renderer.GetOpenGLFactory().GetLightsData().empty())
 				renderer.GetLightsUBO()->UpdateBuffer(renderer.GetOpenGLFactory().GetLightsData().data(), renderer.GetOpenGLFactory().GetLightsData().size() * sizeof(LightData));
+
+			ESTEEM_GPU_PROFILE(renderer.GetGPUProfiler(), "Forward");
 			
 			//depthFrameBuffer->Bind();
 			glClearColor(0, 0, 0, 1);
@@ -147,76 +165,160 @@ namespace Esteem
 
 		void ForwardRendering::RenderOpaque(const OpenGLRenderData& renderData)
 		{
-			const OpenGLRenderList& openGLRenderList = renderData.GetRenderList();
+			const RenderCameraData& camera = renderData.GetCamera()->GetRenderCameraData()->data;
+			opaqueQueue.Build(renderData.GetRenderList(), { RenderObject::RenderOrder::OPAQUE_, RenderObject::RenderOrder::OPAQUE_DOUBLE_SIDED }, camera, JobSystem::GetLocal());
 
-			for (const auto* renderObject : openGLRenderList[RenderObject::RenderOrder::OPAQUE_])
+			const std::vector<RenderQueue::Item>& items = opaqueQueue.GetItems();
+			instanceBatcher.SetThreshold(Settings::instancingThreshold);
+			instanceBatcher.Build(items.size(), [&](std::size_t i)
 			{
-				cgc::raw_ptr<OpenGLMaterial> material = static_cast<OpenGLMaterial*>(renderObject->GetMaterial().ptr());
-				cgc::raw_ptr<OpenGLShader> shader = static_cast<OpenGLShader*>(material->GetOpenGLShader().ptr());
+				return CanInstance(*opaqueQueue.GetObject(items[i]));
+			}, [&](std::size_t a, std::size_t b)
+			{
+				// the material decides the program
+				const OpenGLRenderObject* objectA = opaqueQueue.GetObject(items[a]);
+				const OpenGLRenderObject* objectB = opaqueQueue.GetObject(items[b]);
+				return RenderQueue::GetPass(items[a].key) == RenderQueue::GetPass(items[b].key)
+					&& objectA->GetMaterial().ptr() == objectB->GetMaterial().ptr()
+					&& objectA->GetVAO().ptr() == objectB->GetVAO().ptr();
+			}, [&](std::size_t i) -> const glm::mat4&
+			{
+				return *opaqueQueue.GetObject(items[i])->GetModelMatrix();
+			});
 
-				OpenGLBoneMatrices* boneMatrices = reinterpret_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr());
-				cgc::raw_ptr<VAO> vao = renderObject->GetVAO();
+			const std::vector<glm::mat4>& matrices = instanceBatcher.GetMatrices();
+			if (!matrices.empty())
+			{
+				// orphan last frame's storage, so the upload doesn't wait for draws that still read it
+				glBindBuffer(GL_TEXTURE_BUFFER, instanceBuffer);
+				glBufferData(GL_TEXTURE_BUFFER, matrices.size() * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+				glBufferSubData(GL_TEXTURE_BUFFER, 0, matrices.size() * sizeof(glm::mat4), matrices.data());
+				glBindBuffer(GL_TEXTURE_BUFFER, 0);
+			}
 
-				shader->Bind();
-				shader->SetUniform(CT_HASH("ModelMatrix"), *renderObject->GetModelMatrix());
+			// the other techniques bind through OpenGL directly
+			stateCache.Invalidate();
+			stateCache.Clear();
 
-				renderer.ActivateTexture(7, CT_HASH("shadowAtlas"), shadowMapTechnique.shadowTexture.ptr(), shader);
-				renderer.ActivateTexture(8, CT_HASH("csmShadowTexture"), cascadedShadowMapTechnique.GetCascadedShadowTexture().ptr(), shader);
+			// reserved up front, the recorded draws point into it
+			instancedDraws.clear();
+			instancedDraws.reserve(instanceBatcher.GetBatches().size());
 
-				material->Bind();
-				vao->Bind();
-
-				if (boneMatrices != nullptr)
+			for (const InstanceBatcher::Batch& batch : instanceBatcher.GetBatches())
+			{
+				if (batch.IsInstanced())
 				{
-					shader->SetUniform(CT_HASH("animations"), 1);
-					boneMatrices->GetUBO()->Bind();
+					const RenderQueue::Item& item = items[batch.first];
+					const OpenGLRenderObject* renderObject = opaqueQueue.GetObject(item);
+
+					RecordObjectState(item.key, *renderObject);
+					stateCache.BindTexture(9, GL_TEXTURE_BUFFER, instanceTexture);
+
+					instancedDraws.push_back({ renderObject, batch.matrixOffset, batch.count });
+					stateCache.Draw(&DrawInstancedObjects, &instancedDraws.back());
 				}
 				else
-					shader->SetUniform(CT_HASH("animations"), 0);
+				{
+					for (uint32_t i = batch.first; i < batch.first + batch.count; ++i)
+					{
+						const OpenGLRenderObject* renderObject = opaqueQueue.GetObject(items[i]);
 
-				DrawRenderObject(*renderObject);
-				//DrawElements(vao, renderObject->GetInstanceCount());
+						RecordObjectState(items[i].key, *renderObject);
+						stateCache.Draw(&DrawOpaqueObject, renderObject);
 
-				Diagnostics::drawCalls++;
+						// the custom samplers replaced the material's, the next object sets them again
+						if (renderObject->GetCustomBuffer() != nullptr)
+							stateCache.InvalidateUniforms();
+					}
+				}
 			}
 
-			const auto& opaqueDSRenderList = openGLRenderList[RenderObject::RenderOrder::OPAQUE_DOUBLE_SIDED];
-			if (!opaqueDSRenderList.empty())
+			stateCache.SetCullFace(true);
+			stateCache.Execute();
+
+			// the shader and vertex array classes keep track of what's bound themselves
+			OpenGLShader::UnBind();
+			VAO::UnBind();
+		}
+
+		void ForwardRendering::RecordObjectState(uint64_t key, const OpenGLRenderObject& renderObject)
+		{
+			const OpenGLMaterial* material = static_cast<const OpenGLMaterial*>(renderObject.GetMaterial().ptr());
+			const OpenGLBoneMatrices* boneMatrices = static_cast<const OpenGLBoneMatrices*>(renderObject.boneMatrices.ptr());
+
+			stateCache.SetCullFace(RenderQueue::GetPass(key) != RenderObject::RenderOrder::OPAQUE_DOUBLE_SIDED);
+			stateCache.UseProgram(material->GetOpenGLShader()->GetShaderID());
+
+			material->BindTextures(stateCache);
+			if (const Material::Buffers* customBuffers = renderObject.GetCustomBuffer())
+				OpenGLMaterial::BindTextures(*customBuffers, stateCache);
+
+			stateCache.BindTexture(7, GL_TEXTURE_2D, shadowMapTechnique.shadowTexture->GetID());
+			stateCache.BindTexture(8, GL_TEXTURE_2D, cascadedShadowMapTechnique.GetCascadedShadowTexture()->GetID());
+			stateCache.SetUniforms(&ApplyMaterialUniforms, material);
+
+			stateCache.BindVertexArray(renderObject.GetVAO()->GetID());
+			if (boneMatrices != nullptr)
 			{
-				glDisable(GL_CULL_FACE);
-				for (const auto* renderObject : opaqueDSRenderList)
-				{
-					cgc::raw_ptr<OpenGLMaterial> material = static_cast<OpenGLMaterial*>(renderObject->GetMaterial().ptr());
-					cgc::raw_ptr<OpenGLShader> shader = static_cast<OpenGLShader*>(material->GetOpenGLShader().ptr());
+				const OpenGLBoneMatrices::Binding& bones = boneMatrices->GetBinding();
+				stateCache.BindUniformBuffer(bones.index, bones.buffer, bones.offset, bones.size);
+			}
+		}
+
+		bool ForwardRendering::CanInstance(const OpenGLRenderObject& renderObject)
+		{
+			if (renderObject.boneMatrices.ptr() != nullptr || renderObject.GetCustomBuffer() != nullptr || renderObject.GetInstanceCount() != 1)
+				return false;
 
-					OpenGLBoneMatrices* boneMatrices = static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr());
-					cgc::raw_ptr<VAO> vao = renderObject->GetVAO();
+			// shaders without the instance buffer would draw every instance at the last ModelMatrix
+			const OpenGLMaterial* material = static_cast<const OpenGLMaterial*>(renderObject.GetMaterial().ptr());
+			return material->GetOpenGLShader()->HasUniform(CT_HASH("instanceMatrices"));
+		}
 
-					shader->Bind();
-					shader->SetUniform(CT_HASH("ModelMatrix"), *renderObject->GetModelMatrix());
+		void ForwardRendering::ApplyMaterialUniforms(const void* data)
+		{
+			const OpenGLMaterial& material = *static_cast<const OpenGLMaterial*>(data);
+			const OpenGLShader& shader = *material.GetOpenGLShader();
 
-					//renderer->ActivateTexture(7, CT_HASH("shadowAtlas"), shadowMapTechnique->shadowTexture.ptr(), shader.ptr());
-					//renderer->ActivateTexture(8, CT_HASH("csmShadowTexture"), cascadedShadowMapTechnique->GetCascadedShadowTexture().ptr(), shader.ptr());
+			shader.SetUniform(CT_HASH("shadowAtlas"), 7);
+			shader.SetUniform(CT_HASH("csmShadowTexture"), 8);
+			shader.SetUniform(CT_HASH("instanceMatrices"), 9);
+			material.ApplyUniforms();
+		}
 
-					material->Bind();
-					renderObject->BindCustomBuffers(shader);
-					vao->Bind();
+		void ForwardRendering::DrawOpaqueObject(const void* data)
+		{
+			const OpenGLRenderObject& renderObject = *static_cast<const OpenGLRenderObject*>(data);
+			const OpenGLShader& shader = *static_cast<const OpenGLMaterial*>(renderObject.GetMaterial().ptr())->GetOpenGLShader();
 
-					if (boneMatrices != nullptr)
-					{
-						shader->SetUniform(CT_HASH("animations"), 1);
-						boneMatrices->GetUBO()->Bind();
-					}
-					else
-						shader->SetUniform(CT_HASH("animations"), 0);
+			shader.SetUniform(CT_HASH("ModelMatrix"), *renderObject.GetModelMatrix());
+			shader.SetUniform(CT_HASH("animations"), renderObject.boneMatrices.ptr() != nullptr ? 1 : 0);
+			shader.SetUniform(CT_HASH("instanced"), 0);
 
-					DrawRenderObject(*renderObject);
-					//DrawElements(vao, renderObject->GetInstanceCount());
+			if (const Material::Buffers* customBuffers = renderObject.GetCustomBuffer())
+				OpenGLMaterial::ApplySamplerUniforms(*customBuffers, shader);
 
-					Diagnostics::drawCalls++;
-				}
-				glEnable(GL_CULL_FACE);
-			}
+			DrawRenderObject(renderObject);
+
+			Diagnostics::drawCalls++;
+		}
+
+		void ForwardRendering::DrawInstancedObjects(const void* data)
+		{
+			const InstancedDraw& draw = *static_cast<const InstancedDraw*>(data);
+			const OpenGLShader& shader = *static_cast<const OpenGLMaterial*>(draw.renderObject->GetMaterial().ptr())->GetOpenGLShader();
+
+			shader.SetUniform(CT_HASH("animations"), 0);
+			shader.SetUniform(CT_HASH("instanced"), 1);
+			shader.SetUniform(CT_HASH("instanceOffset"), int(draw.matrixOffset));
+
+			cgc::raw_ptr<VAO> vao = draw.renderObject->GetVAO();
+			if (vao->GetEBO() != nullptr)
+				DrawElementsInstanced(vao->GetEBO(), draw.count);
+			else
+				DrawArraysInstanced(vao->GetVBO(), draw.count);
+
+			Diagnostics::drawCalls++;
 		}
 
 		void ForwardRendering::RenderTransparent(const OpenGLRenderData& renderData)
@@ -249,7 +351,7 @@ namespace Esteem
 				if (boneMatrices != nullptr)
 				{
 					shader->SetUniform(CT_HASH("animations"), 1);
-					boneMatrices->GetUBO()->Bind();
+					boneMatrices->Bind();
 				}
 				else
 					shader->SetUniform(CT_HASH("animations"), 0);
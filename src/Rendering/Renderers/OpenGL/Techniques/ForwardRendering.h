@@ -5,6 +5,9 @@
 #include "../OpenGLRenderer.h"
 #include "../Objects/OpenGLRenderObject.h"
 #include "../../../IRenderTechnique.h"
+#include "../GLStateCache.h"
+#include "../InstanceBatcher.h"
+#include "../RenderQueue.h"
 #include "./SkyBox.h"
 #include "./Shadowing/ShadowMap.h"
 #include "./Shadowing/CascadedShadowMap.h"
@@ -30,8 +33,40 @@ namespace Esteem
 			uint quadVAO;
 			cgc::strong_ptr<OpenGLShader> renderToTargetShader;
 
+			/// \brief one instanced draw, the shader reads the model matrices from the instanceMatrices samplerBuffer
+			/// Matrix i of the draw is stored as 4 RGBA32F texels (its columns) from texel (instanceOffset + i) * 4 on.
+			struct InstancedDraw
+			{
+				const OpenGLRenderObject* renderObject;
+				uint32_t matrixOffset;
+				uint32_t count;
+			};
+
+			/// \brief opaque objects sorted by state, recorded into the state cache before they are drawn
+			RenderQueue opaqueQueue;
+			GLStateCache stateCache;
+
+			/// \brief groups of opaque objects with the same mesh and material, see Settings::instancingThreshold
+			InstanceBatcher instanceBatcher;
+			std::vector<InstancedDraw> instancedDraws;
+			uint instanceBuffer;
+			uint instanceTexture;
+
 			ForwardRendering(OpenGLRenderer& renderer);
 
+			/// \brief record the program, textures and buffers the object is drawn with
+			void RecordObjectState(uint64_t key, const OpenGLRenderObject& renderObject);
+
+			/// \brief neither animated, instanced already, nor using custom buffers, and its shader reads instanceMatrices
+			static bool CanInstance(const OpenGLRenderObject& renderObject);
+
+			/// \param material the OpenGLMaterial whose program is bound
+			static void ApplyMaterialUniforms(const void* material);
+			/// \param renderObject the OpenGLRenderObject to draw, its program and vertex array are bound
+			static void DrawOpaqueObject(const void* renderObject);
+			/// \param draw the InstancedDraw, its program, vertex array and instance buffer are bound
+			static void DrawInstancedObjects(const void* draw);
+
 		public:
 			virtual ~ForwardRendering() = default;
 
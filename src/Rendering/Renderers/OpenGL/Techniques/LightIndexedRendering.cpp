@@ -58,70 +58,80 @@ namespace Esteem
 
 		void LightIndexedRendering::RenderFrame(const OpenGLRenderData& renderData)
 		{
-			cgc::raw_ptr<OpenGLShader> curShader = depthShader;
-			bool cutoff = false;
-
-			depthShader->Bind();
-			glColorMask(false, false, false, false);
-
-			const OpenGLRenderList& openGLRenderList = renderData.GetRenderList();
-			const std::vector<OpenGLRenderObject*>* opaqueRenderList = &openGLRenderList[RenderObject::RenderOrder::OPAQUE_];
-
-			for (uint i = 0; i < opaqueRenderList->size(); ++i)
 			{
-				OpenGLRenderObject* renderObject = (*opaqueRenderList)[i];
-				cgc::raw_ptr<OpenGLMaterial> material = static_cast<OpenGLMaterial*>(renderObject->GetMaterial().ptr());
-				cgc::raw_ptr<OpenGLShader> shader = static_cast<OpenGLShader*>(material->GetOpenGLShader().ptr());
-				cgc::raw_ptr<VAO> vao = renderObject->GetVAO();
+				ESTEEM_GPU_PROFILE(renderer.GetGPUProfiler(), "Depth prepass");
 
-				if (cutoff != shader->IsCutOff())
-				{
-					cutoff = !cutoff;
-					curShader = depthShaderCutoff;
-					curShader->Bind();
-				}
+				cgc::raw_ptr<OpenGLShader> curShader = depthShader;
+				bool cutoff = false;
 
-				if (cutoff)
-				{
-					static_assert("bind all buffer");
-					/*glActiveTexture(GL_TEXTURE0);
-					auto map = material->GetTextures();
-					if(map[0].first == CT_HASH("tex"))
-						glBindTexture(GL_TEXTURE_2D, map[0].second->GetID());
-					depthShaderCutoff->SetUniform(CT_HASH("tex"), 0);*/
-				}
+				depthShader->Bind();
+				glColorMask(false, false, false, false);
 
-				curShader->SetUniform(CT_HASH("ModelMatrix"), *renderObject->GetModelMatrix());
-				vao->Bind();
+				const OpenGLRenderList& openGLRenderList = renderData.GetRenderList();
+				const std::vector<OpenGLRenderObject*>* opaqueRenderList = &openGLRenderList[RenderObject::RenderOrder::OPAQUE_];
 
-				if (renderObject->boneMatrices != nullptr)
+				for (uint i = 0; i < opaqueRenderList->size(); ++i)
 				{
-					curShader->SetUniform(CT_HASH("animations"), 1);
-					static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->GetUBO()->Bind(curShader);
+					OpenGLRenderObject* renderObject = (*opaqueRenderList)[i];
+					cgc::raw_ptr<OpenGLMaterial> material = static_cast<OpenGLMaterial*>(renderObject->GetMaterial().ptr());
+					cgc::raw_ptr<OpenGLShader> shader = static_cast<OpenGLShader*>(material->GetOpenGLShader().ptr());
+					cgc::raw_ptr<VAO> vao = renderObject->GetVAO();
+
+					if (cutoff != shader->IsCutOff())
+					{
+						cutoff = !cutoff;
+						curShader = depthShaderCutoff;
+						curShader->Bind();
+					}
+
+					if (cutoff)
+					{
+						static_assert("bind all buffer");
+						/*glActiveTexture(GL_TEXTURE0);
+						auto map = material->GetTextures();
+						if(map[0].first == CT_HASH("tex"))
+							glBindTexture(GL_TEXTURE_2D, map[0].second->GetID());
+						depthShaderCutoff->SetUniform(CT_HASH("tex"), 0);*/
+					}
+
+					curShader->SetUniform(CT_HASH("ModelMatrix"), *renderObject->GetModelMatrix());
+					vao->Bind();
+
+					if (renderObject->boneMatrices != nullptr)
+					{
+						curShader->SetUniform(CT_HASH("animations"), 1);
+						static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->Bind();
+					}
+					else
+						curShader->SetUniform(CT_HASH("animations"), 0);
+
+					DrawRenderObject(*renderObject);
+					//DrawElements(vao, renderObject->GetInstanceCount());
+
+					Diagnostics::drawCalls++;
 				}
-				else
-					curShader->SetUniform(CT_HASH("animations"), 0);
-
-				DrawRenderObject(*renderObject);
-				//DrawElements(vao, renderObject->GetInstanceCount());
-
-				Diagnostics::drawCalls++;
+				VAO::UnBind();
+				glColorMask(true, true, true, true);
+				OpenGLShader::UnBind();
 			}
-			VAO::UnBind();
-			glColorMask(true, true, true, true);
-			OpenGLShader::UnBind();
 
 			// fill shadow atlas
 			shadowMapTechnique.RenderFrame(renderData);
 			renderer.GetLightsUBO()->UpdateBuffer(renderer.GetOpenGLFactory().GetLightsData().data(), renderer.GetOpenGLFactory().GetLightsData().size() * sizeof(LightData));
 			
 			glDisable(GL_DEPTH_TEST);
-			// light index texture
-			indexFrameBuffer->Bind();
-			glClearBufferiv(GL_COLOR, 0, clearColor);
-			lightingTechnique->RenderFrame(renderData);
-			FBO::UnBind(renderer);
+			{
+				ESTEEM_GPU_PROFILE(renderer.GetGPUProfiler(), "Light indices");
+
+				// light index texture
+				indexFrameBuffer->Bind();
+				glClearBufferiv(GL_COLOR, 0, clearColor);
+				lightingTechnique->RenderFrame(renderData);
+				FBO::UnBind(renderer);
+			}
 			glEnable(GL_DEPTH_TEST);
+
+			ESTEEM_GPU_PROFILE(renderer.GetGPUProfiler(), "Forward");
 			
 			if (Settings::drawLines)
 				glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -161,7 +171,7 @@ namespace Esteem
 				if (renderObject->boneMatrices != nullptr)
 				{
 					shader->SetUniform(CT_HASH("animations"), 1);
-					static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->GetUBO()->Bind(shader);
+					static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->Bind();
 				}
 				else
 					shader->SetUniform(CT_HASH("animations"), 0);
@@ -199,7 +209,7 @@ namespace Esteem
 				if (renderObject->boneMatrices != nullptr)
 				{
 					shader->SetUniform(CT_HASH("animations"), 1);
-					reinterpret_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->GetUBO()->Bind(shader);
+					reinterpret_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->Bind();
 				}
 				else
 					shader->SetUniform(CT_HASH("animations"), 0);
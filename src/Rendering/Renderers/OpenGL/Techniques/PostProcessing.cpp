@@ -83,6 +83,8 @@ namespace Esteem
 
 		void PostProcessing::RenderFrame(const OpenGLRenderData& renderData)
 		{
+			ESTEEM_GPU_PROFILE(renderer.GetGPUProfiler(), "Post");
+
 			BindNextFBO();
 
 			// Require all post processes of current frame
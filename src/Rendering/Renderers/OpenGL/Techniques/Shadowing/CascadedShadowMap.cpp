@@ -107,6 +107,8 @@ namespace Esteem
 
 		void CascadedShadowMap::RenderFrame(const OpenGLRenderData& renderData, const glm::mat4& lightMatrix, const glm::vec3& lightDirection)
 		{
+			ESTEEM_GPU_PROFILE(renderer.GetGPUProfiler(), "Cascades");
+
 			glDepthMask(GL_TRUE);
 			glDepthFunc(GL_GEQUAL);
 			glClearDepth(0.f);
@@ -4,6 +4,7 @@
 
 #include "General/Settings.h"
 #include "Utils/Diagnostics.h"
+#include "Threading/JobSystem.h"
 
 #include "../Lighting/DirectionalLighting.h"
 
@@ -17,6 +18,8 @@ namespace Esteem
 	{
 		ShadowMap::ShadowMap(OpenGLRenderer& renderer)
 			: RenderTechnique(renderer)
+			, casterPassCount(0)
+			, cascadePass(0)
 		{
 
 		}
@@ -61,14 +64,19 @@ namespace Esteem
 			shadowFBO->Validate();
 
 			shadowUBO = cgc::static_pointer_cast<UBO>(renderer.GetOpenGLFactory().LoadUBO(&shadowInfo[0], 64 * sizeof(ShadowMapInfo), "shadowMapInfoUB"));
+			shadowUBO->SetFrameRingBuffer(&renderer.GetFrameRingBuffer());
 			shader = renderer.GetOpenGLFactory().LoadOpenGLShader("ShadowMap");
 			shaderCutoff = renderer.GetOpenGLFactory().LoadOpenGLShader("ShadowMap_cutoff");
 
-			projectionMatrix = glm::mat4(glm::perspective<float>(Math::ToRadians(91.f), 1.f, 1.f, 1024.f)); // Projection Matrix
+			commandBuffer.Initialize();
 		}
 
 		void ShadowMap::RenderFrame(const OpenGLRenderData& renderData)
 		{
+			ESTEEM_GPU_PROFILE(renderer.GetGPUProfiler(), "Shadows");
+
+			RecordCasters(renderData);
+
 			shadowFBO->Bind();
 			shader->Bind();
 
@@ -87,6 +95,9 @@ namespace Esteem
 
 			int shadowIndex = 0;
 
+			// recorded in the same order
+			std::size_t pass = 0;
+
 			for (const auto& light : *renderData.GetLights())
 			{
 				if (light.data->shadowInfoIndex == -1)
@@ -98,6 +109,8 @@ namespace Esteem
 				{
 				case LightData::LightType::DIRECTIONAL:
 				{
+					cascadePass = pass++;
+
 					CascadedShadowMap* csmShadowMap = (CascadedShadowMap*)dirLightingTechnique;
 					csmShadowMap->RenderFrame(renderData, *light.matrix, light.data->forward);
 
@@ -118,25 +131,10 @@ namespace Esteem
 					for (uint j = 0; j < 6; ++j)
 					{
 						glViewport(x, y, width, width);
-						shadowInfo[shadowIndex].shadowMatrix = projectionMatrix * GetCubeMapDirectionMatrix(GL_TEXTURE_CUBE_MAP_POSITIVE_X + j, light.data->position);
+						shadowInfo[shadowIndex].shadowMatrix = light.data->GetShadowMatrix(j);
 						shader->SetUniform(CT_HASH("CameraMVP"), shadowInfo[shadowIndex].shadowMatrix);
 
-						const OpenGLRenderList& openGLRenderList = renderData.GetRenderList();
-						const std::vector<OpenGLRenderObject*>* opaqueRenderList = &openGLRenderList[(size_t)RenderObject::RenderOrder::OPAQUE_];
-
-						for (uint i = 0; i < opaqueRenderList->size(); ++i)
-						{
-							OpenGLRenderObject* renderObject = opaqueRenderList->operator[](i);
-							if (renderObject->IsCastingShadows())
-							{
-								RenderObject(shader, renderObject);
-
-								DrawRenderObject(*renderObject);
-								//DrawElementsOnce(renderObject);
-
-								Diagnostics::drawCalls++;
-							}
-						}
+						RenderCasters(pass++);
 
 						x += width;
 						if (x >= textureWidth)
@@ -153,25 +151,10 @@ namespace Esteem
 					shader->SetUniform(CT_HASH("orthographic"), false);
 
 					glViewport(x, y, width, width);
-					shadowInfo[shadowIndex].shadowMatrix = projectionMatrix * glm::lookAt(light.data->position, light.data->position - light.data->forward, glm::vec3(0, 1, 0));
+					shadowInfo[shadowIndex].shadowMatrix = light.data->GetShadowMatrix(0);
 					shader->SetUniform(CT_HASH("CameraMVP"), shadowInfo[shadowIndex].shadowMatrix);
 
-					const OpenGLRenderList& openGLRenderList = renderData.GetRenderList();
-					const std::vector<OpenGLRenderObject*>* opaqueRenderList = &openGLRenderList[(size_t)RenderObject::RenderOrder::OPAQUE_];
-
-					for (uint i = 0; i < opaqueRenderList->size(); ++i)
-					{
-						OpenGLRenderObject* renderObject = opaqueRenderList->operator[](i);
-						if (renderObject->IsCastingShadows())
-						{
-							RenderObject(shader, renderObject);
-
-							DrawRenderObject(*renderObject);
-							//DrawElementsOnce(renderObject);
-
-							Diagnostics::drawCalls++;
-						}
-					}
+					RenderCasters(pass++);
 
 					x += width;
 					if (x >= textureWidth)
@@ -194,9 +177,6 @@ namespace Esteem
 		{
 			glDisable(GL_CULL_FACE);
 
-			cgc::strong_ptr<OpenGLShader> curShader = shader;
-			bool cutoff = false;
-
 			shaderCutoff->Bind(matrix);
 			shaderCutoff->SetUniform(CT_HASH("lightDistance"), distance);
 			shaderCutoff->SetUniform(CT_HASH("orthographic"), orthographic);
@@ -205,38 +185,9 @@ namespace Esteem
 			shader->SetUniform(CT_HASH("lightDistance"), distance);
 			shader->SetUniform(CT_HASH("orthographic"), orthographic);
 
-			const OpenGLRenderList& openGLRenderList = renderData.GetRenderList();
-			const std::vector<OpenGLRenderObject*>* opaqueRenderList = &openGLRenderList[(size_t)RenderObject::RenderOrder::OPAQUE_];
-
-			for (uint i = 0; i < opaqueRenderList->size(); ++i)
-			{
-				OpenGLRenderObject* renderObject = opaqueRenderList->operator[](i);
-				if (renderObject->IsCastingShadows())
-				{
-					if (cutoff != shader->IsCutOff())
-					{
-						cutoff = !cutoff;
-						(cutoff ? shaderCutoff : shader)->Bind();
-					}
-
-					if (cutoff)
-					{
-						static_assert("bind all buffer");
-						/*glActiveTexture(GL_TEXTURE0 );
-						auto map = renderObject->GetMaterial()->GetTextures();
-						if(map[0].first == CT_HASH("tex"))
-							glBindTexture(GL_TEXTURE_2D, map[0].second->GetID());
-						shader->SetUniform(CT_HASH("tex"), 0);*/
-					}
-
-					RenderObject(shader, renderObject);
-
-					DrawRenderObject(*renderObject);
-					//DrawElementsOnce(renderObject);
+			if (cascadePass < casterPassCount)
+				RenderCasters(cascadePass);
 
-					Diagnostics::drawCalls++;
-				}
-			}
 			VAO::UnBind();
 			glEnable(GL_CULL_FACE);
 
@@ -249,6 +200,7 @@ namespace Esteem
 			shader->Bind(matrix);
 			shader->SetUniform(CT_HASH("lightDistance"), distance);
 			shader->SetUniform(CT_HASH("orthographic"), 0);
+			shader->SetUniform(CT_HASH("drawOffset"), -1);
 
 			//glViewport(0, 0, 1024, 512);
 			glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
@@ -277,26 +229,90 @@ namespace Esteem
 			FBO::UnBind(renderer);
 		}
 
-		glm::mat4 ShadowMap::GetCubeMapDirectionMatrix(const int cubemapSide, glm::vec3 position)
+		void ShadowMap::RecordCasters(const OpenGLRenderData& renderData)
 		{
-			// View Matrices
-			switch (cubemapSide)
+			// culled in the same order as the lights, lights without shadow faces are skipped there
+			const std::vector<ShadowCasterList>* shadowCasters = renderData.GetShadowCasters();
+			std::size_t casterIndex = 0;
+
+			casterPassCount = 0;
+			auto addPass = [this](const std::vector<Esteem::RenderObject*>* casters)
 			{
-			case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
-				return glm::lookAt(position, position + glm::vec3(1, 0, 0), glm::vec3(0, 1, 0));
-			case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
-				return glm::lookAt(position, position + glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0));
-			case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
-				return glm::lookAt(position, position + glm::vec3(0, 1, 0), glm::vec3(0, 0, 1));
-			case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
-				return glm::lookAt(position, position + glm::vec3(0, -1, 0), glm::vec3(0, 0, -1));
-			case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
-				return glm::lookAt(position, position + glm::vec3(0, 0, 1), glm::vec3(0, 1, 0));
-			case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
-				return glm::lookAt(position, position + glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
-			default:
-				return glm::mat4();
+				if (casterPassCount == casterPasses.size())
+					casterPasses.emplace_back();
+
+				casterPasses[casterPassCount++].casters = casters;
+			};
+
+			for (const auto& light : *renderData.GetLights())
+			{
+				if (light.data->shadowInfoIndex == -1)
+					continue;
+
+				const ShadowCasterList* casters = nullptr;
+				if (shadowCasters && casterIndex < shadowCasters->size() && (*shadowCasters)[casterIndex].light == light.data)
+					casters = &(*shadowCasters)[casterIndex++];
+
+				switch (light.data->type)
+				{
+				case LightData::LightType::DIRECTIONAL:
+					// the cascades aren't culled one by one, they all draw the same pass
+					addPass(nullptr);
+					break;
+				case LightData::LightType::POINT:
+					for (uint j = 0; j < 6; ++j)
+						addPass(casters ? &casters->faces[j] : nullptr);
+					break;
+				case LightData::LightType::SPOT:
+					addPass(casters ? &casters->faces[0] : nullptr);
+					break;
+				}
 			}
+
+			const std::vector<OpenGLRenderObject*>& opaqueRenderList = renderData.GetRenderList()[(size_t)RenderObject::RenderOrder::OPAQUE_];
+			JobSystem* jobSystem = JobSystem::GetLocal();
+
+			// a job per pass, the passes split their draws over more jobs when they're large
+			auto recordPasses = [this, &opaqueRenderList, jobSystem](std::size_t from, std::size_t to)
+			{
+				for (std::size_t i = from; i < to; ++i)
+				{
+					CasterPass& pass = casterPasses[i];
+					if (pass.casters)
+					{
+						const std::vector<Esteem::RenderObject*>& casters = *pass.casters;
+						pass.commands.Record(casters.size(), [&casters](CommandList& list, std::size_t j)
+						{
+							GLCommandBuffer::Record(list, *static_cast<const OpenGLRenderObject*>(casters[j]));
+						}, jobSystem);
+					}
+					else
+					{
+						pass.commands.Record(opaqueRenderList.size(), [&opaqueRenderList](CommandList& list, std::size_t j)
+						{
+							if (opaqueRenderList[j]->IsCastingShadows())
+								GLCommandBuffer::Record(list, *opaqueRenderList[j]);
+						}, jobSystem);
+					}
+				}
+			};
+
+			if (jobSystem && casterPassCount > 0)
+				jobSystem->WaitFor(jobSystem->ParallelFor(casterPassCount, 1, recordPasses));
+			else
+				recordPasses(0, casterPassCount);
+
+			commandBuffer.Clear();
+			for (std::size_t i = 0; i < casterPassCount; ++i)
+				casterPasses[i].offset = commandBuffer.Add(casterPasses[i].commands);
+
+			commandBuffer.Upload();
+		}
+
+		void ShadowMap::RenderCasters(std::size_t pass)
+		{
+			const CasterPass& casterPass = casterPasses[pass];
+			commandBuffer.Execute(casterPass.commands, casterPass.offset, *shader);
 		}
 
 		ShadowMap::~ShadowMap()
@@ -7,6 +7,7 @@
 #include "../../OpenGLRenderData.h"
 #include "../../Objects/OpenGLRenderObject.h"
 #include "../../Objects/OpenGLBoneMatrices.h"
+#include "../../GLCommandBuffer.h"
 #include "../../../../IRenderTechnique.h"
 
 namespace Esteem
@@ -28,13 +29,32 @@ namespace Esteem
 		private:
 			cgc::strong_ptr<OpenGLShader> shader;
 			cgc::strong_ptr<OpenGLShader> shaderCutoff;
-			glm::mat4 projectionMatrix;
 
 			std::vector<ShadowMapInfo> shadowInfo;
 			cgc::strong_ptr<UBO> shadowUBO;
 			RenderTechnique<OpenGLRenderData, OpenGLRenderer>* dirLightingTechnique;
 
-			glm::mat4 GetCubeMapDirectionMatrix(const int cubemapSide, glm::vec3 position);
+			/// \brief the draws of a light face, or of all cascades of a directional light
+			struct CasterPass
+			{
+				/// \brief culled casters of the face, nullptr for every shadow casting object in view
+				const std::vector<Esteem::RenderObject*>* casters;
+				CommandList commands;
+				/// \brief offset of the commands in the command buffer
+				uint32_t offset;
+			};
+
+			/// \brief in the order the lights are drawn, only the first casterPassCount are used this frame
+			std::vector<CasterPass> casterPasses;
+			std::size_t casterPassCount;
+			/// \brief pass of the directional light whose cascades are drawn
+			std::size_t cascadePass;
+			GLCommandBuffer commandBuffer;
+
+			/// \brief record the casters of every shadow casting light face on the job threads and upload them
+			void RecordCasters(const OpenGLRenderData& renderData);
+			/// \brief draw a recorded pass with the bound shader
+			void RenderCasters(std::size_t pass);
 
 			inline void RenderObject(const cgc::strong_ptr<OpenGLShader>& shader, OpenGLRenderObject* renderObject)
 			{
@@ -44,7 +64,7 @@ namespace Esteem
 				if (renderObject->boneMatrices)
 				{
 					shader->SetUniform(CT_HASH("animations"), 1);
-					static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->GetUBO()->Bind();
+					static_cast<OpenGLBoneMatrices*>(renderObject->boneMatrices.ptr())->Bind();
 				}
 				else
 					shader->SetUniform(CT_HASH("animations"), 0);
@@ -1,4 +1,8 @@
 #include "RenderingFactory.h"
+#include "Utils/Data.h"
+#include "Utils/Debug.h"
+#include "Utils/CPreProcessor.h"
+#include "Rendering/Objects/Material.h"
 #include "Rendering/Objects/Buffer.h"
 #include "Rendering/Objects/Texture1D.h"
 #include "Rendering/Objects/Texture2D.h"
@@ -51,4 +55,81 @@ namespace Esteem
 			texture->size = size;
 		}
 	}
+
+	void RenderingFactory::ApplyMaterialSettings(Material& material, const rapidjson::Document& json, const std::vector<cgc::strong_ptr<Material>>& baseMaterials)
+	{
+		// set all included material values as default values
+		for (const cgc::strong_ptr<Material>& base : baseMaterials)
+		{
+			material.transparent = base->transparent;
+			material.doubleSided = base->doubleSided;
+			material.reflective = base->reflective;
+			material.buffers = base->buffers;
+		}
+
+		auto found = json.FindMember("transparent");
+		if (found != json.MemberEnd())
+			material.transparent = found->value.IsBool() ? found->value.GetBool() : false;
+
+		if ((found = json.FindMember("doublesided")) != json.MemberEnd())
+			material.doubleSided = found->value.IsBool() ? found->value.GetBool() : false;
+
+		if ((found = json.FindMember("reflective")) != json.MemberEnd())
+			material.reflective = found->value.IsBool() ? found->value.GetBool() : false;
+	}
+
+	cgc::strong_ptr<Material> RenderingFactory::LoadMaterial(std::string_view path, TEXTURE_FILTER textureFlter)
+	{
+		std::string newPath(path);
+		if (path.empty())
+			newPath = "def_diffuse";
+
+		newPath = RESOURCES_PATH + MATERIALS_PATH + newPath.substr(0, newPath.find(".")) + ".mat";
+
+		// Material already loaded ?
+		cgc::strong_ptr<Material> material = GetMaterial(path);
+		if (material)
+			return material;
+
+		// read file and look for # commands
+		std::string fileContents = Data::ReadAsset(newPath);
+		if (fileContents.empty())
+		{
+			std::size_t beginPos = path.find_last_of("/\\");
+			std::string materialName(path.substr(beginPos == std::string_view::npos ? 0 : beginPos + 1));
+			materialName = materialName.substr(0, materialName.find("."));
+
+			fileContents = std::string("{\n  \"name\": \"" + materialName + "\",\n  \"shader\" : \"diffuse\",\n  \"alpha\" : false,\n  \"textures\": {\n    \"texture\": \"").append(path) + ".tga\"\n  }\n}";
+
+			Debug::LogWarning("Couldn't load material \"", path, "\", creating default material.");
+		}
+
+		std::size_t startJson = fileContents.find("{");
+		std::vector<cgc::strong_ptr<Material>> baseMaterials;
+
+		if (startJson != std::string::npos)
+		{
+			std::vector<HashCommand> hashCommands = CPreProcessor::RetrieveHashCommands(fileContents.substr(0, startJson));
+			for (const HashCommand& hashCommand : hashCommands)
+			{
+				if (hashCommand.command == "#include")
+				{
+					cgc::strong_ptr<Material> baseMaterial = LoadMaterial(hashCommand.value);
+					if (baseMaterial != nullptr)
+						baseMaterials.push_back(baseMaterial);
+					else
+						Debug::LogError("Material: Could not load base material: " + hashCommand.value);
+				}
+			}
+
+			fileContents = fileContents.substr(startJson);
+		}
+
+		// ReadJSON already reports errors, def_diffuse itself failing would recurse forever
+		rapidjson::Document jsonDoc = Data::ReadJSON(fileContents.c_str());
+		if (!jsonDoc.IsObject() || jsonDoc.ObjectEmpty())
+			return path != "def_diffuse" ? LoadMaterial("def_diffuse") : nullptr;
+
+		return CreateMaterial(path, jsonDoc, baseMaterials, textureFlter);
+	}
 }
\ No newline at end of file
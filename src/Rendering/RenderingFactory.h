@@ -47,6 +47,10 @@ namespace Esteem
 		void AlterTexture1D(const cgc::strong_ptr<Texture1D>& texture, uint id, const std::string& path, const ConstructSettings::Texture1D* settings, const cgc::strong_ptr<Image>& image);
 		void AlterTexture2D(const cgc::strong_ptr<Texture2D>& texture, uint id, const std::string& path, const ConstructSettings::Texture2D* settings, const cgc::strong_ptr<Image>& image);
 		void AlterTextureCube(const cgc::strong_ptr<TextureCube>& texture, uint id, const glm::uvec2& size);
+
+		/// \brief copy the flags and buffers of the base materials in order, then apply the flags set in the json
+		/// For CreateMaterial(), the backend copies its own shader and uniforms of the bases.
+		static void ApplyMaterialSettings(Material& material, const rapidjson::Document& json, const std::vector<cgc::strong_ptr<Material>>& baseMaterials);
 		
 	public:
 		inline static RenderingFactory* Instance() { return instance; }
@@ -57,7 +61,9 @@ namespace Esteem
 		
 		virtual cgc::strong_ptr<IShader> LoadShader(std::string_view path) = 0;
 
-		virtual cgc::strong_ptr<Material> LoadMaterial(std::string_view path, TEXTURE_FILTER textureFlter = Settings::textureFlter) = 0;
+		/// \brief read the material's .mat file, load the materials it #includes and create it through CreateMaterial()
+		/// Loaded materials are returned by GetMaterial(), a missing file becomes a diffuse material with a texture named after it.
+		virtual cgc::strong_ptr<Material> LoadMaterial(std::string_view path, TEXTURE_FILTER textureFlter = Settings::textureFlter);
 		virtual cgc::strong_ptr<Material> CreateMaterial(std::string_view path, const rapidjson::Document& json, const std::vector<cgc::strong_ptr<Material>>& baseMaterials, TEXTURE_FILTER textureFlter = Settings::textureFlter) = 0;
 		virtual cgc::strong_ptr<Material> GetMaterial(std::string_view path) = 0;
 
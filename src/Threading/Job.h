@@ -0,0 +1,82 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+namespace Esteem
+{
+	/// \brief Fixed size unit of work, lives in a per thread job pool and never allocates
+	/// The callable is stored inside the job itself, the parent will only finish when all of its children are done.
+	struct alignas(64) Job
+	{
+		friend class JobSystem;
+
+	public:
+		typedef void(*Function)(Job& job);
+
+		static constexpr std::size_t JobSize = 128;
+		/// \brief storage for the callable, the remaining 32 bytes hold the bookkeeping
+		static constexpr std::size_t DataSize = JobSize - 32;
+
+	private:
+		alignas(std::max_align_t) char data[DataSize];
+		Function function;
+		Job* parent;
+		std::atomic<int32_t> unfinishedJobs;
+
+		template<typename F>
+		static void CallableStub(Job& job)
+		{
+			F* callable = reinterpret_cast<F*>(job.data);
+			(*callable)();
+			callable->~F();
+		}
+
+	public:
+		Job()
+			: function(nullptr)
+			, parent(nullptr)
+			, unfinishedJobs(0)
+		{ }
+
+		// disable copy
+		Job(const Job&) = delete;
+		void operator=(const Job&) = delete;
+
+		template<typename F>
+		inline void Set(Job* parent, F&& callable)
+		{
+			typedef std::decay_t<F> Callable;
+			static_assert(sizeof(Callable) <= DataSize, "job callable is too big, capture less or capture by reference");
+			static_assert(alignof(Callable) <= alignof(std::max_align_t), "job callable alignment is not supported");
+
+			this->function = &CallableStub<Callable>;
+			this->parent = parent;
+			this->unfinishedJobs.store(1, std::memory_order_relaxed);
+			new (data) Callable(std::forward<F>(callable));
+
+			if (parent)
+				parent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		inline void SetEmpty(Job* parent)
+		{
+			this->function = nullptr;
+			this->parent = parent;
+			this->unfinishedJobs.store(1, std::memory_order_relaxed);
+
+			if (parent)
+				parent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		inline bool IsFinished() const
+		{
+			return unfinishedJobs.load(std::memory_order_acquire) <= 0;
+		}
+	};
+
+	static_assert(sizeof(Job) == Job::JobSize, "Job should fit exactly in two cache lines");
+}
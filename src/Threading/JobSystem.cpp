@@ -0,0 +1,207 @@
+#include "JobSystem.h"
+
+#include <cassert>
+
+#include "Utils/Debug.h"
+#include "Utils/Profiler.h"
+
+namespace Esteem
+{
+	thread_local JobSystem::ThreadData* JobSystem::localThread = nullptr;
+	thread_local JobSystem* JobSystem::localSystem = nullptr;
+
+	JobSystem::ThreadData::ThreadData(uint8 index)
+		: jobPool(new Job[MaxJobsPerThread])
+		, allocatedJobs(0)
+		, randomSeed(0x9E3779B9u * (index + 1u))
+		, index(index)
+	{ }
+
+	Job* JobSystem::ThreadData::AllocateJob()
+	{
+		// skip jobs that are still alive, e.g.: a long living parent that other jobs are added to
+		for (std::size_t i = 0; i < MaxJobsPerThread; ++i)
+		{
+			Job* job = &jobPool[allocatedJobs++ & (MaxJobsPerThread - 1)];
+			if (job->IsFinished())
+				return job;
+		}
+
+		// every job in the pool is alive, MaxJobsPerThread is too small
+		assert(false);
+		return nullptr;
+	}
+
+	JobSystem::JobSystem(uint8 workerCount)
+		: running(true)
+		, queuedJobs(0)
+		, sleepingWorkers(0)
+	{
+		for (uint8 i = 0; i <= workerCount; ++i)
+			threadsData.emplace_back(std::make_unique<ThreadData>(i));
+
+		localThread = threadsData[0].get();
+		localSystem = this;
+
+		for (uint8 i = 1; i <= workerCount; ++i)
+			threads.emplace_back(&JobSystem::Worker, this, i);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepLock);
+			running = false;
+		}
+		sleepWaiter.notify_all();
+
+		for (auto& thread : threads)
+			thread.join();
+
+		if (localSystem == this)
+		{
+			localThread = nullptr;
+			localSystem = nullptr;
+		}
+	}
+
+	void JobSystem::Worker(uint8 threadIndex)
+	{
+		localThread = threadsData[threadIndex].get();
+		localSystem = this;
+		Profiler::SetThreadName("Worker " + std::to_string(threadIndex));
+
+		uint idleRounds = 0;
+		while (running.load(std::memory_order_relaxed))
+		{
+			if (Job* job = GetJob())
+			{
+				Execute(job);
+				idleRounds = 0;
+			}
+			else if (++idleRounds < 64)
+				std::this_thread::yield();
+			else
+			{
+				idleRounds = 0;
+
+				std::unique_lock<std::mutex> lock(sleepLock);
+				sleepingWorkers++;
+				sleepWaiter.wait(lock, [this] { return !running || queuedJobs.load() > 0; });
+				sleepingWorkers--;
+			}
+		}
+	}
+
+	JobSystem::ThreadData& JobSystem::GetThreadData() const
+	{
+		// only the main thread and our own workers are allowed to create and run jobs
+		assert(localSystem == this && localThread != nullptr);
+		return *localThread;
+	}
+
+	Job* JobSystem::GetJob()
+	{
+		ThreadData& thread = GetThreadData();
+
+		Job* job = thread.queue.Pop();
+		if (!job)
+		{
+			// xorshift to pick a random victim, keeps contention spread out
+			uint32_t& seed = thread.randomSeed;
+			seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+
+			std::size_t count = threadsData.size();
+			std::size_t start = seed % count;
+			for (std::size_t i = 0; i < count && !job; ++i)
+			{
+				std::size_t victim = (start + i) % count;
+				if (victim != thread.index)
+					job = threadsData[victim]->queue.Steal();
+			}
+		}
+
+		if (job)
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+		return job;
+	}
+
+	Job* JobSystem::CreateJob()
+	{
+		Job* job = GetThreadData().AllocateJob();
+		job->SetEmpty(nullptr);
+		return job;
+	}
+
+	Job* JobSystem::CreateChildJob(Job* parent)
+	{
+		Job* job = GetThreadData().AllocateJob();
+		job->SetEmpty(parent);
+		return job;
+	}
+
+	void JobSystem::Run(Job* job)
+	{
+		if (!GetThreadData().queue.Push(job))
+		{
+			// queue is full, do it ourselves
+			Execute(job);
+			return;
+		}
+
+		queuedJobs.fetch_add(1);
+		if (sleepingWorkers.load() > 0)
+		{
+			std::lock_guard<std::mutex> lock(sleepLock);
+			sleepWaiter.notify_one();
+		}
+	}
+
+	void JobSystem::Execute(Job* job)
+	{
+		if (job->function)
+		{
+			try
+			{
+				job->function(*job);
+			}
+			catch (std::exception& e)
+			{
+				Debug::Log("JobSystem::Execute Exception: " + std::string(e.what()));
+			}
+		}
+
+		Finish(job);
+	}
+
+	void JobSystem::Finish(Job* job)
+	{
+		// walk up the chain, a parent is finished once its own function and all its children are
+		while (job)
+		{
+			// read the parent first, once finished the job's slot may be reused by its owner
+			Job* parent = job->parent;
+			if (job->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+				break;
+
+			job = parent;
+		}
+	}
+
+	void JobSystem::WaitFor(const Job* job)
+	{
+		while (!job->IsFinished())
+		{
+			if (Job* next = GetJob())
+				Execute(next);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	std::size_t JobSystem::GetThreadIndex()
+	{
+		return localThread ? localThread->index : 0;
+	}
+}
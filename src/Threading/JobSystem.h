@@ -0,0 +1,125 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "./Job.h"
+#include "./WorkStealingQueue.h"
+
+namespace Esteem
+{
+	/// \brief Work-stealing job system, every thread owns a job pool and a lock-free deque
+	/// Jobs are created and run from the thread that constructed the JobSystem (main) or from inside other jobs,
+	/// idle workers steal from random victims and go to sleep when nothing is left.
+	class JobSystem
+	{
+	public:
+		/// \brief jobs per thread that can be alive (created but not finished) at the same time
+		static constexpr std::size_t MaxJobsPerThread = 4096;
+
+	private:
+		struct alignas(64) ThreadData
+		{
+			WorkStealingQueue<MaxJobsPerThread> queue;
+			std::unique_ptr<Job[]> jobPool;
+			uint32_t allocatedJobs;
+			uint32_t randomSeed;
+			uint8 index;
+
+			ThreadData(uint8 index);
+
+			Job* AllocateJob();
+		};
+
+		static thread_local ThreadData* localThread;
+		static thread_local JobSystem* localSystem;
+
+		/// \brief index 0 is the constructing (main) thread, the others belong to the workers
+		std::vector<std::unique_ptr<ThreadData>> threadsData;
+		std::vector<std::thread> threads;
+
+		std::atomic<bool> running;
+
+		// sleeping
+		std::mutex sleepLock;
+		std::condition_variable sleepWaiter;
+		std::atomic<int32_t> queuedJobs;
+		std::atomic<int32_t> sleepingWorkers;
+
+		void Worker(uint8 threadIndex);
+
+		template<typename F>
+		struct ParallelForRange
+		{
+			JobSystem* system;
+			Job* root;
+			const F* function;
+			std::size_t from;
+			std::size_t to;
+			std::size_t batchSize;
+
+			void operator()() const;
+		};
+
+		/// \brief get a job from our own queue or steal one from another thread
+		Job* GetJob();
+		void Execute(Job* job);
+		void Finish(Job* job);
+
+		ThreadData& GetThreadData() const;
+
+	public:
+		/// \brief create the job system with the calling thread as main thread
+		/// \param workerCount amount of extra threads, defaults to hardware_concurrency() - 1
+		JobSystem(uint8 workerCount = uint8(std::max(1u, std::thread::hardware_concurrency()) - 1));
+		~JobSystem();
+
+		// disable copy
+		JobSystem(const JobSystem&) = delete;
+		void operator=(const JobSystem&) = delete;
+
+		/// \brief create an empty job, useful as a parent to wait on a group of jobs
+		Job* CreateJob();
+		Job* CreateChildJob(Job* parent);
+
+		/// \brief create a job that calls the given callable, its captures must fit in Job::DataSize
+		template<typename F>
+		Job* CreateJob(F&& callable);
+
+		template<typename F>
+		Job* CreateChildJob(Job* parent, F&& callable);
+
+		/// \brief schedule the job on the current thread's queue
+		void Run(Job* job);
+
+		/// \brief help out executing jobs until the given job and all of its children are finished
+		void WaitFor(const Job* job);
+
+		/// \brief split [0, count) into ranges of batchSize and call function(from, to) for each in parallel
+		/// Only a pointer to function is stored in the jobs, so it has to stay alive until WaitFor() on the returned job
+		/// returned, don't pass a temporary lambda.
+		/// \return the parent job, use WaitFor() on it to synchronize
+		template<typename F>
+		Job* ParallelFor(std::size_t count, std::size_t batchSize, const F& function, Job* parent = nullptr);
+
+		inline std::size_t GetThreadCount() const { return threadsData.size(); }
+
+		/// \brief index of the calling thread in this job system, 0 is the main thread
+		static std::size_t GetThreadIndex();
+
+		/// \brief true on the main thread and the workers of a job system
+		static inline bool IsJobThread() { return localThread != nullptr; }
+
+		/// \brief the job system the calling thread belongs to, nullptr outside of job threads
+		static inline JobSystem* GetLocal() { return localSystem; }
+	};
+}
+
+#include "./JobSystem.inl"
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "JobSystem.h"
+
+namespace Esteem
+{
+	template<typename F>
+	inline Job* JobSystem::CreateJob(F&& callable)
+	{
+		Job* job = GetThreadData().AllocateJob();
+		job->Set(nullptr, std::forward<F>(callable));
+		return job;
+	}
+
+	template<typename F>
+	inline Job* JobSystem::CreateChildJob(Job* parent, F&& callable)
+	{
+		Job* job = GetThreadData().AllocateJob();
+		job->Set(parent, std::forward<F>(callable));
+		return job;
+	}
+
+	template<typename F>
+	inline void JobSystem::ParallelForRange<F>::operator()() const
+	{
+		std::size_t end = to;
+
+		// keep splitting off the upper half so idle threads can steal big chunks
+		while (end - from > batchSize)
+		{
+			std::size_t batches = (end - from + batchSize - 1) / batchSize;
+			std::size_t middle = from + (batches / 2) * batchSize;
+
+			system->Run(system->CreateChildJob(root, ParallelForRange<F>{ system, root, function, middle, end, batchSize }));
+			end = middle;
+		}
+
+		(*function)(from, end);
+	}
+
+	template<typename F>
+	inline Job* JobSystem::ParallelFor(std::size_t count, std::size_t batchSize, const F& function, Job* parent)
+	{
+		Job* root = parent ? CreateChildJob(parent) : CreateJob();
+
+		if (count > 0)
+			Run(CreateChildJob(root, ParallelForRange<F>{ this, root, &function, 0, count, std::max<std::size_t>(batchSize, 1) }));
+
+		Run(root);
+		return root;
+	}
+}
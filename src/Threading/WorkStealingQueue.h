@@ -0,0 +1,104 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <array>
+#include <atomic>
+
+#include "./Job.h"
+
+namespace Esteem
+{
+	/// \brief Lock-free Chase-Lev deque, only the owning thread may Push and Pop, any thread may Steal
+	/// The owner works LIFO on the bottom (hot caches), thieves take the oldest jobs from the top.
+	template<std::size_t Capacity>
+	class WorkStealingQueue
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	private:
+		static constexpr int64_t Mask = int64_t(Capacity - 1);
+
+		alignas(64) std::atomic<int64_t> top;
+		alignas(64) std::atomic<int64_t> bottom;
+		alignas(64) std::array<std::atomic<Job*>, Capacity> jobs;
+
+	public:
+		WorkStealingQueue()
+			: top(0)
+			, bottom(0)
+		{ }
+
+		// disable copy
+		WorkStealingQueue(const WorkStealingQueue&) = delete;
+		void operator=(const WorkStealingQueue&) = delete;
+
+		/// \brief push a job on the bottom, owner thread only
+		/// \return false if the queue is full, the caller should execute the job itself
+		bool Push(Job* job)
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_acquire);
+			if (b - t >= int64_t(Capacity))
+				return false;
+
+			jobs[b & Mask].store(job, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/// \brief pop a job from the bottom, owner thread only
+		Job* Pop()
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+
+			if (t <= b)
+			{
+				Job* job = jobs[b & Mask].load(std::memory_order_relaxed);
+				if (t == b)
+				{
+					// last job, race against thieves
+					if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						job = nullptr;
+
+					bottom.store(b + 1, std::memory_order_relaxed);
+				}
+
+				return job;
+			}
+
+			// queue was already empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		/// \brief steal a job from the top, may be called from any thread
+		Job* Steal()
+		{
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom.load(std::memory_order_acquire);
+
+			if (t < b)
+			{
+				Job* job = jobs[t & Mask].load(std::memory_order_relaxed);
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+
+				return job;
+			}
+
+			return nullptr;
+		}
+
+		inline std::size_t Size() const
+		{
+			int64_t size = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+			return size > 0 ? std::size_t(size) : 0;
+		}
+	};
+}
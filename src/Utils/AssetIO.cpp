@@ -0,0 +1,334 @@
+#include "AssetIO.h"
+
+#include <filesystem>
+
+#include "Utils/Data.h"
+#include "Utils/PakArchive.h"
+#include "Utils/Profiler.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		/// \brief size of the asset as Data::ReadAsset() would find it, 0 if unknown
+		std::size_t GetAssetSize(const std::string& path)
+		{
+			std::error_code errorCode;
+			std::uintmax_t fileSize = std::filesystem::file_size(path, errorCode);
+			if (!errorCode)
+				return std::size_t(fileSize);
+
+			auto guard = Data::LockPaks();
+			const PakArchive::Entry* entry;
+			if (Data::FindInPaks(path, entry) != nullptr)
+				return entry->uncompressedSize;
+
+			return 0;
+		}
+	}
+
+	AssetRequest::AssetRequest(AssetIO* owner, std::string_view path, std::string&& key, AssetPriority priority)
+		: owner(owner)
+		, path(path)
+		, key(std::move(key))
+		, found(false)
+		, state(State::QUEUED)
+		, priority(priority)
+		, handles(0)
+	{ }
+
+	AssetHandle::AssetHandle(const std::shared_ptr<AssetRequest>& request)
+		: request(request)
+	{ }
+
+	AssetHandle::AssetHandle(const AssetHandle& copy)
+		: request(copy.request)
+	{
+		if (request)
+			++request->handles;
+	}
+
+	AssetHandle::~AssetHandle()
+	{
+		Reset();
+	}
+
+	AssetHandle& AssetHandle::operator=(const AssetHandle& copy)
+	{
+		if (request != copy.request)
+		{
+			if (copy.request)
+				++copy.request->handles;
+
+			Reset();
+			request = copy.request;
+		}
+
+		return *this;
+	}
+
+	AssetHandle& AssetHandle::operator=(AssetHandle&& move) noexcept
+	{
+		if (this != &move)
+		{
+			Reset();
+			request = std::move(move.request);
+		}
+
+		return *this;
+	}
+
+	bool AssetHandle::IsReady() const
+	{
+		return request && request->state == AssetRequest::State::DONE;
+	}
+
+	const std::string& AssetHandle::Wait() const
+	{
+		static const std::string empty;
+		if (!request)
+			return empty;
+
+		if (request->state == AssetRequest::State::QUEUED && request->owner != nullptr)
+			request->owner->Raise(request, AssetPriority::CRITICAL);
+
+		std::unique_lock<std::mutex> requestLock(request->lock);
+		request->finished.wait(requestLock, [this]()
+		{
+			AssetRequest::State state = request->state;
+			return state == AssetRequest::State::DONE || state == AssetRequest::State::CANCELLED;
+		});
+
+		return request->state == AssetRequest::State::DONE ? request->contents : empty;
+	}
+
+	const std::string& AssetHandle::GetPath() const
+	{
+		static const std::string empty;
+		return request ? request->path : empty;
+	}
+
+	void AssetHandle::Reset()
+	{
+		if (request)
+		{
+			// only a queued request needs its owner, finished requests may outlive the AssetIO
+			if (--request->handles == 0 && request->state == AssetRequest::State::QUEUED)
+				request->owner->Release(request);
+
+			request.reset();
+		}
+	}
+
+	AssetIO::AssetIO(uint8 threadCount, std::size_t maxBytesInFlight)
+		: nextSequence(0)
+		, maxBytesInFlight(maxBytesInFlight)
+		, bytesInFlight(0)
+		, completedReads(0)
+		, cancelledReads(0)
+		, mergedReads(0)
+		, running(true)
+	{
+		threadCount = std::max<uint8>(threadCount, 1);
+		for (uint8 i = 0; i < threadCount; ++i)
+			threads.emplace_back(&AssetIO::Worker, this, i);
+	}
+
+	AssetIO::~AssetIO()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			running = false;
+
+			// reads that already started are finished by their worker
+			std::vector<std::shared_ptr<AssetRequest>> queued;
+			for (const auto& [key, request] : pending)
+			{
+				if (request->state == AssetRequest::State::QUEUED)
+					queued.push_back(request);
+			}
+
+			for (const std::shared_ptr<AssetRequest>& request : queued)
+				Cancel(request);
+
+			queue = std::priority_queue<QueueEntry>();
+		}
+
+		wakeUp.notify_all();
+		bytesReleased.notify_all();
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	AssetHandle AssetIO::Read(std::string_view path, AssetPriority priority, AssetRequest::Callback callback)
+	{
+		std::string key = PakArchive::NormalizePath(path);
+
+		std::lock_guard<std::mutex> guard(lock);
+		if (!running)
+			return Completed(path, std::string(), false);
+
+		std::shared_ptr<AssetRequest> request;
+
+		auto found = pending.find(key);
+		if (found != pending.end())
+		{
+			// already queued or being read, share the result
+			request = found->second;
+			++mergedReads;
+			Prioritize(request, priority);
+		}
+		else
+		{
+			request = std::make_shared<AssetRequest>(this, path, std::move(key), priority);
+			pending.emplace(request->key, request);
+			queue.push(QueueEntry{ request, priority, nextSequence++ });
+			wakeUp.notify_one();
+		}
+
+		// still pending, so Finish() can't have collected the callbacks yet
+		if (callback)
+		{
+			std::lock_guard<std::mutex> requestGuard(request->lock);
+			request->callbacks.push_back(std::move(callback));
+		}
+
+		++request->handles;
+		return AssetHandle(request);
+	}
+
+	AssetHandle AssetIO::Completed(std::string_view path, std::string&& contents, bool found)
+	{
+		auto request = std::make_shared<AssetRequest>(nullptr, path, std::string(), AssetPriority::CRITICAL);
+		request->contents = std::move(contents);
+		request->found = found;
+		request->state = AssetRequest::State::DONE;
+		request->handles = 1;
+
+		return AssetHandle(request);
+	}
+
+	void AssetIO::Prioritize(const std::shared_ptr<AssetRequest>& request, AssetPriority priority)
+	{
+		if (priority < request->priority && request->state == AssetRequest::State::QUEUED)
+		{
+			// the old entry becomes stale, see Worker()
+			request->priority = priority;
+			queue.push(QueueEntry{ request, priority, nextSequence++ });
+			wakeUp.notify_one();
+		}
+	}
+
+	void AssetIO::Raise(const std::shared_ptr<AssetRequest>& request, AssetPriority priority)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		Prioritize(request, priority);
+	}
+
+	void AssetIO::Release(const std::shared_ptr<AssetRequest>& request)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		// a merging Read() may have picked the request up again in the meantime
+		if (request->handles == 0 && request->state == AssetRequest::State::QUEUED)
+			Cancel(request);
+	}
+
+	void AssetIO::Cancel(const std::shared_ptr<AssetRequest>& request)
+	{
+		auto found = pending.find(request->key);
+		if (found != pending.end() && found->second == request)
+			pending.erase(found);
+
+		{
+			std::lock_guard<std::mutex> requestGuard(request->lock);
+			request->state = AssetRequest::State::CANCELLED;
+			request->callbacks.clear();
+		}
+
+		request->finished.notify_all();
+		++cancelledReads;
+	}
+
+	void AssetIO::Worker(uint8 threadIndex)
+	{
+		Profiler::SetThreadName("AssetIO " + std::to_string(threadIndex));
+
+		std::unique_lock<std::mutex> guard(lock);
+		while (true)
+		{
+			wakeUp.wait(guard, [this]() { return !running || !queue.empty(); });
+			if (!running)
+				break;
+
+			std::shared_ptr<AssetRequest> request = queue.top().request;
+			AssetPriority priority = queue.top().priority;
+			queue.pop();
+
+			// cancelled, or re-queued with a higher priority
+			if (request->state != AssetRequest::State::QUEUED || priority != request->priority)
+				continue;
+
+			request->state = AssetRequest::State::READING;
+
+			guard.unlock();
+			std::size_t size = GetAssetSize(request->path);
+			guard.lock();
+
+			// always let a single read through, so assets larger than the cap still load
+			bytesReleased.wait(guard, [this, size]() { return !running || bytesInFlight == 0 || bytesInFlight + size <= maxBytesInFlight; });
+
+			if (!running || request->handles == 0)
+			{
+				Cancel(request);
+				continue;
+			}
+
+			bytesInFlight += size;
+			guard.unlock();
+
+			Read(*request);
+
+			guard.lock();
+			bytesInFlight -= size;
+			bytesReleased.notify_all();
+
+			auto found = pending.find(request->key);
+			if (found != pending.end() && found->second == request)
+				pending.erase(found);
+
+			guard.unlock();
+			Finish(request);
+			guard.lock();
+		}
+	}
+
+	void AssetIO::Read(AssetRequest& request)
+	{
+		ESTEEM_PROFILE("AssetIO::Read");
+
+		request.contents = Data::ReadAsset(request.path);
+		request.found = !request.contents.empty() || Data::AssetExists(request.path);
+	}
+
+	void AssetIO::Finish(const std::shared_ptr<AssetRequest>& request)
+	{
+		std::vector<AssetRequest::Callback> callbacks;
+		{
+			std::lock_guard<std::mutex> requestGuard(request->lock);
+			request->state = AssetRequest::State::DONE;
+			callbacks.swap(request->callbacks);
+		}
+
+		request->finished.notify_all();
+		++completedReads;
+
+		// nobody is interested anymore when all handles were dropped during the read
+		if (request->handles > 0)
+		{
+			for (const AssetRequest::Callback& callback : callbacks)
+				callback(request->contents, request->found);
+		}
+	}
+}
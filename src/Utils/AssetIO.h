@@ -0,0 +1,187 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Esteem
+{
+	class AssetIO;
+
+	enum class AssetPriority : uint8
+	{
+		CRITICAL = 0,	// needed to finish the current frame or load, the caller is (or will be) waiting
+		VISIBLE = 1,	// visible (soon), e.g.: textures of objects that just came into view
+		PREFETCH = 2	// speculative, only read when nothing else is waiting
+	};
+
+	/// \brief shared state of one (merged) read, only accessed through AssetHandle
+	class AssetRequest
+	{
+		friend class AssetIO;
+		friend class AssetHandle;
+
+	public:
+		typedef std::function<void(const std::string& contents, bool found)> Callback;
+
+		enum class State : uint8
+		{
+			QUEUED,
+			READING,
+			DONE,
+			CANCELLED
+		};
+
+	private:
+		AssetIO* owner;
+		std::string path;
+		/// \brief normalized path, used to merge requests
+		std::string key;
+		std::string contents;
+		bool found;
+
+		std::atomic<State> state;
+		/// \brief current (highest requested) priority, guarded by the owner's lock
+		AssetPriority priority;
+		/// \brief alive AssetHandles, the request is cancelled when this drops to 0 before it is read
+		std::atomic<uint32_t> handles;
+
+		std::mutex lock;
+		std::condition_variable finished;
+		std::vector<Callback> callbacks;
+
+	public:
+		AssetRequest(AssetIO* owner, std::string_view path, std::string&& key, AssetPriority priority);
+
+		// disable copy
+		AssetRequest(const AssetRequest&) = delete;
+		void operator=(const AssetRequest&) = delete;
+	};
+
+	/// \brief future-like handle to an asynchronous read, dropping the last handle of a queued read cancels it
+	class AssetHandle
+	{
+		friend class AssetIO;
+
+	private:
+		std::shared_ptr<AssetRequest> request;
+
+		AssetHandle(const std::shared_ptr<AssetRequest>& request);
+
+	public:
+		AssetHandle() = default;
+		AssetHandle(const AssetHandle& copy);
+		AssetHandle(AssetHandle&& move) noexcept = default;
+		~AssetHandle();
+
+		AssetHandle& operator=(const AssetHandle& copy);
+		AssetHandle& operator=(AssetHandle&& move) noexcept;
+
+		inline bool IsValid() const { return request != nullptr; }
+		bool IsReady() const;
+
+		/// \brief block until the read is finished, a queued read is bumped to CRITICAL first
+		/// \return the contents, empty when the asset could not be found or the read was cancelled
+		const std::string& Wait() const;
+
+		/// \brief only call after IsReady() or Wait()
+		inline bool Found() const { return request && request->found; }
+
+		/// \brief path as it was requested, empty for an invalid handle
+		const std::string& GetPath() const;
+
+		/// \brief release this handle, same as dropping it
+		void Reset();
+	};
+
+	/// \brief asynchronous asset reads on a few dedicated I/O threads
+	/// Reads are taken from a priority heap (CRITICAL first, FIFO within a priority). Requests for a path that is
+	/// already queued or being read are merged, a merged request takes the highest priority of its requesters.
+	/// At most maxBytesInFlight bytes are being read at once, a single larger asset is still allowed on its own.
+	/// Callbacks are called on an I/O thread.
+	class AssetIO
+	{
+		friend class AssetHandle;
+
+	public:
+		static constexpr uint8 DefaultThreadCount = 2;
+		static constexpr std::size_t DefaultMaxBytesInFlight = 64 * 1024 * 1024;
+
+	private:
+		struct QueueEntry
+		{
+			std::shared_ptr<AssetRequest> request;
+			AssetPriority priority;
+			uint64_t sequence;
+
+			inline bool operator<(const QueueEntry& other) const
+			{
+				// std::priority_queue pops the largest, so lower priority values and older sequences compare greater
+				return priority != other.priority ? priority > other.priority : sequence > other.sequence;
+			}
+		};
+
+		std::mutex lock;
+		std::condition_variable wakeUp;
+		std::condition_variable bytesReleased;
+
+		/// \brief may contain stale entries of cancelled or re-prioritized requests, they are skipped when popped
+		std::priority_queue<QueueEntry> queue;
+		/// \brief requests that are queued or being read, by normalized path
+		std::unordered_map<std::string, std::shared_ptr<AssetRequest>> pending;
+		uint64_t nextSequence;
+
+		std::size_t maxBytesInFlight;
+		std::size_t bytesInFlight;
+
+		std::atomic<std::size_t> completedReads;
+		std::atomic<std::size_t> cancelledReads;
+		std::atomic<std::size_t> mergedReads;
+
+		bool running;
+		std::vector<std::thread> threads;
+
+		void Worker(uint8 threadIndex);
+		void Read(AssetRequest& request);
+		/// \brief mark the request cancelled, drop it from pending and wake its waiters, caller must hold the lock
+		void Cancel(const std::shared_ptr<AssetRequest>& request);
+		void Finish(const std::shared_ptr<AssetRequest>& request);
+
+		/// \brief push a new queue entry when the priority went up, caller must hold the lock
+		void Prioritize(const std::shared_ptr<AssetRequest>& request, AssetPriority priority);
+
+		/// \brief called when the last handle of a request is dropped
+		void Release(const std::shared_ptr<AssetRequest>& request);
+		void Raise(const std::shared_ptr<AssetRequest>& request, AssetPriority priority);
+
+	public:
+		AssetIO(uint8 threadCount = DefaultThreadCount, std::size_t maxBytesInFlight = DefaultMaxBytesInFlight);
+		/// \brief cancels everything that is still queued and joins the I/O threads
+		~AssetIO();
+
+		// disable copy
+		AssetIO(const AssetIO&) = delete;
+		void operator=(const AssetIO&) = delete;
+
+		/// \brief queue a read of the asset (loose file or pak), see Data::ReadAsset()
+		/// \param callback optional, called on an I/O thread once the read finished and was not cancelled
+		AssetHandle Read(std::string_view path, AssetPriority priority, AssetRequest::Callback callback = AssetRequest::Callback());
+
+		inline std::size_t GetCompletedReads() const { return completedReads; }
+		inline std::size_t GetCancelledReads() const { return cancelledReads; }
+		inline std::size_t GetMergedReads() const { return mergedReads; }
+
+		/// \brief already finished handle, e.g.: for a synchronous fallback
+		static AssetHandle Completed(std::string_view path, std::string&& contents, bool found);
+	};
+}
@@ -1,5 +1,7 @@
 #include "./CPreProcessor.h"
 
+#include <algorithm>
+#include <iterator>
 #include <sstream>
 
 #include "Utils/Data.h"
@@ -8,7 +10,8 @@
 
 namespace Esteem
 {
-	std::string CPreProcessor::ProcessStreamToString(cgc::raw_ptr<std::istream> stream, std::string path, const std::string& workingDirectory, std::unordered_map<std::string, std::string>& defines, std::vector<std::string>& includes)
+	std::string CPreProcessor::ProcessStreamToString(cgc::raw_ptr<std::istream> stream, std::string path, const std::string& workingDirectory, std::unordered_map<std::string, std::string>& defines, std::vector<std::string>& includes,
+		std::vector<std::string>* dependencies)
 	{
 		std::string output;
 		std::string line;
@@ -19,6 +22,9 @@ namespace Esteem
 		// add this file to the includes list, to prevent cyclic inclusion
 		includes.push_back(path);
 
+		if (dependencies && std::find(dependencies->begin(), dependencies->end(), path) == dependencies->end())
+			dependencies->push_back(path);
+
 		// write upcomming line
 		bool writeLine = true;
 		// are we in an if statement?
@@ -32,8 +38,29 @@ namespace Esteem
 		// does this command really contains a command?
 		bool validCommand = false;
 
+		// the includes are read on the I/O threads while this file is processed, reads of includes that end up unused are cancelled
+		std::string source((std::istreambuf_iterator<char>(*stream)), std::istreambuf_iterator<char>());
+		std::unordered_map<std::string, AssetHandle> includeReads;
+		{
+			std::istringstream sourceLines(source);
+			while (std::getline(sourceLines, line))
+			{
+				HashCommand hashCommand = CPreProcessor::RetrieveHashCommand(line);
+				if (hashCommand.command == "#include")
+				{
+					std::string includePath = workingDirectory + hashCommand.value;
+					StringParser::StripAll(includePath, "./");
+
+					if (includeReads.find(includePath) == includeReads.end())
+						includeReads.emplace(includePath, Data::ReadAssetAsync(includePath));
+				}
+			}
+		}
+
+		std::istringstream sourceLines(source);
+
 		uint lineNumber = 0;
-		while (std::getline(*stream, line))
+		while (std::getline(sourceLines, line))
 		{
 			// helpful with errors
 			++lineNumber;
@@ -113,10 +140,15 @@ namespace Esteem
 					{
 						if (std::find(includes.begin(), includes.end(), includePath) == includes.end())
 						{
-							size_t size;
-							cgc::strong_ptr<std::istream> ifs = Data::StreamAsset(includePath, size);
-							if (ifs)
-								output += CPreProcessor::ProcessStreamToString(ifs, includePath, workingDirectory, defines, includes) + "\r\n";
+							auto found = includeReads.find(includePath);
+							AssetHandle includeRead = found != includeReads.end() ? found->second : Data::ReadAssetAsync(includePath, AssetPriority::CRITICAL);
+
+							const std::string& contents = includeRead.Wait();
+							if (includeRead.Found())
+							{
+								cgc::strong_ptr<std::istream> includeStream = cgc::construct_new<std::istringstream>(contents);
+								output += CPreProcessor::ProcessStreamToString(includeStream, includePath, workingDirectory, defines, includes, dependencies) + "\r\n";
+							}
 							else
 								Debug::LogError("Could not load file to include: " + includePath);
 						}
@@ -189,11 +221,58 @@ namespace Esteem
 		}
 
 		// remove this file from the includes list, make sure we can reinclude this file
-		includes.push_back(path);
+		includes.pop_back();
 
 		return output;
 	}
 
+	namespace
+	{
+		constexpr std::string_view PackedDefine = "//! define ";
+	}
+
+	std::string CPreProcessor::PackProcessed(const std::string& processed, const std::unordered_map<std::string, std::string>& defines)
+	{
+		// sorted, the same input always packs to the same bytes
+		std::vector<const std::pair<const std::string, std::string>*> sorted;
+		sorted.reserve(defines.size());
+		for (auto& define : defines)
+			sorted.push_back(&define);
+
+		std::sort(sorted.begin(), sorted.end(), [](auto* a, auto* b) { return a->first < b->first; });
+
+		std::string packed;
+		for (auto* define : sorted)
+		{
+			packed += PackedDefine;
+			packed += define->first;
+			packed += ' ';
+			packed += define->second;
+			packed += '\n';
+		}
+
+		return packed + processed;
+	}
+
+	std::string CPreProcessor::UnpackProcessed(std::string_view packed, std::unordered_map<std::string, std::string>& defines)
+	{
+		while (packed.substr(0, PackedDefine.size()) == PackedDefine)
+		{
+			std::size_t end = packed.find('\n');
+			if (end == std::string_view::npos)
+				break;
+
+			std::string_view define = packed.substr(PackedDefine.size(), end - PackedDefine.size());
+			std::size_t separator = define.find(' ');
+			if (separator != std::string_view::npos)
+				defines[std::string(define.substr(0, separator))] = std::string(define.substr(separator + 1));
+
+			packed.remove_prefix(end + 1);
+		}
+
+		return std::string(packed);
+	}
+
 	std::vector<HashCommand> CPreProcessor::RetrieveHashCommands(const std::string& string)
 	{
 		std::vector<HashCommand> commands;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <istream>
@@ -45,8 +46,18 @@ namespace Esteem
 		/// \param workingDirectory		Which directory are we working from?
 		/// \param defines				All defines.
 		/// \param includes				All recent included files, anti cyclic inclusion: works in a hierarchal way, adds it when parsing and removes it when done parsing.
+		/// \param dependencies			Optional, receives every processed file (this one included) once.
 		/// \return						String, returns the stream fully processed.
-		static std::string ProcessStreamToString(cgc::raw_ptr<std::istream> stream, std::string path, const std::string& workingDirectory, std::unordered_map<std::string, std::string>& defines, std::vector<std::string>& includes);
+		static std::string ProcessStreamToString(cgc::raw_ptr<std::istream> stream, std::string path, const std::string& workingDirectory, std::unordered_map<std::string, std::string>& defines, std::vector<std::string>& includes,
+			std::vector<std::string>* dependencies = nullptr);
+
+		/// \brief	Prefix processed output with the defines it ended with, as comments, for storing it.
+		///			EsteemCook and the derived data cache store shaders like this, so defines set by the shader itself survive.
+		static std::string PackProcessed(const std::string& processed, const std::unordered_map<std::string, std::string>& defines);
+
+		/// \brief	Take the defines of PackProcessed() off again, plain processed output passes through unchanged.
+		/// \return	The processed output.
+		static std::string UnpackProcessed(std::string_view packed, std::unordered_map<std::string, std::string>& defines);
 
 		/// \brief	Finds all has commands per line in a string and parses them.
 		/// \param string	String to parse.
@@ -0,0 +1,68 @@
+#include "CookedAssets.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Esteem
+{
+	namespace
+	{
+		inline uint64_t HashBytes(uint64_t hash, std::string_view bytes)
+		{
+			// FNV-1a
+			for (char c : bytes)
+			{
+				hash ^= uint8_t(c);
+				hash *= 0x100000001b3ull;
+			}
+
+			return hash;
+		}
+	}
+
+	std::string CookedAssets::GetModelPath(std::string_view sourcePath)
+	{
+		return std::string(sourcePath) + ".mdl";
+	}
+
+	std::string CookedAssets::GetTexturePath(std::string_view sourcePath)
+	{
+		return std::string(sourcePath) + ".tex";
+	}
+
+	std::string CookedAssets::GetShaderPath(std::string_view sourcePath, const std::unordered_map<std::string, std::string>& defines)
+	{
+		static const char digits[] = "0123456789abcdef";
+
+		uint64_t hash = HashDefines(defines);
+
+		std::string path(sourcePath);
+		path += '.';
+		for (int shift = 60; shift >= 0; shift -= 4)
+			path += digits[(hash >> shift) & 0xF];
+
+		return path;
+	}
+
+	uint64_t CookedAssets::HashDefines(const std::unordered_map<std::string, std::string>& defines)
+	{
+		std::vector<const std::pair<const std::string, std::string>*> sorted;
+		sorted.reserve(defines.size());
+		for (auto& define : defines)
+			sorted.push_back(&define);
+
+		std::sort(sorted.begin(), sorted.end(), [](auto* a, auto* b) { return a->first < b->first; });
+
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (auto* define : sorted)
+		{
+			// the separators include their terminating zero, which keys and values never contain
+			hash = HashBytes(hash, define->first);
+			hash = HashBytes(hash, std::string_view("=", 2));
+			hash = HashBytes(hash, define->second);
+			hash = HashBytes(hash, std::string_view(";", 2));
+		}
+
+		return hash;
+	}
+}
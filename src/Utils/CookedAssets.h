@@ -0,0 +1,32 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Esteem
+{
+	/// \brief naming of the outputs EsteemCook writes next to their sources, shared by the cooker and the loaders
+	/// Loaders check for the cooked variant first and only convert at runtime when it isn't there.
+	class CookedAssets
+	{
+	public:
+		/// \brief bump when any cooked output changes, so every asset is cooked again
+		static constexpr uint32_t Version = 1;
+
+		/// \brief e.g.: "models/crate.fbx" -> "models/crate.fbx.mdl"
+		static std::string GetModelPath(std::string_view sourcePath);
+
+		/// \brief e.g.: "textures/wood.png" -> "textures/wood.png.tex", see TextureContainer
+		static std::string GetTexturePath(std::string_view sourcePath);
+
+		/// \brief preprocessed shader for one set of defines, e.g.: "shaders/diffuse.glfs.6c62272e07bb0142"
+		static std::string GetShaderPath(std::string_view sourcePath, const std::unordered_map<std::string, std::string>& defines);
+
+		/// \brief order independent hash of the defines
+		static uint64_t HashDefines(const std::unordered_map<std::string, std::string>& defines);
+	};
+}
@@ -3,7 +3,7 @@
 #include <algorithm>
 #include <filesystem>
 
-#include "details/izafstream.h"
+#include "details/ipakstream.h"
 #include "Utils/Debug.h"
 #include <sys/stat.h>
 
@@ -64,9 +64,19 @@ namespace Esteem
 	ModelFactory Data::modelFactory = ModelFactory();
 	//WorldFactory Data::worldFactory = WorldFactory();
 	std::vector<RenderingFactory*> Data::renderingFactories = std::vector<RenderingFactory*>();
+	std::vector<Data::MountedPak> Data::paks = std::vector<Data::MountedPak>();
+	std::shared_mutex Data::paksLock;
+	std::unique_ptr<AssetIO> Data::assetIO;
+	DerivedDataCache Data::derivedDataCache;
 
 	void Data::Initialize()
 	{
+		if (FileExists(ROOT_PATH + "data.pak"))
+			MountPak(ROOT_PATH + "data.pak");
+
+		assetIO = std::make_unique<AssetIO>();
+		derivedDataCache.Open(DerivedDataCache::GetDefaultDirectory());
+
 		InitializeDefaultFactories();
 	}
 
@@ -81,6 +91,12 @@ namespace Esteem
 		//for (auto it = renderingFactories.begin(); it != renderingFactories.end(); ++it)
 		//	delete* it;
 		renderingFactories.clear();
+
+		// the I/O threads read from the paks
+		assetIO.reset();
+		UnmountPaks();
+
+		derivedDataCache.Close();
 	}
 
 	void Data::InitializeDefaultFactories()
@@ -148,27 +164,10 @@ namespace Esteem
 			std::error_code errorCode;
 			if (std::filesystem::exists(path.data(), errorCode))
 				return true;
-			else
-			{
-				if (Data::FileExists(ROOT_PATH + "data.pak"))
-				{
-					void* zipFile = unzOpen((ROOT_PATH + "data.pak").c_str());
-					if (zipFile != nullptr)
-					{
-						std::string p(path);
-						const char* newPath = p.c_str();
-						newPath += newPath[1] == '/' ? 2 : newPath[0] == '/' ? 1 : 0;
 
-						if (unzLocateFile(zipFile, newPath, 2) == UNZ_OK)
-						{
-							unzClose(zipFile);
-							return true;
-						}
-
-						unzClose(zipFile);
-					}
-				}
-			}
+			std::shared_lock<std::shared_mutex> guard(paksLock);
+			const PakArchive::Entry* entry;
+			return FindInPaks(path, entry) != nullptr;
 		}
 
 		return false;
@@ -219,41 +218,31 @@ namespace Esteem
 					return bytes;
 				}
 			}
-			else if (Data::FileExists(ROOT_PATH + "data.pak"))
+			else
 			{
-				void* zipFile = unzOpen((ROOT_PATH + "data.pak").c_str());
-				if (zipFile != nullptr)
-				{
-					std::string p(path);
-					const char* newPath = p.c_str();
-					newPath += newPath[1] == '/' ? 2 : newPath[0] == '/' ? 1 : 0;
-
-					if (unzLocateFile(zipFile, newPath, 2) == UNZ_OK)
-					{
-						if (unzOpenCurrentFile(zipFile) == UNZ_OK)
-						{
-							unz_file_info_s fileInfo;
-							unzGetCurrentFileInfo(zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0);
-
-							std::string contents;
-							contents.resize(fileInfo.uncompressed_size);
-							unzReadCurrentFile(zipFile, contents.data(), fileInfo.uncompressed_size);
-
-							unzCloseCurrentFile(zipFile);
-							unzClose(zipFile);
-
-							return contents;
-						}
-					}
-
-					unzClose(zipFile);
-				}
+				std::shared_lock<std::shared_mutex> guard(paksLock);
+				const PakArchive::Entry* entry;
+				if (const PakArchive* pak = FindInPaks(path, entry))
+					return pak->Read(*entry);
 			}
 		}
 
 		return "";
 	}
 
+	AssetHandle Data::ReadAssetAsync(std::string_view path, AssetPriority priority, AssetRequest::Callback callback)
+	{
+		if (assetIO)
+			return assetIO->Read(path, priority, std::move(callback));
+
+		std::string contents = ReadAsset(path);
+		bool found = !contents.empty() || AssetExists(path);
+		if (callback)
+			callback(contents, found);
+
+		return AssetIO::Completed(path, std::move(contents), found);
+	}
+
 	cgc::strong_ptr<std::istream> Data::StreamAsset(std::string_view path, size_t& size)
 	{
 		if (path.size() > 0)
@@ -286,24 +275,27 @@ namespace Esteem
 				stream->seekg(0);
 				return stream;
 			}
-			else if (Data::FileExists(ROOT_PATH + "data.pak"))
+			else
 			{
-				void* zipFile = unzOpen((ROOT_PATH + "data.pak").c_str());
-				if (zipFile != nullptr)
+				std::shared_lock<std::shared_mutex> guard(paksLock);
+				const PakArchive::Entry* entry;
+				if (const PakArchive* pak = FindInPaks(path, entry))
 				{
-					std::string p(path);
-					const char* newPath = p.c_str();
-					newPath += newPath[1] == '/' ? 2 : newPath[0] == '/' ? 1 : 0;
+					size = entry->uncompressedSize;
 
-					if (unzLocateFile(zipFile, newPath, 2) == UNZ_OK
-						&& unzOpenCurrentFile(zipFile) == UNZ_OK)
-					{
-						auto stream = cgc::construct_new<izafstream>(zipFile);
-						size = stream->get_uncompressed_size();
-						return stream;
-					}
+					// stored entries are streamed straight from the mapping
+					mm::array_view view = pak->View(*entry);
+					if (!view.empty())
+						return cgc::construct_new<ipakstream>(static_cast<const char*>(view.data()), view.size());
 
-					unzClose(zipFile);
+					// large entries are inflated while reading, small ones at once
+					mm::array_view compressed = pak->GetCompressedData(*entry);
+					if (size >= StreamInflateThreshold && !compressed.empty())
+						return cgc::construct_new<ipakstream>(static_cast<const uint8_t*>(compressed.data()), compressed.size(), size, pak->GetSeekIndex(*entry));
+
+					std::string contents = pak->Read(*entry);
+					if (contents.size() == size)
+						return cgc::construct_new<ipakstream>(std::move(contents));
 				}
 			}
 		}
@@ -311,6 +303,16 @@ namespace Esteem
 		return cgc::strong_ptr<std::istream>();
 	}
 
+	mm::array_view Data::MapAsset(std::string_view path)
+	{
+		std::shared_lock<std::shared_mutex> guard(paksLock);
+		const PakArchive::Entry* entry;
+		if (const PakArchive* pak = FindInPaks(path, entry))
+			return pak->View(*entry);
+
+		return mm::array_view();
+	}
+
 	bool Data::WriteFile(std::string_view path, const char* content, uint size)
 	{
 		if (path.size() > 0)
@@ -413,6 +415,64 @@ namespace Esteem
 	{
 	}
 
+	bool Data::MountPak(const std::string& path, int priority)
+	{
+		auto archive = std::make_unique<PakArchive>();
+		if (!archive->Open(path))
+		{
+			Debug::LogError("Could not mount pak \"" + path + "\"");
+			return false;
+		}
+
+		std::unique_lock<std::shared_mutex> guard(paksLock);
+
+		// insert before the first pak with a lower or equal priority, so the newest one wins ties
+		auto it = std::find_if(paks.begin(), paks.end(), [priority](const MountedPak& pak) { return pak.priority <= priority; });
+		paks.insert(it, MountedPak{ std::move(archive), priority });
+
+		return true;
+	}
+
+	bool Data::UnmountPak(const std::string& path)
+	{
+		std::unique_lock<std::shared_mutex> guard(paksLock);
+		auto found = std::find_if(paks.begin(), paks.end(), [&path](const MountedPak& pak) { return pak.archive->GetPath() == path; });
+		if (found == paks.end())
+			return false;
+
+		paks.erase(found);
+		return true;
+	}
+
+	void Data::UnmountPaks()
+	{
+		std::unique_lock<std::shared_mutex> guard(paksLock);
+		paks.clear();
+	}
+
+	std::shared_lock<std::shared_mutex> Data::LockPaks()
+	{
+		return std::shared_lock<std::shared_mutex>(paksLock);
+	}
+
+	const PakArchive* Data::FindInPaks(std::string_view path, const PakArchive::Entry*& entry)
+	{
+		for (const MountedPak& pak : paks)
+		{
+			entry = pak.archive->Find(path);
+			if (entry != nullptr)
+				return pak.archive.get();
+		}
+
+		entry = nullptr;
+		return nullptr;
+	}
+
+	DerivedDataCache& Data::GetDerivedDataCache()
+	{
+		return derivedDataCache;
+	}
+
 	IFactory* Data::FindFactory(const char* typeName, const std::string& search)
 	{
 		for (uint i = 0; i < factories.size(); ++i)
@@ -11,8 +11,14 @@
 
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <shared_mutex>
 #include "rapidjson/document.h"
 
+#include "Utils/AssetIO.h"
+#include "Utils/DerivedDataCache.h"
+#include "Utils/PakArchive.h"
+
 namespace Esteem
 {
 
@@ -34,6 +40,18 @@ namespace Esteem
 	class Data
 	{
 	private:
+		struct MountedPak
+		{
+			std::unique_ptr<PakArchive> archive;
+			int priority;
+		};
+
+		/// \brief ordered from highest to lowest priority
+		static std::vector<MountedPak> paks;
+		/// \brief shared while paks are searched and read, exclusive while (un)mounting
+		static std::shared_mutex paksLock;
+		static std::unique_ptr<AssetIO> assetIO;
+		static DerivedDataCache derivedDataCache;
 
 		static std::vector<IFactory*> factories;
 		static ModelFactory modelFactory;
@@ -45,6 +63,9 @@ namespace Esteem
 	public:
 		static const std::string ROOT_PATH;
 
+		/// \brief compressed pak entries of at least this size are streamed instead of inflated up front
+		static constexpr std::size_t StreamInflateThreshold = 1024 * 1024;
+
 		/// \brief Initialize Data utility
 		static void Initialize();
 
@@ -60,9 +81,17 @@ namespace Esteem
 		static void LoadFile(std::string_view path);
 
 		static std::string ReadAsset(std::string_view path);
+		/// \brief read the asset on one of the I/O threads, see AssetIO
+		/// Falls back to a synchronous read when Data is not initialized.
+		static AssetHandle ReadAssetAsync(std::string_view path, AssetPriority priority = AssetPriority::VISIBLE, AssetRequest::Callback callback = AssetRequest::Callback());
 		static cgc::strong_ptr<std::istream> StreamAsset(std::string_view path, size_t& size);
 		static bool WriteFile(std::string_view path, const char* content, uint size);
 
+		/// \brief zero-copy view of an asset stored uncompressed in a mounted pak
+		/// \return an empty view when the asset is not in a pak or is compressed, fall back to ReadAsset()
+		/// The view is valid until the pak is unmounted.
+		static mm::array_view MapAsset(std::string_view path);
+
 		static std::vector<std::string> ListDirectory(std::string_view path, ListDirectoryOptions listOptions = ListDirectoryOptions::LIST_ALL);
 
 		static rapidjson::Document ReadJSONFile(std::string_view path);
@@ -71,6 +100,25 @@ namespace Esteem
 		static void WriteJSON();
 	#pragma endregion
 
+	#pragma region Paks
+		/// \brief open and index a pak once, entries of higher priority paks override those of lower ones
+		/// With equal priorities the last mounted pak wins. (Un)mounting waits for the reads that are using a pak,
+		/// views of MapAsset() and streams of StreamAsset() into an unmounted pak must be released before.
+		static bool MountPak(const std::string& path, int priority = 0);
+		static bool UnmountPak(const std::string& path);
+		static void UnmountPaks();
+
+		/// \brief hold the returned lock while using the results of FindInPaks()
+		static std::shared_lock<std::shared_mutex> LockPaks();
+
+		/// \brief find the pak entry that serves the given path, the caller holds LockPaks()
+		/// \return nullptr when none of the mounted paks contains the path
+		static const PakArchive* FindInPaks(std::string_view path, const PakArchive::Entry*& entry);
+	#pragma endregion
+
+		/// \brief results of runtime conversions of uncooked assets, closed (always building) until Initialize()
+		static DerivedDataCache& GetDerivedDataCache();
+
 	#pragma region Factories
 		static void Register(IFactory* factory);
 		static void Register(RenderingFactory* factory);
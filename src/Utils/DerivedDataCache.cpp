@@ -0,0 +1,451 @@
+#include "DerivedDataCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "Utils/Data.h"
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr char Magic[4] = { 'E', 'D', 'D', 'C' };
+		constexpr const char* EntryExtension = ".ddc";
+		constexpr const char* TemporaryExtension = ".tmp";
+
+		/// \brief temporary files this old were left behind by a writer that crashed
+		constexpr std::chrono::hours StaleTemporaryAge(1);
+
+		constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+		constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+
+		inline uint64_t Rotate(uint64_t value, int shift)
+		{
+			return (value << shift) | (value >> (64 - shift));
+		}
+
+		inline void Round(uint64_t& high, uint64_t& low, uint64_t word)
+		{
+			// two differently mixed lanes, together the 128 bits make accidental collisions a non-issue
+			high = Rotate(high + word * Prime2, 31) * Prime1;
+			low = Rotate(low ^ (word * Prime3), 27) * Prime2 + Prime1;
+		}
+
+		inline uint64_t Avalanche(uint64_t hash)
+		{
+			hash ^= hash >> 33;
+			hash *= Prime2;
+			hash ^= hash >> 29;
+			hash *= Prime3;
+			hash ^= hash >> 32;
+			return hash;
+		}
+
+		const char Digits[] = "0123456789abcdef";
+
+		void AppendHex(std::string& string, uint64_t value)
+		{
+			for (int shift = 60; shift >= 0; shift -= 4)
+				string += Digits[(value >> shift) & 0xF];
+		}
+
+		uint64_t Checksum(const char* data, std::size_t payloadSize, std::size_t dependenciesSize)
+		{
+			return DerivedDataCache::KeyBuilder("checksum", DerivedDataCache::Version)
+				.AddBytes(data, payloadSize)
+				.AddBytes(data + payloadSize, dependenciesSize)
+				.GetKey().low;
+		}
+	}
+
+	/// \brief ends every entry, the payload and the dependency records precede it
+	struct DerivedDataCache::Trailer
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t keyHigh;
+		uint64_t keyLow;
+		uint64_t payloadSize;
+		/// \brief records of { uint64_t hash; uint32_t length; char path[length]; }
+		uint64_t dependenciesSize;
+		/// \brief over the payload and dependency records
+		uint64_t checksum;
+	};
+
+#pragma region Key
+	std::string DerivedDataCache::Key::ToString() const
+	{
+		std::string string;
+		string.reserve(32);
+		AppendHex(string, high);
+		AppendHex(string, low);
+		return string;
+	}
+
+	DerivedDataCache::KeyBuilder::KeyBuilder(std::string_view converter, uint32_t version)
+		: high(Prime1 + Prime2)
+		, low(Prime3)
+	{
+		AddString(converter);
+		AddValue(version);
+		AddValue(DerivedDataCache::Version);
+	}
+
+	DerivedDataCache::KeyBuilder& DerivedDataCache::KeyBuilder::AddBytes(const void* data, std::size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+		std::size_t wordEnd = size & ~std::size_t(7);
+		for (std::size_t i = 0; i < wordEnd; i += 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, bytes + i, sizeof(word));
+			Round(high, low, word);
+		}
+
+		// the tail and the size always go in, so consecutive calls can't be shifted into each other
+		uint64_t tail = 0;
+		std::memcpy(&tail, bytes + wordEnd, size - wordEnd);
+		Round(high, low, tail);
+		Round(high, low, uint64_t(size));
+
+		return *this;
+	}
+
+	DerivedDataCache::KeyBuilder& DerivedDataCache::KeyBuilder::AddValue(uint64_t value)
+	{
+		return AddBytes(&value, sizeof(value));
+	}
+
+	DerivedDataCache::Key DerivedDataCache::KeyBuilder::GetKey() const
+	{
+		return Key{ Avalanche(high + Rotate(low, 17)), Avalanche(low ^ Rotate(high, 41)) };
+	}
+#pragma endregion
+
+	DerivedDataCache::DerivedDataCache()
+		: maxSize(DefaultMaxSize)
+		, writable(false)
+		, totalSize(0)
+		, instanceID(0)
+		, temporaryCounter(0)
+	{ }
+
+	bool DerivedDataCache::Open(const std::string& directory, uint64_t maxSize)
+	{
+		Close();
+
+		if (directory.empty())
+			return false;
+
+		std::error_code errorCode;
+		std::filesystem::create_directories(directory, errorCode);
+		if (!std::filesystem::is_directory(directory, errorCode))
+		{
+			Debug::LogWarning("DerivedDataCache: can't use ", directory, ", derived data won't be cached");
+			return false;
+		}
+
+		this->directory = directory;
+		if (this->directory.back() != '/' && this->directory.back() != '\\')
+			this->directory += '/';
+
+		this->maxSize = maxSize;
+
+		// process ids aren't portable, random bits and the time tell writers apart just as well
+		std::random_device random;
+		instanceID = (uint64_t(random()) << 32) ^ uint64_t(random()) ^ uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+		temporaryCounter = 0;
+
+		// a read-only directory still serves entries, Put() notices it can't write
+		writable = true;
+
+		Trim();
+		return true;
+	}
+
+	void DerivedDataCache::Close()
+	{
+		std::lock_guard<std::mutex> guard(trimLock);
+
+		directory.clear();
+		writable = false;
+		totalSize = 0;
+	}
+
+	std::string DerivedDataCache::GetEntryPath(const Key& key) const
+	{
+		// 256 sub directories keep the directories small
+		std::string name = key.ToString();
+		return directory + name.substr(0, 2) + '/' + name + EntryExtension;
+	}
+
+	bool DerivedDataCache::Get(const Key& key, std::string& data) const
+	{
+		if (!IsOpen())
+			return false;
+
+		std::string path = GetEntryPath(key);
+		if (!ReadEntry(path, key, data))
+			return false;
+
+		// touched for the least recently used eviction, fails harmlessly on a read-only directory
+		std::error_code errorCode;
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), errorCode);
+
+		return true;
+	}
+
+	bool DerivedDataCache::ReadEntry(const std::string& path, const Key& key, std::string& data) const
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+
+		std::streamoff size = file.tellg();
+		std::string contents;
+		if (size >= std::streamoff(sizeof(Trailer)))
+		{
+			contents.resize(std::size_t(size));
+			file.seekg(0);
+			file.read(&contents[0], size);
+		}
+
+		bool valid = file.good() && !contents.empty();
+		file.close();
+
+		Trailer trailer;
+		if (valid)
+		{
+			std::memcpy(&trailer, contents.data() + contents.size() - sizeof(Trailer), sizeof(Trailer));
+
+			valid = std::memcmp(trailer.magic, Magic, sizeof(Magic)) == 0
+				&& trailer.version == Version
+				&& trailer.keyHigh == key.high && trailer.keyLow == key.low
+				&& trailer.payloadSize <= contents.size() && trailer.dependenciesSize <= contents.size()
+				&& trailer.payloadSize + trailer.dependenciesSize + sizeof(Trailer) == contents.size()
+				&& trailer.checksum == Checksum(contents.data(), std::size_t(trailer.payloadSize), std::size_t(trailer.dependenciesSize));
+		}
+
+		if (!valid)
+		{
+			// another process may have replaced it in the meantime, that's fine too: the next Put() overwrites it
+			Debug::LogWarning("DerivedDataCache: removing damaged entry ", path);
+
+			std::error_code errorCode;
+			std::filesystem::remove(path, errorCode);
+			return false;
+		}
+
+		// stale entries are simply replaced by the Put() after the rebuild
+		if (!ValidateDependencies(std::string_view(contents).substr(std::size_t(trailer.payloadSize), std::size_t(trailer.dependenciesSize))))
+			return false;
+
+		contents.resize(std::size_t(trailer.payloadSize));
+		data = std::move(contents);
+		return true;
+	}
+
+	bool DerivedDataCache::ValidateDependencies(std::string_view dependencies) const
+	{
+		std::size_t offset = 0;
+		while (offset < dependencies.size())
+		{
+			uint64_t hash;
+			uint32_t length;
+			if (offset + sizeof(hash) + sizeof(length) > dependencies.size())
+				return false;
+
+			std::memcpy(&hash, dependencies.data() + offset, sizeof(hash));
+			std::memcpy(&length, dependencies.data() + offset + sizeof(hash), sizeof(length));
+			offset += sizeof(hash) + sizeof(length);
+
+			if (offset + length > dependencies.size())
+				return false;
+
+			if (HashDependency(std::string(dependencies.substr(offset, length))) != hash)
+				return false;
+
+			offset += length;
+		}
+
+		return true;
+	}
+
+	bool DerivedDataCache::Put(const Key& key, std::string_view data, const std::vector<std::string>& dependencies)
+	{
+		if (!IsOpen() || !writable)
+			return false;
+
+		std::string dependencyRecords;
+		for (auto& dependency : dependencies)
+		{
+			uint64_t hash = HashDependency(dependency);
+			uint32_t length = uint32_t(dependency.size());
+
+			dependencyRecords.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+			dependencyRecords.append(reinterpret_cast<const char*>(&length), sizeof(length));
+			dependencyRecords += dependency;
+		}
+
+		std::string contents;
+		contents.reserve(data.size() + dependencyRecords.size() + sizeof(Trailer));
+		contents.append(data);
+		contents += dependencyRecords;
+
+		Trailer trailer;
+		std::memcpy(trailer.magic, Magic, sizeof(Magic));
+		trailer.version = Version;
+		trailer.keyHigh = key.high;
+		trailer.keyLow = key.low;
+		trailer.payloadSize = data.size();
+		trailer.dependenciesSize = dependencyRecords.size();
+		trailer.checksum = Checksum(contents.data(), data.size(), dependencyRecords.size());
+		contents.append(reinterpret_cast<const char*>(&trailer), sizeof(Trailer));
+
+		std::string path = GetEntryPath(key);
+		std::error_code errorCode;
+		std::filesystem::create_directories(std::filesystem::path(path).parent_path(), errorCode);
+
+		// unique per process and write, concurrent writers of the same key each rename a complete file into place
+		std::string temporaryPath = path + '.';
+		AppendHex(temporaryPath, instanceID);
+		AppendHex(temporaryPath, temporaryCounter++);
+		temporaryPath += TemporaryExtension;
+
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			if (writable.exchange(false))
+				Debug::LogWarning("DerivedDataCache: can't write to ", directory, ", derived data won't be stored");
+
+			return false;
+		}
+
+		file.write(contents.data(), contents.size());
+		file.close();
+
+		if (file.fail())
+		{
+			std::filesystem::remove(temporaryPath, errorCode);
+			return false;
+		}
+
+		std::filesystem::rename(temporaryPath, path, errorCode);
+		if (errorCode)
+		{
+			// e.g.: another process has the entry open on Windows, what's there is just as good
+			std::filesystem::remove(temporaryPath, errorCode);
+			return false;
+		}
+
+		if ((totalSize += contents.size()) > maxSize)
+			Trim();
+
+		return true;
+	}
+
+	void DerivedDataCache::Trim()
+	{
+		std::unique_lock<std::mutex> lock(trimLock, std::try_to_lock);
+		if (!lock.owns_lock() || directory.empty())
+			return;
+
+		struct Entry
+		{
+			std::filesystem::path path;
+			uint64_t size;
+			std::filesystem::file_time_type time;
+		};
+
+		std::vector<Entry> entries;
+		std::vector<std::filesystem::path> staleFiles;
+		uint64_t size = 0;
+
+		auto now = std::filesystem::file_time_type::clock::now();
+
+		std::error_code errorCode;
+		for (std::filesystem::recursive_directory_iterator it(directory, errorCode), end; !errorCode && it != end; it.increment(errorCode))
+		{
+			std::error_code entryError;
+			if (!it->is_regular_file(entryError))
+				continue;
+
+			std::filesystem::path extension = it->path().extension();
+			std::filesystem::file_time_type time = it->last_write_time(entryError);
+			uint64_t fileSize = it->file_size(entryError);
+			if (entryError)
+				continue;
+
+			if (extension == TemporaryExtension)
+			{
+				if (now - time > StaleTemporaryAge)
+					staleFiles.push_back(it->path());
+			}
+			else if (extension == EntryExtension)
+			{
+				entries.push_back(Entry{ it->path(), fileSize, time });
+				size += fileSize;
+			}
+		}
+
+		for (auto& path : staleFiles)
+			std::filesystem::remove(path, errorCode);
+
+		if (size > maxSize)
+		{
+			// down to three quarters, so the next trim is a while away
+			uint64_t targetSize = maxSize - maxSize / 4;
+			std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+
+			for (auto it = entries.begin(); it != entries.end() && size > targetSize; ++it)
+			{
+				if (std::filesystem::remove(it->path, errorCode))
+					size -= it->size;
+			}
+		}
+
+		totalSize = size;
+	}
+
+	uint64_t DerivedDataCache::HashDependency(const std::string& path)
+	{
+		// 0 stands for a missing file, so a file that shows up later invalidates the entry as well
+		if (!Data::AssetExists(path))
+			return 0;
+
+		std::string contents = Data::ReadAsset(path);
+		uint64_t hash = KeyBuilder("dependency", Version).AddString(contents).GetKey().low;
+		return hash != 0 ? hash : 1;
+	}
+
+	std::string DerivedDataCache::GetDefaultDirectory()
+	{
+		if (const char* path = std::getenv("ESTEEM_DDC_PATH"))
+			return path;
+
+#ifdef _WIN32
+		if (const char* localAppData = std::getenv("LOCALAPPDATA"))
+			return std::string(localAppData) + "/Esteem/DerivedDataCache/";
+#elif defined(__APPLE__)
+		if (const char* home = std::getenv("HOME"))
+			return std::string(home) + "/Library/Caches/Esteem/DerivedDataCache/";
+#else
+		const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+		if (cacheHome && cacheHome[0] == '/')
+			return std::string(cacheHome) + "/esteem/derived-data/";
+
+		if (const char* home = std::getenv("HOME"))
+			return std::string(home) + "/.cache/esteem/derived-data/";
+#endif
+
+		return std::string();
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Esteem
+{
+	/// \brief on disk cache for the results of expensive runtime conversions, e.g.: imported models or BVHs
+	/// Entries are content addressed, the key hashes everything that went into the result: the input bytes, the id and
+	/// version of the converter and its options. Files that were read on the side (includes, .mtl files, ...) are
+	/// stored as dependencies with the hash of their contents and checked again on every hit.
+	///
+	/// Several processes may share the directory. Entries are written to a temporary file and renamed into place, so
+	/// readers only ever see complete files, and every entry ends with a checksum so damaged files are dropped. When
+	/// the directory grows past its size limit the least recently used entries are removed. A cache that is closed or
+	/// can't be written to still works, GetOrBuild() then always builds.
+	class DerivedDataCache
+	{
+	public:
+		struct Key
+		{
+			uint64_t high;
+			uint64_t low;
+
+			inline bool operator==(const Key& other) const { return high == other.high && low == other.low; }
+			inline bool operator!=(const Key& other) const { return !(*this == other); }
+
+			/// \brief 32 hexadecimal digits
+			std::string ToString() const;
+		};
+
+		/// \brief hashes the inputs of a conversion, every Add* call is separated from the next
+		class KeyBuilder
+		{
+		private:
+			uint64_t high;
+			uint64_t low;
+
+		public:
+			/// \param converter	unique name of the conversion, e.g.: "model"
+			/// \param version		bump when the conversion's output changes
+			KeyBuilder(std::string_view converter, uint32_t version);
+
+			KeyBuilder& AddBytes(const void* data, std::size_t size);
+			inline KeyBuilder& AddString(std::string_view string) { return AddBytes(string.data(), string.size()); }
+			KeyBuilder& AddValue(uint64_t value);
+
+			Key GetKey() const;
+		};
+
+		/// \brief bump when the entry layout changes, older entries are then ignored and evicted over time
+		static constexpr uint32_t Version = 1;
+
+		/// \brief default size limit of the whole directory
+		static constexpr uint64_t DefaultMaxSize = 2048ull * 1024 * 1024;
+
+	private:
+		struct Trailer;
+
+		std::string directory;
+		uint64_t maxSize;
+
+		/// \brief false until opened, and once the directory turned out to be read-only
+		std::atomic<bool> writable;
+		/// \brief estimate of the directory size, corrected on every trim
+		std::atomic<uint64_t> totalSize;
+		/// \brief makes temporary names unique between processes and threads
+		uint64_t instanceID;
+		std::atomic<uint64_t> temporaryCounter;
+
+		/// \brief one trim at a time, other writers skip it
+		std::mutex trimLock;
+
+		std::string GetEntryPath(const Key& key) const;
+
+		bool ReadEntry(const std::string& path, const Key& key, std::string& data) const;
+		bool ValidateDependencies(std::string_view dependencies) const;
+
+		/// \brief scan the directory, removes stale temporary files and, when over the limit, the least recently used entries
+		void Trim();
+
+		static uint64_t HashDependency(const std::string& path);
+
+	public:
+		DerivedDataCache();
+
+		// disable copy
+		DerivedDataCache(const DerivedDataCache&) = delete;
+		void operator=(const DerivedDataCache&) = delete;
+
+		/// \brief use the directory, it's created when missing
+		/// \return false when the directory can't be used at all, the cache then stays closed
+		bool Open(const std::string& directory, uint64_t maxSize = DefaultMaxSize);
+		void Close();
+
+		inline bool IsOpen() const { return !directory.empty(); }
+		inline bool IsWritable() const { return writable; }
+		inline const std::string& GetDirectory() const { return directory; }
+
+		/// \brief the entry's contents, entries with changed dependencies count as a miss and damaged ones are removed
+		bool Get(const Key& key, std::string& data) const;
+
+		/// \brief store the entry, dependencies are read through Data and hashed now
+		/// Fails quietly when the cache is closed or read-only, the first failure is logged.
+		bool Put(const Key& key, std::string_view data, const std::vector<std::string>& dependencies = std::vector<std::string>());
+
+		/// \brief the cached entry, or run the builder and store what it made
+		/// \param builder	bool(std::string& data, std::vector<std::string>& dependencies), returns false when it failed
+		/// \return false only when there was no entry and the builder failed
+		template<typename F>
+		bool GetOrBuild(const Key& key, std::string& data, F&& builder);
+
+		/// \brief the platform's per user cache directory, ESTEEM_DDC_PATH overrides it and disables the cache when empty
+		static std::string GetDefaultDirectory();
+	};
+}
+
+#include "./DerivedDataCache.inl"
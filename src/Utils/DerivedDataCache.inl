@@ -0,0 +1,21 @@
+#include "./DerivedDataCache.h"
+
+namespace Esteem
+{
+	template<typename F>
+	bool DerivedDataCache::GetOrBuild(const Key& key, std::string& data, F&& builder)
+	{
+		if (Get(key, data))
+			return true;
+
+		data.clear();
+
+		std::vector<std::string> dependencies;
+		if (!builder(data, dependencies))
+			return false;
+
+		// a failed write only costs the next run another build
+		Put(key, data, dependencies);
+		return true;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Memory/array_view.h"
+
+namespace Esteem
+{
+	/// \brief read-only memory mapping of a whole file
+	class MappedFile
+	{
+	private:
+		const uint8_t* data;
+		std::size_t size;
+
+#ifdef _WIN32
+		void* fileHandle;
+		void* mappingHandle;
+#endif
+
+	public:
+		MappedFile();
+		~MappedFile();
+
+		// disable copy
+		MappedFile(const MappedFile&) = delete;
+		void operator=(const MappedFile&) = delete;
+
+		/// \brief map the file, closes any previously mapped file, fails on empty files
+		bool Open(const std::string& path);
+		void Close();
+
+		inline bool IsOpen() const { return data != nullptr; }
+		inline const uint8_t* GetData() const { return data; }
+		inline std::size_t GetSize() const { return size; }
+
+		inline mm::array_view GetView() const { return mm::array_view(data, size, sizeof(uint8_t)); }
+	};
+}
@@ -0,0 +1,409 @@
+#include "PakArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <zlib/zlib.h>
+
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr uint32_t EndOfCentralDirectorySignature = 0x06054b50;
+		constexpr uint32_t CentralDirectorySignature = 0x02014b50;
+		constexpr uint32_t LocalHeaderSignature = 0x04034b50;
+
+		constexpr std::size_t EndOfCentralDirectorySize = 22;
+		constexpr std::size_t CentralDirectoryHeaderSize = 46;
+		constexpr std::size_t LocalHeaderSize = 30;
+
+		/// \brief zip is little endian, read byte by byte so unaligned access and host endianness don't matter
+		inline uint16_t ReadUInt16(const uint8_t* p)
+		{
+			return uint16_t(p[0] | (p[1] << 8));
+		}
+
+		inline uint32_t ReadUInt32(const uint8_t* p)
+		{
+			return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+		}
+
+		inline char NormalizeCharacter(char c)
+		{
+			return c == '\\' ? '/' : (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+		}
+
+		inline std::string_view StripLeading(std::string_view path)
+		{
+			while (!path.empty())
+			{
+				if (path[0] == '/' || path[0] == '\\')
+					path.remove_prefix(1);
+				else if (path.size() > 1 && path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+					path.remove_prefix(2);
+				else
+					break;
+			}
+
+			return path;
+		}
+	}
+
+	PakSeekIndex::PakSeekIndex(std::size_t span)
+		: span(span)
+	{ }
+
+	const PakSeekIndex::AccessPoint* PakSeekIndex::Find(uint64_t output) const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		auto found = points.upper_bound(output);
+		return found == points.begin() ? nullptr : &std::prev(found)->second;
+	}
+
+	bool PakSeekIndex::Contains(uint64_t output) const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return points.find(output) != points.end();
+	}
+
+	void PakSeekIndex::Add(uint64_t output, uint64_t input, int bits, const uint8_t* window, std::size_t windowSize)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		// block boundaries don't depend on the stream, so another stream may have added this point already
+		if (points.find(output) == points.end())
+			points.emplace(output, AccessPoint{ output, input, bits, std::vector<uint8_t>(window, window + windowSize) });
+	}
+
+	std::size_t PakSeekIndex::GetPointCount() const
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return points.size();
+	}
+
+	PakArchive::PakArchive()
+		: data(nullptr)
+		, size(0)
+		, slotMask(0)
+	{ }
+
+	PakArchive::~PakArchive()
+	{
+		Close();
+	}
+
+	bool PakArchive::Open(const std::string& path)
+	{
+		Close();
+
+		if (!file.Open(path))
+			return false;
+
+		data = file.GetData();
+		size = file.GetSize();
+
+		if (!ReadCentralDirectory())
+		{
+			Debug::LogError("PakArchive: \"" + path + "\" is not a valid zip archive");
+			Close();
+			return false;
+		}
+
+		this->path = path;
+		BuildIndex();
+
+		return true;
+	}
+
+	void PakArchive::Close()
+	{
+		file.Close();
+		data = nullptr;
+		size = 0;
+
+		path.clear();
+		entries.clear();
+		names.clear();
+		slots.clear();
+		slotMask = 0;
+
+		std::lock_guard<std::mutex> guard(seekIndicesLock);
+		seekIndices.clear();
+	}
+
+	bool PakArchive::ReadCentralDirectory()
+	{
+		if (size < EndOfCentralDirectorySize)
+			return false;
+
+		// the end of central directory record is followed by a comment of at most 64KB, search backwards
+		const uint8_t* eocd = nullptr;
+		std::size_t searchEnd = size > EndOfCentralDirectorySize + 0xFFFF ? size - EndOfCentralDirectorySize - 0xFFFF : 0;
+		for (std::size_t i = size - EndOfCentralDirectorySize + 1; i-- > searchEnd; )
+		{
+			if (ReadUInt32(data + i) == EndOfCentralDirectorySignature)
+			{
+				eocd = data + i;
+				break;
+			}
+		}
+
+		if (eocd == nullptr)
+			return false;
+
+		uint32_t entryCount = ReadUInt16(eocd + 10);
+		uint32_t directorySize = ReadUInt32(eocd + 12);
+		uint32_t directoryOffset = ReadUInt32(eocd + 16);
+
+		if (entryCount == 0xFFFF || directoryOffset == 0xFFFFFFFF)
+		{
+			Debug::LogError("PakArchive: zip64 archives are not supported");
+			return false;
+		}
+
+		if (std::size_t(directoryOffset) + directorySize > size)
+			return false;
+
+		entries.reserve(entryCount);
+
+		const uint8_t* current = data + directoryOffset;
+		const uint8_t* end = current + directorySize;
+		for (uint32_t i = 0; i < entryCount; ++i)
+		{
+			if (current + CentralDirectoryHeaderSize > end || ReadUInt32(current) != CentralDirectorySignature)
+				return false;
+
+			uint16_t flags = ReadUInt16(current + 8);
+			uint16_t nameLength = ReadUInt16(current + 28);
+			uint16_t extraLength = ReadUInt16(current + 30);
+			uint16_t commentLength = ReadUInt16(current + 32);
+
+			const char* name = reinterpret_cast<const char*>(current + CentralDirectoryHeaderSize);
+			if (current + CentralDirectoryHeaderSize + nameLength > end)
+				return false;
+
+			Entry entry;
+			entry.method = ReadUInt16(current + 10);
+			entry.crc = ReadUInt32(current + 16);
+			entry.compressedSize = ReadUInt32(current + 20);
+			entry.uncompressedSize = ReadUInt32(current + 24);
+			entry.localHeaderOffset = ReadUInt32(current + 42);
+
+			current += CentralDirectoryHeaderSize + nameLength + extraLength + commentLength;
+
+			std::string_view entryName = StripLeading(std::string_view(name, nameLength));
+
+			// skip directories, encrypted entries and anything we can't decode
+			if (entryName.empty() || entryName.back() == '/' || (flags & 0x1)
+				|| (entry.method != MethodStored && entry.method != MethodDeflated))
+				continue;
+
+			if (entry.compressedSize == 0xFFFFFFFF || entry.uncompressedSize == 0xFFFFFFFF || entry.localHeaderOffset == 0xFFFFFFFF)
+			{
+				Debug::LogWarning("PakArchive: skipping zip64 entry \"" + std::string(entryName) + "\"");
+				continue;
+			}
+
+			entry.nameOffset = uint32_t(names.size());
+			entry.nameLength = uint32_t(entryName.size());
+			for (char c : entryName)
+				names += NormalizeCharacter(c);
+
+			entry.hash = HashPath(GetName(entry));
+			entries.push_back(entry);
+		}
+
+		return true;
+	}
+
+	void PakArchive::BuildIndex()
+	{
+		// keep the load factor at or below 50%, so misses stay short as well
+		std::size_t capacity = 16;
+		while (capacity < entries.size() * 2)
+			capacity <<= 1;
+
+		slots.assign(capacity, EmptySlot);
+		slotMask = uint32_t(capacity - 1);
+
+		for (uint32_t i = 0; i < entries.size(); ++i)
+		{
+			const Entry& entry = entries[i];
+			for (uint32_t slot = uint32_t(entry.hash) & slotMask; ; slot = (slot + 1) & slotMask)
+			{
+				uint32_t& index = slots[slot];
+				if (index == EmptySlot)
+				{
+					index = i;
+					break;
+				}
+
+				// duplicate names, the last one in the central directory wins like it would when extracting
+				const Entry& other = entries[index];
+				if (other.hash == entry.hash && GetName(other) == GetName(entry))
+				{
+					index = i;
+					break;
+				}
+			}
+		}
+	}
+
+	const PakArchive::Entry* PakArchive::Find(std::string_view path) const
+	{
+		if (entries.empty())
+			return nullptr;
+
+		path = StripLeading(path);
+
+		// normalize on the stack for all but unusually long paths
+		char stackBuffer[256];
+		std::string heapBuffer;
+		char* normalized = stackBuffer;
+		if (path.size() > sizeof(stackBuffer))
+		{
+			heapBuffer.resize(path.size());
+			normalized = heapBuffer.data();
+		}
+
+		for (std::size_t i = 0; i < path.size(); ++i)
+			normalized[i] = NormalizeCharacter(path[i]);
+
+		std::string_view name(normalized, path.size());
+		uint64_t hash = HashPath(name);
+
+		for (uint32_t slot = uint32_t(hash) & slotMask; ; slot = (slot + 1) & slotMask)
+		{
+			uint32_t index = slots[slot];
+			if (index == EmptySlot)
+				return nullptr;
+
+			const Entry& entry = entries[index];
+			if (entry.hash == hash && GetName(entry) == name)
+				return &entry;
+		}
+	}
+
+	const uint8_t* PakArchive::GetEntryData(const Entry& entry) const
+	{
+		std::size_t offset = entry.localHeaderOffset;
+		if (offset + LocalHeaderSize > size || ReadUInt32(data + offset) != LocalHeaderSignature)
+			return nullptr;
+
+		// the local header may have a different extra field length than the central directory
+		offset += LocalHeaderSize + ReadUInt16(data + offset + 26) + ReadUInt16(data + offset + 28);
+		if (offset + entry.compressedSize > size)
+			return nullptr;
+
+		return data + offset;
+	}
+
+	mm::array_view PakArchive::View(const Entry& entry) const
+	{
+		if (entry.IsStored())
+		{
+			const uint8_t* entryData = GetEntryData(entry);
+			if (entryData != nullptr)
+				return mm::array_view(entryData, entry.uncompressedSize, sizeof(uint8_t));
+		}
+
+		return mm::array_view();
+	}
+
+	mm::array_view PakArchive::GetCompressedData(const Entry& entry) const
+	{
+		const uint8_t* entryData = GetEntryData(entry);
+		if (entryData == nullptr)
+			return mm::array_view();
+
+		return mm::array_view(entryData, entry.compressedSize, sizeof(uint8_t));
+	}
+
+	std::shared_ptr<PakSeekIndex> PakArchive::GetSeekIndex(const Entry& entry) const
+	{
+		std::lock_guard<std::mutex> guard(seekIndicesLock);
+
+		std::shared_ptr<PakSeekIndex>& index = seekIndices[uint32_t(&entry - entries.data())];
+		if (!index)
+			index = std::make_shared<PakSeekIndex>();
+
+		return index;
+	}
+
+	bool PakArchive::Read(const Entry& entry, void* buffer) const
+	{
+		const uint8_t* entryData = GetEntryData(entry);
+		if (entryData == nullptr)
+			return false;
+
+		if (entry.IsStored())
+			std::memcpy(buffer, entryData, entry.uncompressedSize);
+		else
+		{
+			// raw deflate stream straight out of the mapping, no intermediate buffer
+			z_stream stream = {};
+			if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+				return false;
+
+			stream.next_in = const_cast<Bytef*>(entryData);
+			stream.avail_in = entry.compressedSize;
+			stream.next_out = static_cast<Bytef*>(buffer);
+			stream.avail_out = entry.uncompressedSize;
+
+			int result = inflate(&stream, Z_FINISH);
+			inflateEnd(&stream);
+
+			if (result != Z_STREAM_END || stream.total_out != entry.uncompressedSize)
+			{
+				Debug::LogError("PakArchive: could not inflate \"" + std::string(GetName(entry)) + "\" from \"" + path + "\"");
+				return false;
+			}
+		}
+
+		// a deflate stream can end cleanly with the wrong bytes, and stored entries aren't checked at all otherwise
+		if (uint32_t(crc32(crc32(0, nullptr, 0), static_cast<const Bytef*>(buffer), uInt(entry.uncompressedSize))) != entry.crc)
+		{
+			Debug::LogError("PakArchive: checksum mismatch of \"" + std::string(GetName(entry)) + "\" in \"" + path + "\"");
+			return false;
+		}
+
+		return true;
+	}
+
+	std::string PakArchive::Read(const Entry& entry) const
+	{
+		std::string contents;
+		contents.resize(entry.uncompressedSize);
+
+		if (!Read(entry, contents.data()))
+			contents.clear();
+
+		return contents;
+	}
+
+	std::string PakArchive::NormalizePath(std::string_view path)
+	{
+		path = StripLeading(path);
+
+		std::string normalized;
+		normalized.resize(path.size());
+		std::transform(path.begin(), path.end(), normalized.begin(), NormalizeCharacter);
+
+		return normalized;
+	}
+
+	uint64_t PakArchive::HashPath(std::string_view normalizedPath)
+	{
+		// FNV-1a
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (char c : normalizedPath)
+		{
+			hash ^= uint8_t(c);
+			hash *= 0x100000001b3ull;
+		}
+
+		return hash;
+	}
+}
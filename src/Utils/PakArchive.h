@@ -0,0 +1,157 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Memory/array_view.h"
+#include "Utils/MappedFile.h"
+
+namespace Esteem
+{
+	/// \brief zran style access points into a deflated entry, so a stream can resume inflating close to any offset
+	/// Points are recorded on deflate block boundaries about every span bytes of output, by whichever stream
+	/// inflates past them first. Thread safe, points are never removed so returned pointers stay valid.
+	class PakSeekIndex
+	{
+	public:
+		static constexpr std::size_t DefaultSpan = 256 * 1024;
+		static constexpr std::size_t WindowSize = 32 * 1024;
+
+		struct AccessPoint
+		{
+			/// \brief offset in the uncompressed data
+			uint64_t output;
+			/// \brief offset of the first full byte in the compressed data
+			uint64_t input;
+			/// \brief bits of the byte before input that still belong to the next block, 0-7
+			int bits;
+			/// \brief the (up to) 32KB of output preceding this point, the deflate dictionary
+			std::vector<uint8_t> window;
+		};
+
+	private:
+		mutable std::mutex lock;
+		std::map<uint64_t, AccessPoint> points;
+		std::size_t span;
+
+	public:
+		PakSeekIndex(std::size_t span = DefaultSpan);
+
+		// disable copy
+		PakSeekIndex(const PakSeekIndex&) = delete;
+		void operator=(const PakSeekIndex&) = delete;
+
+		/// \return the last point at or before the given output offset, nullptr if there is none
+		const AccessPoint* Find(uint64_t output) const;
+		bool Contains(uint64_t output) const;
+		void Add(uint64_t output, uint64_t input, int bits, const uint8_t* window, std::size_t windowSize);
+
+		inline std::size_t GetSpan() const { return span; }
+		std::size_t GetPointCount() const;
+	};
+
+	/// \brief read-only zip (pak) archive that is opened and memory mapped once
+	/// The central directory is parsed on Open() into an open-addressing hash index, lookups are a hash plus
+	/// (usually) a single string compare. Paths are normalized before hashing: leading "./" and "/" are stripped,
+	/// '\' becomes '/' and ASCII is lowercased, matching the case insensitive unzLocateFile() lookups it replaces.
+	/// All const methods are thread safe.
+	class PakArchive
+	{
+	public:
+		static constexpr uint16_t MethodStored = 0;
+		static constexpr uint16_t MethodDeflated = 8;
+
+		struct Entry
+		{
+			uint64_t hash;
+			uint32_t nameOffset;
+			uint32_t nameLength;
+			uint32_t localHeaderOffset;
+			uint32_t compressedSize;
+			uint32_t uncompressedSize;
+			uint32_t crc;
+			uint16_t method;
+
+			inline bool IsStored() const { return method == MethodStored; }
+		};
+
+	private:
+		static constexpr uint32_t EmptySlot = ~uint32_t(0);
+
+		std::string path;
+		MappedFile file;
+		/// \brief shortcuts into file
+		const uint8_t* data;
+		std::size_t size;
+
+		std::vector<Entry> entries;
+		/// \brief normalized names of all entries back to back, referenced by Entry::nameOffset
+		std::string names;
+		/// \brief entry index per slot or EmptySlot, size is a power of two
+		std::vector<uint32_t> slots;
+		uint32_t slotMask;
+
+		/// \brief created on first use, by entry index
+		mutable std::mutex seekIndicesLock;
+		mutable std::unordered_map<uint32_t, std::shared_ptr<PakSeekIndex>> seekIndices;
+
+		bool ReadCentralDirectory();
+		void BuildIndex();
+
+		/// \brief pointer to the (compressed) bytes of the entry, skips the local file header
+		const uint8_t* GetEntryData(const Entry& entry) const;
+
+		inline std::string_view GetName(const Entry& entry) const
+		{
+			return std::string_view(names.data() + entry.nameOffset, entry.nameLength);
+		}
+
+	public:
+		PakArchive();
+		~PakArchive();
+
+		// disable copy
+		PakArchive(const PakArchive&) = delete;
+		void operator=(const PakArchive&) = delete;
+
+		/// \brief map the archive and build the index, closes any previously opened archive
+		bool Open(const std::string& path);
+		void Close();
+
+		inline bool IsOpen() const { return data != nullptr; }
+		inline const std::string& GetPath() const { return path; }
+		inline std::size_t GetEntryCount() const { return entries.size(); }
+
+		/// \return the entry or nullptr when the archive does not contain the path
+		const Entry* Find(std::string_view path) const;
+		inline bool Contains(std::string_view path) const { return Find(path) != nullptr; }
+
+		/// \brief zero-copy view into the mapping, only for stored (uncompressed) entries
+		/// \return an empty view for compressed entries, use Read() instead
+		mm::array_view View(const Entry& entry) const;
+
+		/// \brief raw (possibly deflated) bytes of the entry inside the mapping, empty if the entry is corrupt
+		mm::array_view GetCompressedData(const Entry& entry) const;
+
+		/// \brief access points of a deflated entry, shared by every stream of that entry while the archive is open
+		std::shared_ptr<PakSeekIndex> GetSeekIndex(const Entry& entry) const;
+
+		/// \brief copy or inflate the entry into the given buffer, which must be entry.uncompressedSize bytes long
+		/// \return false when the entry can't be inflated or its bytes don't match entry.crc
+		bool Read(const Entry& entry, void* buffer) const;
+		std::string Read(const Entry& entry) const;
+
+		/// \brief lowercase, strip leading "./" and "/" and convert '\' into '/'
+		static std::string NormalizePath(std::string_view path);
+		static uint64_t HashPath(std::string_view normalizedPath);
+	};
+}
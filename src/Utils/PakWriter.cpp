@@ -0,0 +1,212 @@
+#include "PakWriter.h"
+
+#include <zlib/zlib.h>
+
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		constexpr uint32_t EndOfCentralDirectorySignature = 0x06054b50;
+		constexpr uint32_t CentralDirectorySignature = 0x02014b50;
+		constexpr uint32_t LocalHeaderSignature = 0x04034b50;
+
+		constexpr std::size_t LocalHeaderSize = 30;
+		constexpr uint16_t MethodStored = 0;
+		constexpr uint16_t MethodDeflated = 8;
+
+		/// \brief zipalign's extra field id, tools treat it as padding
+		constexpr uint16_t AlignmentExtraId = 0xD935;
+		constexpr std::size_t ExtraHeaderSize = 4;
+
+		inline void WriteUInt16(std::string& out, uint16_t value)
+		{
+			out += char(value & 0xFF);
+			out += char(value >> 8);
+		}
+
+		inline void WriteUInt32(std::string& out, uint32_t value)
+		{
+			WriteUInt16(out, uint16_t(value & 0xFFFF));
+			WriteUInt16(out, uint16_t(value >> 16));
+		}
+	}
+
+	PakWriter::PakWriter()
+		: offset(0)
+	{ }
+
+	PakWriter::~PakWriter()
+	{
+		if (IsOpen())
+			Close();
+	}
+
+	bool PakWriter::Open(const std::string& path)
+	{
+		if (IsOpen())
+			Close();
+
+		stream.open(path, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			Debug::LogError("PakWriter: could not create \"" + path + "\"");
+			return false;
+		}
+
+		this->path = path;
+		offset = 0;
+		entries.clear();
+
+		return true;
+	}
+
+	bool PakWriter::Write(const void* data, std::size_t size)
+	{
+		stream.write(static_cast<const char*>(data), std::streamsize(size));
+		offset += size;
+
+		return bool(stream);
+	}
+
+	bool PakWriter::Add(std::string_view name, const void* data, std::size_t size, bool compress, uint32_t alignment)
+	{
+		if (!IsOpen())
+			return false;
+
+		if (size >= 0xFFFFFFFF || offset >= 0xFFFFFFFF || entries.size() >= 0xFFFF)
+		{
+			Debug::LogError("PakWriter: \"" + path + "\" would need zip64, which PakArchive doesn't support");
+			return false;
+		}
+
+		CentralEntry entry;
+		entry.name = name;
+		entry.localHeaderOffset = uint32_t(offset);
+		entry.uncompressedSize = uint32_t(size);
+		entry.crc = uint32_t(crc32(crc32(0, nullptr, 0), static_cast<const Bytef*>(data), uInt(size)));
+		entry.method = MethodStored;
+
+		std::string deflated;
+		if (compress && size > 0)
+		{
+			z_stream zstream = {};
+			if (deflateInit2(&zstream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+			{
+				deflated.resize(deflateBound(&zstream, uLong(size)));
+				zstream.next_in = const_cast<Bytef*>(static_cast<const Bytef*>(data));
+				zstream.avail_in = uInt(size);
+				zstream.next_out = reinterpret_cast<Bytef*>(deflated.data());
+				zstream.avail_out = uInt(deflated.size());
+
+				int result = deflate(&zstream, Z_FINISH);
+				deflated.resize(zstream.total_out);
+				deflateEnd(&zstream);
+
+				// store what doesn't compress, e.g.: png and jpg
+				if (result == Z_STREAM_END && deflated.size() < size)
+				{
+					entry.method = MethodDeflated;
+					data = deflated.data();
+					size = deflated.size();
+				}
+			}
+		}
+
+		entry.compressedSize = uint32_t(size);
+
+		// pad stored entries, the padding needs to fit an extra field header
+		std::size_t padding = 0;
+		if (entry.method == MethodStored && alignment > 1)
+		{
+			std::size_t dataOffset = std::size_t(offset) + LocalHeaderSize + name.size();
+			padding = (alignment - dataOffset % alignment) % alignment;
+			while (padding != 0 && padding < ExtraHeaderSize)
+				padding += alignment;
+		}
+
+		std::string header;
+		header.reserve(LocalHeaderSize + name.size() + padding);
+		WriteUInt32(header, LocalHeaderSignature);
+		WriteUInt16(header, 20); // version needed: 2.0
+		WriteUInt16(header, 0x0800); // flags: utf-8 names
+		WriteUInt16(header, entry.method);
+		WriteUInt16(header, 0); // time
+		WriteUInt16(header, 0x21); // date: 1980-01-01, so equal input gives an equal pak
+		WriteUInt32(header, entry.crc);
+		WriteUInt32(header, entry.compressedSize);
+		WriteUInt32(header, entry.uncompressedSize);
+		WriteUInt16(header, uint16_t(name.size()));
+		WriteUInt16(header, uint16_t(padding));
+		header.append(name);
+
+		if (padding != 0)
+		{
+			WriteUInt16(header, AlignmentExtraId);
+			WriteUInt16(header, uint16_t(padding - ExtraHeaderSize));
+			header.append(padding - ExtraHeaderSize, '\0');
+		}
+
+		if (!Write(header.data(), header.size()) || !Write(data, size))
+		{
+			Debug::LogError("PakWriter: could not write to \"" + path + "\"");
+			return false;
+		}
+
+		entries.push_back(std::move(entry));
+		return true;
+	}
+
+	bool PakWriter::Close()
+	{
+		if (!IsOpen())
+			return false;
+
+		uint32_t directoryOffset = uint32_t(offset);
+
+		std::string directory;
+		for (const CentralEntry& entry : entries)
+		{
+			WriteUInt32(directory, CentralDirectorySignature);
+			WriteUInt16(directory, 20); // version made by
+			WriteUInt16(directory, 20); // version needed
+			WriteUInt16(directory, 0x0800);
+			WriteUInt16(directory, entry.method);
+			WriteUInt16(directory, 0);
+			WriteUInt16(directory, 0x21);
+			WriteUInt32(directory, entry.crc);
+			WriteUInt32(directory, entry.compressedSize);
+			WriteUInt32(directory, entry.uncompressedSize);
+			WriteUInt16(directory, uint16_t(entry.name.size()));
+			WriteUInt16(directory, 0); // extra field
+			WriteUInt16(directory, 0); // comment
+			WriteUInt16(directory, 0); // disk
+			WriteUInt16(directory, 0); // internal attributes
+			WriteUInt32(directory, 0); // external attributes
+			WriteUInt32(directory, entry.localHeaderOffset);
+			directory.append(entry.name);
+		}
+
+		uint32_t directorySize = uint32_t(directory.size());
+
+		WriteUInt32(directory, EndOfCentralDirectorySignature);
+		WriteUInt16(directory, 0);
+		WriteUInt16(directory, 0);
+		WriteUInt16(directory, uint16_t(entries.size()));
+		WriteUInt16(directory, uint16_t(entries.size()));
+		WriteUInt32(directory, directorySize);
+		WriteUInt32(directory, directoryOffset);
+		WriteUInt16(directory, 0);
+
+		bool success = Write(directory.data(), directory.size());
+		stream.close();
+		success = success && !stream.fail();
+
+		if (!success)
+			Debug::LogError("PakWriter: could not finish \"" + path + "\"");
+
+		entries.clear();
+		return success;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Esteem
+{
+	/// \brief writes zip (pak) archives that PakArchive can map
+	/// Stored entries are padded through the local extra field so their data starts on the requested alignment,
+	/// which lets loaders use them in place through Data::MapAsset(). Not thread safe.
+	class PakWriter
+	{
+	public:
+		/// \brief the alignment stored entries get by default, matches what the native asset formats expect
+		static constexpr uint32_t DefaultAlignment = 16;
+
+	private:
+		struct CentralEntry
+		{
+			std::string name;
+			uint32_t localHeaderOffset;
+			uint32_t compressedSize;
+			uint32_t uncompressedSize;
+			uint32_t crc;
+			uint16_t method;
+		};
+
+		std::string path;
+		std::ofstream stream;
+		uint64_t offset;
+		std::vector<CentralEntry> entries;
+
+		bool Write(const void* data, std::size_t size);
+
+	public:
+		PakWriter();
+		~PakWriter();
+
+		// disable copy
+		PakWriter(const PakWriter&) = delete;
+		void operator=(const PakWriter&) = delete;
+
+		/// \brief create (or truncate) the archive, closes any previously opened one
+		bool Open(const std::string& path);
+		/// \brief write the central directory, returns false if anything failed to write
+		bool Close();
+
+		inline bool IsOpen() const { return stream.is_open(); }
+
+		/// \brief add a file, names are stored as given so pass them normalized (see PakArchive::NormalizePath)
+		/// \param compress deflate the data, unless that doesn't make it any smaller
+		/// \param alignment data alignment of stored entries, 1 for none
+		bool Add(std::string_view name, const void* data, std::size_t size, bool compress, uint32_t alignment = DefaultAlignment);
+		inline bool Add(std::string_view name, std::string_view data, bool compress, uint32_t alignment = DefaultAlignment)
+		{
+			return Add(name, data.data(), data.size(), compress, alignment);
+		}
+
+		inline std::size_t GetEntryCount() const { return entries.size(); }
+	};
+}
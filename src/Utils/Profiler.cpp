@@ -0,0 +1,290 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	std::atomic<bool> Profiler::enabled(false);
+	const std::chrono::steady_clock::time_point Profiler::epoch = std::chrono::steady_clock::now();
+
+	std::mutex Profiler::ringsLock;
+	std::vector<std::unique_ptr<ProfileRing>> Profiler::rings;
+	thread_local ProfileRing* Profiler::localRing = nullptr;
+	std::vector<std::pair<uint32_t, std::string>> Profiler::retiredThreads;
+	uint32_t Profiler::nextThreadId = 0;
+
+	std::mutex Profiler::framesLock;
+	std::deque<ProfileFrame> Profiler::frames;
+	uint64_t Profiler::frameBegin = 0;
+
+	ProfileRing::ProfileRing(uint32_t threadId)
+		: events(nullptr)
+		, head(0)
+		, tail(0)
+		, dropped(0)
+		, retired(false)
+		, threadId(threadId)
+		, threadName("Thread " + std::to_string(threadId))
+		, depth(0)
+	{ }
+
+	ProfileRing::~ProfileRing()
+	{
+		delete[] events.load(std::memory_order_acquire);
+	}
+
+	void ProfileFrame::BuildHierarchy()
+	{
+		std::sort(events.begin(), events.end(), [](const ProfileEvent& a, const ProfileEvent& b)
+		{
+			if (a.threadId != b.threadId)
+				return a.threadId < b.threadId;
+
+			return a.begin != b.begin ? a.begin < b.begin : a.depth < b.depth;
+		});
+
+		nodes.resize(events.size());
+
+		std::vector<int32_t> lastChild(events.size(), -1);
+		std::vector<int32_t> openZones;
+		int32_t lastRoot = -1;
+
+		for (std::size_t i = 0; i < events.size(); ++i)
+		{
+			const ProfileEvent& event = events[i];
+			if (i == 0 || events[i - 1].threadId != event.threadId)
+				openZones.clear();
+
+			// zones of which the parent is still open, began in an earlier frame or was dropped become roots,
+			// the zone one level up must contain it, an earlier zone of that level has ended before it began
+			openZones.resize(event.depth, -1);
+			int32_t parent = event.depth > 0 ? openZones[event.depth - 1] : -1;
+			if (parent >= 0 && events[parent].end < event.end)
+				parent = -1;
+
+			openZones.push_back(int32_t(i));
+
+			nodes[i] = ProfileNode{ uint32_t(i), parent, -1, -1 };
+
+			int32_t& previous = parent >= 0 ? lastChild[parent] : lastRoot;
+			if (previous >= 0)
+				nodes[previous].nextSibling = int32_t(i);
+			else if (parent >= 0)
+				nodes[parent].firstChild = int32_t(i);
+
+			previous = int32_t(i);
+		}
+	}
+
+	namespace
+	{
+		/// \brief retires the ring of its thread when the thread exits, EndFrame() removes it after draining it
+		struct LocalRingOwner
+		{
+			ProfileRing* ring = nullptr;
+
+			~LocalRingOwner()
+			{
+				if (ring)
+					ring->Retire();
+			}
+		};
+
+		thread_local LocalRingOwner localRingOwner;
+	}
+
+	ProfileRing& Profiler::CreateLocalRing()
+	{
+		std::lock_guard<std::mutex> lock(ringsLock);
+		rings.emplace_back(std::make_unique<ProfileRing>(nextThreadId++));
+		localRing = rings.back().get();
+		localRingOwner.ring = localRing;
+
+		return *localRing;
+	}
+
+	ProfileRing& Profiler::CreateRing(std::string_view name)
+	{
+		std::lock_guard<std::mutex> lock(ringsLock);
+		rings.emplace_back(std::make_unique<ProfileRing>(nextThreadId++));
+		rings.back()->threadName = name;
+
+		return *rings.back();
+	}
+
+	void Profiler::DestroyRing(ProfileRing& ring)
+	{
+		ring.Retire();
+	}
+
+	std::size_t Profiler::GetRingCount()
+	{
+		std::lock_guard<std::mutex> lock(ringsLock);
+		return rings.size();
+	}
+
+	void Profiler::Start()
+	{
+		{
+			std::lock_guard<std::mutex> lock(framesLock);
+			frames.clear();
+			frameBegin = Now();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(ringsLock);
+			retiredThreads.clear();
+		}
+
+		enabled = true;
+	}
+
+	void Profiler::Stop()
+	{
+		enabled = false;
+	}
+
+	void Profiler::SetThreadName(std::string_view name)
+	{
+		ProfileRing& ring = GetLocalRing();
+
+		std::lock_guard<std::mutex> lock(ringsLock);
+		ring.threadName = name;
+	}
+
+	void Profiler::EndFrame()
+	{
+		ProfileFrame frame;
+		frame.begin = frameBegin;
+		frame.end = frameBegin = Now();
+
+		{
+			std::lock_guard<std::mutex> lock(ringsLock);
+			for (std::size_t i = 0; i < rings.size();)
+			{
+				// read before draining, everything the owner pushed before retiring is visible then
+				ProfileRing& ring = *rings[i];
+				bool retired = ring.IsRetired();
+				ring.Drain([&frame](const ProfileEvent& event) { frame.events.push_back(event); });
+
+				if (retired)
+				{
+					retiredThreads.emplace_back(ring.threadId, std::move(ring.threadName));
+					rings.erase(rings.begin() + i);
+				}
+				else
+					++i;
+			}
+		}
+
+		// still drain while disabled, the zones that were open when capturing stopped end up here
+		if (!IsEnabled())
+			return;
+
+		frame.BuildHierarchy();
+
+		std::lock_guard<std::mutex> lock(framesLock);
+		frames.emplace_back(std::move(frame));
+		if (frames.size() > MaxFrames)
+			frames.pop_front();
+	}
+
+	std::deque<ProfileFrame> Profiler::GetFrames()
+	{
+		std::lock_guard<std::mutex> lock(framesLock);
+		return frames;
+	}
+
+	bool Profiler::WriteChromeTrace(const std::string& path)
+	{
+		rapidjson::StringBuffer buffer;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+		writer.StartObject();
+		writer.Key("displayTimeUnit");
+		writer.String("ns");
+		writer.Key("traceEvents");
+		writer.StartArray();
+
+		uint32_t droppedEvents = 0;
+		{
+			auto threadName = [&writer](uint32_t threadId, const std::string& name)
+			{
+				writer.StartObject();
+				writer.Key("name"); writer.String("thread_name");
+				writer.Key("ph"); writer.String("M");
+				writer.Key("pid"); writer.Uint(0);
+				writer.Key("tid"); writer.Uint(threadId);
+				writer.Key("args");
+				writer.StartObject();
+				writer.Key("name"); writer.String(name.c_str(), rapidjson::SizeType(name.size()));
+				writer.EndObject();
+				writer.EndObject();
+			};
+
+			std::lock_guard<std::mutex> lock(ringsLock);
+			for (auto& ring : rings)
+			{
+				threadName(ring->threadId, ring->threadName);
+				droppedEvents += ring->GetDropped();
+			}
+
+			// threads that exited, their zones may still be in the captured frames
+			for (auto& retired : retiredThreads)
+				threadName(retired.first, retired.second);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(framesLock);
+			for (auto& frame : frames)
+			{
+				// frame boundaries as global instant events
+				writer.StartObject();
+				writer.Key("name"); writer.String("Frame");
+				writer.Key("ph"); writer.String("i");
+				writer.Key("s"); writer.String("g");
+				writer.Key("ts"); writer.Double(double(frame.begin) * 0.001);
+				writer.Key("pid"); writer.Uint(0);
+				writer.Key("tid"); writer.Uint(0);
+				writer.EndObject();
+
+				// complete events, the viewer nests them by time
+				for (auto& event : frame.events)
+				{
+					writer.StartObject();
+					writer.Key("name"); writer.String(event.name);
+					writer.Key("cat"); writer.String("cpu");
+					writer.Key("ph"); writer.String("X");
+					writer.Key("ts"); writer.Double(double(event.begin) * 0.001);
+					writer.Key("dur"); writer.Double(double(event.end - event.begin) * 0.001);
+					writer.Key("pid"); writer.Uint(0);
+					writer.Key("tid"); writer.Uint(event.threadId);
+					writer.EndObject();
+				}
+			}
+		}
+
+		writer.EndArray();
+		writer.EndObject();
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			Debug::LogError("Profiler: couldn't open \"" + path + "\" to write the trace to");
+			return false;
+		}
+
+		file.write(buffer.GetString(), buffer.GetSize());
+
+		if (droppedEvents)
+			Debug::LogWarning("Profiler: " + std::to_string(droppedEvents) + " zones were dropped, the per thread rings were full");
+
+		return file.good();
+	}
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#define ESTEEM_PROFILE_CONCAT_DETAIL(a, b) a##b
+#define ESTEEM_PROFILE_CONCAT(a, b) ESTEEM_PROFILE_CONCAT_DETAIL(a, b)
+
+#ifdef ESTEEM_PROFILING
+/// \brief profile the current scope, name must be a string literal
+#define ESTEEM_PROFILE(name) ::Esteem::ProfileZone ESTEEM_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define ESTEEM_PROFILE(name) ((void)0)
+#endif
+
+namespace Esteem
+{
+	/// \brief a finished zone, timestamps are in nanoseconds since the profiler's epoch
+	struct ProfileEvent
+	{
+		const char* name;
+		uint64_t begin;
+		uint64_t end;
+		uint32_t threadId;
+		uint32_t depth;
+	};
+
+	/// \brief zone in a frame hierarchy, children are linked through firstChild and nextSibling
+	struct ProfileNode
+	{
+		/// \brief index in ProfileFrame::events
+		uint32_t event;
+		int32_t parent;
+		int32_t firstChild;
+		int32_t nextSibling;
+	};
+
+	/// \brief all zones that finished during one frame, with their hierarchy per thread
+	struct ProfileFrame
+	{
+		uint64_t begin;
+		uint64_t end;
+		std::vector<ProfileEvent> events;
+		/// \brief one node per event, roots have parent -1 and are chained through nextSibling starting at node 0
+		std::vector<ProfileNode> nodes;
+
+		/// \brief sort the events per thread by begin time and link them to their parent zones
+		void BuildHierarchy();
+	};
+
+	/// \brief single producer, single consumer ring of finished zones, one per thread
+	/// The events are allocated by the first Push(), threads that are named but never profiled don't pay for them.
+	class ProfileRing
+	{
+	public:
+		static constexpr uint32_t Capacity = 1 << 14;
+
+	private:
+		/// \brief allocated by the owning thread, published with release so other threads see the allocated events
+		std::atomic<ProfileEvent*> events;
+		alignas(64) std::atomic<uint32_t> head;
+		alignas(64) std::atomic<uint32_t> tail;
+		std::atomic<uint32_t> dropped;
+		/// \brief set when the owner is gone, the ring is removed once drained
+		std::atomic<bool> retired;
+
+	public:
+		const uint32_t threadId;
+		std::string threadName;
+		/// \brief nesting level of the zone that is currently open, only touched by the owning thread
+		uint32_t depth;
+
+		ProfileRing(uint32_t threadId);
+		~ProfileRing();
+
+		// disable copy
+		ProfileRing(const ProfileRing&) = delete;
+		void operator=(const ProfileRing&) = delete;
+
+		/// \brief owning thread only, drops the event when the ring is full
+		void Push(const ProfileEvent& event);
+		/// \brief aggregator only
+		template<typename F>
+		void Drain(F&& function);
+
+		inline uint32_t GetDropped() const { return dropped.load(std::memory_order_relaxed); }
+		/// \brief owning thread only, nothing is pushed anymore after this
+		inline void Retire() { retired.store(true, std::memory_order_release); }
+		inline bool IsRetired() const { return retired.load(std::memory_order_acquire); }
+		inline bool IsAllocated() const { return events.load(std::memory_order_acquire) != nullptr; }
+	};
+
+	/// \brief hierarchical CPU profiler, zones are written lock free to per-thread rings and
+	/// collected into frames by EndFrame(), which can be exported as a Chrome trace (chrome://tracing).
+	class Profiler
+	{
+	public:
+		/// \brief amount of frames kept while capturing, older frames are discarded
+		static constexpr std::size_t MaxFrames = 600;
+
+	private:
+		static std::atomic<bool> enabled;
+		static const std::chrono::steady_clock::time_point epoch;
+
+		static std::mutex ringsLock;
+		static std::vector<std::unique_ptr<ProfileRing>> rings;
+		static thread_local ProfileRing* localRing;
+		/// \brief threadId and name of the rings that were removed, the captured frames may still have their zones
+		static std::vector<std::pair<uint32_t, std::string>> retiredThreads;
+		static uint32_t nextThreadId;
+
+		static std::mutex framesLock;
+		static std::deque<ProfileFrame> frames;
+		static uint64_t frameBegin;
+
+		static ProfileRing& CreateLocalRing();
+
+	public:
+		static inline bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+		/// \brief start capturing, previously captured frames are discarded
+		static void Start();
+		static void Stop();
+
+		/// \brief nanoseconds since the profiler's epoch
+		static uint64_t Now();
+
+		/// \brief get the calling thread's ring
+		static ProfileRing& GetLocalRing();
+
+		/// \brief name the calling thread in the exported trace
+		static void SetThreadName(std::string_view name);
+
+		/// \brief ring for a timeline that isn't a thread, e.g.: the GPU, only one thread may push to it
+		/// Hand it back with DestroyRing() once nothing pushes to it anymore.
+		static ProfileRing& CreateRing(std::string_view name);
+		/// \brief retire a ring of CreateRing(), it's removed by the next EndFrame()
+		static void DestroyRing(ProfileRing& ring);
+
+		/// \brief collect all finished zones into a new frame, call once per frame from the main thread
+		/// Also removes the rings of threads that exited.
+		static void EndFrame();
+
+		/// \brief amount of rings, including the ones waiting for EndFrame() to remove them
+		static std::size_t GetRingCount();
+
+		/// \brief copy of the captured frames, oldest first
+		static std::deque<ProfileFrame> GetFrames();
+
+		/// \brief export the captured frames as Chrome trace_event JSON
+		/// \return false if the file couldn't be written
+		static bool WriteChromeTrace(const std::string& path);
+	};
+
+	/// \brief scoped zone, use ESTEEM_PROFILE("name") instead of constructing this directly
+	/// Whether the profiler is enabled is read once on construction, a disabled zone costs a branch in both
+	/// the constructor and destructor on that member and nothing else.
+	class ProfileZone
+	{
+	private:
+		const char* name;
+		uint64_t begin;
+		const bool enabled;
+
+	public:
+		ProfileZone(const char* name);
+		~ProfileZone();
+
+		// disable copy
+		ProfileZone(const ProfileZone&) = delete;
+		void operator=(const ProfileZone&) = delete;
+	};
+}
+
+#include "./Profiler.inl"
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Profiler.h"
+
+namespace Esteem
+{
+	inline void ProfileRing::Push(const ProfileEvent& event)
+	{
+		uint32_t currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead - tail.load(std::memory_order_acquire) >= Capacity)
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		ProfileEvent* buffer = events.load(std::memory_order_relaxed);
+		if (!buffer)
+		{
+			buffer = new ProfileEvent[Capacity];
+			events.store(buffer, std::memory_order_release);
+		}
+
+		buffer[currentHead & (Capacity - 1)] = event;
+		head.store(currentHead + 1, std::memory_order_release);
+	}
+
+	template<typename F>
+	inline void ProfileRing::Drain(F&& function)
+	{
+		uint32_t currentTail = tail.load(std::memory_order_relaxed);
+		uint32_t currentHead = head.load(std::memory_order_acquire);
+		if (currentTail == currentHead)
+			return;
+
+		// the events were published before head moved
+		const ProfileEvent* buffer = events.load(std::memory_order_acquire);
+		for (; currentTail != currentHead; ++currentTail)
+			function(buffer[currentTail & (Capacity - 1)]);
+
+		tail.store(currentTail, std::memory_order_release);
+	}
+
+	inline uint64_t Profiler::Now()
+	{
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+	}
+
+	inline ProfileRing& Profiler::GetLocalRing()
+	{
+		return localRing ? *localRing : CreateLocalRing();
+	}
+
+	inline ProfileZone::ProfileZone(const char* name)
+		: name(name)
+		, enabled(Profiler::IsEnabled())
+	{
+		if (enabled)
+		{
+			++Profiler::GetLocalRing().depth;
+			begin = Profiler::Now();
+		}
+	}
+
+	inline ProfileZone::~ProfileZone()
+	{
+		if (enabled)
+		{
+			uint64_t end = Profiler::Now();
+			ProfileRing& ring = Profiler::GetLocalRing();
+			ring.Push(ProfileEvent{ name, begin, end, ring.threadId, --ring.depth });
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+#include "pak_inflate_buffer.h"
+
+namespace details
+{
+	/// \brief read-only buffer over a pak entry, either a view into the mapping or its own inflated copy
+	class pak_entry_buffer : public std::streambuf
+	{
+	private:
+		std::string inflated;
+
+		void set_range(const char* begin, std::size_t size)
+		{
+			char* first = const_cast<char*>(begin); // get area only, never written to
+			setg(first, first, first + size);
+		}
+
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which)
+		{
+			if (!(which & std::ios_base::in))
+				return pos_type(off_type(-1));
+
+			char* base = direction == std::ios_base::beg ? eback() : direction == std::ios_base::cur ? gptr() : egptr();
+			char* target = base + offset;
+			if (target < eback() || target > egptr())
+				return pos_type(off_type(-1));
+
+			setg(eback(), target, egptr());
+			return pos_type(off_type(target - eback()));
+		}
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which)
+		{
+			return seekoff(off_type(position), std::ios_base::beg, which);
+		}
+
+	public:
+		pak_entry_buffer(const char* data, std::size_t size)
+		{
+			set_range(data, size);
+		}
+
+		pak_entry_buffer(std::string&& contents)
+			: inflated(std::move(contents))
+		{
+			set_range(inflated.data(), inflated.size());
+		}
+
+		// disable copy
+		pak_entry_buffer(const pak_entry_buffer&) = delete;
+		void operator=(const pak_entry_buffer&) = delete;
+	};
+}
+
+/// \brief stream over a pak entry, see PakArchive
+class ipakstream : public std::istream
+{
+private:
+	std::unique_ptr<std::streambuf> buffer;
+
+public:
+	/// \brief stored entry, reads directly from the mapping which must outlive this stream
+	ipakstream(const char* data, std::size_t size)
+		: std::istream(nullptr)
+		, buffer(std::make_unique<details::pak_entry_buffer>(data, size))
+	{
+		rdbuf(buffer.get());
+	}
+
+	/// \brief compressed entry, already inflated
+	ipakstream(std::string&& contents)
+		: std::istream(nullptr)
+		, buffer(std::make_unique<details::pak_entry_buffer>(std::move(contents)))
+	{
+		rdbuf(buffer.get());
+	}
+
+	/// \brief deflated entry, inflated from the mapping while reading, seeks resume from the index's access points
+	ipakstream(const uint8_t* compressed, std::size_t compressedSize, uint64_t size, const std::shared_ptr<Esteem::PakSeekIndex>& index)
+		: std::istream(nullptr)
+		, buffer(std::make_unique<details::pak_inflate_buffer>(compressed, compressedSize, size, index))
+	{
+		rdbuf(buffer.get());
+	}
+};
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <streambuf>
+#include <vector>
+#include <zlib/zlib.h>
+
+#include "Utils/PakArchive.h"
+
+namespace details
+{
+	/// \brief inflates a deflated pak entry straight from the mapping in chunks
+	/// While inflating, access points are recorded into the (shared) seek index, seeking resumes from the nearest
+	/// point before the target instead of from the start, which keeps random access linear in the seek distance.
+	class pak_inflate_buffer : public std::streambuf
+	{
+	private:
+		static constexpr std::size_t WindowSize = Esteem::PakSeekIndex::WindowSize;
+		static constexpr std::size_t ChunkSize = 64 * 1024;
+
+		const uint8_t* input;
+		std::size_t inputSize;
+		uint64_t outputSize;
+		std::shared_ptr<Esteem::PakSeekIndex> index;
+
+		z_stream stream;
+		bool streamValid;
+
+		/// \brief up to WindowSize bytes of previous output followed by the get area
+		std::vector<char> buffer;
+		/// \brief uncompressed offset of eback()
+		uint64_t bufferStart;
+		/// \brief output offset of the last access point this stream passed
+		uint64_t lastPoint;
+
+		inline uint64_t position() const
+		{
+			return bufferStart + uint64_t(gptr() - eback());
+		}
+
+		/// \brief reset the inflater to the given access point, or the start of the entry when nullptr
+		void restore(const Esteem::PakSeekIndex::AccessPoint* point)
+		{
+			inflateReset(&stream);
+
+			std::size_t historySize = 0;
+			if (point != nullptr)
+			{
+				stream.next_in = const_cast<Bytef*>(input + point->input);
+				stream.avail_in = uInt(inputSize - point->input);
+				if (point->bits)
+					inflatePrime(&stream, point->bits, input[point->input - 1] >> (8 - point->bits));
+
+				inflateSetDictionary(&stream, point->window.data(), uInt(point->window.size()));
+
+				// keep the window in front, so points recorded from here on get their full dictionary
+				historySize = point->window.size();
+				std::memcpy(buffer.data(), point->window.data(), historySize);
+				bufferStart = lastPoint = point->output;
+			}
+			else
+			{
+				stream.next_in = const_cast<Bytef*>(input);
+				stream.avail_in = uInt(inputSize);
+				bufferStart = lastPoint = 0;
+			}
+
+			char* start = buffer.data() + historySize;
+			setg(start, start, start);
+			streamValid = true;
+		}
+
+		/// \brief replace the get area with the next chunk of output
+		bool fill()
+		{
+			bufferStart += uint64_t(egptr() - eback());
+			if (!streamValid || bufferStart >= outputSize)
+				return false;
+
+			// slide the last output in front as history
+			std::size_t historySize = std::min<std::size_t>(WindowSize, std::size_t(egptr() - buffer.data()));
+			std::memmove(buffer.data(), egptr() - historySize, historySize);
+
+			char* start = buffer.data() + historySize;
+			stream.next_out = reinterpret_cast<Bytef*>(start);
+			stream.avail_out = uInt(ChunkSize);
+
+			while (stream.avail_out > 0)
+			{
+				// Z_BLOCK stops at every block boundary, the only places an access point can be made
+				int result = inflate(&stream, Z_BLOCK);
+				if (result == Z_STREAM_END)
+					break;
+
+				if (result != Z_OK)
+				{
+					streamValid = false;
+					break;
+				}
+
+				char* end = reinterpret_cast<char*>(stream.next_out);
+				uint64_t output = bufferStart + uint64_t(end - start);
+				if ((stream.data_type & 128) && !(stream.data_type & 64) && output >= lastPoint + index->GetSpan())
+				{
+					lastPoint = output;
+					if (!index->Contains(output))
+					{
+						std::size_t windowSize = std::min<std::size_t>(WindowSize, std::size_t(end - buffer.data()));
+						index->Add(output, uint64_t(stream.next_in - input), stream.data_type & 7,
+							reinterpret_cast<const uint8_t*>(end - windowSize), windowSize);
+					}
+				}
+			}
+
+			char* end = reinterpret_cast<char*>(stream.next_out);
+			setg(start, start, end);
+			return end != start;
+		}
+
+		pos_type seek(uint64_t target)
+		{
+			if (target > outputSize)
+				return pos_type(off_type(-1));
+
+			uint64_t bufferEnd = bufferStart + uint64_t(egptr() - eback());
+			if (target >= bufferStart && target < bufferEnd)
+			{
+				setg(eback(), eback() + (target - bufferStart), egptr());
+				return pos_type(off_type(target));
+			}
+
+			// e.g.: seekg(0, std::ios::end) to get the size, don't inflate anything
+			if (target == outputSize)
+			{
+				bufferStart = target;
+				setg(buffer.data(), buffer.data(), buffer.data());
+				streamValid = false;
+				return pos_type(off_type(target));
+			}
+
+			// keep inflating forward unless an access point gets us closer
+			const Esteem::PakSeekIndex::AccessPoint* point = index->Find(target);
+			if (!streamValid || target < bufferStart || (point != nullptr && point->output > bufferEnd))
+				restore(point);
+
+			while (target >= bufferStart + uint64_t(egptr() - eback()))
+			{
+				if (!fill())
+					return pos_type(off_type(-1));
+			}
+
+			setg(eback(), eback() + (target - bufferStart), egptr());
+			return pos_type(off_type(target));
+		}
+
+	protected:
+		int_type underflow()
+		{
+			if (gptr() == egptr() && !fill())
+				return traits_type::eof();
+
+			return traits_type::to_int_type(*gptr());
+		}
+
+		std::streamsize showmanyc()
+		{
+			return std::streamsize(outputSize - position());
+		}
+
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which)
+		{
+			if (!(which & std::ios_base::in))
+				return pos_type(off_type(-1));
+
+			int64_t base = direction == std::ios_base::beg ? 0 : direction == std::ios_base::cur ? int64_t(position()) : int64_t(outputSize);
+			int64_t target = base + offset;
+			if (target < 0)
+				return pos_type(off_type(-1));
+
+			return seek(uint64_t(target));
+		}
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which)
+		{
+			return seekoff(off_type(position), std::ios_base::beg, which);
+		}
+
+	public:
+		pak_inflate_buffer(const uint8_t* input, std::size_t inputSize, uint64_t outputSize, const std::shared_ptr<Esteem::PakSeekIndex>& index)
+			: input(input)
+			, inputSize(inputSize)
+			, outputSize(outputSize)
+			, index(index ? index : std::make_shared<Esteem::PakSeekIndex>())
+			, stream()
+			, streamValid(false)
+			, buffer(WindowSize + ChunkSize)
+			, bufferStart(0)
+			, lastPoint(0)
+		{
+			if (inflateInit2(&stream, -MAX_WBITS) == Z_OK)
+				restore(nullptr);
+			else
+				setg(buffer.data(), buffer.data(), buffer.data());
+		}
+
+		~pak_inflate_buffer()
+		{
+			inflateEnd(&stream);
+		}
+
+		// disable copy
+		pak_inflate_buffer(const pak_inflate_buffer&) = delete;
+		void operator=(const pak_inflate_buffer&) = delete;
+	};
+}
@@ -0,0 +1,158 @@
+#include "Archetype.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	std::deque<ComponentTypeInfo>& ComponentTypes::GetInfos()
+	{
+		static std::deque<ComponentTypeInfo> infos;
+		return infos;
+	}
+
+	std::mutex& ComponentTypes::GetInfosLock()
+	{
+		static std::mutex lock;
+		return lock;
+	}
+
+	uint32_t ComponentTypes::Register(std::size_t size, std::size_t alignment, void(*moveConstruct)(void*, void*), void(*destruct)(void*))
+	{
+		// a mask has a bit per type and every archetype needs at least one row per chunk, ids past that would corrupt memory
+		if (alignment > alignof(ArchetypeChunk) || size + alignment + sizeof(ArchetypeEntity) > ArchetypeChunkSize)
+		{
+			Debug::LogError("ComponentTypes: a component of ", std::to_string(size), " bytes aligned to ", std::to_string(alignment), " doesn't fit in an archetype chunk of ", std::to_string(ArchetypeChunkSize), " bytes");
+			std::abort();
+		}
+
+		std::lock_guard<std::mutex> lock(GetInfosLock());
+		auto& infos = GetInfos();
+		if (infos.size() >= MaxArchetypeComponents)
+		{
+			Debug::LogError("ComponentTypes: more than ", std::to_string(MaxArchetypeComponents), " component types registered");
+			std::abort();
+		}
+
+		uint32_t id = uint32_t(infos.size());
+		infos.push_back(ComponentTypeInfo{ id, size, alignment, moveConstruct, destruct });
+		return id;
+	}
+
+	const ComponentTypeInfo& ComponentTypes::GetInfo(uint32_t id)
+	{
+		std::lock_guard<std::mutex> lock(GetInfosLock());
+		return GetInfos()[id];
+	}
+
+	Archetype::Archetype(ComponentMask mask)
+		: mask(mask)
+		, chunkCapacity(0)
+		, count(0)
+	{
+		columnIndices.fill(-1);
+
+		// column 0 is reserved for the entity handles
+		columnTypes.push_back(nullptr);
+		std::size_t rowSize = sizeof(ArchetypeEntity);
+		std::size_t padding = 0;
+
+		for (uint32_t id = 0; id < MaxArchetypeComponents; ++id)
+		{
+			if (mask & (ComponentMask(1) << id))
+			{
+				const ComponentTypeInfo& info = ComponentTypes::GetInfo(id);
+				columnIndices[id] = int16_t(columnTypes.size());
+				componentIds.push_back(id);
+				columnTypes.push_back(&info);
+
+				rowSize += info.size;
+				padding += info.alignment;
+			}
+		}
+
+		// fit as many rows as possible, reserve the worst case alignment padding between the columns
+		// every type fits on its own, but a combination of big ones may not
+		if (padding + rowSize > ArchetypeChunkSize)
+		{
+			Debug::LogError("Archetype: a row of ", std::to_string(rowSize), " bytes doesn't fit in an archetype chunk of ", std::to_string(ArchetypeChunkSize), " bytes");
+			std::abort();
+		}
+
+		chunkCapacity = (ArchetypeChunkSize - padding) / rowSize;
+
+		std::size_t offset = 0;
+		for (const ComponentTypeInfo* type : columnTypes)
+		{
+			std::size_t alignment = type ? type->alignment : alignof(ArchetypeEntity);
+			offset = (offset + alignment - 1) / alignment * alignment;
+			columnOffsets.push_back(offset);
+			offset += chunkCapacity * (type ? type->size : sizeof(ArchetypeEntity));
+		}
+
+		assert(offset <= ArchetypeChunkSize);
+	}
+
+	Archetype::~Archetype()
+	{
+		for (std::size_t row = 0; row < count; ++row)
+		{
+			for (std::size_t column = 1; column < columnTypes.size(); ++column)
+				columnTypes[column]->destruct(GetElement(column, row));
+		}
+	}
+
+	std::size_t Archetype::AllocateRow(ArchetypeEntity entity)
+	{
+		std::size_t row = count++;
+		if (row / chunkCapacity >= chunks.size())
+			chunks.emplace_back(std::make_unique<ArchetypeChunk>());
+
+		*static_cast<ArchetypeEntity*>(GetElement(0, row)) = entity;
+		return row;
+	}
+
+	ArchetypeEntity Archetype::RemoveRow(std::size_t row)
+	{
+		std::size_t last = count - 1;
+		ArchetypeEntity moved{ ~0u, 0 };
+
+		for (std::size_t column = 1; column < columnTypes.size(); ++column)
+		{
+			const ComponentTypeInfo* type = columnTypes[column];
+			type->destruct(GetElement(column, row));
+
+			if (row != last)
+			{
+				type->moveConstruct(GetElement(column, row), GetElement(column, last));
+				type->destruct(GetElement(column, last));
+			}
+		}
+
+		if (row != last)
+		{
+			moved = *static_cast<ArchetypeEntity*>(GetElement(0, last));
+			*static_cast<ArchetypeEntity*>(GetElement(0, row)) = moved;
+		}
+
+		count = last;
+
+		// release empty chunks, keep one spare around to prevent thrashing
+		while (chunks.size() > (count + chunkCapacity - 1) / chunkCapacity + 1)
+			chunks.pop_back();
+
+		return moved;
+	}
+
+	void Archetype::MoveRowTo(std::size_t row, Archetype& other, std::size_t otherRow)
+	{
+		for (uint32_t id : componentIds)
+		{
+			int16_t otherColumn = other.columnIndices[id];
+			if (otherColumn >= 0)
+				columnTypes[columnIndices[id]]->moveConstruct(other.GetElement(otherColumn, otherRow), GetElement(columnIndices[id], row));
+		}
+	}
+}
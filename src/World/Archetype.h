@@ -1,36 +1,132 @@
 #pragma once
 
+#include "stdafx.h"
+
 #include <array>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <type_traits>
 
 namespace Esteem
 {
-	template <typename... Components>
-	class Archetype
+	/// \brief maximum amount of different component types, one bit per type in a ComponentMask
+	constexpr std::size_t MaxArchetypeComponents = 64;
+	/// \brief size of a single SoA chunk, all columns of an archetype share one chunk
+	constexpr std::size_t ArchetypeChunkSize = 16 * 1024;
+
+	typedef uint64_t ComponentMask;
+
+	/// \brief handle to an entity in the archetype store, generation protects against stale handles
+	struct ArchetypeEntity
 	{
-	public:
-		typedef Components Components;
+		uint32_t index;
+		uint32_t generation;
+
+		inline bool operator==(const ArchetypeEntity& other) const { return index == other.index && generation == other.generation; }
+		inline bool operator!=(const ArchetypeEntity& other) const { return !(*this == other); }
 	};
 
-	template<size_t N, typename Component>
-	struct ComponentArray : std::array<Component, N> { };
+	/// \brief type erased information to move and destroy components inside chunks
+	struct ComponentTypeInfo
+	{
+		uint32_t id;
+		std::size_t size;
+		std::size_t alignment;
 
-	template<size_t N, typename Component, typename... Components>
-	struct ComponentArray : ComponentArray<N, Component>, ComponentArray<N, Components...> { };
+		void(*moveConstruct)(void* destination, void* source);
+		void(*destruct)(void* component);
+	};
 
-	template <size_t N, typename... Components>
-	class ArchetypeBucket
+	/// \brief hands out a dense id per component type, ids are assigned on first use
+	/// Registering more than MaxArchetypeComponents types, or a type that doesn't fit in a chunk, aborts.
+	class ComponentTypes
 	{
+	private:
+		/// \brief deque to keep the infos at a stable address
+		static std::deque<ComponentTypeInfo>& GetInfos();
+		/// \brief guards GetInfos(), types can be registered from any thread
+		static std::mutex& GetInfosLock();
+		static uint32_t Register(std::size_t size, std::size_t alignment, void(*moveConstruct)(void*, void*), void(*destruct)(void*));
+
+		template<class T>
+		static uint32_t Register();
+
 	public:
-		typedef Archetype<Components...> Archetype;
+		template<class T>
+		static uint32_t GetId();
+
+		template<class T>
+		static ComponentMask GetMask();
+
+		template<class... Ts>
+		static ComponentMask GetMasks();
+
+		static const ComponentTypeInfo& GetInfo(uint32_t id);
+	};
+
+	struct alignas(64) ArchetypeChunk
+	{
+		std::byte data[ArchetypeChunkSize];
+	};
+
+	/// \brief stores all entities with exactly the same set of components
+	/// Components are stored in SoA columns inside 16 KiB chunks, rows are kept dense by swap-removal.
+	class Archetype
+	{
+		friend class ArchetypeStore;
 
 	private:
-		ComponentArray<N, Components...> components;
+		ComponentMask mask;
+		std::vector<uint32_t> componentIds;
+		std::array<int16_t, MaxArchetypeComponents> columnIndices;
+
+		/// \brief byte offset of each column inside a chunk, column 0 holds the ArchetypeEntity handles
+		std::vector<std::size_t> columnOffsets;
+		std::vector<const ComponentTypeInfo*> columnTypes;
+
+		std::vector<std::unique_ptr<ArchetypeChunk>> chunks;
+		std::size_t chunkCapacity;
+		std::size_t count;
+
+		void* GetElement(std::size_t column, std::size_t row) const;
+
+		/// \brief add a row for the entity, components are left unconstructed
+		std::size_t AllocateRow(ArchetypeEntity entity);
+		/// \brief destroy the row's components and move the last row in its place
+		/// \return entity that got moved into the given row, index is ~0 if nothing was moved
+		ArchetypeEntity RemoveRow(std::size_t row);
+		/// \brief move all components this archetype shares with the other into its row
+		void MoveRowTo(std::size_t row, Archetype& other, std::size_t otherRow);
 
 	public:
-		template<typename T>
-		ComponentArray<N, T>& GetComponents()
-		{
-			return static_cast<ComponentArray<N, T>>(components);
-		}
+		Archetype(ComponentMask mask);
+
+		// disable copy
+		Archetype(const Archetype&) = delete;
+		void operator=(const Archetype&) = delete;
+
+		~Archetype();
+
+		inline ComponentMask GetMask() const { return mask; }
+		inline std::size_t GetCount() const { return count; }
+		inline std::size_t GetChunkCapacity() const { return chunkCapacity; }
+		inline std::size_t GetChunkCount() const { return chunks.size(); }
+		/// \brief amount of used rows in the given chunk
+		inline std::size_t GetChunkRows(std::size_t chunk) const;
+
+		inline bool HasComponent(uint32_t componentId) const { return columnIndices[componentId] >= 0; }
+
+		/// \brief get the contiguous column of component T in the given chunk
+		template<class T>
+		T* GetColumn(std::size_t chunk) const;
+		const ArchetypeEntity* GetEntities(std::size_t chunk) const;
+
+		template<class T>
+		T& GetComponent(std::size_t row) const;
 	};
-}
\ No newline at end of file
+}
+
+#include "./Archetype.inl"
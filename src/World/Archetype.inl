@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Archetype.h"
+
+#include <cassert>
+
+namespace Esteem
+{
+	template<class T>
+	inline uint32_t ComponentTypes::Register()
+	{
+		static_assert(std::is_move_constructible_v<T>, "archetype components need to be move constructible");
+
+		return Register(sizeof(T), alignof(T),
+			[](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+			[](void* component) { static_cast<T*>(component)->~T(); });
+	}
+
+	template<class T>
+	inline uint32_t ComponentTypes::GetId()
+	{
+		static const uint32_t id = Register<std::decay_t<T>>();
+		return id;
+	}
+
+	template<class T>
+	inline ComponentMask ComponentTypes::GetMask()
+	{
+		return ComponentMask(1) << GetId<T>();
+	}
+
+	template<class... Ts>
+	inline ComponentMask ComponentTypes::GetMasks()
+	{
+		return (ComponentMask(0) | ... | GetMask<Ts>());
+	}
+
+	inline std::size_t Archetype::GetChunkRows(std::size_t chunk) const
+	{
+		std::size_t begin = chunk * chunkCapacity;
+		return count > begin ? std::min(count - begin, chunkCapacity) : 0;
+	}
+
+	inline void* Archetype::GetElement(std::size_t column, std::size_t row) const
+	{
+		const ComponentTypeInfo* type = columnTypes[column];
+		std::size_t size = type ? type->size : sizeof(ArchetypeEntity);
+		return chunks[row / chunkCapacity]->data + columnOffsets[column] + (row % chunkCapacity) * size;
+	}
+
+	template<class T>
+	inline T* Archetype::GetColumn(std::size_t chunk) const
+	{
+		int16_t column = columnIndices[ComponentTypes::GetId<T>()];
+		assert(column >= 0);
+		return reinterpret_cast<T*>(chunks[chunk]->data + columnOffsets[column]);
+	}
+
+	inline const ArchetypeEntity* Archetype::GetEntities(std::size_t chunk) const
+	{
+		return reinterpret_cast<const ArchetypeEntity*>(chunks[chunk]->data);
+	}
+
+	template<class T>
+	inline T& Archetype::GetComponent(std::size_t row) const
+	{
+		return GetColumn<T>(row / chunkCapacity)[row % chunkCapacity];
+	}
+}
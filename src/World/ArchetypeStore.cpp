@@ -0,0 +1,99 @@
+#include "ArchetypeStore.h"
+
+namespace Esteem
+{
+	ArchetypeStore::ArchetypeStore()
+		: archetypeGeneration(0)
+	{ }
+
+	ArchetypeStore::~ArchetypeStore()
+	{
+		// archetypes destroy their own components
+		queries.clear();
+		archetypes.clear();
+	}
+
+	Archetype& ArchetypeStore::GetOrCreateArchetype(ComponentMask mask)
+	{
+		auto found = archetypesByMask.find(mask);
+		if (found != archetypesByMask.end())
+			return *found->second;
+
+		archetypes.emplace_back(std::make_unique<Archetype>(mask));
+		Archetype* archetype = archetypes.back().get();
+		archetypesByMask.emplace(mask, archetype);
+		++archetypeGeneration;
+
+		return *archetype;
+	}
+
+	ArchetypeEntity ArchetypeStore::CreateEntity()
+	{
+		uint32_t index;
+		if (!freeRecords.empty())
+		{
+			index = freeRecords.back();
+			freeRecords.pop_back();
+		}
+		else
+		{
+			index = uint32_t(records.size());
+			records.push_back(EntityRecord{ nullptr, 0, 0 });
+		}
+
+		EntityRecord& record = records[index];
+		ArchetypeEntity entity{ index, record.generation };
+
+		record.archetype = &GetOrCreateArchetype(0);
+		record.row = record.archetype->AllocateRow(entity);
+
+		return entity;
+	}
+
+	void ArchetypeStore::DestroyEntity(ArchetypeEntity entity)
+	{
+		if (!IsAlive(entity))
+			return;
+
+		EntityRecord& record = records[entity.index];
+		ArchetypeEntity moved = record.archetype->RemoveRow(record.row);
+		if (moved.index != ~0u)
+			records[moved.index].row = record.row;
+
+		record.archetype = nullptr;
+		record.generation++;
+		freeRecords.push_back(entity.index);
+	}
+
+	std::size_t ArchetypeStore::Migrate(ArchetypeEntity entity, ComponentMask mask)
+	{
+		// fetch the target first, creating it may not invalidate the source as archetypes are heap allocated
+		Archetype& target = GetOrCreateArchetype(mask);
+		EntityRecord& record = records[entity.index];
+		Archetype& source = *record.archetype;
+
+		std::size_t row = target.AllocateRow(entity);
+		source.MoveRowTo(record.row, target, row);
+
+		ArchetypeEntity moved = source.RemoveRow(record.row);
+		if (moved.index != ~0u)
+			records[moved.index].row = record.row;
+
+		record.archetype = &target;
+		record.row = row;
+
+		return row;
+	}
+
+	void ArchetypeStore::UpdateQuery(ArchetypeQueryCache& query) const
+	{
+		for (; query.checkedArchetypes < archetypes.size(); ++query.checkedArchetypes)
+		{
+			Archetype* archetype = archetypes[query.checkedArchetypes].get();
+			if ((archetype->GetMask() & query.mask) == query.mask)
+				query.archetypes.push_back(archetype);
+		}
+
+		query.generation = archetypeGeneration;
+	}
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "./Archetype.h"
+
+namespace Esteem
+{
+	class ArchetypeStore;
+
+	/// \brief cached list of archetypes matching a component mask, refreshed when new archetypes appear
+	class ArchetypeQueryCache
+	{
+		friend class ArchetypeStore;
+
+	private:
+		ComponentMask mask;
+		std::vector<Archetype*> archetypes;
+		std::size_t checkedArchetypes;
+		/// \brief archetype generation of the store when the archetypes were last matched
+		uint32_t generation;
+
+	public:
+		ArchetypeQueryCache(ComponentMask mask)
+			: mask(mask)
+			, checkedArchetypes(0)
+			, generation(0)
+		{ }
+
+		inline const std::vector<Archetype*>& GetArchetypes() const { return archetypes; }
+	};
+
+	/// \brief typed view on a query cache, iterates all matching chunks in contiguous memory
+	/// Archetypes created after the query was made are matched on the next ForEach(), ForEachChunk() or Count(),
+	/// so don't iterate while another thread adds or removes components.
+	template<class... Ts>
+	class ArchetypeQuery
+	{
+	private:
+		ArchetypeStore* store;
+		ArchetypeQueryCache* cache;
+
+		/// \brief match the archetypes that were created since the last call
+		void Refresh() const;
+
+	public:
+		ArchetypeQuery(ArchetypeStore& store, ArchetypeQueryCache& cache)
+			: store(&store)
+			, cache(&cache)
+		{ }
+
+		/// \brief call function(Ts&...) for every entity that has all components
+		template<typename F>
+		void ForEach(F&& function) const;
+
+		/// \brief call function(count, entities, Ts*...) for every chunk, useful for SIMD or batched work
+		template<typename F>
+		void ForEachChunk(F&& function) const;
+
+		std::size_t Count() const;
+	};
+
+	/// \brief archetype based entity/component store, lives next to the AbstractConstituent path
+	/// Entities with the same set of components share an Archetype, adding or removing a component migrates the entity.
+	class ArchetypeStore
+	{
+		template<class... Ts>
+		friend class ArchetypeQuery;
+
+	private:
+		struct EntityRecord
+		{
+			Archetype* archetype;
+			std::size_t row;
+			uint32_t generation;
+		};
+
+		std::vector<std::unique_ptr<Archetype>> archetypes;
+		std::unordered_map<ComponentMask, Archetype*> archetypesByMask;
+
+		std::vector<EntityRecord> records;
+		std::vector<uint32_t> freeRecords;
+
+		std::unordered_map<ComponentMask, std::unique_ptr<ArchetypeQueryCache>> queries;
+		/// \brief bumped for every new archetype, query caches of another generation need to be matched again
+		uint32_t archetypeGeneration;
+
+		Archetype& GetOrCreateArchetype(ComponentMask mask);
+		/// \brief move the entity to the archetype with the given mask, returns its new row
+		std::size_t Migrate(ArchetypeEntity entity, ComponentMask mask);
+		void UpdateQuery(ArchetypeQueryCache& query) const;
+		/// \brief UpdateQuery() when archetypes were created since the query was last matched
+		void RefreshQuery(ArchetypeQueryCache& query) const;
+
+	public:
+		ArchetypeStore();
+		~ArchetypeStore();
+
+		// disable copy
+		ArchetypeStore(const ArchetypeStore&) = delete;
+		void operator=(const ArchetypeStore&) = delete;
+
+		ArchetypeEntity CreateEntity();
+		void DestroyEntity(ArchetypeEntity entity);
+		bool IsAlive(ArchetypeEntity entity) const;
+
+		template<class T, class... Args>
+		T& AddComponent(ArchetypeEntity entity, Args&&... args);
+
+		template<class T>
+		void RemoveComponent(ArchetypeEntity entity);
+
+		template<class T>
+		bool HasComponent(ArchetypeEntity entity) const;
+
+		/// \brief get the component, returns nullptr when the entity doesn't have it
+		template<class T>
+		T* GetComponent(ArchetypeEntity entity) const;
+
+		/// \brief get a cached query, the returned view stays valid for the lifetime of this store
+		/// and also visits archetypes that are created later on
+		template<class... Ts>
+		ArchetypeQuery<Ts...> Query();
+
+		inline const std::vector<std::unique_ptr<Archetype>>& GetArchetypes() const { return archetypes; }
+	};
+}
+
+#include "./ArchetypeStore.inl"
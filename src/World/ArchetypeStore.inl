@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ArchetypeStore.h"
+
+#include <cassert>
+#include <utility>
+
+namespace Esteem
+{
+	template<class... Ts>
+	inline void ArchetypeQuery<Ts...>::Refresh() const
+	{
+		store->RefreshQuery(*cache);
+	}
+
+	template<class... Ts>
+	template<typename F>
+	inline void ArchetypeQuery<Ts...>::ForEach(F&& function) const
+	{
+		ForEachChunk([&function](std::size_t count, const ArchetypeEntity*, Ts*... columns)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				function(columns[i]...);
+		});
+	}
+
+	template<class... Ts>
+	template<typename F>
+	inline void ArchetypeQuery<Ts...>::ForEachChunk(F&& function) const
+	{
+		Refresh();
+
+		for (Archetype* archetype : cache->GetArchetypes())
+		{
+			for (std::size_t chunk = 0; chunk < archetype->GetChunkCount(); ++chunk)
+			{
+				std::size_t rows = archetype->GetChunkRows(chunk);
+				if (rows > 0)
+					function(rows, archetype->GetEntities(chunk), archetype->template GetColumn<Ts>(chunk)...);
+			}
+		}
+	}
+
+	template<class... Ts>
+	inline std::size_t ArchetypeQuery<Ts...>::Count() const
+	{
+		Refresh();
+
+		std::size_t count = 0;
+		for (Archetype* archetype : cache->GetArchetypes())
+			count += archetype->GetCount();
+
+		return count;
+	}
+
+	template<class T, class... Args>
+	inline T& ArchetypeStore::AddComponent(ArchetypeEntity entity, Args&&... args)
+	{
+		assert(IsAlive(entity));
+
+		EntityRecord& record = records[entity.index];
+		if (record.archetype->HasComponent(ComponentTypes::GetId<T>()))
+			return record.archetype->GetComponent<T>(record.row) = T(std::forward<Args>(args)...);
+
+		std::size_t row = Migrate(entity, record.archetype->GetMask() | ComponentTypes::GetMask<T>());
+		return *new (&records[entity.index].archetype->GetComponent<T>(row)) T(std::forward<Args>(args)...);
+	}
+
+	template<class T>
+	inline void ArchetypeStore::RemoveComponent(ArchetypeEntity entity)
+	{
+		if (HasComponent<T>(entity))
+			Migrate(entity, records[entity.index].archetype->GetMask() & ~ComponentTypes::GetMask<T>());
+	}
+
+	template<class T>
+	inline bool ArchetypeStore::HasComponent(ArchetypeEntity entity) const
+	{
+		return IsAlive(entity) && records[entity.index].archetype->HasComponent(ComponentTypes::GetId<T>());
+	}
+
+	template<class T>
+	inline T* ArchetypeStore::GetComponent(ArchetypeEntity entity) const
+	{
+		if (!HasComponent<T>(entity))
+			return nullptr;
+
+		const EntityRecord& record = records[entity.index];
+		return &record.archetype->GetComponent<T>(record.row);
+	}
+
+	template<class... Ts>
+	inline ArchetypeQuery<Ts...> ArchetypeStore::Query()
+	{
+		ComponentMask mask = ComponentTypes::GetMasks<Ts...>();
+
+		auto& query = queries[mask];
+		if (!query)
+			query = std::make_unique<ArchetypeQueryCache>(mask);
+
+		RefreshQuery(*query);
+		return ArchetypeQuery<Ts...>(*this, *query);
+	}
+
+	inline void ArchetypeStore::RefreshQuery(ArchetypeQueryCache& query) const
+	{
+		if (query.generation != archetypeGeneration)
+			UpdateQuery(query);
+	}
+
+	inline bool ArchetypeStore::IsAlive(ArchetypeEntity entity) const
+	{
+		return entity.index < records.size() && records[entity.index].generation == entity.generation && records[entity.index].archetype;
+	}
+}
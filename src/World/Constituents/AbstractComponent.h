@@ -43,6 +43,10 @@ namespace Esteem
 
 		virtual void DirtyCleanUp() {}
 
+		/// \brief opt-in, if true Update() and LateUpdate() only touch this component and its own entity
+		/// An entity of which all components are thread safe is updated in parallel with other entities.
+		virtual bool IsThreadSafeUpdate() const { return false; }
+
 		virtual void OnEnable() {};
 
 		virtual void OnDisable() {};
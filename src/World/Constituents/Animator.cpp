@@ -13,6 +13,7 @@
 #include "Utils/Time.h"
 #include "Utils/Data.h"
 #include "Utils/Debug.h"
+#include "Memory/FrameArena.h"
 
 #include "World/World.h"
 #include "Physics/Physics.h"
@@ -91,7 +92,7 @@ namespace Esteem
 		auto bonesEnd = boneData->cend();
 		const Model::BoneData& root = bones[0];
 		
-		std::vector<Animation::MixedFrame> localTransforms;
+		frame_vector<Animation::MixedFrame> localTransforms(&FrameArena::Get());
 		localTransforms.reserve(boneData->size());
 		localTransforms.push_back(InterpolateSequences(root, sequences[0], nullptr, 0.f));
 		localTransforms[0].t.x = 0.f;
@@ -7,7 +7,8 @@ namespace Esteem
 {
 	void AudioEmitter::Initialize()
 	{
-		emitter.setPosition(reinterpret_cast<const sf::Vector3f&>(entity->GetPosition()));
+		Vector3 position = entity->GetPosition();
+		emitter.setPosition(reinterpret_cast<const sf::Vector3f&>(position));
 	}
 
 	void AudioEmitter::Start()
@@ -65,7 +66,8 @@ namespace Esteem
 
 	void AudioEmitter::DirtyCleanUp()
 	{
-		emitter.setPosition(reinterpret_cast<const sf::Vector3f&>(entity->GetPosition()));
+		Vector3 position = entity->GetPosition();
+		emitter.setPosition(reinterpret_cast<const sf::Vector3f&>(position));
 	}
 }
 
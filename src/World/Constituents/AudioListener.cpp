@@ -42,7 +42,8 @@ namespace Esteem
 
 	void AudioListener::DirtyCleanUp()
 	{
-		listener.setPosition(reinterpret_cast<const sf::Vector3f&>(entity->GetPosition()));
+		Vector3 position = entity->GetPosition();
+		listener.setPosition(reinterpret_cast<const sf::Vector3f&>(position));
 		listener.setUpVector(reinterpret_cast<const sf::Vector3f&>(entity->GetUp()));
 		listener.setDirection(reinterpret_cast<const sf::Vector3f&>(entity->GetForward()));
 	}
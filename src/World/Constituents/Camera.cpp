@@ -34,17 +34,23 @@ namespace Esteem
 
 	void Camera::Initialize()
 	{
-		auto& size = View::GetView()->GetScreenSize();
+		// headless, e.g. on the null renderer, there is no view to follow nor an html context to draw in
+		IView* view = View::GetView();
+		glm::ivec2 size = view ? view->GetScreenSize() : glm::ivec2(Settings::initialScreenSize);
 
-		// weird naming convention
-		uintptr_t intPtr = uintptr_t(this);
-		while (Rml::GetContext("Default_" + std::to_string(intPtr)))
-			++intPtr;
+		if (view)
+		{
+			// weird naming convention
+			uintptr_t intPtr = uintptr_t(this);
+			while (Rml::GetContext("Default_" + std::to_string(intPtr)))
+				++intPtr;
 
-		renderCamera->guiContext = Rml::CreateContext("Default_" + std::to_string(intPtr), { size.x, size.y });
+			renderCamera->guiContext = Rml::CreateContext("Default_" + std::to_string(intPtr), { size.x, size.y });
+		}
 
 		OnScreenSizeChanged(size);
-		View::GetView()->RegisterScreenSizeListener(DELEGATE(&Camera::OnScreenSizeChanged, this));
+		if (view)
+			view->RegisterScreenSizeListener(DELEGATE(&Camera::OnScreenSizeChanged, this));
 
 		entity->SetDirections(glm::mat3(entity->GetRotation()));
 
@@ -53,9 +59,10 @@ namespace Esteem
 	
 	Camera::~Camera()
 	{
-		View::GetView()->UnRegisterScreenSizeListener(DELEGATE(&Camera::OnScreenSizeChanged, this));
+		if (IView* view = View::GetView())
+			view->UnRegisterScreenSizeListener(DELEGATE(&Camera::OnScreenSizeChanged, this));
 
-		if (!Rml::RemoveContext(renderCamera->guiContext->GetName()))
+		if (renderCamera->guiContext && !Rml::RemoveContext(renderCamera->guiContext->GetName()))
 			Debug::LogWarning("Couldn't remove the HTML context");
 	}
 
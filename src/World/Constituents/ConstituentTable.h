@@ -0,0 +1,126 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <vector>
+#include <cppu/cgc/pointers.h>
+
+#include "./ConstituentTypes.h"
+
+namespace Esteem
+{
+	/// \brief bitmask indexed lookup table, one entry per set bit ordered by bit index
+	/// Finding a type is a bit test plus a popcount, a derived type also occupies the bits of its registered bases.
+	/// Polymorphic constituents are found by their dynamic type as well, also when they were added through a base pointer.
+	template<class Base>
+	class ConstituentTable
+	{
+	private:
+		struct Added
+		{
+			cgc::strong_ptr<Base> constituent;
+			/// \brief bits of its static and dynamic type and their bases
+			ConstituentMask mask;
+			uint32_t typeId;
+		};
+
+		ConstituentMask mask;
+		std::vector<cgc::strong_ptr<Base>> entries;
+		/// \brief in order of addition, the first one added gets the bits it shares with later ones
+		std::vector<Added> added;
+
+		inline std::size_t IndexOf(ConstituentMask bit) const
+		{
+			return ConstituentMaskCount(mask & (bit - 1));
+		}
+
+		/// \brief give the bits of the constituent that are still free to it
+		void Assign(const cgc::strong_ptr<Base>& constituent, ConstituentMask typeMask)
+		{
+			for (ConstituentMask bits = typeMask; bits; bits &= bits - 1)
+			{
+				ConstituentMask bit = bits & (~bits + 1);
+				if (!(mask & bit))
+				{
+					entries.insert(entries.begin() + IndexOf(bit), constituent);
+					mask |= bit;
+				}
+			}
+		}
+
+	public:
+		ConstituentTable()
+			: mask(0)
+		{ }
+
+		template<class T>
+		inline bool Has() const
+		{
+			return (mask & (ConstituentMask(1) << ConstituentTypes<Base>::template GetId<T>())) != 0;
+		}
+
+		template<class T>
+		inline cgc::strong_ptr<T> Get() const
+		{
+			ConstituentMask bit = ConstituentMask(1) << ConstituentTypes<Base>::template GetId<T>();
+			return (mask & bit) ? cgc::static_pointer_cast<T>(entries[IndexOf(bit)]) : nullptr;
+		}
+
+		/// \brief add the constituent under its own type, its dynamic type and all registered base types that are still free
+		/// \return false if a constituent of exactly this dynamic type was already added
+		template<class T>
+		bool Add(const cgc::strong_ptr<T>& constituent)
+		{
+			if (!constituent)
+				return false;
+
+			uint32_t typeId = ConstituentTypes<Base>::GetId(*constituent.ptr());
+			for (const Added& other : added)
+			{
+				if (other.typeId == typeId)
+					return false;
+			}
+
+			ConstituentMask typeMask = ConstituentTypes<Base>::GetMask(*constituent.ptr());
+			added.push_back({ constituent, typeMask, typeId });
+			Assign(constituent, typeMask);
+			return true;
+		}
+
+		/// \brief remove the constituent of type T including the base type entries it occupied
+		template<class T>
+		cgc::strong_ptr<T> Remove()
+		{
+			cgc::strong_ptr<T> constituent = Get<T>();
+			if (constituent)
+				Remove(constituent);
+
+			return constituent;
+		}
+
+		/// \brief remove the constituent, the bits it occupied go to the remaining constituents that match them
+		void Remove(const cgc::strong_ptr<Base>& constituent)
+		{
+			auto found = std::find_if(added.begin(), added.end(), [&constituent](const Added& other) { return other.constituent == constituent; });
+			if (found == added.end())
+				return;
+
+			added.erase(found);
+
+			entries.clear();
+			mask = 0;
+			for (const Added& other : added)
+				Assign(other.constituent, other.mask);
+		}
+
+		void Clear()
+		{
+			entries.clear();
+			added.clear();
+			mask = 0;
+		}
+
+		inline ConstituentMask GetMask() const { return mask; }
+	};
+}
@@ -0,0 +1,76 @@
+#include "ConstituentTypes.h"
+
+#include <cstdlib>
+#include <utility>
+
+#include "Utils/Debug.h"
+
+namespace Esteem
+{
+	std::unordered_map<std::type_index, std::vector<std::type_index>>& ConstituentBaseTypes::GetBases()
+	{
+		// function local, the registrars of other translation units may run before a namespace scope map is constructed
+		static std::unordered_map<std::type_index, std::vector<std::type_index>> bases;
+		return bases;
+	}
+
+	void ConstituentBaseTypes::Add(std::type_index type, std::vector<std::type_index>&& bases)
+	{
+		GetBases()[type] = std::move(bases);
+	}
+
+	const std::vector<std::type_index>* ConstituentBaseTypes::Get(std::type_index type)
+	{
+		auto& bases = GetBases();
+		auto found = bases.find(type);
+		return found != bases.end() ? &found->second : nullptr;
+	}
+
+	ConstituentTypeRegistry::ConstituentTypeRegistry()
+	{
+		bases.fill(0);
+	}
+
+	uint32_t ConstituentTypeRegistry::Register(std::type_index type)
+	{
+		auto found = ids.find(type);
+		if (found != ids.end())
+			return found->second;
+
+		// the id is a bit in a 64 bit mask, shifting past it is undefined
+		if (ids.size() >= MaxConstituentTypes)
+		{
+			Debug::LogError("ConstituentTypes: registering ", type.name(), " exceeds the maximum of ", std::to_string(MaxConstituentTypes), " types");
+			std::abort();
+		}
+
+		uint32_t id = uint32_t(ids.size());
+		ids.emplace(type, id);
+
+		// the bases are registered the first time the type is seen, whether that's statically or through a base pointer
+		if (const std::vector<std::type_index>* typeBases = ConstituentBaseTypes::Get(type))
+		{
+			for (std::type_index base : *typeBases)
+			{
+				uint32_t baseId = Register(base);
+				bases[id] |= (ConstituentMask(1) << baseId) | bases[baseId];
+			}
+		}
+
+		return id;
+	}
+
+	uint32_t ConstituentTypeRegistry::GetId(std::type_index type)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return Register(type);
+	}
+
+	ConstituentMask ConstituentTypeRegistry::GetMask(std::type_index type)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		uint32_t id = Register(type);
+		return (ConstituentMask(1) << id) | bases[id];
+	}
+}
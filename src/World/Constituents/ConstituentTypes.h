@@ -0,0 +1,146 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <array>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
+namespace Esteem
+{
+	/// \brief maximum amount of constituent (or component) types per family, one bit each
+	constexpr std::size_t MaxConstituentTypes = 64;
+
+	typedef uint64_t ConstituentMask;
+
+	inline uint32_t ConstituentMaskCount(ConstituentMask mask)
+	{
+#ifdef _MSC_VER
+		return uint32_t(__popcnt64(mask));
+#else
+		return uint32_t(__builtin_popcountll(mask));
+#endif
+	}
+
+	/// \brief base classes of every type that specialized ConstituentBases, filled before main() by their registrars
+	class ConstituentBaseTypes
+	{
+	private:
+		static std::unordered_map<std::type_index, std::vector<std::type_index>>& GetBases();
+
+	public:
+		static void Add(std::type_index type, std::vector<std::type_index>&& bases);
+		/// \return nullptr when the type has no registered bases
+		static const std::vector<std::type_index>* Get(std::type_index type);
+	};
+
+	template<class T, class Tuple>
+	struct ConstituentBasesRegistrar;
+
+	/// \brief static member of a ConstituentBases specialization, registers the bases when the type is known but before
+	/// any of its ids are, so it's also found through its bases when it's only ever added through a base pointer
+	template<class T, class... Bases>
+	struct ConstituentBasesRegistrar<T, std::tuple<Bases...>>
+	{
+		ConstituentBasesRegistrar()
+		{
+			ConstituentBaseTypes::Add(typeid(T), { std::type_index(typeid(Bases))... });
+		}
+	};
+
+	/// \brief specialize this trait to register base classes, e.g.: so asking for a Collider returns the RigidBody
+	/// Every specialization needs the registrar as well:
+	///	template<>
+	///	struct ConstituentBases<RigidBody>
+	///	{
+	///		typedef std::tuple<Collider> Types;
+	///		static inline const ConstituentBasesRegistrar<RigidBody, Types> registrar;
+	///	};
+	template<class T>
+	struct ConstituentBases
+	{
+		typedef std::tuple<> Types;
+	};
+
+	/// \brief maps the types of one family to dense ids, a type gets the same id whether it's seen statically or dynamically
+	class ConstituentTypeRegistry
+	{
+	private:
+		std::mutex lock;
+		std::unordered_map<std::type_index, uint32_t> ids;
+		/// \brief bits of the registered base classes per id, including their bases
+		std::array<ConstituentMask, MaxConstituentTypes> bases;
+
+		/// \brief id of the type, a new type gets its bases registered as well, call with the lock held
+		uint32_t Register(std::type_index type);
+
+	public:
+		ConstituentTypeRegistry();
+
+		// disable copy
+		ConstituentTypeRegistry(const ConstituentTypeRegistry&) = delete;
+		void operator=(const ConstituentTypeRegistry&) = delete;
+
+		/// \brief aborts when more than MaxConstituentTypes types are registered, their bits wouldn't fit in a mask
+		uint32_t GetId(std::type_index type);
+		/// \brief bit of the type together with the bits of its registered bases
+		ConstituentMask GetMask(std::type_index type);
+	};
+
+	/// \brief dense per process type ids, every Family (e.g.: AbstractConstituent) counts separately
+	template<class Family>
+	class ConstituentTypes
+	{
+	private:
+		static ConstituentTypeRegistry& GetRegistry()
+		{
+			static ConstituentTypeRegistry registry;
+			return registry;
+		}
+
+	public:
+		template<class T>
+		static uint32_t GetId()
+		{
+			static const uint32_t id = GetRegistry().GetId(typeid(T));
+			return id;
+		}
+
+		/// \brief bit of T together with the bits of all its registered base classes
+		template<class T>
+		static ConstituentMask GetMask()
+		{
+			static const ConstituentMask mask = GetRegistry().GetMask(typeid(T));
+			return mask;
+		}
+
+		/// \brief bits of T and of the dynamic type of the object, so it's found by its concrete type when added through a base pointer
+		template<class T>
+		static ConstituentMask GetMask(const T& object)
+		{
+			if constexpr (std::is_polymorphic_v<T>)
+				return GetMask<T>() | GetRegistry().GetMask(typeid(object));
+			else
+				return GetMask<T>();
+		}
+
+		/// \brief id of the dynamic type of the object
+		template<class T>
+		static uint32_t GetId(const T& object)
+		{
+			if constexpr (std::is_polymorphic_v<T>)
+				return GetRegistry().GetId(typeid(object));
+			else
+				return GetId<T>();
+		}
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "./Collider.h"
+#include "./ConstituentTypes.h"
 #include <atomic>
 #include <unordered_set>
 
@@ -100,6 +101,13 @@ namespace Esteem
 
 		void Interpolate(float delta);
 	};
+
+	template<>
+	struct ConstituentBases<KinematicBody>
+	{
+		typedef std::tuple<Collider> Types;
+		static inline const ConstituentBasesRegistrar<KinematicBody, Types> registrar;
+	};
 }
 
 #include "./KinematicBody.inl"
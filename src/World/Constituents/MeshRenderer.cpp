@@ -10,8 +10,46 @@
 
 #include "World/World.h"
 
+#include <cstring>
+
 namespace Esteem
 {
+	namespace
+	{
+		/// \brief copy the positions and indices of every mesh, fails when one isn't on the CPU anymore
+		bool CopyOccluderMeshes(const Model& model, Occluder& occluder)
+		{
+			for (const auto& mesh : model.meshes)
+			{
+				if (!mesh->AvailableOnCPU())
+					return false;
+
+				const cgc::strong_ptr<IMeshData>& meshData = mesh->GetMeshData();
+				mm::array_view vertices = meshData->GetVertexMemInfo();
+				mm::array_view indices = meshData->GetIndexMemInfo();
+				uint32_t firstVertex = uint32_t(occluder.vertices.size());
+
+				const uint8* vertexData = static_cast<const uint8*>(vertices.data());
+				for (std::size_t i = 0; i < vertices.size(); ++i)
+				{
+					glm::vec3 position;
+					std::memcpy(&position, vertexData + i * vertices.type_size() + offsetof(ModelVertexDataA, position), sizeof(position));
+					occluder.vertices.push_back(position);
+				}
+
+				for (std::size_t i = 0; i < indices.size(); ++i)
+				{
+					if (indices.type_size() == sizeof(uint16))
+						occluder.indices.push_back(firstVertex + static_cast<const uint16*>(indices.data())[i]);
+					else
+						occluder.indices.push_back(firstVertex + static_cast<const uint32_t*>(indices.data())[i]);
+				}
+			}
+
+			return true;
+		}
+	}
+
 	cgc::strong_ptr<MeshRenderer> MeshRenderer::Instantiate(const cgc::strong_ptr<Entity>& entity, bool dynamic)
 	{
 		World* worldData = entity->GetWorld();
@@ -26,6 +64,7 @@ namespace Esteem
 
 	MeshRenderer::~MeshRenderer()
 	{
+		SetOccluderModel(nullptr);
 		delete cullingObject;
 	}
 
@@ -77,6 +116,43 @@ namespace Esteem
 			renderObject->SetCastingShadows(enable);
 	}
 
+	void MeshRenderer::SetOccluder(bool enable)
+	{
+		SetOccluderModel(enable ? model : nullptr);
+	}
+
+	void MeshRenderer::SetOccluderModel(const cgc::strong_ptr<const Model>& occluderModel)
+	{
+		if (occluder)
+		{
+			entity->GetWorld()->GetCulling().UnRegisterOccluder(occluder);
+			delete occluder;
+			occluder = nullptr;
+		}
+
+		if (occluderModel == nullptr)
+			return;
+
+		if (cullingObject == nullptr)
+		{
+			Debug::LogError("MeshRenderer::SetOccluderModel() set a model first, the occluder follows its transform and bounds");
+			return;
+		}
+
+		occluder = new Occluder();
+		if (!CopyOccluderMeshes(*occluderModel, *occluder))
+		{
+			Debug::LogWarning("MeshRenderer::SetOccluderModel() the meshes of ", occluderModel->GetPath(), " aren't kept on the CPU, it can't occlude");
+			delete occluder;
+			occluder = nullptr;
+			return;
+		}
+
+		occluder->modelMatrix = &entity->GetMatrix();
+		occluder->bounds = &cullingObject->GetAABB();
+		entity->GetWorld()->GetCulling().RegisterOccluder(occluder);
+	}
+
 	void MeshRenderer::DirtyCleanUp()
 	{
 		if(model != nullptr)
@@ -6,6 +6,7 @@
 #include "Model/Model.h"
 #include "Rendering/Objects/RenderObject.h"
 #include "Culling/Objects/CullingObject.h"
+#include "Culling/Objects/Occluder.h"
 
 namespace Esteem
 {
@@ -14,6 +15,7 @@ namespace Esteem
 	private:
 		cgc::strong_ptr<const Model> model;
 		CullingObject* cullingObject;
+		Occluder* occluder;
 
 		bool enabled : 1;
 		bool dynamic : 1;
@@ -23,6 +25,8 @@ namespace Esteem
 
 		MeshRenderer(const cgc::strong_ptr<Entity>& entity, bool dynamic)
 			: AbstractConstituent(entity)
+			, cullingObject(nullptr)
+			, occluder(nullptr)
 			, dynamic(dynamic)
 		{
 			Initialize();
@@ -39,6 +43,12 @@ namespace Esteem
 
 		void SetCastingShadows(bool enable);
 
+		/// \brief hide what's behind this mesh with its own triangles, needs the model's meshes to be kept on the CPU
+		void SetOccluder(bool enable);
+		/// \brief hide what's behind a simpler stand-in that fits inside the mesh, nullptr to stop occluding
+		void SetOccluderModel(const cgc::strong_ptr<const Model>& occluderModel);
+		bool IsOccluder() const { return occluder != nullptr; }
+
 		void Initialize();
 
 		void DirtyCleanUp();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "./Collider.h"
+#include "./ConstituentTypes.h"
 
 #include <BulletDynamics/Dynamics/btRigidBody.h>
 
@@ -49,6 +50,13 @@ namespace Esteem
 		void SetSize(const Vector3& size);
 		void SetOffset(const Vector3& offset);
 	};
+
+	template<>
+	struct ConstituentBases<RigidBody>
+	{
+		typedef std::tuple<Collider> Types;
+		static inline const ConstituentBasesRegistrar<RigidBody, Types> registrar;
+	};
 }
 
 #include "./RigidBody.inl"
\ No newline at end of file
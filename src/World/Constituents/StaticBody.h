@@ -1,6 +1,7 @@
 #pragma once
 
 #include "./Collider.h"
+#include "./ConstituentTypes.h"
 
 #include "General/Vector3.h"
 #include "Model/Model.h"
@@ -49,6 +50,13 @@ namespace Esteem
 		void SetFilterGroup(uint32_t filterGroup);
 		void SetFilterMask(uint32_t filterMask);
 	};
+
+	template<>
+	struct ConstituentBases<StaticBody>
+	{
+		typedef std::tuple<Collider> Types;
+		static inline const ConstituentBasesRegistrar<StaticBody, Types> registrar;
+	};
 }
 
 #include "./StaticBody.inl"
\ No newline at end of file
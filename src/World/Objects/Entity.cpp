@@ -10,6 +10,8 @@ namespace Esteem
 	Entity::Entity(World* world)
 		: Transform(world)
 		, components()
+		, threadSafeUpdate(false)
+		, serialComponents(0)
 	{
 		
 	}
@@ -17,7 +19,8 @@ namespace Esteem
 	Entity::~Entity()
 	{
 		components.clear();
-		constituents.clear();
+		componentTable.Clear();
+		constituents.Clear();
 
 		GetWorld()->RemoveWorldObject(this);
 	}
@@ -42,22 +45,14 @@ namespace Esteem
 			component->DirtyCleanUp();
 	}	
 
-	void Entity::AddComponent(const cgc::strong_ptr<Entity>& entity, const cgc::strong_ptr<AbstractComponent>& component)
+	void Entity::RemoveComponent(const cgc::strong_ptr<AbstractComponent>& component)
 	{
-		if (entity && component)
+		auto found = std::find(components.begin(), components.end(), component);
+		if (found != components.end())
 		{
-			auto& components = entity->components;
-			if (std::find(components.begin(), components.end(), component) == components.end())
-			{
-				components.push_back(component);
-				component->entity = entity;
-				component->Initialize();
-			}
+			components.erase(found);
+			componentTable.Remove(component);
+			serialComponents -= !component->IsThreadSafeUpdate();
 		}
 	}
-
-	void Entity::RemoveComponent(const cgc::strong_ptr<AbstractComponent>& component)
-	{
-		(void)std::remove(components.begin(), components.end(), component);
-	}
 }
\ No newline at end of file
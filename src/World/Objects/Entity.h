@@ -11,6 +11,7 @@
 #include <memory>
 
 #include "World/Objects/Transform.h"
+#include "World/Constituents/ConstituentTable.h"
 
 #include <cppu/cgc/pointers.h>
 
@@ -26,10 +27,16 @@ namespace Esteem
 		friend class cgc::constructor;
 
 	private:
-		std::unordered_map<size_t, cgc::strong_ptr<AbstractConstituent>> constituents;
+		ConstituentTable<AbstractConstituent> constituents;
 
+		/// \brief components in order of addition, used for the update calls
 		std::vector<cgc::strong_ptr<AbstractComponent>> components;
-		//std::map<int, AbstractComponent> components;
+		/// \brief typed lookup for the components
+		ConstituentTable<AbstractComponent> componentTable;
+
+		bool threadSafeUpdate;
+		/// \brief components of which IsThreadSafeUpdate() returned false when they were added
+		uint serialComponents;
 
 		Entity(World* world);
 
@@ -42,19 +49,32 @@ namespace Esteem
 
 		virtual void DirtyCleanUp();
 
+		/// \brief true when all components are thread safe, or when SetThreadSafeUpdate(true) was called
+		virtual bool IsThreadSafeUpdate() const;
+		/// \brief mark this entity's components safe to update in parallel with other entities, even when they don't say so themselves
+		void SetThreadSafeUpdate(bool threadSafe);
+
 		template<class T>
 		cgc::strong_ptr<T> GetSystemComponent() const;
 
+		template<class T>
+		bool HasSystemComponent() const;
+
 		template <typename T>
 		void AddSystemComponent(const cgc::strong_ptr<T>& constituent);
 
 		template <typename T>
 		void RemoveSystemComponent();
 
+		/// \brief get the component of type T, or of a type that registered T as base through ConstituentBases
 		template<class T>
 		cgc::strong_ptr<T> GetComponent() const;
 
-		static void AddComponent(const cgc::strong_ptr<Entity>& entity, const cgc::strong_ptr<AbstractComponent>& component);
+		template<class T>
+		bool HasComponent() const;
+
+		template<class T>
+		static void AddComponent(const cgc::strong_ptr<Entity>& entity, const cgc::strong_ptr<T>& component);
 		void RemoveComponent(const cgc::strong_ptr<AbstractComponent>& component);
 
 		operator std::string() { return "Entity()"; }
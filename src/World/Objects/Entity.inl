@@ -1,39 +1,73 @@
 #pragma once
 
 #include "Entity.h"
+#include "World/Constituents/AbstractComponent.h"
 
 namespace Esteem
 {
+	inline bool Entity::IsThreadSafeUpdate() const
+	{
+		return threadSafeUpdate || serialComponents == 0;
+	}
+
+	inline void Entity::SetThreadSafeUpdate(bool threadSafe)
+	{
+		threadSafeUpdate = threadSafe;
+	}
+
 	template<class T>
 	inline cgc::strong_ptr<T> Entity::GetSystemComponent() const
 	{
-		auto found = constituents.find(typeid(T).hash_code());
-		return found != constituents.end() ? cgc::static_pointer_cast<T>(found->second) : nullptr;
+		return constituents.Get<T>();
+	}
+
+	template<class T>
+	inline bool Entity::HasSystemComponent() const
+	{
+		return constituents.Has<T>();
 	}
 
 	template <typename T>	
 	inline void Entity::AddSystemComponent(const cgc::strong_ptr<T>& constituent)
 	{
-		if (constituent)
-			constituents.try_emplace(typeid(T).hash_code(), constituent);
+		constituents.Add(constituent);
 	}
 
 	template <typename T>
 	inline void Entity::RemoveSystemComponent()
 	{
-		constituents.erase(typeid(T).hash_code());
+		constituents.Remove<T>();
 	}
 
 	template<class T>
 	inline cgc::strong_ptr<T> Entity::GetComponent() const
 	{
-		for (std::size_t i = 0; i < components.size(); ++i)
+		return componentTable.Get<T>();
+	}
+
+	template<class T>
+	inline bool Entity::HasComponent() const
+	{
+		return componentTable.Has<T>();
+	}
+
+	template<class T>
+	inline void Entity::AddComponent(const cgc::strong_ptr<Entity>& entity, const cgc::strong_ptr<T>& component)
+	{
+		static_assert(std::is_base_of_v<AbstractComponent, T>, "T must derive from AbstractComponent");
+
+		if (entity && component)
 		{
-			cgc::strong_ptr<T> component = cgc::dynamic_pointer_cast<T, AbstractComponent>(components[i]);
-			if (component && typeid(T*) == typeid(component.ptr()))
-				return component;
+			auto& components = entity->components;
+			if (std::find(components.begin(), components.end(), component) == components.end())
+			{
+				// a second component of the same type is updated, but not found by GetComponent
+				entity->componentTable.Add(component);
+				components.push_back(component);
+				entity->serialComponents += !component->IsThreadSafeUpdate();
+				component->entity = entity;
+				component->Initialize();
+			}
 		}
-
-		return nullptr;
 	}
 }
\ No newline at end of file
@@ -16,5 +16,9 @@ namespace Esteem
 		virtual World* GetWorld() = 0;
 
 		virtual void DirtyCleanUp() {};
+
+		/// \brief opt-in, if true Update() and LateUpdate() may run in parallel with other objects
+		/// Objects that touch shared state should keep this false, they will be updated serially after the parallel pass.
+		virtual bool IsThreadSafeUpdate() const { return false; }
 	};
 }
\ No newline at end of file
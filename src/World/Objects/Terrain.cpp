@@ -2,6 +2,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Window/View.h"
+#include "Utils/Data.h"
 #include "Rendering/Renderers/OpenGL/Objects/OpenGLMaterial.h"
 #include "World/World.h"
 
@@ -47,6 +48,9 @@ namespace Esteem
 
 	void Terrain::Initialize(uint outerSize, uint innerSize, uint minQuadSize, uint maxQuadSize, uint startSecondLaneDistance, uint increaseLaneDistance)
 	{
+		// read while the lanes are generated
+		AssetHandle heightMapRead = Data::ReadAssetAsync(RESOURCES_PATH + TEXTURES_PATH + "TERRAIN/heightmap1.tga", AssetPriority::CRITICAL);
+
 		RenderingFactory* renderingFactory = RenderingFactory::Instance();
 		terrainMaterial = renderingFactory->LoadMaterial("TERRAIN/terrain");
 
@@ -127,7 +131,8 @@ namespace Esteem
 		long bytesPerElement = gridSize * gridSize;
 
 		sf::Image img;
-		if (img.loadFromFile("./resources/textures/TERRAIN/heightmap1.tga"))
+		const std::string& heightMap = heightMapRead.Wait();
+		if (!heightMap.empty() && img.loadFromMemory(heightMap.data(), heightMap.size()))
 		{
 			terrainData = new float[bytesPerElement];
 			assert(terrainData && "out of memory");
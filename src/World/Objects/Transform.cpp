@@ -7,15 +7,16 @@
 namespace Esteem
 {
 	Transform::Transform(World* world)
-		: world(world)
-		, position(0.f)
-		, rotation(1, 0, 0, 0)
-		, scale(1.f)
-		, localPosition(0.f)
-		, localRotation(1, 0, 0, 0)
-		, localScale(1.f)
+		: Transform(world, world->GetTransformHierarchy())
+	{
+
+	}
+
+	Transform::Transform(World* world, TransformHierarchy& hierarchy)
+		: hierarchy(&hierarchy)
+		, id(hierarchy.Create())
 		, directions(1.f)
-		, matrix(1.f)
+		, world(world)
 		, dirty(false)
 	{
 
@@ -24,6 +25,7 @@ namespace Esteem
 	Transform::~Transform()
 	{
 		//world->GetData()->RemoveDirty(this);
+		hierarchy->Release(id);
 	}
 
 	void Transform::AddChild(const cgc::strong_ptr<Transform>& parent, const cgc::strong_ptr<Transform>& child)
@@ -36,9 +38,15 @@ namespace Esteem
 			childs.push_back(child);
 			child->parent = parent;
 
-			child->localPosition = child->position - parent->position;
-			child->localRotation = glm::inverse(parent->rotation) * child->rotation;
-			child->localScale = child->scale / parent->scale;
+			// keep the world transform, the hierarchy derives the local one from it
+			Vector3 position = child->GetPosition();
+			Quaternion rotation = child->GetRotation();
+			Vector3 scale = child->GetScale();
+
+			child->hierarchy->SetParent(child->id, parent->id);
+			child->SetPosition(position);
+			child->SetRotation(rotation);
+			child->SetScale(scale);
 		}
 	}
 
@@ -49,20 +57,23 @@ namespace Esteem
 		{
 			childs.erase(found);
 			child->parent = cgc::weak_ptr<Transform>();
+
+			Vector3 position = child->GetPosition();
+			Quaternion rotation = child->GetRotation();
+			Vector3 scale = child->GetScale();
+
+			child->hierarchy->SetParent(child->id, InvalidTransformId);
+			child->SetPosition(position);
+			child->SetRotation(rotation);
+			child->SetScale(scale);
 		}
 	}
 
 	void Transform::DirtyCleanUp()
 	{
+		// the world values of the childs are already recalculated by TransformHierarchy::DirtyCleanUp(), let them know
 		for (uint c = 0; c < childs.size(); ++c)
-		{
-			Transform* child = childs[c].ptr();
-			child->scale = scale * child->localScale;
-			child->position = position + (rotation * (scale * child->localPosition));
-			child->rotation = rotation * child->localRotation;
-
-			child->DirtyCleanUp();
-		}
+			childs[c]->DirtyCleanUp();
 
 		dirty = false;
 	}
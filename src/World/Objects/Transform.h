@@ -7,24 +7,20 @@
 #include "General/Vector3.h"
 #include "General/Quaternion.h"
 #include "./IWorldObject.h"
+#include "./TransformHierarchy.h"
 
 #include <cppu/cgc/pointers.h>
 
 namespace Esteem
 {
+	/// \brief handle into the TransformHierarchy of its world, which holds the values and recalculates them once per frame
 	class Transform : public IWorldObject
 	{
 	private:
-		Vector3 position;
-		Vector3 scale;
-		Quaternion rotation;
-
-		Vector3 localPosition;
-		Vector3 localScale;
-		Quaternion localRotation;
+		TransformHierarchy* hierarchy;
+		TransformId id;
 
 		glm::mat3 directions;
-		glm::mat4 matrix;
 
 		cgc::weak_ptr<Transform> parent;
 		std::vector<cgc::strong_ptr<Transform>> childs;
@@ -37,6 +33,8 @@ namespace Esteem
 		
 	public:
 		Transform(World* world);
+		/// \brief transform in a hierarchy of its own choosing, world may be nullptr for tools and benchmarks
+		Transform(World* world, TransformHierarchy& hierarchy);
 		virtual ~Transform();
 
 		const cgc::strong_ptr<Transform> GetParent();
@@ -45,18 +43,18 @@ namespace Esteem
 		static void AddChild(const cgc::strong_ptr<Transform>& parent, const cgc::strong_ptr<Transform>& child);
 		void RemoveChild(const cgc::strong_ptr<Transform>& transform);
 
-		const Vector3& GetPosition() const;
+		Vector3 GetPosition() const;
 		void SetPosition(const Vector3& position);
-		const Quaternion& GetRotation() const;
+		Quaternion GetRotation() const;
 		void SetRotation(const Quaternion& rotation);
-		const Vector3& GetScale() const;
+		Vector3 GetScale() const;
 		void SetScale(const Vector3& scale);
 
-		const Vector3& GetLocalPosition() const;
+		Vector3 GetLocalPosition() const;
 		void SetLocalPosition(const Vector3& position);
-		const Quaternion& GetLocalRotation() const;
+		Quaternion GetLocalRotation() const;
 		void SetLocalRotation(const Quaternion& rotation);
-		const Vector3& GetLocalScale() const;
+		Vector3 GetLocalScale() const;
 		void SetLocalScale(const Vector3& scale);
 
 		const glm::mat3& GetDirections() const;
@@ -69,9 +67,9 @@ namespace Esteem
 		const Vector3& GetUp() const;
 		void SetUp(const Vector3& up);
 		
-		/// \brief get pointer to matrix
+		/// \brief get pointer to matrix, stays valid for the lifetime of the transform
 		const glm::mat4& GetMatrix();
-		/// \brief overwrite values of transform's matrix
+		/// \brief overwrite values of transform's matrix, until the transform moves again
 		void SetMatrix(const glm::mat4& matrix);
 		/// \brief Calculates new matrix from RST
 		void UpdateMatrix();
@@ -21,64 +21,64 @@ namespace Esteem
 		return childs;
 	}
 	
-	inline const Vector3& Transform::GetPosition() const
+	inline Vector3 Transform::GetPosition() const
 	{
-		return position;
+		return hierarchy->GetPosition(id);
 	}
 	
 	inline void Transform::SetPosition(const Vector3& position)
 	{
-		this->position = position;
+		hierarchy->SetPosition(id, position);
 	}
 
-	inline const Quaternion& Transform::GetRotation() const
+	inline Quaternion Transform::GetRotation() const
 	{
-		return rotation;
+		return hierarchy->GetRotation(id);
 	}
 	
 	inline void Transform::SetRotation(const Quaternion& rotation)
 	{
-		this->rotation = rotation;
+		hierarchy->SetRotation(id, rotation);
 	}
 
-	inline const Vector3& Transform::GetScale() const
+	inline Vector3 Transform::GetScale() const
 	{
-		return scale;
+		return hierarchy->GetScale(id);
 	}
 
 	inline void Transform::SetScale(const Vector3& scale)
 	{
-		this->scale = scale;
+		hierarchy->SetScale(id, scale);
 	}
 
-	inline const Vector3& Transform::GetLocalPosition() const
+	inline Vector3 Transform::GetLocalPosition() const
 	{
-		return localPosition;
+		return hierarchy->GetLocalPosition(id);
 	}
 
 	inline void Transform::SetLocalPosition(const Vector3& position)
 	{
-		this->localPosition = position;
+		hierarchy->SetLocalPosition(id, position);
 	}
 
-	inline const Quaternion& Transform::GetLocalRotation() const
+	inline Quaternion Transform::GetLocalRotation() const
 	{
-		return localRotation;
+		return hierarchy->GetLocalRotation(id);
 	}
 
 	inline void Transform::SetLocalRotation(const Quaternion& rotation)
 	{
-		this->localRotation = rotation;
+		hierarchy->SetLocalRotation(id, rotation);
 	}
 
-	inline const Vector3& Transform::GetLocalScale() const
+	inline Vector3 Transform::GetLocalScale() const
 	{
-		return localScale;
+		return hierarchy->GetLocalScale(id);
 	}
 
 	inline void Transform::SetLocalScale(const Vector3& scale)
 	{
-		this->localScale = scale;
+		hierarchy->SetLocalScale(id, scale);
 	}
 
 	inline const glm::mat3& Transform::GetDirections() const
@@ -123,18 +123,18 @@ namespace Esteem
 
 	inline const glm::mat4& Transform::GetMatrix()
 	{
-		return matrix;
+		return hierarchy->GetMatrix(id);
 	}
 
 	inline void Transform::SetMatrix(const glm::mat4& matrix)
 	{
-		this->matrix = matrix;
+		hierarchy->SetMatrix(id, matrix);
 	}
 
 	inline void Transform::UpdateMatrix()
 	{
-		this->directions = Matrix3x3(rotation);
-		this->matrix = Matrix4x4(this->directions, scale, position);
+		this->directions = Matrix3x3(GetRotation());
+		hierarchy->UpdateMatrix(id);
 	}
 
 	inline World* Transform::GetWorld()
@@ -0,0 +1,542 @@
+#include "TransformHierarchy.h"
+
+#include <cassert>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Math/SimdFloats.h"
+
+namespace Esteem
+{
+	namespace
+	{
+		template<class T, class C>
+		inline void Permute(std::vector<T>& values, const C& order)
+		{
+			std::vector<T> sorted(values.size());
+			for (std::size_t i = 0; i < order.size(); ++i)
+				sorted[i] = values[order[i]];
+
+			values.swap(sorted);
+		}
+	}
+
+	TransformHierarchy::TransformHierarchy()
+		: orderDirty(false)
+	{ }
+
+	TransformId TransformHierarchy::Create(TransformId parent)
+	{
+		TransformId id;
+		if (!freeIds.empty())
+		{
+			id = freeIds.back();
+			freeIds.pop_back();
+			matrices[id] = glm::mat4(1.f);
+		}
+		else
+		{
+			id = TransformId(indices.size());
+			indices.push_back(0);
+			firstChilds.push_back(InvalidTransformId);
+			nextSiblings.push_back(InvalidTransformId);
+			previousSiblings.push_back(InvalidTransformId);
+			matrices.emplace_back(1.f);
+		}
+
+		indices[id] = uint32_t(AddNode(id, parent != InvalidTransformId ? int32_t(indices[parent]) : -1));
+		Link(id, parent);
+
+		return id;
+	}
+
+	void TransformHierarchy::Link(TransformId id, TransformId parent)
+	{
+		if (parent == InvalidTransformId)
+			return;
+
+		TransformId next = firstChilds[parent];
+		if (next != InvalidTransformId)
+			previousSiblings[next] = id;
+
+		nextSiblings[id] = next;
+		previousSiblings[id] = InvalidTransformId;
+		firstChilds[parent] = id;
+	}
+
+	void TransformHierarchy::Unlink(TransformId id)
+	{
+		TransformId parent = GetParent(id);
+		if (parent == InvalidTransformId)
+			return;
+
+		TransformId previous = previousSiblings[id];
+		TransformId next = nextSiblings[id];
+		if (next != InvalidTransformId)
+			previousSiblings[next] = previous;
+
+		if (previous != InvalidTransformId)
+			nextSiblings[previous] = next;
+		else
+			firstChilds[parent] = next;
+
+		nextSiblings[id] = InvalidTransformId;
+		previousSiblings[id] = InvalidTransformId;
+	}
+
+	std::size_t TransformHierarchy::AddNode(TransformId id, int32_t parent)
+	{
+		std::size_t index = ids.size();
+
+		ids.push_back(id);
+		parents.push_back(parent);
+		depths.push_back(parent >= 0 ? depths[parent] + 1 : 0);
+		dirty.push_back(1);
+
+		for (std::size_t c = 0; c < 3; ++c)
+		{
+			localPositions[c].push_back(0.f);
+			localScales[c].push_back(1.f);
+			worldPositions[c].push_back(0.f);
+			worldScales[c].push_back(1.f);
+		}
+
+		for (std::size_t c = 0; c < 4; ++c)
+		{
+			localRotations[c].push_back(c == 3 ? 1.f : 0.f);
+			worldRotations[c].push_back(c == 3 ? 1.f : 0.f);
+		}
+
+		orderDirty = true;
+		return index;
+	}
+
+	void TransformHierarchy::Destroy(TransformId id)
+	{
+		std::size_t index = indices[id];
+		Unlink(id);
+
+		// childs become roots, their local transform becomes their last known world transform
+		for (TransformId child = firstChilds[id]; child != InvalidTransformId;)
+		{
+			TransformId next = nextSiblings[child];
+			nextSiblings[child] = InvalidTransformId;
+			previousSiblings[child] = InvalidTransformId;
+
+			std::size_t i = indices[child];
+			parents[i] = -1;
+			for (std::size_t c = 0; c < 3; ++c)
+			{
+				localPositions[c][i] = worldPositions[c][i];
+				localScales[c][i] = worldScales[c][i];
+			}
+
+			for (std::size_t c = 0; c < 4; ++c)
+				localRotations[c][i] = worldRotations[c][i];
+
+			dirty[i] = 1;
+			child = next;
+		}
+
+		firstChilds[id] = InvalidTransformId;
+		SwapRemoveNode(index);
+
+		indices[id] = ~0u;
+		freeIds.push_back(id);
+	}
+
+	void TransformHierarchy::Release(TransformId id)
+	{
+		std::lock_guard<std::mutex> guard(releaseLock);
+		released.push_back(id);
+	}
+
+	void TransformHierarchy::DestroyReleased()
+	{
+		std::vector<TransformId> destroy;
+		{
+			std::lock_guard<std::mutex> guard(releaseLock);
+			destroy.swap(released);
+		}
+
+		for (TransformId id : destroy)
+			Destroy(id);
+	}
+
+	void TransformHierarchy::SwapRemoveNode(std::size_t index)
+	{
+		std::size_t last = ids.size() - 1;
+		if (index != last)
+		{
+			ids[index] = ids[last];
+			parents[index] = parents[last];
+			depths[index] = depths[last];
+			dirty[index] = dirty[last];
+
+			for (std::size_t c = 0; c < 3; ++c)
+			{
+				localPositions[c][index] = localPositions[c][last];
+				localScales[c][index] = localScales[c][last];
+				worldPositions[c][index] = worldPositions[c][last];
+				worldScales[c][index] = worldScales[c][last];
+			}
+
+			for (std::size_t c = 0; c < 4; ++c)
+			{
+				localRotations[c][index] = localRotations[c][last];
+				worldRotations[c][index] = worldRotations[c][last];
+			}
+
+			indices[ids[index]] = uint32_t(index);
+
+			for (TransformId child = firstChilds[ids[index]]; child != InvalidTransformId; child = nextSiblings[child])
+				parents[indices[child]] = int32_t(index);
+		}
+
+		ids.pop_back();
+		parents.pop_back();
+		depths.pop_back();
+		dirty.pop_back();
+
+		for (std::size_t c = 0; c < 3; ++c)
+		{
+			localPositions[c].pop_back();
+			localScales[c].pop_back();
+			worldPositions[c].pop_back();
+			worldScales[c].pop_back();
+		}
+
+		for (std::size_t c = 0; c < 4; ++c)
+		{
+			localRotations[c].pop_back();
+			worldRotations[c].pop_back();
+		}
+
+		orderDirty = true;
+	}
+
+	void TransformHierarchy::SetParent(TransformId id, TransformId parent)
+	{
+		int32_t index = int32_t(indices[id]);
+		int32_t parentIndex = parent != InvalidTransformId ? int32_t(indices[parent]) : -1;
+
+		// prevent cycles, the new parent may not be one of our descendants
+		for (int32_t p = parentIndex; p >= 0; p = parents[p])
+		{
+			if (p == index)
+			{
+				assert(false);
+				return;
+			}
+		}
+
+		Unlink(id);
+		parents[index] = parentIndex;
+		Link(id, parent);
+
+		dirty[index] = 1;
+		orderDirty = true;
+	}
+
+	void TransformHierarchy::SetPosition(TransformId id, const Vector3& position)
+	{
+		std::size_t i = indices[id];
+		worldPositions[0][i] = position.x; worldPositions[1][i] = position.y; worldPositions[2][i] = position.z;
+
+		glm::vec3 local = position;
+		int32_t p = parents[i];
+		if (p >= 0)
+		{
+			glm::quat parentRotation(worldRotations[3][p], worldRotations[0][p], worldRotations[1][p], worldRotations[2][p]);
+			glm::vec3 parentPosition(worldPositions[0][p], worldPositions[1][p], worldPositions[2][p]);
+			glm::vec3 parentScale(worldScales[0][p], worldScales[1][p], worldScales[2][p]);
+
+			local = (glm::inverse(parentRotation) * (local - parentPosition)) / parentScale;
+		}
+
+		localPositions[0][i] = local.x; localPositions[1][i] = local.y; localPositions[2][i] = local.z;
+		dirty[i] = 1;
+	}
+
+	void TransformHierarchy::SetRotation(TransformId id, const Quaternion& rotation)
+	{
+		std::size_t i = indices[id];
+		worldRotations[0][i] = rotation.x; worldRotations[1][i] = rotation.y; worldRotations[2][i] = rotation.z; worldRotations[3][i] = rotation.w;
+
+		glm::quat local = rotation;
+		int32_t p = parents[i];
+		if (p >= 0)
+			local = glm::inverse(glm::quat(worldRotations[3][p], worldRotations[0][p], worldRotations[1][p], worldRotations[2][p])) * local;
+
+		localRotations[0][i] = local.x; localRotations[1][i] = local.y; localRotations[2][i] = local.z; localRotations[3][i] = local.w;
+		dirty[i] = 1;
+	}
+
+	void TransformHierarchy::SetScale(TransformId id, const Vector3& scale)
+	{
+		std::size_t i = indices[id];
+		worldScales[0][i] = scale.x; worldScales[1][i] = scale.y; worldScales[2][i] = scale.z;
+
+		glm::vec3 local = scale;
+		int32_t p = parents[i];
+		if (p >= 0)
+			local /= glm::vec3(worldScales[0][p], worldScales[1][p], worldScales[2][p]);
+
+		localScales[0][i] = local.x; localScales[1][i] = local.y; localScales[2][i] = local.z;
+		dirty[i] = 1;
+	}
+
+	void TransformHierarchy::SortByDepth()
+	{
+		std::size_t count = ids.size();
+		constexpr uint32_t unknown = ~0u;
+
+		// recalculate depths, parents are not guaranteed to come first after a SetParent
+		std::fill(depths.begin(), depths.end(), unknown);
+		uint32_t maxDepth = 0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			uint32_t depth = 0;
+			int32_t p = int32_t(i);
+			while (p >= 0 && depths[p] == unknown)
+			{
+				p = parents[p];
+				++depth;
+			}
+
+			depth += p >= 0 ? depths[p] + 1 : 0;
+			for (p = int32_t(i); p >= 0 && depths[p] == unknown; p = parents[p])
+				depths[p] = --depth;
+
+			maxDepth = std::max(maxDepth, depths[i]);
+		}
+
+		// stable counting sort on depth
+		levels.assign(std::size_t(maxDepth) + 2, 0);
+		for (std::size_t i = 0; i < count; ++i)
+			++levels[depths[i] + 1];
+
+		for (std::size_t l = 1; l < levels.size(); ++l)
+			levels[l] += levels[l - 1];
+
+		std::vector<std::size_t> order(count);
+		std::vector<std::size_t> offsets(levels.begin(), levels.end() - 1);
+		for (std::size_t i = 0; i < count; ++i)
+			order[offsets[depths[i]]++] = i;
+
+		std::vector<int32_t> newIndices(count);
+		for (std::size_t i = 0; i < count; ++i)
+			newIndices[order[i]] = int32_t(i);
+
+		for (int32_t& parent : parents)
+		{
+			if (parent >= 0)
+				parent = newIndices[parent];
+		}
+
+		Permute(ids, order);
+		Permute(parents, order);
+		Permute(depths, order);
+		Permute(dirty, order);
+
+		for (std::size_t c = 0; c < 3; ++c)
+		{
+			Permute(localPositions[c], order);
+			Permute(localScales[c], order);
+			Permute(worldPositions[c], order);
+			Permute(worldScales[c], order);
+		}
+
+		for (std::size_t c = 0; c < 4; ++c)
+		{
+			Permute(localRotations[c], order);
+			Permute(worldRotations[c], order);
+		}
+
+		for (std::size_t i = 0; i < count; ++i)
+			indices[ids[i]] = uint32_t(i);
+
+		orderDirty = false;
+	}
+
+	template<class V>
+	inline void TransformHierarchy::UpdateRoots(std::size_t i)
+	{
+		for (std::size_t c = 0; c < 3; ++c)
+		{
+			V::Load(&localPositions[c][i]).Store(&worldPositions[c][i]);
+			V::Load(&localScales[c][i]).Store(&worldScales[c][i]);
+		}
+
+		for (std::size_t c = 0; c < 4; ++c)
+			V::Load(&localRotations[c][i]).Store(&worldRotations[c][i]);
+	}
+
+	template<class V>
+	inline void TransformHierarchy::UpdateChilds(std::size_t i)
+	{
+		const int32_t* p = &parents[i];
+
+		// parent's world transform
+		V px = V::Gather(worldPositions[0].data(), p), py = V::Gather(worldPositions[1].data(), p), pz = V::Gather(worldPositions[2].data(), p);
+		V qx = V::Gather(worldRotations[0].data(), p), qy = V::Gather(worldRotations[1].data(), p), qz = V::Gather(worldRotations[2].data(), p), qw = V::Gather(worldRotations[3].data(), p);
+		V sx = V::Gather(worldScales[0].data(), p), sy = V::Gather(worldScales[1].data(), p), sz = V::Gather(worldScales[2].data(), p);
+
+		// local transform
+		V lqx = V::Load(&localRotations[0][i]), lqy = V::Load(&localRotations[1][i]), lqz = V::Load(&localRotations[2][i]), lqw = V::Load(&localRotations[3][i]);
+
+		// scale = parent.scale * local.scale
+		(sx * V::Load(&localScales[0][i])).Store(&worldScales[0][i]);
+		(sy * V::Load(&localScales[1][i])).Store(&worldScales[1][i]);
+		(sz * V::Load(&localScales[2][i])).Store(&worldScales[2][i]);
+
+		// position = parent.position + parent.rotation * (parent.scale * local.position), same operation order as glm
+		V vx = sx * V::Load(&localPositions[0][i]);
+		V vy = sy * V::Load(&localPositions[1][i]);
+		V vz = sz * V::Load(&localPositions[2][i]);
+
+		V uvx = qy * vz - vy * qz;
+		V uvy = qz * vx - vz * qx;
+		V uvz = qx * vy - vx * qy;
+
+		V uuvx = qy * uvz - uvy * qz;
+		V uuvy = qz * uvx - uvz * qx;
+		V uuvz = qx * uvy - uvx * qy;
+
+		V two = V::Set1(2.f);
+		(px + (vx + ((uvx * qw) + uuvx) * two)).Store(&worldPositions[0][i]);
+		(py + (vy + ((uvy * qw) + uuvy) * two)).Store(&worldPositions[1][i]);
+		(pz + (vz + ((uvz * qw) + uuvz) * two)).Store(&worldPositions[2][i]);
+
+		// rotation = parent.rotation * local.rotation
+		(qw * lqw - qx * lqx - qy * lqy - qz * lqz).Store(&worldRotations[3][i]);
+		(qw * lqx + qx * lqw + qy * lqz - qz * lqy).Store(&worldRotations[0][i]);
+		(qw * lqy + qy * lqw + qz * lqx - qx * lqz).Store(&worldRotations[1][i]);
+		(qw * lqz + qz * lqw + qx * lqy - qy * lqx).Store(&worldRotations[2][i]);
+	}
+
+	template<class V>
+	inline void TransformHierarchy::UpdateMatrices(std::size_t i)
+	{
+		V x = V::Load(&worldRotations[0][i]), y = V::Load(&worldRotations[1][i]), z = V::Load(&worldRotations[2][i]), w = V::Load(&worldRotations[3][i]);
+		V sx = V::Load(&worldScales[0][i]), sy = V::Load(&worldScales[1][i]), sz = V::Load(&worldScales[2][i]);
+
+		V one = V::Set1(1.f), two = V::Set1(2.f);
+		V xx = x * x, yy = y * y, zz = z * z;
+		V xz = x * z, xy = x * y, yz = y * z;
+		V wx = w * x, wy = w * y, wz = w * z;
+
+		// same as Matrix4x4(Matrix3x3(rotation), scale, position)
+		float m[12][V::Width];
+		(sx * (one - two * (yy + zz))).Store(m[0]);
+		(sx * (two * (xy + wz))).Store(m[1]);
+		(sx * (two * (xz - wy))).Store(m[2]);
+
+		(sy * (two * (xy - wz))).Store(m[3]);
+		(sy * (one - two * (xx + zz))).Store(m[4]);
+		(sy * (two * (yz + wx))).Store(m[5]);
+
+		(sz * (two * (xz + wy))).Store(m[6]);
+		(sz * (two * (yz - wx))).Store(m[7]);
+		(sz * (one - two * (xx + yy))).Store(m[8]);
+
+		V::Load(&worldPositions[0][i]).Store(m[9]);
+		V::Load(&worldPositions[1][i]).Store(m[10]);
+		V::Load(&worldPositions[2][i]).Store(m[11]);
+
+		for (std::size_t l = 0; l < V::Width; ++l)
+		{
+			glm::mat4& matrix = matrices[ids[i + l]];
+			for (std::size_t c = 0; c < 4; ++c)
+			{
+				matrix[int(c)][0] = m[c * 3 + 0][l];
+				matrix[int(c)][1] = m[c * 3 + 1][l];
+				matrix[int(c)][2] = m[c * 3 + 2][l];
+				matrix[int(c)][3] = c == 3 ? 1.f : 0.f;
+			}
+		}
+	}
+
+	template<class V>
+	void TransformHierarchy::UpdateLevel(std::size_t begin, std::size_t end, bool roots)
+	{
+		std::size_t i = begin;
+		for (; i + V::Width <= end; i += V::Width)
+		{
+			bool anyDirty = false;
+			for (std::size_t l = 0; l < V::Width; ++l)
+				anyDirty |= dirty[i + l] != 0;
+
+			// clean nodes are recalculated along, the result is identical because every width does the same operations
+			if (anyDirty)
+			{
+				if (roots)
+					UpdateRoots<V>(i);
+				else
+					UpdateChilds<V>(i);
+
+				UpdateMatrices<V>(i);
+			}
+		}
+
+		for (; i < end; ++i)
+		{
+			if (dirty[i])
+			{
+				if (roots)
+					UpdateRoots<Math::ScalarFloats>(i);
+				else
+					UpdateChilds<Math::ScalarFloats>(i);
+
+				UpdateMatrices<Math::ScalarFloats>(i);
+			}
+		}
+	}
+
+	void TransformHierarchy::UpdateMatrix(TransformId id)
+	{
+		UpdateMatrices<Math::ScalarFloats>(indices[id]);
+	}
+
+	void TransformHierarchy::DirtyCleanUp()
+	{
+		DestroyReleased();
+
+		if (orderDirty)
+			SortByDepth();
+
+		for (std::size_t l = 0; l + 1 < levels.size(); ++l)
+		{
+			// a dirty parent makes all of its childs dirty
+			if (l > 0)
+			{
+				for (std::size_t i = levels[l]; i < levels[l + 1]; ++i)
+					dirty[i] |= dirty[parents[i]];
+			}
+
+			UpdateLevel<Math::WideFloats>(levels[l], levels[l + 1], l == 0);
+		}
+
+		std::fill(dirty.begin(), dirty.end(), uint8_t(0));
+	}
+
+	void TransformHierarchy::DirtyCleanUpScalar()
+	{
+		DestroyReleased();
+
+		if (orderDirty)
+			SortByDepth();
+
+		for (std::size_t l = 0; l + 1 < levels.size(); ++l)
+		{
+			if (l > 0)
+			{
+				for (std::size_t i = levels[l]; i < levels[l + 1]; ++i)
+					dirty[i] |= dirty[parents[i]];
+			}
+
+			UpdateLevel<Math::ScalarFloats>(levels[l], levels[l + 1], l == 0);
+		}
+
+		std::fill(dirty.begin(), dirty.end(), uint8_t(0));
+	}
+}
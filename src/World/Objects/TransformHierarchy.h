@@ -0,0 +1,134 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "General/Vector3.h"
+#include "General/Quaternion.h"
+
+namespace Esteem
+{
+	typedef uint32_t TransformId;
+	constexpr TransformId InvalidTransformId = ~TransformId(0);
+
+	/// \brief SoA transform store, nodes are kept in depth order so every parent comes before its children
+	/// Local and world position, rotation and scale live in separate float columns, world matrices are
+	/// recalculated per depth level for all dirty nodes, four or eight nodes at a time.
+	/// Every Transform is a handle into the hierarchy of its World, GameEngine cleans it up once per frame before the
+	/// dirty world objects are notified. Create(), Destroy() and SetParent() change the node order and may not run next to
+	/// other calls, setting or getting the values of different transforms may happen from several threads.
+	class TransformHierarchy
+	{
+	private:
+		template<std::size_t N>
+		using FloatColumns = std::array<std::vector<float>, N>;
+
+		// per handle
+		std::vector<uint32_t> indices;
+		std::vector<TransformId> freeIds;
+		/// \brief child links, so Destroy() and SetParent() don't scan every node to find the childs
+		std::vector<TransformId> firstChilds;
+		std::vector<TransformId> nextSiblings;
+		std::vector<TransformId> previousSiblings;
+		/// \brief world matrices, a deque so their addresses stay the same and render objects can point to them
+		std::deque<glm::mat4> matrices;
+
+		/// \brief handles released by destroyed Transforms, which can happen on any thread
+		std::mutex releaseLock;
+		std::vector<TransformId> released;
+
+		// per node, in depth order
+		std::vector<TransformId> ids;
+		std::vector<int32_t> parents;
+		std::vector<uint32_t> depths;
+		std::vector<uint8_t> dirty;
+
+		FloatColumns<3> localPositions;
+		FloatColumns<4> localRotations; // x, y, z, w
+		FloatColumns<3> localScales;
+
+		FloatColumns<3> worldPositions;
+		FloatColumns<4> worldRotations; // x, y, z, w
+		FloatColumns<3> worldScales;
+
+		/// \brief first node of every depth level, last entry is the node count
+		std::vector<std::size_t> levels;
+		bool orderDirty;
+
+		std::size_t AddNode(TransformId id, int32_t parent);
+		void SwapRemoveNode(std::size_t index);
+		/// \brief add to the front of the childs of parent
+		void Link(TransformId id, TransformId parent);
+		/// \brief remove from the childs of its parent, call before parents is updated
+		void Unlink(TransformId id);
+		void SortByDepth();
+		void DestroyReleased();
+
+		template<class V>
+		void UpdateRoots(std::size_t index);
+		template<class V>
+		void UpdateChilds(std::size_t index);
+		template<class V>
+		void UpdateMatrices(std::size_t index);
+
+		template<class V>
+		void UpdateLevel(std::size_t begin, std::size_t end, bool roots);
+
+	public:
+		TransformHierarchy();
+
+		// disable copy
+		TransformHierarchy(const TransformHierarchy&) = delete;
+		void operator=(const TransformHierarchy&) = delete;
+
+		TransformId Create(TransformId parent = InvalidTransformId);
+		/// \brief destroy the transform, its childs become roots and keep their world transform
+		void Destroy(TransformId id);
+		/// \brief destroy the transform at the start of the next DirtyCleanUp(), safe to call from any thread
+		void Release(TransformId id);
+
+		void SetParent(TransformId id, TransformId parent);
+		TransformId GetParent(TransformId id) const;
+
+		void SetLocalPosition(TransformId id, const Vector3& position);
+		void SetLocalRotation(TransformId id, const Quaternion& rotation);
+		void SetLocalScale(TransformId id, const Vector3& scale);
+
+		Vector3 GetLocalPosition(TransformId id) const;
+		Quaternion GetLocalRotation(TransformId id) const;
+		Vector3 GetLocalScale(TransformId id) const;
+
+		/// \brief set the world position, the local position is derived from the parent's last cleaned up world transform
+		void SetPosition(TransformId id, const Vector3& position);
+		/// \brief set the world rotation, the local rotation is derived from the parent's last cleaned up world rotation
+		void SetRotation(TransformId id, const Quaternion& rotation);
+		/// \brief set the world scale, the local scale is derived from the parent's last cleaned up world scale
+		void SetScale(TransformId id, const Vector3& scale);
+
+		Vector3 GetPosition(TransformId id) const;
+		Quaternion GetRotation(TransformId id) const;
+		Vector3 GetScale(TransformId id) const;
+
+		/// \brief the address stays the same until the transform is destroyed
+		const glm::mat4& GetMatrix(TransformId id) const;
+		/// \brief overwrite the world matrix, until the transform is dirty again
+		void SetMatrix(TransformId id, const glm::mat4& matrix);
+		/// \brief recalculate the world matrix from the current world values, without waiting for DirtyCleanUp()
+		void UpdateMatrix(TransformId id);
+
+		/// \brief propagate all dirty nodes down to their childs and recalculate their world matrices
+		void DirtyCleanUp();
+
+		/// \brief reference version of DirtyCleanUp, walks the nodes one at a time without SIMD
+		void DirtyCleanUpScalar();
+
+		inline std::size_t GetCount() const { return ids.size(); }
+	};
+}
+
+#include "./TransformHierarchy.inl"
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "TransformHierarchy.h"
+
+namespace Esteem
+{
+	inline TransformId TransformHierarchy::GetParent(TransformId id) const
+	{
+		int32_t parent = parents[indices[id]];
+		return parent >= 0 ? ids[parent] : InvalidTransformId;
+	}
+
+	inline void TransformHierarchy::SetLocalPosition(TransformId id, const Vector3& position)
+	{
+		uint32_t i = indices[id];
+		localPositions[0][i] = position.x; localPositions[1][i] = position.y; localPositions[2][i] = position.z;
+		dirty[i] = 1;
+	}
+
+	inline void TransformHierarchy::SetLocalRotation(TransformId id, const Quaternion& rotation)
+	{
+		uint32_t i = indices[id];
+		localRotations[0][i] = rotation.x; localRotations[1][i] = rotation.y; localRotations[2][i] = rotation.z; localRotations[3][i] = rotation.w;
+		dirty[i] = 1;
+	}
+
+	inline void TransformHierarchy::SetLocalScale(TransformId id, const Vector3& scale)
+	{
+		uint32_t i = indices[id];
+		localScales[0][i] = scale.x; localScales[1][i] = scale.y; localScales[2][i] = scale.z;
+		dirty[i] = 1;
+	}
+
+	inline Vector3 TransformHierarchy::GetLocalPosition(TransformId id) const
+	{
+		uint32_t i = indices[id];
+		return Vector3(localPositions[0][i], localPositions[1][i], localPositions[2][i]);
+	}
+
+	inline Quaternion TransformHierarchy::GetLocalRotation(TransformId id) const
+	{
+		uint32_t i = indices[id];
+		return Quaternion(glm::quat(localRotations[3][i], localRotations[0][i], localRotations[1][i], localRotations[2][i]));
+	}
+
+	inline Vector3 TransformHierarchy::GetLocalScale(TransformId id) const
+	{
+		uint32_t i = indices[id];
+		return Vector3(localScales[0][i], localScales[1][i], localScales[2][i]);
+	}
+
+	inline Vector3 TransformHierarchy::GetPosition(TransformId id) const
+	{
+		uint32_t i = indices[id];
+		return Vector3(worldPositions[0][i], worldPositions[1][i], worldPositions[2][i]);
+	}
+
+	inline Quaternion TransformHierarchy::GetRotation(TransformId id) const
+	{
+		uint32_t i = indices[id];
+		return Quaternion(glm::quat(worldRotations[3][i], worldRotations[0][i], worldRotations[1][i], worldRotations[2][i]));
+	}
+
+	inline Vector3 TransformHierarchy::GetScale(TransformId id) const
+	{
+		uint32_t i = indices[id];
+		return Vector3(worldScales[0][i], worldScales[1][i], worldScales[2][i]);
+	}
+
+	inline const glm::mat4& TransformHierarchy::GetMatrix(TransformId id) const
+	{
+		return matrices[id];
+	}
+
+	inline void TransformHierarchy::SetMatrix(TransformId id, const glm::mat4& matrix)
+	{
+		matrices[id] = matrix;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <vector>
+
+#include "World/Objects/IWorldObject.h"
+#include "Threading/JobSystem.h"
+
+namespace Esteem
+{
+	/// \brief splits arrays of world objects in ranges and runs their Update or LateUpdate as jobs
+	/// Objects that aren't thread safe are collected per range and updated after the parallel pass, in range order,
+	/// on the calling thread. The ranges only hold iterator pairs, the arrays don't have to be contiguous.
+	/// \tparam ObjectIterator iterates objects derived from IWorldObject, e.g.: the entities of an array
+	/// \tparam PointerIterator iterates pointers to objects derived from IWorldObject
+	template<class ObjectIterator, class PointerIterator>
+	class UpdateRanges
+	{
+	private:
+		struct Range
+		{
+			/// \brief true when the range is over ObjectIterator, false when it's over PointerIterator
+			bool isObjects;
+			ObjectIterator objectsBegin;
+			ObjectIterator objectsEnd;
+			PointerIterator pointersBegin;
+			PointerIterator pointersEnd;
+			/// \brief objects that are not thread safe, these are updated after the parallel pass
+			std::vector<IWorldObject*> serialObjects;
+		};
+
+		/// \brief reused every frame to prevent reallocations
+		std::vector<Range> ranges;
+		std::size_t count;
+
+		Range& NextRange();
+		void UpdateRange(Range& range, bool late);
+
+	public:
+		UpdateRanges();
+
+		// disable copy
+		UpdateRanges(const UpdateRanges&) = delete;
+		void operator=(const UpdateRanges&) = delete;
+
+		/// \brief remove all ranges, keeps the memory for the next frame
+		inline void Clear() { count = 0; }
+
+		/// \brief split [begin, end) in ranges of batchSize objects
+		void AddObjects(ObjectIterator begin, ObjectIterator end, std::size_t batchSize);
+		/// \brief split [begin, end) in ranges of batchSize pointers
+		void AddPointers(PointerIterator begin, PointerIterator end, std::size_t batchSize);
+
+		/// \brief run Update or LateUpdate on all ranges in parallel and wait for them, followed by the serial tail
+		void Run(JobSystem& jobSystem, bool late);
+
+		inline std::size_t GetCount() const { return count; }
+		/// \brief objects the last Run() updated in the serial tail
+		std::size_t GetSerialCount() const;
+	};
+}
+
+#include "./UpdateRanges.inl"
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "UpdateRanges.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "Utils/Profiler.h"
+
+namespace Esteem
+{
+	template<class ObjectIterator, class PointerIterator>
+	inline UpdateRanges<ObjectIterator, PointerIterator>::UpdateRanges()
+		: ranges()
+		, count(0)
+	{ }
+
+	template<class ObjectIterator, class PointerIterator>
+	inline typename UpdateRanges<ObjectIterator, PointerIterator>::Range& UpdateRanges<ObjectIterator, PointerIterator>::NextRange()
+	{
+		if (count == ranges.size())
+			ranges.emplace_back();
+
+		return ranges[count++];
+	}
+
+	template<class ObjectIterator, class PointerIterator>
+	inline void UpdateRanges<ObjectIterator, PointerIterator>::AddObjects(ObjectIterator begin, ObjectIterator end, std::size_t batchSize)
+	{
+		batchSize = std::max<std::size_t>(batchSize, 1);
+		for (std::size_t size = std::size_t(std::distance(begin, end)); size > 0;)
+		{
+			std::size_t rangeSize = std::min(batchSize, size);
+			ObjectIterator rangeEnd = std::next(begin, rangeSize);
+
+			Range& range = NextRange();
+			range.isObjects = true;
+			range.objectsBegin = begin;
+			range.objectsEnd = rangeEnd;
+
+			begin = rangeEnd;
+			size -= rangeSize;
+		}
+	}
+
+	template<class ObjectIterator, class PointerIterator>
+	inline void UpdateRanges<ObjectIterator, PointerIterator>::AddPointers(PointerIterator begin, PointerIterator end, std::size_t batchSize)
+	{
+		batchSize = std::max<std::size_t>(batchSize, 1);
+		for (std::size_t size = std::size_t(std::distance(begin, end)); size > 0;)
+		{
+			std::size_t rangeSize = std::min(batchSize, size);
+			PointerIterator rangeEnd = std::next(begin, rangeSize);
+
+			Range& range = NextRange();
+			range.isObjects = false;
+			range.pointersBegin = begin;
+			range.pointersEnd = rangeEnd;
+
+			begin = rangeEnd;
+			size -= rangeSize;
+		}
+	}
+
+	template<class ObjectIterator, class PointerIterator>
+	inline void UpdateRanges<ObjectIterator, PointerIterator>::UpdateRange(Range& range, bool late)
+	{
+		range.serialObjects.clear();
+
+		auto update = [&range, late](IWorldObject& worldObject)
+		{
+			if (!worldObject.IsThreadSafeUpdate())
+				range.serialObjects.push_back(&worldObject);
+			else if (late)
+				worldObject.LateUpdate();
+			else
+				worldObject.Update();
+		};
+
+		if (range.isObjects)
+		{
+			for (ObjectIterator it = range.objectsBegin; it != range.objectsEnd; ++it)
+				update(*it);
+		}
+		else
+		{
+			for (PointerIterator it = range.pointersBegin; it != range.pointersEnd; ++it)
+				update(**it);
+		}
+	}
+
+	template<class ObjectIterator, class PointerIterator>
+	inline void UpdateRanges<ObjectIterator, PointerIterator>::Run(JobSystem& jobSystem, bool late)
+	{
+		auto rangesUpdate = [this, late](std::size_t from, std::size_t to)
+		{
+			ESTEEM_PROFILE("UpdateRanges::Range");
+			for (std::size_t i = from; i < to; ++i)
+				UpdateRange(ranges[i], late);
+		};
+
+		// barrier: wait (and help) until all parallel ranges are done
+		jobSystem.WaitFor(jobSystem.ParallelFor(count, 1, rangesUpdate));
+
+		// serial tail, in range order so it stays deterministic
+		ESTEEM_PROFILE("UpdateRanges::Serial");
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			for (IWorldObject* worldObject : ranges[i].serialObjects)
+			{
+				if (late)
+					worldObject->LateUpdate();
+				else
+					worldObject->Update();
+			}
+		}
+	}
+
+	template<class ObjectIterator, class PointerIterator>
+	inline std::size_t UpdateRanges<ObjectIterator, PointerIterator>::GetSerialCount() const
+	{
+		std::size_t serialCount = 0;
+		for (std::size_t i = 0; i < count; ++i)
+			serialCount += ranges[i].serialObjects.size();
+
+		return serialCount;
+	}
+}
@@ -60,6 +60,19 @@ namespace Esteem
 		return entities.emplace(this);
 	}
 
+	void World::BuildUpdateRanges(WorldUpdateRanges& ranges)
+	{
+		// split every entity array in ranges that roughly fit in L1 cache
+		constexpr std::size_t entityBatch = std::max<std::size_t>(1, UpdateRangeBytes / sizeof(Entity));
+
+		ranges.Clear();
+		for (auto& vector : entities.get_arrays())
+			ranges.AddObjects(std::begin(*vector), std::end(*vector), entityBatch);
+
+		// world objects are scattered pointers, keep their ranges small enough for stealing
+		ranges.AddPointers(worldObjects.begin(), worldObjects.end(), WorldObjectBatch);
+	}
+
 	cgc::strong_ptr<GraphicalOverlay> World::CreateGraphicalOverlay(const std::string& name)
 	{
 		return graphicalOverlays.emplace(name);
@@ -110,6 +123,16 @@ namespace Esteem
 
 	}
 
+	void World::DirtyTransformCleanUp()
+	{
+		// SoA transforms, recalculates the world values and matrices of everything that moved this frame
+		transformHierarchy.DirtyCleanUp();
+
+		IWorldObject* worldObject;
+		while (dirtyWorldObjects.pop(worldObject))
+			worldObject->DirtyCleanUp();
+	}
+
 	void World::DirtyRenderCleanUp()
 	{
 		//constituents.cameras.DirtyCleanUp();
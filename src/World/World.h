@@ -15,6 +15,9 @@
 #include "General/Delegate.h"
 #include "World/Objects/DelayedAction.h"
 #include "World/Objects/Entity.h"
+#include "World/ArchetypeStore.h"
+#include "World/Objects/TransformHierarchy.h"
+#include "World/UpdateRanges.h"
 
 #include "./WorldDataConstituents.h"
 
@@ -47,6 +50,16 @@ namespace Esteem
 	class World
 	{
 		friend class GameEngine;
+	public:
+		/// \brief iterator over one of the arrays of the entities
+		typedef decltype(std::begin(*std::declval<cgc::m_array<Entity>&>().get_arrays()[0])) EntityIterator;
+		typedef UpdateRanges<EntityIterator, std::deque<cgc::strong_ptr<Transform>>::iterator> WorldUpdateRanges;
+
+		/// \brief approximate bytes of entities per update range, about the size of an L1 cache
+		static constexpr std::size_t UpdateRangeBytes = 32 * 1024;
+		/// \brief world objects per update range
+		static constexpr std::size_t WorldObjectBatch = 64;
+
 	private:
 		bool loaded;
 		float simulationSpeed;
@@ -78,9 +91,14 @@ namespace Esteem
 		cgc::strong_ptr<Camera> defaultCamera;
 				
 		// World Objects
+		// SoA transforms of all entities, declared before them so it outlives their Transforms
+		TransformHierarchy transformHierarchy;
 		cgc::m_array<Entity> entities;
 		cgc::m_array<GraphicalOverlay> graphicalOverlays;
 
+		// Archetype based components, adopted one system at a time next to the constituents
+		ArchetypeStore archetypes;
+
 		std::deque<cgc::strong_ptr<Transform>> worldObjects;
 		std::vector<cgc::strong_ptr<Transform>> nonTransformWorldObjects;
 
@@ -132,6 +150,8 @@ namespace Esteem
 		void RemoveDirty(IWorldObject* worldObject);
 
 		void DirtyCleanUp();
+		/// \brief recalculate the transforms of everything that moved this frame and notify the dirty world objects
+		void DirtyTransformCleanUp();
 		void DirtyRenderCleanUp();
 
 		bool AddDirty(BoneMatrices* BoneMatrices);
@@ -148,6 +168,11 @@ namespace Esteem
 
 		void OnEntityMove(const cgc::strong_ptr<Entity>& entity);
 
+		/// \brief split the entities and world objects in ranges for the update jobs, rebuild before every phase
+		/// Entities take the parallel path unless one of their AbstractComponents isn't thread safe. Constituents like the
+		/// MeshRenderer, Animator or bodies are updated by their systems, so an entity with only constituents runs in parallel.
+		void BuildUpdateRanges(WorldUpdateRanges& ranges);
+
 		void Update();
 		void UpdateThreadTasks(std::deque<std::function<void()>>& taskQueue, uint8 threadCount);
 
@@ -158,6 +183,14 @@ namespace Esteem
 
 		WorldDataConstituents& GetWorldConstituents();
 
+		ArchetypeStore& GetArchetypes();
+
+		TransformHierarchy& GetTransformHierarchy();
+
+		/// \brief get a cached query over all archetype entities that have the given components
+		template<class... Ts>
+		ArchetypeQuery<Ts...> Query();
+
 		TriggerSystem& GetTriggerSystem();
 		NetworkSystem& GetNetworkSystem();
 
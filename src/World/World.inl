@@ -60,6 +60,22 @@ namespace Esteem
 		return constituents;
 	}
 
+	inline ArchetypeStore& World::GetArchetypes()
+	{
+		return archetypes;
+	}
+
+	inline TransformHierarchy& World::GetTransformHierarchy()
+	{
+		return transformHierarchy;
+	}
+
+	template<class... Ts>
+	inline ArchetypeQuery<Ts...> World::Query()
+	{
+		return archetypes.Query<Ts...>();
+	}
+
 	inline Culling& World::GetCulling()
 	{
 		return culling;